@@ -0,0 +1,109 @@
+#pragma once
+
+#include "http_message.h"
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/beast/core/file.hpp>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// nghttp2仅在实现文件中使用
+struct nghttp2_session;
+
+namespace common {
+namespace network {
+namespace http {
+
+class HttpServer;
+
+/**
+ * @brief HTTP/2服务端连接
+ *
+ * 基于nghttp2处理帧、HPACK头部压缩和流量控制（需要编译时启用ZEUS_HTTP_HAS_NGHTTP2）。
+ * TLS连接通过ALPN协商h2，明文连接通过prior-knowledge前言识别（h2c），
+ * 由HttpServerSession在识别出协议后移交套接字。
+ * 每个流的请求完整接收后投递到服务器的工作线程执行HttpServer::ProcessRequest，与HTTP/1.1共用路由和中间件链；
+ * 帧收发和nghttp2会话只在连接的strand上访问，处理器完成后再回到strand提交响应，
+ * 因此慢处理器不会阻塞同一连接上的其他流（工作线程数由HttpServer的线程池决定）。
+ * 流式路由需要HTTP/1.1，以HTTP_1_1_REQUIRED重置该流，由客户端改用HTTP/1.1重试。
+ */
+class Http2ServerSession : public std::enable_shared_from_this<Http2ServerSession> {
+public:
+    /**
+     * @brief 构造函数
+     * @param socket 明文连接（与ssl_stream二选一）
+     * @param ssl_stream TLS连接
+     * @param server HTTP服务器引用
+     */
+    Http2ServerSession(std::unique_ptr<boost::asio::ip::tcp::socket> socket,
+                       std::unique_ptr<boost::asio::ssl::stream<boost::asio::ip::tcp::socket>> ssl_stream,
+                       HttpServer& server);
+    ~Http2ServerSession();
+
+    Http2ServerSession(const Http2ServerSession&) = delete;
+    Http2ServerSession& operator=(const Http2ServerSession&) = delete;
+
+    /**
+     * @brief 开始处理连接
+     * @param initial_data 协议识别阶段已读取的数据（h2c连接前言等）
+     */
+    void Start(std::string_view initial_data);
+
+    /**
+     * @brief 关闭连接
+     */
+    void Close();
+
+private:
+    // 单个HTTP/2流的请求与响应
+    struct Stream {
+        int32_t id = 0;
+        boost::beast::http::request_header<> header;
+        std::string body;
+        bool rejected = false;                  // 已直接返回错误响应，忽略剩余请求体
+        HttpResponse response;
+        std::string response_body;
+        size_t body_offset = 0;
+        boost::beast::file file;                // 文件区间响应
+        uint64_t file_remaining = 0;
+        std::chrono::steady_clock::time_point start_time;
+        HttpArena arena;                        // 请求级临时内存，随流一起释放
+    };
+
+    // nghttp2回调，定义在实现文件中
+    struct Callbacks;
+
+    bool InitSession();
+    void DoRead();
+    void OnRead(boost::system::error_code ec, std::size_t bytes_transferred);
+    void DoWrite();
+    void OnWrite(boost::system::error_code ec, std::size_t bytes_transferred);
+
+    void ProcessStream(const std::shared_ptr<Stream>& stream);
+    void SubmitResponse(Stream& stream);
+    void SubmitError(Stream& stream, HttpStatusCode status);
+
+    std::unique_ptr<boost::asio::ip::tcp::socket> socket_;
+    std::unique_ptr<boost::asio::ssl::stream<boost::asio::ip::tcp::socket>> ssl_stream_;
+    boost::asio::strand<boost::asio::any_io_executor> strand_;
+    HttpServer& server_;
+    std::string remote_address_;
+
+    nghttp2_session* session_ = nullptr;
+    std::map<int32_t, std::shared_ptr<Stream>> streams_;   // 处理器执行期间与工作线程共享
+
+    std::array<uint8_t, 16 * 1024> read_buffer_{};
+    std::string write_buffer_;
+    bool writing_ = false;
+    bool closed_ = false;
+};
+
+} // namespace http
+} // namespace network
+} // namespace common
@@ -7,18 +7,66 @@
 #include <boost/beast/core.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ssl.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <array>
+#include <deque>
+#include <functional>
 #include <memory>
-#include <queue>
 #include <mutex>
-#include <condition_variable>
 #include <future>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace common {
 namespace network {
 namespace http {
 
 /**
- * @brief HTTP client session for handling individual requests
+ * @brief Asynchronous DNS cache shared by the sessions of one client
+ *
+ * Successful lookups are kept for a fixed TTL; failures are not cached.
+ * Concurrent lookups of the same host:port share one resolver query.
+ */
+class HttpDnsCache : public std::enable_shared_from_this<HttpDnsCache> {
+public:
+    using Results = boost::asio::ip::tcp::resolver::results_type;
+    using ResolveCallback = std::function<void(boost::system::error_code, Results)>;
+    
+    HttpDnsCache(boost::asio::any_io_executor executor, std::chrono::milliseconds ttl);
+    
+    /**
+     * @brief Resolve host:port, answering from the cache when the entry is fresh
+     */
+    void AsyncResolve(const std::string& host, const std::string& port, ResolveCallback callback);
+    
+    /**
+     * @brief Drop all cached entries
+     */
+    void Clear();
+    
+    size_t GetEntries() const;
+
+private:
+    struct Entry {
+        Results results;
+        std::chrono::steady_clock::time_point expires_at;
+        std::vector<ResolveCallback> waiters;
+        bool resolving = false;
+    };
+    
+    boost::asio::ip::tcp::resolver resolver_;
+    std::chrono::milliseconds ttl_;
+    std::unordered_map<std::string, Entry> entries_;
+    mutable std::mutex mutex_;
+};
+
+/**
+ * @brief HTTP client session (one connection) for handling requests
+ *
+ * The connection is kept open across requests while the server allows keep-alive.
+ * All socket operations run on a per-session strand; requests may be queued
+ * behind each other and, for pipelining, written before earlier responses arrive.
  */
 class HttpSession : public std::enable_shared_from_this<HttpSession> {
 public:
@@ -26,8 +74,10 @@ public:
      * @brief Constructor
      * @param executor ASIO executor
      * @param config HTTP configuration
+     * @param dns_cache Optional shared DNS cache (resolves directly when null)
      */
-    explicit HttpSession(boost::asio::any_io_executor executor, const HttpConfig& config = HttpConfig{});
+    explicit HttpSession(boost::asio::any_io_executor executor, const HttpConfig& config = HttpConfig{},
+                         std::shared_ptr<HttpDnsCache> dns_cache = nullptr);
     
     /**
      * @brief Destructor
@@ -44,6 +94,16 @@ public:
                      HttpResponseCallback callback,
                      HttpProgressCallback progress_callback = nullptr);
     
+    /**
+     * @brief Queue HTTP request behind the outstanding ones on this connection
+     *
+     * GET and HEAD requests are written without waiting for earlier responses
+     * (HTTP/1.1 pipelining); other methods wait until the connection is idle.
+     */
+    void AsyncPipelinedRequest(const HttpRequest& request,
+                               HttpResponseCallback callback,
+                               HttpProgressCallback progress_callback = nullptr);
+    
     /**
      * @brief Execute HTTP request synchronously
      * @param request HTTP request to send
@@ -64,6 +124,19 @@ public:
      */
     bool IsBusy() const { return busy_; }
     
+    /**
+     * @brief Number of queued and in-flight requests
+     */
+    size_t GetOutstanding() const { return outstanding_; }
+    
+    /**
+     * @brief Check if the idle connection can carry another request
+     *
+     * Returns false when the connection is closed, the server asked to close it,
+     * or the peer has already sent EOF/data on the idle socket.
+     */
+    bool IsReusable() const;
+    
     /**
      * @brief Get session configuration
      */
@@ -75,15 +148,32 @@ public:
     void SetConfig(const HttpConfig& config) { config_ = config; }
 
 private:
+    // One request/response exchange on this connection
+    struct Exchange {
+        HttpRequest request;
+        HttpResponseCallback callback;
+        HttpProgressCallback progress_callback;
+        bool retried = false;   // already replayed once after a stale keep-alive connection
+    };
+    
     // Connection management
     void Connect(const HttpUrl& url, std::function<void(boost::system::error_code)> callback);
     void Disconnect();
     bool IsConnected() const;
     
-    // Request processing
-    void DoRequest(const HttpRequest& request, HttpResponseCallback callback, HttpProgressCallback progress_callback);
-    void WriteRequest(const HttpRequest& request);
-    void ReadResponse(HttpResponseCallback callback);
+    // Request processing (on the strand)
+    void Submit(Exchange exchange);
+    void DoRequest();
+    void WriteRequest();
+    void WriteBodyChunk();
+    void OnWrite(boost::system::error_code ec, std::size_t bytes_transferred);
+    void ReadResponse();
+    void OnRead(boost::system::error_code ec, std::size_t bytes_transferred);
+    void OnResponseHeader(boost::system::error_code ec, std::size_t bytes_transferred);
+    void ReadSinkBody();
+    void OnSinkBody(boost::system::error_code ec, std::size_t bytes_transferred);
+    void CompleteResponse(HttpResponse response);
+    void FailAll(boost::system::error_code ec);
     void HandleRedirect(const HttpResponse& response, const HttpRequest& original_request, 
                        HttpResponseCallback callback, HttpProgressCallback progress_callback, size_t redirect_count);
     
@@ -101,6 +191,7 @@ private:
     
     boost::asio::any_io_executor executor_;
     HttpConfig config_;
+    std::shared_ptr<HttpDnsCache> dns_cache_;
     
     // Network components
     std::unique_ptr<boost::asio::ip::tcp::socket> socket_;
@@ -111,11 +202,39 @@ private:
     // Request/Response handling
     boost::beast::flat_buffer buffer_;
     boost::beast::http::request<boost::beast::http::string_body> beast_request_;
-    boost::beast::http::response<boost::beast::http::string_body> beast_response_;
+    std::optional<boost::beast::http::response_parser<boost::beast::http::string_body>> parser_;
+    
+    // Streamed request body: the header goes out through the serializer, then the
+    // body is written chunk by chunk as the stream produces it
+    std::shared_ptr<HttpBodyStream> body_stream_;
+    std::optional<boost::beast::http::request_serializer<boost::beast::http::string_body>> header_serializer_;
+    std::string body_chunk_;
+    size_t body_bytes_written_ = 0;
+    
+    // Response body passed to the request's HttpResponseSink: the header is read on its
+    // own, then the parser is converted to a buffer_body one (or to parser_ when declined)
+    std::optional<boost::beast::http::response_parser<boost::beast::http::empty_body>> header_parser_;
+    std::optional<boost::beast::http::response_parser<boost::beast::http::buffer_body>> sink_parser_;
+    std::shared_ptr<HttpResponseSink> response_sink_;
+    HttpResponse sink_response_;
+    std::vector<char> sink_buffer_;
+    size_t sink_bytes_ = 0;
+    
+    // Exchanges not yet written, and written ones awaiting their response (in order)
+    std::deque<Exchange> pending_;
+    std::deque<Exchange> in_flight_;
+    size_t written_ = 0;            // in_flight_ entries fully written
+    bool connecting_ = false;
+    bool writing_ = false;
+    bool reading_ = false;
+    bool keep_alive_ = true;        // cleared when the server closes the connection
+    size_t connection_requests_ = 0; // responses received on the current connection
+    uint64_t connection_id_ = 0;     // bumped on disconnect so stale handlers are ignored
     
     // State management
     std::atomic<bool> busy_{false};
     std::atomic<bool> cancelled_{false};
+    std::atomic<size_t> outstanding_{0};
     HttpUrl current_url_;
     std::string session_id_;
     
@@ -129,7 +248,99 @@ private:
 };
 
 /**
- * @brief HTTP client pool for managing multiple sessions
+ * @brief Retry and hedging policy for a request
+ *
+ * Only idempotent requests (GET/HEAD/OPTIONS/PUT/DELETE) are retried or hedged.
+ * Every retry and hedge spends a token from the client's retry budget.
+ */
+struct HttpRequestPolicy {
+    // Retries with full-jitter exponential backoff
+    size_t max_retries = 0;
+    std::chrono::milliseconds retry_base_delay{50};
+    std::chrono::milliseconds retry_max_delay{2000};
+    bool retry_on_server_error = true;          // retry 502/503/504 as well as transport errors
+    
+    // Hedging: send a duplicate when the first attempt is slower than the origin's recent latency percentile
+    bool enable_hedging = false;
+    double hedge_percentile = 0.95;
+    std::chrono::milliseconds min_hedge_delay{5};
+    size_t max_hedges = 1;
+    
+    // Alternative origins ("http://10.0.0.2:8080") used round-robin for hedges and retries
+    std::vector<std::string> replicas;
+};
+
+/**
+ * @brief Options of HttpClient::DownloadFile
+ */
+struct HttpDownloadOptions {
+    // Continue a partial file left by an earlier download with a Range request
+    // (a server that ignores the Range header sends the whole file again)
+    bool resume = false;
+    
+    // Range requests for the remaining bytes after the connection drops mid-transfer;
+    // the first response's ETag/Last-Modified is sent as If-Range so a changed file restarts
+    size_t max_resume_attempts = 3;
+    
+    HttpHeaders headers;
+};
+
+/**
+ * @brief Token bucket limiting retries and hedges to a fraction of traffic
+ *
+ * Each request deposits `ratio` tokens, each retry/hedge withdraws one, and a
+ * minimum rate is refilled over time. During an outage the bucket drains, so
+ * retries cannot multiply the load on a failing service.
+ */
+class HttpRetryBudget {
+public:
+    HttpRetryBudget(double ratio, double min_per_second);
+    
+    void Deposit();
+    
+    /**
+     * @brief Refill for the time since the last call, then take one token if available
+     */
+    bool TryWithdraw(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+private:
+    double ratio_;
+    double min_per_second_;
+    double max_balance_;
+    double balance_;
+    std::chrono::steady_clock::time_point last_refill_;
+    std::mutex mutex_;
+};
+
+/**
+ * @brief Recent successful latencies of one origin, used to derive hedge delays
+ *
+ * Keeps the last kCapacity samples in a ring. Not synchronized; the client
+ * guards each origin's tracker with its pool mutex.
+ */
+class HttpLatencyTracker {
+public:
+    static constexpr size_t kCapacity = 128;
+    static constexpr size_t kMinSamples = 16;       // no percentile before this many samples
+    
+    void Record(std::chrono::microseconds latency);
+    
+    /**
+     * @brief Latency at percentile (0-1) of the recent samples, rounded up to whole milliseconds
+     */
+    std::optional<std::chrono::milliseconds> GetPercentile(double percentile) const;
+
+private:
+    std::array<uint32_t, kCapacity> samples_{};
+    size_t count_ = 0;
+};
+
+/**
+ * @brief HTTP client with per-origin keep-alive connection pools
+ *
+ * Each origin (scheme/host/port) has its own pool bounded by max_connections_per_host.
+ * Idle connections are reused most-recently-used first and closed after idle_timeout;
+ * requests beyond the limit wait in a per-origin queue (or are pipelined when enabled).
  */
 class HttpClient {
 public:
@@ -193,6 +404,12 @@ public:
     void Request(const HttpRequest& request, HttpResponseCallback callback, 
                 HttpProgressCallback progress_callback = nullptr);
     
+    /**
+     * @brief Execute custom request asynchronously with a retry/hedging policy
+     */
+    void Request(const HttpRequest& request, const HttpRequestPolicy& policy,
+                 HttpResponseCallback callback, HttpProgressCallback progress_callback = nullptr);
+    
     // Synchronous Request Methods
     
     /**
@@ -246,12 +463,16 @@ public:
      */
     std::future<nlohmann::json> PostJson(const std::string& url, const nlohmann::json& json, 
                                         const HttpHeaders& headers = {});
+    std::future<nlohmann::json> PostJson(const std::string& url, const HttpJsonBuilder& build,
+                                        const HttpHeaders& headers = {});
     
     /**
      * @brief Execute PUT request with JSON body
      */
     std::future<nlohmann::json> PutJson(const std::string& url, const nlohmann::json& json, 
                                        const HttpHeaders& headers = {});
+    std::future<nlohmann::json> PutJson(const std::string& url, const HttpJsonBuilder& build,
+                                       const HttpHeaders& headers = {});
     
     /**
      * @brief Execute PATCH request with JSON body
@@ -263,18 +484,42 @@ public:
     
     /**
      * @brief Download file asynchronously
+     *
+     * The body is written to local_path as it arrives, so memory use does not
+     * depend on the file size; progress_callback reports the bytes on disk.
+     * A connection lost mid-transfer is resumed with a Range request.
      */
     void DownloadFile(const std::string& url, const std::string& local_path, 
                      std::function<void(boost::system::error_code, const std::string&)> callback,
                      HttpProgressCallback progress_callback = nullptr, const HttpHeaders& headers = {});
     
     /**
-     * @brief Upload file asynchronously
+     * @brief Download file asynchronously, optionally resuming an earlier partial download
+     */
+    void DownloadFile(const std::string& url, const std::string& local_path, const HttpDownloadOptions& options,
+                     std::function<void(boost::system::error_code, const std::string&)> callback,
+                     HttpProgressCallback progress_callback = nullptr);
+    
+    /**
+     * @brief Upload file asynchronously as a multipart/form-data POST
+     *
+     * The file is read from disk in chunks while the request is written,
+     * progress_callback reports the uploaded bytes.
      */
     void UploadFile(const std::string& url, const std::string& file_path, const std::string& field_name,
                    HttpResponseCallback callback, HttpProgressCallback progress_callback = nullptr,
                    const HttpHeaders& headers = {});
     
+    /**
+     * @brief Send a file from disk as the raw request body (PUT by default)
+     *
+     * Streamed like UploadFile. Content-Type defaults to the MIME type of the
+     * file extension unless set in headers.
+     */
+    void UploadFileBody(const std::string& url, const std::string& file_path,
+                        HttpResponseCallback callback, HttpProgressCallback progress_callback = nullptr,
+                        const HttpHeaders& headers = {}, HttpMethod method = HttpMethod::PUT);
+    
     // Session Management
     
     /**
@@ -330,6 +575,12 @@ public:
     const HttpConfig& GetConfig() const { return config_; }
     void SetConfig(const HttpConfig& config) { config_ = config; }
     
+    /**
+     * @brief Policy applied to requests issued without an explicit one
+     */
+    void SetDefaultPolicy(const HttpRequestPolicy& policy) { default_policy_ = policy; }
+    const HttpRequestPolicy& GetDefaultPolicy() const { return default_policy_; }
+    
     /**
      * @brief Get client statistics
      */
@@ -343,6 +594,14 @@ public:
         std::chrono::steady_clock::time_point created_at;
         double average_request_time_ms = 0.0;
         
+        // Retries and hedges (rates are per original request)
+        size_t retries = 0;
+        size_t hedges = 0;
+        size_t hedge_wins = 0;                  // responses delivered from a hedge
+        size_t retry_budget_exhausted = 0;      // retries/hedges skipped for lack of budget
+        double retry_rate = 0.0;
+        double hedge_rate = 0.0;
+        
         ClientStats() : created_at(std::chrono::steady_clock::now()) {}
     };
     
@@ -362,27 +621,71 @@ public:
     void WaitForCompletion(std::chrono::milliseconds timeout = std::chrono::milliseconds{30000});
 
 private:
+    // A queued request waiting for a connection of its origin
+    struct PendingRequest {
+        HttpRequest request;
+        HttpResponseCallback callback;
+        HttpProgressCallback progress_callback;
+    };
+    
+    // Connections of one origin
+    struct HostPool {
+        std::vector<std::shared_ptr<HttpSession>> sessions;     // busy and idle
+        std::vector<std::pair<std::shared_ptr<HttpSession>, std::chrono::steady_clock::time_point>> idle;
+        std::deque<PendingRequest> waiting;
+        
+        // Recent successful latencies for hedge delays
+        HttpLatencyTracker latencies;
+    };
+    
+    // State shared by the attempts of a request with a policy
+    struct PolicyCall;
+    
+    // State shared by the requests of one (resumed) file download
+    struct DownloadCall;
+    
     // Session pool management
-    std::shared_ptr<HttpSession> GetAvailableSession();
-    void ReturnSession(std::shared_ptr<HttpSession> session);
-    void CreateSession();
+    static std::string MakeOriginKey(const HttpUrl& url);
+    void DispatchRequest(PendingRequest pending);
+    void Execute(const std::string& origin, std::shared_ptr<HttpSession> session, PendingRequest pending, bool pipelined);
+    void ReleaseSession(const std::string& origin, std::shared_ptr<HttpSession> session,
+                        std::optional<std::chrono::microseconds> latency);
+    void RemoveSessionLocked(HostPool& pool, const std::shared_ptr<HttpSession>& session);
+    void ScheduleIdleSweep();
     void CleanupSessions();
     
     // Request preparation
     HttpRequest PrepareRequest(const HttpRequest& original_request) const;
     
+    // Send a request and resolve with its parsed JSON response (null on failure)
+    std::future<nlohmann::json> RequestJson(HttpRequest request, const HttpHeaders& headers);
+    
+    // Request the part of a download not yet on disk
+    void StartDownload(const std::shared_ptr<DownloadCall>& call);
+    
+    // Retries and hedging
+    void StartAttempt(const std::shared_ptr<PolicyCall>& call, bool hedge);
+    void OnAttemptComplete(const std::shared_ptr<PolicyCall>& call, bool hedge,
+                           boost::system::error_code ec, const HttpResponse& response);
+    void ScheduleHedge(const std::shared_ptr<PolicyCall>& call);
+    std::optional<std::chrono::milliseconds> GetHedgeDelay(const std::string& origin, double percentile);
+    
     // Statistics update
     void UpdateStats(bool success, std::chrono::milliseconds duration, size_t bytes_sent, size_t bytes_received);
     
     boost::asio::any_io_executor executor_;
     HttpConfig config_;
     
-    // Session pool
-    std::vector<std::shared_ptr<HttpSession>> session_pool_;
-    std::queue<std::shared_ptr<HttpSession>> available_sessions_;
+    // Per-origin connection pools
+    std::unordered_map<std::string, HostPool> pools_;
     std::mutex session_mutex_;
-    std::condition_variable session_cv_;
-    size_t max_pool_size_ = 10;
+    std::shared_ptr<HttpDnsCache> dns_cache_;
+    std::unique_ptr<boost::asio::steady_timer> idle_timer_;
+    
+    // Retry/hedging policy and the budget shared by all requests
+    HttpRequestPolicy default_policy_;
+    HttpRetryBudget retry_budget_;
+    std::shared_ptr<int> lifetime_ = std::make_shared<int>(0);  // timer handlers hold a weak reference
     
     // Global settings
     HttpHeaders global_headers_;
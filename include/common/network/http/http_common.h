@@ -1,11 +1,14 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <memory>
 #include <chrono>
 #include <functional>
+#include <memory_resource>
 #include <boost/beast/http.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/version.hpp>
@@ -42,7 +45,7 @@ enum class HttpMethod {
 enum class HttpVersion {
     HTTP_1_0,
     HTTP_1_1,
-    HTTP_2_0  // Future support
+    HTTP_2_0
 };
 
 /**
@@ -79,6 +82,8 @@ enum class HttpStatusCode {
     GONE = 410,
     PAYLOAD_TOO_LARGE = 413,
     UNSUPPORTED_MEDIA_TYPE = 415,
+    RANGE_NOT_SATISFIABLE = 416,
+    UPGRADE_REQUIRED = 426,
     TOO_MANY_REQUESTS = 429,
     
     // 5xx Server Error
@@ -95,11 +100,59 @@ enum class HttpStatusCode {
  */
 using HttpHeaders = std::unordered_map<std::string, std::string>;
 
+/**
+ * @brief Header storage of HttpRequest/HttpResponse
+ *
+ * Beast's field container: case-insensitive lookup, one allocation per
+ * field, and it can be moved in and out of Beast messages without copying.
+ */
+using HttpFields = boost::beast::http::fields;
+
 /**
  * @brief HTTP query parameters type
  */
 using HttpParams = std::unordered_map<std::string, std::string>;
 
+/**
+ * @brief Query parameters parsed into an arena, in request order
+ */
+using HttpArenaParams = std::pmr::vector<std::pair<std::pmr::string, std::pmr::string>>;
+
+/**
+ * @brief Cookie name/value pairs parsed into an arena; the views point into the Cookie header
+ */
+using HttpCookieViews = std::pmr::vector<std::pair<std::string_view, std::string_view>>;
+
+/**
+ * @brief Per-request monotonic arena
+ *
+ * Allocations bump a pointer through one buffer that is allocated once and reused;
+ * requests that outgrow it spill to the heap in growing chunks. Nothing is freed
+ * individually: Reset() drops everything at once and rewinds to the start of the buffer.
+ * The server owns one per connection (one per stream on HTTP/2) and resets it after each
+ * response is written, so memory taken from it must not outlive the request.
+ */
+class HttpArena {
+public:
+    static constexpr size_t kDefaultSize = 4096;
+
+    explicit HttpArena(size_t initial_size = kDefaultSize);
+
+    HttpArena(const HttpArena&) = delete;
+    HttpArena& operator=(const HttpArena&) = delete;
+
+    std::pmr::memory_resource* Resource() { return &resource_; }
+
+    /**
+     * @brief Release all allocations
+     */
+    void Reset() { resource_.release(); }
+
+private:
+    std::unique_ptr<std::byte[]> buffer_;
+    std::pmr::monotonic_buffer_resource resource_;
+};
+
 /**
  * @brief HTTP cookie structure
  */
@@ -150,6 +203,13 @@ struct HttpConfig {
     // Connection settings
     bool keep_alive = true;
     size_t max_redirects = 5;
+    
+    // Connection pool settings (pools are kept per origin: scheme/host/port)
+    size_t max_connections_per_host = 32;                 // busy + idle connections
+    size_t max_idle_connections_per_host = 8;             // idle connections kept for reuse
+    std::chrono::milliseconds dns_cache_ttl{30000};       // 0 disables the DNS cache
+    bool enable_pipelining = false;                       // pipeline GET/HEAD on busy connections when the pool is full
+    size_t max_pipeline_depth = 4;                        // outstanding requests per pipelined connection
     bool verify_ssl = true;
     std::string user_agent = "Zeus-HTTP/1.0";
     
@@ -161,6 +221,8 @@ struct HttpConfig {
     // Retry settings
     size_t max_retries = 3;
     std::chrono::milliseconds retry_delay{1000};
+    double retry_budget_ratio = 0.1;                      // retries/hedges earned per request sent
+    double retry_budget_min_per_second = 10.0;            // floor so low-traffic clients can still retry
     
     HttpConfig() = default;
 };
@@ -224,7 +286,7 @@ namespace HttpUtils {
     /**
      * @brief URL encode string
      */
-    std::string UrlEncode(const std::string& input);
+    std::string UrlEncode(std::string_view input);
     
     /**
      * @brief URL decode string
@@ -236,6 +298,11 @@ namespace HttpUtils {
      */
     HttpParams ParseQueryString(const std::string& query);
     
+    /**
+     * @brief Parse query string into an arena (no per-parameter heap allocation)
+     */
+    HttpArenaParams ParseQueryString(std::string_view query, std::pmr::memory_resource* arena);
+    
     /**
      * @brief Build query string from parameters
      */
@@ -246,6 +313,11 @@ namespace HttpUtils {
      */
     std::vector<HttpCookie> ParseCookies(const std::string& cookie_header);
     
+    /**
+     * @brief Parse HTTP cookie header into an arena without copying names or values
+     */
+    HttpCookieViews ParseCookies(std::string_view cookie_header, std::pmr::memory_resource* arena);
+    
     /**
      * @brief Build cookie header string
      */
@@ -266,6 +338,11 @@ namespace HttpUtils {
      */
     std::string BuildContentType(const ContentType& content_type);
     
+    /**
+     * @brief Copy header fields into a plain name/value map
+     */
+    HttpHeaders ToHeaderMap(const HttpFields& fields);
+    
     /**
      * @brief Get MIME type from file extension
      */
@@ -291,6 +368,19 @@ namespace HttpUtils {
      */
     std::string GenerateBoundary();
     
+    /**
+     * @brief Fast non-cryptographic 64-bit hash (xxHash64) for ETags and cache keys
+     */
+    uint64_t Hash64(std::string_view data, uint64_t seed = 0);
+    
+    /**
+     * @brief Check an If-None-Match value against an entity tag
+     *
+     * Uses weak comparison (a W/ prefix is ignored) over the comma separated
+     * list; "*" matches any tag.
+     */
+    bool EtagMatches(std::string_view if_none_match, std::string_view etag);
+    
     /**
      * @brief Format HTTP date
      */
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace common {
+namespace network {
+namespace http {
+
+/**
+ * @brief HTTP内容编码器
+ *
+ * 支持gzip、deflate（zlib格式）以及编译时启用的br（ZEUS_HTTP_HAS_BROTLI）。
+ * zlib压缩流按线程复用，每次压缩只重置流状态，不重新分配窗口和哈希表。
+ */
+class HttpCompressor {
+public:
+    /**
+     * @brief 检查是否支持指定编码
+     */
+    static bool IsSupported(std::string_view encoding);
+
+    /**
+     * @brief 压缩数据
+     * @param input 原始数据
+     * @param encoding 内容编码名称（gzip/deflate/br）
+     * @param level 压缩级别（1-9，br映射为同级quality）
+     * @param output 输出压缩结果
+     * @return 编码不支持或压缩失败时返回false
+     */
+    static bool Compress(std::string_view input, std::string_view encoding, int level, std::string& output);
+};
+
+/**
+ * @brief 压缩结果缓存
+ *
+ * 以编码和响应标识（ETag或响应体哈希）为键缓存压缩结果，容量按字节数限制，LRU淘汰。
+ * 相同的响应体（配置下发、排行榜等）只压缩一次。
+ */
+class HttpCompressionCache {
+public:
+    explicit HttpCompressionCache(size_t max_bytes);
+
+    /**
+     * @brief 生成缓存键
+     * @param encoding 内容编码
+     * @param etag 响应ETag，为空时使用响应体哈希
+     * @param target 请求目标（路径加查询字符串），ETag只在同一资源内唯一
+     * @param body 响应体
+     */
+    static std::string MakeKey(std::string_view encoding, std::string_view etag,
+                               std::string_view target, std::string_view body);
+
+    std::shared_ptr<const std::string> Get(const std::string& key);
+    void Put(const std::string& key, std::shared_ptr<const std::string> data);
+    void Clear();
+
+    size_t GetBytes() const;
+    size_t GetEntries() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const std::string> data;
+    };
+
+    void EvictLocked();
+
+    size_t max_bytes_;
+    size_t bytes_ = 0;
+    std::list<Entry> lru_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace http
+} // namespace network
+} // namespace common
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace common {
+namespace network {
+namespace http {
+
+/**
+ * @brief Type of a value in an HttpJsonDocument
+ */
+enum class HttpJsonType {
+    MISSING,        // no value at the pointer (or the document is invalid)
+    NULL_VALUE,
+    BOOLEAN,
+    NUMBER,
+    STRING,
+    ARRAY,
+    OBJECT
+};
+
+/**
+ * @brief Read-only parsed JSON body
+ *
+ * Values are addressed with JSON Pointers (RFC 6901): "" is the root,
+ * "/user/name" a member, "/items/0" an array element. When the library is
+ * built with simdjson the document is parsed by its SIMD parser into a
+ * compact tape; otherwise it wraps an nlohmann::json tree. Use ToJson() to
+ * get a mutable nlohmann::json copy of any subtree.
+ *
+ * A document never changes after parsing, so it may be read from several
+ * threads. String views returned by GetString stay valid as long as the
+ * document is alive.
+ */
+class HttpJsonDocument {
+public:
+    ~HttpJsonDocument();
+
+    HttpJsonDocument(const HttpJsonDocument&) = delete;
+    HttpJsonDocument& operator=(const HttpJsonDocument&) = delete;
+
+    /**
+     * @brief Parse text with the fastest available backend; check IsValid() on the result
+     */
+    static std::shared_ptr<const HttpJsonDocument> Parse(std::string_view text);
+
+    /**
+     * @brief Backend used by Parse: "simdjson" or "nlohmann"
+     */
+    static const char* GetBackend();
+
+    bool IsValid() const;
+    const std::string& GetError() const;
+
+    HttpJsonType GetType(std::string_view pointer = "") const;
+    bool Has(std::string_view pointer) const { return GetType(pointer) != HttpJsonType::MISSING; }
+
+    // Typed access, nullopt when the value is missing or has another type
+    std::optional<std::string_view> GetString(std::string_view pointer) const;
+    std::optional<int64_t> GetInt(std::string_view pointer) const;
+    std::optional<double> GetDouble(std::string_view pointer) const;
+    std::optional<bool> GetBool(std::string_view pointer) const;
+
+    /**
+     * @brief Number of elements of an array or members of an object, 0 otherwise
+     */
+    size_t GetSize(std::string_view pointer = "") const;
+
+    /**
+     * @brief Mutable copy of a subtree, null when the value is missing
+     */
+    nlohmann::json ToJson(std::string_view pointer = "") const;
+
+private:
+    friend class HttpJsonCache;
+
+    struct Impl;
+
+    HttpJsonDocument();
+
+    // The whole document as an nlohmann tree; shared instead of copied for the nlohmann backend
+    std::shared_ptr<const nlohmann::json> ToSharedJson() const;
+
+    std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * @brief Parse-once cache of a message's JSON body
+ *
+ * Holds the nlohmann tree and/or the read-only document; each is built on
+ * first use, from the other one when that already exists, so a body is
+ * parsed at most once however many middlewares and handlers inspect it.
+ * The owning message resets the cache whenever its body changes. Copies of
+ * a message share the cached trees.
+ */
+class HttpJsonCache {
+public:
+    /**
+     * @brief Parsed body, null when the body is not valid JSON
+     */
+    const nlohmann::json& Get(std::string_view body) const;
+
+    std::shared_ptr<const HttpJsonDocument> GetDocument(std::string_view body) const;
+
+    void Reset() {
+        json_.reset();
+        document_.reset();
+        json_valid_ = false;
+    }
+
+private:
+    mutable std::shared_ptr<const nlohmann::json> json_;
+    mutable std::shared_ptr<const HttpJsonDocument> document_;
+    mutable bool json_valid_ = false;
+};
+
+/**
+ * @brief Object key escaped and quoted once, for keys written many times
+ *
+ *     static const HttpJsonKey kId("id");
+ *     writer.Key(kId).Int(player.id);
+ */
+class HttpJsonKey {
+public:
+    explicit HttpJsonKey(std::string_view key);
+
+    // Quoted key followed by ':'
+    const std::string& GetRendered() const { return rendered_; }
+
+private:
+    std::string rendered_;
+};
+
+/**
+ * @brief Streaming JSON serializer, writes text directly without building a DOM
+ *
+ * Appends to an external string (e.g. a response body) or to an internal
+ * buffer that Take() hands out piece by piece for chunked responses. The
+ * caller is responsible for a well-formed sequence of calls; separators are
+ * inserted automatically. Strings are escaped but not UTF-8 validated,
+ * non-finite doubles are written as null.
+ *
+ *     writer.BeginObject()
+ *           .Member("count", items.size())
+ *           .Key("items").BeginArray();
+ *     for (const auto& item : items) {
+ *         writer.BeginObject().Member(kId, item.id).Member(kName, item.name).EndObject();
+ *     }
+ *     writer.EndArray().EndObject();
+ */
+class HttpJsonWriter {
+public:
+    /**
+     * @brief Write into an internal buffer, see Take()
+     */
+    HttpJsonWriter() : out_(&buffer_) {}
+
+    /**
+     * @brief Append to out, which must outlive the writer
+     */
+    explicit HttpJsonWriter(std::string& out) : out_(&out) {}
+
+    HttpJsonWriter(const HttpJsonWriter&) = delete;
+    HttpJsonWriter& operator=(const HttpJsonWriter&) = delete;
+
+    // Structure
+    HttpJsonWriter& BeginObject() { Open('{'); return *this; }
+    HttpJsonWriter& EndObject() { Close('}'); return *this; }
+    HttpJsonWriter& BeginArray() { Open('['); return *this; }
+    HttpJsonWriter& EndArray() { Close(']'); return *this; }
+
+    HttpJsonWriter& Key(std::string_view key);
+    HttpJsonWriter& Key(const HttpJsonKey& key) {
+        Separate();
+        out_->append(key.GetRendered());
+        need_comma_ = false;
+        return *this;
+    }
+
+    // Scalars
+    HttpJsonWriter& Null() { Separate(); out_->append("null", 4); return *this; }
+    HttpJsonWriter& Bool(bool value) {
+        Separate();
+        value ? out_->append("true", 4) : out_->append("false", 5);
+        return *this;
+    }
+    HttpJsonWriter& Int(int64_t value) { Separate(); AppendNumber(value); return *this; }
+    HttpJsonWriter& Uint(uint64_t value) { Separate(); AppendNumber(value); return *this; }
+    HttpJsonWriter& Double(double value);
+    HttpJsonWriter& String(std::string_view value);
+
+    /**
+     * @brief Insert already serialized JSON text as one value
+     */
+    HttpJsonWriter& Raw(std::string_view json) { Separate(); out_->append(json); return *this; }
+
+    /**
+     * @brief Insert a DOM value (serialized with nlohmann::json::dump)
+     */
+    HttpJsonWriter& Json(const nlohmann::json& json) { return Raw(json.dump()); }
+
+    /**
+     * @brief Write any supported value: bool, integers, floating point, strings, nullptr, nlohmann::json
+     */
+    template <typename T>
+    HttpJsonWriter& Value(const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            return Bool(value);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            return Int(value);
+        } else if constexpr (std::is_integral_v<T>) {
+            return Uint(value);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            return Double(static_cast<double>(value));
+        } else if constexpr (std::is_same_v<T, std::nullptr_t>) {
+            return Null();
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            return String(value);
+        } else {
+            return Json(nlohmann::json(value));
+        }
+    }
+
+    template <typename T>
+    HttpJsonWriter& Member(std::string_view key, const T& value) { return Key(key).Value(value); }
+
+    template <typename T>
+    HttpJsonWriter& Member(const HttpJsonKey& key, const T& value) { return Key(key).Value(value); }
+
+    /**
+     * @brief Hand out everything written so far and continue with an empty buffer
+     */
+    std::string Take() {
+        std::string chunk;
+        chunk.swap(*out_);
+        return chunk;
+    }
+
+    void Reserve(size_t bytes) { out_->reserve(out_->size() + bytes); }
+
+    // Bytes currently in the buffer (not yet taken)
+    size_t GetSize() const { return out_->size(); }
+
+    // Nesting depth; 0 once the top-level value is complete
+    size_t GetDepth() const { return stack_.size(); }
+
+private:
+    void Separate() {
+        if (need_comma_) {
+            out_->push_back(',');
+        }
+        need_comma_ = true;
+    }
+
+    void Open(char bracket) {
+        Separate();
+        out_->push_back(bracket);
+        stack_.push_back(bracket);
+        need_comma_ = false;
+    }
+
+    void Close(char bracket) {
+        out_->push_back(bracket);
+        if (!stack_.empty()) {
+            stack_.pop_back();
+        }
+        need_comma_ = true;
+    }
+
+    template <typename Integer>
+    void AppendNumber(Integer value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        out_->append(digits, static_cast<size_t>(result.ptr - digits));
+    }
+
+    std::string buffer_;
+    std::string* out_;
+    std::vector<char> stack_;
+    bool need_comma_ = false;
+};
+
+/**
+ * @brief Callback that writes a complete JSON value
+ */
+using HttpJsonBuilder = std::function<void(HttpJsonWriter& writer)>;
+
+} // namespace http
+} // namespace network
+} // namespace common
@@ -1,8 +1,13 @@
 #pragma once
 
 #include "http_common.h"
+#include "http_json.h"
 #include <boost/beast/http.hpp>
 #include <nlohmann/json.hpp>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <string_view>
 
 namespace common {
 namespace network {
@@ -36,6 +41,145 @@ struct HttpFormField {
         : name(field_name), value(field_value) {}
 };
 
+/**
+ * @brief Byte range of a file sent as the response body
+ *
+ * The server session writes the range straight from the file (sendfile on
+ * plain TCP connections) instead of copying it into the string body.
+ */
+struct HttpFileRange {
+    std::string path;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+/**
+ * @brief Request body produced piece by piece while it is being sent
+ *
+ * Used for bodies that should not be held in memory as a whole, e.g. uploads
+ * of files from disk (see HttpMultipartWriter). A stream is consumed by one
+ * send at a time; HttpClient rewinds it before every attempt.
+ */
+class HttpBodyStream {
+public:
+    virtual ~HttpBodyStream() = default;
+    
+    /**
+     * @brief Total body size, or nullopt when unknown (sent chunked)
+     */
+    virtual std::optional<uint64_t> Size() const = 0;
+    
+    /**
+     * @brief Replace chunk with the next piece of the body
+     * @return false when the body is complete (chunk empty) or on error (ec set)
+     */
+    virtual bool Read(std::string& chunk, boost::system::error_code& ec) = 0;
+    
+    /**
+     * @brief Restart from the first byte; false if the body cannot be produced again
+     */
+    virtual bool Rewind() = 0;
+};
+
+/**
+ * @brief Sequential chunk reads from a file for streamed request bodies
+ *
+ * Shared by HttpFileBodyStream and HttpMultipartWriter. Both announce the file
+ * size in Content-Length before sending, so a file that has shrunk since is
+ * reported as an I/O error rather than sent short.
+ */
+class HttpFileChunkReader {
+public:
+    HttpFileChunkReader();
+    ~HttpFileChunkReader();
+    
+    /**
+     * @brief Append the next n bytes of path to out
+     *
+     * The first call opens the file at offset; later calls continue where the
+     * previous one stopped until Close.
+     * @return false with ec set (and out unchanged) when the file cannot be opened or ends early
+     */
+    bool Append(const std::string& path, uint64_t offset, size_t n, std::string& out, boost::system::error_code& ec);
+    
+    void Close();
+
+private:
+    std::unique_ptr<std::ifstream> file_;
+};
+
+/**
+ * @brief Request body read from a file (or a byte range of it) while it is sent
+ *
+ * Only the path and size are recorded up front; the bytes are read in chunks
+ * during the send, so uploading a large file never holds it in memory. The
+ * file must not shrink before the send completes.
+ */
+class HttpFileBodyStream : public HttpBodyStream {
+public:
+    /**
+     * @brief Stream bytes [offset, offset + length) of path, to the end of the file when length is nullopt
+     * @return nullptr if path is not a regular file or the range lies outside it
+     */
+    static std::shared_ptr<HttpFileBodyStream> Open(const std::string& path, uint64_t offset = 0,
+                                                    std::optional<uint64_t> length = std::nullopt,
+                                                    size_t chunk_size = 64 * 1024);
+    
+    ~HttpFileBodyStream() override;
+    
+    const std::string& GetPath() const { return path_; }
+    
+    std::optional<uint64_t> Size() const override { return length_; }
+    bool Read(std::string& chunk, boost::system::error_code& ec) override;
+    bool Rewind() override;
+
+private:
+    HttpFileBodyStream(std::string path, uint64_t offset, uint64_t length, size_t chunk_size);
+    
+    std::string path_;
+    uint64_t offset_;
+    uint64_t length_;
+    size_t chunk_size_;
+    uint64_t position_ = 0;                 // bytes of the range already read
+    HttpFileChunkReader reader_;
+};
+
+class HttpResponse;
+
+/**
+ * @brief Destination for a response body written piece by piece as it arrives
+ *
+ * Set on a request with HttpRequest::SetResponseSink, e.g. to save a large
+ * download to disk without holding it in memory. HttpClient passes the
+ * response header to Open; when the sink accepts it, the body goes to Write
+ * and the response handed to the callback has headers only. Declined
+ * responses (typically errors) are buffered in the body as usual.
+ *
+ * A sink takes one response at a time, so requests with a sink are never
+ * hedged or retried by HttpClient. After a failed transfer the next Open
+ * starts over.
+ */
+class HttpResponseSink {
+public:
+    virtual ~HttpResponseSink() = default;
+    
+    /**
+     * @brief Start receiving a response
+     * @return false to keep the body in the HttpResponse instead, or on error (ec set, the request fails)
+     */
+    virtual bool Open(const HttpResponse& response, boost::system::error_code& ec) = 0;
+    
+    /**
+     * @brief Next piece of the body; false on error (ec set)
+     */
+    virtual bool Write(std::string_view data, boost::system::error_code& ec) = 0;
+    
+    /**
+     * @brief The whole body has been written; false on error (ec set)
+     */
+    virtual bool Close(boost::system::error_code& ec) = 0;
+};
+
 /**
  * @brief HTTP request class
  */
@@ -87,47 +231,90 @@ public:
     void SetMethod(const std::string& method) { method_ = HttpUtils::StringToMethod(method); }
     
     const HttpUrl& GetUrl() const { return url_; }
-    void SetUrl(const std::string& url) { url_ = HttpUrl(url); }
-    void SetUrl(const HttpUrl& url) { url_ = url; }
+    void SetUrl(const std::string& url) { url_ = HttpUrl(url); scratch_.params.reset(); }
+    void SetUrl(const HttpUrl& url) { url_ = url; scratch_.params.reset(); }
     
     // HTTP version
     HttpVersion GetVersion() const { return version_; }
     void SetVersion(HttpVersion version) { version_ = version; }
     
-    // Headers
-    const HttpHeaders& GetHeaders() const { return headers_; }
-    void SetHeaders(const HttpHeaders& headers) { headers_ = headers; }
-    void SetHeader(const std::string& name, const std::string& value) { headers_[name] = value; }
+    // Headers (names are case-insensitive)
+    const HttpFields& GetHeaders() const { return headers_; }
+    HttpFields& GetHeaders() { return headers_; }
+    void SetHeaders(const HttpHeaders& headers);
+    void SetHeaders(HttpFields&& headers) { headers_ = std::move(headers); }
+    void SetHeader(const std::string& name, const std::string& value) { headers_.set(name, value); }
     std::string GetHeader(const std::string& name) const;
+    std::string_view GetHeaderView(std::string_view name) const;
     bool HasHeader(const std::string& name) const;
     void RemoveHeader(const std::string& name);
     
-    // Query parameters
-    const HttpParams& GetParams() const { return params_; }
-    void SetParams(const HttpParams& params) { params_ = params; }
-    void SetParam(const std::string& name, const std::string& value) { params_[name] = value; }
+    // Query parameters (requests parsed by the server decode the query on first use)
+    const HttpParams& GetParams() const { EnsureParams(); return params_; }
+    void SetParams(const HttpParams& params) { params_ = params; query_pending_ = false; }
+    void SetParam(const std::string& name, const std::string& value) { EnsureParams(); params_[name] = value; }
     std::string GetParam(const std::string& name) const;
     bool HasParam(const std::string& name) const;
     void RemoveParam(const std::string& name);
     
-    // Cookies
-    const std::vector<HttpCookie>& GetCookies() const { return cookies_; }
-    void SetCookies(const std::vector<HttpCookie>& cookies) { cookies_ = cookies; }
-    void AddCookie(const HttpCookie& cookie) { cookies_.push_back(cookie); }
-    void AddCookie(const std::string& name, const std::string& value) { cookies_.emplace_back(name, value); }
+    // Path parameters (filled by the server router, e.g. {id} in /users/{id})
+    const HttpParams& GetPathParams() const { return path_params_; }
+    void SetPathParam(const std::string& name, const std::string& value) { path_params_[name] = value; }
+    std::string GetPathParam(const std::string& name) const;
+
+    // Peer address of the connection (filled by the server, without port)
+    const std::string& GetRemoteAddress() const { return remote_address_; }
+    void SetRemoteAddress(const std::string& address) { remote_address_ = address; }
+
+    /**
+     * @brief Scratch memory for the current request
+     *
+     * On the server this is the connection's HttpArena, released after the response is
+     * written; anything allocated from it must not outlive the request. Requests built
+     * elsewhere fall back to the default heap resource, and so do copies, since a copy
+     * may outlive the request it was taken from. Changing the arena drops the views
+     * parsed into the previous one, so clear it before releasing that arena.
+     */
+    std::pmr::memory_resource* GetArena() const { return scratch_.arena ? scratch_.arena : std::pmr::get_default_resource(); }
+    void SetArena(std::pmr::memory_resource* arena) { scratch_.Clear(); scratch_.arena = arena; }
+
+    // Cookies (requests parsed by the server split the Cookie header on first use)
+    const std::vector<HttpCookie>& GetCookies() const { EnsureCookies(); return cookies_; }
+    void SetCookies(const std::vector<HttpCookie>& cookies) { cookies_ = cookies; cookies_pending_ = false; }
+    void AddCookie(const HttpCookie& cookie) { EnsureCookies(); cookies_.push_back(cookie); }
+    void AddCookie(const std::string& name, const std::string& value) { EnsureCookies(); cookies_.emplace_back(name, value); }
+
+    /**
+     * @brief Look up a cookie value; the view is valid until the cookies are modified
+     */
+    std::string_view GetCookieView(std::string_view name) const;
     
     // Body content
     HttpBodyType GetBodyType() const { return body_type_; }
     
-    const std::string& GetBody() const { return body_; }
+    const std::string& GetBody() const { EnsureMultipartBody(); return body_; }
     void SetBody(const std::string& body, const std::string& content_type = "");
     void SetBody(std::string&& body, const std::string& content_type = "");
     void SetBody(const std::vector<uint8_t>& body, const std::string& content_type = "application/octet-stream");
     
-    // JSON body
+    // JSON body (parsed on first use and cached until the body changes)
     void SetJsonBody(const nlohmann::json& json);
     void SetJsonBody(const std::string& json);
-    nlohmann::json GetJsonBody() const;
+    
+    /**
+     * @brief Parsed body, null when the body is not valid JSON; copy it to modify
+     */
+    const nlohmann::json& GetJsonBody() const { return json_cache_.Get(GetBody()); }
+    
+    /**
+     * @brief Serialize the body with a streaming writer instead of building a DOM
+     */
+    void WriteJsonBody(const HttpJsonBuilder& build, size_t reserve = 0);
+    
+    /**
+     * @brief Read-only parsed body (SIMD parser when available), cheaper than GetJsonBody for lookups
+     */
+    std::shared_ptr<const HttpJsonDocument> GetJsonDocument() const { return json_cache_.GetDocument(GetBody()); }
     
     // Form data
     void SetFormData(const HttpParams& form_data);
@@ -136,11 +323,28 @@ public:
     // Multipart form data
     void SetMultipartForm(const std::vector<HttpFormField>& fields);
     const std::vector<HttpFormField>& GetMultipartForm() const { return multipart_fields_; }
-    void AddFormField(const HttpFormField& field) { multipart_fields_.push_back(field); }
+    void AddFormField(const HttpFormField& field);
     void AddFormField(const std::string& name, const std::string& value);
     void AddFileField(const std::string& name, const std::string& filename, 
                      const std::string& content, const std::string& content_type = "");
     
+    /**
+     * @brief Send the body from a stream instead of body_ (body type STREAM)
+     *
+     * Copies of the request share the stream. Content-Length is taken from
+     * HttpBodyStream::Size(), an unknown size is sent with chunked encoding.
+     */
+    void SetBodyStream(std::shared_ptr<HttpBodyStream> stream, const std::string& content_type = "");
+    const std::shared_ptr<HttpBodyStream>& GetBodyStream() const { return body_stream_; }
+    
+    /**
+     * @brief Stream the response body into sink instead of HttpResponse::GetBody (see HttpResponseSink)
+     *
+     * Copies of the request share the sink. Ignored for HEAD requests.
+     */
+    void SetResponseSink(std::shared_ptr<HttpResponseSink> sink) { response_sink_ = std::move(sink); }
+    const std::shared_ptr<HttpResponseSink>& GetResponseSink() const { return response_sink_; }
+    
     // Content properties
     size_t GetContentLength() const;
     std::string GetContentType() const;
@@ -162,22 +366,63 @@ public:
     
     static HttpRequest FromBeastRequest(const boost::beast::http::request<boost::beast::http::string_body>& beast_req);
     
+    /**
+     * @brief Take over a parsed Beast request: header fields and body are moved, not copied
+     */
+    static HttpRequest FromBeastRequest(boost::beast::http::request<boost::beast::http::string_body>&& beast_req);
+    
+    /**
+     * @brief Build a request from a parsed header only (streamed bodies are read separately)
+     */
+    static HttpRequest FromBeastHeader(const boost::beast::http::request_header<>& header);
+    
 private:
     void UpdateBodyFromMultipart();
     void UpdateBodyFromFormData();
+    void EnsureMultipartBody() const;
     std::string GenerateMultipartBody() const;
+    void EnsureParams() const;
+    void EnsureCookies() const;
+    const HttpArenaParams& GetQueryViews() const;
+    const HttpCookieViews& GetCookieViews() const;
+    
+    // Arena plus the pending query/cookies parsed into it once by the lookups above. Copies
+    // drop the arena; neither copies nor moves keep the views, which point into the arena
+    // and into cookie_header_ (whose characters move with a short string).
+    struct Scratch {
+        std::pmr::memory_resource* arena = nullptr;
+        mutable std::optional<HttpArenaParams> params;
+        mutable std::optional<HttpCookieViews> cookies;
+        
+        Scratch() = default;
+        Scratch(const Scratch&) {}
+        Scratch(Scratch&& other) noexcept : arena(other.arena) { other.Clear(); }
+        Scratch& operator=(const Scratch&) { Clear(); arena = nullptr; return *this; }
+        Scratch& operator=(Scratch&& other) noexcept { Clear(); arena = other.arena; other.Clear(); return *this; }
+        void Clear() { params.reset(); cookies.reset(); }
+    };
     
     HttpMethod method_ = HttpMethod::GET;
     HttpUrl url_;
     HttpVersion version_ = HttpVersion::HTTP_1_1;
-    HttpHeaders headers_;
-    HttpParams params_;
-    std::vector<HttpCookie> cookies_;
+    HttpFields headers_;
+    mutable HttpParams params_;
+    HttpParams path_params_;
+    mutable std::vector<HttpCookie> cookies_;
+    std::string cookie_header_;             // raw Cookie header while cookies_pending_
+    mutable bool query_pending_ = false;    // params_ not yet decoded from url_.query
+    mutable bool cookies_pending_ = false;  // cookies_ not yet split from cookie_header_
+    std::string remote_address_;
+    Scratch scratch_;
     
     HttpBodyType body_type_ = HttpBodyType::EMPTY;
-    std::string body_;
+    mutable std::string body_;
     std::vector<HttpFormField> multipart_fields_;
     std::string multipart_boundary_;
+    mutable bool multipart_pending_ = false;  // body_ not yet rendered from multipart_fields_
+    std::shared_ptr<HttpBodyStream> body_stream_;
+    std::shared_ptr<HttpResponseSink> response_sink_;
+    HttpJsonCache json_cache_;
 };
 
 /**
@@ -231,11 +476,14 @@ public:
     HttpVersion GetVersion() const { return version_; }
     void SetVersion(HttpVersion version) { version_ = version; }
     
-    // Headers
-    const HttpHeaders& GetHeaders() const { return headers_; }
-    void SetHeaders(const HttpHeaders& headers) { headers_ = headers; }
-    void SetHeader(const std::string& name, const std::string& value) { headers_[name] = value; }
+    // Headers (names are case-insensitive)
+    const HttpFields& GetHeaders() const { return headers_; }
+    HttpFields& GetHeaders() { return headers_; }
+    void SetHeaders(const HttpHeaders& headers);
+    void SetHeaders(HttpFields&& headers) { headers_ = std::move(headers); }
+    void SetHeader(const std::string& name, const std::string& value) { headers_.set(name, value); }
     std::string GetHeader(const std::string& name) const;
+    std::string_view GetHeaderView(std::string_view name) const;
     bool HasHeader(const std::string& name) const;
     void RemoveHeader(const std::string& name);
     
@@ -253,10 +501,24 @@ public:
     void SetBody(std::string&& body, const std::string& content_type = "text/plain");
     void SetBody(const std::vector<uint8_t>& body, const std::string& content_type = "application/octet-stream");
     
-    // JSON body
+    // JSON body (parsed on first use and cached until the body changes)
     void SetJsonBody(const nlohmann::json& json);
     void SetJsonBody(const std::string& json);
-    nlohmann::json GetJsonBody() const;
+    
+    /**
+     * @brief Parsed body, null when the body is not valid JSON; copy it to modify
+     */
+    const nlohmann::json& GetJsonBody() const { return json_cache_.Get(GetBody()); }
+    
+    /**
+     * @brief Serialize the body with a streaming writer instead of building a DOM
+     */
+    void WriteJsonBody(const HttpJsonBuilder& build, size_t reserve = 0);
+    
+    /**
+     * @brief Read-only parsed body (SIMD parser when available), cheaper than GetJsonBody for lookups
+     */
+    std::shared_ptr<const HttpJsonDocument> GetJsonDocument() const { return json_cache_.GetDocument(GetBody()); }
     
     // HTML body
     void SetHtmlBody(const std::string& html);
@@ -264,6 +526,16 @@ public:
     // File response
     void SetFileBody(const std::string& file_path);
     
+    // Zero-copy file response (any body setter discards it)
+    void SetFileRange(const std::string& file_path, uint64_t offset, uint64_t length);
+    const std::optional<HttpFileRange>& GetFileRange() const { return file_range_; }
+    bool HasFileRange() const { return file_range_.has_value(); }
+    void ClearFileRange() { file_range_.reset(); }
+    
+    // Streamed response: the body is written by a stream handler after the middleware chain
+    void SetStreaming(bool streaming) { streaming_ = streaming; }
+    bool IsStreaming() const { return streaming_; }
+    
     // Content properties
     size_t GetContentLength() const;
     std::string GetContentType() const;
@@ -286,6 +558,25 @@ public:
     boost::beast::http::response<Body> ToBeastResponse() const;
     
     static HttpResponse FromBeastResponse(const boost::beast::http::response<boost::beast::http::string_body>& beast_resp);
+    static HttpResponse FromBeastResponse(boost::beast::http::response<boost::beast::http::string_body>&& beast_resp);
+    
+    /**
+     * @brief Build a response from a parsed header only (streamed bodies are read separately)
+     */
+    static HttpResponse FromBeastHeader(const boost::beast::http::response_header<>& header);
+    
+    /**
+     * @brief Move status, header fields, cookies and body into a Beast response
+     *
+     * Leaves this response without headers and body. Used by the server
+     * session so the response is never copied on its way to the socket.
+     */
+    void MoveToBeastResponse(boost::beast::http::response<boost::beast::http::string_body>& beast_resp);
+    
+    /**
+     * @brief Move header fields and cookies into a Beast field container
+     */
+    void MoveHeadersTo(HttpFields& fields);
     
     // Convenience factory methods
     static HttpResponse Ok(const std::string& body = "", const std::string& content_type = "text/plain");
@@ -297,6 +588,7 @@ public:
     static HttpResponse NotFound(const std::string& message = "Not Found");
     static HttpResponse InternalServerError(const std::string& message = "Internal Server Error");
     static HttpResponse Json(const nlohmann::json& json, HttpStatusCode status = HttpStatusCode::OK);
+    static HttpResponse Json(const HttpJsonBuilder& build, HttpStatusCode status = HttpStatusCode::OK);
     static HttpResponse Html(const std::string& html, HttpStatusCode status = HttpStatusCode::OK);
     static HttpResponse Redirect(const std::string& location, HttpStatusCode status = HttpStatusCode::FOUND);
     
@@ -304,9 +596,12 @@ private:
     HttpStatusCode status_code_ = HttpStatusCode::OK;
     std::string reason_phrase_;
     HttpVersion version_ = HttpVersion::HTTP_1_1;
-    HttpHeaders headers_;
+    HttpFields headers_;
     std::vector<HttpCookie> cookies_;
     std::string body_;
+    std::optional<HttpFileRange> file_range_;
+    bool streaming_ = false;
+    HttpJsonCache json_cache_;
 };
 
 // Template implementations
@@ -322,7 +617,7 @@ boost::beast::http::request<Body> HttpRequest::ToBeastRequest() const {
     if (!url_.query.empty()) {
         target += "?" + url_.query;
     }
-    if (!params_.empty()) {
+    if (!query_pending_ && !params_.empty()) {
         std::string query = HttpUtils::BuildQueryString(params_);
         if (!query.empty()) {
             target += (url_.query.empty() ? "?" : "&") + query;
@@ -334,16 +629,19 @@ boost::beast::http::request<Body> HttpRequest::ToBeastRequest() const {
     req.version(version_ == HttpVersion::HTTP_1_0 ? 10 : 11);
     
     // Set headers
-    for (const auto& [name, value] : headers_) {
-        req.set(name, value);
+    for (const auto& field : headers_) {
+        req.insert(field.name_string(), field.value());
     }
     
     // Set cookies
-    if (!cookies_.empty()) {
+    if (cookies_pending_) {
+        req.set(boost::beast::http::field::cookie, cookie_header_);
+    } else if (!cookies_.empty()) {
         req.set(boost::beast::http::field::cookie, HttpUtils::BuildCookieHeader(cookies_));
     }
     
     // Set body
+    EnsureMultipartBody();
     if (!body_.empty()) {
         if constexpr (std::is_same_v<Body, boost::beast::http::string_body>) {
             req.body() = body_;
@@ -365,8 +663,8 @@ boost::beast::http::response<Body> HttpResponse::ToBeastResponse() const {
     resp.version(version_ == HttpVersion::HTTP_1_0 ? 10 : 11);
     
     // Set headers
-    for (const auto& [name, value] : headers_) {
-        resp.set(name, value);
+    for (const auto& field : headers_) {
+        resp.insert(field.name_string(), field.value());
     }
     
     // Set cookies
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "http_common.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace common {
+namespace network {
+namespace http {
+
+/**
+ * @brief HDR风格的对数线性直方图桶布局
+ *
+ * 值按2的幂分段，每段再线性划分为2^SubBucketBits个桶，任意值的相对误差不超过2^-SubBucketBits。
+ * 小于2^SubBucketBits的值各占一个桶，不小于2^kMaxBits的值计入最后一个桶。
+ */
+template <int SubBucketBits>
+struct HttpLogLinearLayout {
+    static constexpr int kSubBucketBits = SubBucketBits;
+    static constexpr int kMaxBits = 40;        // 微秒约12.7天，字节1TB
+    static constexpr size_t kBucketCount = static_cast<size_t>(kMaxBits - kSubBucketBits + 1) << kSubBucketBits;
+
+    static size_t GetBucket(uint64_t value) {
+        constexpr uint64_t kSubBuckets = uint64_t(1) << kSubBucketBits;
+        if (value < kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        if (value >> kMaxBits) {
+            return kBucketCount - 1;
+        }
+
+        // 最高位决定分段，其后kSubBucketBits位决定段内位置
+        int msb = 63;
+        while (!(value >> msb)) {
+            --msb;
+        }
+        const int shift = msb - kSubBucketBits;
+        return (static_cast<size_t>(shift + 1) << kSubBucketBits) +
+               static_cast<size_t>((value >> shift) & (kSubBuckets - 1));
+    }
+
+    /**
+     * @brief 桶内最大值（含）
+     */
+    static uint64_t GetUpperBound(size_t bucket) {
+        constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+        if (bucket < kSubBuckets) {
+            return bucket;
+        }
+        const int shift = static_cast<int>(bucket >> kSubBucketBits) - 1;
+        const uint64_t base = static_cast<uint64_t>(kSubBuckets + (bucket & (kSubBuckets - 1))) << shift;
+        return base + (uint64_t(1) << shift) - 1;
+    }
+
+    /**
+     * @brief 按桶计数求百分位数（0-100），返回所在桶的上界且不超过max，落在溢出桶时返回max
+     */
+    static uint64_t GetPercentile(const std::vector<uint64_t>& buckets, uint64_t count, uint64_t max,
+                                  double percentile) {
+        if (count == 0) {
+            return 0;
+        }
+
+        const double clamped = std::clamp(percentile, 0.0, 100.0);
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * count)));
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            cumulative += buckets[i];
+            if (cumulative >= rank) {
+                return i + 1 == kBucketCount ? max : std::min(GetUpperBound(i), max);
+            }
+        }
+        return max;
+    }
+};
+
+// 服务端按路由和状态类保存直方图，只保留1/8精度以控制内存
+using HttpHistogramLayout = HttpLogLinearLayout<3>;
+
+/**
+ * @brief 直方图快照
+ */
+struct HttpHistogramSnapshot {
+    std::vector<uint64_t> buckets;             // 各桶计数，无数据时为空
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    void Merge(const HttpHistogramSnapshot& other);
+
+    /**
+     * @brief 百分位数（0-100），返回所在桶的上界且不超过max
+     */
+    uint64_t GetPercentile(double percentile) const;
+
+    double GetMean() const { return count > 0 ? static_cast<double>(sum) / count : 0.0; }
+};
+
+/**
+ * @brief 单个路由的指标快照
+ */
+struct HttpRouteMetrics {
+    std::string method;
+    std::string pattern;                                   // 路由模式（非原始路径），特殊路由见HttpServerMetrics
+    int64_t in_flight = 0;                                 // 处理中的请求数
+    std::array<HttpHistogramSnapshot, 5> latency_us;       // 处理耗时（微秒），按状态类1xx-5xx
+    HttpHistogramSnapshot request_bytes;                   // 请求体大小
+    HttpHistogramSnapshot response_bytes;                  // 响应体大小
+
+    uint64_t GetRequestCount() const;
+    HttpHistogramSnapshot GetLatency() const;              // 所有状态类合并
+};
+
+/**
+ * @brief HTTP服务端指标
+ *
+ * 按路由模式和状态类记录耗时直方图，以及请求/响应大小直方图和处理中请求数。
+ * 数据按线程分片：每个线程首次记录时分配一个分片，之后只写该分片的原子计数（relaxed），
+ * 不加锁，多个线程共用分片时计数仍然正确。各分片的路由数据在首次使用时分配，
+ * 内存只与实际访问的路由有关。读取时合并所有分片。
+ */
+class HttpServerMetrics {
+public:
+    static constexpr size_t kUnmatchedRoute = 0;   // 未匹配任何路由
+    static constexpr size_t kStaticRoute = 1;      // 静态文件
+    static constexpr size_t kOverflowRoute = 2;    // 超出max_routes的路由合并于此
+
+    /**
+     * @param max_routes 单独统计的路由数上限（含上述特殊路由）
+     * @param shard_count 分片数，0表示按CPU核数
+     */
+    explicit HttpServerMetrics(size_t max_routes = 1024, size_t shard_count = 0);
+    ~HttpServerMetrics();
+
+    HttpServerMetrics(const HttpServerMetrics&) = delete;
+    HttpServerMetrics& operator=(const HttpServerMetrics&) = delete;
+
+    /**
+     * @brief 注册路由，返回其指标编号，超出上限时返回kOverflowRoute
+     */
+    size_t RegisterRoute(const std::string& method, const std::string& pattern);
+
+    /**
+     * @brief 请求开始处理，与EndRequest成对调用
+     */
+    void BeginRequest(size_t route);
+
+    /**
+     * @brief 请求处理结束
+     */
+    void EndRequest(size_t route, HttpStatusCode status, std::chrono::microseconds latency,
+                    uint64_t request_bytes, uint64_t response_bytes);
+
+    /**
+     * @brief 有数据或有处理中请求的路由
+     */
+    std::vector<HttpRouteMetrics> GetSnapshot() const;
+
+    /**
+     * @brief 所有路由合并后的指标
+     */
+    HttpRouteMetrics GetTotal() const;
+
+    /**
+     * @brief 以Prometheus文本格式输出
+     *
+     * 耗时单位为秒。le计数由内部细粒度桶累加而成，只包含上界不超过该边界的桶，
+     * 跨越边界的桶整体计入下一个边界，因此每个le计数是“不超过边界的观测数”的下界：
+     * 漏计的只有落在边界以下最近一个桶内的观测（与边界相差不超过1/8）。
+     * 大小边界是2的幂，恰好等于边界的值所在的桶从边界开始，计入下一个边界。
+     */
+    std::string RenderPrometheus(const std::string& prefix = "zeus_http") const;
+
+private:
+    class Histogram;
+    struct RouteShard;
+    struct Shard;
+    struct RouteLabel {
+        std::string method;
+        std::string pattern;
+    };
+
+    Shard& GetShard();
+    RouteShard& GetRouteShard(size_t route);
+    static Histogram& GetHistogram(std::atomic<Histogram*>& slot);
+
+    size_t max_routes_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    mutable std::mutex labels_mutex_;
+    std::deque<RouteLabel> labels_;
+};
+
+} // namespace http
+} // namespace network
+} // namespace common
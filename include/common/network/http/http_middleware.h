@@ -2,6 +2,7 @@
 
 #include "http_common.h"
 #include "http_message.h"
+#include "http_compression.h"
 #include "../network_logger.h"
 #include <string>
 #include <vector>
@@ -10,7 +11,10 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <list>
 #include <regex>
 
 namespace common {
@@ -188,46 +192,88 @@ private:
 
 /**
  * @brief 速率限制中间件
+ *
+ * 使用滑动窗口近似计数：估算值 = 上一窗口计数 * 剩余比例 + 当前窗口计数。
+ * 计数表按键哈希分片，每个分片是固定容量的组相联表（每组kSlotsPerSet个槽位），
+ * 组满时按CLOCK（二次机会）淘汰，内存占用与键的数量无关。
+ * 表中只保存键的64位哈希，极少数哈希冲突的键会共享同一计数。
  */
 class RateLimitMiddleware : public HttpMiddlewareBase {
 public:
     struct RateLimitConfig {
-        size_t max_requests = 100;                    // 最大请求数
+        size_t max_requests = 100;                    // 最大请求数（0表示不限流）
         std::chrono::seconds window{60};              // 时间窗口
         std::string key_generator = "ip";             // 键生成策略 ("ip", "user", "custom")
         std::function<std::string(const HttpRequest&)> custom_key_generator; // 自定义键生成器
         bool skip_successful_requests = false;        // 跳过成功请求
         std::string message = "Too Many Requests";    // 限制消息
+        std::unordered_map<std::string, size_t> route_limits; // 路径前缀 -> 窗口内最大请求数（最长前缀优先，各路由单独计数，0表示该路由不限流）
+        size_t max_keys = 1024 * 1024;                // 跟踪的键数量上限
+        size_t shard_count = 64;                      // 分片数量
+        bool trust_forwarded_for = false;             // "ip"策略优先使用X-Forwarded-For中的客户端地址
+        size_t trusted_proxy_hops = 1;                // 服务前的可信代理层数，取X-Forwarded-For右起第N个地址
         
         RateLimitConfig() = default;
         static RateLimitConfig Default() { return RateLimitConfig{}; }
     };
     
+    struct RateLimitStats {
+        uint64_t allowed = 0;
+        uint64_t limited = 0;
+        uint64_t evictions = 0;
+        size_t tracked_keys = 0;
+        size_t capacity = 0;
+    };
+    
     explicit RateLimitMiddleware(const RateLimitConfig& config = RateLimitConfig::Default());
     void Handle(const HttpRequest& request, HttpResponse& response, std::function<void()> next) override;
+    
+    RateLimitStats GetStats() const;
 
 private:
-    struct RequestRecord {
-        std::chrono::steady_clock::time_point timestamp;
-        size_t count = 1;
+    static constexpr size_t kSlotsPerSet = 8;
+    
+    // 单个键的计数槽位，hash为0表示空槽位
+    struct Slot {
+        uint64_t hash = 0;
+        uint64_t window = 0;          // 当前窗口序号
+        uint32_t current = 0;         // 当前窗口计数
+        uint32_t previous = 0;        // 上一窗口计数
+        bool referenced = false;      // CLOCK引用位
+    };
+    
+    struct Shard {
+        mutable std::mutex mutex;
+        std::vector<Slot> slots;
+        size_t hand = 0;              // CLOCK指针（组内扫描起点）
+        size_t used = 0;
+        uint64_t allowed = 0;
+        uint64_t limited = 0;
+        uint64_t evictions = 0;
     };
     
     RateLimitConfig config_;
-    std::unordered_map<std::string, RequestRecord> request_records_;
-    std::mutex records_mutex_;
+    int64_t window_ms_;
+    size_t sets_per_shard_;
+    std::vector<std::unique_ptr<Shard>> shards_;
     
     std::string GenerateKey(const HttpRequest& request) const;
-    bool IsRateLimited(const std::string& key);
-    void CleanupExpiredRecords();
+    size_t GetLimit(const std::string& path, std::string* route) const;
+    Shard& GetShard(uint64_t hash);
+    Slot& FindSlotLocked(Shard& shard, uint64_t hash, uint64_t window);
+    bool IsRateLimited(uint64_t hash, size_t limit, int64_t* retry_after_ms, uint64_t* charged_window);
+    void Refund(uint64_t hash, uint64_t charged_window);
 };
 
 /**
  * @brief 压缩中间件
+ *
+ * 按encodings顺序选择客户端接受（q>0）且已编译支持的编码，压缩结果按ETag或响应体哈希缓存。
  */
 class CompressionMiddleware : public HttpMiddlewareBase {
 public:
     struct CompressionConfig {
-        std::vector<std::string> encodings = {"gzip", "deflate"}; // 支持的编码
+        std::vector<std::string> encodings = {"br", "gzip", "deflate"}; // 支持的编码（按优先级）
         size_t min_size = 1024;                                   // 最小压缩大小
         std::vector<std::string> mime_types = {                   // 压缩的MIME类型
             "text/html", "text/plain", "text/css", "text/javascript",
@@ -235,6 +281,7 @@ public:
         };
         std::unordered_set<std::string> excluded_paths;           // 排除的路径
         int compression_level = 6;                                // 压缩级别 (1-9)
+        size_t cache_max_bytes = 16 * 1024 * 1024;                // 压缩结果缓存容量，0表示不缓存
         
         CompressionConfig() = default;
         static CompressionConfig Default() { return CompressionConfig{}; }
@@ -245,10 +292,12 @@ public:
 
 private:
     CompressionConfig config_;
+    std::unique_ptr<HttpCompressionCache> cache_;
     
     bool ShouldCompress(const HttpRequest& request, const HttpResponse& response) const;
     std::string GetAcceptedEncoding(const HttpRequest& request) const;
-    std::vector<uint8_t> CompressData(const std::vector<uint8_t>& data, const std::string& encoding) const;
+    std::shared_ptr<const std::string> CompressBody(const HttpRequest& request, const HttpResponse& response,
+                                                    const std::string& encoding);
 };
 
 /**
@@ -277,6 +326,173 @@ private:
     void SetCacheHeaders(HttpResponse& response) const;
 };
 
+/**
+ * @brief ETag/条件GET中间件
+ *
+ * GET/HEAD的200响应按响应体的64位哈希生成强ETag（处理器已设置ETag时直接使用），
+ * If-None-Match匹配时改为304并丢弃响应体。为路径配置版本提供者后，在执行处理器之前
+ * 即可判断客户端副本是否仍然有效，有效时不执行处理器，响应体不会生成。
+ * 处理器也可调用CheckVersion自行提前返回。
+ */
+class EtagMiddleware : public HttpMiddlewareBase {
+public:
+    /**
+     * @brief 版本提供者，返回资源当前版本（如配置快照序号），返回空表示未知，此时按响应体哈希处理
+     */
+    using VersionProvider = std::function<std::string(const HttpRequest& request)>;
+    
+    struct EtagConfig {
+        std::unordered_map<std::string, VersionProvider> version_providers; // 路径前缀 -> 版本提供者（最长前缀优先）
+        std::unordered_set<std::string> excluded_paths;                     // 排除的路径
+        size_t max_body_size = 16 * 1024 * 1024;                            // 超过该大小的响应体不计算哈希
+        
+        EtagConfig() = default;
+        static EtagConfig Default() { return EtagConfig{}; }
+    };
+    
+    struct EtagStats {
+        uint64_t not_modified = 0;        // 返回304的请求
+        uint64_t handler_skipped = 0;     // 其中由版本提供者判定、未执行处理器的请求
+        uint64_t hashed_bytes = 0;        // 计算哈希的响应体字节数
+        uint64_t saved_bytes = 0;         // 304省去的响应体字节数（未执行处理器的请求不计）
+    };
+    
+    explicit EtagMiddleware(const EtagConfig& config = EtagConfig::Default());
+    void Handle(const HttpRequest& request, HttpResponse& response, std::function<void()> next) override;
+    
+    EtagStats GetStats() const;
+    
+    /**
+     * @brief 由版本号生成强ETag，版本号含ETag不允许的字符时使用其哈希
+     */
+    static std::string MakeEtag(std::string_view version);
+    
+    /**
+     * @brief 供处理器在生成响应体之前调用：按版本号设置ETag并检查If-None-Match
+     * @return 客户端副本仍有效时返回true，此时response已是304，处理器应直接返回
+     */
+    static bool CheckVersion(const HttpRequest& request, HttpResponse& response, std::string_view version);
+
+private:
+    bool IsApplicable(const HttpRequest& request) const;
+    const VersionProvider* FindProvider(const std::string& path) const;
+    static void SetNotModified(HttpResponse& response);
+    
+    EtagConfig config_;
+    std::atomic<uint64_t> not_modified_{0};
+    std::atomic<uint64_t> handler_skipped_{0};
+    std::atomic<uint64_t> hashed_bytes_{0};
+    std::atomic<uint64_t> saved_bytes_{0};
+};
+
+/**
+ * @brief 服务端响应缓存中间件
+ *
+ * - 缓存键：方法 + 路径 + 排序后的查询参数 + 配置的Vary请求头
+ * - 按键哈希分片的LRU，总容量按字节限制，每个分片独立加锁
+ * - 按路径前缀配置TTL，过期后在stale_while_revalidate窗口内继续返回旧响应
+ * - 同一键只有一个请求执行处理器：未命中时其余请求等待其结果；
+ *   过期时由第一个请求同步刷新，其余请求直接返回旧响应
+ *
+ * 中间件链是同步执行的，next()只能在当前请求内调用，因此刷新由选出的请求完成而非后台线程。
+ *
+ * 注意：合并等待会阻塞调用线程（即服务器的I/O线程）。每个等待者最多阻塞coalesce_timeout，
+ * 同一键同时阻塞的线程数不超过max_coalesced_waiters，超出的请求和等待超时的请求自行执行处理器。
+ * 默认值只用于吸收几十毫秒内的并发未命中；处理器较慢时应调小这两个值，
+ * 或将coalesce_timeout设为0关闭合并，避免I/O线程被占满。
+ */
+class ResponseCacheMiddleware : public HttpMiddlewareBase {
+public:
+    struct ResponseCacheConfig {
+        std::chrono::seconds default_ttl{10};                               // 默认TTL
+        std::unordered_map<std::string, std::chrono::seconds> route_ttls;   // 路径前缀 -> TTL（最长前缀优先，0表示不缓存）
+        std::chrono::seconds stale_while_revalidate{30};                    // 过期后可返回旧响应的时间
+        std::vector<std::string> vary_headers;                              // 参与缓存键的请求头
+        size_t max_bytes = 64 * 1024 * 1024;                                // 缓存总容量 (64MB)
+        size_t max_entry_size = 1024 * 1024;                                // 单个响应上限 (1MB)
+        size_t shard_count = 16;                                            // 分片数量
+        std::chrono::milliseconds coalesce_timeout{50};                     // 等待同键请求结果的最长时间（阻塞I/O线程，0表示不合并）
+        size_t max_coalesced_waiters = 4;                                   // 同一键最多同时等待的请求数
+        bool cache_authorized = false;                                      // 是否缓存带Authorization的请求
+        
+        ResponseCacheConfig() = default;
+        static ResponseCacheConfig Default() { return ResponseCacheConfig{}; }
+    };
+    
+    struct CacheStats {
+        uint64_t hits = 0;
+        uint64_t stale_hits = 0;
+        uint64_t misses = 0;
+        uint64_t coalesced = 0;
+        uint64_t coalesce_timeouts = 0;     // 等待超时后自行执行处理器的请求
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+    
+    explicit ResponseCacheMiddleware(const ResponseCacheConfig& config = ResponseCacheConfig::Default());
+    void Handle(const HttpRequest& request, HttpResponse& response, std::function<void()> next) override;
+    
+    CacheStats GetStats() const;
+    void Clear();
+
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    struct CachedResponse {
+        HttpStatusCode status_code = HttpStatusCode::OK;
+        HttpFields headers;
+        std::string body;
+        Clock::time_point stored_at;
+        Clock::time_point expires_at;
+        Clock::time_point stale_until;
+        size_t bytes = 0;
+    };
+    
+    // 正在执行处理器的请求，同键的其余请求在此等待
+    struct InFlight {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t waiters = 0;                 // 由分片锁保护
+        bool done = false;
+        std::shared_ptr<const CachedResponse> result;
+    };
+    
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const CachedResponse> response;
+        bool refreshing = false;
+    };
+    
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        std::unordered_map<std::string, std::shared_ptr<InFlight>> in_flight;
+        size_t bytes = 0;
+        uint64_t hits = 0;
+        uint64_t stale_hits = 0;
+        uint64_t misses = 0;
+        uint64_t coalesced = 0;
+        uint64_t coalesce_timeouts = 0;
+    };
+    
+    bool IsCacheableRequest(const HttpRequest& request) const;
+    std::string BuildKey(const HttpRequest& request) const;
+    std::chrono::seconds GetTtl(const std::string& path) const;
+    std::shared_ptr<const CachedResponse> Capture(const HttpResponse& response, std::chrono::seconds ttl) const;
+    void Serve(const CachedResponse& cached, HttpResponse& response, const char* cache_status) const;
+    
+    Shard& GetShard(const std::string& key);
+    void Complete(Shard& shard, const std::string& key, const std::shared_ptr<InFlight>& flight,
+                  std::shared_ptr<const CachedResponse> cached);
+    void StoreLocked(Shard& shard, const std::string& key, std::shared_ptr<const CachedResponse> cached);
+    void EvictLocked(Shard& shard);
+    
+    ResponseCacheConfig config_;
+    size_t shard_max_bytes_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
 /**
  * @brief 安全头中间件
  */
@@ -441,6 +657,16 @@ std::unique_ptr<RateLimitMiddleware> RateLimit(const RateLimitMiddleware::RateLi
  */
 std::unique_ptr<CompressionMiddleware> Compression(const CompressionMiddleware::CompressionConfig& config = CompressionMiddleware::CompressionConfig::Default());
 
+/**
+ * @brief 创建ETag/条件GET中间件
+ */
+std::unique_ptr<EtagMiddleware> Etag(const EtagMiddleware::EtagConfig& config = EtagMiddleware::EtagConfig::Default());
+
+/**
+ * @brief 创建服务端响应缓存中间件
+ */
+std::unique_ptr<ResponseCacheMiddleware> ResponseCache(const ResponseCacheMiddleware::ResponseCacheConfig& config = ResponseCacheMiddleware::ResponseCacheConfig::Default());
+
 /**
  * @brief 创建缓存中间件
  */
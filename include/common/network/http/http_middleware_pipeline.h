@@ -0,0 +1,124 @@
+#pragma once
+
+#include "http_common.h"
+#include "http_message.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace common {
+namespace network {
+namespace http {
+
+/**
+ * @brief 预编译的中间件链
+ *
+ * 路由注册时把全局中间件、路径中间件和路由处理器按执行顺序展开为数组，
+ * 请求处理时按下标依次调用，不再逐个请求收集中间件或复制处理器。
+ * 每一级的next只捕获一个栈上帧的引用，std::function可以内联保存，不分配堆内存。
+ * 无法在注册时确定是否匹配的路径中间件（路由模式含参数且前缀落在参数部分）保留路径前缀，
+ * 在请求时检查。路径前缀按路径段匹配：/api匹配/api和/api/items，不匹配/apix。
+ */
+class HttpMiddlewarePipeline {
+public:
+    /**
+     * @brief 追加一级处理器
+     * @param handler 中间件或路由处理器
+     * @param path_prefix 非空时仅在请求路径位于该前缀之下时执行（见HasPathPrefix）
+     */
+    void Append(HttpRequestHandler handler, std::string path_prefix = "");
+
+    void Clear() { stages_.clear(); }
+    size_t Size() const { return stages_.size(); }
+    bool Empty() const { return stages_.empty(); }
+
+    /**
+     * @brief 执行中间件链
+     */
+    void Run(const HttpRequest& request, HttpResponse& response) const;
+
+    /**
+     * @brief 路径中间件与路由模式的匹配关系
+     */
+    enum class PrefixMatch {
+        NEVER,      // 该路由的请求路径都不以此前缀开头
+        ALWAYS,     // 该路由的请求路径都以此前缀开头
+        RUNTIME     // 前缀落在参数或通配符部分，需按请求路径判断
+    };
+
+    /**
+     * @brief 判断路径中间件前缀与路由模式的匹配关系
+     */
+    static PrefixMatch MatchPrefix(std::string_view pattern, std::string_view prefix);
+
+    /**
+     * @brief 请求路径是否位于前缀之下：等于前缀，或前缀之后紧接'/'（前缀以'/'结尾时不要求）
+     */
+    static bool HasPathPrefix(std::string_view path, std::string_view prefix);
+
+private:
+    struct Stage {
+        HttpRequestHandler handler;
+        std::string path_prefix;
+    };
+
+    // next回调只捕获该帧的引用
+    struct Frame {
+        const HttpMiddlewarePipeline* pipeline;
+        const HttpRequest* request;
+        HttpResponse* response;
+        size_t index;
+    };
+
+    void Invoke(const Frame& frame) const;
+
+    std::vector<Stage> stages_;
+};
+
+/**
+ * @brief 编译期组合的中间件链
+ *
+ * 各级中间件的类型在编译期确定，next是直接调用下一级的lambda，不经过std::function。
+ * 中间件形如 void(const HttpRequest&, HttpResponse&, Next&& next)，Next为模板参数。
+ * 整条链本身也满足HttpRequestHandler的调用形式，可作为一级传给HttpServer::Use。
+ */
+template <typename... Stages>
+class HttpStaticMiddlewareChain {
+public:
+    explicit HttpStaticMiddlewareChain(Stages... stages) : stages_(std::move(stages)...) {}
+
+    template <typename Next>
+    void operator()(const HttpRequest& request, HttpResponse& response, Next&& next) const {
+        Invoke<0>(request, response, next);
+    }
+
+private:
+    template <size_t Index, typename Next>
+    void Invoke(const HttpRequest& request, HttpResponse& response, Next& next) const {
+        if constexpr (Index == sizeof...(Stages)) {
+            next();
+        } else {
+            std::get<Index>(stages_)(request, response, [this, &request, &response, &next]() {
+                Invoke<Index + 1>(request, response, next);
+            });
+        }
+    }
+
+    std::tuple<Stages...> stages_;
+};
+
+/**
+ * @brief 创建编译期组合的中间件链
+ */
+template <typename... Stages>
+HttpStaticMiddlewareChain<std::decay_t<Stages>...> MakeStaticMiddlewareChain(Stages&&... stages) {
+    return HttpStaticMiddlewareChain<std::decay_t<Stages>...>(std::forward<Stages>(stages)...);
+}
+
+} // namespace http
+} // namespace network
+} // namespace common
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "http_message.h"
+#include <boost/system/error_code.hpp>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace common {
+namespace network {
+namespace http {
+
+/**
+ * @brief Streaming multipart/form-data request body
+ *
+ * Each part's header block is rendered once when the part is added, so
+ * building an N-field form is linear. Files added with AddFileFromDisk are
+ * only recorded by path and size; their bytes are read in chunks while the
+ * body is sent, so uploading a large file never holds it in memory.
+ *
+ * The body size is known up front (sent with Content-Length). Files must not
+ * change size between being added and being sent; a file that became shorter
+ * fails the send.
+ */
+class HttpMultipartWriter : public HttpBodyStream {
+public:
+    /**
+     * @param boundary Delimiter between parts, generated when empty
+     * @param chunk_size Upper bound of the pieces returned by Read
+     */
+    explicit HttpMultipartWriter(std::string boundary = "", size_t chunk_size = 64 * 1024);
+
+    const std::string& GetBoundary() const { return boundary_; }
+
+    /**
+     * @brief Content-Type header value including the boundary
+     */
+    std::string GetContentType() const;
+
+    // Parts held in memory
+    void AddField(const std::string& name, std::string value, const std::string& content_type = "");
+    void AddFile(const std::string& name, const std::string& filename, std::string content,
+                 const std::string& content_type = "");
+    void AddPart(const HttpFormField& field);
+
+    /**
+     * @brief Add a file part streamed from disk during send
+     * @param filename Name reported to the server, defaults to the last path component
+     * @param content_type Defaults to the MIME type of filename
+     * @return false if the file does not exist or is not a regular file
+     */
+    bool AddFileFromDisk(const std::string& name, const std::string& path,
+                         const std::string& filename = "", const std::string& content_type = "");
+
+    size_t GetPartCount() const { return parts_.size(); }
+
+    // HttpBodyStream interface
+    std::optional<uint64_t> Size() const override { return size_; }
+    bool Read(std::string& chunk, boost::system::error_code& ec) override;
+    bool Rewind() override;
+
+    /**
+     * @brief Render the whole body into one string (reads disk files completely)
+     */
+    std::string ToString() const;
+
+private:
+    struct Part {
+        std::string head;        // delimiter line and part headers, up to the empty line
+        std::string data;        // in-memory content
+        std::string path;        // file content streamed from disk when not empty
+        uint64_t size = 0;       // content size
+    };
+
+    void AppendPart(const std::string& name, const std::string& filename, const std::string& content_type,
+                    const HttpHeaders& headers, std::string data, std::string path, uint64_t size);
+
+    std::string boundary_;
+    std::string closing_;        // final "--boundary--" line
+    size_t chunk_size_;
+    std::vector<Part> parts_;
+    uint64_t size_;
+
+    // Read cursor: segment 3*i is the head of part i, 3*i+1 its content,
+    // 3*i+2 the CRLF ending it, and 3*parts_.size() the closing line
+    size_t segment_ = 0;
+    uint64_t offset_ = 0;
+    HttpFileChunkReader file_reader_;
+};
+
+/**
+ * @brief One part as seen by HttpMultipartParser handlers
+ */
+struct HttpMultipartPart {
+    size_t index = 0;            // position in the body, starting at 0
+    std::string name;            // Content-Disposition name
+    std::string filename;        // Content-Disposition filename, empty for plain fields
+    std::string content_type;
+    HttpFields headers;
+    uint64_t size = 0;           // content bytes delivered so far
+    uint64_t max_size = 0;       // limit for this part, may be changed by the begin handler
+
+    bool IsFile() const { return !filename.empty(); }
+};
+
+/**
+ * @brief Limits applied by HttpMultipartParser
+ */
+struct HttpMultipartLimits {
+    size_t max_header_size = 8 * 1024;              // header block of one part
+    uint64_t max_field_size = 1024 * 1024;          // default max_size of parts without filename
+    uint64_t max_file_size = 64ull * 1024 * 1024;   // default max_size of file parts
+    size_t max_parts = 128;
+};
+
+enum class HttpMultipartError {
+    NONE,
+    MALFORMED,
+    HEADER_TOO_LARGE,
+    PART_TOO_LARGE,
+    TOO_MANY_PARTS,
+    ABORTED,             // a handler returned false
+    INCOMPLETE           // Finish() before the closing delimiter
+};
+
+/**
+ * @brief Incremental multipart/form-data parser
+ *
+ * The body is fed in arbitrary pieces; part content is handed to the data
+ * handler as soon as it cannot be the start of a delimiter, so only about one
+ * delimiter length is buffered between calls (plus a part's header block).
+ * Any handler may return false to stop parsing.
+ */
+class HttpMultipartParser {
+public:
+    using PartBeginHandler = std::function<bool(HttpMultipartPart& part)>;
+    using PartDataHandler = std::function<bool(const HttpMultipartPart& part, std::string_view data)>;
+    using PartEndHandler = std::function<bool(const HttpMultipartPart& part)>;
+
+    explicit HttpMultipartParser(std::string boundary, const HttpMultipartLimits& limits = HttpMultipartLimits{});
+
+    HttpMultipartParser(const HttpMultipartParser&) = delete;
+    HttpMultipartParser& operator=(const HttpMultipartParser&) = delete;
+
+    /**
+     * @brief Extract the boundary parameter of a multipart Content-Type, empty if absent
+     */
+    static std::string ParseBoundary(std::string_view content_type);
+
+    void OnPartBegin(PartBeginHandler handler) { on_begin_ = std::move(handler); }
+    void OnPartData(PartDataHandler handler) { on_data_ = std::move(handler); }
+    void OnPartEnd(PartEndHandler handler) { on_end_ = std::move(handler); }
+
+    /**
+     * @brief Parse the next piece of the body
+     * @return false once an error occurred (see GetError)
+     */
+    bool Feed(std::string_view data);
+
+    /**
+     * @brief Signal the end of the body
+     * @return false if the closing delimiter was not seen or an error occurred
+     */
+    bool Finish();
+
+    bool IsDone() const { return state_ == State::END; }
+    HttpMultipartError GetError() const { return error_; }
+
+    /**
+     * @brief Error mapped to a system error code (body_limit for size limits)
+     */
+    boost::system::error_code GetErrorCode() const;
+
+    size_t GetPartCount() const { return part_count_; }
+
+    static const char* ErrorToString(HttpMultipartError error);
+
+private:
+    enum class State {
+        PREAMBLE,
+        AFTER_DELIMITER,
+        HEADERS,
+        BODY,
+        END,
+        FAILED
+    };
+
+    bool Fail(HttpMultipartError error);
+    bool ParseHeaders(std::string_view block);
+    bool Deliver(std::string_view data);
+
+    HttpMultipartLimits limits_;
+    std::string delimiter_;      // CRLF "--" boundary
+
+    PartBeginHandler on_begin_;
+    PartDataHandler on_data_;
+    PartEndHandler on_end_;
+
+    State state_ = State::PREAMBLE;
+    HttpMultipartError error_ = HttpMultipartError::NONE;
+    std::string buffer_;         // unparsed input starting at pos_
+    size_t pos_ = 0;
+    HttpMultipartPart part_;
+    size_t part_count_ = 0;
+};
+
+} // namespace http
+} // namespace network
+} // namespace common
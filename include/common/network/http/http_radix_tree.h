@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace common {
+namespace network {
+namespace http {
+
+/**
+ * @brief 路径参数（名称与值均指向路由树和请求路径，不持有内存）
+ */
+struct PathParam {
+    std::string_view name;
+    std::string_view value;
+};
+
+/**
+ * @brief 路径参数集合，少量参数保存在内联数组中，匹配过程不分配内存
+ */
+class PathParams {
+public:
+    static constexpr size_t kInlineCapacity = 8;
+
+    void Push(std::string_view name, std::string_view value);
+    void Pop();
+    void Clear();
+
+    size_t Size() const { return size_; }
+    bool Empty() const { return size_ == 0; }
+    const PathParam& operator[](size_t index) const;
+
+    /**
+     * @brief 按名称查找参数值，不存在时返回空
+     */
+    std::string_view Get(std::string_view name) const;
+    bool Has(std::string_view name) const;
+
+private:
+    std::array<PathParam, kInlineCapacity> inline_{};
+    std::vector<PathParam> overflow_;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief 压缩前缀树路由表
+ *
+ * 支持的路径模式：
+ * - 静态片段：/api/users
+ * - 参数片段：/api/users/{id}，参数匹配到下一个'/'为止
+ * - 带约束的参数：/api/users/{id:[0-9]+}，仅在声明约束时执行正则匹配
+ * - 通配符：以'*'或'*name'结尾的模式（如 /static/ 后接 *path），匹配剩余全部路径
+ *
+ * 匹配优先级为 静态片段 > 参数片段 > 通配符，同级失败时回溯。
+ * 每个节点只保存一个值（路由索引），由调用方按HTTP方法分别建树。
+ */
+class HttpRadixTree {
+public:
+    explicit HttpRadixTree(bool case_sensitive = true);
+    ~HttpRadixTree();
+
+    HttpRadixTree(HttpRadixTree&&) noexcept;
+    HttpRadixTree& operator=(HttpRadixTree&&) noexcept;
+    HttpRadixTree(const HttpRadixTree&) = delete;
+    HttpRadixTree& operator=(const HttpRadixTree&) = delete;
+
+    /**
+     * @brief 插入路由模式
+     * @param pattern 路径模式
+     * @param value 匹配成功时返回的值
+     * @return 模式非法或已存在相同模式时返回false
+     */
+    bool Insert(const std::string& pattern, size_t value);
+
+    /**
+     * @brief 匹配请求路径（不含查询字符串）
+     * @param path 请求路径，params中的值指向该字符串，调用方需保证其生命周期
+     * @param value 输出匹配到的值
+     * @param params 输出路径参数
+     * @return 是否匹配
+     */
+    bool Find(std::string_view path, size_t& value, PathParams& params) const;
+
+    void Clear();
+    size_t Size() const { return size_; }
+
+private:
+    struct Node;
+
+    bool Match(const Node* node, std::string_view path, size_t& value, PathParams& params) const;
+    bool MatchChildren(const Node* node, std::string_view path, size_t& value, PathParams& params) const;
+    Node* InsertStatic(Node* node, std::string_view text);
+    bool CharsEqual(char a, char b) const;
+
+    std::unique_ptr<Node> root_;
+    bool case_sensitive_;
+    size_t size_ = 0;
+};
+
+} // namespace http
+} // namespace network
+} // namespace common
@@ -2,11 +2,12 @@
 
 #include "http_common.h"
 #include "http_message.h"
+#include "http_radix_tree.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <functional>
-#include <regex>
 #include <memory>
 
 namespace common {
@@ -23,7 +24,6 @@ class RouteGroup;
 struct Route {
     HttpMethod method;                          // HTTP方法
     std::string pattern;                        // 路径模式
-    std::regex regex;                          // 编译的正则表达式
     std::vector<std::string> param_names;      // 参数名称列表
     HttpHandler handler;                       // 请求处理器
     std::vector<HttpMiddleware> middlewares;   // 路由特定中间件
@@ -183,6 +183,15 @@ public:
      */
     RouteMatch Match(HttpMethod method, const std::string& path) const;
     
+    /**
+     * @brief 匹配路由（不分配内存）
+     * @param method HTTP方法
+     * @param path 请求路径，params中的值指向该字符串
+     * @param params 输出路径参数
+     * @return 匹配的路由，未匹配时返回nullptr
+     */
+    const struct Route* MatchRoute(HttpMethod method, std::string_view path, PathParams& params) const;
+    
     /**
      * @brief 处理HTTP请求
      * @param request HTTP请求
@@ -233,12 +242,12 @@ public:
 
 private:
     // 路由匹配辅助方法
-    RouteMatch MatchSingle(const struct Route& route, const std::string& path) const;
     std::unordered_map<std::string, std::string> ParseQueryString(const std::string& query) const;
+    std::vector<HttpMethod> FindAllowedMethods(std::string_view path) const;
+    std::string_view TrimTrailingSlash(std::string_view path) const;
     
-    // 路径模式编译
-    std::pair<std::regex, std::vector<std::string>> CompilePattern(const std::string& pattern) const;
-    std::string PatternToRegex(const std::string& pattern, std::vector<std::string>& param_names) const;
+    // 路径模式解析
+    std::vector<std::string> ExtractParamNames(const std::string& pattern) const;
     
     // 中间件执行
     void ExecuteMiddlewares(const HttpRequest& request, HttpResponse& response, 
@@ -251,6 +260,7 @@ private:
     void Handle500(const HttpRequest& request, HttpResponse& response, const std::exception& error);
     
     std::vector<struct Route> routes_;                             // 所有路由
+    std::vector<HttpRadixTree> trees_;                             // 按HTTP方法划分的路由树，值为routes_下标
     std::vector<HttpMiddleware> global_middlewares_;               // 全局中间件
     std::unordered_map<std::string, std::vector<HttpMiddleware>> path_middlewares_; // 路径中间件
     std::unordered_map<std::string, size_t> named_routes_;        // 命名路由索引
@@ -2,19 +2,30 @@
 
 #include "http_message.h"
 #include "http_common.h"
+#include "http_metrics.h"
+#include "http_multipart.h"
+#include "http_radix_tree.h"
+#include "http_middleware_pipeline.h"
+#include "http_static_file.h"
+#include "http2_session.h"
+#include "http_websocket.h"
 #include "../network_logger.h"
 #include "../network_events.h"
 #include <boost/beast/http.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ssl.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/strand.hpp>
+#include <deque>
 #include <memory>
+#include <optional>
 #include <functional>
 #include <unordered_map>
 #include <vector>
 #include <mutex>
 #include <atomic>
-#include <regex>
+#include <string_view>
 
 namespace common {
 namespace network {
@@ -23,6 +34,101 @@ namespace http {
 // Forward declarations
 class HttpServer;
 class HttpRouter;
+class HttpServerSession;
+class CompressionMiddleware;
+
+/**
+ * @brief 流式请求/响应句柄
+ *
+ * 由流式路由处理器持有。请求体按块读取，响应体按块写出（HTTP/1.1且未设置
+ * Content-Length时使用chunked编码）。所有操作投递到会话的strand上执行，可在任意线程调用。
+ * 每次Read只读取一块请求体，Write在数据写入套接字后才回调，调用方据此控制节奏（背压），
+ * 请求体和响应体都不需要完整驻留内存。
+ */
+class HttpServerStream : public std::enable_shared_from_this<HttpServerStream> {
+public:
+    /**
+     * @brief 读取回调，请求体读完时chunk为空
+     */
+    using ReadHandler = std::function<void(boost::system::error_code ec, std::string_view chunk)>;
+    using WriteHandler = std::function<void(boost::system::error_code ec)>;
+    using CompleteHandler = std::function<void(boost::system::error_code ec)>;
+    
+    /**
+     * @brief 响应体数据源，填充下一块数据，返回false表示数据已结束
+     */
+    using ChunkSource = std::function<bool(std::string& chunk)>;
+    
+    /**
+     * @brief JSON响应体数据源，每次向writer写入一部分，返回false表示JSON已写完
+     */
+    using JsonSource = std::function<bool(HttpJsonWriter& writer)>;
+    
+    explicit HttpServerStream(std::shared_ptr<HttpServerSession> session);
+    
+    /**
+     * @brief 请求行和头部（不含请求体）
+     */
+    const HttpRequest& GetRequest() const;
+    
+    /**
+     * @brief 响应状态和头部，仅在首次Write/End之前修改
+     */
+    HttpResponse& GetResponse();
+    
+    /**
+     * @brief 读取下一块请求体，同一时间只能有一个读取操作
+     */
+    void Read(ReadHandler handler);
+    
+    /**
+     * @brief 以multipart/form-data流式解析请求体
+     *
+     * 每读到一块即交给解析器，解析器回调返回后才读取下一块，内存中只保留当前块。
+     * 请求体读完或出错后调用handler：超出限制为body_limit/header_limit，格式错误为bad_message，
+     * 回调中止为operation_aborted。边界可由HttpMultipartParser::ParseBoundary从Content-Type取得。
+     */
+    void ReadMultipart(std::shared_ptr<HttpMultipartParser> parser, CompleteHandler handler);
+    
+    /**
+     * @brief 写出一块响应体，首次写入时先发送响应头
+     */
+    void Write(std::string chunk, WriteHandler handler = nullptr);
+    
+    /**
+     * @brief 结束响应，之后的写入返回operation_aborted
+     */
+    void End(WriteHandler handler = nullptr);
+    
+    /**
+     * @brief 持续从数据源拉取并写出，每块写完后再拉取下一块，数据源结束后结束响应
+     */
+    void Pipe(ChunkSource source, WriteHandler handler = nullptr);
+    
+    /**
+     * @brief 以流式JSON写出响应体，不构建DOM
+     *
+     * 反复调用source直到累积约16KB后作为一块写出，写完再继续，内存中只保留当前块。
+     * 未设置Content-Type时使用application/json。
+     */
+    void PipeJson(JsonSource source, WriteHandler handler = nullptr);
+
+private:
+    std::shared_ptr<HttpServerSession> session_;
+};
+
+/**
+ * @brief 流式路由处理器
+ */
+using HttpStreamHandler = std::function<void(std::shared_ptr<HttpServerStream> stream)>;
+
+/**
+ * @brief WebSocket路由处理器
+ *
+ * 握手完成后调用，request为升级请求（含路径参数）。处理器返回后连接才开始读取消息，
+ * 应在处理器内设置数据/错误/状态回调，或把连接交给GatewaySession等按Connection使用的模块。
+ */
+using HttpWebSocketHandler = std::function<void(std::shared_ptr<WebSocketConnection> connection, const HttpRequest& request)>;
 
 /**
  * @brief HTTP服务端会话类，处理单个客户端连接
@@ -73,19 +179,63 @@ public:
      * @brief 获取会话ID
      */
     const std::string& GetSessionId() const { return session_id_; }
+    
+    /**
+     * @brief 连接是否已移交给仍在使用的HTTP/2会话或WebSocket连接
+     */
+    bool HasActiveUpgrade() const { return !http2_session_.expired() || !websocket_.expired(); }
 
 private:
+    friend class HttpServerStream;
+    
     // HTTP请求处理
     void DoRead();
+    void OnReadHeader(boost::system::error_code ec, std::size_t bytes_transferred);
     void OnRead(boost::system::error_code ec, std::size_t bytes_transferred);
     void ProcessRequest();
+    void SendPayloadTooLarge();
     void SendResponse();
     void OnWrite(boost::system::error_code ec, std::size_t bytes_transferred, bool close);
     void DoClose();
     
+    // 文件区间响应：先写头部，再从文件直接发送响应体
+    void SendFileResponse();
+    void OnFileHeaderWritten(boost::system::error_code ec, std::size_t bytes_transferred);
+    void WriteFileBody();
+    void OnFileChunkWritten(boost::system::error_code ec, std::size_t bytes_transferred);
+    void FinishFileResponse();
+#ifdef __linux__
+    void SendFileZeroCopy();
+#endif
+    
+    // 流式请求/响应：请求头读取后转为buffer_body解析器，响应头单独发送后逐块写出
+    struct StreamWriteOp {
+        std::string data;
+        HttpServerStream::WriteHandler handler;
+        bool last = false;
+    };
+    
+    void StartStream();
+    void StreamRead(HttpServerStream::ReadHandler handler);
+    void DoStreamRead(HttpServerStream::ReadHandler handler);
+    void OnStreamRead(boost::system::error_code ec, HttpServerStream::ReadHandler handler);
+    void StreamWrite(std::string data, HttpServerStream::WriteHandler handler, bool last);
+    void DoStreamWrite();
+    void OnStreamHeaderWritten(boost::system::error_code ec, std::size_t bytes_transferred);
+    void OnStreamWritten(boost::system::error_code ec, std::size_t bytes_transferred);
+    void FinishStream(boost::system::error_code ec);
+    
+    // WebSocket：升级请求通过中间件后，连接移交给WebSocketConnection
+    void StartWebSocket();
+    
     // SSL handshake handling
     void OnSSLHandshake(boost::system::error_code ec);
     
+    // HTTP/2：明文连接检查prior-knowledge前言，TLS连接检查ALPN结果
+    void DetectProtocol();
+    void OnDetectProtocol(boost::system::error_code ec, std::size_t bytes_transferred);
+    void UpgradeToHttp2();
+    
     // 错误处理
     void HandleError(boost::system::error_code ec, const std::string& operation);
     
@@ -101,14 +251,50 @@ private:
     std::unique_ptr<boost::asio::ip::tcp::socket> socket_;
     std::unique_ptr<boost::asio::ssl::stream<boost::asio::ip::tcp::socket>> ssl_stream_;
     
+    // 会话操作统一在strand上执行，流式处理器可从任意线程调用
+    boost::asio::strand<boost::asio::any_io_executor> strand_;
+    
     // HTTP处理组件
     boost::beast::flat_buffer buffer_;
+    std::optional<boost::beast::http::request_parser<boost::beast::http::string_body>> parser_;
     boost::beast::http::request<boost::beast::http::string_body> beast_request_;
     boost::beast::http::response<boost::beast::http::string_body> beast_response_;
     
+    // 文件响应组件
+    boost::beast::http::response<boost::beast::http::empty_body> file_response_;
+    std::unique_ptr<boost::beast::http::response_serializer<boost::beast::http::empty_body>> file_serializer_;
+    boost::beast::file file_;
+    uint64_t file_offset_ = 0;
+    uint64_t file_remaining_ = 0;
+    std::vector<char> file_chunk_;
+    
+    // 流式请求/响应组件（响应头复用file_response_和file_serializer_）
+    std::optional<boost::beast::http::request_parser<boost::beast::http::buffer_body>> stream_parser_;
+    std::vector<char> stream_read_buffer_;
+    std::deque<StreamWriteOp> stream_writes_;
+    std::chrono::steady_clock::time_point stream_start_time_;
+    size_t stream_bytes_sent_ = 0;
+    size_t stream_body_bytes_sent_ = 0;        // 响应体字节数（不含响应头和分块格式）
+    size_t stream_bytes_received_ = 0;
+    size_t stream_metrics_route_ = 0;          // 流式请求的指标路由，FinishStream时记录
+    bool stream_active_ = false;
+    bool stream_reading_ = false;
+    bool stream_writing_ = false;
+    bool stream_header_sent_ = false;
+    bool stream_chunked_ = false;
+    bool stream_ended_ = false;
+    bool stream_expect_continue_ = false;
+    
+    // 协商为HTTP/2后连接移交给该会话
+    std::weak_ptr<Http2ServerSession> http2_session_;
+    
+    // 升级为WebSocket后连接移交给该对象
+    std::weak_ptr<WebSocketConnection> websocket_;
+    
     // 会话状态
     HttpServer& server_;
     std::string session_id_;
+    std::string remote_address_;            // 对端地址（不含端口），连接建立时读取一次
     std::chrono::steady_clock::time_point session_start_time_;
     std::atomic<bool> closed_{false};
     
@@ -120,6 +306,7 @@ private:
     // 当前请求上下文
     HttpRequest current_request_;
     HttpResponse current_response_;
+    HttpArena request_arena_;               // 请求级临时内存，响应写完后在读取下一个请求前整体释放
     
     // Keep-Alive支持
     bool keep_alive_ = false;
@@ -137,10 +324,14 @@ struct HttpServerConfig {
     std::chrono::seconds keep_alive_timeout{60}; // Keep-Alive超时
     std::chrono::seconds request_timeout{30};   // 请求超时
     size_t max_request_size = 10 * 1024 * 1024; // 最大请求大小 (10MB)
+    uint64_t max_stream_request_size = 1024ULL * 1024 * 1024; // 流式路由的最大请求体大小 (1GB)
     size_t max_header_size = 64 * 1024;        // 最大头部大小 (64KB)
     bool enable_compression = true;             // 启用压缩
     std::string server_name = "Zeus-HTTP/1.0"; // 服务器名称
     
+    // 静态文件配置
+    HttpStaticFileConfig static_files;         // 静态文件缓存与条件请求
+    
     // SSL配置
     bool enable_ssl = false;                   // 启用SSL
     std::string ssl_certificate_file;         // SSL证书文件
@@ -148,6 +339,22 @@ struct HttpServerConfig {
     std::string ssl_dh_param_file;            // SSL DH参数文件
     bool ssl_verify_client = false;           // SSL客户端验证
     
+    // HTTP/2配置（需要编译时启用nghttp2）
+    bool enable_http2 = false;                 // 启用HTTP/2（TLS使用ALPN h2，明文使用prior-knowledge h2c）
+    uint32_t http2_max_concurrent_streams = 100;        // 每连接最大并发流数
+    uint32_t http2_stream_window_size = 1024 * 1024;    // 每流初始流控窗口 (1MB)
+    uint32_t http2_connection_window_size = 16 * 1024 * 1024; // 连接级流控窗口 (16MB)
+    
+    // WebSocket配置
+    bool websocket_permessage_deflate = true;          // 客户端请求时启用permessage-deflate压缩
+    int websocket_deflate_level = 6;                   // 压缩级别
+    size_t websocket_max_message_size = 1024 * 1024;   // 单条消息最大长度 (1MB)
+    uint32_t websocket_heartbeat_interval_ms = 30000;  // ping间隔，0表示不发送；连续两个间隔无数据时断开
+    
+    // 指标配置（构造服务器时生效）
+    size_t metrics_max_routes = 1024;          // 单独统计的路由数上限，超出的路由合并为<other>
+    size_t metrics_shard_count = 0;            // 指标分片数，0表示按CPU核数
+    
     HttpServerConfig() = default;
 };
 
@@ -235,10 +442,29 @@ public:
      */
     void All(const std::string& path, HttpRequestHandler handler);
     
+    /**
+     * @brief 注册流式路由
+     *
+     * 请求头读取后即执行中间件链（此时请求体尚未读取），中间件未直接返回响应时调用处理器，
+     * 由处理器通过HttpServerStream按块读取请求体、写出响应体。
+     */
+    void Stream(HttpMethod method, const std::string& path, HttpStreamHandler handler);
+    
+    /**
+     * @brief 注册WebSocket路由
+     *
+     * GET升级请求执行完中间件链（可在其中鉴权）后完成握手，连接以WebSocketConnection交给处理器；
+     * 中间件直接返回响应时不升级。非升级请求返回426。
+     */
+    void WebSocket(const std::string& path, HttpWebSocketHandler handler);
+    
     // 中间件支持
     
     /**
      * @brief 添加全局中间件
+     *
+     * 中间件在注册时编译进各路由的中间件链，应在服务器启动前完成注册。
+     * 多个中间件可用MakeStaticMiddlewareChain在编译期组合后作为一级注册。
      */
     void Use(HttpRequestHandler middleware);
     
@@ -256,6 +482,11 @@ public:
      */
     void ServeStatic(const std::string& url_path, const std::string& file_path);
     
+    /**
+     * @brief 获取静态文件缓存统计
+     */
+    HttpStaticFileHandler::CacheStats GetStaticCacheStats() const { return static_files_.GetCacheStats(); }
+    
     // 配置管理
     
     /**
@@ -271,17 +502,19 @@ public:
     // 统计信息
     
     /**
-     * @brief 服务器统计信息
+     * @brief 服务器统计信息，由各路由指标汇总
      */
     struct ServerStats {
         size_t active_connections = 0;
+        size_t in_flight_requests = 0;
         size_t total_requests = 0;
-        size_t successful_requests = 0;
-        size_t failed_requests = 0;
-        size_t total_bytes_received = 0;
-        size_t total_bytes_sent = 0;
+        size_t successful_requests = 0;         // 1xx-3xx
+        size_t failed_requests = 0;             // 4xx/5xx
+        size_t total_bytes_received = 0;        // 请求体字节数
+        size_t total_bytes_sent = 0;            // 响应体字节数
         std::chrono::steady_clock::time_point start_time;
         double average_response_time_ms = 0.0;
+        double p99_response_time_ms = 0.0;
     };
     
     /**
@@ -289,14 +522,38 @@ public:
      */
     ServerStats GetStats() const;
     
+    /**
+     * @brief 按路由模式和状态类统计的耗时、大小直方图及处理中请求数
+     */
+    const HttpServerMetrics& GetMetrics() const { return metrics_; }
+    std::vector<HttpRouteMetrics> GetRouteMetrics() const { return metrics_.GetSnapshot(); }
+    
+    /**
+     * @brief 以Prometheus文本格式输出路由指标
+     */
+    std::string RenderPrometheusMetrics(const std::string& prefix = "zeus_http") const {
+        return metrics_.RenderPrometheus(prefix);
+    }
+    
+    /**
+     * @brief 注册GET路由输出Prometheus指标
+     */
+    void ServeMetrics(const std::string& path = "/metrics", const std::string& prefix = "zeus_http");
+    
     /**
      * @brief 获取监听端点信息
      */
     std::string GetListeningEndpoint() const;
     
     // 内部使用方法（由HttpServerSession调用）
-    bool ProcessRequest(const HttpRequest& request, HttpResponse& response);
-    void UpdateStats(bool success, std::chrono::milliseconds response_time, size_t bytes_received, size_t bytes_sent);
+    // Process*在确定路由后开始计入处理中请求，metrics_route返回其指标路由，调用方处理结束后以UpdateStats结束
+    bool ProcessRequest(HttpRequest& request, HttpResponse& response, size_t& metrics_route);
+    bool IsStreamRoute(HttpMethod method, std::string_view path) const;
+    HttpStreamHandler ProcessStreamRequest(HttpRequest& request, HttpResponse& response, size_t& metrics_route);
+    bool IsWebSocketRoute(std::string_view path) const;
+    HttpWebSocketHandler ProcessWebSocketRequest(HttpRequest& request, HttpResponse& response, size_t& metrics_route);
+    void UpdateStats(size_t metrics_route, HttpStatusCode status, std::chrono::steady_clock::duration response_time,
+                     size_t bytes_received, size_t bytes_sent);
     std::string GenerateServerHeader() const;
     // boost::asio::ssl::context* GetSSLContext() { return ssl_context_.get(); } // Temporarily disabled
 
@@ -310,20 +567,28 @@ private:
     void HandleAccept(boost::system::error_code ec, boost::asio::ip::tcp::socket socket);
     // SSL accept handler
     void HandleSSLAccept(boost::system::error_code ec, boost::asio::ssl::stream<boost::asio::ip::tcp::socket> stream);
+    void PruneSessionsLocked();
     
     // 路由处理
     RouteMatch MatchRoute(HttpMethod method, const std::string& path) const;
-    void ExecuteMiddlewares(const HttpRequest& request, HttpResponse& response, 
-                           const std::vector<HttpRequestHandler>& middlewares, size_t index);
     
-    // 内建中间件
-    void DefaultErrorHandler(const HttpRequest& request, HttpResponse& response, std::function<void()> next);
-    void CompressionMiddleware(const HttpRequest& request, HttpResponse& response, std::function<void()> next);
-    void LoggingMiddleware(const HttpRequest& request, HttpResponse& response, std::function<void()> next);
+    // 内建中间件，编译期组合为builtin_chain_，位于每条中间件链的最外层
+    struct LoggingStage {
+        template <typename Next>
+        void operator()(const HttpRequest& request, HttpResponse& response, Next&& next) const;
+    };
+    struct ErrorHandlerStage {
+        template <typename Next>
+        void operator()(const HttpRequest& request, HttpResponse& response, Next&& next) const;
+    };
+    struct CompressionStage {
+        const HttpServer* server;
+        template <typename Next>
+        void operator()(const HttpRequest& request, HttpResponse& response, Next&& next) const;
+    };
     
     // 静态文件处理
     bool HandleStaticFile(const HttpRequest& request, HttpResponse& response);
-    std::string GetMimeType(const std::string& file_path);
     
     // Other utility functions
     
@@ -338,32 +603,44 @@ private:
     struct RouteEntry {
         HttpMethod method;
         std::string path_pattern;
-        std::regex path_regex;
-        std::vector<std::string> param_names;
         HttpRequestHandler handler;
+        HttpStreamHandler stream_handler;   // 流式路由的处理器，此时handler为空
+        HttpWebSocketHandler websocket_handler; // WebSocket路由的处理器，此时handler为空
+        HttpMiddlewarePipeline pipeline;    // 全局中间件 + 路径中间件 + 处理器
+        size_t metrics_route = HttpServerMetrics::kOverflowRoute;   // 指标编号
     };
     
+    const RouteEntry* FindRoute(HttpMethod method, std::string_view path, PathParams& params) const;
+    void CompilePipeline(RouteEntry& route) const;
+    void CompilePipelines();
+    
     std::vector<RouteEntry> routes_;
+    std::vector<HttpRadixTree> route_trees_;   // 按HTTP方法划分的路由树，值为routes_下标
     std::vector<HttpRequestHandler> global_middlewares_;
-    std::unordered_map<std::string, std::vector<HttpRequestHandler>> path_middlewares_;
+    std::vector<std::pair<std::string, HttpRequestHandler>> path_middlewares_;   // 按注册顺序保存
+    HttpStaticMiddlewareChain<LoggingStage, ErrorHandlerStage, CompressionStage> builtin_chain_;
     
-    // 静态文件映射
-    std::unordered_map<std::string, std::string> static_paths_;
+    // 静态文件服务
+    HttpStaticFileHandler static_files_;
+    
+    // 响应压缩（enable_compression时启用，位于中间件链最外层）
+    std::unique_ptr<common::network::http::CompressionMiddleware> compression_;
     
     // 服务器状态
     std::atomic<bool> running_{false};
     std::atomic<bool> shutdown_requested_{false};
     
-    // 统计信息
-    mutable std::mutex stats_mutex_;
-    ServerStats stats_;
+    // 统计信息（按线程分片，记录时不加锁）
+    HttpServerMetrics metrics_;
+    std::chrono::steady_clock::time_point start_time_;
     
     // 会话管理
     std::vector<std::shared_ptr<HttpServerSession>> active_sessions_;
-    std::mutex sessions_mutex_;
+    mutable std::mutex sessions_mutex_;
     
     // 线程管理（当使用内部线程池时）
     std::unique_ptr<boost::asio::io_context> owned_ioc_;
+    std::optional<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> owned_work_; // 开始监听前工作线程不能退出
     std::vector<std::thread> worker_threads_;
 };
 
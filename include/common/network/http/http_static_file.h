@@ -0,0 +1,117 @@
+#pragma once
+
+#include "http_message.h"
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace common {
+namespace network {
+namespace http {
+
+/**
+ * @brief 静态文件服务配置
+ */
+struct HttpStaticFileConfig {
+    size_t cache_max_bytes = 64 * 1024 * 1024;    // 热点文件缓存总容量 (64MB)
+    size_t cache_max_file_size = 256 * 1024;      // 不超过该大小的文件进入内存缓存，更大的文件直接从磁盘发送
+    std::chrono::seconds max_age{3600};           // Cache-Control max-age
+    bool enable_ranges = true;                    // 支持Range请求
+    std::string index_file = "index.html";        // 请求目录时返回的默认文件
+};
+
+/**
+ * @brief 静态文件处理器
+ *
+ * - 小文件缓存在按字节数限制容量的LRU中，按文件大小和修改时间校验是否过期
+ * - 大文件以文件区间的形式交给会话，由会话直接从文件发送（普通TCP连接使用sendfile）
+ * - 生成ETag/Last-Modified，处理If-None-Match/If-Modified-Since(304)、单区间Range(206/416)及If-Range
+ */
+class HttpStaticFileHandler {
+public:
+    /**
+     * @brief 缓存统计信息
+     */
+    struct CacheStats {
+        size_t entries = 0;
+        size_t bytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    explicit HttpStaticFileHandler(const HttpStaticFileConfig& config = HttpStaticFileConfig{});
+
+    /**
+     * @brief 更新配置并清空缓存
+     */
+    void Configure(const HttpStaticFileConfig& config);
+
+    /**
+     * @brief 挂载目录（仅在服务器启动前调用）
+     * @param url_prefix URL路径前缀
+     * @param root 本地文件系统目录
+     */
+    void Mount(const std::string& url_prefix, const std::string& root);
+
+    bool HasMounts() const { return !mounts_.empty(); }
+
+    /**
+     * @brief 处理GET/HEAD请求
+     * @return 请求路径对应到已存在的文件时返回true
+     */
+    bool Handle(const HttpRequest& request, HttpResponse& response);
+
+    CacheStats GetCacheStats() const;
+    void ClearCache();
+
+private:
+    struct FileInfo {
+        std::string path;
+        uint64_t size = 0;
+        int64_t mtime = 0;              // 文件时钟的原始计数，仅用于校验
+        std::string etag;
+        std::string last_modified;
+    };
+
+    struct CacheEntry {
+        std::string path;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        std::shared_ptr<const std::string> data;
+    };
+
+    bool ResolvePath(const std::string& request_path, std::string& file_path) const;
+    bool StatFile(const std::string& file_path, FileInfo& info) const;
+    bool IsNotModified(const HttpRequest& request, const FileInfo& info) const;
+    bool RangeApplies(const HttpRequest& request, const FileInfo& info) const;
+
+    /**
+     * @brief 解析单区间Range头
+     * @return 0: 忽略Range返回完整文件；1: 区间有效；-1: 区间无法满足
+     */
+    static int ParseRange(const std::string& header, uint64_t size, uint64_t& offset, uint64_t& length);
+
+    std::shared_ptr<const std::string> GetCachedFile(const FileInfo& info);
+    void InsertCacheLocked(const FileInfo& info, std::shared_ptr<const std::string> data);
+    void EvictLocked(size_t max_bytes);
+
+    HttpStaticFileConfig config_;
+    std::vector<std::pair<std::string, std::string>> mounts_;   // 按前缀长度降序排列
+
+    mutable std::mutex cache_mutex_;
+    std::list<CacheEntry> lru_;                                 // 头部为最近使用
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator> cache_index_;
+    size_t cache_bytes_ = 0;
+    uint64_t cache_hits_ = 0;
+    uint64_t cache_misses_ = 0;
+};
+
+} // namespace http
+} // namespace network
+} // namespace common
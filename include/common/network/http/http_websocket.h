@@ -0,0 +1,156 @@
+#pragma once
+
+#include "../connection.h"
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/asio/strand.hpp>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace common {
+namespace network {
+namespace http {
+
+/**
+ * @brief Per-connection WebSocket settings
+ */
+struct WebSocketOptions {
+    bool permessage_deflate = true;            // Negotiate permessage-deflate (RFC 7692) when the client offers it
+    int deflate_level = 6;                     // zlib compression level of outgoing messages
+    bool deflate_no_context_takeover = false;  // Reset the compressor after every message
+    size_t max_message_size = 1024 * 1024;     // Largest accepted incoming message
+    bool binary = true;                        // Frame type used by AsyncSend(std::vector<uint8_t>)
+    std::string server_name;                   // Server header of the 101 response
+};
+
+/**
+ * @brief Server side WebSocket connection
+ *
+ * Created by HttpServer when a request to a WebSocket route is upgraded; the
+ * TCP/TLS stream is taken over from the HTTP session. Exposes the same
+ * Connection interface as TcpConnector/KcpConnector, so gateway sessions and
+ * service hooks work on it unchanged: every received message is delivered as
+ * one HandleDataReceived call and every AsyncSend becomes one frame.
+ *
+ * The Connection heartbeat sends WebSocket pings; the pong round trip updates
+ * last_ping_ms/avg_ping_ms, and a peer that stays silent for two heartbeat
+ * intervals is dropped. All stream operations run on a strand, so the public
+ * methods may be called from any thread.
+ */
+class WebSocketConnection : public Connection {
+public:
+    using PlainStream = boost::beast::websocket::stream<boost::asio::ip::tcp::socket>;
+    using SslStream = boost::beast::websocket::stream<boost::asio::ssl::stream<boost::asio::ip::tcp::socket>>;
+    using AcceptHandler = std::function<void(boost::system::error_code)>;
+
+    /**
+     * @brief Constructor for an upgraded plain connection
+     * @param socket Connected socket taken over from the HTTP session
+     * @param connection_id Unique connection identifier
+     * @param options WebSocket settings
+     */
+    WebSocketConnection(boost::asio::ip::tcp::socket socket, const std::string& connection_id,
+                        const WebSocketOptions& options = WebSocketOptions{});
+
+    /**
+     * @brief Constructor for an upgraded TLS connection (handshake already completed)
+     */
+    WebSocketConnection(boost::asio::ssl::stream<boost::asio::ip::tcp::socket> stream, const std::string& connection_id,
+                        const WebSocketOptions& options = WebSocketOptions{});
+
+    ~WebSocketConnection() override;
+
+    /**
+     * @brief Complete the handshake for an already parsed upgrade request
+     *
+     * On success the connection becomes CONNECTED, then the handler runs and
+     * only after it returns is the first message read, so data/error handlers
+     * installed by the handler see every message.
+     */
+    void AsyncAccept(boost::beast::http::request<boost::beast::http::string_body> request, AcceptHandler handler);
+
+    // Connection interface implementation
+    std::string GetProtocol() const override { return IsSSL() ? "WSS" : "WS"; }
+    std::string GetRemoteEndpoint() const override { return remote_endpoint_; }
+    std::string GetLocalEndpoint() const override { return local_endpoint_; }
+
+    /**
+     * @brief Not supported, the connection is always accepted by HttpServer
+     */
+    void AsyncConnect(const std::string& endpoint,
+                      std::function<void(boost::system::error_code)> callback) override;
+
+    using Connection::AsyncSend;
+    void AsyncSend(const std::vector<uint8_t>& data, SendCallback callback = nullptr) override;
+
+    /**
+     * @brief Send a text frame regardless of WebSocketOptions::binary
+     */
+    void AsyncSendText(std::string text, SendCallback callback = nullptr);
+
+    /**
+     * @brief Send a close frame and wait for the peer's close frame
+     */
+    void Close() override;
+    void ForceClose() override;
+
+    bool IsSSL() const { return std::holds_alternative<std::unique_ptr<SslStream>>(stream_); }
+
+protected:
+    void SendHeartbeat() override;
+
+private:
+    struct SendOperation {
+        std::vector<uint8_t> data;
+        SendCallback callback;
+        bool text = false;
+    };
+
+    template <typename Function>
+    decltype(auto) WithStream(Function&& function);
+
+    void Configure();
+    void OnAccept(boost::system::error_code ec, AcceptHandler handler);
+    void StartReceive();
+    void HandleReceive(boost::system::error_code ec, size_t bytes_transferred);
+    void QueueSend(SendOperation operation);
+    void ProcessSendQueue();
+    void HandleSend(boost::system::error_code ec, size_t bytes_transferred);
+    void OnControlFrame(boost::beast::websocket::frame_type kind, boost::beast::string_view payload);
+    void HandleClosed(boost::system::error_code ec);
+    void CloseSocket();
+
+    // executor_ (from Connection) is a strand over the socket's executor
+    std::variant<std::unique_ptr<PlainStream>, std::unique_ptr<SslStream>> stream_;
+    WebSocketOptions options_;
+    std::string remote_endpoint_;
+    std::string local_endpoint_;
+
+    // Receive side
+    boost::beast::flat_buffer read_buffer_;
+    std::chrono::steady_clock::time_point last_receive_;
+
+    // Send queue, only touched on the strand; one frame is written at a time
+    std::deque<SendOperation> send_queue_;
+    bool sending_ = false;
+    bool closing_ = false;
+
+    // Heartbeat: each ping carries a sequence number, and a pong still missing
+    // at the next heartbeat is given up so a lost pong never stops the pings
+    bool ping_pending_ = false;             // waiting for the pong of ping_sequence_
+    bool ping_writing_ = false;             // Beast allows one ping write at a time
+    uint32_t ping_sequence_ = 0;
+    std::chrono::steady_clock::time_point ping_sent_at_;
+};
+
+} // namespace http
+} // namespace network
+} // namespace common
@@ -52,10 +52,14 @@
 // HTTP module
 #include "http/http_common.h"
 #include "http/http_message.h"
+#include "http/http_json.h"
+#include "http/http_metrics.h"
+#include "http/http_multipart.h"
 #include "http/http_client.h"
 #include "http/http_server.h"
 #include "http/http_router.h"
 #include "http/http_middleware.h"
+#include "http/http_websocket.h"
 
 namespace common {
 namespace network {
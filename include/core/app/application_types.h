@@ -40,7 +40,7 @@ struct SSLConfig {
  */
 struct ListenerConfig {
     std::string name;
-    std::string type;           // tcp, http, https, kcp
+    std::string type;           // tcp, http, https, kcp, ws, wss
     uint16_t port = 0;
     std::string bind = "0.0.0.0";
     std::optional<SSLConfig> ssl;
@@ -266,6 +266,7 @@ enum class ServiceType {
     HTTP_SERVER,
     HTTPS_SERVER,
     KCP_SERVER,
+    WEBSOCKET_SERVER,
     TCP_CLIENT,
     HTTP_CLIENT,
     HTTPS_CLIENT,
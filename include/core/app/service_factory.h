@@ -52,6 +52,17 @@ public:
      */
     std::unique_ptr<Service> CreateHttpsServer(const ListenerConfig& config, const HttpServiceOptions& options);
     
+    /**
+     * @brief 创建WebSocket服务器
+     *
+     * 连接以Connection接口交给TCP服务选项中的回调，与TCP服务器用法相同。
+     * 类型为wss时使用SSL配置。options支持path、permessage_deflate、max_message_size、heartbeat_interval_ms。
+     * @param config 监听器配置
+     * @param options 服务选项
+     * @return WebSocket服务器实例
+     */
+    std::unique_ptr<Service> CreateWebSocketServer(const ListenerConfig& config, const TcpServiceOptions& options);
+    
     /**
      * @brief 创建KCP服务器
      * @param config 监听器配置
@@ -195,6 +206,25 @@ private:
     std::atomic<bool> running_{false};
 };
 
+/**
+ * @brief WebSocket服务器适配器
+ */
+class WebSocketServerAdapter : public Service {
+public:
+    WebSocketServerAdapter(const std::string& name, std::unique_ptr<common::network::http::HttpServer> server);
+    
+    bool Start() override;
+    void Stop() override;
+    bool IsRunning() const override;
+    const std::string& GetName() const override;
+    ServiceType GetType() const override;
+
+private:
+    std::string name_;
+    std::unique_ptr<common::network::http::HttpServer> server_;
+    std::atomic<bool> running_{false};
+};
+
 /**
  * @brief KCP服务器适配器
  */
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "common/network/connection.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <boost/asio.hpp>
+
+namespace gateway {
+
+/**
+ * @brief 后端链路消息聚合器
+ *
+ * 将同一后端链路上的多个消息帧合并为一次AsyncSend写入。
+ * 聚合字节数达到阈值或等待时间达到截止期限时刷新。
+ * 自适应模式下根据帧到达间隔调整截止期限：空闲时立即发送，负载高时等待聚合。
+ *
+ * 每个网关会话的每条后端链路各有一个聚合器，只合并该会话发往该链路的帧，不跨会话聚合：
+ * 后端按连接区分会话，多个会话共用一条链路需要带会话标识的多路复用协议。
+ * 因此聚合收益来自单个会话的突发流量，会话数多而各自流量小时批次通常只有一帧。
+ *
+ * 注意：帧按原样首尾拼接写入，后端需按字节流解析消息边界（TCP天然满足）。
+ */
+class BackendBatcher : public std::enable_shared_from_this<BackendBatcher> {
+public:
+    /**
+     * @brief 聚合配置
+     */
+    struct Config {
+        bool enabled = false;             // 是否启用聚合
+        size_t max_batch_bytes = 16384;   // 字节阈值，达到即刷新
+        size_t max_batch_frames = 64;     // 帧数阈值，达到即刷新
+        uint32_t max_delay_us = 500;      // 最大聚合等待时间（微秒）
+        bool adaptive = true;             // 根据负载自适应调整等待时间
+    };
+
+    /**
+     * @brief 直方图桶数量，第i个桶统计 [2^(i-1), 2^i) 范围的样本，最后一个桶为溢出桶
+     */
+    static constexpr size_t kHistogramBuckets = 16;
+
+    /**
+     * @brief 刷新原因
+     */
+    enum class FlushReason {
+        SIZE,       // 达到字节/帧数阈值
+        DEADLINE,   // 到达截止期限
+        IMMEDIATE,  // 空闲链路直接发送
+        CLOSE       // 关闭时刷新剩余数据
+    };
+
+    /**
+     * @brief 聚合统计信息（可跨会话累加）
+     */
+    struct BatchStats {
+        uint64_t batches_flushed = 0;
+        uint64_t frames_batched = 0;
+        uint64_t bytes_batched = 0;
+        uint64_t flush_by_size = 0;
+        uint64_t flush_by_deadline = 0;
+        uint64_t flush_immediate = 0;
+        uint64_t flush_on_close = 0;
+        uint64_t send_errors = 0;
+        uint32_t current_delay_us = 0;
+        std::array<uint64_t, kHistogramBuckets> frames_per_batch{};  // 每批帧数直方图
+        std::array<uint64_t, kHistogramBuckets> bytes_per_batch{};   // 每批字节数直方图（单位：64字节）
+
+        BatchStats& operator+=(const BatchStats& other);
+    };
+
+    /**
+     * @brief 每批发送完成回调
+     * @param ec 错误码
+     * @param frames 本批帧数
+     * @param bytes 本批字节数
+     */
+    using FlushCallback = std::function<void(boost::system::error_code ec, size_t frames, size_t bytes)>;
+
+    BackendBatcher(std::shared_ptr<common::network::Connection> connection, const Config& config);
+    ~BackendBatcher();
+
+    /**
+     * @brief 设置批次发送完成回调
+     */
+    void SetFlushCallback(FlushCallback callback) { flush_callback_ = std::move(callback); }
+
+    /**
+     * @brief 追加一帧到当前批次
+     */
+    void Enqueue(const std::vector<uint8_t>& frame);
+
+    /**
+     * @brief 立即刷新当前批次
+     */
+    void Flush();
+
+    /**
+     * @brief 停止聚合，剩余数据立即发送
+     */
+    void Close();
+
+    /**
+     * @brief 获取统计信息快照
+     */
+    BatchStats GetStats() const;
+
+    const Config& GetConfig() const { return config_; }
+
+private:
+    void FlushLocked(FlushReason reason);
+    void ArmTimerLocked();
+    void HandleTimer(boost::system::error_code ec, uint64_t generation);
+    void UpdateArrivalLocked(std::chrono::steady_clock::time_point now);
+    static size_t BucketIndex(uint64_t value);
+
+    std::shared_ptr<common::network::Connection> connection_;
+    Config config_;
+    FlushCallback flush_callback_;
+
+    boost::asio::steady_timer timer_;
+    mutable std::mutex mutex_;
+    std::vector<uint8_t> buffer_;
+    size_t pending_frames_ = 0;
+    bool timer_armed_ = false;
+    bool closed_ = false;
+    uint64_t timer_generation_ = 0;
+
+    // 自适应状态：帧到达间隔的指数移动平均
+    std::chrono::steady_clock::time_point last_arrival_{};
+    double arrival_gap_ewma_us_ = 0.0;
+    uint32_t current_delay_us_ = 0;
+
+    BatchStats stats_;
+};
+
+} // namespace gateway
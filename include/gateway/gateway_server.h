@@ -7,6 +7,7 @@
 #include "common/network/kcp_acceptor.h"
 #include "common/network/tcp_connector.h"
 #include "common/network/kcp_connector.h"
+#include "common/network/http/http_server.h"
 #include "common/network/network_logger.h"
 #include <memory>
 #include <unordered_map>
@@ -32,6 +33,13 @@ struct GatewayConfig {
     common::network::KcpConnector::KcpConfig kcp_config = 
         common::network::KcpConnector::KcpConfig::FastMode();
     
+    // WebSocket接入配置（浏览器客户端），与TCP/KCP监听同时工作，会话处理完全相同
+    bool websocket_enabled = false;
+    uint16_t websocket_port = 8090;
+    std::string websocket_path = "/ws";
+    bool websocket_permessage_deflate = true;
+    size_t websocket_max_message_bytes = 65536;   // 单条WebSocket消息最大长度
+    
     // 后端服务器配置
     std::vector<std::string> backend_servers;
     
@@ -44,6 +52,18 @@ struct GatewayConfig {
     uint32_t backend_timeout_ms = 30000;     // 30秒后端超时
     uint32_t heartbeat_interval_ms = 30000;  // 30秒心跳间隔
     
+    // 后端链路消息聚合配置
+    BackendBatcher::Config batch_config;
+    
+    // 客户端报文限流配置
+    SessionRateLimiter::Config rate_limit_config;
+    
+    // 断线会话恢复配置
+    SessionResumeConfig resume_config;
+    
+    // 按操作码路由到后端集群的配置
+    OpcodeRoutingConfig routing_config;
+    
     // 负载均衡策略已移至ProtocolRouter管理
 };
 
@@ -75,7 +95,7 @@ public:
     // 后端服务器管理 - 现在由 ProtocolRouter 管理
     ProtocolRouter& GetProtocolRouter() { return protocol_router_; }
     
-    // 统计信息
+    // 统计信息（快照）
     struct GatewayStats {
         uint64_t total_sessions_created = 0;
         uint64_t active_sessions = 0;
@@ -83,16 +103,30 @@ public:
         uint64_t total_bytes_processed = 0;
         uint64_t backend_connections_active = 0;
         uint64_t backend_connections_failed = 0;
+        uint64_t rate_limit_dropped = 0;        // 限流丢弃的消息数
+        uint64_t rate_limit_delayed = 0;        // 限流延迟的消息数
+        uint64_t rate_limit_disconnects = 0;    // 因限流断开的客户端数
+        uint64_t sessions_resumed = 0;          // 成功恢复的会话数
+        uint64_t session_resume_failures = 0;   // 恢复失败的请求数
         std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
     };
     
-    const GatewayStats& GetStats() const { return stats_; }
+    /**
+     * @brief 获取统计信息快照，消息与字节总数在读取时由各会话计数器汇总
+     */
+    GatewayStats GetStats() const;
+    
+    /**
+     * @brief 汇总所有会话的后端聚合统计（含批次大小直方图）
+     */
+    BackendBatcher::BatchStats GetBatchStats() const;
 
 private:
     // 网络组件
     boost::asio::any_io_executor executor_;
     std::unique_ptr<common::network::TcpAcceptor> tcp_acceptor_;
     std::unique_ptr<common::network::KcpAcceptor> kcp_acceptor_;
+    std::unique_ptr<common::network::http::HttpServer> websocket_server_;
     
     // 配置和状态
     GatewayConfig config_;
@@ -100,29 +134,51 @@ private:
     
     // 会话管理
     std::unordered_map<std::string, std::shared_ptr<GatewaySession>> sessions_;
+    std::unordered_map<std::string, std::string> resume_tokens_;  // 恢复令牌标识 -> 会话ID
     mutable std::mutex sessions_mutex_;
     std::atomic<uint64_t> next_session_id_{1};
     
     // 协议路由器
     ProtocolRouter protocol_router_;
     
-    // 统计信息
-    GatewayStats stats_;
-    mutable std::mutex stats_mutex_;
+    // 统计信息，使用relaxed原子计数器，读取时汇总为GatewayStats快照
+    struct AtomicGatewayStats {
+        std::atomic<uint64_t> total_sessions_created{0};
+        std::atomic<uint64_t> active_sessions{0};
+        std::atomic<uint64_t> retired_messages_processed{0};   // 已移除会话的消息数
+        std::atomic<uint64_t> retired_bytes_processed{0};      // 已移除会话的字节数
+        std::atomic<uint64_t> backend_connections_active{0};
+        std::atomic<uint64_t> backend_connections_failed{0};
+        std::atomic<uint64_t> rate_limit_dropped{0};
+        std::atomic<uint64_t> rate_limit_delayed{0};
+        std::atomic<uint64_t> rate_limit_disconnects{0};
+        std::atomic<uint64_t> sessions_resumed{0};
+        std::atomic<uint64_t> session_resume_failures{0};
+    };
+    AtomicGatewayStats stats_;
+    const std::chrono::steady_clock::time_point start_time_;
     
     // 定时器
     std::unique_ptr<boost::asio::steady_timer> cleanup_timer_;
     
     // 内部方法
     void StartAcceptor();
+    bool StartWebSocketListener();
     void OnClientConnection(std::shared_ptr<common::network::Connection> connection);
+    bool ConnectSessionToBackend(GatewaySession& session);
     std::string GenerateSessionId();
     std::string SelectBackendServer();
+    void ConfigureProtocolRouter();
     
     void StartCleanupTimer();
     void HandleCleanupTimer(boost::system::error_code ec);
     void CleanupInactiveSessions();
     
+    void OnRateLimitViolation(SessionRateLimiter::Action action);
+    bool HandleResumeRequest(GatewaySession& session, const std::string& token, uint64_t client_offset,
+                             const std::vector<uint8_t>& early_data);
+    void EraseResumeTokenLocked(const GatewaySession& session);
+    void RemoveSessionLocked(std::unordered_map<std::string, std::shared_ptr<GatewaySession>>::iterator it);
     void UpdateStats();
 };
 
@@ -2,10 +2,19 @@
 
 #include "common/network/connection.h"
 #include "common/network/network_logger.h"
+#include "gateway/backend_batcher.h"
+#include "gateway/message_frame.h"
+#include "gateway/protocol_router.h"
+#include "gateway/session_rate_limiter.h"
+#include "gateway/session_resume.h"
+#include <atomic>
 #include <memory>
 #include <string>
 #include <mutex>
 #include <chrono>
+#include <deque>
+#include <functional>
+#include <unordered_map>
 #include <boost/asio.hpp>
 
 namespace gateway {
@@ -18,6 +27,43 @@ struct GatewayConfig;
  */
 class GatewaySession {
 public:
+    /**
+     * @brief 限流触发回调，参数为实际执行的动作
+     */
+    using RateLimitViolationHandler = std::function<void(SessionRateLimiter::Action)>;
+
+    /**
+     * @brief 恢复请求回调
+     * @param session 收到恢复请求的新会话
+     * @param token 客户端出示的恢复令牌
+     * @param client_offset 客户端已收到的下行字节数
+     * @param early_data 与恢复请求一起到达、位于其后的客户端数据，接管成功时应交给挂起的会话
+     * @return 是否已由挂起的会话接管客户端连接
+     */
+    using ResumeRequestHandler = std::function<bool(GatewaySession& session,
+                                                    const std::string& token,
+                                                    uint64_t client_offset,
+                                                    const std::vector<uint8_t>& early_data)>;
+
+    /**
+     * @brief 延迟连接后端的回调，由其选择后端并调用ConnectToBackend
+     * @return 是否已发起连接，返回false时会话关闭
+     */
+    using BackendConnector = std::function<bool(GatewaySession& session)>;
+
+    /**
+     * @brief 会话选项
+     */
+    struct Options {
+        SessionRateLimiter::Config rate_limit_config;       // 客户端报文限流配置
+        RateLimitViolationHandler violation_handler;        // 限流触发回调
+        SessionResumeConfig resume_config;                  // 会话恢复配置
+        ResumeRequestHandler resume_handler;                // 恢复请求回调
+        BackendConnector backend_connector;                 // 设置后确认首条消息不是恢复请求时才连接后端
+        std::shared_ptr<const OpcodeRouteTable> route_table; // 操作码路由表，为空时所有消息发往默认后端
+        size_t max_frame_bytes = 65536;                     // 路由模式下单帧最大字节数
+    };
+
     /**
      * @brief 构造函数
      * @param session_id 会话ID
@@ -26,6 +72,16 @@ public:
     GatewaySession(const std::string& session_id, 
                    std::shared_ptr<common::network::Connection> client_conn);
 
+    /**
+     * @brief 构造函数
+     * @param session_id 会话ID
+     * @param client_conn 客户端连接
+     * @param options 会话选项
+     */
+    GatewaySession(const std::string& session_id, 
+                   std::shared_ptr<common::network::Connection> client_conn,
+                   Options options);
+
     /**
      * @brief 析构函数
      */
@@ -36,15 +92,44 @@ public:
     bool IsActive() const;
     void Close();
     
+    // 会话恢复
+    const std::string& GetResumeToken() const { return resume_token_; }
+    bool MatchesResumeToken(const std::string& token) const;
+    bool IsParked() const;
+    bool IsParkExpired(std::chrono::steady_clock::time_point now) const;
+    
+    /**
+     * @brief 由挂起的会话接管新客户端连接，并重放客户端未收到的下行数据
+     * @param client_conn 新客户端连接
+     * @param client_offset 客户端已收到的下行字节数
+     * @param early_data 恢复请求之后已收到的客户端数据，接管成功后按普通消息处理
+     * @return 是否接管成功
+     */
+    bool Resume(std::shared_ptr<common::network::Connection> client_conn, uint64_t client_offset,
+                const std::vector<uint8_t>& early_data = {});
+    
+    /**
+     * @brief 客户端连接已被其他会话接管，释放连接引用
+     */
+    std::shared_ptr<common::network::Connection> DetachClientConnection();
+    
     // 客户端连接管理
-    std::shared_ptr<common::network::Connection> GetClientConnection() const { return client_connection_; }
+    std::shared_ptr<common::network::Connection> GetClientConnection() const;
     void OnClientMessage(const std::vector<uint8_t>& data);
     void OnClientDisconnected(boost::system::error_code ec);
     
     // 后端连接管理
+    /**
+     * @brief 连接默认后端及各路由集群的后端
+     * @param backend_endpoint 默认后端地址，承载未命中路由的消息
+     * @param executor 执行器
+     * @param config 网关配置
+     * @param cluster_endpoints 集群名 -> 该会话选中的集群后端地址
+     */
     void ConnectToBackend(const std::string& backend_endpoint, 
                          boost::asio::any_io_executor executor,
-                         const GatewayConfig& config);
+                         const GatewayConfig& config,
+                         const std::unordered_map<std::string, std::string>& cluster_endpoints = {});
     void OnBackendMessage(const std::vector<uint8_t>& data);
     void OnBackendDisconnected(boost::system::error_code ec);
     
@@ -52,7 +137,7 @@ public:
     void ForwardToBackend(const std::vector<uint8_t>& data);
     void ForwardToClient(const std::vector<uint8_t>& data);
     
-    // 统计信息
+    // 统计信息（快照）
     struct SessionStats {
         uint64_t client_messages_received = 0;
         uint64_t client_bytes_received = 0;
@@ -62,20 +147,133 @@ public:
         uint64_t backend_bytes_received = 0;
         uint64_t client_messages_sent = 0;
         uint64_t client_bytes_sent = 0;
+        uint64_t rate_limited_messages = 0;     // 超限消息总数，含延迟转发和丢弃
+        uint64_t rate_limited_delayed = 0;      // 进入延迟队列的消息
+        uint64_t rate_limited_dropped = 0;      // 被丢弃的消息（含断开连接时的那一条）
+        uint64_t resumes = 0;
         std::chrono::steady_clock::time_point created_time = std::chrono::steady_clock::now();
         std::chrono::steady_clock::time_point last_activity = std::chrono::steady_clock::now();
     };
     
-    const SessionStats& GetStats() const { return stats_; }
+    /**
+     * @brief 获取统计信息快照，计数器为无锁读取，各字段之间不保证严格一致
+     */
+    SessionStats GetStats() const;
+    
+    /**
+     * @brief 获取最近活动时间（毫秒精度）
+     */
+    std::chrono::steady_clock::time_point GetLastActivity() const;
+    
+    /**
+     * @brief 获取后端链路聚合统计（未启用聚合时返回空统计）
+     */
+    BackendBatcher::BatchStats GetBatchStats() const;
 
 private:
     std::string session_id_;
     std::shared_ptr<common::network::Connection> client_connection_;
-    std::shared_ptr<common::network::Connection> backend_connection_;
-    SessionStats stats_;
+    
+    /**
+     * @brief 后端链路
+     */
+    struct BackendLink {
+        std::shared_ptr<common::network::Connection> connection;
+        std::shared_ptr<BackendBatcher> batcher;
+        std::unique_ptr<MessageFrameDecoder> decoder;   // 路由模式下按帧拆分后端下行数据
+    };
+    BackendLink backend_link_;                                   // 默认后端
+    std::unordered_map<std::string, BackendLink> cluster_links_; // 集群名 -> 路由集群后端
     mutable std::mutex mutex_;
     bool active_ = true;
     
+    // 后端链路只在ConnectToBackend中设置一次，发布后转发路径无需加锁读取
+    std::atomic<bool> backend_ready_{false};
+    
+    // 延迟连接后端：连接建立前的客户端消息暂存，连接成功后按序转发
+    BackendConnector backend_connector_;
+    std::atomic<bool> backend_connecting_{false};
+    std::vector<std::vector<uint8_t>> pending_backend_messages_;
+    
+    // 当前客户端连接身份，供连接回调无锁过滤已被替换的旧连接
+    std::atomic<const common::network::Connection*> current_client_{nullptr};
+    
+    // 热路径计数器，使用relaxed原子操作，读取时汇总为SessionStats快照
+    struct AtomicSessionStats {
+        std::atomic<uint64_t> client_messages_received{0};
+        std::atomic<uint64_t> client_bytes_received{0};
+        std::atomic<uint64_t> backend_messages_sent{0};
+        std::atomic<uint64_t> backend_bytes_sent{0};
+        std::atomic<uint64_t> backend_messages_received{0};
+        std::atomic<uint64_t> backend_bytes_received{0};
+        std::atomic<uint64_t> client_messages_sent{0};
+        std::atomic<uint64_t> client_bytes_sent{0};
+        std::atomic<uint64_t> rate_limited_messages{0};
+        std::atomic<uint64_t> rate_limited_delayed{0};
+        std::atomic<uint64_t> rate_limited_dropped{0};
+        std::atomic<uint64_t> resumes{0};
+        std::atomic<int64_t> last_activity_ms{0};   // 粗粒度时间戳，同一毫秒内不重复写入
+    };
+    AtomicSessionStats stats_;
+    const std::chrono::steady_clock::time_point created_time_;
+    
+    // 客户端报文限流
+    struct DelayedMessage {
+        std::chrono::steady_clock::time_point ready_time;
+        std::vector<uint8_t> data;
+    };
+    std::unique_ptr<SessionRateLimiter> rate_limiter_;
+    RateLimitViolationHandler violation_handler_;
+    std::deque<DelayedMessage> delayed_messages_;
+    std::unique_ptr<boost::asio::steady_timer> delay_timer_;
+    bool delay_timer_armed_ = false;
+    bool delay_draining_ = false;               // 定时器正在转发到期消息，新消息须排队
+    
+    bool AdmitClientMessage(const std::vector<uint8_t>& data);
+    void ArmDelayTimerLocked();
+    void HandleDelayTimer(boost::system::error_code ec);
+    void NotifyRateLimitViolation(SessionRateLimiter::Action action);
+    
+    // 会话恢复
+    SessionResumeConfig resume_config_;
+    ResumeRequestHandler resume_handler_;
+    std::string resume_token_;
+    // 首批客户端字节在判定是否为完整的恢复请求前暂存（见ResumeFrame的分帧说明）
+    std::atomic<bool> resume_probe_done_{false};
+    bool resume_deciding_ = false;                     // 恢复请求已收齐，等待接管结果
+    std::vector<uint8_t> resume_probe_buffer_;
+    bool parked_ = false;
+    std::chrono::steady_clock::time_point parked_since_;
+    uint64_t parked_offset_ = 0;
+    std::deque<std::vector<uint8_t>> replay_buffer_;   // 最近下发的下行帧
+    size_t replay_bytes_ = 0;
+    uint64_t replay_start_offset_ = 0;                 // 重放缓冲区首字节的下行偏移
+    uint64_t downstream_offset_ = 0;                   // 已下发的下行字节总数
+    
+    // 操作码路由
+    std::shared_ptr<const OpcodeRouteTable> route_table_;
+    size_t max_frame_bytes_;
+    std::unique_ptr<MessageFrameDecoder> client_decoder_;   // 仅在客户端读回调中使用
+    
+    void AttachClientConnectionLocked(std::shared_ptr<common::network::Connection> client_conn);
+    void ProbeResumeRequest(const std::vector<uint8_t>& data);
+    void DecideResume(const ResumeFrame& frame);
+    void ProcessClientData(const std::vector<uint8_t>& data);
+    void SendResumeTokenLocked();
+    void StartDeferredBackend();
+    void OnDefaultBackendConnected(boost::system::error_code ec);
+    void DispatchToBackend(const std::vector<uint8_t>& data);
+    bool Park();
+    bool RecordDownstreamLocked(const std::vector<uint8_t>& data);
+    BackendLink CreateBackendLinkLocked(const std::string& name,
+                                        const std::string& endpoint,
+                                        boost::asio::any_io_executor executor,
+                                        const GatewayConfig& config,
+                                        bool is_default);
+    void OnBackendData(MessageFrameDecoder* decoder, const std::vector<uint8_t>& data);
+    const BackendLink& RouteMessage(const std::vector<uint8_t>& data) const;
+    void SendToClient(const std::shared_ptr<common::network::Connection>& client_connection,
+                      const std::vector<uint8_t>& data);
     void UpdateLastActivity();
 };
 
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace gateway {
+
+/**
+ * @brief 路由消息固定头
+ *
+ * 帧格式: 负载长度(4字节大端) | 操作码(2字节大端) | 负载
+ * 网关只解析固定头用于选择后端集群，负载原样透传。
+ */
+struct MessageHeader {
+    static constexpr size_t kSize = 6;
+
+    uint32_t body_length = 0;
+    uint16_t opcode = 0;
+
+    /**
+     * @brief 从帧首部解析固定头，数据不足时返回空
+     */
+    static std::optional<MessageHeader> Parse(const uint8_t* data, size_t size);
+};
+
+/**
+ * @brief 字节流分帧器，将连接上收到的任意数据块拆分为完整帧
+ */
+class MessageFrameDecoder {
+public:
+    /**
+     * @param max_frame_bytes 单帧最大字节数（含固定头），超出视为协议错误
+     */
+    explicit MessageFrameDecoder(size_t max_frame_bytes = 65536);
+
+    /**
+     * @brief 追加数据并取出已完整的帧
+     * @param data 新收到的数据
+     * @param frames 输出的完整帧（含固定头）
+     * @return 帧长度超限时返回false，此后流已不可解析
+     */
+    bool Feed(const std::vector<uint8_t>& data, std::vector<std::vector<uint8_t>>& frames);
+
+    /**
+     * @brief 丢弃未完成的半帧
+     */
+    void Reset() { buffer_.clear(); }
+
+    size_t GetBufferedBytes() const { return buffer_.size(); }
+
+private:
+    size_t max_frame_bytes_;
+    std::vector<uint8_t> buffer_;
+};
+
+} // namespace gateway
@@ -3,12 +3,52 @@
 #include <vector>
 #include <string>
 #include <atomic>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <utility>
 
 namespace gateway {
 
+/**
+ * @brief 操作码路由表，按操作码区间映射到后端集群
+ *
+ * 路由表构建完成后不再修改，会话持有其只读快照，查找无需加锁。
+ */
+class OpcodeRouteTable {
+public:
+    /**
+     * @brief 操作码区间路由项（闭区间）
+     */
+    struct Route {
+        uint16_t first_opcode = 0;
+        uint16_t last_opcode = 0;
+        std::string cluster;
+    };
+
+    /**
+     * @brief 添加路由项
+     * @return 区间非法或与已有区间重叠时返回false
+     */
+    bool AddRoute(uint16_t first_opcode, uint16_t last_opcode, const std::string& cluster);
+
+    /**
+     * @brief 查找操作码所属集群，未命中时返回nullptr（使用默认后端）
+     */
+    const std::string* Resolve(uint16_t opcode) const;
+
+    const std::vector<Route>& GetRoutes() const { return routes_; }
+    bool Empty() const { return routes_.empty(); }
+
+private:
+    std::vector<Route> routes_;   // 按first_opcode升序排列
+};
+
 /**
  * @brief 协议路由器，负责后端服务器的选择和负载均衡
+ *
+ * 默认后端服务器列表承载未配置路由的消息；按操作码区间配置的消息
+ * 转发到独立的后端集群，每个集群使用各自的负载均衡策略。
  */
 class ProtocolRouter {
 public:
@@ -47,16 +87,76 @@ public:
     void SetLoadBalanceStrategy(LoadBalanceStrategy strategy);
     LoadBalanceStrategy GetLoadBalanceStrategy() const;
 
+    // 后端集群管理
+    void AddCluster(const std::string& name, LoadBalanceStrategy strategy);
+    void AddClusterServer(const std::string& cluster, const std::string& endpoint);
+    std::vector<std::string> GetClusterNames() const;
+    void ClearClusters();
+
+    /**
+     * @brief 从指定集群选择后端服务器
+     * @return 集群不存在或为空时返回空字符串
+     */
+    std::string SelectClusterServer(const std::string& cluster);
+
+    // 操作码路由
+    /**
+     * @brief 将操作码区间[first_opcode, last_opcode]路由到集群
+     * @return 集群不存在、区间非法或与已有区间重叠时返回false
+     */
+    bool AddOpcodeRoute(uint16_t first_opcode, uint16_t last_opcode, const std::string& cluster);
+
+    /**
+     * @brief 获取当前路由表快照，未配置路由时返回nullptr
+     */
+    std::shared_ptr<const OpcodeRouteTable> GetRouteTable() const;
+
+    /**
+     * @brief 解析策略名称（round_robin/random/least_connections），无法识别时返回ROUND_ROBIN
+     */
+    static LoadBalanceStrategy ParseStrategy(const std::string& name);
+
 private:
+    /**
+     * @brief 后端集群
+     */
+    struct Cluster {
+        LoadBalanceStrategy strategy = LoadBalanceStrategy::ROUND_ROBIN;
+        std::vector<std::string> servers;
+        size_t round_robin_index = 0;
+    };
+
     LoadBalanceStrategy strategy_;
     std::vector<std::string> backend_servers_;
-    std::atomic<size_t> round_robin_index_{0};
+    size_t round_robin_index_ = 0;
+    std::unordered_map<std::string, Cluster> clusters_;
+    std::shared_ptr<const OpcodeRouteTable> route_table_;   // 写时复制
     mutable std::mutex mutex_;
 
     // 内部路由算法
-    std::string SelectRoundRobin();
-    std::string SelectRandom();
-    std::string SelectLeastConnections(); // 简化为轮询实现
+    static std::string Select(LoadBalanceStrategy strategy, const std::vector<std::string>& servers, size_t& index);
+    static std::string SelectRoundRobin(const std::vector<std::string>& servers, size_t& index);
+    static std::string SelectRandom(const std::vector<std::string>& servers);
+    static std::string SelectLeastConnections(const std::vector<std::string>& servers, size_t& index); // 简化为轮询实现
+};
+
+/**
+ * @brief 后端集群配置
+ */
+struct BackendClusterConfig {
+    std::string name;
+    ProtocolRouter::LoadBalanceStrategy strategy = ProtocolRouter::LoadBalanceStrategy::ROUND_ROBIN;
+    std::vector<std::string> servers;
+    std::vector<std::pair<uint16_t, uint16_t>> opcode_ranges;   // 闭区间
+};
+
+/**
+ * @brief 操作码路由配置
+ */
+struct OpcodeRoutingConfig {
+    bool enabled = false;                        // 是否启用操作码路由（客户端需按MessageHeader分帧）
+    size_t max_frame_bytes = 65536;              // 单帧最大字节数
+    std::vector<BackendClusterConfig> clusters;  // 后端集群
 };
 
-} // namespace gateway
\ No newline at end of file
+} // namespace gateway
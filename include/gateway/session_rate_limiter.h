@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace gateway {
+
+/**
+ * @brief 会话级报文限流器
+ *
+ * 每个会话维护消息数和字节数两个令牌桶，采用GCRA（理论到达时间）实现：
+ * 每个桶只有一个原子时间戳，判定与扣减为一次CAS，O(1)且无锁。
+ */
+class SessionRateLimiter {
+public:
+    /**
+     * @brief 超限处理动作
+     */
+    enum class Action {
+        DROP,        // 丢弃超限消息
+        DELAY,       // 延迟转发，超过最大延迟时丢弃
+        DISCONNECT   // 断开客户端
+    };
+
+    /**
+     * @brief 限流配置
+     */
+    struct Config {
+        bool enabled = false;                   // 是否启用限流
+        uint32_t messages_per_second = 200;     // 消息速率（0表示不限制）
+        uint32_t message_burst = 400;           // 消息突发容量
+        uint64_t bytes_per_second = 262144;     // 字节速率（0表示不限制）
+        uint64_t byte_burst = 524288;           // 字节突发容量
+        Action action = Action::DROP;           // 超限处理动作
+        uint32_t max_delay_ms = 200;            // DELAY动作的最大延迟
+        size_t max_delayed_messages = 256;      // DELAY动作的最大排队消息数
+    };
+
+    /**
+     * @brief 判定结果
+     */
+    struct Decision {
+        bool allowed = false;                              // 是否放行
+        std::chrono::nanoseconds delay{0};                 // 放行前需等待的时间
+    };
+
+    explicit SessionRateLimiter(const Config& config);
+
+    /**
+     * @brief 为一条消息申请令牌
+     * @param bytes 消息字节数
+     * @param max_delay 可接受的最大等待时间，为0时只在令牌充足时放行
+     * @return 判定结果，放行时令牌已扣减
+     */
+    Decision Acquire(size_t bytes, std::chrono::nanoseconds max_delay = std::chrono::nanoseconds{0});
+
+    /**
+     * @brief 归还一条已放行消息的令牌（消息最终未被转发时调用）
+     * @param bytes 与Acquire相同的消息字节数
+     */
+    void Refund(size_t bytes);
+
+    const Config& GetConfig() const { return config_; }
+
+    /**
+     * @brief 解析动作名称（drop/delay/disconnect），无法识别时返回DROP
+     */
+    static Action ParseAction(const std::string& name);
+
+private:
+    /**
+     * @brief 单个GCRA令牌桶
+     */
+    class Bucket {
+    public:
+        void Configure(double rate_per_second, double burst);
+        bool Enabled() const { return emission_interval_ns_ > 0.0; }
+
+        /**
+         * @brief 申请cost个令牌
+         * @return 需要等待的纳秒数，超过max_delay_ns时返回-1且不扣减
+         */
+        int64_t Acquire(int64_t now_ns, double cost, int64_t max_delay_ns);
+
+        /**
+         * @brief 归还cost个令牌（另一个桶拒绝时回滚）
+         */
+        void Refund(double cost);
+
+    private:
+        double emission_interval_ns_ = 0.0;   // 每个令牌的间隔
+        int64_t tolerance_ns_ = 0;            // 突发容忍度
+        std::atomic<int64_t> tat_ns_{0};      // 理论到达时间
+    };
+
+    static int64_t NowNs();
+    double ByteCost(size_t bytes) const;
+
+    Config config_;
+    Bucket message_bucket_;
+    Bucket byte_bucket_;
+};
+
+} // namespace gateway
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gateway {
+
+/**
+ * @brief 会话恢复配置
+ */
+struct SessionResumeConfig {
+    bool enabled = false;               // 是否启用会话恢复
+    uint32_t grace_period_ms = 30000;   // 客户端断开后会话保留时间
+    size_t max_replay_bytes = 262144;   // 下行重放缓冲区上限
+};
+
+/**
+ * @brief 会话恢复控制帧
+ *
+ * 控制帧格式: "ZRSM"(4字节) | 类型(1字节) | 负载
+ * - TOKEN:          网关 -> 客户端，负载为恢复令牌
+ * - RESUME_REQUEST: 客户端 -> 网关，负载为恢复令牌 + 已收到的下行字节数(8字节大端)
+ * - RESUMED:        网关 -> 客户端，负载为即将重放的字节数(8字节大端)
+ * - REJECTED:       网关 -> 客户端，无负载，随后网关在本次连接上下发新令牌
+ *
+ * 恢复请求必须是新连接上最先发送的字节，控制帧不计入下行字节偏移。
+ * 客户端字节流没有分帧，恢复请求可能分多次到达或与之后的数据合并：网关暂存首批字节，
+ * 直到能判定它们不是恢复请求的开头，或已收齐固定长度(kResumeRequestSize)的恢复请求；
+ * 收齐时只消费这一帧，其后的字节作为普通数据交给最终接管连接的会话。
+ * 令牌由标识（前16个字符，用于查找会话）和密钥两部分组成，校验时对整个令牌做常量时间比较。
+ */
+class ResumeFrame {
+public:
+    enum class Type : uint8_t {
+        TOKEN = 1,
+        RESUME_REQUEST = 2,
+        RESUMED = 3,
+        REJECTED = 4
+    };
+
+    static constexpr size_t kTokenLength = 48;
+    static constexpr size_t kTokenIdLength = 16;
+    static constexpr size_t kHeaderSize = 5;
+    static constexpr size_t kResumeRequestSize = kHeaderSize + kTokenLength + 8;
+
+    Type type = Type::TOKEN;
+    std::string token;
+    uint64_t offset = 0;
+
+    /**
+     * @brief 编码为控制帧
+     */
+    std::vector<uint8_t> Encode() const;
+
+    /**
+     * @brief 解析控制帧，非控制帧或格式错误时返回空
+     */
+    static std::optional<ResumeFrame> Decode(const std::vector<uint8_t>& data);
+    static std::optional<ResumeFrame> Decode(const uint8_t* data, size_t size);
+
+    /**
+     * @brief 判断客户端首批字节是否可能是恢复请求的开头（收到的字节不足帧头时按已收到的部分判断）
+     */
+    static bool MayBeResumeRequest(const uint8_t* data, size_t size);
+
+    /**
+     * @brief 用CSPRNG生成恢复令牌（48个十六进制字符，192位随机数）
+     * @return 令牌，随机数生成失败时返回空字符串
+     */
+    static std::string GenerateToken();
+
+    /**
+     * @brief 令牌标识部分，用作会话查找键，不参与身份校验
+     */
+    static std::string_view GetTokenId(std::string_view token) { return token.substr(0, kTokenIdLength); }
+
+    /**
+     * @brief 常量时间比较两个令牌，耗时与内容无关
+     */
+    static bool TokenEquals(std::string_view expected, std::string_view actual);
+};
+
+} // namespace gateway
@@ -0,0 +1,520 @@
+#include "common/network/http/http2_session.h"
+
+#ifdef ZEUS_HTTP_HAS_NGHTTP2
+
+#include "common/network/http/http_server.h"
+#include <nghttp2/nghttp2.h>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/write.hpp>
+#include <algorithm>
+#include <cctype>
+#include <vector>
+
+namespace common {
+namespace network {
+namespace http {
+
+namespace {
+
+// 单次写出的最大数据量，避免一次性序列化过多DATA帧
+constexpr size_t kMaxWriteBatch = 64 * 1024;
+
+std::string ToLower(std::string_view value) {
+    std::string result(value);
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return result;
+}
+
+// HTTP/2禁止连接相关的头部（RFC 7540 8.1.2.2）
+bool IsConnectionHeader(const std::string& name) {
+    return name == "connection" || name == "keep-alive" || name == "proxy-connection" ||
+           name == "transfer-encoding" || name == "upgrade";
+}
+
+nghttp2_nv MakeNv(const std::string& name, const std::string& value) {
+    return nghttp2_nv{reinterpret_cast<uint8_t*>(const_cast<char*>(name.data())),
+                      reinterpret_cast<uint8_t*>(const_cast<char*>(value.data())),
+                      name.size(), value.size(), NGHTTP2_NV_FLAG_NONE};
+}
+
+} // namespace
+
+// ===== nghttp2回调 =====
+
+struct Http2ServerSession::Callbacks {
+    static Http2ServerSession& Self(void* user_data) {
+        return *static_cast<Http2ServerSession*>(user_data);
+    }
+
+    static Stream* FindStream(void* user_data, int32_t stream_id) {
+        auto& streams = Self(user_data).streams_;
+        auto it = streams.find(stream_id);
+        return it != streams.end() ? it->second.get() : nullptr;
+    }
+
+    static bool IsRequestHeaders(const nghttp2_frame* frame) {
+        return frame->hd.type == NGHTTP2_HEADERS && frame->headers.cat == NGHTTP2_HCAT_REQUEST;
+    }
+
+    static int OnBeginHeaders(nghttp2_session*, const nghttp2_frame* frame, void* user_data) {
+        if (!IsRequestHeaders(frame)) {
+            return 0;
+        }
+
+        auto stream = std::make_shared<Stream>();
+        stream->id = frame->hd.stream_id;
+        stream->start_time = std::chrono::steady_clock::now();
+        Self(user_data).streams_[stream->id] = std::move(stream);
+        return 0;
+    }
+
+    static int OnHeader(nghttp2_session*, const nghttp2_frame* frame, const uint8_t* name, size_t name_len,
+                        const uint8_t* value, size_t value_len, uint8_t, void* user_data) {
+        // 尾部头部（trailers）不参与请求处理
+        if (!IsRequestHeaders(frame)) {
+            return 0;
+        }
+
+        Stream* stream = FindStream(user_data, frame->hd.stream_id);
+        if (!stream) {
+            return 0;
+        }
+
+        const boost::beast::string_view key(reinterpret_cast<const char*>(name), name_len);
+        const boost::beast::string_view val(reinterpret_cast<const char*>(value), value_len);
+        auto& header = stream->header;
+
+        if (key == ":method") {
+            header.method_string(val);
+        } else if (key == ":path") {
+            header.target(val);
+        } else if (key == ":authority") {
+            header.set(boost::beast::http::field::host, val);
+        } else if (!key.empty() && key[0] == ':') {
+            // :scheme等其余伪头部无需保留
+        } else if (key == "cookie") {
+            // 拆分发送的cookie头合并为一个（RFC 7540 8.1.2.5）
+            auto it = header.find(boost::beast::http::field::cookie);
+            if (it != header.end()) {
+                std::string merged(it->value());
+                merged += "; ";
+                merged.append(val.data(), val.size());
+                header.set(boost::beast::http::field::cookie, merged);
+            } else {
+                header.set(boost::beast::http::field::cookie, val);
+            }
+        } else if (key == "host") {
+            if (header.find(boost::beast::http::field::host) == header.end()) {
+                header.set(boost::beast::http::field::host, val);
+            }
+        } else {
+            header.insert(key, val);
+        }
+        return 0;
+    }
+
+    static int OnDataChunk(nghttp2_session*, uint8_t, int32_t stream_id,
+                           const uint8_t* data, size_t len, void* user_data) {
+        Stream* stream = FindStream(user_data, stream_id);
+        if (!stream || stream->rejected) {
+            return 0;
+        }
+
+        auto& self = Self(user_data);
+        if (stream->body.size() + len > self.server_.GetConfig().max_request_size) {
+            self.SubmitError(*stream, HttpStatusCode::PAYLOAD_TOO_LARGE);
+            return 0;
+        }
+
+        stream->body.append(reinterpret_cast<const char*>(data), len);
+        return 0;
+    }
+
+    static int OnFrameRecv(nghttp2_session*, const nghttp2_frame* frame, void* user_data) {
+        if ((frame->hd.type != NGHTTP2_HEADERS && frame->hd.type != NGHTTP2_DATA) ||
+            !(frame->hd.flags & NGHTTP2_FLAG_END_STREAM)) {
+            return 0;
+        }
+
+        auto& streams = Self(user_data).streams_;
+        auto it = streams.find(frame->hd.stream_id);
+        if (it != streams.end() && !it->second->rejected) {
+            Self(user_data).ProcessStream(it->second);
+        }
+        return 0;
+    }
+
+    static int OnStreamClose(nghttp2_session*, int32_t stream_id, uint32_t, void* user_data) {
+        Self(user_data).streams_.erase(stream_id);
+        return 0;
+    }
+
+    static ssize_t ReadResponseBody(nghttp2_session*, int32_t stream_id, uint8_t* buf, size_t length,
+                                    uint32_t* data_flags, nghttp2_data_source*, void* user_data) {
+        Stream* stream = FindStream(user_data, stream_id);
+        if (!stream) {
+            return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE;
+        }
+
+        if (stream->file.is_open()) {
+            const size_t count = static_cast<size_t>(std::min<uint64_t>(length, stream->file_remaining));
+            boost::beast::error_code ec;
+            const size_t bytes_read = count > 0 ? stream->file.read(buf, count, ec) : 0;
+            if (ec || (count > 0 && bytes_read == 0)) {
+                return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE;
+            }
+            stream->file_remaining -= bytes_read;
+            if (stream->file_remaining == 0) {
+                *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+            }
+            return static_cast<ssize_t>(bytes_read);
+        }
+
+        const size_t count = std::min(length, stream->response_body.size() - stream->body_offset);
+        std::copy_n(stream->response_body.data() + stream->body_offset, count, buf);
+        stream->body_offset += count;
+        if (stream->body_offset == stream->response_body.size()) {
+            *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+        }
+        return static_cast<ssize_t>(count);
+    }
+};
+
+// ===== Http2ServerSession Implementation =====
+
+Http2ServerSession::Http2ServerSession(std::unique_ptr<boost::asio::ip::tcp::socket> socket,
+                                       std::unique_ptr<boost::asio::ssl::stream<boost::asio::ip::tcp::socket>> ssl_stream,
+                                       HttpServer& server)
+    : socket_(std::move(socket)),
+      ssl_stream_(std::move(ssl_stream)),
+      strand_(boost::asio::make_strand(ssl_stream_ ? ssl_stream_->get_executor() : socket_->get_executor())),
+      server_(server) {
+    boost::system::error_code ec;
+    auto endpoint = ssl_stream_ ? ssl_stream_->lowest_layer().remote_endpoint(ec) : socket_->remote_endpoint(ec);
+    if (!ec) {
+        remote_address_ = endpoint.address().to_string();
+    }
+}
+
+Http2ServerSession::~Http2ServerSession() {
+    if (session_) {
+        nghttp2_session_del(session_);
+    }
+}
+
+void Http2ServerSession::Start(std::string_view initial_data) {
+    auto self = shared_from_this();
+    boost::asio::dispatch(strand_, [self, data = std::string(initial_data)]() {
+        if (!self->InitSession()) {
+            self->Close();
+            return;
+        }
+
+        if (!data.empty()) {
+            const ssize_t rv = nghttp2_session_mem_recv(self->session_,
+                reinterpret_cast<const uint8_t*>(data.data()), data.size());
+            if (rv < 0) {
+                NETWORK_LOG_DEBUG("HTTP/2 preface rejected: {}", nghttp2_strerror(static_cast<int>(rv)));
+                self->Close();
+                return;
+            }
+        }
+
+        self->DoWrite();
+        self->DoRead();
+    });
+}
+
+void Http2ServerSession::Close() {
+    auto self = shared_from_this();
+    boost::asio::dispatch(strand_, [self]() {
+        if (self->closed_) {
+            return;
+        }
+        self->closed_ = true;
+
+        boost::system::error_code ec;
+        if (self->ssl_stream_) {
+            self->ssl_stream_->lowest_layer().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+            self->ssl_stream_->lowest_layer().close(ec);
+        } else if (self->socket_) {
+            self->socket_->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+            self->socket_->close(ec);
+        }
+    });
+}
+
+bool Http2ServerSession::InitSession() {
+    nghttp2_session_callbacks* callbacks = nullptr;
+    if (nghttp2_session_callbacks_new(&callbacks) != 0) {
+        return false;
+    }
+
+    nghttp2_session_callbacks_set_on_begin_headers_callback(callbacks, &Callbacks::OnBeginHeaders);
+    nghttp2_session_callbacks_set_on_header_callback(callbacks, &Callbacks::OnHeader);
+    nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks, &Callbacks::OnDataChunk);
+    nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks, &Callbacks::OnFrameRecv);
+    nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, &Callbacks::OnStreamClose);
+
+    const int rv = nghttp2_session_server_new(&session_, callbacks, this);
+    nghttp2_session_callbacks_del(callbacks);
+    if (rv != 0) {
+        NETWORK_LOG_ERROR("Failed to create HTTP/2 session: {}", nghttp2_strerror(rv));
+        session_ = nullptr;
+        return false;
+    }
+
+    // 每连接并发流数、每流初始窗口和头部大小上限通过SETTINGS通告给客户端
+    const auto& config = server_.GetConfig();
+    const nghttp2_settings_entry settings[] = {
+        {NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, config.http2_max_concurrent_streams},
+        {NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, config.http2_stream_window_size},
+        {NGHTTP2_SETTINGS_MAX_HEADER_LIST_SIZE, static_cast<uint32_t>(config.max_header_size)},
+    };
+    if (nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, settings, std::size(settings)) != 0) {
+        return false;
+    }
+
+    // 连接级窗口独立于单个流的窗口
+    nghttp2_session_set_local_window_size(session_, NGHTTP2_FLAG_NONE, 0,
+                                          static_cast<int32_t>(config.http2_connection_window_size));
+    return true;
+}
+
+void Http2ServerSession::DoRead() {
+    if (closed_ || !nghttp2_session_want_read(session_)) {
+        return;
+    }
+
+    auto self = shared_from_this();
+    auto on_read = boost::asio::bind_executor(strand_,
+        [self](boost::system::error_code ec, std::size_t bytes_transferred) {
+            self->OnRead(ec, bytes_transferred);
+        });
+
+    if (ssl_stream_) {
+        ssl_stream_->async_read_some(boost::asio::buffer(read_buffer_), std::move(on_read));
+    } else {
+        socket_->async_read_some(boost::asio::buffer(read_buffer_), std::move(on_read));
+    }
+}
+
+void Http2ServerSession::OnRead(boost::system::error_code ec, std::size_t bytes_transferred) {
+    if (ec) {
+        if (ec != boost::asio::error::operation_aborted && ec != boost::asio::error::eof) {
+            NETWORK_LOG_DEBUG("HTTP/2 read error: {}", ec.message());
+        }
+        Close();
+        return;
+    }
+
+    const ssize_t rv = nghttp2_session_mem_recv(session_, read_buffer_.data(), bytes_transferred);
+    if (rv < 0) {
+        NETWORK_LOG_DEBUG("HTTP/2 protocol error: {}", nghttp2_strerror(static_cast<int>(rv)));
+        Close();
+        return;
+    }
+
+    DoWrite();
+    DoRead();
+}
+
+void Http2ServerSession::DoWrite() {
+    if (writing_ || closed_) {
+        return;
+    }
+
+    write_buffer_.clear();
+    while (write_buffer_.size() < kMaxWriteBatch) {
+        const uint8_t* data = nullptr;
+        const ssize_t length = nghttp2_session_mem_send(session_, &data);
+        if (length < 0) {
+            NETWORK_LOG_DEBUG("HTTP/2 send error: {}", nghttp2_strerror(static_cast<int>(length)));
+            Close();
+            return;
+        }
+        if (length == 0) {
+            break;
+        }
+        write_buffer_.append(reinterpret_cast<const char*>(data), static_cast<size_t>(length));
+    }
+
+    if (write_buffer_.empty()) {
+        // 双方都不再需要读写（如GOAWAY已发送完毕）时关闭连接
+        if (!nghttp2_session_want_read(session_) && !nghttp2_session_want_write(session_)) {
+            Close();
+        }
+        return;
+    }
+
+    writing_ = true;
+    auto self = shared_from_this();
+    auto on_write = boost::asio::bind_executor(strand_,
+        [self](boost::system::error_code ec, std::size_t bytes_transferred) {
+            self->OnWrite(ec, bytes_transferred);
+        });
+
+    if (ssl_stream_) {
+        boost::asio::async_write(*ssl_stream_, boost::asio::buffer(write_buffer_), std::move(on_write));
+    } else {
+        boost::asio::async_write(*socket_, boost::asio::buffer(write_buffer_), std::move(on_write));
+    }
+}
+
+void Http2ServerSession::OnWrite(boost::system::error_code ec, std::size_t) {
+    writing_ = false;
+    if (ec) {
+        if (ec != boost::asio::error::operation_aborted) {
+            NETWORK_LOG_DEBUG("HTTP/2 write error: {}", ec.message());
+        }
+        Close();
+        return;
+    }
+
+    DoWrite();
+}
+
+void Http2ServerSession::ProcessStream(const std::shared_ptr<Stream>& stream) {
+    HttpRequest request = HttpRequest::FromBeastHeader(stream->header);
+    request.SetVersion(HttpVersion::HTTP_2_0);
+    request.SetRemoteAddress(remote_address_);
+    request.SetArena(stream->arena.Resource());
+    const size_t bytes_received = stream->body.size();
+    if (!stream->body.empty()) {
+        request.SetBody(std::move(stream->body));
+    }
+
+    // 流式路由依赖HTTP/1.1的分块传输，要求客户端改用HTTP/1.1
+    if (server_.IsStreamRoute(request.GetMethod(), request.GetUrl().path)) {
+        nghttp2_submit_rst_stream(session_, NGHTTP2_FLAG_NONE, stream->id, NGHTTP2_HTTP_1_1_REQUIRED);
+        return;
+    }
+
+    // 处理器在工作线程执行，慢请求不阻塞同一连接上其他流的帧收发；
+    // 执行期间只访问流的响应和请求级内存，其余状态仍由strand独占
+    auto self = shared_from_this();
+    boost::asio::post(strand_.get_inner_executor(),
+        [self, stream, request = std::move(request), bytes_received]() mutable {
+            HttpResponse& response = stream->response;
+            response = HttpResponse(HttpStatusCode::OK);
+            response.SetHeader("Server", self->server_.GenerateServerHeader());
+
+            size_t metrics_route = HttpServerMetrics::kUnmatchedRoute;
+            try {
+                const bool handled = self->server_.ProcessRequest(request, response, metrics_route);
+                if (!handled) {
+                    response.SetStatusCode(HttpStatusCode::NOT_FOUND);
+                    response.SetBody("Not Found");
+                }
+            } catch (const std::exception& e) {
+                NETWORK_LOG_ERROR("Error processing HTTP/2 stream {}: {}", stream->id, e.what());
+                response = HttpResponse::InternalServerError();
+                response.SetHeader("Server", self->server_.GenerateServerHeader());
+            }
+
+            self->server_.UpdateStats(metrics_route, response.GetStatusCode(),
+                                      std::chrono::steady_clock::now() - stream->start_time,
+                                      bytes_received, response.GetContentLength());
+
+            boost::asio::post(self->strand_, [self, stream]() {
+                // 客户端可能已重置该流或连接已关闭
+                auto it = self->streams_.find(stream->id);
+                if (self->closed_ || it == self->streams_.end() || it->second != stream) {
+                    return;
+                }
+                self->SubmitResponse(*stream);
+                self->DoWrite();
+            });
+        });
+}
+
+void Http2ServerSession::SubmitError(Stream& stream, HttpStatusCode status) {
+    stream.rejected = true;
+    stream.body.clear();
+    stream.response = HttpResponse(status);
+    stream.response.SetHeader("Server", server_.GenerateServerHeader());
+    stream.response.SetBody(HttpUtils::StatusCodeToString(status));
+    SubmitResponse(stream);
+}
+
+void Http2ServerSession::SubmitResponse(Stream& stream) {
+    HttpResponse& response = stream.response;
+
+    if (response.HasFileRange()) {
+        const HttpFileRange& range = *response.GetFileRange();
+        boost::beast::error_code ec;
+        stream.file.open(range.path.c_str(), boost::beast::file_mode::scan, ec);
+        if (!ec && range.offset > 0) {
+            stream.file.seek(range.offset, ec);
+        }
+        if (ec) {
+            NETWORK_LOG_ERROR("Failed to open file {} for HTTP/2 stream {}: {}", range.path, stream.id, ec.message());
+            if (stream.file.is_open()) {
+                stream.file.close(ec);
+            }
+            response = HttpResponse::InternalServerError();
+            response.SetHeader("Server", server_.GenerateServerHeader());
+        } else {
+            stream.file_remaining = range.length;
+        }
+    }
+
+    const int status = static_cast<int>(response.GetStatusCode());
+    const uint64_t content_length = response.GetContentLength();
+    const bool head_only = stream.header.method() == boost::beast::http::verb::head;
+    const bool no_content = status == 204 || status == 304 || status < 200;
+
+    // 状态、头部和响应体一次性转移出HttpResponse
+    boost::beast::http::response<boost::beast::http::string_body> message;
+    response.MoveToBeastResponse(message);
+    stream.response_body = std::move(message.body());
+    stream.body_offset = 0;
+
+    // nghttp2_nv只引用名称和值，存储需保持到提交完成
+    std::vector<std::string> storage;
+    storage.reserve(2 * (std::distance(message.begin(), message.end()) + 2));
+    storage.push_back(":status");
+    storage.push_back(std::to_string(status));
+    for (const auto& field : message) {
+        std::string name = ToLower(std::string_view(field.name_string().data(), field.name_string().size()));
+        if (IsConnectionHeader(name) || name == "content-length") {
+            continue;
+        }
+        storage.push_back(std::move(name));
+        storage.emplace_back(field.value());
+    }
+    if (!no_content) {
+        storage.push_back("content-length");
+        storage.push_back(std::to_string(content_length));
+    }
+
+    std::vector<nghttp2_nv> headers;
+    headers.reserve(storage.size() / 2);
+    for (size_t i = 0; i + 1 < storage.size(); i += 2) {
+        headers.push_back(MakeNv(storage[i], storage[i + 1]));
+    }
+
+    const bool has_body = !head_only && !no_content && content_length > 0;
+    if (!has_body && stream.file.is_open()) {
+        boost::beast::error_code ec;
+        stream.file.close(ec);
+    }
+
+    nghttp2_data_provider provider{};
+    provider.read_callback = &Callbacks::ReadResponseBody;
+
+    const int rv = nghttp2_submit_response(session_, stream.id, headers.data(), headers.size(),
+                                           has_body ? &provider : nullptr);
+    if (rv != 0) {
+        NETWORK_LOG_ERROR("Failed to submit HTTP/2 response on stream {}: {}", stream.id, nghttp2_strerror(rv));
+        nghttp2_submit_rst_stream(session_, NGHTTP2_FLAG_NONE, stream.id, NGHTTP2_INTERNAL_ERROR);
+    }
+}
+
+} // namespace http
+} // namespace network
+} // namespace common
+
+#endif // ZEUS_HTTP_HAS_NGHTTP2
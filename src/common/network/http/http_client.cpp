@@ -1,32 +1,287 @@
 #include "common/network/http/http_client.h"
+#include "common/network/http/http_multipart.h"
 #include <boost/asio/connect.hpp>
 #include <boost/asio/ssl/error.hpp>
 #include <boost/asio/ssl/host_name_verification.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
 #include <fstream>
+#include <limits>
 #include <random>
 
 namespace common {
 namespace network {
 namespace http {
 
-// HttpSession Implementation
-HttpSession::HttpSession(boost::asio::any_io_executor executor, const HttpConfig& config)
-    : executor_(executor), config_(config), resolver_(executor) {
+namespace {
+
+// Requests that may be replayed after a stale keep-alive connection
+bool IsIdempotent(HttpMethod method) {
+    return method == HttpMethod::GET || method == HttpMethod::HEAD ||
+           method == HttpMethod::OPTIONS || method == HttpMethod::PUT ||
+           method == HttpMethod::DELETE;
+}
+
+// Requests that may be written before earlier responses have arrived
+bool IsPipelinable(HttpMethod method) {
+    return method == HttpMethod::GET || method == HttpMethod::HEAD;
+}
+
+// Errors seen when the server closed a keep-alive connection while it sat idle
+bool IsStaleConnectionError(boost::system::error_code ec) {
+    return ec == boost::asio::error::eof || ec == boost::beast::http::error::end_of_stream ||
+           ec == boost::asio::error::connection_reset || ec == boost::asio::error::broken_pipe ||
+           ec == boost::asio::ssl::error::stream_truncated;
+}
+
+// An idle socket must have nothing to read: pending data or EOF means the server gave up on it
+bool IsIdleSocketAlive(boost::asio::ip::tcp::socket& socket) {
+    if (!socket.is_open()) {
+        return false;
+    }
+
+    boost::system::error_code ec;
+    char probe;
+    const bool was_non_blocking = socket.non_blocking();
+    socket.non_blocking(true, ec);
+    if (ec) {
+        return false;
+    }
+    socket.receive(boost::asio::buffer(&probe, 1), boost::asio::socket_base::message_peek, ec);
+    boost::system::error_code restore_ec;
+    socket.non_blocking(was_non_blocking, restore_ec);
+    return ec == boost::asio::error::would_block;
+}
+
+// "bytes 100-199/1000" or "bytes */1000"; an unknown total ("*") leaves total empty
+bool ParseContentRange(std::string_view value, std::optional<uint64_t>& first, std::optional<uint64_t>& total) {
+    first.reset();
+    total.reset();
+    if (value.substr(0, 6) != "bytes ") {
+        return false;
+    }
+    value.remove_prefix(6);
     
+    const size_t slash = value.find('/');
+    if (slash == std::string_view::npos) {
+        return false;
+    }
+    const std::string_view range = value.substr(0, slash);
+    const std::string_view length = value.substr(slash + 1);
+    
+    auto parse = [](std::string_view text, uint64_t& number) {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), number);
+        return result.ec == std::errc{} && result.ptr == text.data() + text.size();
+    };
+    
+    uint64_t number = 0;
+    if (length != "*") {
+        if (!parse(length, number)) {
+            return false;
+        }
+        total = number;
+    }
+    if (range != "*") {
+        const size_t dash = range.find('-');
+        if (dash == std::string_view::npos || !parse(range.substr(0, dash), number)) {
+            return false;
+        }
+        first = number;
+    }
+    return true;
+}
+
+// Writes 200/206 download bodies to a file and tracks how much of it is on disk for Range requests
+class FileDownloadSink : public HttpResponseSink {
+public:
+    FileDownloadSink(std::string path, uint64_t size) : path_(std::move(path)), size_(size) {}
+    
+    bool Open(const HttpResponse& response, boost::system::error_code& ec) override {
+        accepted_ = false;
+        std::ios::openmode mode = std::ios::binary | std::ios::out;
+        
+        if (response.GetStatusCode() == HttpStatusCode::PARTIAL_CONTENT) {
+            std::optional<uint64_t> first;
+            std::optional<uint64_t> total;
+            if (!ParseContentRange(response.GetHeader("Content-Range"), first, total) || first != size_) {
+                failed_ = true;
+                ec = boost::asio::error::invalid_argument;
+                return false;
+            }
+            mode |= std::ios::app;
+            total_ = total;
+        } else if (response.GetStatusCode() == HttpStatusCode::OK) {
+            // Full body: a first request, or the server ignored Range / the file changed (If-Range)
+            mode |= std::ios::trunc;
+            size_ = 0;
+            total_.reset();
+            uint64_t length = 0;
+            const std::string content_length = response.GetHeader("Content-Length");
+            auto result = std::from_chars(content_length.data(), content_length.data() + content_length.size(), length);
+            if (!content_length.empty() && result.ec == std::errc{}) {
+                total_ = length;
+            }
+            
+            // Only a strong ETag may validate a range; Last-Modified is the fallback
+            const std::string etag = response.GetHeader("ETag");
+            validator_ = !etag.empty() && etag.compare(0, 2, "W/") != 0 ? etag : response.GetHeader("Last-Modified");
+        } else {
+            return false;
+        }
+        
+        Release();
+        file_.clear();
+        file_.open(path_, mode);
+        if (!file_.is_open()) {
+            failed_ = true;
+            ec = boost::asio::error::access_denied;
+            return false;
+        }
+        
+        accepted_ = true;
+        return true;
+    }
+    
+    bool Write(std::string_view data, boost::system::error_code& ec) override {
+        file_.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (file_.fail()) {
+            failed_ = true;
+            ec = boost::asio::error::no_such_device;
+            return false;
+        }
+        size_ += data.size();
+        return true;
+    }
+    
+    bool Close(boost::system::error_code& ec) override {
+        file_.close();
+        if (file_.fail()) {
+            failed_ = true;
+            ec = boost::asio::error::no_such_device;
+            return false;
+        }
+        return true;
+    }
+    
+    // Flush and close the file after a failed transfer so the partial download is on disk
+    void Release() {
+        if (file_.is_open()) {
+            file_.close();
+        }
+    }
+    
+    const std::string& GetPath() const { return path_; }
+    uint64_t GetSize() const { return size_; }
+    std::optional<uint64_t> GetTotal() const { return total_; }
+    const std::string& GetValidator() const { return validator_; }
+    bool IsAccepted() const { return accepted_; }      // the last response went to the file
+    bool HasFailed() const { return failed_; }         // a local error that a new request cannot fix
+
+private:
+    std::string path_;
+    std::ofstream file_;
+    uint64_t size_;
+    std::optional<uint64_t> total_;
+    std::string validator_;
+    bool accepted_ = false;
+    bool failed_ = false;
+};
+
+} // namespace
+
+// HttpDnsCache Implementation
+HttpDnsCache::HttpDnsCache(boost::asio::any_io_executor executor, std::chrono::milliseconds ttl)
+    : resolver_(executor), ttl_(ttl) {
+}
+
+void HttpDnsCache::AsyncResolve(const std::string& host, const std::string& port, ResolveCallback callback) {
+    std::string key = host + ":" + port;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto& entry = entries_[key];
+    if (!entry.results.empty() && std::chrono::steady_clock::now() < entry.expires_at) {
+        Results results = entry.results;
+        lock.unlock();
+        callback(boost::system::error_code{}, std::move(results));
+        return;
+    }
+
+    // Join the lookup already in progress for this host
+    entry.waiters.push_back(std::move(callback));
+    if (entry.resolving) {
+        return;
+    }
+    entry.resolving = true;
+    lock.unlock();
+
+    NETWORK_LOG_DEBUG("Resolving {}", key);
+
+    auto self = shared_from_this();
+    resolver_.async_resolve(host, port,
+        [self, key](boost::system::error_code ec, Results results) {
+            std::vector<ResolveCallback> waiters;
+            {
+                std::lock_guard<std::mutex> lock(self->mutex_);
+                auto& entry = self->entries_[key];
+                entry.resolving = false;
+                waiters.swap(entry.waiters);
+                if (ec) {
+                    self->entries_.erase(key);
+                } else {
+                    entry.results = results;
+                    entry.expires_at = std::chrono::steady_clock::now() + self->ttl_;
+                }
+            }
+
+            if (ec) {
+                NETWORK_LOG_ERROR("DNS resolution failed for {}: {}", key, ec.message());
+            }
+            for (auto& waiter : waiters) {
+                waiter(ec, results);
+            }
+        });
+}
+
+void HttpDnsCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.resolving) {
+            it->second.results = Results{};
+            ++it;
+        } else {
+            it = entries_.erase(it);
+        }
+    }
+}
+
+size_t HttpDnsCache::GetEntries() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+// HttpSession Implementation
+HttpSession::HttpSession(boost::asio::any_io_executor executor, const HttpConfig& config,
+                         std::shared_ptr<HttpDnsCache> dns_cache)
+    : executor_(boost::asio::make_strand(executor)), config_(config),
+      dns_cache_(std::move(dns_cache)), resolver_(executor_) {
+
     // Generate unique session ID
     static std::atomic<uint64_t> session_counter{1};
     session_id_ = "http_session_" + std::to_string(session_counter.fetch_add(1));
-    
+
     NETWORK_LOG_DEBUG("HTTP session created: {}", session_id_);
 }
 
 HttpSession::~HttpSession() {
-    Cancel();
+    CancelTimeout();
     Disconnect();
     NETWORK_LOG_DEBUG("HTTP session destroyed: {}", session_id_);
 }
 
-void HttpSession::AsyncRequest(const HttpRequest& request, 
+void HttpSession::AsyncRequest(const HttpRequest& request,
                               HttpResponseCallback callback,
                               HttpProgressCallback progress_callback) {
     if (busy_.exchange(true)) {
@@ -37,25 +292,35 @@ void HttpSession::AsyncRequest(const HttpRequest& request,
         }
         return;
     }
-    
+
     cancelled_ = false;
-    request_start_time_ = std::chrono::steady_clock::now();
-    bytes_sent_ = 0;
-    bytes_received_ = 0;
-    
-    NETWORK_LOG_DEBUG("Starting HTTP request: {} {}", 
-                     HttpUtils::MethodToString(request.GetMethod()), 
+
+    NETWORK_LOG_DEBUG("Starting HTTP request: {} {}",
+                     HttpUtils::MethodToString(request.GetMethod()),
                      request.GetUrl().ToString());
-    
-    DoRequest(request, callback, progress_callback);
+
+    Submit(Exchange{request, std::move(callback), std::move(progress_callback)});
+}
+
+void HttpSession::AsyncPipelinedRequest(const HttpRequest& request,
+                                        HttpResponseCallback callback,
+                                        HttpProgressCallback progress_callback) {
+    busy_ = true;
+    cancelled_ = false;
+
+    NETWORK_LOG_DEBUG("Queueing HTTP request: {} {}",
+                     HttpUtils::MethodToString(request.GetMethod()),
+                     request.GetUrl().ToString());
+
+    Submit(Exchange{request, std::move(callback), std::move(progress_callback)});
 }
 
 HttpResponse HttpSession::Request(const HttpRequest& request, std::chrono::milliseconds timeout_ms) {
     std::promise<HttpResponse> promise;
     std::future<HttpResponse> future = promise.get_future();
-    
+
     HttpException last_error{HttpErrorCode::UNKNOWN_ERROR, "Request failed"};
-    
+
     AsyncRequest(request, [&promise, &last_error](boost::system::error_code ec, const HttpResponse& response) {
         if (ec) {
             last_error = HttpException{HttpErrorCode::UNKNOWN_ERROR, ec.message()};
@@ -64,108 +329,145 @@ HttpResponse HttpSession::Request(const HttpRequest& request, std::chrono::milli
             promise.set_value(response);
         }
     });
-    
+
     if (future.wait_for(timeout_ms) == std::future_status::timeout) {
         Cancel();
+        future.wait();
         throw HttpException{HttpErrorCode::REQUEST_TIMEOUT, "Request timeout"};
     }
-    
+
     HttpResponse response = future.get();
-    if (response.GetStatusCode() == HttpStatusCode::INTERNAL_SERVER_ERROR && 
+    if (response.GetStatusCode() == HttpStatusCode::INTERNAL_SERVER_ERROR &&
         response.GetBody().empty()) {
         throw last_error;
     }
-    
+
     return response;
 }
 
 void HttpSession::Cancel() {
     cancelled_ = true;
-    CancelTimeout();
-    
+
+    auto self = weak_from_this().lock();
+    if (!self) {
+        return;
+    }
+
+    // Posted so that callers holding locks (the client pool) never run callbacks inline
+    boost::asio::post(executor_, [self]() {
+        self->FailAll(boost::asio::error::operation_aborted);
+    });
+}
+
+bool HttpSession::IsReusable() const {
+    if (!keep_alive_ || cancelled_ || outstanding_ > 0) {
+        return false;
+    }
+
     if (ssl_stream_) {
-        boost::system::error_code ec;
-        ssl_stream_->lowest_layer().cancel(ec);
-    } else if (socket_ && socket_->is_open()) {
-        boost::system::error_code ec;
-        socket_->cancel(ec);
+        return IsIdleSocketAlive(ssl_stream_->next_layer());
     }
-    
-    busy_ = false;
+    return socket_ && IsIdleSocketAlive(*socket_);
 }
 
 void HttpSession::Connect(const HttpUrl& url, std::function<void(boost::system::error_code)> callback) {
     current_url_ = url;
-    
+
     // Check if we need SSL
     bool use_ssl = url.IsSecure();
-    
+
     if (use_ssl && !ssl_context_) {
         SetupSSL(url);
     }
-    
+
     // Resolve hostname
     auto self = shared_from_this();
     std::string port = std::to_string(url.port == 0 ? url.GetDefaultPort() : url.port);
-    
-    NETWORK_LOG_DEBUG("Resolving {}:{}", url.host, port);
-    
-    resolver_.async_resolve(url.host, port,
-        [self, callback](boost::system::error_code ec, 
-                         boost::asio::ip::tcp::resolver::results_type results) {
-            if (ec) {
-                NETWORK_LOG_ERROR("DNS resolution failed for {}: {}", self->current_url_.host, ec.message());
-                self->HandleError(ec, "DNS resolution");
-                if (callback) callback(ec);
-                return;
+    const uint64_t connection_id = connection_id_;
+
+    auto on_resolve = [self, callback, connection_id](boost::system::error_code ec,
+                                                      boost::asio::ip::tcp::resolver::results_type results) {
+        // The attempt was abandoned (timeout/cancel) while resolving
+        if (connection_id != self->connection_id_) {
+            return;
+        }
+
+        if (ec) {
+            NETWORK_LOG_ERROR("DNS resolution failed for {}: {}", self->current_url_.host, ec.message());
+            self->HandleError(ec, "DNS resolution");
+            if (callback) callback(ec);
+            return;
+        }
+
+        // Check if we need SSL from the URL
+        bool use_ssl = self->current_url_.IsSecure();
+
+        if (use_ssl) {
+            // Create SSL stream if needed
+            if (!self->ssl_stream_ && self->ssl_context_) {
+                self->ssl_stream_ = std::make_unique<boost::asio::ssl::stream<boost::asio::ip::tcp::socket>>(
+                    self->executor_, *self->ssl_context_);
             }
-            
-            // Check if we need SSL from the URL
-            bool use_ssl = self->current_url_.IsSecure();
-            
-            if (use_ssl) {
-                // Create SSL stream if needed
-                if (!self->ssl_stream_ && self->ssl_context_) {
-                    auto socket = std::make_unique<boost::asio::ip::tcp::socket>(self->executor_);
-                    self->ssl_stream_ = std::make_unique<boost::asio::ssl::stream<boost::asio::ip::tcp::socket>>(
-                        std::move(*socket), *self->ssl_context_);
-                }
-                
-                // Connect SSL stream
-                if (self->ssl_stream_) {
-                    boost::asio::async_connect(self->ssl_stream_->lowest_layer(), results,
-                        [self, callback](boost::system::error_code ec, const boost::asio::ip::tcp::endpoint&) {
-                            if (ec) {
-                                NETWORK_LOG_ERROR("TCP connect failed: {}", ec.message());
-                                self->HandleError(ec, "TCP connection");
-                                if (callback) callback(ec);
-                                return;
-                            }
-                            
-                            NETWORK_LOG_DEBUG("TCP connected successfully, starting SSL handshake");
-                            self->PerformSSLHandshake(callback);
-                        });
-                }
-            } else {
-                // HTTP connection - create regular socket if needed
-                if (!self->socket_) {
-                    self->socket_ = std::make_unique<boost::asio::ip::tcp::socket>(self->executor_);
-                }
-                
-                boost::asio::async_connect(*self->socket_, results,
-                    [self, callback](boost::system::error_code ec, const boost::asio::ip::tcp::endpoint&) {
+
+            // Connect SSL stream
+            if (self->ssl_stream_) {
+                boost::asio::async_connect(self->ssl_stream_->lowest_layer(), results,
+                    [self, callback, connection_id](boost::system::error_code ec, const boost::asio::ip::tcp::endpoint&) {
+                        if (connection_id != self->connection_id_) {
+                            return;
+                        }
                         if (ec) {
                             NETWORK_LOG_ERROR("TCP connect failed: {}", ec.message());
                             self->HandleError(ec, "TCP connection");
                             if (callback) callback(ec);
                             return;
                         }
-                        
-                        NETWORK_LOG_DEBUG("TCP connected successfully");
-                        if (callback) callback(boost::system::error_code{});
+
+                        NETWORK_LOG_DEBUG("TCP connected successfully, starting SSL handshake");
+                        self->PerformSSLHandshake(callback);
                     });
+            } else if (callback) {
+                callback(boost::asio::error::no_protocol_option);
             }
-        });
+        } else {
+            // HTTP connection - create regular socket if needed
+            if (!self->socket_) {
+                self->socket_ = std::make_unique<boost::asio::ip::tcp::socket>(self->executor_);
+            }
+
+            boost::asio::async_connect(*self->socket_, results,
+                [self, callback, connection_id](boost::system::error_code ec, const boost::asio::ip::tcp::endpoint&) {
+                    if (connection_id != self->connection_id_) {
+                        return;
+                    }
+                    if (ec) {
+                        NETWORK_LOG_ERROR("TCP connect failed: {}", ec.message());
+                        self->HandleError(ec, "TCP connection");
+                        if (callback) callback(ec);
+                        return;
+                    }
+
+                    boost::system::error_code option_ec;
+                    self->socket_->set_option(boost::asio::ip::tcp::no_delay(true), option_ec);
+
+                    NETWORK_LOG_DEBUG("TCP connected successfully");
+                    if (callback) callback(boost::system::error_code{});
+                });
+        }
+    };
+
+    if (dns_cache_) {
+        // Cached results may be delivered inline; continue on the strand either way
+        dns_cache_->AsyncResolve(url.host, port,
+            [self, on_resolve](boost::system::error_code ec, HttpDnsCache::Results results) {
+                boost::asio::post(self->executor_, [on_resolve, ec, results]() {
+                    on_resolve(ec, results);
+                });
+            });
+    } else {
+        NETWORK_LOG_DEBUG("Resolving {}:{}", url.host, port);
+        resolver_.async_resolve(url.host, port, on_resolve);
+    }
 }
 
 void HttpSession::Disconnect() {
@@ -176,7 +478,7 @@ void HttpSession::Disconnect() {
         ssl_stream_->lowest_layer().close(ec);
         ssl_stream_.reset();
     }
-    
+
     // Close regular HTTP socket
     if (socket_) {
         boost::system::error_code ec;
@@ -184,7 +486,19 @@ void HttpSession::Disconnect() {
         socket_->close(ec);
         socket_.reset();
     }
-    
+
+    // Handlers still queued for the old connection see a different id and are ignored
+    connection_id_++;
+    connecting_ = false;
+    writing_ = false;
+    reading_ = false;
+    parser_.reset();
+    header_parser_.reset();
+    sink_parser_.reset();
+    response_sink_.reset();
+    buffer_.consume(buffer_.size());
+    keep_alive_ = true;
+    connection_requests_ = 0;
     current_url_ = HttpUrl{};
 }
 
@@ -193,168 +507,543 @@ bool HttpSession::IsConnected() const {
     if (ssl_stream_) {
         return ssl_stream_->lowest_layer().is_open();
     }
-    
+
     // Check regular HTTP socket connection
     if (socket_) {
         return socket_->is_open();
     }
-    
+
     return false;
 }
 
-void HttpSession::DoRequest(const HttpRequest& request, HttpResponseCallback callback, HttpProgressCallback progress_callback) {
-    if (cancelled_) {
-        if (callback) {
-            callback(boost::asio::error::operation_aborted, HttpResponse{});
-        }
-        busy_ = false;
+void HttpSession::Submit(Exchange exchange) {
+    outstanding_++;
+
+    auto self = shared_from_this();
+    boost::asio::dispatch(executor_, [self, exchange = std::move(exchange)]() mutable {
+        self->pending_.push_back(std::move(exchange));
+        self->DoRequest();
+    });
+}
+
+void HttpSession::DoRequest() {
+    if (pending_.empty() || connecting_ || writing_) {
         return;
     }
-    
+
+    const HttpRequest& request = pending_.front().request;
+    const HttpUrl& url = request.GetUrl();
+
     // Check if we need to connect or reconnect
-    if (!IsConnected() || current_url_.host != request.GetUrl().host || 
-        current_url_.port != request.GetUrl().port || current_url_.scheme != request.GetUrl().scheme) {
-        
+    if (!IsConnected() || current_url_.host != url.host ||
+        current_url_.port != url.port || current_url_.scheme != url.scheme) {
+        if (!in_flight_.empty()) {
+            // Wait for the responses still owed on the current connection
+            return;
+        }
+
         Disconnect();
-        
+        connecting_ = true;
+        StartTimeout(config_.connect_timeout);
+
         auto self = shared_from_this();
-        Connect(request.GetUrl(), [self, request, callback, progress_callback](boost::system::error_code ec) {
+        Connect(url, [self](boost::system::error_code ec) {
+            self->connecting_ = false;
+            self->CancelTimeout();
             if (ec) {
-                if (callback) {
-                    callback(ec, HttpResponse{});
-                }
-                self->busy_ = false;
+                self->FailAll(ec);
                 return;
             }
-            
-            self->DoRequest(request, callback, progress_callback);
+
+            self->DoRequest();
         });
         return;
     }
-    
-    // Start timeout
-    StartTimeout(config_.request_timeout);
-    
+
+    // Pipeline only safe methods behind outstanding requests, and only on a keep-alive connection
+    if (!in_flight_.empty() &&
+        (!keep_alive_ || in_flight_.size() >= std::max<size_t>(config_.max_pipeline_depth, 1) ||
+         !IsPipelinable(request.GetMethod()) || !IsPipelinable(in_flight_.back().request.GetMethod()))) {
+        return;
+    }
+
+    // A streamed body is produced again for every attempt; one that cannot restart fails alone
+    body_stream_.reset();
+    if (request.GetBodyType() == HttpBodyType::STREAM && request.GetBodyStream()) {
+        if (!request.GetBodyStream()->Rewind()) {
+            Exchange exchange = std::move(pending_.front());
+            pending_.pop_front();
+            outstanding_--;
+            busy_ = outstanding_ > 0;
+            if (exchange.callback) {
+                exchange.callback(boost::asio::error::operation_not_supported, HttpResponse{});
+            }
+            DoRequest();
+            return;
+        }
+        body_stream_ = request.GetBodyStream();
+    }
+
+    in_flight_.push_back(std::move(pending_.front()));
+    pending_.pop_front();
+
+    const HttpRequest& current = in_flight_.back().request;
+
     // Convert to Beast request
-    beast_request_ = request.ToBeastRequest();
-    
+    beast_request_ = current.ToBeastRequest();
+
     // Add required headers
     beast_request_.set(boost::beast::http::field::host, current_url_.host);
-    if (!beast_request_.has_content_length() && !beast_request_.body().empty()) {
+    beast_request_.keep_alive(config_.keep_alive);
+    if (body_stream_) {
+        auto size = body_stream_->Size();
+        if (size) {
+            beast_request_.content_length(*size);
+        } else {
+            beast_request_.chunked(true);
+        }
+    } else if (!beast_request_.has_content_length() && !beast_request_.body().empty()) {
         beast_request_.prepare_payload();
     }
-    
-    WriteRequest(request);
+
+    if (in_flight_.size() == 1) {
+        request_start_time_ = std::chrono::steady_clock::now();
+        bytes_sent_ = 0;
+        bytes_received_ = 0;
+        StartTimeout(config_.request_timeout);
+    }
+
+    WriteRequest();
 }
 
-void HttpSession::WriteRequest(const HttpRequest& request) {
+void HttpSession::WriteRequest() {
     auto self = shared_from_this();
-    
+    writing_ = true;
+
     // Fire send event
     FireNetworkEvent(NetworkEventType::DATA_SENT);
-    
+
+    auto on_write = [self, connection_id = connection_id_](boost::system::error_code ec, std::size_t bytes_transferred) {
+        if (connection_id == self->connection_id_) {
+            self->OnWrite(ec, bytes_transferred);
+        }
+    };
+
+    if (body_stream_) {
+        // Header first, the body follows from WriteBodyChunk
+        body_bytes_written_ = 0;
+        header_serializer_.emplace(beast_request_);
+        auto on_header = [self, connection_id = connection_id_](boost::system::error_code ec, std::size_t bytes_transferred) {
+            if (connection_id != self->connection_id_) {
+                return;
+            }
+            if (ec) {
+                self->OnWrite(ec, bytes_transferred);
+                return;
+            }
+            // Counted as sent but not as body, so upload progress ends at the body size
+            self->bytes_sent_ += bytes_transferred;
+            self->WriteBodyChunk();
+        };
+        
+        if (ssl_stream_) {
+            boost::beast::http::async_write_header(*ssl_stream_, *header_serializer_, std::move(on_header));
+        } else {
+            boost::beast::http::async_write_header(*socket_, *header_serializer_, std::move(on_header));
+        }
+        return;
+    }
+
     if (ssl_stream_) {
         // SSL写入
-        boost::beast::http::async_write(*ssl_stream_, beast_request_,
-            [self, request](boost::system::error_code ec, std::size_t bytes_transferred) {
-                if (ec) {
-                    NETWORK_LOG_ERROR("HTTPS write failed: {}", ec.message());
-                    self->HandleError(ec, "HTTPS write");
-                    return;
-                }
-                
-                self->bytes_sent_ = bytes_transferred;
-                NETWORK_LOG_TRACE("HTTPS request sent: {} bytes", bytes_transferred);
-                
-                // Start reading response
-                self->ReadResponse([self](boost::system::error_code ec, const HttpResponse& response) {
-                    // This callback will be handled by ReadResponse
-                });
-            });
+        boost::beast::http::async_write(*ssl_stream_, beast_request_, std::move(on_write));
     } else {
         // HTTP写入
-        boost::beast::http::async_write(*socket_, beast_request_,
-            [self, request](boost::system::error_code ec, std::size_t bytes_transferred) {
-                if (ec) {
-                    NETWORK_LOG_ERROR("HTTP write failed: {}", ec.message());
-                    self->HandleError(ec, "HTTP write");
-                    return;
-                }
-                
-                self->bytes_sent_ = bytes_transferred;
-                NETWORK_LOG_TRACE("HTTP request sent: {} bytes", bytes_transferred);
-                
-                // Start reading response
-                self->ReadResponse([self](boost::system::error_code ec, const HttpResponse& response) {
-                    // This callback will be handled by ReadResponse
-                });
-            });
+        boost::beast::http::async_write(*socket_, beast_request_, std::move(on_write));
     }
 }
 
-void HttpSession::ReadResponse(HttpResponseCallback callback) {
+void HttpSession::WriteBodyChunk() {
     auto self = shared_from_this();
+    const bool chunked = beast_request_.chunked();
+    
+    boost::system::error_code ec;
+    if (!body_stream_->Read(body_chunk_, ec)) {
+        if (ec) {
+            NETWORK_LOG_ERROR("HTTP request body stream failed: {}", ec.message());
+            OnWrite(ec, body_bytes_written_);
+            return;
+        }
+        
+        if (!chunked) {
+            OnWrite(boost::system::error_code{}, body_bytes_written_);
+            return;
+        }
+        
+        auto on_last = [self, connection_id = connection_id_](boost::system::error_code ec, std::size_t bytes_transferred) {
+            if (connection_id == self->connection_id_) {
+                self->OnWrite(ec, self->body_bytes_written_ + bytes_transferred);
+            }
+        };
+        if (ssl_stream_) {
+            boost::asio::async_write(*ssl_stream_, boost::beast::http::make_chunk_last(), std::move(on_last));
+        } else {
+            boost::asio::async_write(*socket_, boost::beast::http::make_chunk_last(), std::move(on_last));
+        }
+        return;
+    }
     
+    // The next chunk is read only after this one has been written, so one chunk is held at a time
+    auto on_chunk = [self, connection_id = connection_id_](boost::system::error_code ec, std::size_t bytes_transferred) {
+        if (connection_id != self->connection_id_) {
+            return;
+        }
+        if (ec) {
+            self->OnWrite(ec, self->body_bytes_written_ + bytes_transferred);
+            return;
+        }
+        
+        self->body_bytes_written_ += bytes_transferred;
+        const auto& exchange = self->in_flight_.back();
+        if (exchange.progress_callback) {
+            HttpProgress progress;
+            progress.bytes_uploaded = self->body_bytes_written_;
+            progress.total_upload_size = static_cast<size_t>(self->body_stream_->Size().value_or(0));
+            progress.start_time = self->request_start_time_;
+            exchange.progress_callback(progress);
+        }
+        self->WriteBodyChunk();
+    };
+    
+    auto buffer = boost::asio::buffer(body_chunk_);
+    if (ssl_stream_) {
+        if (chunked) {
+            boost::asio::async_write(*ssl_stream_, boost::beast::http::make_chunk(buffer), std::move(on_chunk));
+        } else {
+            boost::asio::async_write(*ssl_stream_, buffer, std::move(on_chunk));
+        }
+    } else {
+        if (chunked) {
+            boost::asio::async_write(*socket_, boost::beast::http::make_chunk(buffer), std::move(on_chunk));
+        } else {
+            boost::asio::async_write(*socket_, buffer, std::move(on_chunk));
+        }
+    }
+}
+
+void HttpSession::OnWrite(boost::system::error_code ec, std::size_t bytes_transferred) {
+    writing_ = false;
+    header_serializer_.reset();
+    body_stream_.reset();
+
+    if (ec) {
+        NETWORK_LOG_ERROR("HTTP write failed: {}", ec.message());
+        HandleError(ec, ssl_stream_ ? "HTTPS write" : "HTTP write");
+        FailAll(ec);
+        return;
+    }
+
+    bytes_sent_ += bytes_transferred;
+    written_++;
+    NETWORK_LOG_TRACE("HTTP request sent: {} bytes", bytes_transferred);
+
+    // Start reading response, then keep the pipeline filled
+    ReadResponse();
+    DoRequest();
+}
+
+void HttpSession::ReadResponse() {
+    if (reading_ || written_ == 0) {
+        return;
+    }
+
+    reading_ = true;
+    const HttpRequest& request = in_flight_.front().request;
+    auto self = shared_from_this();
+
+    if (request.GetResponseSink() && request.GetMethod() != HttpMethod::HEAD) {
+        // No size limit yet: it only applies when the sink declines the body (boost::none
+        // is not used because some Beast versions reject every Content-Length with it)
+        header_parser_.emplace();
+        header_parser_->body_limit(std::numeric_limits<std::uint64_t>::max());
+        auto on_header = [self, connection_id = connection_id_](boost::system::error_code ec, std::size_t bytes_transferred) {
+            if (connection_id == self->connection_id_) {
+                self->OnResponseHeader(ec, bytes_transferred);
+            }
+        };
+        if (ssl_stream_) {
+            boost::beast::http::async_read_header(*ssl_stream_, buffer_, *header_parser_, std::move(on_header));
+        } else {
+            boost::beast::http::async_read_header(*socket_, buffer_, *header_parser_, std::move(on_header));
+        }
+        return;
+    }
+
+    parser_.emplace();
+    parser_->body_limit(config_.max_response_size);
+
+    // HEAD responses carry Content-Length but no body
+    if (request.GetMethod() == HttpMethod::HEAD) {
+        parser_->skip(true);
+    }
+
+    auto on_read = [self, connection_id = connection_id_](boost::system::error_code ec, std::size_t bytes_transferred) {
+        if (connection_id == self->connection_id_) {
+            self->OnRead(ec, bytes_transferred);
+        }
+    };
+
     if (ssl_stream_) {
         // SSL读取
-        boost::beast::http::async_read(*ssl_stream_, buffer_, beast_response_,
-            [self, callback](boost::system::error_code ec, std::size_t bytes_transferred) {
-                self->CancelTimeout();
-                
-                if (ec) {
-                    NETWORK_LOG_ERROR("HTTPS read failed: {}", ec.message());
-                    self->HandleError(ec, "HTTPS read");
-                    if (callback) {
-                        callback(ec, HttpResponse{});
-                    }
-                    return;
-                }
-                
-                self->bytes_received_ = bytes_transferred;
-                NETWORK_LOG_TRACE("HTTPS response received: {} bytes", bytes_transferred);
-                
-                // Convert response
-                HttpResponse response = HttpResponse::FromBeastResponse(self->beast_response_);
-                
-                // Fire receive event
-                self->FireNetworkEvent(NetworkEventType::DATA_RECEIVED);
-                
-                self->busy_ = false;
-                
-                if (callback) {
-                    callback(boost::system::error_code{}, response);
-                }
-            });
+        boost::beast::http::async_read(*ssl_stream_, buffer_, *parser_, std::move(on_read));
     } else {
         // HTTP读取
-        boost::beast::http::async_read(*socket_, buffer_, beast_response_,
-            [self, callback](boost::system::error_code ec, std::size_t bytes_transferred) {
-                self->CancelTimeout();
-                
-                if (ec) {
-                    NETWORK_LOG_ERROR("HTTP read failed: {}", ec.message());
-                    self->HandleError(ec, "HTTP read");
-                    if (callback) {
-                        callback(ec, HttpResponse{});
-                    }
-                    return;
-                }
-                
-                self->bytes_received_ = bytes_transferred;
-                NETWORK_LOG_TRACE("HTTP response received: {} bytes", bytes_transferred);
-                
-                // Convert response
-                HttpResponse response = HttpResponse::FromBeastResponse(self->beast_response_);
-                
-                // Fire receive event
-                self->FireNetworkEvent(NetworkEventType::DATA_RECEIVED);
-                
-                self->busy_ = false;
-                
-                if (callback) {
-                    callback(boost::system::error_code{}, response);
-                }
-            });
+        boost::beast::http::async_read(*socket_, buffer_, *parser_, std::move(on_read));
+    }
+}
+
+void HttpSession::OnRead(boost::system::error_code ec, std::size_t bytes_transferred) {
+    reading_ = false;
+
+    if (ec) {
+        if (!(connection_requests_ > 0 && IsStaleConnectionError(ec))) {
+            NETWORK_LOG_ERROR("HTTP read failed: {}", ec.message());
+            HandleError(ec, ssl_stream_ ? "HTTPS read" : "HTTP read");
+        }
+        FailAll(ec);
+        return;
+    }
+
+    bytes_received_ += bytes_transferred;
+    NETWORK_LOG_TRACE("HTTP response received: {} bytes", bytes_transferred);
+
+    // Convert response
+    auto beast_response = parser_->release();
+    parser_.reset();
+    keep_alive_ = config_.keep_alive && beast_response.keep_alive();
+    CompleteResponse(HttpResponse::FromBeastResponse(std::move(beast_response)));
+}
+
+void HttpSession::OnResponseHeader(boost::system::error_code ec, std::size_t bytes_transferred) {
+    if (ec) {
+        header_parser_.reset();
+        OnRead(ec, bytes_transferred);
+        return;
+    }
+
+    bytes_received_ += bytes_transferred;
+    HttpResponse response = HttpResponse::FromBeastHeader(header_parser_->get().base());
+
+    response_sink_ = in_flight_.front().request.GetResponseSink();
+    boost::system::error_code sink_ec;
+    if (!response_sink_->Open(response, sink_ec)) {
+        response_sink_.reset();
+        if (sink_ec) {
+            NETWORK_LOG_ERROR("HTTP response sink failed: {}", sink_ec.message());
+            header_parser_.reset();
+            OnRead(sink_ec, 0);
+            return;
+        }
+
+        // Declined: read the body into the response as usual, within the configured limit
+        parser_.emplace(std::move(*header_parser_));
+        header_parser_.reset();
+        const auto content_length = parser_->content_length();
+        if (content_length && *content_length > config_.max_response_size) {
+            OnRead(boost::beast::http::error::body_limit, 0);
+            return;
+        }
+        parser_->body_limit(config_.max_response_size);
+        if (parser_->is_done()) {
+            OnRead(boost::system::error_code{}, 0);
+            return;
+        }
+
+        auto self = shared_from_this();
+        auto on_read = [self, connection_id = connection_id_](boost::system::error_code ec, std::size_t bytes_transferred) {
+            if (connection_id == self->connection_id_) {
+                self->OnRead(ec, bytes_transferred);
+            }
+        };
+        if (ssl_stream_) {
+            boost::beast::http::async_read(*ssl_stream_, buffer_, *parser_, std::move(on_read));
+        } else {
+            boost::beast::http::async_read(*socket_, buffer_, *parser_, std::move(on_read));
+        }
+        return;
+    }
+
+    sink_response_ = std::move(response);
+    sink_parser_.emplace(std::move(*header_parser_));
+    header_parser_.reset();
+    sink_bytes_ = 0;
+    if (sink_buffer_.empty()) {
+        sink_buffer_.resize(64 * 1024);
+    }
+    ReadSinkBody();
+}
+
+void HttpSession::ReadSinkBody() {
+    if (sink_parser_->is_done()) {
+        boost::system::error_code ec;
+        const bool closed = response_sink_->Close(ec);
+        response_sink_.reset();
+        if (!closed) {
+            NETWORK_LOG_ERROR("HTTP response sink failed: {}", ec.message());
+            sink_parser_.reset();
+            OnRead(ec, 0);
+            return;
+        }
+
+        reading_ = false;
+        keep_alive_ = config_.keep_alive && sink_parser_->get().keep_alive();
+        sink_parser_.reset();
+        CompleteResponse(std::move(sink_response_));
+        return;
+    }
+
+    // Only this buffer and the read buffer are held, whatever the body size
+    auto& body = sink_parser_->get().body();
+    body.data = sink_buffer_.data();
+    body.size = sink_buffer_.size();
+
+    auto self = shared_from_this();
+    auto on_body = [self, connection_id = connection_id_](boost::system::error_code ec, std::size_t bytes_transferred) {
+        if (connection_id == self->connection_id_) {
+            self->OnSinkBody(ec, bytes_transferred);
+        }
+    };
+    if (ssl_stream_) {
+        boost::beast::http::async_read(*ssl_stream_, buffer_, *sink_parser_, std::move(on_body));
+    } else {
+        boost::beast::http::async_read(*socket_, buffer_, *sink_parser_, std::move(on_body));
+    }
+}
+
+void HttpSession::OnSinkBody(boost::system::error_code ec, std::size_t bytes_transferred) {
+    // need_buffer only means the chunk buffer is full
+    if (ec == boost::beast::http::error::need_buffer) {
+        ec = {};
+    }
+    const size_t received = sink_buffer_.size() - sink_parser_->get().body().size;
+    if (ec) {
+        // Keep what arrived before the failure, and leave resuming to the sink's owner instead of replaying
+        if (received > 0) {
+            boost::system::error_code sink_ec;
+            response_sink_->Write(std::string_view(sink_buffer_.data(), received), sink_ec);
+        }
+        in_flight_.front().retried = true;
+        sink_parser_.reset();
+        response_sink_.reset();
+        OnRead(ec, bytes_transferred);
+        return;
+    }
+
+    bytes_received_ += bytes_transferred;
+    if (received > 0) {
+        if (!response_sink_->Write(std::string_view(sink_buffer_.data(), received), ec)) {
+            NETWORK_LOG_ERROR("HTTP response sink failed: {}", ec.message());
+            sink_parser_.reset();
+            response_sink_.reset();
+            OnRead(ec, 0);
+            return;
+        }
+        sink_bytes_ += received;
+
+        const auto& exchange = in_flight_.front();
+        if (exchange.progress_callback) {
+            HttpProgress progress;
+            progress.bytes_downloaded = sink_bytes_;
+            progress.total_download_size = static_cast<size_t>(sink_parser_->content_length().value_or(0));
+            progress.start_time = request_start_time_;
+            exchange.progress_callback(progress);
+        }
+
+        // A long download is bounded by the time between reads, not by its total duration
+        StartTimeout(config_.request_timeout);
+    }
+
+    ReadSinkBody();
+}
+
+void HttpSession::CompleteResponse(HttpResponse response) {
+    // Fire receive event
+    FireNetworkEvent(NetworkEventType::DATA_RECEIVED);
+
+    Exchange exchange = std::move(in_flight_.front());
+    in_flight_.pop_front();
+    written_--;
+    connection_requests_++;
+
+    if (!keep_alive_) {
+        // Requests already pipelined behind this one were never answered; send them again
+        CancelTimeout();
+        Disconnect();
+        keep_alive_ = false;
+        while (!in_flight_.empty()) {
+            pending_.push_front(std::move(in_flight_.back()));
+            in_flight_.pop_back();
+        }
+        written_ = 0;
+    } else if (!in_flight_.empty()) {
+        request_start_time_ = std::chrono::steady_clock::now();
+        StartTimeout(config_.request_timeout);
+        ReadResponse();
+    } else {
+        CancelTimeout();
+    }
+
+    outstanding_--;
+    busy_ = outstanding_ > 0;
+
+    if (exchange.callback) {
+        exchange.callback(boost::system::error_code{}, response);
+    }
+
+    DoRequest();
+}
+
+void HttpSession::FailAll(boost::system::error_code ec) {
+    CancelTimeout();
+
+    const bool stale = connection_requests_ > 0 && IsStaleConnectionError(ec);
+    Disconnect();
+
+    // A keep-alive connection closed by the server before answering: replay idempotent requests
+    // once, and keep requests that were never written
+    std::deque<Exchange> failed;
+    std::deque<Exchange> replay;
+    for (auto& exchange : in_flight_) {
+        if (stale && !exchange.retried && IsIdempotent(exchange.request.GetMethod())) {
+            exchange.retried = true;
+            replay.push_back(std::move(exchange));
+        } else {
+            failed.push_back(std::move(exchange));
+        }
+    }
+    for (auto& exchange : pending_) {
+        if (stale) {
+            replay.push_back(std::move(exchange));
+        } else {
+            failed.push_back(std::move(exchange));
+        }
+    }
+    in_flight_.clear();
+    written_ = 0;
+    pending_ = std::move(replay);
+
+    outstanding_ -= failed.size();
+    busy_ = outstanding_ > 0;
+
+    for (auto& exchange : failed) {
+        if (exchange.callback) {
+            exchange.callback(ec, HttpResponse{});
+        }
+    }
+
+    if (!pending_.empty()) {
+        NETWORK_LOG_DEBUG("Retrying {} request(s) on a new connection: {}", pending_.size(), session_id_);
+        DoRequest();
     }
 }
 
@@ -394,7 +1083,7 @@ void HttpSession::HandleRedirect(const HttpResponse& response, const HttpRequest
     
     NETWORK_LOG_DEBUG("Following redirect to: {}", location);
     
-    DoRequest(redirect_request, callback, progress_callback);
+    Submit(Exchange{redirect_request, callback, progress_callback});
 }
 
 void HttpSession::SetupSSL(const HttpUrl& url) {
@@ -468,10 +1157,11 @@ void HttpSession::StartTimeout(std::chrono::milliseconds timeout) {
     timeout_timer_->expires_after(timeout);
     
     auto self = shared_from_this();
-    timeout_timer_->async_wait([self](boost::system::error_code ec) {
-        if (!ec && !self->cancelled_) {
+    auto* timer = timeout_timer_.get();
+    timeout_timer_->async_wait([self, timer](boost::system::error_code ec) {
+        if (!ec && self->timeout_timer_.get() == timer) {
             NETWORK_LOG_WARN("HTTP request timeout: {}", self->session_id_);
-            self->Cancel();
+            self->FailAll(boost::asio::error::timed_out);
         }
     });
 }
@@ -488,8 +1178,6 @@ void HttpSession::HandleError(boost::system::error_code ec, const std::string& o
     NETWORK_LOG_ERROR("HTTP session error in {}: {}", operation, ec.message());
     
     FireNetworkEvent(NetworkEventType::CONNECTION_ERROR, operation + ": " + ec.message());
-    
-    busy_ = false;
 }
 
 void HttpSession::FireNetworkEvent(NetworkEventType type, const std::string& details) {
@@ -510,25 +1198,110 @@ void HttpSession::FireNetworkEvent(NetworkEventType type, const std::string& det
     }
 }
 
+// HttpRetryBudget Implementation
+HttpRetryBudget::HttpRetryBudget(double ratio, double min_per_second)
+    : ratio_(ratio), min_per_second_(min_per_second),
+      max_balance_(std::max(min_per_second, 1.0) * 10), balance_(min_per_second),
+      last_refill_(std::chrono::steady_clock::now()) {
+}
+
+void HttpRetryBudget::Deposit() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    balance_ = std::min(max_balance_, balance_ + ratio_);
+}
+
+bool HttpRetryBudget::TryWithdraw(std::chrono::steady_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // A timestamp taken before waiting for the lock may be older than the last refill
+    const double elapsed = std::max(0.0, std::chrono::duration<double>(now - last_refill_).count());
+    last_refill_ = std::max(last_refill_, now);
+    balance_ = std::min(max_balance_, balance_ + elapsed * min_per_second_);
+    
+    if (balance_ < 1.0) {
+        return false;
+    }
+    balance_ -= 1.0;
+    return true;
+}
+
+void HttpLatencyTracker::Record(std::chrono::microseconds latency) {
+    samples_[count_++ % samples_.size()] = static_cast<uint32_t>(std::clamp<int64_t>(latency.count(), 0, UINT32_MAX));
+}
+
+std::optional<std::chrono::milliseconds> HttpLatencyTracker::GetPercentile(double percentile) const {
+    if (count_ < kMinSamples) {
+        return std::nullopt;
+    }
+    
+    std::array<uint32_t, kCapacity> samples = samples_;
+    const size_t count = std::min(count_, samples.size());
+    const size_t index = std::min(count - 1, static_cast<size_t>(std::clamp(percentile, 0.0, 1.0) * count));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.begin() + count);
+    
+    // Round up so sub-millisecond latencies still wait a full millisecond
+    return std::chrono::milliseconds((samples[index] + 999) / 1000);
+}
+
 // HttpClient Implementation
+struct HttpClient::PolicyCall {
+    HttpRequest request;
+    HttpRequestPolicy policy;
+    HttpResponseCallback callback;
+    HttpProgressCallback progress_callback;
+    std::string origin;
+    
+    std::mutex mutex;
+    bool done = false;
+    size_t in_flight = 0;
+    size_t retries = 0;
+    size_t hedges = 0;
+    size_t next_replica = 0;
+    boost::system::error_code last_error;
+    HttpResponse last_response;
+    std::unique_ptr<boost::asio::steady_timer> hedge_timer;
+    std::unique_ptr<boost::asio::steady_timer> retry_timer;
+};
+
+struct HttpClient::DownloadCall {
+    std::string url;
+    HttpDownloadOptions options;
+    std::shared_ptr<FileDownloadSink> sink;
+    std::function<void(boost::system::error_code, const std::string&)> callback;
+    HttpProgressCallback progress_callback;
+    std::chrono::steady_clock::time_point start_time;
+    size_t attempts = 0;
+};
+
 HttpClient::HttpClient(boost::asio::any_io_executor executor, const HttpConfig& config)
-    : executor_(executor), config_(config) {
+    : executor_(executor), config_(config),
+      retry_budget_(config.retry_budget_ratio, config.retry_budget_min_per_second) {
     
-    // Create initial session pool
-    for (size_t i = 0; i < std::min(max_pool_size_, size_t{2}); ++i) {
-        CreateSession();
+    // Shared DNS cache and idle connection sweeping for the per-origin pools
+    if (config_.dns_cache_ttl.count() > 0) {
+        dns_cache_ = std::make_shared<HttpDnsCache>(executor_, config_.dns_cache_ttl);
     }
+    idle_timer_ = std::make_unique<boost::asio::steady_timer>(executor_);
+    ScheduleIdleSweep();
     
     NETWORK_LOG_DEBUG("HTTP client created with executor");
 }
 
 HttpClient::HttpClient(size_t thread_count, const HttpConfig& config)
-    : config_(config) {
+    : config_(config),
+      retry_budget_(config.retry_budget_ratio, config.retry_budget_min_per_second) {
     
     // Create our own io_context and thread pool
     owned_ioc_ = std::make_unique<boost::asio::io_context>();
     executor_ = owned_ioc_->get_executor();
     
+    // Shared DNS cache and idle connection sweeping; the pending sweep also keeps the workers running
+    if (config_.dns_cache_ttl.count() > 0) {
+        dns_cache_ = std::make_shared<HttpDnsCache>(executor_, config_.dns_cache_ttl);
+    }
+    idle_timer_ = std::make_unique<boost::asio::steady_timer>(executor_);
+    ScheduleIdleSweep();
+    
     // Start worker threads
     worker_threads_.reserve(thread_count);
     for (size_t i = 0; i < thread_count; ++i) {
@@ -537,15 +1310,15 @@ HttpClient::HttpClient(size_t thread_count, const HttpConfig& config)
         });
     }
     
-    // Create initial session pool
-    for (size_t i = 0; i < std::min(max_pool_size_, size_t{2}); ++i) {
-        CreateSession();
-    }
-    
     NETWORK_LOG_DEBUG("HTTP client created with {} threads", thread_count);
 }
 
 HttpClient::~HttpClient() {
+    shutdown_requested_ = true;
+    lifetime_.reset();
+    if (idle_timer_) {
+        idle_timer_->cancel();
+    }
     CancelAllRequests();
     
     if (owned_ioc_) {
@@ -557,6 +1330,13 @@ HttpClient::~HttpClient() {
         }
     }
     
+    // Sockets and timers must go before the io_context that owns them
+    {
+        std::lock_guard<std::mutex> lock(session_mutex_);
+        pools_.clear();
+    }
+    idle_timer_.reset();
+    
     NETWORK_LOG_DEBUG("HTTP client destroyed");
 }
 
@@ -614,38 +1394,31 @@ void HttpClient::Patch(const std::string& url, const std::string& body, HttpResp
 
 void HttpClient::Request(const HttpRequest& request, HttpResponseCallback callback, 
                         HttpProgressCallback progress_callback) {
-    auto prepared_request = PrepareRequest(request);
-    auto session = GetAvailableSession();
-    
-    if (!session) {
-        if (callback) {
-            boost::asio::post(executor_, [callback]() {
-                callback(boost::asio::error::no_descriptors, HttpResponse{});
-            });
-        }
+    Request(request, default_policy_, std::move(callback), std::move(progress_callback));
+}
+
+void HttpClient::Request(const HttpRequest& request, const HttpRequestPolicy& policy,
+                         HttpResponseCallback callback, HttpProgressCallback progress_callback) {
+    HttpRequest prepared = PrepareRequest(request);
+    retry_budget_.Deposit();
+    
+    // A streamed body or response sink can only serve one attempt at a time, so it is never hedged or retried
+    if (!IsIdempotent(prepared.GetMethod()) || prepared.GetBodyType() == HttpBodyType::STREAM ||
+        prepared.GetResponseSink() ||
+        (policy.max_retries == 0 && !policy.enable_hedging)) {
+        DispatchRequest(PendingRequest{std::move(prepared), std::move(callback), std::move(progress_callback)});
         return;
     }
     
-    auto self = this;
-    auto start_time = std::chrono::steady_clock::now();
+    auto call = std::make_shared<PolicyCall>();
+    call->origin = MakeOriginKey(prepared.GetUrl());
+    call->request = std::move(prepared);
+    call->policy = policy;
+    call->callback = std::move(callback);
+    call->progress_callback = std::move(progress_callback);
     
-    session->AsyncRequest(prepared_request, [self, session, callback, start_time]
-                         (boost::system::error_code ec, const HttpResponse& response) {
-        // Update statistics
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - start_time);
-        
-        bool success = !ec && response.IsSuccess();
-        self->UpdateStats(success, duration, 0, response.GetBody().size()); // TODO: get actual bytes sent
-        
-        // Return session to pool
-        self->ReturnSession(session);
-        
-        // Call user callback
-        if (callback) {
-            callback(ec, response);
-        }
-    }, progress_callback);
+    StartAttempt(call, false);
+    ScheduleHedge(call);
 }
 
 // Synchronous methods implementation
@@ -701,35 +1474,25 @@ HttpResponse HttpClient::Patch(const std::string& url, const std::string& body,
 }
 
 HttpResponse HttpClient::Request(const HttpRequest& request, std::chrono::milliseconds timeout) {
-    auto prepared_request = PrepareRequest(request);
-    auto session = GetAvailableSession();
-    
-    if (!session) {
-        throw HttpException{HttpErrorCode::CONNECTION_FAILED, "No available HTTP session"};
-    }
-    
-    auto start_time = std::chrono::steady_clock::now();
+    using Result = std::pair<boost::system::error_code, HttpResponse>;
+    auto promise = std::make_shared<std::promise<Result>>();
+    auto future = promise->get_future();
     
-    try {
-        HttpResponse response = session->Request(prepared_request, timeout);
-        
-        // Update statistics
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - start_time);
-        
-        bool success = response.IsSuccess();
-        UpdateStats(success, duration, 0, response.GetBody().size()); // TODO: get actual bytes sent
-        
-        // Return session to pool
-        ReturnSession(session);
-        
-        return response;
-        
-    } catch (...) {
-        // Return session to pool even on exception
-        ReturnSession(session);
-        throw;
+    // Goes through the same pool as async requests; the promise outlives a timed-out wait
+    Request(request, [promise](boost::system::error_code ec, const HttpResponse& response) {
+        promise->set_value(Result{ec, response});
+    });
+    
+    if (future.wait_for(timeout) == std::future_status::timeout) {
+        throw HttpException{HttpErrorCode::REQUEST_TIMEOUT, "Request timeout"};
+    }
+    
+    Result result = future.get();
+    if (result.first) {
+        throw HttpException{HttpErrorCode::UNKNOWN_ERROR, result.first.message()};
     }
+    
+    return std::move(result.second);
 }
 
 // JSON convenience methods (simplified implementation)
@@ -750,55 +1513,43 @@ std::future<nlohmann::json> HttpClient::GetJson(const std::string& url, const Ht
 
 std::future<nlohmann::json> HttpClient::PostJson(const std::string& url, const nlohmann::json& json, 
                                                  const HttpHeaders& headers) {
-    auto promise = std::make_shared<std::promise<nlohmann::json>>();
-    auto future = promise->get_future();
-    
     HttpRequest request(HttpMethod::POST, url);
     request.SetJsonBody(json);
-    for (const auto& [name, value] : headers) {
-        request.SetHeader(name, value);
-    }
-    
-    Request(request, [promise](boost::system::error_code ec, const HttpResponse& response) {
-        if (ec) {
-            promise->set_value(nlohmann::json{});
-        } else {
-            promise->set_value(response.GetJsonBody());
-        }
-    });
-    
-    return future;
+    return RequestJson(std::move(request), headers);
+}
+
+std::future<nlohmann::json> HttpClient::PostJson(const std::string& url, const HttpJsonBuilder& build,
+                                                 const HttpHeaders& headers) {
+    HttpRequest request(HttpMethod::POST, url);
+    request.WriteJsonBody(build);
+    return RequestJson(std::move(request), headers);
 }
 
 std::future<nlohmann::json> HttpClient::PutJson(const std::string& url, const nlohmann::json& json, 
                                                 const HttpHeaders& headers) {
-    auto promise = std::make_shared<std::promise<nlohmann::json>>();
-    auto future = promise->get_future();
-    
     HttpRequest request(HttpMethod::PUT, url);
     request.SetJsonBody(json);
-    for (const auto& [name, value] : headers) {
-        request.SetHeader(name, value);
-    }
-    
-    Request(request, [promise](boost::system::error_code ec, const HttpResponse& response) {
-        if (ec) {
-            promise->set_value(nlohmann::json{});
-        } else {
-            promise->set_value(response.GetJsonBody());
-        }
-    });
-    
-    return future;
+    return RequestJson(std::move(request), headers);
+}
+
+std::future<nlohmann::json> HttpClient::PutJson(const std::string& url, const HttpJsonBuilder& build,
+                                                const HttpHeaders& headers) {
+    HttpRequest request(HttpMethod::PUT, url);
+    request.WriteJsonBody(build);
+    return RequestJson(std::move(request), headers);
 }
 
 std::future<nlohmann::json> HttpClient::PatchJson(const std::string& url, const nlohmann::json& json, 
                                                   const HttpHeaders& headers) {
+    HttpRequest request(HttpMethod::PATCH, url);
+    request.SetJsonBody(json);
+    return RequestJson(std::move(request), headers);
+}
+
+std::future<nlohmann::json> HttpClient::RequestJson(HttpRequest request, const HttpHeaders& headers) {
     auto promise = std::make_shared<std::promise<nlohmann::json>>();
     auto future = promise->get_future();
     
-    HttpRequest request(HttpMethod::PATCH, url);
-    request.SetJsonBody(json);
     for (const auto& [name, value] : headers) {
         request.SetHeader(name, value);
     }
@@ -814,44 +1565,106 @@ std::future<nlohmann::json> HttpClient::PatchJson(const std::string& url, const
     return future;
 }
 
-// File operations (simplified implementation)
+// File operations
 void HttpClient::DownloadFile(const std::string& url, const std::string& local_path, 
                              std::function<void(boost::system::error_code, const std::string&)> callback,
                              HttpProgressCallback progress_callback, const HttpHeaders& headers) {
-    Get(url, [local_path, callback](boost::system::error_code ec, const HttpResponse& response) {
-        if (ec) {
-            if (callback) callback(ec, "");
-            return;
+    HttpDownloadOptions options;
+    options.headers = headers;
+    DownloadFile(url, local_path, options, std::move(callback), std::move(progress_callback));
+}
+
+void HttpClient::DownloadFile(const std::string& url, const std::string& local_path, const HttpDownloadOptions& options,
+                             std::function<void(boost::system::error_code, const std::string&)> callback,
+                             HttpProgressCallback progress_callback) {
+    uint64_t existing = 0;
+    if (options.resume) {
+        std::error_code ec;
+        if (std::filesystem::is_regular_file(local_path, ec)) {
+            existing = std::filesystem::file_size(local_path, ec);
+            if (ec) {
+                existing = 0;
+            }
         }
-        
-        if (!response.IsSuccess()) {
-            if (callback) callback(boost::asio::error::invalid_argument, "");
+    }
+    
+    auto call = std::make_shared<DownloadCall>();
+    call->url = url;
+    call->options = options;
+    call->sink = std::make_shared<FileDownloadSink>(local_path, existing);
+    call->callback = std::move(callback);
+    call->progress_callback = std::move(progress_callback);
+    call->start_time = std::chrono::steady_clock::now();
+    
+    StartDownload(call);
+}
+
+void HttpClient::StartDownload(const std::shared_ptr<DownloadCall>& call) {
+    HttpRequest request(HttpMethod::GET, call->url);
+    for (const auto& [name, value] : call->options.headers) {
+        request.SetHeader(name, value);
+    }
+    
+    const uint64_t offset = call->sink->GetSize();
+    if (offset > 0) {
+        request.SetHeader("Range", "bytes=" + std::to_string(offset) + "-");
+        if (!call->sink->GetValidator().empty()) {
+            request.SetHeader("If-Range", call->sink->GetValidator());
+        }
+    }
+    request.SetResponseSink(call->sink);
+    
+    // Report the whole file rather than the current response
+    HttpProgressCallback progress_callback;
+    if (call->progress_callback) {
+        progress_callback = [call](const HttpProgress&) {
+            HttpProgress progress;
+            progress.bytes_downloaded = static_cast<size_t>(call->sink->GetSize());
+            progress.total_download_size = static_cast<size_t>(call->sink->GetTotal().value_or(0));
+            progress.start_time = call->start_time;
+            call->progress_callback(progress);
+        };
+    }
+    
+    auto self = this;
+    std::weak_ptr<int> guard = lifetime_;
+    Request(request, [self, guard, call](boost::system::error_code ec, const HttpResponse& response) {
+        FileDownloadSink& sink = *call->sink;
+        sink.Release();
+        if (!ec && sink.IsAccepted()) {
+            if (call->callback) call->callback(boost::system::error_code{}, sink.GetPath());
             return;
         }
         
-        // Write to file
-        std::ofstream file(local_path, std::ios::binary);
-        if (!file.is_open()) {
-            if (callback) callback(boost::asio::error::access_denied, "");
-            return;
+        // The partial file was already complete
+        if (!ec && response.GetStatusCode() == HttpStatusCode::RANGE_NOT_SATISFIABLE && sink.GetSize() > 0) {
+            std::optional<uint64_t> first;
+            std::optional<uint64_t> total;
+            if (ParseContentRange(response.GetHeader("Content-Range"), first, total) && total == sink.GetSize()) {
+                if (call->callback) call->callback(boost::system::error_code{}, sink.GetPath());
+                return;
+            }
         }
         
-        file.write(response.GetBody().data(), response.GetBody().size());
-        if (file.fail()) {
-            if (callback) callback(boost::asio::error::no_such_device, "");
+        if (ec && ec != boost::asio::error::operation_aborted && !sink.HasFailed() &&
+            call->attempts < call->options.max_resume_attempts && !guard.expired()) {
+            call->attempts++;
+            NETWORK_LOG_WARN("Download of {} interrupted at {} bytes ({}), resuming",
+                             call->url, sink.GetSize(), ec.message());
+            self->StartDownload(call);
             return;
         }
         
-        if (callback) callback(boost::system::error_code{}, local_path);
-    }, headers, progress_callback);
+        if (call->callback) call->callback(ec ? ec : boost::asio::error::invalid_argument, "");
+    }, std::move(progress_callback));
 }
 
 void HttpClient::UploadFile(const std::string& url, const std::string& file_path, const std::string& field_name,
                            HttpResponseCallback callback, HttpProgressCallback progress_callback,
                            const HttpHeaders& headers) {
-    // Read file content
-    std::ifstream file(file_path, std::ios::binary);
-    if (!file.is_open()) {
+    // The file is streamed from disk while the request is written
+    auto body = std::make_shared<HttpMultipartWriter>();
+    if (!body->AddFileFromDisk(field_name, file_path)) {
         if (callback) {
             boost::asio::post(executor_, [callback]() {
                 callback(boost::asio::error::not_found, HttpResponse{});
@@ -860,19 +1673,31 @@ void HttpClient::UploadFile(const std::string& url, const std::string& file_path
         return;
     }
     
-    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    
-    // Create multipart request
     HttpRequest request(HttpMethod::POST, url);
+    request.SetBodyStream(body, body->GetContentType());
+    
+    for (const auto& [name, value] : headers) {
+        request.SetHeader(name, value);
+    }
     
-    // Extract filename from path
-    std::string filename = file_path;
-    size_t last_slash = filename.find_last_of("/\\");
-    if (last_slash != std::string::npos) {
-        filename = filename.substr(last_slash + 1);
+    Request(request, callback, progress_callback);
+}
+
+void HttpClient::UploadFileBody(const std::string& url, const std::string& file_path,
+                                HttpResponseCallback callback, HttpProgressCallback progress_callback,
+                                const HttpHeaders& headers, HttpMethod method) {
+    auto body = HttpFileBodyStream::Open(file_path);
+    if (!body) {
+        if (callback) {
+            boost::asio::post(executor_, [callback]() {
+                callback(boost::asio::error::not_found, HttpResponse{});
+            });
+        }
+        return;
     }
     
-    request.AddFileField(field_name, filename, content, HttpUtils::GetMimeType(filename));
+    HttpRequest request(method, url);
+    request.SetBodyStream(body, HttpUtils::GetMimeType(std::filesystem::path(file_path).extension().string()));
     
     for (const auto& [name, value] : headers) {
         request.SetHeader(name, value);
@@ -904,15 +1729,42 @@ HttpClient::ClientStats HttpClient::GetStats() const {
     
     // Update active sessions count
     std::lock_guard<std::mutex> session_lock(const_cast<std::mutex&>(session_mutex_));
-    current_stats.active_sessions = session_pool_.size() - available_sessions_.size();
+    for (const auto& [origin, pool] : pools_) {
+        current_stats.active_sessions += pool.sessions.size() - pool.idle.size();
+    }
+    
+    // Attempts are counted per request sent; rates are relative to the original requests
+    const size_t extra = current_stats.retries + current_stats.hedges;
+    if (current_stats.total_requests > extra) {
+        const double originals = static_cast<double>(current_stats.total_requests - extra);
+        current_stats.retry_rate = current_stats.retries / originals;
+        current_stats.hedge_rate = current_stats.hedges / originals;
+    }
     
     return current_stats;
 }
 
 void HttpClient::CancelAllRequests() {
-    std::lock_guard<std::mutex> lock(session_mutex_);
-    for (auto& session : session_pool_) {
-        session->Cancel();
+    std::deque<PendingRequest> waiting;
+    {
+        std::lock_guard<std::mutex> lock(session_mutex_);
+        for (auto& [origin, pool] : pools_) {
+            for (auto& session : pool.sessions) {
+                session->Cancel();
+            }
+            for (auto& pending : pool.waiting) {
+                waiting.push_back(std::move(pending));
+            }
+            pool.waiting.clear();
+        }
+    }
+    
+    for (auto& pending : waiting) {
+        if (pending.callback) {
+            boost::asio::post(executor_, [callback = std::move(pending.callback)]() {
+                callback(boost::asio::error::operation_aborted, HttpResponse{});
+            });
+        }
     }
 }
 
@@ -922,7 +1774,14 @@ void HttpClient::WaitForCompletion(std::chrono::milliseconds timeout) {
     while (std::chrono::steady_clock::now() - start_time < timeout) {
         {
             std::lock_guard<std::mutex> lock(session_mutex_);
-            if (available_sessions_.size() == session_pool_.size()) {
+            bool idle = true;
+            for (const auto& [origin, pool] : pools_) {
+                if (!pool.waiting.empty() || pool.idle.size() != pool.sessions.size()) {
+                    idle = false;
+                    break;
+                }
+            }
+            if (idle) {
                 break; // All sessions are available (not busy)
             }
         }
@@ -931,47 +1790,398 @@ void HttpClient::WaitForCompletion(std::chrono::milliseconds timeout) {
 }
 
 // Private methods
-std::shared_ptr<HttpSession> HttpClient::GetAvailableSession() {
-    std::unique_lock<std::mutex> lock(session_mutex_);
+std::string HttpClient::MakeOriginKey(const HttpUrl& url) {
+    const uint16_t port = url.port == 0 ? url.GetDefaultPort() : url.port;
+    return url.scheme + "://" + url.host + ":" + std::to_string(port);
+}
+
+void HttpClient::DispatchRequest(PendingRequest pending) {
+    if (shutdown_requested_) {
+        if (pending.callback) {
+            boost::asio::post(executor_, [callback = std::move(pending.callback)]() {
+                callback(boost::asio::error::operation_aborted, HttpResponse{});
+            });
+        }
+        return;
+    }
+    
+    const std::string origin = MakeOriginKey(pending.request.GetUrl());
+    std::shared_ptr<HttpSession> session;
+    bool pipelined = false;
+    
+    {
+        std::lock_guard<std::mutex> lock(session_mutex_);
+        HostPool& pool = pools_[origin];
+        
+        // Most recently used idle connection first; drop the ones the server closed meanwhile
+        while (!pool.idle.empty()) {
+            auto candidate = std::move(pool.idle.back().first);
+            pool.idle.pop_back();
+            if (candidate->IsReusable()) {
+                session = std::move(candidate);
+                break;
+            }
+            RemoveSessionLocked(pool, candidate);
+        }
+        
+        if (!session && pool.sessions.size() < std::max<size_t>(config_.max_connections_per_host, 1)) {
+            session = std::make_shared<HttpSession>(executor_, config_, dns_cache_);
+            pool.sessions.push_back(session);
+        }
+        
+        // Pool is full: pipeline onto the least loaded connection that still has room
+        if (!session && config_.enable_pipelining && IsPipelinable(pending.request.GetMethod())) {
+            for (const auto& candidate : pool.sessions) {
+                const size_t outstanding = candidate->GetOutstanding();
+                if (outstanding < config_.max_pipeline_depth &&
+                    (!session || outstanding < session->GetOutstanding())) {
+                    session = candidate;
+                }
+            }
+            pipelined = session != nullptr;
+        }
+        
+        if (!session) {
+            pool.waiting.push_back(std::move(pending));
+            return;
+        }
+    }
+    
+    Execute(origin, std::move(session), std::move(pending), pipelined);
+}
+
+void HttpClient::StartAttempt(const std::shared_ptr<PolicyCall>& call, bool hedge) {
+    HttpRequest attempt = call->request;
+    {
+        std::lock_guard<std::mutex> lock(call->mutex);
+        call->in_flight++;
+        
+        // The first attempt goes to the original origin; hedges and retries rotate over the replicas
+        if ((hedge || call->retries > 0) && !call->policy.replicas.empty()) {
+            HttpUrl replica(call->policy.replicas[call->next_replica++ % call->policy.replicas.size()]);
+            HttpUrl url = attempt.GetUrl();
+            url.scheme = replica.scheme;
+            url.host = replica.host;
+            url.port = replica.port;
+            attempt.SetUrl(url);
+        }
+    }
+    
+    auto self = this;
+    std::weak_ptr<int> guard = lifetime_;
+    auto on_response = [self, guard, call, hedge](boost::system::error_code ec, const HttpResponse& response) {
+        if (!guard.expired()) {
+            self->OnAttemptComplete(call, hedge, ec, response);
+            return;
+        }
+        
+        // Client is gone: deliver the first answer without retrying
+        HttpResponseCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(call->mutex);
+            if (call->done) {
+                return;
+            }
+            call->done = true;
+            callback = std::move(call->callback);
+        }
+        if (callback) {
+            callback(ec, response);
+        }
+    };
     
-    // Wait for available session with timeout
-    if (session_cv_.wait_for(lock, std::chrono::milliseconds(1000), 
-                            [this] { return !available_sessions_.empty() || shutdown_requested_; })) {
+    DispatchRequest(PendingRequest{std::move(attempt), std::move(on_response),
+                                   hedge ? nullptr : call->progress_callback});
+}
+
+void HttpClient::OnAttemptComplete(const std::shared_ptr<PolicyCall>& call, bool hedge,
+                                   boost::system::error_code ec, const HttpResponse& response) {
+    HttpResponseCallback callback;
+    boost::system::error_code result_ec = ec;
+    HttpResponse result = response;
+    std::optional<std::chrono::milliseconds> retry_delay;
+    bool budget_exhausted = false;
+    
+    {
+        std::lock_guard<std::mutex> lock(call->mutex);
+        call->in_flight--;
+        if (call->done) {
+            return;
+        }
+        
+        const int status = static_cast<int>(response.GetStatusCode());
+        const bool failed = ec ? ec != boost::asio::error::operation_aborted
+                               : call->policy.retry_on_server_error && (status == 502 || status == 503 || status == 504);
         
-        if (shutdown_requested_ || available_sessions_.empty()) {
-            return nullptr;
+        if (failed) {
+            call->last_error = ec;
+            call->last_response = response;
+            
+            // Another attempt is still running and may succeed
+            if (call->in_flight > 0) {
+                return;
+            }
+            
+            if (call->retries < call->policy.max_retries) {
+                if (retry_budget_.TryWithdraw()) {
+                    call->retries++;
+                    
+                    // Full jitter: uniform in [0, min(max, base * 2^(n-1))]
+                    thread_local std::mt19937_64 rng{std::random_device{}()};
+                    const auto base = call->policy.retry_base_delay.count() << std::min<size_t>(call->retries - 1, 20);
+                    const auto cap = std::min<int64_t>(base, call->policy.retry_max_delay.count());
+                    retry_delay = std::chrono::milliseconds(
+                        std::uniform_int_distribution<int64_t>(0, std::max<int64_t>(cap, 0))(rng));
+                } else {
+                    budget_exhausted = true;
+                }
+            }
         }
         
-        auto session = available_sessions_.front();
-        available_sessions_.pop();
-        return session;
+        if (!retry_delay) {
+            call->done = true;
+            callback = std::move(call->callback);
+            if (call->hedge_timer) {
+                call->hedge_timer->cancel();
+            }
+        }
     }
     
-    // Timeout or no available sessions
-    if (session_pool_.size() < max_pool_size_) {
-        CreateSession();
-        if (!available_sessions_.empty()) {
-            auto session = available_sessions_.front();
-            available_sessions_.pop();
-            return session;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        if (budget_exhausted) {
+            stats_.retry_budget_exhausted++;
         }
+        if (retry_delay) {
+            stats_.retries++;
+        } else if (hedge && callback && !result_ec) {
+            stats_.hedge_wins++;
+        }
+    }
+    
+    if (retry_delay) {
+        NETWORK_LOG_DEBUG("Retrying {} in {}ms", call->request.GetUrl().ToString(), retry_delay->count());
+        
+        std::weak_ptr<int> guard = lifetime_;
+        std::lock_guard<std::mutex> lock(call->mutex);
+        call->retry_timer = std::make_unique<boost::asio::steady_timer>(executor_, *retry_delay);
+        call->retry_timer->async_wait([this, guard, call](boost::system::error_code ec) {
+            if (ec || guard.expired()) {
+                return;
+            }
+            StartAttempt(call, false);
+            ScheduleHedge(call);
+        });
+        return;
     }
     
-    return nullptr;
+    if (callback) {
+        callback(result_ec, result);
+    }
 }
 
-void HttpClient::ReturnSession(std::shared_ptr<HttpSession> session) {
-    if (!session) return;
+void HttpClient::ScheduleHedge(const std::shared_ptr<PolicyCall>& call) {
+    if (!call->policy.enable_hedging) {
+        return;
+    }
     
-    std::lock_guard<std::mutex> lock(session_mutex_);
-    available_sessions_.push(session);
-    session_cv_.notify_one();
+    // No hedging until the origin has enough latency samples
+    auto delay = GetHedgeDelay(call->origin, call->policy.hedge_percentile);
+    if (!delay) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(call->mutex);
+    if (call->done || call->hedges >= call->policy.max_hedges) {
+        return;
+    }
+    
+    call->hedge_timer = std::make_unique<boost::asio::steady_timer>(
+        executor_, std::max(*delay, call->policy.min_hedge_delay));
+    
+    std::weak_ptr<int> guard = lifetime_;
+    call->hedge_timer->async_wait([this, guard, call](boost::system::error_code ec) {
+        if (ec || guard.expired()) {
+            return;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(call->mutex);
+            if (call->done || call->hedges >= call->policy.max_hedges) {
+                return;
+            }
+        }
+        
+        if (!retry_budget_.TryWithdraw()) {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_.retry_budget_exhausted++;
+            return;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(call->mutex);
+            call->hedges++;
+        }
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_.hedges++;
+        }
+        
+        StartAttempt(call, true);
+        ScheduleHedge(call);
+    });
 }
 
-void HttpClient::CreateSession() {
-    auto session = std::make_shared<HttpSession>(executor_, config_);
-    session_pool_.push_back(session);
-    available_sessions_.push(session);
+std::optional<std::chrono::milliseconds> HttpClient::GetHedgeDelay(const std::string& origin, double percentile) {
+    HttpLatencyTracker latencies;
+    {
+        std::lock_guard<std::mutex> lock(session_mutex_);
+        auto it = pools_.find(origin);
+        if (it == pools_.end()) {
+            return std::nullopt;
+        }
+        latencies = it->second.latencies;
+    }
+    return latencies.GetPercentile(percentile);
+}
+
+void HttpClient::Execute(const std::string& origin, std::shared_ptr<HttpSession> session,
+                         PendingRequest pending, bool pipelined) {
+    auto self = this;
+    std::weak_ptr<int> guard = lifetime_;
+    auto start_time = std::chrono::steady_clock::now();
+    
+    auto on_response = [self, guard, origin, session, callback = std::move(pending.callback), start_time]
+                       (boost::system::error_code ec, const HttpResponse& response) {
+        if (!guard.expired()) {
+            // Update statistics
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_time);
+            
+            bool success = !ec && response.IsSuccess();
+            self->UpdateStats(success, duration, 0, response.GetBody().size()); // TODO: get actual bytes sent
+            
+            // Return session to pool (or hand it to the next waiting request)
+            std::optional<std::chrono::microseconds> latency;
+            if (!ec) {
+                latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start_time);
+            }
+            self->ReleaseSession(origin, session, latency);
+        }
+        
+        // Call user callback
+        if (callback) {
+            callback(ec, response);
+        }
+    };
+    
+    if (pipelined) {
+        session->AsyncPipelinedRequest(pending.request, std::move(on_response), std::move(pending.progress_callback));
+    } else {
+        session->AsyncRequest(pending.request, std::move(on_response), std::move(pending.progress_callback));
+    }
+}
+
+void HttpClient::ReleaseSession(const std::string& origin, std::shared_ptr<HttpSession> session,
+                                std::optional<std::chrono::microseconds> latency) {
+    std::shared_ptr<HttpSession> next_session;
+    PendingRequest next;
+    
+    {
+        std::lock_guard<std::mutex> lock(session_mutex_);
+        auto it = pools_.find(origin);
+        if (it == pools_.end()) {
+            return;
+        }
+        HostPool& pool = it->second;
+        
+        if (latency) {
+            pool.latencies.Record(*latency);
+        }
+        
+        // Still carrying pipelined requests
+        if (session->GetOutstanding() > 0) {
+            return;
+        }
+        
+        if (session->IsReusable()) {
+            next_session = session;
+        } else {
+            RemoveSessionLocked(pool, session);
+        }
+        
+        if (!pool.waiting.empty()) {
+            next = std::move(pool.waiting.front());
+            pool.waiting.pop_front();
+            if (!next_session) {
+                next_session = std::make_shared<HttpSession>(executor_, config_, dns_cache_);
+                pool.sessions.push_back(next_session);
+            }
+        } else if (next_session) {
+            if (pool.idle.size() < config_.max_idle_connections_per_host) {
+                pool.idle.emplace_back(std::move(next_session), std::chrono::steady_clock::now());
+            } else {
+                RemoveSessionLocked(pool, next_session);
+            }
+            return;
+        } else {
+            return;
+        }
+    }
+    
+    Execute(origin, std::move(next_session), std::move(next), false);
+}
+
+void HttpClient::RemoveSessionLocked(HostPool& pool, const std::shared_ptr<HttpSession>& session) {
+    pool.sessions.erase(std::remove(pool.sessions.begin(), pool.sessions.end(), session), pool.sessions.end());
+    pool.idle.erase(std::remove_if(pool.idle.begin(), pool.idle.end(),
+                                   [&session](const auto& entry) { return entry.first == session; }),
+                    pool.idle.end());
+    session->Cancel();
+}
+
+void HttpClient::ScheduleIdleSweep() {
+    if (!idle_timer_ || shutdown_requested_) {
+        return;
+    }
+    
+    const auto interval = std::max(config_.idle_timeout / 2, std::chrono::milliseconds{1000});
+    idle_timer_->expires_after(interval);
+    
+    std::weak_ptr<int> guard = lifetime_;
+    idle_timer_->async_wait([this, guard](boost::system::error_code ec) {
+        if (ec || guard.expired()) {
+            return;
+        }
+        CleanupSessions();
+        ScheduleIdleSweep();
+    });
+}
+
+void HttpClient::CleanupSessions() {
+    std::lock_guard<std::mutex> lock(session_mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    
+    for (auto it = pools_.begin(); it != pools_.end();) {
+        HostPool& pool = it->second;
+        
+        std::vector<std::shared_ptr<HttpSession>> expired;
+        for (const auto& [session, since] : pool.idle) {
+            if (now - since >= config_.idle_timeout || !session->IsReusable()) {
+                expired.push_back(session);
+            }
+        }
+        for (const auto& session : expired) {
+            RemoveSessionLocked(pool, session);
+        }
+        
+        if (pool.sessions.empty() && pool.waiting.empty()) {
+            it = pools_.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
 
 HttpRequest HttpClient::PrepareRequest(const HttpRequest& original_request) const {
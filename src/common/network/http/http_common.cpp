@@ -3,6 +3,7 @@
 #include <sstream>
 #include <iomanip>
 #include <cctype>
+#include <cstring>
 #include <random>
 
 namespace common {
@@ -60,6 +61,83 @@ uint16_t HttpUrl::GetDefaultPort() const {
     return 0;
 }
 
+// HttpArena Implementation
+HttpArena::HttpArena(size_t initial_size)
+    : buffer_(new std::byte[initial_size]),
+      resource_(buffer_.get(), initial_size) {
+}
+
+namespace {
+
+int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Same rules as UrlDecode, written into an arena string
+void UrlDecodeInto(std::string_view input, std::pmr::string& output) {
+    output.reserve(input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+        if (input[i] == '%' && i + 2 < input.size()) {
+            const int high = HexValue(input[i + 1]);
+            const int low = HexValue(input[i + 2]);
+            if (high >= 0 && low >= 0) {
+                output += static_cast<char>(high * 16 + low);
+                i += 2;
+                continue;
+            }
+        }
+        output += input[i] == '+' ? ' ' : input[i];
+    }
+}
+
+std::string_view TrimView(std::string_view value) {
+    const size_t begin = value.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    const size_t end = value.find_last_not_of(" \t");
+    return value.substr(begin, end - begin + 1);
+}
+
+constexpr uint64_t kPrime64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime64_5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t Rotl64(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Native byte order loads; hashes are only compared within one process
+inline uint64_t Read64(const char* data) {
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline uint32_t Read32(const char* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline uint64_t HashRound(uint64_t acc, uint64_t input) {
+    acc += input * kPrime64_2;
+    acc = Rotl64(acc, 31);
+    return acc * kPrime64_1;
+}
+
+inline uint64_t HashMerge(uint64_t acc, uint64_t value) {
+    acc ^= HashRound(0, value);
+    return acc * kPrime64_1 + kPrime64_4;
+}
+
+} // namespace
+
 // HttpUtils Implementation
 namespace HttpUtils {
 
@@ -120,6 +198,8 @@ std::string StatusCodeToString(HttpStatusCode code) {
         case HttpStatusCode::GONE: return "Gone";
         case HttpStatusCode::PAYLOAD_TOO_LARGE: return "Payload Too Large";
         case HttpStatusCode::UNSUPPORTED_MEDIA_TYPE: return "Unsupported Media Type";
+        case HttpStatusCode::RANGE_NOT_SATISFIABLE: return "Range Not Satisfiable";
+        case HttpStatusCode::UPGRADE_REQUIRED: return "Upgrade Required";
         case HttpStatusCode::TOO_MANY_REQUESTS: return "Too Many Requests";
         case HttpStatusCode::INTERNAL_SERVER_ERROR: return "Internal Server Error";
         case HttpStatusCode::NOT_IMPLEMENTED: return "Not Implemented";
@@ -207,7 +287,7 @@ std::string BuildUrl(const std::string& base_url, const HttpParams& params) {
     return result;
 }
 
-std::string UrlEncode(const std::string& input) {
+std::string UrlEncode(std::string_view input) {
     std::ostringstream oss;
     oss << std::hex << std::uppercase;
     
@@ -269,6 +349,28 @@ HttpParams ParseQueryString(const std::string& query) {
     return params;
 }
 
+HttpArenaParams ParseQueryString(std::string_view query, std::pmr::memory_resource* arena) {
+    HttpArenaParams params(arena);
+    
+    while (!query.empty()) {
+        const size_t amp = query.find('&');
+        const std::string_view pair = query.substr(0, amp);
+        query = amp == std::string_view::npos ? std::string_view() : query.substr(amp + 1);
+        if (pair.empty()) {
+            continue;
+        }
+        
+        const size_t equals_pos = pair.find('=');
+        auto& param = params.emplace_back();
+        UrlDecodeInto(pair.substr(0, equals_pos), param.first);
+        if (equals_pos != std::string_view::npos) {
+            UrlDecodeInto(pair.substr(equals_pos + 1), param.second);
+        }
+    }
+    
+    return params;
+}
+
 std::string BuildQueryString(const HttpParams& params) {
     if (params.empty()) {
         return "";
@@ -316,6 +418,23 @@ std::vector<HttpCookie> ParseCookies(const std::string& cookie_header) {
     return cookies;
 }
 
+HttpCookieViews ParseCookies(std::string_view cookie_header, std::pmr::memory_resource* arena) {
+    HttpCookieViews cookies(arena);
+    
+    while (!cookie_header.empty()) {
+        const size_t semicolon = cookie_header.find(';');
+        const std::string_view cookie_pair = TrimView(cookie_header.substr(0, semicolon));
+        cookie_header = semicolon == std::string_view::npos ? std::string_view() : cookie_header.substr(semicolon + 1);
+        
+        const size_t equals_pos = cookie_pair.find('=');
+        if (equals_pos != std::string_view::npos) {
+            cookies.emplace_back(cookie_pair.substr(0, equals_pos), cookie_pair.substr(equals_pos + 1));
+        }
+    }
+    
+    return cookies;
+}
+
 std::string BuildCookieHeader(const std::vector<HttpCookie>& cookies) {
     if (cookies.empty()) {
         return "";
@@ -396,6 +515,14 @@ std::string BuildContentType(const ContentType& content_type) {
     return result;
 }
 
+HttpHeaders ToHeaderMap(const HttpFields& fields) {
+    HttpHeaders headers;
+    for (const auto& field : fields) {
+        headers[std::string(field.name_string())] = std::string(field.value());
+    }
+    return headers;
+}
+
 std::string GetMimeType(const std::string& file_extension) {
     static const std::unordered_map<std::string, std::string> mime_types = {
         // Text
@@ -459,6 +586,85 @@ bool IsMultipartContentType(const std::string& content_type) {
     return ct.media_type.substr(0, 10) == "multipart/";
 }
 
+uint64_t Hash64(std::string_view data, uint64_t seed) {
+    const char* p = data.data();
+    const char* const end = p + data.size();
+    uint64_t hash;
+    
+    // Four independent lanes over 32-byte stripes
+    if (data.size() >= 32) {
+        uint64_t v1 = seed + kPrime64_1 + kPrime64_2;
+        uint64_t v2 = seed + kPrime64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kPrime64_1;
+        const char* const limit = end - 32;
+        do {
+            v1 = HashRound(v1, Read64(p));
+            v2 = HashRound(v2, Read64(p + 8));
+            v3 = HashRound(v3, Read64(p + 16));
+            v4 = HashRound(v4, Read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        
+        hash = Rotl64(v1, 1) + Rotl64(v2, 7) + Rotl64(v3, 12) + Rotl64(v4, 18);
+        hash = HashMerge(hash, v1);
+        hash = HashMerge(hash, v2);
+        hash = HashMerge(hash, v3);
+        hash = HashMerge(hash, v4);
+    } else {
+        hash = seed + kPrime64_5;
+    }
+    hash += static_cast<uint64_t>(data.size());
+    
+    for (; p + 8 <= end; p += 8) {
+        hash ^= HashRound(0, Read64(p));
+        hash = Rotl64(hash, 27) * kPrime64_1 + kPrime64_4;
+    }
+    if (p + 4 <= end) {
+        hash ^= static_cast<uint64_t>(Read32(p)) * kPrime64_1;
+        hash = Rotl64(hash, 23) * kPrime64_2 + kPrime64_3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash ^= static_cast<uint64_t>(static_cast<unsigned char>(*p)) * kPrime64_5;
+        hash = Rotl64(hash, 11) * kPrime64_1;
+    }
+    
+    hash ^= hash >> 33;
+    hash *= kPrime64_2;
+    hash ^= hash >> 29;
+    hash *= kPrime64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+bool EtagMatches(std::string_view if_none_match, std::string_view etag) {
+    if (etag.substr(0, 2) == "W/") {
+        etag.remove_prefix(2);
+    }
+    
+    size_t pos = 0;
+    while (pos <= if_none_match.size()) {
+        size_t end = if_none_match.find(',', pos);
+        if (end == std::string_view::npos) {
+            end = if_none_match.size();
+        }
+        
+        std::string_view candidate = TrimView(if_none_match.substr(pos, end - pos));
+        if (candidate == "*") {
+            return true;
+        }
+        if (candidate.substr(0, 2) == "W/") {
+            candidate.remove_prefix(2);
+        }
+        if (!candidate.empty() && candidate == etag) {
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
 std::string GenerateBoundary() {
     static std::random_device rd;
     static std::mt19937 gen(rd());
@@ -0,0 +1,224 @@
+#include "common/network/http/http_compression.h"
+#include "common/network/http/http_common.h"
+#include <zlib.h>
+#ifdef ZEUS_HTTP_HAS_BROTLI
+#include <brotli/encode.h>
+#endif
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <functional>
+
+namespace common {
+namespace network {
+namespace http {
+
+namespace {
+
+/**
+ * @brief 线程内复用的zlib压缩流，压缩级别变化时重新初始化
+ */
+class ZlibStream {
+public:
+    explicit ZlibStream(int window_bits) : window_bits_(window_bits) {}
+
+    ~ZlibStream() {
+        if (initialized_) {
+            deflateEnd(&stream_);
+        }
+    }
+
+    ZlibStream(const ZlibStream&) = delete;
+    ZlibStream& operator=(const ZlibStream&) = delete;
+
+    bool Compress(std::string_view input, int level, std::string& output) {
+        if (input.size() > UINT_MAX) {
+            return false;
+        }
+
+        level = std::clamp(level, 1, 9);
+        if (!initialized_ || level != level_) {
+            if (initialized_) {
+                deflateEnd(&stream_);
+                initialized_ = false;
+            }
+            stream_ = z_stream{};
+            if (deflateInit2(&stream_, level, Z_DEFLATED, window_bits_, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                return false;
+            }
+            initialized_ = true;
+            level_ = level;
+        } else if (deflateReset(&stream_) != Z_OK) {
+            return false;
+        }
+
+        output.resize(deflateBound(&stream_, static_cast<uLong>(input.size())));
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream_.avail_in = static_cast<uInt>(input.size());
+        stream_.next_out = reinterpret_cast<Bytef*>(&output[0]);
+        stream_.avail_out = static_cast<uInt>(output.size());
+
+        if (deflate(&stream_, Z_FINISH) != Z_STREAM_END) {
+            output.clear();
+            return false;
+        }
+
+        output.resize(stream_.total_out);
+        return true;
+    }
+
+private:
+    z_stream stream_{};
+    int window_bits_;
+    int level_ = 0;
+    bool initialized_ = false;
+};
+
+// gzip格式：窗口位数加16
+ZlibStream& GzipStream() {
+    thread_local ZlibStream stream(MAX_WBITS + 16);
+    return stream;
+}
+
+// HTTP的deflate编码实际为zlib格式
+ZlibStream& DeflateStream() {
+    thread_local ZlibStream stream(MAX_WBITS);
+    return stream;
+}
+
+#ifdef ZEUS_HTTP_HAS_BROTLI
+bool BrotliCompress(std::string_view input, int level, std::string& output) {
+    size_t encoded_size = BrotliEncoderMaxCompressedSize(input.size());
+    if (encoded_size == 0) {
+        return false;
+    }
+
+    output.resize(encoded_size);
+    const int quality = std::clamp(level, BROTLI_MIN_QUALITY, BROTLI_MAX_QUALITY);
+    if (!BrotliEncoderCompress(quality, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                               input.size(), reinterpret_cast<const uint8_t*>(input.data()),
+                               &encoded_size, reinterpret_cast<uint8_t*>(&output[0]))) {
+        output.clear();
+        return false;
+    }
+
+    output.resize(encoded_size);
+    return true;
+}
+#endif
+
+} // namespace
+
+// ===== HttpCompressor Implementation =====
+
+bool HttpCompressor::IsSupported(std::string_view encoding) {
+#ifdef ZEUS_HTTP_HAS_BROTLI
+    if (encoding == "br") {
+        return true;
+    }
+#endif
+    return encoding == "gzip" || encoding == "deflate";
+}
+
+bool HttpCompressor::Compress(std::string_view input, std::string_view encoding, int level, std::string& output) {
+    if (encoding == "gzip") {
+        return GzipStream().Compress(input, level, output);
+    }
+    if (encoding == "deflate") {
+        return DeflateStream().Compress(input, level, output);
+    }
+#ifdef ZEUS_HTTP_HAS_BROTLI
+    if (encoding == "br") {
+        return BrotliCompress(input, level, output);
+    }
+#endif
+    return false;
+}
+
+// ===== HttpCompressionCache Implementation =====
+
+HttpCompressionCache::HttpCompressionCache(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+std::string HttpCompressionCache::MakeKey(std::string_view encoding, std::string_view etag,
+                                          std::string_view target, std::string_view body) {
+    std::string key(encoding);
+    key += '|';
+
+    // 同一路径按查询参数返回不同内容时ETag可能相同（如按页码生成的弱ETag），键中需包含查询字符串
+    if (!etag.empty()) {
+        key += "e|";
+        key += target;
+        key += '|';
+        key += etag;
+        return key;
+    }
+
+    // 两个独立的64位哈希加长度，避免哈希碰撞返回错误的响应体
+    char digest[64];
+    std::snprintf(digest, sizeof(digest), "h|%016llx%016llx|%zu",
+                  static_cast<unsigned long long>(HttpUtils::Hash64(body)),
+                  static_cast<unsigned long long>(std::hash<std::string_view>{}(body)),
+                  body.size());
+    key += digest;
+    return key;
+}
+
+std::shared_ptr<const std::string> HttpCompressionCache::Get(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        return nullptr;
+    }
+
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->data;
+}
+
+void HttpCompressionCache::Put(const std::string& key, std::shared_ptr<const std::string> data) {
+    if (!data || data->size() > max_bytes_) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        bytes_ -= it->second->data->size();
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    bytes_ += data->size();
+    lru_.push_front(Entry{key, std::move(data)});
+    index_[key] = lru_.begin();
+    EvictLocked();
+}
+
+void HttpCompressionCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
+
+size_t HttpCompressionCache::GetBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+size_t HttpCompressionCache::GetEntries() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+void HttpCompressionCache::EvictLocked() {
+    while (bytes_ > max_bytes_ && !lru_.empty()) {
+        const Entry& victim = lru_.back();
+        bytes_ -= victim.data->size();
+        index_.erase(victim.key);
+        lru_.pop_back();
+    }
+}
+
+} // namespace http
+} // namespace network
+} // namespace common
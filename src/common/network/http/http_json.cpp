@@ -0,0 +1,420 @@
+#include "common/network/http/http_json.h"
+#include <array>
+#include <cmath>
+
+#ifdef ZEUS_HTTP_HAS_SIMDJSON
+#include <simdjson.h>
+#endif
+
+namespace common {
+namespace network {
+namespace http {
+
+namespace {
+
+// Bytes that must be escaped inside a JSON string: quote, backslash and control characters
+constexpr std::array<bool, 256> MakeEscapeTable() {
+    std::array<bool, 256> table{};
+    for (int c = 0; c < 0x20; ++c) {
+        table[c] = true;
+    }
+    table['"'] = true;
+    table['\\'] = true;
+    return table;
+}
+
+constexpr std::array<bool, 256> kEscapeTable = MakeEscapeTable();
+
+// Append value as a quoted JSON string; unescaped runs are copied in one piece
+void AppendQuoted(std::string& out, std::string_view value) {
+    static const char kHex[] = "0123456789abcdef";
+    
+    out.push_back('"');
+    size_t run = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(value[i]);
+        if (!kEscapeTable[c]) {
+            continue;
+        }
+        
+        out.append(value.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"': out.append("\\\"", 2); break;
+            case '\\': out.append("\\\\", 2); break;
+            case '\n': out.append("\\n", 2); break;
+            case '\r': out.append("\\r", 2); break;
+            case '\t': out.append("\\t", 2); break;
+            case '\b': out.append("\\b", 2); break;
+            case '\f': out.append("\\f", 2); break;
+            default: {
+                const char escaped[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0x0f]};
+                out.append(escaped, sizeof(escaped));
+                break;
+            }
+        }
+    }
+    out.append(value.data() + run, value.size() - run);
+    out.push_back('"');
+}
+
+const nlohmann::json& NullJson() {
+    static const nlohmann::json null_json;
+    return null_json;
+}
+
+#ifdef ZEUS_HTTP_HAS_SIMDJSON
+
+// The parser only holds scratch buffers (the parsed tape lives in each document), so one per thread is reused
+simdjson::dom::parser& ThreadParser() {
+    thread_local simdjson::dom::parser parser;
+    return parser;
+}
+
+nlohmann::json ToNlohmann(simdjson::dom::element element) {
+    switch (element.type()) {
+        case simdjson::dom::element_type::ARRAY: {
+            nlohmann::json array = nlohmann::json::array();
+            for (simdjson::dom::element child : simdjson::dom::array(element)) {
+                array.push_back(ToNlohmann(child));
+            }
+            return array;
+        }
+        case simdjson::dom::element_type::OBJECT: {
+            nlohmann::json object = nlohmann::json::object();
+            for (simdjson::dom::key_value_pair field : simdjson::dom::object(element)) {
+                object[std::string(field.key)] = ToNlohmann(field.value);
+            }
+            return object;
+        }
+        case simdjson::dom::element_type::INT64:
+            return element.get_int64().value_unsafe();
+        case simdjson::dom::element_type::UINT64:
+            return element.get_uint64().value_unsafe();
+        case simdjson::dom::element_type::DOUBLE:
+            return element.get_double().value_unsafe();
+        case simdjson::dom::element_type::STRING:
+            return std::string(element.get_string().value_unsafe());
+        case simdjson::dom::element_type::BOOL:
+            return element.get_bool().value_unsafe();
+        case simdjson::dom::element_type::NULL_VALUE:
+        default:
+            return nullptr;
+    }
+}
+
+#else
+
+nlohmann::json::json_pointer MakePointer(std::string_view pointer) {
+    return nlohmann::json::json_pointer(std::string(pointer));
+}
+
+#endif
+
+} // namespace
+
+#ifdef ZEUS_HTTP_HAS_SIMDJSON
+
+struct HttpJsonDocument::Impl {
+    simdjson::dom::document document;
+    simdjson::dom::element root;
+    bool valid = false;
+    std::string error;
+
+    bool Find(std::string_view pointer, simdjson::dom::element& element) const {
+        return valid && !root.at_pointer(pointer).get(element);
+    }
+};
+
+std::shared_ptr<const HttpJsonDocument> HttpJsonDocument::Parse(std::string_view text) {
+    std::shared_ptr<HttpJsonDocument> document(new HttpJsonDocument());
+    Impl& impl = *document->impl_;
+    auto error = ThreadParser().parse_into_document(impl.document, text.data(), text.size()).get(impl.root);
+    impl.valid = !error;
+    if (error) {
+        impl.error = simdjson::error_message(error);
+    }
+    return document;
+}
+
+const char* HttpJsonDocument::GetBackend() {
+    return "simdjson";
+}
+
+HttpJsonType HttpJsonDocument::GetType(std::string_view pointer) const {
+    simdjson::dom::element element;
+    if (!impl_->Find(pointer, element)) {
+        return HttpJsonType::MISSING;
+    }
+    switch (element.type()) {
+        case simdjson::dom::element_type::ARRAY: return HttpJsonType::ARRAY;
+        case simdjson::dom::element_type::OBJECT: return HttpJsonType::OBJECT;
+        case simdjson::dom::element_type::STRING: return HttpJsonType::STRING;
+        case simdjson::dom::element_type::BOOL: return HttpJsonType::BOOLEAN;
+        case simdjson::dom::element_type::NULL_VALUE: return HttpJsonType::NULL_VALUE;
+        default: return HttpJsonType::NUMBER;
+    }
+}
+
+std::optional<std::string_view> HttpJsonDocument::GetString(std::string_view pointer) const {
+    simdjson::dom::element element;
+    std::string_view value;
+    if (!impl_->Find(pointer, element) || element.get_string().get(value)) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<int64_t> HttpJsonDocument::GetInt(std::string_view pointer) const {
+    simdjson::dom::element element;
+    int64_t value = 0;
+    if (!impl_->Find(pointer, element) || element.get_int64().get(value)) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<double> HttpJsonDocument::GetDouble(std::string_view pointer) const {
+    simdjson::dom::element element;
+    double value = 0;
+    if (!impl_->Find(pointer, element) || element.get_double().get(value)) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<bool> HttpJsonDocument::GetBool(std::string_view pointer) const {
+    simdjson::dom::element element;
+    bool value = false;
+    if (!impl_->Find(pointer, element) || element.get_bool().get(value)) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+size_t HttpJsonDocument::GetSize(std::string_view pointer) const {
+    simdjson::dom::element element;
+    if (!impl_->Find(pointer, element)) {
+        return 0;
+    }
+    if (element.is_array()) {
+        return simdjson::dom::array(element).size();
+    }
+    if (element.is_object()) {
+        return simdjson::dom::object(element).size();
+    }
+    return 0;
+}
+
+nlohmann::json HttpJsonDocument::ToJson(std::string_view pointer) const {
+    simdjson::dom::element element;
+    if (!impl_->Find(pointer, element)) {
+        return nlohmann::json();
+    }
+    return ToNlohmann(element);
+}
+
+std::shared_ptr<const nlohmann::json> HttpJsonDocument::ToSharedJson() const {
+    return std::make_shared<const nlohmann::json>(ToJson());
+}
+
+#else
+
+struct HttpJsonDocument::Impl {
+    std::shared_ptr<const nlohmann::json> json;
+    bool valid = false;
+    std::string error;
+
+    const nlohmann::json* Find(std::string_view pointer) const {
+        if (!valid) {
+            return nullptr;
+        }
+        if (pointer.empty()) {
+            return json.get();
+        }
+        try {
+            const auto json_pointer = MakePointer(pointer);
+            return json->contains(json_pointer) ? &json->at(json_pointer) : nullptr;
+        } catch (const nlohmann::json::exception&) {
+            return nullptr;
+        }
+    }
+};
+
+std::shared_ptr<const HttpJsonDocument> HttpJsonDocument::Parse(std::string_view text) {
+    std::shared_ptr<HttpJsonDocument> document(new HttpJsonDocument());
+    Impl& impl = *document->impl_;
+    try {
+        impl.json = std::make_shared<const nlohmann::json>(nlohmann::json::parse(text));
+        impl.valid = true;
+    } catch (const nlohmann::json::exception& e) {
+        impl.error = e.what();
+    }
+    return document;
+}
+
+const char* HttpJsonDocument::GetBackend() {
+    return "nlohmann";
+}
+
+HttpJsonType HttpJsonDocument::GetType(std::string_view pointer) const {
+    const nlohmann::json* value = impl_->Find(pointer);
+    if (!value) {
+        return HttpJsonType::MISSING;
+    }
+    switch (value->type()) {
+        case nlohmann::json::value_t::array: return HttpJsonType::ARRAY;
+        case nlohmann::json::value_t::object: return HttpJsonType::OBJECT;
+        case nlohmann::json::value_t::string: return HttpJsonType::STRING;
+        case nlohmann::json::value_t::boolean: return HttpJsonType::BOOLEAN;
+        case nlohmann::json::value_t::null: return HttpJsonType::NULL_VALUE;
+        default: return HttpJsonType::NUMBER;
+    }
+}
+
+std::optional<std::string_view> HttpJsonDocument::GetString(std::string_view pointer) const {
+    const nlohmann::json* value = impl_->Find(pointer);
+    if (!value || !value->is_string()) {
+        return std::nullopt;
+    }
+    return std::string_view(value->get_ref<const std::string&>());
+}
+
+std::optional<int64_t> HttpJsonDocument::GetInt(std::string_view pointer) const {
+    const nlohmann::json* value = impl_->Find(pointer);
+    if (!value || !value->is_number_integer()) {
+        return std::nullopt;
+    }
+    if (value->is_number_unsigned() && value->get<uint64_t>() > static_cast<uint64_t>(INT64_MAX)) {
+        return std::nullopt;
+    }
+    return value->get<int64_t>();
+}
+
+std::optional<double> HttpJsonDocument::GetDouble(std::string_view pointer) const {
+    const nlohmann::json* value = impl_->Find(pointer);
+    if (!value || !value->is_number()) {
+        return std::nullopt;
+    }
+    return value->get<double>();
+}
+
+std::optional<bool> HttpJsonDocument::GetBool(std::string_view pointer) const {
+    const nlohmann::json* value = impl_->Find(pointer);
+    if (!value || !value->is_boolean()) {
+        return std::nullopt;
+    }
+    return value->get<bool>();
+}
+
+size_t HttpJsonDocument::GetSize(std::string_view pointer) const {
+    const nlohmann::json* value = impl_->Find(pointer);
+    return value && value->is_structured() ? value->size() : 0;
+}
+
+nlohmann::json HttpJsonDocument::ToJson(std::string_view pointer) const {
+    const nlohmann::json* value = impl_->Find(pointer);
+    return value ? *value : nlohmann::json();
+}
+
+std::shared_ptr<const nlohmann::json> HttpJsonDocument::ToSharedJson() const {
+    return impl_->valid ? impl_->json : std::make_shared<const nlohmann::json>();
+}
+
+#endif
+
+HttpJsonDocument::HttpJsonDocument() : impl_(std::make_unique<Impl>()) {}
+
+HttpJsonDocument::~HttpJsonDocument() = default;
+
+bool HttpJsonDocument::IsValid() const {
+    return impl_->valid;
+}
+
+const std::string& HttpJsonDocument::GetError() const {
+    return impl_->error;
+}
+
+// ===== HttpJsonCache =====
+
+const nlohmann::json& HttpJsonCache::Get(std::string_view body) const {
+    if (json_) {
+        return *json_;
+    }
+
+    if (document_) {
+        // Built from the document instead of parsing the text a second time
+        json_valid_ = document_->IsValid();
+        json_ = document_->ToSharedJson();
+        return *json_;
+    }
+
+    try {
+        json_ = std::make_shared<const nlohmann::json>(nlohmann::json::parse(body));
+        json_valid_ = true;
+    } catch (const nlohmann::json::exception&) {
+        json_valid_ = false;
+        json_ = std::shared_ptr<const nlohmann::json>(std::shared_ptr<const nlohmann::json>(), &NullJson());
+    }
+    return *json_;
+}
+
+std::shared_ptr<const HttpJsonDocument> HttpJsonCache::GetDocument(std::string_view body) const {
+    if (document_) {
+        return document_;
+    }
+
+#ifndef ZEUS_HTTP_HAS_SIMDJSON
+    // Same backend: wrap the tree that is already there
+    if (json_ && json_valid_) {
+        std::shared_ptr<HttpJsonDocument> document(new HttpJsonDocument());
+        document->impl_->json = json_;
+        document->impl_->valid = true;
+        document_ = std::move(document);
+        return document_;
+    }
+#endif
+
+    document_ = HttpJsonDocument::Parse(body);
+    return document_;
+}
+
+// ===== HttpJsonKey / HttpJsonWriter =====
+
+HttpJsonKey::HttpJsonKey(std::string_view key) {
+    rendered_.reserve(key.size() + 3);
+    AppendQuoted(rendered_, key);
+    rendered_.push_back(':');
+}
+
+HttpJsonWriter& HttpJsonWriter::Key(std::string_view key) {
+    Separate();
+    AppendQuoted(*out_, key);
+    out_->push_back(':');
+    need_comma_ = false;
+    return *this;
+}
+
+HttpJsonWriter& HttpJsonWriter::Double(double value) {
+    Separate();
+    if (!std::isfinite(value)) {
+        out_->append("null", 4);
+        return *this;
+    }
+    
+    // Shortest representation that reads back as the same double
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out_->append(digits, static_cast<size_t>(result.ptr - digits));
+    return *this;
+}
+
+HttpJsonWriter& HttpJsonWriter::String(std::string_view value) {
+    Separate();
+    AppendQuoted(*out_, value);
+    return *this;
+}
+
+} // namespace http
+} // namespace network
+} // namespace common
@@ -1,4 +1,6 @@
 #include "common/network/http/http_message.h"
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 // TODO: Implement or include proper Base64 library
@@ -7,6 +9,116 @@ namespace common {
 namespace network {
 namespace http {
 
+namespace {
+
+// Query parameters are decoded lazily from url.query
+void ParseTarget(boost::beast::string_view target, HttpUrl& url) {
+    size_t query_pos = target.find('?');
+    if (query_pos != boost::beast::string_view::npos) {
+        url.path = std::string(target.substr(0, query_pos));
+        url.query = std::string(target.substr(query_pos + 1));
+    } else {
+        url.path = std::string(target);
+    }
+}
+
+void AppendSetCookies(const HttpFields& fields, std::vector<HttpCookie>& cookies) {
+    for (auto it = fields.find(boost::beast::http::field::set_cookie);
+         it != fields.end() && it->name() == boost::beast::http::field::set_cookie; ++it) {
+        auto parsed = HttpUtils::ParseCookies(std::string(it->value()));
+        cookies.insert(cookies.end(), parsed.begin(), parsed.end());
+    }
+}
+
+std::string_view FieldView(const HttpFields& fields, std::string_view name) {
+    auto it = fields.find(boost::beast::string_view(name.data(), name.size()));
+    if (it == fields.end()) {
+        return {};
+    }
+    return std::string_view(it->value().data(), it->value().size());
+}
+
+} // namespace
+
+// HttpFileChunkReader Implementation
+HttpFileChunkReader::HttpFileChunkReader() = default;
+
+HttpFileChunkReader::~HttpFileChunkReader() = default;
+
+bool HttpFileChunkReader::Append(const std::string& path, uint64_t offset, size_t n, std::string& out,
+                                 boost::system::error_code& ec) {
+    if (!file_) {
+        file_ = std::make_unique<std::ifstream>(path, std::ios::binary);
+        if (!file_->is_open()) {
+            file_.reset();
+            ec = boost::system::errc::make_error_code(boost::system::errc::no_such_file_or_directory);
+            return false;
+        }
+        file_->seekg(static_cast<std::streamoff>(offset));
+    }
+    
+    const size_t old_size = out.size();
+    out.resize(old_size + n);
+    file_->read(&out[old_size], static_cast<std::streamsize>(n));
+    if (static_cast<size_t>(file_->gcount()) != n) {
+        // The file shrank after its size was taken; Content-Length can no longer be met
+        file_.reset();
+        out.resize(old_size);
+        ec = boost::system::errc::make_error_code(boost::system::errc::io_error);
+        return false;
+    }
+    return true;
+}
+
+void HttpFileChunkReader::Close() {
+    file_.reset();
+}
+
+// HttpFileBodyStream Implementation
+std::shared_ptr<HttpFileBodyStream> HttpFileBodyStream::Open(const std::string& path, uint64_t offset,
+                                                             std::optional<uint64_t> length, size_t chunk_size) {
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec)) {
+        return nullptr;
+    }
+    const uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec || offset > size || (length && *length > size - offset)) {
+        return nullptr;
+    }
+    
+    return std::shared_ptr<HttpFileBodyStream>(
+        new HttpFileBodyStream(path, offset, length.value_or(size - offset), std::max<size_t>(chunk_size, 1)));
+}
+
+HttpFileBodyStream::HttpFileBodyStream(std::string path, uint64_t offset, uint64_t length, size_t chunk_size)
+    : path_(std::move(path)), offset_(offset), length_(length), chunk_size_(chunk_size) {
+}
+
+HttpFileBodyStream::~HttpFileBodyStream() = default;
+
+bool HttpFileBodyStream::Read(std::string& chunk, boost::system::error_code& ec) {
+    chunk.clear();
+    ec = {};
+    if (position_ == length_) {
+        reader_.Close();
+        return false;
+    }
+    
+    const size_t n = static_cast<size_t>(std::min<uint64_t>(length_ - position_, chunk_size_));
+    if (!reader_.Append(path_, offset_ + position_, n, chunk, ec)) {
+        return false;
+    }
+    
+    position_ += n;
+    return true;
+}
+
+bool HttpFileBodyStream::Rewind() {
+    reader_.Close();
+    position_ = 0;
+    return true;
+}
+
 // HttpRequest Implementation
 HttpRequest::HttpRequest(HttpMethod method, const std::string& url)
     : method_(method), url_(url) {
@@ -16,9 +128,19 @@ HttpRequest::HttpRequest(HttpMethod method, const HttpUrl& url)
     : method_(method), url_(url) {
 }
 
+void HttpRequest::SetHeaders(const HttpHeaders& headers) {
+    headers_.clear();
+    for (const auto& [name, value] : headers) {
+        headers_.set(name, value);
+    }
+}
+
 std::string HttpRequest::GetHeader(const std::string& name) const {
-    auto it = headers_.find(name);
-    return (it != headers_.end()) ? it->second : "";
+    return std::string(FieldView(headers_, name));
+}
+
+std::string_view HttpRequest::GetHeaderView(std::string_view name) const {
+    return FieldView(headers_, name);
 }
 
 bool HttpRequest::HasHeader(const std::string& name) const {
@@ -30,20 +152,94 @@ void HttpRequest::RemoveHeader(const std::string& name) {
 }
 
 std::string HttpRequest::GetParam(const std::string& name) const {
+    if (query_pending_) {
+        // Look up the decoded views instead of building the parameter map; the last value wins
+        const auto& params = GetQueryViews();
+        for (auto it = params.rbegin(); it != params.rend(); ++it) {
+            if (std::string_view(it->first) == name) {
+                return std::string(it->second);
+            }
+        }
+        return "";
+    }
     auto it = params_.find(name);
     return (it != params_.end()) ? it->second : "";
 }
 
 bool HttpRequest::HasParam(const std::string& name) const {
+    if (query_pending_) {
+        const auto& params = GetQueryViews();
+        return std::any_of(params.begin(), params.end(), [&name](const auto& param) { return std::string_view(param.first) == name; });
+    }
     return params_.find(name) != params_.end();
 }
 
+std::string_view HttpRequest::GetCookieView(std::string_view name) const {
+    if (cookies_pending_) {
+        for (const auto& cookie : GetCookieViews()) {
+            if (cookie.first == name) {
+                return cookie.second;
+            }
+        }
+        return {};
+    }
+    for (const auto& cookie : cookies_) {
+        if (cookie.name == name) {
+            return cookie.value;
+        }
+    }
+    return {};
+}
+
+const HttpArenaParams& HttpRequest::GetQueryViews() const {
+    if (!scratch_.params) {
+        scratch_.params.emplace(HttpUtils::ParseQueryString(url_.query, GetArena()));
+    }
+    return *scratch_.params;
+}
+
+const HttpCookieViews& HttpRequest::GetCookieViews() const {
+    if (!scratch_.cookies) {
+        scratch_.cookies.emplace(HttpUtils::ParseCookies(cookie_header_, GetArena()));
+    }
+    return *scratch_.cookies;
+}
+
+void HttpRequest::EnsureParams() const {
+    if (!query_pending_) {
+        return;
+    }
+    query_pending_ = false;
+    for (const auto& param : GetQueryViews()) {
+        params_[std::string(param.first)] = std::string(param.second);
+    }
+    scratch_.params.reset();
+}
+
+void HttpRequest::EnsureCookies() const {
+    if (!cookies_pending_) {
+        return;
+    }
+    cookies_pending_ = false;
+    for (const auto& cookie : GetCookieViews()) {
+        cookies_.emplace_back(std::string(cookie.first), std::string(cookie.second));
+    }
+    scratch_.cookies.reset();
+}
+
+std::string HttpRequest::GetPathParam(const std::string& name) const {
+    auto it = path_params_.find(name);
+    return (it != path_params_.end()) ? it->second : "";
+}
+
 void HttpRequest::RemoveParam(const std::string& name) {
+    EnsureParams();
     params_.erase(name);
 }
 
 void HttpRequest::SetBody(const std::string& body, const std::string& content_type) {
     body_ = body;
+    json_cache_.Reset();
     body_type_ = HttpBodyType::TEXT;
     if (!content_type.empty()) {
         SetContentType(content_type);
@@ -52,6 +248,7 @@ void HttpRequest::SetBody(const std::string& body, const std::string& content_ty
 
 void HttpRequest::SetBody(std::string&& body, const std::string& content_type) {
     body_ = std::move(body);
+    json_cache_.Reset();
     body_type_ = HttpBodyType::TEXT;
     if (!content_type.empty()) {
         SetContentType(content_type);
@@ -60,32 +257,38 @@ void HttpRequest::SetBody(std::string&& body, const std::string& content_type) {
 
 void HttpRequest::SetBody(const std::vector<uint8_t>& body, const std::string& content_type) {
     body_.assign(body.begin(), body.end());
+    json_cache_.Reset();
     body_type_ = HttpBodyType::BINARY;
     SetContentType(content_type);
 }
 
 void HttpRequest::SetJsonBody(const nlohmann::json& json) {
     body_ = json.dump();
+    json_cache_.Reset();
     body_type_ = HttpBodyType::JSON;
     SetContentType("application/json");
 }
 
 void HttpRequest::SetJsonBody(const std::string& json) {
     body_ = json;
+    json_cache_.Reset();
     body_type_ = HttpBodyType::JSON;
     SetContentType("application/json");
 }
 
-nlohmann::json HttpRequest::GetJsonBody() const {
-    try {
-        return nlohmann::json::parse(body_);
-    } catch (const nlohmann::json::exception&) {
-        return nlohmann::json();
-    }
+void HttpRequest::WriteJsonBody(const HttpJsonBuilder& build, size_t reserve) {
+    body_.clear();
+    body_.reserve(reserve);
+    HttpJsonWriter writer(body_);
+    build(writer);
+    json_cache_.Reset();
+    body_type_ = HttpBodyType::JSON;
+    SetContentType("application/json");
 }
 
 void HttpRequest::SetFormData(const HttpParams& form_data) {
     body_ = HttpUtils::BuildQueryString(form_data);
+    json_cache_.Reset();
     body_type_ = HttpBodyType::FORM_DATA;
     SetContentType("application/x-www-form-urlencoded");
 }
@@ -99,16 +302,17 @@ HttpParams HttpRequest::GetFormData() const {
 
 void HttpRequest::SetMultipartForm(const std::vector<HttpFormField>& fields) {
     multipart_fields_ = fields;
-    body_type_ = HttpBodyType::MULTIPART;
-    multipart_boundary_ = HttpUtils::GenerateBoundary();
+    UpdateBodyFromMultipart();
+}
+
+void HttpRequest::AddFormField(const HttpFormField& field) {
+    multipart_fields_.push_back(field);
     UpdateBodyFromMultipart();
 }
 
 void HttpRequest::AddFormField(const std::string& name, const std::string& value) {
     multipart_fields_.emplace_back(name, value);
-    if (body_type_ == HttpBodyType::MULTIPART) {
-        UpdateBodyFromMultipart();
-    }
+    UpdateBodyFromMultipart();
 }
 
 void HttpRequest::AddFileField(const std::string& name, const std::string& filename, 
@@ -119,13 +323,25 @@ void HttpRequest::AddFileField(const std::string& name, const std::string& filen
     field.value = content;
     field.content_type = content_type.empty() ? "application/octet-stream" : content_type;
     
-    multipart_fields_.push_back(field);
-    if (body_type_ == HttpBodyType::MULTIPART) {
-        UpdateBodyFromMultipart();
+    multipart_fields_.push_back(std::move(field));
+    UpdateBodyFromMultipart();
+}
+
+void HttpRequest::SetBodyStream(std::shared_ptr<HttpBodyStream> stream, const std::string& content_type) {
+    body_stream_ = std::move(stream);
+    body_.clear();
+    json_cache_.Reset();
+    body_type_ = HttpBodyType::STREAM;
+    if (!content_type.empty()) {
+        SetContentType(content_type);
     }
 }
 
 size_t HttpRequest::GetContentLength() const {
+    if (body_type_ == HttpBodyType::STREAM && body_stream_) {
+        return static_cast<size_t>(body_stream_->Size().value_or(0));
+    }
+    EnsureMultipartBody();
     return body_.length();
 }
 
@@ -157,7 +373,7 @@ std::string HttpRequest::BuildRequestLine() const {
     if (!url_.query.empty()) {
         target += "?" + url_.query;
     }
-    if (!params_.empty()) {
+    if (!query_pending_ && !params_.empty()) {
         std::string query = HttpUtils::BuildQueryString(params_);
         if (!query.empty()) {
             target += (url_.query.empty() ? "?" : "&") + query;
@@ -172,12 +388,14 @@ std::string HttpRequest::BuildHeadersString() const {
     std::ostringstream oss;
     
     // Add standard headers
-    for (const auto& [name, value] : headers_) {
-        oss << name << ": " << value << "\r\n";
+    for (const auto& field : headers_) {
+        oss << field.name_string() << ": " << field.value() << "\r\n";
     }
     
     // Add cookies
-    if (!cookies_.empty()) {
+    if (cookies_pending_) {
+        oss << "Cookie: " << cookie_header_ << "\r\n";
+    } else if (!cookies_.empty()) {
         oss << "Cookie: " << HttpUtils::BuildCookieHeader(cookies_) << "\r\n";
     }
     
@@ -189,58 +407,94 @@ std::string HttpRequest::ToString() const {
     oss << BuildRequestLine() << "\r\n";
     oss << BuildHeadersString();
     oss << "\r\n";
-    if (!body_.empty()) {
-        oss << body_;
-    }
+    oss << GetBody();
     return oss.str();
 }
 
 HttpRequest HttpRequest::FromBeastRequest(const boost::beast::http::request<boost::beast::http::string_body>& beast_req) {
+    HttpRequest request = FromBeastHeader(beast_req);
+    
+    // Copy body
+    request.body_ = beast_req.body();
+    request.body_type_ = request.body_.empty() ? HttpBodyType::EMPTY : HttpBodyType::TEXT;
+    
+    return request;
+}
+
+HttpRequest HttpRequest::FromBeastRequest(boost::beast::http::request<boost::beast::http::string_body>&& beast_req) {
     HttpRequest request;
     
-    // Convert method
+    // Method, target and version live in the header; read them before the fields are moved out
     request.method_ = HttpUtils::BeastMethodToEnum(beast_req.method());
+    ParseTarget(beast_req.target(), request.url_);
+    request.query_pending_ = !request.url_.query.empty();
+    request.version_ = (beast_req.version() == 10) ? HttpVersion::HTTP_1_0 : HttpVersion::HTTP_1_1;
     
-    // Parse target
-    std::string target = beast_req.target();
-    size_t query_pos = target.find('?');
-    if (query_pos != std::string::npos) {
-        request.url_.path = target.substr(0, query_pos);
-        request.url_.query = target.substr(query_pos + 1);
-        request.params_ = HttpUtils::ParseQueryString(request.url_.query);
-    } else {
-        request.url_.path = target;
+    // Move headers
+    request.headers_ = std::move(static_cast<HttpFields&>(beast_req));
+    auto cookie = request.headers_.find(boost::beast::http::field::cookie);
+    if (cookie != request.headers_.end()) {
+        request.cookie_header_ = std::string(cookie->value());
+        request.cookies_pending_ = true;
+        request.headers_.erase(boost::beast::http::field::cookie);
     }
     
+    // Move body
+    request.body_ = std::move(beast_req.body());
+    request.body_type_ = request.body_.empty() ? HttpBodyType::EMPTY : HttpBodyType::TEXT;
+    
+    return request;
+}
+
+HttpRequest HttpRequest::FromBeastHeader(const boost::beast::http::request_header<>& header) {
+    HttpRequest request;
+    
+    // Convert method
+    request.method_ = HttpUtils::BeastMethodToEnum(header.method());
+    
+    // Parse target
+    ParseTarget(header.target(), request.url_);
+    request.query_pending_ = !request.url_.query.empty();
+    
     // Convert version
-    request.version_ = (beast_req.version() == 10) ? HttpVersion::HTTP_1_0 : HttpVersion::HTTP_1_1;
+    request.version_ = (header.version() == 10) ? HttpVersion::HTTP_1_0 : HttpVersion::HTTP_1_1;
     
-    // Convert headers
-    for (const auto& field : beast_req) {
-        std::string name(field.name_string());
-        std::string value(field.value());
-        
-        if (name == "Cookie") {
-            request.cookies_ = HttpUtils::ParseCookies(value);
-        } else {
-            request.headers_[name] = value;
-        }
+    // Copy headers
+    request.headers_ = static_cast<const HttpFields&>(header);
+    auto cookie = request.headers_.find(boost::beast::http::field::cookie);
+    if (cookie != request.headers_.end()) {
+        request.cookie_header_ = std::string(cookie->value());
+        request.cookies_pending_ = true;
+        request.headers_.erase(boost::beast::http::field::cookie);
     }
     
-    // Copy body
-    request.body_ = beast_req.body();
-    request.body_type_ = request.body_.empty() ? HttpBodyType::EMPTY : HttpBodyType::TEXT;
-    
     return request;
 }
 
+// The body is rendered on first use, so adding N fields costs O(N) instead of O(N^2)
 void HttpRequest::UpdateBodyFromMultipart() {
-    if (multipart_boundary_.empty()) {
+    // The boundary is kept once generated so the Content-Type header always matches the body
+    const bool new_boundary = multipart_boundary_.empty();
+    if (new_boundary) {
         multipart_boundary_ = HttpUtils::GenerateBoundary();
     }
     
-    body_ = GenerateMultipartBody();
-    SetContentType("multipart/form-data; boundary=" + multipart_boundary_);
+    if (new_boundary || body_type_ != HttpBodyType::MULTIPART) {
+        body_type_ = HttpBodyType::MULTIPART;
+        SetContentType("multipart/form-data; boundary=" + multipart_boundary_);
+    }
+    multipart_pending_ = true;
+    json_cache_.Reset();
+}
+
+void HttpRequest::EnsureMultipartBody() const {
+    if (!multipart_pending_) {
+        return;
+    }
+    multipart_pending_ = false;
+    if (body_type_ == HttpBodyType::MULTIPART) {
+        body_ = GenerateMultipartBody();
+    }
 }
 
 void HttpRequest::UpdateBodyFromFormData() {
@@ -249,38 +503,53 @@ void HttpRequest::UpdateBodyFromFormData() {
         form_params[field.name] = field.value;
     }
     body_ = HttpUtils::BuildQueryString(form_params);
+    json_cache_.Reset();
     SetContentType("application/x-www-form-urlencoded");
 }
 
 std::string HttpRequest::GenerateMultipartBody() const {
-    std::ostringstream oss;
-    
-    for (const auto& field : multipart_fields_) {
-        oss << "--" << multipart_boundary_ << "\r\n";
-        oss << "Content-Disposition: form-data; name=\"" << field.name << "\"";
+    auto append_head = [this](std::string& out, const HttpFormField& field) {
+        out.append("--").append(multipart_boundary_).append("\r\n");
+        out.append("Content-Disposition: form-data; name=\"").append(field.name).append("\"");
         
         if (!field.filename.empty()) {
-            oss << "; filename=\"" << field.filename << "\"";
+            out.append("; filename=\"").append(field.filename).append("\"");
         }
         
-        oss << "\r\n";
+        out.append("\r\n");
         
         if (!field.content_type.empty()) {
-            oss << "Content-Type: " << field.content_type << "\r\n";
+            out.append("Content-Type: ").append(field.content_type).append("\r\n");
         }
         
         // Add custom headers
         for (const auto& [name, value] : field.headers) {
-            oss << name << ": " << value << "\r\n";
+            out.append(name).append(": ").append(value).append("\r\n");
         }
         
-        oss << "\r\n";
-        oss << field.value << "\r\n";
+        out.append("\r\n");
+    };
+    
+    // Size the buffer once so large file fields are copied a single time
+    size_t size = multipart_boundary_.size() + 6;
+    for (const auto& field : multipart_fields_) {
+        size += multipart_boundary_.size() + field.name.size() + field.filename.size() +
+                field.content_type.size() + field.value.size() + 96;
+        for (const auto& [name, value] : field.headers) {
+            size += name.size() + value.size() + 4;
+        }
+    }
+    
+    std::string body;
+    body.reserve(size);
+    for (const auto& field : multipart_fields_) {
+        append_head(body, field);
+        body.append(field.value).append("\r\n");
     }
     
-    oss << "--" << multipart_boundary_ << "--\r\n";
+    body.append("--").append(multipart_boundary_).append("--\r\n");
     
-    return oss.str();
+    return body;
 }
 
 // HttpResponse Implementation
@@ -288,9 +557,19 @@ HttpResponse::HttpResponse(HttpStatusCode status_code)
     : status_code_(status_code), reason_phrase_(HttpUtils::StatusCodeToString(status_code)) {
 }
 
+void HttpResponse::SetHeaders(const HttpHeaders& headers) {
+    headers_.clear();
+    for (const auto& [name, value] : headers) {
+        headers_.set(name, value);
+    }
+}
+
 std::string HttpResponse::GetHeader(const std::string& name) const {
-    auto it = headers_.find(name);
-    return (it != headers_.end()) ? it->second : "";
+    return std::string(FieldView(headers_, name));
+}
+
+std::string_view HttpResponse::GetHeaderView(std::string_view name) const {
+    return FieldView(headers_, name);
 }
 
 bool HttpResponse::HasHeader(const std::string& name) const {
@@ -313,49 +592,65 @@ void HttpResponse::SetCookie(const std::string& name, const std::string& value,
 }
 
 void HttpResponse::SetBody(const std::string& body, const std::string& content_type) {
+    file_range_.reset();
     body_ = body;
+    json_cache_.Reset();
     SetContentType(content_type);
 }
 
 void HttpResponse::SetBody(std::string&& body, const std::string& content_type) {
+    file_range_.reset();
     body_ = std::move(body);
+    json_cache_.Reset();
     SetContentType(content_type);
 }
 
 void HttpResponse::SetBody(const std::vector<uint8_t>& body, const std::string& content_type) {
+    file_range_.reset();
     body_.assign(body.begin(), body.end());
+    json_cache_.Reset();
     SetContentType(content_type);
 }
 
 void HttpResponse::SetJsonBody(const nlohmann::json& json) {
+    file_range_.reset();
     body_ = json.dump();
+    json_cache_.Reset();
     SetContentType("application/json");
 }
 
 void HttpResponse::SetJsonBody(const std::string& json) {
+    file_range_.reset();
     body_ = json;
+    json_cache_.Reset();
     SetContentType("application/json");
 }
 
-nlohmann::json HttpResponse::GetJsonBody() const {
-    try {
-        return nlohmann::json::parse(body_);
-    } catch (const nlohmann::json::exception&) {
-        return nlohmann::json();
-    }
+void HttpResponse::WriteJsonBody(const HttpJsonBuilder& build, size_t reserve) {
+    file_range_.reset();
+    body_.clear();
+    body_.reserve(reserve);
+    HttpJsonWriter writer(body_);
+    build(writer);
+    json_cache_.Reset();
+    SetContentType("application/json");
 }
 
 void HttpResponse::SetHtmlBody(const std::string& html) {
+    file_range_.reset();
     body_ = html;
+    json_cache_.Reset();
     SetContentType("text/html");
 }
 
 void HttpResponse::SetFileBody(const std::string& file_path) {
     std::ifstream file(file_path, std::ios::binary);
     if (file.is_open()) {
+        file_range_.reset();
         std::ostringstream oss;
         oss << file.rdbuf();
         body_ = oss.str();
+        json_cache_.Reset();
         
         // Determine content type from file extension
         size_t dot_pos = file_path.find_last_of('.');
@@ -368,7 +663,16 @@ void HttpResponse::SetFileBody(const std::string& file_path) {
     }
 }
 
+void HttpResponse::SetFileRange(const std::string& file_path, uint64_t offset, uint64_t length) {
+    body_.clear();
+    json_cache_.Reset();
+    file_range_ = HttpFileRange{file_path, offset, length};
+}
+
 size_t HttpResponse::GetContentLength() const {
+    if (file_range_) {
+        return static_cast<size_t>(file_range_->length);
+    }
     return body_.length();
 }
 
@@ -390,8 +694,8 @@ std::string HttpResponse::BuildHeadersString() const {
     std::ostringstream oss;
     
     // Add standard headers
-    for (const auto& [name, value] : headers_) {
-        oss << name << ": " << value << "\r\n";
+    for (const auto& field : headers_) {
+        oss << field.name_string() << ": " << field.value() << "\r\n";
     }
     
     // Add cookies
@@ -434,23 +738,15 @@ HttpResponse HttpResponse::FromBeastResponse(const boost::beast::http::response<
     
     // Convert status
     response.status_code_ = HttpUtils::BeastStatusToEnum(beast_resp.result());
-    response.reason_phrase_ = beast_resp.reason();
+    response.reason_phrase_ = std::string(beast_resp.reason());
     
     // Convert version
     response.version_ = (beast_resp.version() == 10) ? HttpVersion::HTTP_1_0 : HttpVersion::HTTP_1_1;
     
-    // Convert headers
-    for (const auto& field : beast_resp) {
-        std::string name(field.name_string());
-        std::string value(field.value());
-        
-        if (name == "Set-Cookie") {
-            auto cookies = HttpUtils::ParseCookies(value);
-            response.cookies_.insert(response.cookies_.end(), cookies.begin(), cookies.end());
-        } else {
-            response.headers_[name] = value;
-        }
-    }
+    // Copy headers
+    response.headers_ = static_cast<const HttpFields&>(beast_resp);
+    AppendSetCookies(response.headers_, response.cookies_);
+    response.headers_.erase(boost::beast::http::field::set_cookie);
     
     // Copy body
     response.body_ = beast_resp.body();
@@ -458,6 +754,72 @@ HttpResponse HttpResponse::FromBeastResponse(const boost::beast::http::response<
     return response;
 }
 
+HttpResponse HttpResponse::FromBeastResponse(boost::beast::http::response<boost::beast::http::string_body>&& beast_resp) {
+    HttpResponse response;
+    
+    // Status and version live in the header; read them before the fields are moved out
+    response.status_code_ = HttpUtils::BeastStatusToEnum(beast_resp.result());
+    response.reason_phrase_ = std::string(beast_resp.reason());
+    response.version_ = (beast_resp.version() == 10) ? HttpVersion::HTTP_1_0 : HttpVersion::HTTP_1_1;
+    
+    // Move headers
+    response.headers_ = std::move(static_cast<HttpFields&>(beast_resp));
+    AppendSetCookies(response.headers_, response.cookies_);
+    response.headers_.erase(boost::beast::http::field::set_cookie);
+    
+    // Move body
+    response.body_ = std::move(beast_resp.body());
+    
+    return response;
+}
+
+HttpResponse HttpResponse::FromBeastHeader(const boost::beast::http::response_header<>& header) {
+    HttpResponse response;
+    
+    response.status_code_ = HttpUtils::BeastStatusToEnum(header.result());
+    response.reason_phrase_ = std::string(header.reason());
+    response.version_ = (header.version() == 10) ? HttpVersion::HTTP_1_0 : HttpVersion::HTTP_1_1;
+    
+    response.headers_ = static_cast<const HttpFields&>(header);
+    AppendSetCookies(response.headers_, response.cookies_);
+    response.headers_.erase(boost::beast::http::field::set_cookie);
+    
+    return response;
+}
+
+void HttpResponse::MoveHeadersTo(HttpFields& fields) {
+    fields = std::move(headers_);
+    headers_.clear();
+    
+    for (const auto& cookie : cookies_) {
+        std::string cookie_header = cookie.name + "=" + cookie.value;
+        if (!cookie.path.empty()) {
+            cookie_header += "; Path=" + cookie.path;
+        }
+        if (!cookie.domain.empty()) {
+            cookie_header += "; Domain=" + cookie.domain;
+        }
+        if (cookie.secure) {
+            cookie_header += "; Secure";
+        }
+        if (cookie.http_only) {
+            cookie_header += "; HttpOnly";
+        }
+        if (!cookie.same_site.empty()) {
+            cookie_header += "; SameSite=" + cookie.same_site;
+        }
+        fields.insert(boost::beast::http::field::set_cookie, cookie_header);
+    }
+}
+
+void HttpResponse::MoveToBeastResponse(boost::beast::http::response<boost::beast::http::string_body>& beast_resp) {
+    beast_resp.result(static_cast<unsigned>(status_code_));
+    MoveHeadersTo(beast_resp);
+    beast_resp.body() = std::move(body_);
+    body_.clear();
+    json_cache_.Reset();
+}
+
 // Static factory methods
 HttpResponse HttpResponse::Ok(const std::string& body, const std::string& content_type) {
     HttpResponse response(HttpStatusCode::OK);
@@ -528,6 +890,12 @@ HttpResponse HttpResponse::Json(const nlohmann::json& json, HttpStatusCode statu
     return response;
 }
 
+HttpResponse HttpResponse::Json(const HttpJsonBuilder& build, HttpStatusCode status) {
+    HttpResponse response(status);
+    response.WriteJsonBody(build);
+    return response;
+}
+
 HttpResponse HttpResponse::Html(const std::string& html, HttpStatusCode status) {
     HttpResponse response(status);
     response.SetHtmlBody(html);
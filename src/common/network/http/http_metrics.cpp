@@ -0,0 +1,434 @@
+#include "common/network/http/http_metrics.h"
+#include <algorithm>
+#include <charconv>
+#include <thread>
+
+namespace common {
+namespace network {
+namespace http {
+
+namespace {
+
+// 线程首次记录时获得的序号，按分片数取模选择分片
+std::atomic<size_t> g_thread_counter{0};
+
+size_t GetThreadIndex() {
+    thread_local const size_t index = g_thread_counter.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+size_t GetStatusClass(HttpStatusCode status) {
+    const int code = static_cast<int>(status);
+    return static_cast<size_t>(std::clamp(code / 100, 1, 5) - 1);
+}
+
+// Prometheus的le边界：耗时以微秒比较、以秒输出，大小以字节输出
+struct Boundary {
+    uint64_t value;
+    const char* label;
+};
+
+constexpr Boundary kLatencyBoundaries[] = {
+    {500, "0.0005"}, {1000, "0.001"}, {2500, "0.0025"}, {5000, "0.005"}, {10000, "0.01"},
+    {25000, "0.025"}, {50000, "0.05"}, {100000, "0.1"}, {250000, "0.25"}, {500000, "0.5"},
+    {1000000, "1"}, {2500000, "2.5"}, {5000000, "5"}, {10000000, "10"}
+};
+
+constexpr Boundary kSizeBoundaries[] = {
+    {64, "64"}, {256, "256"}, {1024, "1024"}, {4096, "4096"}, {16384, "16384"}, {65536, "65536"},
+    {262144, "262144"}, {1048576, "1048576"}, {4194304, "4194304"}, {16777216, "16777216"}
+};
+
+const char* const kStatusClasses[] = {"1xx", "2xx", "3xx", "4xx", "5xx"};
+
+void AppendEscapedLabel(std::string& out, const std::string& value) {
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"': out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default: out += c; break;
+        }
+    }
+}
+
+void AppendNumber(std::string& out, uint64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+// 微秒以秒输出，按十进制精确转换，避免浮点除法产生0.020125999999999998这样的尾数
+void AppendSeconds(std::string& out, uint64_t microseconds) {
+    AppendNumber(out, microseconds / 1000000);
+    uint64_t fraction = microseconds % 1000000;
+    if (fraction == 0) {
+        return;
+    }
+    char digits[7] = {'.'};
+    int length = 6;
+    while (fraction % 10 == 0) {
+        fraction /= 10;
+        --length;
+    }
+    for (int i = length; i > 0; --i) {
+        digits[i] = static_cast<char>('0' + fraction % 10);
+        fraction /= 10;
+    }
+    out.append(digits, static_cast<size_t>(length + 1));
+}
+
+// labels不含花括号，如 method="GET",route="/items"
+// 只累加上界不超过le的桶，跨越边界的桶留给下一个边界，le计数不会多计
+template <size_t N>
+void AppendHistogram(std::string& out, const std::string& name, const std::string& labels,
+                     const HttpHistogramSnapshot& histogram, const Boundary (&boundaries)[N], bool seconds) {
+    size_t bucket = 0;
+    uint64_t cumulative = 0;
+    for (const auto& boundary : boundaries) {
+        while (bucket < histogram.buckets.size() && HttpHistogramLayout::GetUpperBound(bucket) <= boundary.value) {
+            cumulative += histogram.buckets[bucket++];
+        }
+        out += name;
+        out += "_bucket{";
+        out += labels;
+        out += ",le=\"";
+        out += boundary.label;
+        out += "\"} ";
+        AppendNumber(out, cumulative);
+        out += '\n';
+    }
+
+    out += name;
+    out += "_bucket{";
+    out += labels;
+    out += ",le=\"+Inf\"} ";
+    AppendNumber(out, histogram.count);
+    out += '\n';
+
+    out += name;
+    out += "_sum{";
+    out += labels;
+    out += "} ";
+    if (seconds) {
+        AppendSeconds(out, histogram.sum);
+    } else {
+        AppendNumber(out, histogram.sum);
+    }
+    out += '\n';
+
+    out += name;
+    out += "_count{";
+    out += labels;
+    out += "} ";
+    AppendNumber(out, histogram.count);
+    out += '\n';
+}
+
+void AppendHeader(std::string& out, const std::string& name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+} // namespace
+
+// ===== HttpHistogramLayout / HttpHistogramSnapshot Implementation =====
+
+void HttpHistogramSnapshot::Merge(const HttpHistogramSnapshot& other) {
+    if (other.count == 0) {
+        return;
+    }
+    if (buckets.empty()) {
+        buckets.assign(HttpHistogramLayout::kBucketCount, 0);
+    }
+    for (size_t i = 0; i < other.buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sum += other.sum;
+    max = std::max(max, other.max);
+}
+
+uint64_t HttpHistogramSnapshot::GetPercentile(double percentile) const {
+    return HttpHistogramLayout::GetPercentile(buckets, count, max, percentile);
+}
+
+uint64_t HttpRouteMetrics::GetRequestCount() const {
+    uint64_t count = 0;
+    for (const auto& histogram : latency_us) {
+        count += histogram.count;
+    }
+    return count;
+}
+
+HttpHistogramSnapshot HttpRouteMetrics::GetLatency() const {
+    HttpHistogramSnapshot merged;
+    for (const auto& histogram : latency_us) {
+        merged.Merge(histogram);
+    }
+    return merged;
+}
+
+// ===== HttpServerMetrics Implementation =====
+
+class HttpServerMetrics::Histogram {
+public:
+    void Record(uint64_t value) {
+        buckets_[HttpHistogramLayout::GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t current = max_.load(std::memory_order_relaxed);
+        while (value > current && !max_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    void AddTo(HttpHistogramSnapshot& snapshot) const {
+        const uint64_t count = count_.load(std::memory_order_relaxed);
+        if (count == 0) {
+            return;
+        }
+        if (snapshot.buckets.empty()) {
+            snapshot.buckets.assign(HttpHistogramLayout::kBucketCount, 0);
+        }
+        for (size_t i = 0; i < buckets_.size(); ++i) {
+            snapshot.buckets[i] += buckets_[i].load(std::memory_order_relaxed);
+        }
+        snapshot.count += count;
+        snapshot.sum += sum_.load(std::memory_order_relaxed);
+        snapshot.max = std::max(snapshot.max, max_.load(std::memory_order_relaxed));
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, HttpHistogramLayout::kBucketCount> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+struct HttpServerMetrics::RouteShard {
+    std::atomic<int64_t> in_flight{0};
+    std::array<std::atomic<Histogram*>, 5> latency{};
+    std::atomic<Histogram*> request_bytes{nullptr};
+    std::atomic<Histogram*> response_bytes{nullptr};
+
+    ~RouteShard() {
+        for (auto& histogram : latency) {
+            delete histogram.load();
+        }
+        delete request_bytes.load();
+        delete response_bytes.load();
+    }
+};
+
+struct HttpServerMetrics::Shard {
+    explicit Shard(size_t route_count)
+        : routes(new std::atomic<RouteShard*>[route_count]()), size(route_count) {}
+
+    ~Shard() {
+        for (size_t i = 0; i < size; ++i) {
+            delete routes[i].load();
+        }
+    }
+
+    std::unique_ptr<std::atomic<RouteShard*>[]> routes;
+    size_t size;
+};
+
+HttpServerMetrics::HttpServerMetrics(size_t max_routes, size_t shard_count)
+    : max_routes_(std::max<size_t>(max_routes, kOverflowRoute + 1)) {
+    if (shard_count == 0) {
+        shard_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<Shard>(max_routes_));
+    }
+
+    labels_.push_back({"", "<unmatched>"});
+    labels_.push_back({"", "<static>"});
+    labels_.push_back({"", "<other>"});
+}
+
+HttpServerMetrics::~HttpServerMetrics() = default;
+
+size_t HttpServerMetrics::RegisterRoute(const std::string& method, const std::string& pattern) {
+    std::lock_guard<std::mutex> lock(labels_mutex_);
+    if (labels_.size() >= max_routes_) {
+        return kOverflowRoute;
+    }
+    labels_.push_back({method, pattern});
+    return labels_.size() - 1;
+}
+
+HttpServerMetrics::Shard& HttpServerMetrics::GetShard() {
+    return *shards_[GetThreadIndex() % shards_.size()];
+}
+
+HttpServerMetrics::RouteShard& HttpServerMetrics::GetRouteShard(size_t route) {
+    if (route >= max_routes_) {
+        route = kOverflowRoute;
+    }
+
+    std::atomic<RouteShard*>& slot = GetShard().routes[route];
+    RouteShard* route_shard = slot.load(std::memory_order_acquire);
+    if (route_shard) {
+        return *route_shard;
+    }
+
+    // 首次使用时分配，与其他线程竞争失败则使用对方分配的
+    auto created = std::make_unique<RouteShard>();
+    if (slot.compare_exchange_strong(route_shard, created.get(), std::memory_order_acq_rel)) {
+        return *created.release();
+    }
+    return *route_shard;
+}
+
+HttpServerMetrics::Histogram& HttpServerMetrics::GetHistogram(std::atomic<Histogram*>& slot) {
+    Histogram* histogram = slot.load(std::memory_order_acquire);
+    if (histogram) {
+        return *histogram;
+    }
+
+    auto created = std::make_unique<Histogram>();
+    if (slot.compare_exchange_strong(histogram, created.get(), std::memory_order_acq_rel)) {
+        return *created.release();
+    }
+    return *histogram;
+}
+
+void HttpServerMetrics::BeginRequest(size_t route) {
+    GetRouteShard(route).in_flight.fetch_add(1, std::memory_order_relaxed);
+}
+
+void HttpServerMetrics::EndRequest(size_t route, HttpStatusCode status, std::chrono::microseconds latency,
+                                   uint64_t request_bytes, uint64_t response_bytes) {
+    // 请求可能在其他线程开始，分片之间的差值在合并时抵消
+    RouteShard& route_shard = GetRouteShard(route);
+    route_shard.in_flight.fetch_sub(1, std::memory_order_relaxed);
+    GetHistogram(route_shard.latency[GetStatusClass(status)]).Record(static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0)));
+    GetHistogram(route_shard.request_bytes).Record(request_bytes);
+    GetHistogram(route_shard.response_bytes).Record(response_bytes);
+}
+
+std::vector<HttpRouteMetrics> HttpServerMetrics::GetSnapshot() const {
+    std::vector<RouteLabel> labels;
+    {
+        std::lock_guard<std::mutex> lock(labels_mutex_);
+        labels.assign(labels_.begin(), labels_.end());
+    }
+
+    std::vector<HttpRouteMetrics> routes;
+    for (size_t route = 0; route < labels.size(); ++route) {
+        HttpRouteMetrics metrics;
+        for (const auto& shard : shards_) {
+            const RouteShard* route_shard = shard->routes[route].load(std::memory_order_acquire);
+            if (!route_shard) {
+                continue;
+            }
+            metrics.in_flight += route_shard->in_flight.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < metrics.latency_us.size(); ++i) {
+                if (const Histogram* histogram = route_shard->latency[i].load(std::memory_order_acquire)) {
+                    histogram->AddTo(metrics.latency_us[i]);
+                }
+            }
+            if (const Histogram* histogram = route_shard->request_bytes.load(std::memory_order_acquire)) {
+                histogram->AddTo(metrics.request_bytes);
+            }
+            if (const Histogram* histogram = route_shard->response_bytes.load(std::memory_order_acquire)) {
+                histogram->AddTo(metrics.response_bytes);
+            }
+        }
+
+        if (metrics.in_flight != 0 || metrics.GetRequestCount() > 0) {
+            metrics.method = std::move(labels[route].method);
+            metrics.pattern = std::move(labels[route].pattern);
+            routes.push_back(std::move(metrics));
+        }
+    }
+    return routes;
+}
+
+HttpRouteMetrics HttpServerMetrics::GetTotal() const {
+    HttpRouteMetrics total;
+    total.pattern = "<all>";
+    for (const auto& route : GetSnapshot()) {
+        total.in_flight += route.in_flight;
+        for (size_t i = 0; i < total.latency_us.size(); ++i) {
+            total.latency_us[i].Merge(route.latency_us[i]);
+        }
+        total.request_bytes.Merge(route.request_bytes);
+        total.response_bytes.Merge(route.response_bytes);
+    }
+    return total;
+}
+
+std::string HttpServerMetrics::RenderPrometheus(const std::string& prefix) const {
+    const auto routes = GetSnapshot();
+    const std::string duration_name = prefix + "_request_duration_seconds";
+    const std::string in_flight_name = prefix + "_requests_in_flight";
+    const std::string request_size_name = prefix + "_request_size_bytes";
+    const std::string response_size_name = prefix + "_response_size_bytes";
+
+    std::vector<std::string> route_labels;
+    route_labels.reserve(routes.size());
+    for (const auto& route : routes) {
+        std::string labels = "method=\"";
+        AppendEscapedLabel(labels, route.method);
+        labels += "\",route=\"";
+        AppendEscapedLabel(labels, route.pattern);
+        labels += '"';
+        route_labels.push_back(std::move(labels));
+    }
+
+    std::string out;
+    out.reserve(routes.size() * 4096 + 512);
+
+    AppendHeader(out, duration_name, "histogram", "Time spent handling HTTP requests by route and status class.");
+    for (size_t i = 0; i < routes.size(); ++i) {
+        for (size_t status = 0; status < routes[i].latency_us.size(); ++status) {
+            if (routes[i].latency_us[status].count == 0) {
+                continue;
+            }
+            AppendHistogram(out, duration_name, route_labels[i] + ",status=\"" + kStatusClasses[status] + "\"",
+                            routes[i].latency_us[status], kLatencyBoundaries, true);
+        }
+    }
+
+    AppendHeader(out, in_flight_name, "gauge", "HTTP requests currently being handled.");
+    for (size_t i = 0; i < routes.size(); ++i) {
+        out += in_flight_name;
+        out += '{';
+        out += route_labels[i];
+        out += "} ";
+        out += std::to_string(routes[i].in_flight);
+        out += '\n';
+    }
+
+    AppendHeader(out, request_size_name, "histogram", "HTTP request body sizes by route.");
+    for (size_t i = 0; i < routes.size(); ++i) {
+        if (routes[i].request_bytes.count > 0) {
+            AppendHistogram(out, request_size_name, route_labels[i], routes[i].request_bytes, kSizeBoundaries, false);
+        }
+    }
+
+    AppendHeader(out, response_size_name, "histogram", "HTTP response body sizes by route.");
+    for (size_t i = 0; i < routes.size(); ++i) {
+        if (routes[i].response_bytes.count > 0) {
+            AppendHistogram(out, response_size_name, route_labels[i], routes[i].response_bytes, kSizeBoundaries, false);
+        }
+    }
+
+    return out;
+}
+
+} // namespace http
+} // namespace network
+} // namespace common
@@ -1,12 +1,13 @@
 #include "common/network/http/http_middleware.h"
 #include "common/network/network_logger.h"
 // #include <base64.h> // Temporarily disabled - not a standard library
-// #include <zlib.h> // Temporarily disabled - external dependency
 #include <chrono>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
 #include <cctype>
+#include <cstdio>
+#include <cstdlib>
 
 namespace common {
 namespace network {
@@ -56,7 +57,7 @@ void LoggingMiddleware::Handle(const HttpRequest& request, HttpResponse& respons
         if (config_.log_request_headers) {
             log_stream << "\nHeaders:";
             for (const auto& header : request.GetHeaders()) {
-                log_stream << "\n  " << header.first << ": " << header.second;
+                log_stream << "\n  " << header.name_string() << ": " << header.value();
             }
         }
         
@@ -290,16 +291,45 @@ bool ApiKeyAuthMiddleware::Authenticate(const HttpRequest& request) {
 
 // ===== RateLimitMiddleware Implementation =====
 
-RateLimitMiddleware::RateLimitMiddleware(const RateLimitConfig& config) : config_(config) {}
+RateLimitMiddleware::RateLimitMiddleware(const RateLimitConfig& config) : config_(config) {
+    window_ms_ = std::max<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(config_.window).count(), 1);
+    
+    const size_t shard_count = std::max<size_t>(config_.shard_count, 1);
+    const size_t slots_per_shard = std::max<size_t>(config_.max_keys / shard_count, kSlotsPerSet);
+    sets_per_shard_ = (slots_per_shard + kSlotsPerSet - 1) / kSlotsPerSet;
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->slots.resize(sets_per_shard_ * kSlotsPerSet);
+        shards_.push_back(std::move(shard));
+    }
+}
 
 void RateLimitMiddleware::Handle(const HttpRequest& request, HttpResponse& response, std::function<void()> next) {
+    std::string route;
+    const size_t limit = GetLimit(request.GetUrl().path, &route);
+    if (limit == 0) {
+        next();
+        return;
+    }
+    
+    // 路由单独限流时计数键带上路由前缀
     std::string key = GenerateKey(request);
+    if (!route.empty()) {
+        key.insert(0, route + '\n');
+    }
+    uint64_t hash = std::hash<std::string>{}(key);
+    if (hash == 0) {
+        hash = 1;
+    }
     
-    if (IsRateLimited(key)) {
+    int64_t retry_after_ms = 0;
+    uint64_t charged_window = 0;
+    if (IsRateLimited(hash, limit, &retry_after_ms, &charged_window)) {
         response.SetStatusCode(HttpStatusCode::TOO_MANY_REQUESTS);
         response.SetHeader("Content-Type", "text/plain");
         response.SetBody(config_.message);
-        response.SetHeader("Retry-After", std::to_string(config_.window.count()));
+        response.SetHeader("Retry-After", std::to_string(std::max<int64_t>((retry_after_ms + 999) / 1000, 1)));
         return;
     }
     
@@ -309,14 +339,52 @@ void RateLimitMiddleware::Handle(const HttpRequest& request, HttpResponse& respo
     if (config_.skip_successful_requests && 
         static_cast<int>(response.GetStatusCode()) >= 200 && 
         static_cast<int>(response.GetStatusCode()) < 300) {
-        return;
+        Refund(hash, charged_window);
+    }
+}
+
+RateLimitMiddleware::RateLimitStats RateLimitMiddleware::GetStats() const {
+    RateLimitStats stats;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.allowed += shard->allowed;
+        stats.limited += shard->limited;
+        stats.evictions += shard->evictions;
+        stats.tracked_keys += shard->used;
+        stats.capacity += shard->slots.size();
     }
+    return stats;
 }
 
 std::string RateLimitMiddleware::GenerateKey(const HttpRequest& request) const {
     if (config_.key_generator == "ip") {
-        // 这里需要从请求中获取IP地址，暂时使用简化版本
-        return "127.0.0.1"; // 实际需要从请求中提取IP
+        if (config_.trust_forwarded_for) {
+            // 每层代理把对端地址追加到末尾，右起第trusted_proxy_hops个地址由最外层可信代理写入，
+            // 其左侧的条目可由客户端任意伪造；条目不足时说明请求未经过全部代理，回退到连接地址
+            std::string_view forwarded = request.GetHeaderView("X-Forwarded-For");
+            std::string_view entry;
+            const size_t hops = std::max<size_t>(config_.trusted_proxy_hops, 1);
+            for (size_t i = 0; i < hops && !forwarded.empty(); ++i) {
+                const size_t comma = forwarded.rfind(',');
+                if (comma == std::string_view::npos) {
+                    entry = i + 1 == hops ? forwarded : std::string_view();
+                    break;
+                }
+                entry = forwarded.substr(comma + 1);
+                forwarded = forwarded.substr(0, comma);
+            }
+            forwarded = entry;
+            while (!forwarded.empty() && std::isspace(static_cast<unsigned char>(forwarded.front()))) {
+                forwarded.remove_prefix(1);
+            }
+            while (!forwarded.empty() && std::isspace(static_cast<unsigned char>(forwarded.back()))) {
+                forwarded.remove_suffix(1);
+            }
+            if (!forwarded.empty()) {
+                return std::string(forwarded);
+            }
+        }
+        return request.GetRemoteAddress();
     } else if (config_.key_generator == "user") {
         // 从认证信息中获取用户ID
         return request.GetHeader("X-User-ID");
@@ -327,45 +395,121 @@ std::string RateLimitMiddleware::GenerateKey(const HttpRequest& request) const {
     return "default";
 }
 
-bool RateLimitMiddleware::IsRateLimited(const std::string& key) {
-    std::lock_guard<std::mutex> lock(records_mutex_);
+size_t RateLimitMiddleware::GetLimit(const std::string& path, std::string* route) const {
+    size_t limit = config_.max_requests;
+    size_t best_length = 0;
+    for (const auto& entry : config_.route_limits) {
+        if (entry.first.size() >= best_length && path.compare(0, entry.first.size(), entry.first) == 0) {
+            best_length = entry.first.size();
+            limit = entry.second;
+            *route = entry.first;
+        }
+    }
+    return limit;
+}
+
+RateLimitMiddleware::Shard& RateLimitMiddleware::GetShard(uint64_t hash) {
+    return *shards_[hash % shards_.size()];
+}
+
+RateLimitMiddleware::Slot& RateLimitMiddleware::FindSlotLocked(Shard& shard, uint64_t hash, uint64_t window) {
+    const size_t set = (hash / shards_.size()) % sets_per_shard_;
+    Slot* begin = shard.slots.data() + set * kSlotsPerSet;
+    
+    Slot* free_slot = nullptr;
+    for (size_t i = 0; i < kSlotsPerSet; ++i) {
+        Slot& slot = begin[i];
+        if (slot.hash == hash) {
+            return slot;
+        }
+        // 空槽位或两个窗口内无请求的槽位可直接复用
+        if (!free_slot && (slot.hash == 0 || slot.window + 1 < window)) {
+            free_slot = &slot;
+        }
+    }
+    
+    if (!free_slot) {
+        // CLOCK：跳过并清除最近访问过的槽位，最多扫描两轮
+        for (size_t i = 0; i < 2 * kSlotsPerSet; ++i) {
+            Slot& slot = begin[shard.hand++ % kSlotsPerSet];
+            if (!slot.referenced) {
+                free_slot = &slot;
+                break;
+            }
+            slot.referenced = false;
+        }
+        ++shard.evictions;
+    } else if (free_slot->hash == 0) {
+        ++shard.used;
+    }
+    
+    *free_slot = Slot{};
+    free_slot->hash = hash;
+    free_slot->window = window;
+    return *free_slot;
+}
+
+bool RateLimitMiddleware::IsRateLimited(uint64_t hash, size_t limit, int64_t* retry_after_ms,
+                                        uint64_t* charged_window) {
+    const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    const uint64_t window = static_cast<uint64_t>(now_ms / window_ms_);
+    const int64_t elapsed_ms = now_ms % window_ms_;
     
-    auto now = std::chrono::steady_clock::now();
-    auto& record = request_records_[key];
+    Shard& shard = GetShard(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
     
-    // 检查是否在时间窗口内
-    if (now - record.timestamp > config_.window) {
-        // 重置计数
-        record.timestamp = now;
-        record.count = 1;
-        return false;
+    Slot& slot = FindSlotLocked(shard, hash, window);
+    slot.referenced = true;
+    if (slot.window != window) {
+        slot.previous = slot.window + 1 == window ? slot.current : 0;
+        slot.current = 0;
+        slot.window = window;
     }
     
-    // 检查是否超过限制
-    if (record.count >= config_.max_requests) {
+    // 上一窗口的计数按剩余比例计入
+    const double estimate = static_cast<double>(slot.previous) * static_cast<double>(window_ms_ - elapsed_ms) /
+                            static_cast<double>(window_ms_) + slot.current;
+    if (estimate + 1 > static_cast<double>(limit)) {
+        ++shard.limited;
+        *retry_after_ms = window_ms_ - elapsed_ms;
         return true;
     }
     
-    record.count++;
+    ++slot.current;
+    ++shard.allowed;
+    *charged_window = window;
     return false;
 }
 
-void RateLimitMiddleware::CleanupExpiredRecords() {
-    std::lock_guard<std::mutex> lock(records_mutex_);
+void RateLimitMiddleware::Refund(uint64_t hash, uint64_t charged_window) {
+    Shard& shard = GetShard(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
     
-    auto now = std::chrono::steady_clock::now();
-    for (auto it = request_records_.begin(); it != request_records_.end();) {
-        if (now - it->second.timestamp > config_.window) {
-            it = request_records_.erase(it);
-        } else {
-            ++it;
+    const size_t set = (hash / shards_.size()) % sets_per_shard_;
+    Slot* begin = shard.slots.data() + set * kSlotsPerSet;
+    for (size_t i = 0; i < kSlotsPerSet; ++i) {
+        Slot& slot = begin[i];
+        if (slot.hash != hash) {
+            continue;
         }
+        // 只归还计数时所在窗口的计数；该窗口已滚动为previous时归还previous，更早的窗口已不参与估算
+        if (slot.window == charged_window && slot.current > 0) {
+            --slot.current;
+        } else if (slot.window == charged_window + 1 && slot.previous > 0) {
+            --slot.previous;
+        }
+        return;
     }
 }
 
 // ===== CompressionMiddleware Implementation =====
 
-CompressionMiddleware::CompressionMiddleware(const CompressionConfig& config) : config_(config) {}
+CompressionMiddleware::CompressionMiddleware(const CompressionConfig& config) : config_(config) {
+    if (config_.cache_max_bytes > 0) {
+        cache_ = std::make_unique<HttpCompressionCache>(config_.cache_max_bytes);
+    }
+}
 
 void CompressionMiddleware::Handle(const HttpRequest& request, HttpResponse& response, std::function<void()> next) {
     next();
@@ -374,19 +518,31 @@ void CompressionMiddleware::Handle(const HttpRequest& request, HttpResponse& res
         return;
     }
     
+    // 响应内容随Accept-Encoding变化
+    std::string vary = response.GetHeader("Vary");
+    if (vary.find("Accept-Encoding") == std::string::npos) {
+        response.SetHeader("Vary", vary.empty() ? "Accept-Encoding" : vary + ", Accept-Encoding");
+    }
+    
     std::string encoding = GetAcceptedEncoding(request);
     if (encoding.empty()) {
         return;
     }
     
     // 压缩响应体
-    std::vector<uint8_t> body_bytes(response.GetBody().begin(), response.GetBody().end());
-    std::vector<uint8_t> compressed = CompressData(body_bytes, encoding);
+    auto compressed = CompressBody(request, response, encoding);
+    if (!compressed || compressed->size() >= response.GetBody().size()) {
+        return;
+    }
+    
+    response.SetBody(*compressed, response.GetContentType());
+    response.SetHeader("Content-Encoding", encoding);
+    response.SetHeader("Content-Length", std::to_string(compressed->size()));
     
-    if (!compressed.empty() && compressed.size() < body_bytes.size()) {
-        response.SetBody(std::string(compressed.begin(), compressed.end()));
-        response.SetHeader("Content-Encoding", encoding);
-        response.SetHeader("Content-Length", std::to_string(compressed.size()));
+    // 压缩后的表示与原始表示不同，强ETag降级为弱ETag
+    std::string etag = response.GetHeader("ETag");
+    if (!etag.empty() && etag.compare(0, 2, "W/") != 0) {
+        response.SetHeader("ETag", "W/" + etag);
     }
 }
 
@@ -397,6 +553,14 @@ bool CompressionMiddleware::ShouldCompress(const HttpRequest& request, const Htt
         return false;
     }
     
+    // 已编码、无实体、部分内容或流式的响应不再压缩
+    const auto status = response.GetStatusCode();
+    if (response.HasHeader("Content-Encoding") || response.HasFileRange() || response.IsStreaming() ||
+        status == HttpStatusCode::NO_CONTENT || status == HttpStatusCode::PARTIAL_CONTENT ||
+        status == HttpStatusCode::NOT_MODIFIED) {
+        return false;
+    }
+    
     // 检查响应大小
     if (response.GetBody().size() < config_.min_size) {
         return false;
@@ -414,14 +578,43 @@ bool CompressionMiddleware::ShouldCompress(const HttpRequest& request, const Htt
 }
 
 std::string CompressionMiddleware::GetAcceptedEncoding(const HttpRequest& request) const {
-    std::string accept_encoding = request.GetHeader("Accept-Encoding");
+    const std::string accept_encoding = request.GetHeader("Accept-Encoding");
     if (accept_encoding.empty()) {
         return "";
     }
     
-    // 简化的编码检查
+    // 解析 "gzip;q=0.8, br, *;q=0" 形式的编码列表
+    std::unordered_map<std::string, double> accepted;
+    std::istringstream stream(accept_encoding);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        std::string name = item.substr(0, item.find(';'));
+        name.erase(0, name.find_first_not_of(" \t"));
+        name.erase(name.find_last_not_of(" \t") + 1);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (name.empty()) {
+            continue;
+        }
+        
+        double quality = 1.0;
+        auto q_pos = item.find("q=");
+        if (q_pos != std::string::npos) {
+            quality = std::atof(item.c_str() + q_pos + 2);
+        }
+        accepted[name] = quality;
+    }
+    
+    // 按服务端优先级选择客户端接受的编码
     for (const auto& encoding : config_.encodings) {
-        if (accept_encoding.find(encoding) != std::string::npos) {
+        if (!HttpCompressor::IsSupported(encoding)) {
+            continue;
+        }
+        
+        auto it = accepted.find(encoding);
+        if (it == accepted.end()) {
+            it = accepted.find("*");
+        }
+        if (it != accepted.end() && it->second > 0.0) {
             return encoding;
         }
     }
@@ -429,10 +622,473 @@ std::string CompressionMiddleware::GetAcceptedEncoding(const HttpRequest& reques
     return "";
 }
 
-std::vector<uint8_t> CompressionMiddleware::CompressData(const std::vector<uint8_t>& data, const std::string& encoding) const {
-    // 这里需要实现实际的压缩算法（gzip, deflate等）
-    // 暂时返回原数据作为占位符
-    return data;
+std::shared_ptr<const std::string> CompressionMiddleware::CompressBody(const HttpRequest& request, const HttpResponse& response,
+                                                                       const std::string& encoding) {
+    const std::string& body = response.GetBody();
+    
+    std::string key;
+    if (cache_) {
+        const HttpUrl& url = request.GetUrl();
+        std::string target = url.path;
+        if (!url.query.empty()) {
+            target += '?';
+            target += url.query;
+        }
+        key = HttpCompressionCache::MakeKey(encoding, response.GetHeader("ETag"), target, body);
+        if (auto cached = cache_->Get(key)) {
+            return cached;
+        }
+    }
+    
+    auto compressed = std::make_shared<std::string>();
+    if (!HttpCompressor::Compress(body, encoding, config_.compression_level, *compressed)) {
+        NETWORK_LOG_WARN("Failed to compress response body with {}", encoding);
+        return nullptr;
+    }
+    
+    // 压缩无收益的结果同样缓存，避免重复尝试
+    if (cache_) {
+        cache_->Put(key, compressed);
+    }
+    return compressed;
+}
+
+// ===== EtagMiddleware Implementation =====
+
+EtagMiddleware::EtagMiddleware(const EtagConfig& config) : config_(config) {}
+
+void EtagMiddleware::Handle(const HttpRequest& request, HttpResponse& response, std::function<void()> next) {
+    if (!IsApplicable(request)) {
+        next();
+        return;
+    }
+    
+    // 版本提供者可在执行处理器之前判定
+    std::string etag;
+    if (const VersionProvider* provider = FindProvider(request.GetUrl().path)) {
+        const std::string version = (*provider)(request);
+        if (!version.empty()) {
+            etag = MakeEtag(version);
+            const std::string if_none_match = request.GetHeader("If-None-Match");
+            if (!if_none_match.empty() && HttpUtils::EtagMatches(if_none_match, etag)) {
+                response.SetHeader("ETag", etag);
+                SetNotModified(response);
+                not_modified_.fetch_add(1, std::memory_order_relaxed);
+                handler_skipped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+    
+    next();
+    
+    // 只处理完整的200响应，文件和流式响应由各自的处理器负责
+    if (response.GetStatusCode() != HttpStatusCode::OK || response.HasFileRange() || response.IsStreaming()) {
+        return;
+    }
+    
+    const std::string& body = response.GetBody();
+    if (response.HasHeader("ETag")) {
+        etag = response.GetHeader("ETag");
+    } else if (etag.empty()) {
+        if (body.size() > config_.max_body_size) {
+            return;
+        }
+        char digest[48];
+        std::snprintf(digest, sizeof(digest), "\"%zx-%016llx\"", body.size(),
+                      static_cast<unsigned long long>(HttpUtils::Hash64(body)));
+        etag = digest;
+        hashed_bytes_.fetch_add(body.size(), std::memory_order_relaxed);
+        response.SetHeader("ETag", etag);
+    } else {
+        response.SetHeader("ETag", etag);
+    }
+    
+    const std::string if_none_match = request.GetHeader("If-None-Match");
+    if (!if_none_match.empty() && HttpUtils::EtagMatches(if_none_match, etag)) {
+        saved_bytes_.fetch_add(body.size(), std::memory_order_relaxed);
+        not_modified_.fetch_add(1, std::memory_order_relaxed);
+        SetNotModified(response);
+    }
+}
+
+EtagMiddleware::EtagStats EtagMiddleware::GetStats() const {
+    EtagStats stats;
+    stats.not_modified = not_modified_.load(std::memory_order_relaxed);
+    stats.handler_skipped = handler_skipped_.load(std::memory_order_relaxed);
+    stats.hashed_bytes = hashed_bytes_.load(std::memory_order_relaxed);
+    stats.saved_bytes = saved_bytes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::string EtagMiddleware::MakeEtag(std::string_view version) {
+    // etagc = %x21 / %x23-7E / obs-text
+    const bool valid = !version.empty() && std::all_of(version.begin(), version.end(), [](char c) {
+        const unsigned char ch = static_cast<unsigned char>(c);
+        return ch >= 0x21 && ch != '"' && ch != 0x7F;
+    });
+    if (valid) {
+        std::string etag;
+        etag.reserve(version.size() + 2);
+        etag += '"';
+        etag += version;
+        etag += '"';
+        return etag;
+    }
+    
+    char digest[24];
+    std::snprintf(digest, sizeof(digest), "\"v%016llx\"", static_cast<unsigned long long>(HttpUtils::Hash64(version)));
+    return digest;
+}
+
+bool EtagMiddleware::CheckVersion(const HttpRequest& request, HttpResponse& response, std::string_view version) {
+    const std::string etag = MakeEtag(version);
+    response.SetHeader("ETag", etag);
+    
+    const auto method = request.GetMethod();
+    if (method != HttpMethod::GET && method != HttpMethod::HEAD) {
+        return false;
+    }
+    const std::string if_none_match = request.GetHeader("If-None-Match");
+    if (if_none_match.empty() || !HttpUtils::EtagMatches(if_none_match, etag)) {
+        return false;
+    }
+    
+    SetNotModified(response);
+    return true;
+}
+
+bool EtagMiddleware::IsApplicable(const HttpRequest& request) const {
+    const auto method = request.GetMethod();
+    if (method != HttpMethod::GET && method != HttpMethod::HEAD) {
+        return false;
+    }
+    return config_.excluded_paths.find(request.GetUrl().path) == config_.excluded_paths.end();
+}
+
+const EtagMiddleware::VersionProvider* EtagMiddleware::FindProvider(const std::string& path) const {
+    const VersionProvider* provider = nullptr;
+    size_t best_length = 0;
+    for (const auto& route : config_.version_providers) {
+        if (route.first.size() >= best_length && path.compare(0, route.first.size(), route.first) == 0) {
+            best_length = route.first.size();
+            provider = &route.second;
+        }
+    }
+    return provider;
+}
+
+// 304只保留ETag、Cache-Control、Vary等元数据，不携带响应体及其描述头
+void EtagMiddleware::SetNotModified(HttpResponse& response) {
+    response.SetStatusCode(HttpStatusCode::NOT_MODIFIED);
+    response.SetBody(std::string(), "");
+    response.RemoveHeader("Content-Type");
+    response.RemoveHeader("Content-Length");
+    response.RemoveHeader("Content-Encoding");
+}
+
+// ===== ResponseCacheMiddleware Implementation =====
+
+ResponseCacheMiddleware::ResponseCacheMiddleware(const ResponseCacheConfig& config) : config_(config) {
+    const size_t shard_count = std::max<size_t>(config_.shard_count, 1);
+    shard_max_bytes_ = std::max<size_t>(config_.max_bytes / shard_count, 1);
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+void ResponseCacheMiddleware::Handle(const HttpRequest& request, HttpResponse& response, std::function<void()> next) {
+    if (!IsCacheableRequest(request)) {
+        next();
+        return;
+    }
+    
+    const auto ttl = GetTtl(request.GetUrl().path);
+    if (ttl.count() <= 0) {
+        next();
+        return;
+    }
+    
+    const std::string key = BuildKey(request);
+    Shard& shard = GetShard(key);
+    
+    std::shared_ptr<InFlight> flight;
+    bool leader = false;
+    {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        const auto now = Clock::now();
+        
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            auto entry = it->second;
+            auto cached = entry->response;
+            
+            if (now < cached->expires_at) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+                ++shard.hits;
+                lock.unlock();
+                Serve(*cached, response, "HIT");
+                return;
+            }
+            
+            if (now < cached->stale_until) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+                if (entry->refreshing) {
+                    // 已有请求在刷新，直接返回旧响应
+                    ++shard.stale_hits;
+                    lock.unlock();
+                    Serve(*cached, response, "STALE");
+                    return;
+                }
+                // 当前请求负责刷新
+                entry->refreshing = true;
+                ++shard.misses;
+                leader = true;
+            } else {
+                shard.bytes -= cached->bytes;
+                shard.lru.erase(entry);
+                shard.index.erase(it);
+            }
+        }
+        
+        if (!leader) {
+            auto flight_it = shard.in_flight.find(key);
+            if (flight_it != shard.in_flight.end()) {
+                // 等待会阻塞I/O线程，超出上限的请求不等待，直接执行处理器
+                if (config_.coalesce_timeout.count() <= 0 ||
+                    flight_it->second->waiters >= config_.max_coalesced_waiters) {
+                    ++shard.misses;
+                    lock.unlock();
+                    next();
+                    return;
+                }
+                flight = flight_it->second;
+                ++flight->waiters;
+                ++shard.coalesced;
+            } else {
+                flight = std::make_shared<InFlight>();
+                shard.in_flight.emplace(key, flight);
+                ++shard.misses;
+                leader = true;
+            }
+        }
+    }
+    
+    if (!leader) {
+        // 等待同键请求的处理结果
+        std::unique_lock<std::mutex> wait_lock(flight->mutex);
+        const bool done = flight->cv.wait_for(wait_lock, config_.coalesce_timeout, [&flight]() { return flight->done; });
+        auto result = flight->result;
+        wait_lock.unlock();
+        
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            --flight->waiters;
+            if (!done) {
+                ++shard.coalesce_timeouts;
+            }
+        }
+        
+        if (done && result) {
+            Serve(*result, response, "HIT");
+            return;
+        }
+        
+        // 结果不可缓存或等待超时，自行执行处理器
+        next();
+        return;
+    }
+    
+    try {
+        next();
+    } catch (...) {
+        Complete(shard, key, flight, nullptr);
+        throw;
+    }
+    
+    Complete(shard, key, flight, Capture(response, ttl));
+    response.SetHeader("X-Cache", "MISS");
+}
+
+ResponseCacheMiddleware::CacheStats ResponseCacheMiddleware::GetStats() const {
+    CacheStats stats;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.hits += shard->hits;
+        stats.stale_hits += shard->stale_hits;
+        stats.misses += shard->misses;
+        stats.coalesced += shard->coalesced;
+        stats.coalesce_timeouts += shard->coalesce_timeouts;
+        stats.entries += shard->lru.size();
+        stats.bytes += shard->bytes;
+    }
+    return stats;
+}
+
+void ResponseCacheMiddleware::Clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->lru.clear();
+        shard->index.clear();
+        shard->bytes = 0;
+    }
+}
+
+bool ResponseCacheMiddleware::IsCacheableRequest(const HttpRequest& request) const {
+    const HttpMethod method = request.GetMethod();
+    if (method != HttpMethod::GET && method != HttpMethod::HEAD) {
+        return false;
+    }
+    
+    if (!config_.cache_authorized && request.HasHeader("Authorization")) {
+        return false;
+    }
+    
+    return request.GetHeader("Cache-Control").find("no-store") == std::string::npos;
+}
+
+std::string ResponseCacheMiddleware::BuildKey(const HttpRequest& request) const {
+    std::string key = HttpUtils::MethodToString(request.GetMethod());
+    key += ' ';
+    key += request.GetUrl().path;
+    
+    // 查询参数排序后参与缓存键，参数顺序不同的请求共享同一条目
+    const std::string& query = request.GetUrl().query;
+    if (!query.empty()) {
+        // 同名参数保持原有先后顺序（处理器取最后一个值）
+        auto params = HttpUtils::ParseQueryString(query, request.GetArena());
+        std::stable_sort(params.begin(), params.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        
+        char separator = '?';
+        for (const auto& param : params) {
+            key += separator;
+            key += HttpUtils::UrlEncode(param.first);
+            key += '=';
+            key += HttpUtils::UrlEncode(param.second);
+            separator = '&';
+        }
+    }
+    
+    for (const auto& header : config_.vary_headers) {
+        key += '\n';
+        key += header;
+        key += ':';
+        key += request.GetHeaderView(header);
+    }
+    
+    return key;
+}
+
+std::chrono::seconds ResponseCacheMiddleware::GetTtl(const std::string& path) const {
+    auto ttl = config_.default_ttl;
+    size_t best_length = 0;
+    for (const auto& route : config_.route_ttls) {
+        if (route.first.size() >= best_length && path.compare(0, route.first.size(), route.first) == 0) {
+            best_length = route.first.size();
+            ttl = route.second;
+        }
+    }
+    return ttl;
+}
+
+std::shared_ptr<const ResponseCacheMiddleware::CachedResponse> ResponseCacheMiddleware::Capture(
+    const HttpResponse& response, std::chrono::seconds ttl) const {
+    if (response.GetStatusCode() != HttpStatusCode::OK || response.HasFileRange() || response.IsStreaming() ||
+        !response.GetCookies().empty() || response.HasHeader("Set-Cookie") ||
+        response.GetBody().size() > config_.max_entry_size) {
+        return nullptr;
+    }
+    
+    const std::string cache_control = response.GetHeader("Cache-Control");
+    if (cache_control.find("no-store") != std::string::npos || cache_control.find("private") != std::string::npos) {
+        return nullptr;
+    }
+    
+    auto cached = std::make_shared<CachedResponse>();
+    cached->status_code = response.GetStatusCode();
+    cached->headers = response.GetHeaders();
+    cached->body = response.GetBody();
+    cached->stored_at = Clock::now();
+    cached->expires_at = cached->stored_at + ttl;
+    cached->stale_until = cached->expires_at + config_.stale_while_revalidate;
+    
+    cached->bytes = cached->body.size();
+    for (const auto& header : cached->headers) {
+        cached->bytes += header.name_string().size() + header.value().size();
+    }
+    return cached;
+}
+
+void ResponseCacheMiddleware::Serve(const CachedResponse& cached, HttpResponse& response, const char* cache_status) const {
+    response.SetStatusCode(cached.status_code);
+    response.SetBody(cached.body);
+    for (const auto& header : cached.headers) {
+        response.GetHeaders().set(header.name_string(), header.value());
+    }
+    
+    const auto age = std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - cached.stored_at);
+    response.SetHeader("Age", std::to_string(age.count()));
+    response.SetHeader("X-Cache", cache_status);
+}
+
+ResponseCacheMiddleware::Shard& ResponseCacheMiddleware::GetShard(const std::string& key) {
+    return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+void ResponseCacheMiddleware::Complete(Shard& shard, const std::string& key, const std::shared_ptr<InFlight>& flight,
+                                       std::shared_ptr<const CachedResponse> cached) {
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (cached) {
+            StoreLocked(shard, key, cached);
+        } else {
+            // 刷新失败时保留旧响应，后续请求可再次尝试刷新
+            auto it = shard.index.find(key);
+            if (it != shard.index.end()) {
+                it->second->refreshing = false;
+            }
+        }
+        if (flight) {
+            shard.in_flight.erase(key);
+        }
+    }
+    
+    if (flight) {
+        {
+            std::lock_guard<std::mutex> lock(flight->mutex);
+            flight->done = true;
+            flight->result = std::move(cached);
+        }
+        flight->cv.notify_all();
+    }
+}
+
+void ResponseCacheMiddleware::StoreLocked(Shard& shard, const std::string& key, std::shared_ptr<const CachedResponse> cached) {
+    if (cached->bytes > shard_max_bytes_) {
+        return;
+    }
+    
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        shard.bytes -= it->second->response->bytes;
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+    
+    shard.bytes += cached->bytes;
+    shard.lru.push_front(Entry{key, std::move(cached), false});
+    shard.index[key] = shard.lru.begin();
+    EvictLocked(shard);
+}
+
+void ResponseCacheMiddleware::EvictLocked(Shard& shard) {
+    while (shard.bytes > shard_max_bytes_ && !shard.lru.empty()) {
+        const Entry& victim = shard.lru.back();
+        shard.bytes -= victim.response->bytes;
+        shard.index.erase(victim.key);
+        shard.lru.pop_back();
+    }
 }
 
 // ===== SecurityHeadersMiddleware Implementation =====
@@ -511,6 +1167,14 @@ std::unique_ptr<CompressionMiddleware> Compression(const CompressionMiddleware::
     return std::make_unique<CompressionMiddleware>(config);
 }
 
+std::unique_ptr<EtagMiddleware> Etag(const EtagMiddleware::EtagConfig& config) {
+    return std::make_unique<EtagMiddleware>(config);
+}
+
+std::unique_ptr<ResponseCacheMiddleware> ResponseCache(const ResponseCacheMiddleware::ResponseCacheConfig& config) {
+    return std::make_unique<ResponseCacheMiddleware>(config);
+}
+
 std::unique_ptr<SecurityHeadersMiddleware> Security(const SecurityHeadersMiddleware::SecurityConfig& config) {
     return std::make_unique<SecurityHeadersMiddleware>(config);
 }
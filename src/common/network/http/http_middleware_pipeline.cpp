@@ -0,0 +1,63 @@
+#include "common/network/http/http_middleware_pipeline.h"
+
+namespace common {
+namespace network {
+namespace http {
+
+// ===== HttpMiddlewarePipeline Implementation =====
+
+void HttpMiddlewarePipeline::Append(HttpRequestHandler handler, std::string path_prefix) {
+    stages_.push_back(Stage{std::move(handler), std::move(path_prefix)});
+}
+
+void HttpMiddlewarePipeline::Run(const HttpRequest& request, HttpResponse& response) const {
+    Invoke(Frame{this, &request, &response, 0});
+}
+
+void HttpMiddlewarePipeline::Invoke(const Frame& frame) const {
+    size_t index = frame.index;
+    const std::string& path = frame.request->GetUrl().path;
+    while (index < stages_.size() && !stages_[index].path_prefix.empty() &&
+           !HasPathPrefix(path, stages_[index].path_prefix)) {
+        ++index;
+    }
+    if (index >= stages_.size()) {
+        return;
+    }
+
+    const Frame next_frame{this, frame.request, frame.response, index + 1};
+    stages_[index].handler(*frame.request, *frame.response, [&next_frame]() {
+        next_frame.pipeline->Invoke(next_frame);
+    });
+}
+
+HttpMiddlewarePipeline::PrefixMatch HttpMiddlewarePipeline::MatchPrefix(std::string_view pattern,
+                                                                        std::string_view prefix) {
+    // 模式中第一个参数或通配符之前的部分对该路由的所有请求路径都相同
+    const size_t dynamic = pattern.find_first_of("{*");
+    const std::string_view literal = pattern.substr(0, dynamic);
+
+    // 前缀之后的字符仍在固定部分内（或模式没有动态部分）时可以直接判定
+    if (prefix.size() < literal.size() || dynamic == std::string_view::npos) {
+        return HasPathPrefix(literal, prefix) ? PrefixMatch::ALWAYS : PrefixMatch::NEVER;
+    }
+    if (prefix.compare(0, literal.size(), literal) != 0) {
+        return PrefixMatch::NEVER;
+    }
+    // 前缀恰好覆盖固定部分且以'/'结尾时，不论动态部分是什么都在前缀之下
+    if (prefix.size() == literal.size() && (prefix.empty() || prefix.back() == '/')) {
+        return PrefixMatch::ALWAYS;
+    }
+    return PrefixMatch::RUNTIME;
+}
+
+bool HttpMiddlewarePipeline::HasPathPrefix(std::string_view path, std::string_view prefix) {
+    if (path.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    return path.size() == prefix.size() || prefix.empty() || prefix.back() == '/' || path[prefix.size()] == '/';
+}
+
+} // namespace http
+} // namespace network
+} // namespace common
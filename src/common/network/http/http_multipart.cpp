@@ -0,0 +1,492 @@
+#include "common/network/http/http_multipart.h"
+#include <boost/asio/error.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/http/error.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace common {
+namespace network {
+namespace http {
+
+namespace {
+
+constexpr std::string_view kCrlf = "\r\n";
+
+// Whitespace allowed after a delimiter before its line break (RFC 2046 transport padding)
+constexpr size_t kMaxTransportPadding = 256;
+
+boost::beast::string_view ToBeast(std::string_view value) {
+    return boost::beast::string_view(value.data(), value.size());
+}
+
+bool IEquals(std::string_view a, std::string_view b) {
+    return boost::beast::iequals(ToBeast(a), ToBeast(b));
+}
+
+std::string_view Trim(std::string_view value) {
+    const size_t begin = value.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    const size_t end = value.find_last_not_of(" \t");
+    return value.substr(begin, end - begin + 1);
+}
+
+// Call f(name, value) for each ";name=value" parameter of a header value; quoted values may contain ';'
+template <typename Function>
+void ForEachParameter(std::string_view header, Function&& f) {
+    size_t i = header.find(';');
+    while (i != std::string_view::npos && i < header.size()) {
+        ++i;
+        const size_t equals = header.find_first_of("=;", i);
+        if (equals == std::string_view::npos || header[equals] == ';') {
+            i = equals;
+            continue;
+        }
+
+        const std::string_view name = Trim(header.substr(i, equals - i));
+        i = equals + 1;
+        while (i < header.size() && (header[i] == ' ' || header[i] == '\t')) {
+            ++i;
+        }
+
+        std::string value;
+        if (i < header.size() && header[i] == '"') {
+            for (++i; i < header.size() && header[i] != '"'; ++i) {
+                if (header[i] == '\\' && i + 1 < header.size()) {
+                    ++i;
+                }
+                value.push_back(header[i]);
+            }
+            i = header.find(';', i);
+        } else {
+            const size_t end = header.find(';', i);
+            value = std::string(Trim(header.substr(i, end == std::string_view::npos ? std::string_view::npos : end - i)));
+            i = end;
+        }
+
+        f(name, std::move(value));
+    }
+}
+
+std::string QuoteParameter(const std::string& value) {
+    std::string quoted;
+    quoted.reserve(value.size() + 2);
+    quoted.push_back('"');
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            quoted.push_back('\\');
+        }
+        quoted.push_back(c);
+    }
+    quoted.push_back('"');
+    return quoted;
+}
+
+std::string MimeTypeOf(const std::string& filename) {
+    const size_t dot = filename.find_last_of('.');
+    return HttpUtils::GetMimeType(dot == std::string::npos ? std::string() : filename.substr(dot));
+}
+
+} // namespace
+
+// ===== HttpMultipartWriter =====
+
+HttpMultipartWriter::HttpMultipartWriter(std::string boundary, size_t chunk_size)
+    : boundary_(boundary.empty() ? HttpUtils::GenerateBoundary() : std::move(boundary)),
+      chunk_size_(std::max<size_t>(chunk_size, 1)) {
+    closing_ = "--" + boundary_ + "--\r\n";
+    size_ = closing_.size();
+}
+
+std::string HttpMultipartWriter::GetContentType() const {
+    return "multipart/form-data; boundary=" + boundary_;
+}
+
+void HttpMultipartWriter::AddField(const std::string& name, std::string value, const std::string& content_type) {
+    const uint64_t size = value.size();
+    AppendPart(name, "", content_type, HttpHeaders{}, std::move(value), "", size);
+}
+
+void HttpMultipartWriter::AddFile(const std::string& name, const std::string& filename, std::string content,
+                                  const std::string& content_type) {
+    const uint64_t size = content.size();
+    AppendPart(name, filename, content_type.empty() ? MimeTypeOf(filename) : content_type,
+               HttpHeaders{}, std::move(content), "", size);
+}
+
+void HttpMultipartWriter::AddPart(const HttpFormField& field) {
+    AppendPart(field.name, field.filename, field.content_type, field.headers, field.value, "", field.value.size());
+}
+
+bool HttpMultipartWriter::AddFileFromDisk(const std::string& name, const std::string& path,
+                                          const std::string& filename, const std::string& content_type) {
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec)) {
+        return false;
+    }
+    const uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+
+    const std::string reported = filename.empty() ? std::filesystem::path(path).filename().string() : filename;
+    AppendPart(name, reported, content_type.empty() ? MimeTypeOf(reported) : content_type,
+               HttpHeaders{}, "", path, size);
+    return true;
+}
+
+void HttpMultipartWriter::AppendPart(const std::string& name, const std::string& filename,
+                                     const std::string& content_type, const HttpHeaders& headers,
+                                     std::string data, std::string path, uint64_t size) {
+    Part part;
+    part.head.reserve(boundary_.size() + name.size() + filename.size() + content_type.size() + 80);
+    part.head.append("--").append(boundary_).append(kCrlf);
+    part.head.append("Content-Disposition: form-data; name=").append(QuoteParameter(name));
+    if (!filename.empty()) {
+        part.head.append("; filename=").append(QuoteParameter(filename));
+    }
+    part.head.append(kCrlf);
+    if (!content_type.empty()) {
+        part.head.append("Content-Type: ").append(content_type).append(kCrlf);
+    }
+    for (const auto& [header, value] : headers) {
+        part.head.append(header).append(": ").append(value).append(kCrlf);
+    }
+    part.head.append(kCrlf);
+
+    part.data = std::move(data);
+    part.path = std::move(path);
+    part.size = size;
+
+    size_ += part.head.size() + part.size + kCrlf.size();
+    parts_.push_back(std::move(part));
+}
+
+bool HttpMultipartWriter::Read(std::string& chunk, boost::system::error_code& ec) {
+    chunk.clear();
+    ec = {};
+
+    const size_t last = parts_.size() * 3;
+
+    // Copy the rest of an in-memory segment, or as much of it as fits
+    auto append = [this, &chunk](std::string_view segment) {
+        const size_t n = std::min<size_t>(segment.size() - offset_, chunk_size_ - chunk.size());
+        chunk.append(segment.data() + offset_, n);
+        offset_ += n;
+        if (offset_ == segment.size()) {
+            segment_++;
+            offset_ = 0;
+        }
+    };
+
+    while (segment_ <= last && chunk.size() < chunk_size_) {
+        if (segment_ == last) {
+            append(closing_);
+            continue;
+        }
+
+        const Part& part = parts_[segment_ / 3];
+        if (segment_ % 3 == 0) {
+            append(part.head);
+        } else if (segment_ % 3 == 2) {
+            append(kCrlf);
+        } else if (part.path.empty()) {
+            append(part.data);
+        } else {
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(part.size - offset_, chunk_size_ - chunk.size()));
+            if (!file_reader_.Append(part.path, offset_, n, chunk, ec)) {
+                return false;
+            }
+
+            offset_ += n;
+            if (offset_ == part.size) {
+                file_reader_.Close();
+                segment_++;
+                offset_ = 0;
+            }
+        }
+    }
+
+    return !chunk.empty();
+}
+
+bool HttpMultipartWriter::Rewind() {
+    segment_ = 0;
+    offset_ = 0;
+    file_reader_.Close();
+    return true;
+}
+
+std::string HttpMultipartWriter::ToString() const {
+    std::string body;
+    body.reserve(static_cast<size_t>(size_));
+    for (const auto& part : parts_) {
+        body.append(part.head);
+        if (part.path.empty()) {
+            body.append(part.data);
+        } else {
+            std::ifstream file(part.path, std::ios::binary);
+            const size_t offset = body.size();
+            body.resize(offset + static_cast<size_t>(part.size));
+            file.read(&body[offset], static_cast<std::streamsize>(part.size));
+            body.resize(offset + static_cast<size_t>(std::max<std::streamsize>(file.gcount(), 0)));
+        }
+        body.append(kCrlf);
+    }
+    body.append(closing_);
+    return body;
+}
+
+// ===== HttpMultipartParser =====
+
+HttpMultipartParser::HttpMultipartParser(std::string boundary, const HttpMultipartLimits& limits)
+    : limits_(limits), delimiter_("\r\n--" + boundary) {
+    // The first delimiter may start the body without a preceding line break
+    buffer_ = kCrlf;
+    if (boundary.empty() || boundary.size() > 70) {
+        Fail(HttpMultipartError::MALFORMED);
+    }
+}
+
+std::string HttpMultipartParser::ParseBoundary(std::string_view content_type) {
+    std::string boundary;
+    ForEachParameter(content_type, [&boundary](std::string_view name, std::string value) {
+        if (boundary.empty() && IEquals(name, "boundary")) {
+            boundary = std::move(value);
+        }
+    });
+    return boundary;
+}
+
+bool HttpMultipartParser::Feed(std::string_view data) {
+    if (state_ == State::FAILED) {
+        return false;
+    }
+    if (state_ == State::END) {
+        // Epilogue after the closing delimiter is ignored
+        return true;
+    }
+
+    buffer_.append(data.data(), data.size());
+
+    bool more = true;
+    while (more) {
+        std::string_view view(buffer_);
+        view.remove_prefix(pos_);
+
+        switch (state_) {
+        case State::PREAMBLE: {
+            const size_t at = view.find(delimiter_);
+            if (at == std::string_view::npos) {
+                // Only a possible delimiter prefix has to be kept
+                if (view.size() >= delimiter_.size()) {
+                    pos_ += view.size() - (delimiter_.size() - 1);
+                }
+                more = false;
+                break;
+            }
+            pos_ += at + delimiter_.size();
+            state_ = State::AFTER_DELIMITER;
+            break;
+        }
+
+        case State::AFTER_DELIMITER: {
+            size_t i = 0;
+            while (i < view.size() && (view[i] == ' ' || view[i] == '\t')) {
+                ++i;
+            }
+            if (i > kMaxTransportPadding) {
+                return Fail(HttpMultipartError::MALFORMED);
+            }
+            if (view.size() - i < 2) {
+                more = false;
+                break;
+            }
+            if (view.compare(i, 2, "--") == 0) {
+                state_ = State::END;
+                buffer_.clear();
+                pos_ = 0;
+                return true;
+            }
+            if (view.compare(i, 2, kCrlf) != 0) {
+                return Fail(HttpMultipartError::MALFORMED);
+            }
+            pos_ += i + 2;
+            state_ = State::HEADERS;
+            break;
+        }
+
+        case State::HEADERS: {
+            size_t end = 0;
+            size_t consumed = 2;
+            if (view.compare(0, 2, kCrlf) != 0) {
+                end = view.find("\r\n\r\n");
+                if (end == std::string_view::npos) {
+                    if (view.size() > limits_.max_header_size) {
+                        return Fail(HttpMultipartError::HEADER_TOO_LARGE);
+                    }
+                    more = false;
+                    break;
+                }
+                consumed = end + 4;
+            }
+            if (end > limits_.max_header_size) {
+                return Fail(HttpMultipartError::HEADER_TOO_LARGE);
+            }
+            if (part_count_ >= limits_.max_parts) {
+                return Fail(HttpMultipartError::TOO_MANY_PARTS);
+            }
+
+            part_ = HttpMultipartPart{};
+            part_.index = part_count_++;
+            if (!ParseHeaders(view.substr(0, end))) {
+                return false;
+            }
+            part_.max_size = part_.IsFile() ? limits_.max_file_size : limits_.max_field_size;
+            pos_ += consumed;
+
+            if (on_begin_ && !on_begin_(part_)) {
+                return Fail(HttpMultipartError::ABORTED);
+            }
+            state_ = State::BODY;
+            break;
+        }
+
+        case State::BODY: {
+            const size_t at = view.find(delimiter_);
+            if (at == std::string_view::npos) {
+                // Hold back only a trailing piece that could begin a delimiter
+                size_t keep = 0;
+                const size_t tail = std::min(view.size(), delimiter_.size() - 1);
+                const size_t cr = view.find('\r', view.size() - tail);
+                if (cr != std::string_view::npos) {
+                    keep = view.size() - cr;
+                }
+                const size_t n = view.size() - keep;
+                if (n > 0 && !Deliver(view.substr(0, n))) {
+                    return false;
+                }
+                pos_ += n;
+                more = false;
+                break;
+            }
+
+            if (at > 0 && !Deliver(view.substr(0, at))) {
+                return false;
+            }
+            if (on_end_ && !on_end_(part_)) {
+                return Fail(HttpMultipartError::ABORTED);
+            }
+            pos_ += at + delimiter_.size();
+            state_ = State::AFTER_DELIMITER;
+            break;
+        }
+
+        case State::END:
+        case State::FAILED:
+            more = false;
+            break;
+        }
+    }
+
+    buffer_.erase(0, pos_);
+    pos_ = 0;
+    return true;
+}
+
+bool HttpMultipartParser::Finish() {
+    if (state_ == State::FAILED) {
+        return false;
+    }
+    if (state_ != State::END) {
+        return Fail(HttpMultipartError::INCOMPLETE);
+    }
+    return true;
+}
+
+boost::system::error_code HttpMultipartParser::GetErrorCode() const {
+    switch (error_) {
+        case HttpMultipartError::NONE:
+            return {};
+        case HttpMultipartError::HEADER_TOO_LARGE:
+            return boost::beast::http::error::header_limit;
+        case HttpMultipartError::PART_TOO_LARGE:
+        case HttpMultipartError::TOO_MANY_PARTS:
+            return boost::beast::http::error::body_limit;
+        case HttpMultipartError::ABORTED:
+            return boost::asio::error::operation_aborted;
+        case HttpMultipartError::INCOMPLETE:
+            return boost::beast::http::error::partial_message;
+        case HttpMultipartError::MALFORMED:
+        default:
+            return boost::system::errc::make_error_code(boost::system::errc::bad_message);
+    }
+}
+
+const char* HttpMultipartParser::ErrorToString(HttpMultipartError error) {
+    switch (error) {
+        case HttpMultipartError::NONE: return "none";
+        case HttpMultipartError::MALFORMED: return "malformed multipart body";
+        case HttpMultipartError::HEADER_TOO_LARGE: return "part header too large";
+        case HttpMultipartError::PART_TOO_LARGE: return "part too large";
+        case HttpMultipartError::TOO_MANY_PARTS: return "too many parts";
+        case HttpMultipartError::ABORTED: return "aborted by handler";
+        case HttpMultipartError::INCOMPLETE: return "incomplete multipart body";
+        default: return "unknown";
+    }
+}
+
+bool HttpMultipartParser::Fail(HttpMultipartError error) {
+    state_ = State::FAILED;
+    error_ = error;
+    buffer_.clear();
+    pos_ = 0;
+    return false;
+}
+
+bool HttpMultipartParser::ParseHeaders(std::string_view block) {
+    while (!block.empty()) {
+        const size_t end = block.find(kCrlf);
+        const std::string_view line = block.substr(0, end);
+        block = end == std::string_view::npos ? std::string_view{} : block.substr(end + 2);
+
+        const size_t colon = line.find(':');
+        if (colon == std::string_view::npos || colon == 0) {
+            return Fail(HttpMultipartError::MALFORMED);
+        }
+        const std::string_view name = Trim(line.substr(0, colon));
+        const std::string_view value = Trim(line.substr(colon + 1));
+        part_.headers.insert(ToBeast(name), ToBeast(value));
+
+        if (IEquals(name, "Content-Disposition")) {
+            ForEachParameter(value, [this](std::string_view param, std::string param_value) {
+                if (IEquals(param, "name")) {
+                    part_.name = std::move(param_value);
+                } else if (IEquals(param, "filename")) {
+                    part_.filename = std::move(param_value);
+                }
+            });
+        } else if (IEquals(name, "Content-Type")) {
+            part_.content_type = std::string(value);
+        }
+    }
+    return true;
+}
+
+bool HttpMultipartParser::Deliver(std::string_view data) {
+    if (part_.size + data.size() > part_.max_size) {
+        return Fail(HttpMultipartError::PART_TOO_LARGE);
+    }
+    part_.size += data.size();
+    if (on_data_ && !on_data_(part_, data)) {
+        return Fail(HttpMultipartError::ABORTED);
+    }
+    return true;
+}
+
+} // namespace http
+} // namespace network
+} // namespace common
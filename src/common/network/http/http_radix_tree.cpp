@@ -0,0 +1,312 @@
+#include "common/network/http/http_radix_tree.h"
+#include <algorithm>
+#include <cctype>
+
+namespace common {
+namespace network {
+namespace http {
+
+// ===== PathParams Implementation =====
+
+void PathParams::Push(std::string_view name, std::string_view value) {
+    if (size_ < kInlineCapacity) {
+        inline_[size_] = PathParam{name, value};
+    } else {
+        overflow_.push_back(PathParam{name, value});
+    }
+    ++size_;
+}
+
+void PathParams::Pop() {
+    if (size_ == 0) {
+        return;
+    }
+    if (size_ > kInlineCapacity) {
+        overflow_.pop_back();
+    }
+    --size_;
+}
+
+void PathParams::Clear() {
+    overflow_.clear();
+    size_ = 0;
+}
+
+const PathParam& PathParams::operator[](size_t index) const {
+    return index < kInlineCapacity ? inline_[index] : overflow_[index - kInlineCapacity];
+}
+
+std::string_view PathParams::Get(std::string_view name) const {
+    for (size_t i = 0; i < size_; ++i) {
+        const auto& param = (*this)[i];
+        if (param.name == name) {
+            return param.value;
+        }
+    }
+    return {};
+}
+
+bool PathParams::Has(std::string_view name) const {
+    for (size_t i = 0; i < size_; ++i) {
+        if ((*this)[i].name == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ===== HttpRadixTree Implementation =====
+
+struct HttpRadixTree::Node {
+    std::string prefix;                                   // 静态节点：边上的静态文本
+    std::string param_name;                               // 参数/通配符节点：参数名
+    std::string constraint_source;                        // 参数约束原文
+    std::unique_ptr<std::regex> constraint;               // 参数约束（未声明时为空）
+
+    std::string indices;                                  // 各静态子节点前缀的首字符
+    std::vector<std::unique_ptr<Node>> static_children;
+    std::vector<std::unique_ptr<Node>> param_children;    // 带约束的参数节点排在前面
+    std::unique_ptr<Node> wildcard_child;
+
+    bool has_value = false;
+    size_t value = 0;
+};
+
+HttpRadixTree::HttpRadixTree(bool case_sensitive)
+    : root_(std::make_unique<Node>()), case_sensitive_(case_sensitive) {
+}
+
+HttpRadixTree::~HttpRadixTree() = default;
+HttpRadixTree::HttpRadixTree(HttpRadixTree&&) noexcept = default;
+HttpRadixTree& HttpRadixTree::operator=(HttpRadixTree&&) noexcept = default;
+
+bool HttpRadixTree::Insert(const std::string& pattern, size_t value) {
+    Node* node = root_.get();
+    size_t pos = 0;
+
+    while (pos < pattern.size()) {
+        const char c = pattern[pos];
+
+        if (c == '{') {
+            // 查找配对的'}'，约束正则中可能包含花括号
+            size_t close = pos + 1;
+            int depth = 1;
+            for (; close < pattern.size(); ++close) {
+                if (pattern[close] == '{') {
+                    ++depth;
+                } else if (pattern[close] == '}' && --depth == 0) {
+                    break;
+                }
+            }
+            if (close >= pattern.size()) {
+                return false;
+            }
+
+            const std::string spec = pattern.substr(pos + 1, close - pos - 1);
+            const auto colon = spec.find(':');
+            const std::string name = spec.substr(0, colon);
+            const std::string constraint = colon == std::string::npos ? "" : spec.substr(colon + 1);
+            if (name.empty()) {
+                return false;
+            }
+
+            // 参数匹配到片段结尾，其后只能是'/'或模式结尾
+            pos = close + 1;
+            if (pos < pattern.size() && pattern[pos] != '/') {
+                return false;
+            }
+
+            auto it = std::find_if(node->param_children.begin(), node->param_children.end(),
+                [&](const std::unique_ptr<Node>& child) {
+                    return child->param_name == name && child->constraint_source == constraint;
+                });
+
+            if (it != node->param_children.end()) {
+                node = it->get();
+                continue;
+            }
+
+            auto child = std::make_unique<Node>();
+            child->param_name = name;
+            child->constraint_source = constraint;
+            if (!constraint.empty()) {
+                try {
+                    auto flags = std::regex::ECMAScript | std::regex::optimize;
+                    if (!case_sensitive_) {
+                        flags |= std::regex::icase;
+                    }
+                    child->constraint = std::make_unique<std::regex>(constraint, flags);
+                } catch (const std::regex_error&) {
+                    return false;
+                }
+            }
+
+            Node* inserted = child.get();
+            auto insert_pos = constraint.empty()
+                ? node->param_children.end()
+                : std::find_if(node->param_children.begin(), node->param_children.end(),
+                      [](const std::unique_ptr<Node>& existing) { return !existing->constraint; });
+            node->param_children.insert(insert_pos, std::move(child));
+            node = inserted;
+        } else if (c == '*') {
+            std::string name = pattern.substr(pos + 1);
+            if (name.find('/') != std::string::npos) {
+                return false;
+            }
+            if (name.empty()) {
+                name = "*";
+            }
+
+            if (!node->wildcard_child) {
+                node->wildcard_child = std::make_unique<Node>();
+                node->wildcard_child->param_name = name;
+            } else if (node->wildcard_child->param_name != name) {
+                return false;
+            }
+
+            node = node->wildcard_child.get();
+            pos = pattern.size();
+        } else {
+            const size_t end = std::min(pattern.find_first_of("{*", pos), pattern.size());
+            std::string text = pattern.substr(pos, end - pos);
+            if (!case_sensitive_) {
+                std::transform(text.begin(), text.end(), text.begin(),
+                               [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+            }
+            node = InsertStatic(node, text);
+            pos = end;
+        }
+    }
+
+    if (node->has_value) {
+        return false;
+    }
+
+    node->has_value = true;
+    node->value = value;
+    ++size_;
+    return true;
+}
+
+HttpRadixTree::Node* HttpRadixTree::InsertStatic(Node* node, std::string_view text) {
+    while (!text.empty()) {
+        const auto index = node->indices.find(text.front());
+        if (index == std::string::npos) {
+            auto child = std::make_unique<Node>();
+            child->prefix = std::string(text);
+            Node* inserted = child.get();
+            node->indices.push_back(text.front());
+            node->static_children.push_back(std::move(child));
+            return inserted;
+        }
+
+        auto& slot = node->static_children[index];
+        const std::string& prefix = slot->prefix;
+        size_t common = 0;
+        while (common < prefix.size() && common < text.size() && prefix[common] == text[common]) {
+            ++common;
+        }
+
+        // 公共前缀短于已有边时拆分该边
+        if (common < prefix.size()) {
+            auto split = std::make_unique<Node>();
+            split->prefix = prefix.substr(0, common);
+
+            auto existing = std::move(slot);
+            existing->prefix.erase(0, common);
+            split->indices.push_back(existing->prefix.front());
+            split->static_children.push_back(std::move(existing));
+            slot = std::move(split);
+        }
+
+        node = slot.get();
+        text.remove_prefix(common);
+    }
+    return node;
+}
+
+bool HttpRadixTree::Find(std::string_view path, size_t& value, PathParams& params) const {
+    params.Clear();
+    return Match(root_.get(), path, value, params);
+}
+
+void HttpRadixTree::Clear() {
+    root_ = std::make_unique<Node>();
+    size_ = 0;
+}
+
+bool HttpRadixTree::Match(const Node* node, std::string_view path, size_t& value, PathParams& params) const {
+    if (path.empty()) {
+        if (node->has_value) {
+            value = node->value;
+            return true;
+        }
+
+        // 通配符允许匹配空的剩余路径
+        if (node->wildcard_child && node->wildcard_child->has_value) {
+            params.Push(node->wildcard_child->param_name, path);
+            value = node->wildcard_child->value;
+            return true;
+        }
+        return false;
+    }
+
+    return MatchChildren(node, path, value, params);
+}
+
+bool HttpRadixTree::MatchChildren(const Node* node, std::string_view path, size_t& value, PathParams& params) const {
+    // 静态子节点：首字符唯一，最多尝试一个
+    for (size_t i = 0; i < node->indices.size(); ++i) {
+        if (!CharsEqual(node->indices[i], path.front())) {
+            continue;
+        }
+
+        const Node* child = node->static_children[i].get();
+        const std::string& prefix = child->prefix;
+        if (path.size() >= prefix.size() &&
+            std::equal(prefix.begin(), prefix.end(), path.begin(),
+                       [this](char a, char b) { return CharsEqual(a, b); }) &&
+            Match(child, path.substr(prefix.size()), value, params)) {
+            return true;
+        }
+        break;
+    }
+
+    // 参数子节点：匹配到下一个'/'为止
+    if (!node->param_children.empty()) {
+        const std::string_view segment = path.substr(0, path.find('/'));
+        if (!segment.empty()) {
+            for (const auto& child : node->param_children) {
+                if (child->constraint && !std::regex_match(segment.begin(), segment.end(), *child->constraint)) {
+                    continue;
+                }
+
+                params.Push(child->param_name, segment);
+                if (Match(child.get(), path.substr(segment.size()), value, params)) {
+                    return true;
+                }
+                params.Pop();
+            }
+        }
+    }
+
+    // 通配符：匹配剩余全部路径
+    if (node->wildcard_child && node->wildcard_child->has_value) {
+        params.Push(node->wildcard_child->param_name, path);
+        value = node->wildcard_child->value;
+        return true;
+    }
+
+    return false;
+}
+
+bool HttpRadixTree::CharsEqual(char stored, char input) const {
+    if (case_sensitive_) {
+        return stored == input;
+    }
+    return stored == static_cast<char>(std::tolower(static_cast<unsigned char>(input)));
+}
+
+} // namespace http
+} // namespace network
+} // namespace common
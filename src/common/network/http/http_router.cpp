@@ -2,7 +2,6 @@
 #include "common/network/network_logger.h"
 #include <algorithm>
 #include <sstream>
-#include <regex>
 
 namespace common {
 namespace network {
@@ -71,7 +70,7 @@ RouteGroup& RouteGroup::Any(const std::string& path, HttpHandler handler, const
     };
     
     for (auto method : methods) {
-        Route(method, path, handler, name + "_" + std::to_string(static_cast<int>(method)));
+        RegisterRoute(method, path, handler, name.empty() ? "" : name + "_" + std::to_string(static_cast<int>(method)));
     }
     
     return *this;
@@ -91,6 +90,10 @@ std::unique_ptr<RouteGroup> RouteGroup::Group(const std::string& prefix) {
 
 HttpRouter::HttpRouter() {
     stats_.created_at = std::chrono::steady_clock::now();
+    
+    for (size_t i = 0; i <= static_cast<size_t>(HttpMethod::CUSTOM); ++i) {
+        trees_.emplace_back(case_sensitive_);
+    }
 }
 
 HttpRouter::~HttpRouter() = default;
@@ -141,7 +144,7 @@ HttpRouter& HttpRouter::Any(const std::string& path, HttpHandler handler, const
     };
     
     for (auto method : methods) {
-        Route(method, path, handler, name + "_" + std::to_string(static_cast<int>(method)));
+        RegisterRoute(method, path, handler, name.empty() ? "" : name + "_" + std::to_string(static_cast<int>(method)));
     }
     
     return *this;
@@ -176,23 +179,24 @@ std::unique_ptr<RouteGroup> HttpRouter::Group(const std::string& prefix) {
 RouteMatch HttpRouter::Match(HttpMethod method, const std::string& path) const {
     RouteMatch result;
     
-    for (size_t i = 0; i < routes_.size(); ++i) {
-        const auto& route = routes_[i];
-        
-        if (route.method != method) {
-            continue;
-        }
-        
-        RouteMatch single_match = MatchSingle(route, path);
-        if (single_match.matched) {
-            result = std::move(single_match);
-            break;
-        }
+    auto query_pos = path.find('?');
+    std::string_view route_path = std::string_view(path).substr(0, query_pos);
+    
+    PathParams params;
+    const Route* route = MatchRoute(method, route_path, params);
+    if (!route) {
+        return result;
+    }
+    
+    result.matched = true;
+    result.matched_pattern = route->pattern;
+    result.matched_path = std::string(route_path);
+    for (size_t i = 0; i < params.Size(); ++i) {
+        result.params.emplace(std::string(params[i].name), std::string(params[i].value));
     }
     
     // 解析查询字符串
-    auto query_pos = path.find('?');
-    if (query_pos != std::string::npos && result.matched) {
+    if (query_pos != std::string::npos) {
         std::string query = path.substr(query_pos + 1);
         result.queries = ParseQueryString(query);
     }
@@ -200,6 +204,40 @@ RouteMatch HttpRouter::Match(HttpMethod method, const std::string& path) const {
     return result;
 }
 
+const Route* HttpRouter::MatchRoute(HttpMethod method, std::string_view path, PathParams& params) const {
+    const size_t method_index = static_cast<size_t>(method);
+    if (method_index >= trees_.size()) {
+        return nullptr;
+    }
+    
+    size_t route_index = 0;
+    if (!trees_[method_index].Find(TrimTrailingSlash(path), route_index, params)) {
+        return nullptr;
+    }
+    return &routes_[route_index];
+}
+
+std::vector<HttpMethod> HttpRouter::FindAllowedMethods(std::string_view path) const {
+    std::vector<HttpMethod> allowed_methods;
+    PathParams params;
+    size_t route_index = 0;
+    
+    for (size_t i = 0; i < trees_.size(); ++i) {
+        if (trees_[i].Size() > 0 && trees_[i].Find(TrimTrailingSlash(path), route_index, params)) {
+            allowed_methods.push_back(static_cast<HttpMethod>(i));
+        }
+    }
+    return allowed_methods;
+}
+
+std::string_view HttpRouter::TrimTrailingSlash(std::string_view path) const {
+    // 非严格模式下 /users/ 与 /users 等价
+    if (!strict_slash_ && path.size() > 1 && path.back() == '/') {
+        path.remove_suffix(1);
+    }
+    return path;
+}
+
 bool HttpRouter::HandleRequest(const HttpRequest& request, HttpResponse& response) {
     {
         std::lock_guard<std::mutex> lock(stats_mutex_);
@@ -208,24 +246,16 @@ bool HttpRouter::HandleRequest(const HttpRequest& request, HttpResponse& respons
     
     try {
         // 匹配路由
-        RouteMatch match = Match(request.GetMethod(), request.GetUrl().path);
-        if (!match.matched) {
-            Handle404(request, response);
-            return false;
-        }
-        
-        // 找到对应的路由
-        const struct Route* matched_route = nullptr;
-        for (const auto& route : routes_) {
-            RouteMatch single_match = MatchSingle(route, request.GetUrl().path);
-            if (single_match.matched && route.method == request.GetMethod()) {
-                matched_route = &route;
-                break;
-            }
-        }
+        PathParams params;
+        const struct Route* matched_route = MatchRoute(request.GetMethod(), request.GetUrl().path, params);
         
         if (!matched_route) {
-            Handle404(request, response);
+            auto allowed_methods = FindAllowedMethods(request.GetUrl().path);
+            if (!allowed_methods.empty()) {
+                Handle405(request, response, allowed_methods);
+            } else {
+                Handle404(request, response);
+            }
             return false;
         }
         
@@ -247,7 +277,7 @@ bool HttpRouter::HandleRequest(const HttpRequest& request, HttpResponse& respons
                           matched_route->middlewares.end());
         
         // 执行中间件链，最后执行路由处理器
-        ExecuteMiddlewares(request, response, middlewares, 0, [matched_route, &request, &response, match]() {
+        ExecuteMiddlewares(request, response, middlewares, 0, [matched_route, &request, &response]() {
             // 将路由参数添加到请求中（这里需要扩展HttpRequest类来支持参数存储）
             // 暂时通过函数调用传递参数
             matched_route->handler(request, response, [](){});
@@ -318,6 +348,9 @@ HttpRouter::RouterStats HttpRouter::GetStats() const {
 
 void HttpRouter::Clear() {
     routes_.clear();
+    for (auto& tree : trees_) {
+        tree.Clear();
+    }
     global_middlewares_.clear();
     path_middlewares_.clear();
     named_routes_.clear();
@@ -329,11 +362,14 @@ void HttpRouter::Clear() {
 
 void HttpRouter::AddRoute(const Route& route, const std::vector<HttpMiddleware>& group_middlewares) {
     Route new_route = route;
+    new_route.param_names = ExtractParamNames(route.pattern);
     
-    // 编译路径模式
-    auto compiled = CompilePattern(route.pattern);
-    new_route.regex = std::move(compiled.first);
-    new_route.param_names = std::move(compiled.second);
+    const size_t method_index = static_cast<size_t>(route.method);
+    if (method_index >= trees_.size() ||
+        !trees_[method_index].Insert(std::string(TrimTrailingSlash(route.pattern)), routes_.size())) {
+        NETWORK_LOG_ERROR("Invalid or duplicate route pattern: {}", route.pattern);
+        return;
+    }
     
     // 添加组中间件
     new_route.middlewares.insert(new_route.middlewares.begin(),
@@ -350,24 +386,6 @@ void HttpRouter::AddRoute(const Route& route, const std::vector<HttpMiddleware>&
     stats_.total_routes++;
 }
 
-RouteMatch HttpRouter::MatchSingle(const Route& route, const std::string& path) const {
-    RouteMatch result;
-    
-    std::smatch match;
-    if (std::regex_match(path, match, route.regex)) {
-        result.matched = true;
-        result.matched_pattern = route.pattern;
-        result.matched_path = path;
-        
-        // 提取参数
-        for (size_t i = 1; i < match.size() && (i - 1) < route.param_names.size(); ++i) {
-            result.params[route.param_names[i - 1]] = match[i].str();
-        }
-    }
-    
-    return result;
-}
-
 std::unordered_map<std::string, std::string> HttpRouter::ParseQueryString(const std::string& query) const {
     std::unordered_map<std::string, std::string> result;
     
@@ -388,55 +406,29 @@ std::unordered_map<std::string, std::string> HttpRouter::ParseQueryString(const
     return result;
 }
 
-std::pair<std::regex, std::vector<std::string>> HttpRouter::CompilePattern(const std::string& pattern) const {
+std::vector<std::string> HttpRouter::ExtractParamNames(const std::string& pattern) const {
     std::vector<std::string> param_names;
-    std::string regex_pattern = PatternToRegex(pattern, param_names);
     
-    std::regex::flag_type flags = std::regex::optimize;
-    if (!case_sensitive_) {
-        flags |= std::regex::icase;
-    }
-    
-    return {std::regex(regex_pattern, flags), std::move(param_names)};
-}
-
-std::string HttpRouter::PatternToRegex(const std::string& pattern, std::vector<std::string>& param_names) const {
-    std::string result = pattern;
-    
-    // 转义特殊字符
-    std::regex special_chars(R"([\.^$|()[\]{}*+?\\])");
-    result = std::regex_replace(result, special_chars, R"(\$&)");
-    
-    // 处理参数占位符 {param}
-    std::regex param_regex(R"(\\\{([^}]+)\\\})");
-    std::sregex_iterator iter(result.begin(), result.end(), param_regex);
-    std::sregex_iterator end;
-    
-    size_t offset = 0;
-    for (; iter != end; ++iter) {
-        const std::smatch& match = *iter;
-        param_names.push_back(match[1].str());
+    size_t pos = 0;
+    while ((pos = pattern.find('{', pos)) != std::string::npos) {
+        auto end = pattern.find_first_of(":}", pos);
+        if (end == std::string::npos) {
+            break;
+        }
+        param_names.push_back(pattern.substr(pos + 1, end - pos - 1));
         
-        size_t pos = match.position() + offset;
-        size_t len = match.length();
-        result.replace(pos, len, "([^/]+)");
-        offset += 7 - len; // "([^/]+)" 有7个字符
-    }
-    
-    // 处理通配符 *
-    std::regex wildcard_regex(R"(\\\*)");
-    result = std::regex_replace(result, wildcard_regex, "(.*)");
-    
-    // 严格斜杠匹配
-    if (!strict_slash_) {
-        if (result.back() == '/') {
-            result += "?";
-        } else {
-            result += "/?";
+        // 跳过约束正则中可能出现的花括号
+        int depth = 1;
+        for (pos = pos + 1; pos < pattern.size() && depth > 0; ++pos) {
+            if (pattern[pos] == '{') {
+                ++depth;
+            } else if (pattern[pos] == '}') {
+                --depth;
+            }
         }
     }
     
-    return "^" + result + "$";
+    return param_names;
 }
 
 void HttpRouter::ExecuteMiddlewares(const HttpRequest& request, HttpResponse& response, 
@@ -541,42 +533,43 @@ std::string PathMatcher::GetFileExtension(const std::string& path) {
 }
 
 std::string PathMatcher::NormalizePath(const std::string& path) {
-    if (path.empty()) {
-        return "/";
-    }
-    
-    std::string result = path;
-    
-    // 确保以/开头
-    if (result.front() != '/') {
-        result = "/" + result;
-    }
-    
-    // 移除重复的斜杠
-    std::regex multiple_slash(R"(/+)");
-    result = std::regex_replace(result, multiple_slash, "/");
-    
-    // 处理 . 和 ..
-    std::vector<std::string> segments = SplitPath(result);
-    std::vector<std::string> normalized_segments;
+    // 单次扫描：合并重复斜杠并处理 . 和 ..
+    std::string result;
+    result.reserve(path.size() + 1);
     
-    for (const auto& segment : segments) {
-        if (segment == "." || segment.empty()) {
+    size_t pos = 0;
+    while (pos < path.size()) {
+        while (pos < path.size() && path[pos] == '/') {
+            ++pos;
+        }
+        
+        size_t end = path.find('/', pos);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        
+        std::string_view segment(path.data() + pos, end - pos);
+        pos = end;
+        
+        if (segment.empty() || segment == ".") {
             continue;
-        } else if (segment == "..") {
-            if (!normalized_segments.empty()) {
-                normalized_segments.pop_back();
-            }
-        } else {
-            normalized_segments.push_back(segment);
         }
+        
+        if (segment == "..") {
+            auto last_slash = result.find_last_of('/');
+            result.resize(last_slash == std::string::npos ? 0 : last_slash);
+            continue;
+        }
+        
+        result += '/';
+        result.append(segment.data(), segment.size());
     }
     
-    if (normalized_segments.empty()) {
+    if (result.empty()) {
         return "/";
     }
     
-    return "/" + JoinPaths(normalized_segments);
+    return result;
 }
 
 std::string PathMatcher::JoinPaths(const std::vector<std::string>& segments) {
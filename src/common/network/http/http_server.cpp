@@ -1,24 +1,165 @@
 #include "common/network/http/http_server.h"
 #include "common/network/http/http_router.h"
+#include "common/network/http/http_middleware.h"
 #include <boost/beast/http.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/version.hpp>
+#include <boost/beast/websocket/rfc6455.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ssl.hpp>
 #include <boost/asio/bind_executor.hpp>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <thread>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <cerrno>
+#endif
 
 namespace common {
 namespace network {
 namespace http {
 
+namespace {
+// 文件响应每次读取或sendfile的最大字节数
+constexpr size_t kFileChunkSize = 64 * 1024;
+constexpr size_t kSendfileChunkSize = 1024 * 1024;
+
+// 流式请求体每次读取的最大字节数
+constexpr size_t kStreamReadChunkSize = 64 * 1024;
+
+// HTTP/2客户端连接前言（RFC 7540 3.5）
+constexpr std::string_view kHttp2Preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+#ifdef ZEUS_HTTP_HAS_NGHTTP2
+// ALPN协议选择：启用HTTP/2时优先h2，否则只接受http/1.1
+int SelectAlpnProtocol(SSL*, const unsigned char** out, unsigned char* outlen,
+                       const unsigned char* in, unsigned int inlen, void* arg) {
+    const bool enable_http2 = *static_cast<const bool*>(arg);
+    const unsigned char* http11 = nullptr;
+    for (unsigned int i = 0; i < inlen;) {
+        const unsigned char length = in[i];
+        if (i + 1 + length > inlen) {
+            break;
+        }
+        const std::string_view protocol(reinterpret_cast<const char*>(in + i + 1), length);
+        if (enable_http2 && protocol == "h2") {
+            *out = in + i + 1;
+            *outlen = length;
+            return SSL_TLSEXT_ERR_OK;
+        }
+        if (protocol == "http/1.1" && !http11) {
+            http11 = in + i + 1;
+        }
+        i += 1 + length;
+    }
+    
+    if (http11) {
+        *out = http11;
+        *outlen = 8;
+        return SSL_TLSEXT_ERR_OK;
+    }
+    return SSL_TLSEXT_ERR_NOACK;
+}
+#endif
+
+constexpr char kContinueResponse[] = "HTTP/1.1 100 Continue\r\n\r\n";
+
+// PipeJson在写出前累积的数据量
+constexpr size_t kJsonChunkSize = 16 * 1024;
+}
+
+// ===== HttpServerStream Implementation =====
+
+HttpServerStream::HttpServerStream(std::shared_ptr<HttpServerSession> session)
+    : session_(std::move(session)) {
+}
+
+const HttpRequest& HttpServerStream::GetRequest() const {
+    return session_->current_request_;
+}
+
+HttpResponse& HttpServerStream::GetResponse() {
+    return session_->current_response_;
+}
+
+void HttpServerStream::Read(ReadHandler handler) {
+    session_->StreamRead(std::move(handler));
+}
+
+void HttpServerStream::Write(std::string chunk, WriteHandler handler) {
+    session_->StreamWrite(std::move(chunk), std::move(handler), false);
+}
+
+void HttpServerStream::End(WriteHandler handler) {
+    session_->StreamWrite(std::string(), std::move(handler), true);
+}
+
+void HttpServerStream::ReadMultipart(std::shared_ptr<HttpMultipartParser> parser, CompleteHandler handler) {
+    auto self = shared_from_this();
+    Read([self, parser = std::move(parser), handler = std::move(handler)](boost::system::error_code ec, std::string_view chunk) mutable {
+        if (!ec && chunk.empty() && !parser->Finish()) {
+            ec = parser->GetErrorCode();
+        } else if (!ec && !chunk.empty()) {
+            if (parser->Feed(chunk)) {
+                self->ReadMultipart(std::move(parser), std::move(handler));
+                return;
+            }
+            ec = parser->GetErrorCode();
+        }
+        
+        if (ec && ec != boost::asio::error::operation_aborted) {
+            NETWORK_LOG_DEBUG("Multipart request body failed: {} ({})", ec.message(),
+                              HttpMultipartParser::ErrorToString(parser->GetError()));
+        }
+        if (handler) {
+            handler(ec);
+        }
+    });
+}
+
+void HttpServerStream::Pipe(ChunkSource source, WriteHandler handler) {
+    std::string chunk;
+    if (!source(chunk)) {
+        End(std::move(handler));
+        return;
+    }
+    
+    auto self = shared_from_this();
+    Write(std::move(chunk), [self, source = std::move(source), handler = std::move(handler)](boost::system::error_code ec) mutable {
+        if (ec) {
+            if (handler) {
+                handler(ec);
+            }
+            return;
+        }
+        self->Pipe(std::move(source), std::move(handler));
+    });
+}
+
+void HttpServerStream::PipeJson(JsonSource source, WriteHandler handler) {
+    if (GetResponse().GetContentType().empty()) {
+        GetResponse().SetContentType("application/json");
+    }
+    
+    auto writer = std::make_shared<HttpJsonWriter>();
+    auto more = std::make_shared<bool>(true);
+    Pipe([source = std::move(source), writer, more](std::string& chunk) {
+        while (*more && writer->GetSize() < kJsonChunkSize) {
+            *more = source(*writer);
+        }
+        chunk = writer->Take();
+        return !chunk.empty();
+    }, std::move(handler));
+}
+
 // ===== HttpServerSession Implementation =====
 
 HttpServerSession::HttpServerSession(boost::asio::ip::tcp::socket socket, HttpServer& server)
-    : server_(server), session_start_time_(std::chrono::steady_clock::now()) {
+    : strand_(boost::asio::make_strand(socket.get_executor())),
+      server_(server), session_start_time_(std::chrono::steady_clock::now()) {
     socket_ = std::make_unique<boost::asio::ip::tcp::socket>(std::move(socket));
     session_id_ = GenerateSessionId();
     last_activity_ = std::chrono::steady_clock::now();
@@ -27,7 +168,8 @@ HttpServerSession::HttpServerSession(boost::asio::ip::tcp::socket socket, HttpSe
 }
 
 HttpServerSession::HttpServerSession(boost::asio::ssl::stream<boost::asio::ip::tcp::socket> stream, HttpServer& server)
-    : server_(server), session_start_time_(std::chrono::steady_clock::now()) {
+    : strand_(boost::asio::make_strand(stream.get_executor())),
+      server_(server), session_start_time_(std::chrono::steady_clock::now()) {
     ssl_stream_ = std::make_unique<boost::asio::ssl::stream<boost::asio::ip::tcp::socket>>(std::move(stream));
     session_id_ = GenerateSessionId();
     last_activity_ = std::chrono::steady_clock::now();
@@ -41,6 +183,13 @@ HttpServerSession::~HttpServerSession() {
 }
 
 void HttpServerSession::Start() {
+    boost::system::error_code endpoint_ec;
+    auto endpoint = ssl_stream_ ? ssl_stream_->lowest_layer().remote_endpoint(endpoint_ec)
+                                : socket_->remote_endpoint(endpoint_ec);
+    if (!endpoint_ec) {
+        remote_address_ = endpoint.address().to_string();
+    }
+    
     if (ssl_stream_) {
         // SSL握手
         auto self = shared_from_this();
@@ -49,6 +198,9 @@ void HttpServerSession::Start() {
             [self](boost::system::error_code ec) {
                 self->OnSSLHandshake(ec);
             });
+    } else if (server_.GetConfig().enable_http2) {
+        // 明文连接先识别是否为h2c
+        DetectProtocol();
     } else {
         // 直接开始读取
         DoRead();
@@ -60,6 +212,16 @@ void HttpServerSession::Close() {
         return;
     }
     
+#ifdef ZEUS_HTTP_HAS_NGHTTP2
+    if (auto http2_session = http2_session_.lock()) {
+        http2_session->Close();
+    }
+#endif
+    
+    if (auto websocket = websocket_.lock()) {
+        websocket->Close();
+    }
+    
     // 关闭SSL流或常规socket
     if (ssl_stream_) {
         boost::system::error_code ec;
@@ -111,43 +273,117 @@ void HttpServerSession::OnSSLHandshake(boost::system::error_code ec) {
     }
     
     NETWORK_LOG_DEBUG("SSL handshake completed for session: {}", session_id_);
+    
+#ifdef ZEUS_HTTP_HAS_NGHTTP2
+    const unsigned char* protocol = nullptr;
+    unsigned int protocol_length = 0;
+    SSL_get0_alpn_selected(ssl_stream_->native_handle(), &protocol, &protocol_length);
+    if (std::string_view(reinterpret_cast<const char*>(protocol), protocol_length) == "h2") {
+        UpgradeToHttp2();
+        return;
+    }
+#endif
+    
     DoRead();
 }
 
+void HttpServerSession::DetectProtocol() {
+    if (closed_) {
+        return;
+    }
+    
+    auto self = shared_from_this();
+    auto buffers = buffer_.prepare(kHttp2Preface.size() - buffer_.size());
+    socket_->async_read_some(buffers, boost::asio::bind_executor(strand_,
+        [self](boost::system::error_code ec, std::size_t bytes_transferred) {
+            self->OnDetectProtocol(ec, bytes_transferred);
+        }));
+}
+
+void HttpServerSession::OnDetectProtocol(boost::system::error_code ec, std::size_t bytes_transferred) {
+    if (ec) {
+        if (ec == boost::asio::error::eof) {
+            DoClose();
+        } else {
+            HandleError(ec, "read");
+        }
+        return;
+    }
+    
+    buffer_.commit(bytes_transferred);
+    const auto data = buffer_.cdata();
+    const std::string_view received(static_cast<const char*>(data.data()), data.size());
+    
+    // 已读数据与前言不符时按HTTP/1.x处理，解析器直接使用已缓冲的数据
+    if (kHttp2Preface.substr(0, received.size()) != received) {
+        DoRead();
+        return;
+    }
+    
+    if (received.size() < kHttp2Preface.size()) {
+        DetectProtocol();
+        return;
+    }
+    
+    UpgradeToHttp2();
+}
+
+void HttpServerSession::UpgradeToHttp2() {
+#ifdef ZEUS_HTTP_HAS_NGHTTP2
+    auto data = buffer_.cdata();
+    auto session = std::make_shared<Http2ServerSession>(std::move(socket_), std::move(ssl_stream_), server_);
+    http2_session_ = session;
+    session->Start(std::string_view(static_cast<const char*>(data.data()), data.size()));
+    buffer_.consume(buffer_.size());
+    
+    NETWORK_LOG_DEBUG("HTTP session {} switched to HTTP/2", session_id_);
+#else
+    DoRead();
+#endif
+}
+
 void HttpServerSession::DoRead() {
     if (closed_) {
         return;
     }
     
-    // 设置超时
-    beast_request_ = {};
+    // 上一个请求的响应已写完，释放其临时内存（先丢弃请求中解析到竞技场的视图）
+    current_request_.SetArena(nullptr);
+    request_arena_.Reset();
+    
+    // 先读取请求头，根据路由决定请求体整体读取还是流式读取；读取请求头时使用两者中较大的上限
+    const auto& config = server_.GetConfig();
+    parser_.emplace();
+    parser_->header_limit(static_cast<std::uint32_t>(config.max_header_size));
+    parser_->body_limit(std::max<uint64_t>(config.max_request_size, config.max_stream_request_size));
     
     auto self = shared_from_this();
+    auto on_header = boost::asio::bind_executor(strand_,
+        [self](boost::system::error_code ec, std::size_t bytes_transferred) {
+            self->OnReadHeader(ec, bytes_transferred);
+        });
     
     if (ssl_stream_) {
         // SSL流读取
-        boost::beast::http::async_read(
-            *ssl_stream_, buffer_, beast_request_,
-            [self](boost::system::error_code ec, std::size_t bytes_transferred) {
-                self->OnRead(ec, bytes_transferred);
-            });
+        boost::beast::http::async_read_header(*ssl_stream_, buffer_, *parser_, std::move(on_header));
     } else {
         // 普通Socket读取
-        boost::beast::http::async_read(
-            *socket_, buffer_, beast_request_,
-            [self](boost::system::error_code ec, std::size_t bytes_transferred) {
-                self->OnRead(ec, bytes_transferred);
-            });
+        boost::beast::http::async_read_header(*socket_, buffer_, *parser_, std::move(on_header));
     }
 }
 
-void HttpServerSession::OnRead(boost::system::error_code ec, std::size_t bytes_transferred) {
+void HttpServerSession::OnReadHeader(boost::system::error_code ec, std::size_t bytes_transferred) {
     if (ec == boost::beast::http::error::end_of_stream) {
         // 客户端关闭连接
         DoClose();
         return;
     }
     
+    if (ec == boost::beast::http::error::body_limit) {
+        SendPayloadTooLarge();
+        return;
+    }
+    
     if (ec) {
         HandleError(ec, "read");
         return;
@@ -156,51 +392,82 @@ void HttpServerSession::OnRead(boost::system::error_code ec, std::size_t bytes_t
     bytes_received_ += bytes_transferred;
     last_activity_ = std::chrono::steady_clock::now();
     
-    // 检查请求大小限制
-    if (bytes_received_ > server_.GetConfig().max_request_size) {
-        // 请求过大
-        current_response_.SetStatusCode(HttpStatusCode::PAYLOAD_TOO_LARGE);
-        current_response_.SetBody("Request too large");
-        SendResponse();
+    const auto& header = parser_->get();
+    boost::beast::string_view target = header.target();
+    const std::string_view path(target.data(), std::min(target.find('?'), target.size()));
+    if (boost::beast::websocket::is_upgrade(header) && server_.IsWebSocketRoute(path)) {
+        StartWebSocket();
         return;
     }
+    if (server_.IsStreamRoute(HttpUtils::BeastMethodToEnum(header.method()), path)) {
+        StartStream();
+        return;
+    }
+    
+    // 声明的请求体长度超过限制时不再读取请求体
+    const size_t max_request_size = server_.GetConfig().max_request_size;
+    const auto content_length = parser_->content_length();
+    if (content_length && *content_length > max_request_size) {
+        SendPayloadTooLarge();
+        return;
+    }
+    parser_->body_limit(max_request_size);
+    
+    auto self = shared_from_this();
+    auto on_read = boost::asio::bind_executor(strand_,
+        [self](boost::system::error_code ec, std::size_t bytes_transferred) {
+            self->OnRead(ec, bytes_transferred);
+        });
+    
+    if (ssl_stream_) {
+        boost::beast::http::async_read(*ssl_stream_, buffer_, *parser_, std::move(on_read));
+    } else {
+        boost::beast::http::async_read(*socket_, buffer_, *parser_, std::move(on_read));
+    }
+}
+
+void HttpServerSession::OnRead(boost::system::error_code ec, std::size_t bytes_transferred) {
+    if (ec == boost::beast::http::error::body_limit) {
+        SendPayloadTooLarge();
+        return;
+    }
+    
+    if (ec) {
+        HandleError(ec, "read");
+        return;
+    }
+    
+    bytes_received_ += bytes_transferred;
+    last_activity_ = std::chrono::steady_clock::now();
     
+    beast_request_ = parser_->release();
+    parser_.reset();
     ProcessRequest();
 }
 
+void HttpServerSession::SendPayloadTooLarge() {
+    // 剩余请求体不再读取，响应后关闭连接
+    beast_request_ = {};
+    beast_request_.version(parser_->get().version());
+    parser_.reset();
+    keep_alive_ = false;
+    current_request_ = HttpRequest();
+    current_response_ = HttpResponse(HttpStatusCode::PAYLOAD_TOO_LARGE);
+    current_response_.SetHeader("Server", server_.GenerateServerHeader());
+    current_response_.SetBody("Request too large");
+    SendResponse();
+}
+
 void HttpServerSession::ProcessRequest() {
     try {
-        // 转换Beast请求到HttpRequest
-        current_request_ = HttpRequest();
-        
-        // 设置方法
-        auto method_str = std::string(beast_request_.method_string());
-        if (method_str == "GET") current_request_.SetMethod(HttpMethod::GET);
-        else if (method_str == "POST") current_request_.SetMethod(HttpMethod::POST);
-        else if (method_str == "PUT") current_request_.SetMethod(HttpMethod::PUT);
-        else if (method_str == "DELETE") current_request_.SetMethod(HttpMethod::DELETE);
-        else if (method_str == "PATCH") current_request_.SetMethod(HttpMethod::PATCH);
-        else if (method_str == "HEAD") current_request_.SetMethod(HttpMethod::HEAD);
-        else if (method_str == "OPTIONS") current_request_.SetMethod(HttpMethod::OPTIONS);
-        else current_request_.SetMethod(HttpMethod::CUSTOM);
-        
-        // 设置URL
-        std::string target = std::string(beast_request_.target());
-        current_request_.SetUrl(target);
-        
-        // 设置头部
-        for (const auto& field : beast_request_) {
-            std::string name(field.name_string());
-            std::string value(field.value());
-            current_request_.SetHeader(name, value);
-        }
-        
-        // 设置请求体
-        current_request_.SetBody(beast_request_.body());
-        
-        // 检查Keep-Alive
+        // 检查Keep-Alive（依赖Connection头，需在转移头部之前读取）
         keep_alive_ = beast_request_.keep_alive();
         
+        // 转换Beast请求到HttpRequest，头部和请求体直接转移，不复制
+        current_request_ = HttpRequest::FromBeastRequest(std::move(beast_request_));
+        current_request_.SetRemoteAddress(remote_address_);
+        current_request_.SetArena(request_arena_.Resource());
+        
         // 初始化响应
         current_response_ = HttpResponse();
         current_response_.SetStatusCode(HttpStatusCode::OK);
@@ -211,9 +478,8 @@ void HttpServerSession::ProcessRequest() {
         
         // 处理请求
         auto start_time = std::chrono::steady_clock::now();
-        bool handled = server_.ProcessRequest(current_request_, current_response_);
-        auto end_time = std::chrono::steady_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+        size_t metrics_route = HttpServerMetrics::kUnmatchedRoute;
+        bool handled = server_.ProcessRequest(current_request_, current_response_, metrics_route);
         
         if (!handled) {
             current_response_.SetStatusCode(HttpStatusCode::NOT_FOUND);
@@ -221,7 +487,8 @@ void HttpServerSession::ProcessRequest() {
         }
         
         // 更新统计
-        server_.UpdateStats(handled, duration, bytes_received_, current_response_.GetBody().size());
+        server_.UpdateStats(metrics_route, current_response_.GetStatusCode(), std::chrono::steady_clock::now() - start_time,
+                            current_request_.GetBody().size(), current_response_.GetContentLength());
         requests_processed_++;
         
         SendResponse();
@@ -243,21 +510,27 @@ void HttpServerSession::SendResponse() {
         current_response_.SetHeader("Connection", "close");
     }
     
+    if (current_response_.HasFileRange()) {
+        SendFileResponse();
+        return;
+    }
+    
     // 转换HttpResponse到Beast响应
     beast_response_ = {};
     beast_response_.version(beast_request_.version());
-    beast_response_.result(static_cast<boost::beast::http::status>(static_cast<int>(current_response_.GetStatusCode())));
-    beast_response_.keep_alive(keep_alive_);
     
-    // 设置头部
-    for (const auto& header : current_response_.GetHeaders()) {
-        beast_response_.set(header.first, header.second);
+    // 状态、头部和响应体转移到Beast响应，HEAD响应只发送头部并保留实体长度
+    const bool head_only = current_request_.GetMethod() == HttpMethod::HEAD;
+    const size_t content_length = current_response_.GetContentLength();
+    current_response_.MoveToBeastResponse(beast_response_);
+    beast_response_.keep_alive(keep_alive_);
+    if (head_only) {
+        beast_response_.body().clear();
+        beast_response_.content_length(content_length);
+    } else {
+        beast_response_.prepare_payload();
     }
     
-    // 设置响应体
-    beast_response_.body() = current_response_.GetBody();
-    beast_response_.prepare_payload();
-    
     auto self = shared_from_this();
     
     if (ssl_stream_) {
@@ -299,6 +572,568 @@ void HttpServerSession::DoClose() {
     Close();
 }
 
+void HttpServerSession::SendFileResponse() {
+    const HttpFileRange& range = *current_response_.GetFileRange();
+    
+    boost::beast::error_code ec;
+    file_.open(range.path.c_str(), boost::beast::file_mode::scan, ec);
+    if (!ec && range.offset > 0) {
+        file_.seek(range.offset, ec);
+    }
+    if (ec) {
+        NETWORK_LOG_ERROR("Failed to open file {} in session {}: {}", range.path, session_id_, ec.message());
+        if (file_.is_open()) {
+            file_.close(ec);
+        }
+        current_response_ = HttpResponse::InternalServerError();
+        current_response_.SetHeader("Server", server_.GenerateServerHeader());
+        SendResponse();
+        return;
+    }
+    
+    file_offset_ = range.offset;
+    file_remaining_ = current_request_.GetMethod() == HttpMethod::HEAD ? 0 : range.length;
+    
+    // 头部单独序列化，Content-Length为文件区间长度
+    file_response_ = {};
+    file_response_.version(beast_request_.version());
+    file_response_.result(static_cast<boost::beast::http::status>(static_cast<int>(current_response_.GetStatusCode())));
+    current_response_.MoveHeadersTo(file_response_);
+    file_response_.keep_alive(keep_alive_);
+    file_response_.content_length(range.length);
+    file_serializer_ = std::make_unique<boost::beast::http::response_serializer<boost::beast::http::empty_body>>(file_response_);
+    
+    auto self = shared_from_this();
+    auto on_header = [self](boost::system::error_code ec, std::size_t bytes_transferred) {
+        self->OnFileHeaderWritten(ec, bytes_transferred);
+    };
+    
+    if (ssl_stream_) {
+        boost::beast::http::async_write_header(*ssl_stream_, *file_serializer_, std::move(on_header));
+    } else {
+        boost::beast::http::async_write_header(*socket_, *file_serializer_, std::move(on_header));
+    }
+}
+
+void HttpServerSession::OnFileHeaderWritten(boost::system::error_code ec, std::size_t bytes_transferred) {
+    if (ec) {
+        FinishFileResponse();
+        HandleError(ec, "write");
+        return;
+    }
+    
+    bytes_sent_ += bytes_transferred;
+    WriteFileBody();
+}
+
+void HttpServerSession::WriteFileBody() {
+    if (file_remaining_ == 0) {
+        FinishFileResponse();
+        OnWrite({}, 0, !keep_alive_);
+        return;
+    }
+    
+#ifdef __linux__
+    // 明文连接由内核直接从页缓存发送，TLS连接需要在用户态加密
+    if (!ssl_stream_) {
+        SendFileZeroCopy();
+        return;
+    }
+#endif
+    
+    const size_t chunk_size = static_cast<size_t>(std::min<uint64_t>(file_remaining_, kFileChunkSize));
+    file_chunk_.resize(kFileChunkSize);
+    
+    boost::beast::error_code ec;
+    const size_t bytes_read = file_.read(file_chunk_.data(), chunk_size, ec);
+    if (ec || bytes_read == 0) {
+        NETWORK_LOG_ERROR("Failed to read file in session {}: {}", session_id_,
+                          ec ? ec.message() : std::string("unexpected end of file"));
+        FinishFileResponse();
+        DoClose();
+        return;
+    }
+    
+    auto self = shared_from_this();
+    auto on_chunk = [self](boost::system::error_code ec, std::size_t bytes_transferred) {
+        self->OnFileChunkWritten(ec, bytes_transferred);
+    };
+    
+    if (ssl_stream_) {
+        boost::asio::async_write(*ssl_stream_, boost::asio::buffer(file_chunk_.data(), bytes_read), std::move(on_chunk));
+    } else {
+        boost::asio::async_write(*socket_, boost::asio::buffer(file_chunk_.data(), bytes_read), std::move(on_chunk));
+    }
+}
+
+void HttpServerSession::OnFileChunkWritten(boost::system::error_code ec, std::size_t bytes_transferred) {
+    if (ec) {
+        FinishFileResponse();
+        HandleError(ec, "write");
+        return;
+    }
+    
+    bytes_sent_ += bytes_transferred;
+    file_offset_ += bytes_transferred;
+    file_remaining_ -= bytes_transferred;
+    last_activity_ = std::chrono::steady_clock::now();
+    WriteFileBody();
+}
+
+#ifdef __linux__
+void HttpServerSession::SendFileZeroCopy() {
+    boost::system::error_code ec;
+    if (!socket_->native_non_blocking()) {
+        socket_->native_non_blocking(true, ec);
+        if (ec) {
+            FinishFileResponse();
+            HandleError(ec, "sendfile");
+            return;
+        }
+    }
+    
+    off_t offset = static_cast<off_t>(file_offset_);
+    const size_t count = static_cast<size_t>(std::min<uint64_t>(file_remaining_, kSendfileChunkSize));
+    const ssize_t sent = ::sendfile(socket_->native_handle(), file_.native_handle(), &offset, count);
+    
+    auto self = shared_from_this();
+    
+    if (sent > 0) {
+        bytes_sent_ += static_cast<size_t>(sent);
+        file_offset_ = static_cast<uint64_t>(offset);
+        file_remaining_ -= static_cast<uint64_t>(sent);
+        last_activity_ = std::chrono::steady_clock::now();
+        
+        // 每发送一块让出执行器，避免大文件独占线程
+        boost::asio::post(socket_->get_executor(), [self]() { self->WriteFileBody(); });
+        return;
+    }
+    
+    if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        socket_->async_wait(boost::asio::ip::tcp::socket::wait_write,
+            [self](boost::system::error_code ec) {
+                if (ec) {
+                    self->FinishFileResponse();
+                    self->HandleError(ec, "sendfile");
+                    return;
+                }
+                self->WriteFileBody();
+            });
+        return;
+    }
+    
+    // sent为0表示文件在发送过程中被截断
+    ec = sent < 0 ? boost::system::error_code(errno, boost::system::system_category())
+                  : boost::system::error_code(boost::asio::error::eof);
+    FinishFileResponse();
+    HandleError(ec, "sendfile");
+}
+#endif
+
+void HttpServerSession::FinishFileResponse() {
+    boost::beast::error_code ec;
+    if (file_.is_open()) {
+        file_.close(ec);
+    }
+    file_serializer_.reset();
+    file_remaining_ = 0;
+}
+
+void HttpServerSession::StartStream() {
+    // 解析器转换为buffer_body，请求体由处理器按块读取
+    stream_parser_.emplace(std::move(*parser_));
+    parser_.reset();
+    stream_parser_->body_limit(server_.GetConfig().max_stream_request_size);
+    
+    const auto& header = stream_parser_->get();
+    keep_alive_ = header.keep_alive();
+    beast_request_ = {};
+    beast_request_.version(header.version());
+    
+    current_request_ = HttpRequest::FromBeastHeader(header);
+    current_request_.SetRemoteAddress(remote_address_);
+    current_request_.SetArena(request_arena_.Resource());
+    current_response_ = HttpResponse();
+    current_response_.SetStatusCode(HttpStatusCode::OK);
+    current_response_.SetHeader("Server", server_.GenerateServerHeader());
+    
+    stream_active_ = true;
+    stream_reading_ = false;
+    stream_writing_ = false;
+    stream_header_sent_ = false;
+    stream_chunked_ = false;
+    stream_ended_ = false;
+    stream_expect_continue_ = boost::beast::iequals(header[boost::beast::http::field::expect], "100-continue");
+    stream_bytes_sent_ = 0;
+    stream_body_bytes_sent_ = 0;
+    stream_bytes_received_ = 0;
+    stream_start_time_ = std::chrono::steady_clock::now();
+    stream_read_buffer_.resize(kStreamReadChunkSize);
+    
+    LogRequest();
+    
+    HttpStreamHandler handler = server_.ProcessStreamRequest(current_request_, current_response_, stream_metrics_route_);
+    if (!handler) {
+        // 中间件已给出完整响应，未读取的请求体无法跳过，响应后关闭连接
+        server_.UpdateStats(stream_metrics_route_, current_response_.GetStatusCode(),
+                            std::chrono::steady_clock::now() - stream_start_time_, 0, current_response_.GetContentLength());
+        stream_active_ = false;
+        if (!stream_parser_->is_done()) {
+            keep_alive_ = false;
+        }
+        stream_parser_.reset();
+        SendResponse();
+        return;
+    }
+    
+    try {
+        handler(std::make_shared<HttpServerStream>(shared_from_this()));
+    } catch (const std::exception& e) {
+        NETWORK_LOG_ERROR("Error in stream handler in session {}: {}", session_id_, e.what());
+        if (!stream_header_sent_ && stream_writes_.empty()) {
+            stream_active_ = false;
+            stream_parser_.reset();
+            keep_alive_ = false;
+            current_response_ = HttpResponse::InternalServerError();
+            server_.UpdateStats(stream_metrics_route_, current_response_.GetStatusCode(),
+                                std::chrono::steady_clock::now() - stream_start_time_,
+                                stream_bytes_received_, current_response_.GetContentLength());
+            SendResponse();
+        } else {
+            FinishStream(boost::asio::error::operation_aborted);
+        }
+    }
+}
+
+void HttpServerSession::StartWebSocket() {
+    // 升级请求没有请求体，请求头读取后即可完整取出
+    auto upgrade = parser_->release();
+    parser_.reset();
+    keep_alive_ = upgrade.keep_alive();
+    beast_request_ = {};
+    beast_request_.version(upgrade.version());
+    
+    current_request_ = HttpRequest::FromBeastHeader(upgrade);
+    current_request_.SetRemoteAddress(remote_address_);
+    current_request_.SetArena(request_arena_.Resource());
+    current_response_ = HttpResponse();
+    current_response_.SetStatusCode(HttpStatusCode::OK);
+    current_response_.SetHeader("Server", server_.GenerateServerHeader());
+    
+    LogRequest();
+    
+    // 升级请求按握手前的处理耗时记录，状态为101
+    const auto start_time = std::chrono::steady_clock::now();
+    size_t metrics_route = HttpServerMetrics::kUnmatchedRoute;
+    HttpWebSocketHandler handler = server_.ProcessWebSocketRequest(current_request_, current_response_, metrics_route);
+    if (!handler) {
+        // 中间件已给出完整响应（如鉴权失败），不升级
+        server_.UpdateStats(metrics_route, current_response_.GetStatusCode(), std::chrono::steady_clock::now() - start_time,
+                            0, current_response_.GetContentLength());
+        SendResponse();
+        return;
+    }
+    server_.UpdateStats(metrics_route, HttpStatusCode::SWITCHING_PROTOCOLS, std::chrono::steady_clock::now() - start_time, 0, 0);
+    
+    const auto& config = server_.GetConfig();
+    WebSocketOptions options;
+    options.permessage_deflate = config.websocket_permessage_deflate;
+    options.deflate_level = config.websocket_deflate_level;
+    options.max_message_size = config.websocket_max_message_size;
+    options.server_name = server_.GenerateServerHeader();
+    
+    // 连接移交后本会话不再读写套接字，Close时转为关闭WebSocket连接
+    const std::string connection_id = "ws_" + session_id_;
+    std::shared_ptr<WebSocketConnection> connection;
+    if (ssl_stream_) {
+        connection = std::make_shared<WebSocketConnection>(std::move(*ssl_stream_), connection_id, options);
+        ssl_stream_.reset();
+    } else {
+        connection = std::make_shared<WebSocketConnection>(std::move(*socket_), connection_id, options);
+        socket_.reset();
+    }
+    websocket_ = connection;
+    if (config.websocket_heartbeat_interval_ms > 0) {
+        connection->SetHeartbeat(true, config.websocket_heartbeat_interval_ms);
+    }
+    
+    // 请求对象在握手完成后交给处理器，副本不引用本会话的请求级内存
+    HttpRequest request = current_request_;
+    current_request_ = HttpRequest();
+    
+    connection->AsyncAccept(std::move(upgrade),
+        [connection, handler = std::move(handler), request = std::move(request)](boost::system::error_code ec) {
+            if (!ec) {
+                handler(connection, request);
+            }
+        });
+    
+    NETWORK_LOG_DEBUG("HTTP session {} switched to WebSocket", session_id_);
+}
+
+void HttpServerSession::StreamRead(HttpServerStream::ReadHandler handler) {
+    auto self = shared_from_this();
+    boost::asio::post(strand_, [self, handler = std::move(handler)]() mutable {
+        if (self->closed_ || !self->stream_active_ || !self->stream_parser_) {
+            handler(boost::asio::error::operation_aborted, {});
+            return;
+        }
+        if (self->stream_reading_) {
+            handler(boost::asio::error::in_progress, {});
+            return;
+        }
+        if (self->stream_parser_->is_done()) {
+            handler({}, {});
+            return;
+        }
+        
+        self->stream_reading_ = true;
+        if (!self->stream_expect_continue_) {
+            self->DoStreamRead(std::move(handler));
+            return;
+        }
+        
+        // 客户端等待100 Continue后才发送请求体
+        self->stream_expect_continue_ = false;
+        auto on_continue = boost::asio::bind_executor(self->strand_,
+            [self, handler = std::move(handler)](boost::system::error_code ec, std::size_t) mutable {
+                if (ec) {
+                    self->stream_reading_ = false;
+                    handler(ec, {});
+                    self->FinishStream(ec);
+                    return;
+                }
+                self->DoStreamRead(std::move(handler));
+            });
+        auto buffer = boost::asio::buffer(kContinueResponse, sizeof(kContinueResponse) - 1);
+        if (self->ssl_stream_) {
+            boost::asio::async_write(*self->ssl_stream_, buffer, std::move(on_continue));
+        } else {
+            boost::asio::async_write(*self->socket_, buffer, std::move(on_continue));
+        }
+    });
+}
+
+void HttpServerSession::DoStreamRead(HttpServerStream::ReadHandler handler) {
+    auto& body = stream_parser_->get().body();
+    body.data = stream_read_buffer_.data();
+    body.size = stream_read_buffer_.size();
+    
+    auto self = shared_from_this();
+    auto on_read = boost::asio::bind_executor(strand_,
+        [self, handler = std::move(handler)](boost::system::error_code ec, std::size_t) mutable {
+            self->OnStreamRead(ec, std::move(handler));
+        });
+    
+    if (ssl_stream_) {
+        boost::beast::http::async_read_some(*ssl_stream_, buffer_, *stream_parser_, std::move(on_read));
+    } else {
+        boost::beast::http::async_read_some(*socket_, buffer_, *stream_parser_, std::move(on_read));
+    }
+}
+
+void HttpServerSession::OnStreamRead(boost::system::error_code ec, HttpServerStream::ReadHandler handler) {
+    // need_buffer表示本块缓冲区已填满，不是错误
+    if (ec == boost::beast::http::error::need_buffer) {
+        ec = {};
+    }
+    
+    if (ec || !stream_parser_) {
+        stream_reading_ = false;
+        keep_alive_ = false;
+        handler(ec ? ec : boost::system::error_code(boost::asio::error::operation_aborted), {});
+        return;
+    }
+    
+    const size_t bytes_read = stream_read_buffer_.size() - stream_parser_->get().body().size;
+    if (bytes_read == 0 && !stream_parser_->is_done()) {
+        // 只读到分块编码的控制数据，继续读取
+        DoStreamRead(std::move(handler));
+        return;
+    }
+    
+    stream_reading_ = false;
+    bytes_received_ += bytes_read;
+    stream_bytes_received_ += bytes_read;
+    last_activity_ = std::chrono::steady_clock::now();
+    handler({}, std::string_view(stream_read_buffer_.data(), bytes_read));
+}
+
+void HttpServerSession::StreamWrite(std::string data, HttpServerStream::WriteHandler handler, bool last) {
+    auto self = shared_from_this();
+    boost::asio::post(strand_, [self, data = std::move(data), handler = std::move(handler), last]() mutable {
+        if (self->closed_ || !self->stream_active_ || self->stream_ended_) {
+            if (handler) {
+                handler(boost::asio::error::operation_aborted);
+            }
+            return;
+        }
+        
+        self->stream_ended_ = last;
+        self->stream_writes_.push_back(StreamWriteOp{std::move(data), std::move(handler), last});
+        if (!self->stream_writing_) {
+            self->DoStreamWrite();
+        }
+    });
+}
+
+void HttpServerSession::DoStreamWrite() {
+    auto self = shared_from_this();
+    
+    if (!stream_header_sent_) {
+        stream_writing_ = true;
+        
+        // 响应头单独发送；未指定Content-Length时HTTP/1.1使用chunked编码，HTTP/1.0以关闭连接结束响应体
+        file_response_ = {};
+        file_response_.version(beast_request_.version());
+        file_response_.result(static_cast<boost::beast::http::status>(static_cast<int>(current_response_.GetStatusCode())));
+        current_response_.MoveHeadersTo(file_response_);
+        
+        const bool head_only = current_request_.GetMethod() == HttpMethod::HEAD;
+        if (!head_only && !file_response_.has_content_length()) {
+            if (file_response_.version() >= 11) {
+                stream_chunked_ = true;
+                file_response_.chunked(true);
+            } else {
+                keep_alive_ = false;
+            }
+        }
+        
+        // 请求体未读完时无法复用连接
+        if (!stream_parser_ || !stream_parser_->is_done()) {
+            keep_alive_ = false;
+        }
+        file_response_.keep_alive(keep_alive_);
+        file_serializer_ = std::make_unique<boost::beast::http::response_serializer<boost::beast::http::empty_body>>(file_response_);
+        
+        auto on_header = boost::asio::bind_executor(strand_,
+            [self](boost::system::error_code ec, std::size_t bytes_transferred) {
+                self->OnStreamHeaderWritten(ec, bytes_transferred);
+            });
+        if (ssl_stream_) {
+            boost::beast::http::async_write_header(*ssl_stream_, *file_serializer_, std::move(on_header));
+        } else {
+            boost::beast::http::async_write_header(*socket_, *file_serializer_, std::move(on_header));
+        }
+        return;
+    }
+    
+    if (stream_writes_.empty()) {
+        stream_writing_ = false;
+        return;
+    }
+    
+    stream_writing_ = true;
+    auto on_write = boost::asio::bind_executor(strand_,
+        [self](boost::system::error_code ec, std::size_t bytes_transferred) {
+            self->OnStreamWritten(ec, bytes_transferred);
+        });
+    
+    // deque尾部插入不会使首元素失效，写入期间数据保持有效
+    const StreamWriteOp& op = stream_writes_.front();
+    const bool head_only = current_request_.GetMethod() == HttpMethod::HEAD;
+    if (op.last) {
+        if (!stream_chunked_) {
+            boost::asio::post(strand_, [self]() { self->OnStreamWritten({}, 0); });
+        } else if (ssl_stream_) {
+            boost::asio::async_write(*ssl_stream_, boost::beast::http::make_chunk_last(), std::move(on_write));
+        } else {
+            boost::asio::async_write(*socket_, boost::beast::http::make_chunk_last(), std::move(on_write));
+        }
+    } else if (op.data.empty() || head_only) {
+        // 空块会被解释为结束块，HEAD响应不发送响应体
+        boost::asio::post(strand_, [self]() { self->OnStreamWritten({}, 0); });
+    } else if (stream_chunked_) {
+        auto chunk = boost::beast::http::make_chunk(boost::asio::buffer(op.data));
+        if (ssl_stream_) {
+            boost::asio::async_write(*ssl_stream_, chunk, std::move(on_write));
+        } else {
+            boost::asio::async_write(*socket_, chunk, std::move(on_write));
+        }
+    } else if (ssl_stream_) {
+        boost::asio::async_write(*ssl_stream_, boost::asio::buffer(op.data), std::move(on_write));
+    } else {
+        boost::asio::async_write(*socket_, boost::asio::buffer(op.data), std::move(on_write));
+    }
+}
+
+void HttpServerSession::OnStreamHeaderWritten(boost::system::error_code ec, std::size_t bytes_transferred) {
+    file_serializer_.reset();
+    if (ec) {
+        FinishStream(ec);
+        return;
+    }
+    
+    stream_header_sent_ = true;
+    stream_bytes_sent_ += bytes_transferred;
+    DoStreamWrite();
+}
+
+void HttpServerSession::OnStreamWritten(boost::system::error_code ec, std::size_t bytes_transferred) {
+    StreamWriteOp op = std::move(stream_writes_.front());
+    stream_writes_.pop_front();
+    
+    stream_bytes_sent_ += bytes_transferred;
+    if (!ec && current_request_.GetMethod() != HttpMethod::HEAD) {
+        stream_body_bytes_sent_ += op.data.size();
+    }
+    last_activity_ = std::chrono::steady_clock::now();
+    
+    if (op.handler) {
+        op.handler(ec);
+    }
+    
+    if (ec) {
+        FinishStream(ec);
+        return;
+    }
+    
+    if (op.last) {
+        FinishStream({});
+        return;
+    }
+    
+    DoStreamWrite();
+}
+
+void HttpServerSession::FinishStream(boost::system::error_code ec) {
+    if (!stream_active_) {
+        return;
+    }
+    
+    stream_active_ = false;
+    stream_writing_ = false;
+    
+    // 未写出的数据以相同错误回调
+    auto pending = std::move(stream_writes_);
+    stream_writes_.clear();
+    for (auto& op : pending) {
+        if (op.handler) {
+            op.handler(ec ? ec : boost::system::error_code(boost::asio::error::operation_aborted));
+        }
+    }
+    
+    // 中途失败的流式请求按状态类计入5xx
+    const HttpStatusCode status = ec ? HttpStatusCode::INTERNAL_SERVER_ERROR : current_response_.GetStatusCode();
+    server_.UpdateStats(stream_metrics_route_, status, std::chrono::steady_clock::now() - stream_start_time_,
+                        stream_bytes_received_, stream_body_bytes_sent_);
+    bytes_sent_ += stream_bytes_sent_;
+    requests_processed_++;
+    
+    // 读取仍在进行时不能开始读取下一个请求
+    const bool reusable = !ec && keep_alive_ && !stream_reading_ && stream_parser_ && stream_parser_->is_done();
+    stream_parser_.reset();
+    file_serializer_.reset();
+    
+    if (ec) {
+        HandleError(ec, "stream");
+    } else if (reusable) {
+        DoRead();
+    } else {
+        DoClose();
+    }
+}
+
 void HttpServerSession::HandleError(boost::system::error_code ec, const std::string& operation) {
     if (ec == boost::asio::error::operation_aborted) {
         return;
@@ -327,14 +1162,21 @@ void HttpServerSession::LogRequest() {
 // ===== HttpServer Implementation =====
 
 HttpServer::HttpServer(boost::asio::any_io_executor executor, const HttpServerConfig& config)
-    : executor_(executor), config_(config) {
+    : executor_(executor), config_(config),
+      builtin_chain_(LoggingStage{}, ErrorHandlerStage{}, CompressionStage{this}),
+      static_files_(config.static_files),
+      metrics_(config.metrics_max_routes, config.metrics_shard_count) {
     Initialize();
 }
 
 HttpServer::HttpServer(size_t thread_count, const HttpServerConfig& config)
-    : config_(config) {
+    : config_(config),
+      builtin_chain_(LoggingStage{}, ErrorHandlerStage{}, CompressionStage{this}),
+      static_files_(config.static_files),
+      metrics_(config.metrics_max_routes, config.metrics_shard_count) {
     owned_ioc_ = std::make_unique<boost::asio::io_context>();
     executor_ = owned_ioc_->get_executor();
+    owned_work_.emplace(owned_ioc_->get_executor());
     
     // 创建工作线程
     worker_threads_.reserve(thread_count);
@@ -349,6 +1191,11 @@ HttpServer::HttpServer(size_t thread_count, const HttpServerConfig& config)
 
 HttpServer::~HttpServer() {
     Stop();
+    // 未启动过的服务器也要让内部线程池退出
+    if (owned_ioc_) {
+        owned_work_.reset();
+        owned_ioc_->stop();
+    }
     Join();
 }
 
@@ -356,21 +1203,24 @@ void HttpServer::Initialize() {
     // 初始化acceptor
     acceptor_ = std::make_unique<boost::asio::ip::tcp::acceptor>(executor_);
     
+#ifndef ZEUS_HTTP_HAS_NGHTTP2
+    if (config_.enable_http2) {
+        NETWORK_LOG_WARN("HTTP/2 requested but not compiled in (nghttp2 missing), serving HTTP/1.1 only");
+        config_.enable_http2 = false;
+    }
+#endif
+    
     // 初始化SSL（如果启用）
     if (config_.enable_ssl) {
         SetupSSL();
     }
     
-    // 添加默认中间件
-    global_middlewares_.push_back([this](const HttpRequest& request, HttpResponse& response, std::function<void()> next) {
-        LoggingMiddleware(request, response, next);
-    });
-    
-    global_middlewares_.push_back([this](const HttpRequest& request, HttpResponse& response, std::function<void()> next) {
-        DefaultErrorHandler(request, response, next);
-    });
+    // 压缩位于用户中间件外层，处理最终的响应体
+    if (config_.enable_compression) {
+        compression_ = std::make_unique<common::network::http::CompressionMiddleware>();
+    }
     
-    stats_.start_time = std::chrono::steady_clock::now();
+    start_time_ = std::chrono::steady_clock::now();
     
     NETWORK_LOG_INFO("HTTP server initialized on {}:{}", config_.bind_address, config_.port);
 }
@@ -401,6 +1251,10 @@ void HttpServer::SetupSSL() {
             ssl_context_->use_tmp_dh_file(config_.ssl_dh_param_file);
         }
         
+#ifdef ZEUS_HTTP_HAS_NGHTTP2
+        SSL_CTX_set_alpn_select_cb(ssl_context_->native_handle(), &SelectAlpnProtocol, &config_.enable_http2);
+#endif
+        
         // 设置验证模式
         if (config_.ssl_verify_client) {
             ssl_context_->set_verify_mode(boost::asio::ssl::verify_peer | boost::asio::ssl::verify_fail_if_no_peer_cert);
@@ -467,6 +1321,7 @@ void HttpServer::Stop() {
     }
     
     if (owned_ioc_) {
+        owned_work_.reset();
         owned_ioc_->stop();
     }
     
@@ -484,6 +1339,16 @@ void HttpServer::Join() {
 
 // IsRunning() is defined inline in header file
 
+void HttpServer::PruneSessionsLocked() {
+    // 只被本列表持有的会话已没有进行中的读写；移交给HTTP/2或WebSocket的会话在新连接关闭后才释放
+    active_sessions_.erase(
+        std::remove_if(active_sessions_.begin(), active_sessions_.end(),
+            [](const std::shared_ptr<HttpServerSession>& session) {
+                return session.use_count() == 1 && !session->HasActiveUpgrade();
+            }),
+        active_sessions_.end());
+}
+
 void HttpServer::StartAccept() {
     if (!running_) {
         return;
@@ -524,6 +1389,7 @@ void HttpServer::HandleAccept(boost::system::error_code ec, boost::asio::ip::tcp
     // 检查连接限制
     {
         std::lock_guard<std::mutex> lock(sessions_mutex_);
+        PruneSessionsLocked();
         if (active_sessions_.size() >= config_.max_connections) {
             NETWORK_LOG_WARN("HTTP server rejecting connection - maximum connections reached ({})", config_.max_connections);
             boost::system::error_code close_ec;
@@ -537,11 +1403,6 @@ void HttpServer::HandleAccept(boost::system::error_code ec, boost::asio::ip::tcp
         // 启动会话
         session->Start();
     }
-    
-    {
-        std::lock_guard<std::mutex> lock(stats_mutex_);
-        stats_.active_connections++;
-    }
 }
 
 void HttpServer::HandleSSLAccept(boost::system::error_code ec, boost::asio::ssl::stream<boost::asio::ip::tcp::socket> stream) {
@@ -555,6 +1416,7 @@ void HttpServer::HandleSSLAccept(boost::system::error_code ec, boost::asio::ssl:
     // 检查连接限制
     {
         std::lock_guard<std::mutex> lock(sessions_mutex_);
+        PruneSessionsLocked();
         if (active_sessions_.size() >= config_.max_connections) {
             NETWORK_LOG_WARN("HTTPS server rejecting connection - maximum connections reached ({})", config_.max_connections);
             boost::system::error_code close_ec;
@@ -568,11 +1430,6 @@ void HttpServer::HandleSSLAccept(boost::system::error_code ec, boost::asio::ssl:
         // 启动会话
         session->Start();
     }
-    
-    {
-        std::lock_guard<std::mutex> lock(stats_mutex_);
-        stats_.active_connections++;
-    }
 }
 
 // 路由注册方法
@@ -597,30 +1454,23 @@ void HttpServer::Patch(const std::string& path, HttpRequestHandler handler) {
 }
 
 void HttpServer::Route(HttpMethod method, const std::string& path, HttpRequestHandler handler) {
+    if (route_trees_.empty()) {
+        for (size_t i = 0; i <= static_cast<size_t>(HttpMethod::CUSTOM); ++i) {
+            route_trees_.emplace_back(true);
+        }
+    }
+    
+    if (!route_trees_[static_cast<size_t>(method)].Insert(path, routes_.size())) {
+        NETWORK_LOG_ERROR("Invalid or duplicate HTTP route pattern: {}", path);
+        return;
+    }
+    
     RouteEntry entry;
     entry.method = method;
     entry.path_pattern = path;
     entry.handler = std::move(handler);
-    
-    // 编译路径正则表达式（简化版本）
-    std::string regex_pattern = path;
-    // 将{param}替换为捕获组
-    std::regex param_regex(R"(\{([^}]+)\})");
-    std::sregex_iterator iter(regex_pattern.begin(), regex_pattern.end(), param_regex);
-    std::sregex_iterator end;
-    
-    size_t offset = 0;
-    for (; iter != end; ++iter) {
-        const std::smatch& match = *iter;
-        entry.param_names.push_back(match[1].str());
-        
-        size_t pos = match.position() + offset;
-        size_t len = match.length();
-        regex_pattern.replace(pos, len, "([^/]+)");
-        offset += 7 - len; // "([^/]+)" has 7 chars, original match has len chars
-    }
-    
-    entry.path_regex = std::regex(regex_pattern);
+    entry.metrics_route = metrics_.RegisterRoute(HttpUtils::MethodToString(method), path);
+    CompilePipeline(entry);
     routes_.push_back(std::move(entry));
 }
 
@@ -636,16 +1486,36 @@ void HttpServer::All(const std::string& path, HttpRequestHandler handler) {
     }
 }
 
+void HttpServer::Stream(HttpMethod method, const std::string& path, HttpStreamHandler handler) {
+    const size_t route_count = routes_.size();
+    Route(method, path, nullptr);
+    if (routes_.size() > route_count) {
+        routes_.back().stream_handler = std::move(handler);
+        CompilePipeline(routes_.back());
+    }
+}
+
+void HttpServer::WebSocket(const std::string& path, HttpWebSocketHandler handler) {
+    const size_t route_count = routes_.size();
+    Route(HttpMethod::GET, path, nullptr);
+    if (routes_.size() > route_count) {
+        routes_.back().websocket_handler = std::move(handler);
+        CompilePipeline(routes_.back());
+    }
+}
+
 void HttpServer::Use(HttpRequestHandler middleware) {
     global_middlewares_.push_back(std::move(middleware));
+    CompilePipelines();
 }
 
 void HttpServer::Use(const std::string& path, HttpRequestHandler middleware) {
-    path_middlewares_[path].push_back(std::move(middleware));
+    path_middlewares_.emplace_back(path, std::move(middleware));
+    CompilePipelines();
 }
 
 void HttpServer::ServeStatic(const std::string& url_path, const std::string& file_path) {
-    static_paths_[url_path] = file_path;
+    static_files_.Mount(url_path, file_path);
     
     // 注册通配符路由处理静态文件
     std::string pattern = url_path;
@@ -659,83 +1529,209 @@ void HttpServer::ServeStatic(const std::string& url_path, const std::string& fil
     });
 }
 
-bool HttpServer::ProcessRequest(const HttpRequest& request, HttpResponse& response) {
+bool HttpServer::ProcessRequest(HttpRequest& request, HttpResponse& response, size_t& metrics_route) {
+    metrics_route = HttpServerMetrics::kUnmatchedRoute;
+    bool counted = false;
     try {
         // 首先检查静态文件
         if (HandleStaticFile(request, response)) {
+            metrics_route = HttpServerMetrics::kStaticRoute;
+            metrics_.BeginRequest(metrics_route);
             return true;
         }
         
         // 查找匹配的路由
-        RouteMatch match = MatchRoute(request.GetMethod(), request.GetUrl().path);
-        if (!match.matched) {
+        PathParams params;
+        const RouteEntry* route = FindRoute(request.GetMethod(), request.GetUrl().path, params);
+        if (route) {
+            metrics_route = route->metrics_route;
+        }
+        metrics_.BeginRequest(metrics_route);
+        counted = true;
+        if (route && route->websocket_handler) {
+            response.SetStatusCode(HttpStatusCode::UPGRADE_REQUIRED);
+            response.SetHeader("Upgrade", "websocket");
+            response.SetHeader("Connection", "Upgrade");
+            response.SetBody("Upgrade Required");
+            return true;
+        }
+        if (!route || !route->handler) {
             return false;
         }
         
-        // 准备中间件列表
-        std::vector<HttpRequestHandler> middlewares = global_middlewares_;
-        
-        // 添加路径特定中间件
-        for (const auto& path_middleware : path_middlewares_) {
-            if (request.GetUrl().path.find(path_middleware.first) == 0) {
-                middlewares.insert(middlewares.end(), 
-                                 path_middleware.second.begin(), 
-                                 path_middleware.second.end());
-            }
+        for (size_t i = 0; i < params.Size(); ++i) {
+            request.SetPathParam(std::string(params[i].name), std::string(params[i].value));
         }
         
-        // 执行中间件链
-        ExecuteMiddlewares(request, response, middlewares, 0);
+        // 执行预编译的中间件链，路由处理器位于链末端
+        builtin_chain_(request, response, [route, &request, &response]() {
+            route->pipeline.Run(request, response);
+        });
         
         return true;
         
     } catch (const std::exception& e) {
         NETWORK_LOG_ERROR("Error processing HTTP request: {}", e.what());
+        if (!counted) {
+            metrics_.BeginRequest(metrics_route);
+        }
         response.SetStatusCode(HttpStatusCode::INTERNAL_SERVER_ERROR);
         response.SetBody("Internal Server Error");
         return true;
     }
 }
 
-RouteMatch HttpServer::MatchRoute(HttpMethod method, const std::string& path) const {
-    RouteMatch result;
-    
-    for (const auto& route : routes_) {
-        if (route.method != method) {
-            continue;
+bool HttpServer::IsStreamRoute(HttpMethod method, std::string_view path) const {
+    PathParams params;
+    const RouteEntry* route = FindRoute(method, path, params);
+    return route && route->stream_handler;
+}
+
+HttpStreamHandler HttpServer::ProcessStreamRequest(HttpRequest& request, HttpResponse& response, size_t& metrics_route) {
+    metrics_route = HttpServerMetrics::kUnmatchedRoute;
+    try {
+        PathParams params;
+        const RouteEntry* route = FindRoute(request.GetMethod(), request.GetUrl().path, params);
+        if (route) {
+            metrics_route = route->metrics_route;
+        }
+        metrics_.BeginRequest(metrics_route);
+        if (!route || !route->stream_handler) {
+            response.SetStatusCode(HttpStatusCode::NOT_FOUND);
+            response.SetBody("Not Found");
+            return nullptr;
         }
         
-        std::smatch match;
-        if (std::regex_match(path, match, route.path_regex)) {
-            result.matched = true;
-            result.matched_path = path;
-            
-            // 提取参数
-            for (size_t i = 1; i < match.size() && (i - 1) < route.param_names.size(); ++i) {
-                result.params[route.param_names[i - 1]] = match[i].str();
-            }
-            
-            break;
+        for (size_t i = 0; i < params.Size(); ++i) {
+            request.SetPathParam(std::string(params[i].name), std::string(params[i].value));
+        }
+        
+        // 中间件链末端只把响应标记为流式，中间件直接返回响应（如鉴权失败）时不调用处理器
+        builtin_chain_(request, response, [route, &request, &response]() {
+            route->pipeline.Run(request, response);
+        });
+        
+        return response.IsStreaming() ? route->stream_handler : nullptr;
+        
+    } catch (const std::exception& e) {
+        NETWORK_LOG_ERROR("Error processing HTTP stream request: {}", e.what());
+        response.SetStreaming(false);
+        response.SetStatusCode(HttpStatusCode::INTERNAL_SERVER_ERROR);
+        response.SetBody("Internal Server Error");
+        return nullptr;
+    }
+}
+
+bool HttpServer::IsWebSocketRoute(std::string_view path) const {
+    PathParams params;
+    const RouteEntry* route = FindRoute(HttpMethod::GET, path, params);
+    return route && route->websocket_handler;
+}
+
+HttpWebSocketHandler HttpServer::ProcessWebSocketRequest(HttpRequest& request, HttpResponse& response, size_t& metrics_route) {
+    metrics_route = HttpServerMetrics::kUnmatchedRoute;
+    try {
+        PathParams params;
+        const RouteEntry* route = FindRoute(HttpMethod::GET, request.GetUrl().path, params);
+        if (route) {
+            metrics_route = route->metrics_route;
+        }
+        metrics_.BeginRequest(metrics_route);
+        if (!route || !route->websocket_handler) {
+            response.SetStatusCode(HttpStatusCode::NOT_FOUND);
+            response.SetBody("Not Found");
+            return nullptr;
         }
+        
+        for (size_t i = 0; i < params.Size(); ++i) {
+            request.SetPathParam(std::string(params[i].name), std::string(params[i].value));
+        }
+        
+        // 与流式路由相同，中间件链末端只标记响应，由会话完成握手
+        builtin_chain_(request, response, [route, &request, &response]() {
+            route->pipeline.Run(request, response);
+        });
+        
+        return response.IsStreaming() ? route->websocket_handler : nullptr;
+        
+    } catch (const std::exception& e) {
+        NETWORK_LOG_ERROR("Error processing WebSocket upgrade request: {}", e.what());
+        response.SetStreaming(false);
+        response.SetStatusCode(HttpStatusCode::INTERNAL_SERVER_ERROR);
+        response.SetBody("Internal Server Error");
+        return nullptr;
+    }
+}
+
+RouteMatch HttpServer::MatchRoute(HttpMethod method, const std::string& path) const {
+    RouteMatch result;
+    
+    PathParams params;
+    const RouteEntry* route = FindRoute(method, path, params);
+    if (!route) {
+        return result;
+    }
+    
+    result.matched = true;
+    result.matched_pattern = route->path_pattern;
+    result.matched_path = path;
+    for (size_t i = 0; i < params.Size(); ++i) {
+        result.params.emplace(std::string(params[i].name), std::string(params[i].value));
     }
     
     return result;
 }
 
-void HttpServer::ExecuteMiddlewares(const HttpRequest& request, HttpResponse& response, 
-                                   const std::vector<HttpRequestHandler>& middlewares, size_t index) {
-    if (index >= middlewares.size()) {
-        return;
+const HttpServer::RouteEntry* HttpServer::FindRoute(HttpMethod method, std::string_view path, PathParams& params) const {
+    const size_t method_index = static_cast<size_t>(method);
+    if (method_index >= route_trees_.size()) {
+        return nullptr;
     }
     
-    auto next = [this, &request, &response, &middlewares, index]() {
-        ExecuteMiddlewares(request, response, middlewares, index + 1);
-    };
+    size_t route_index = 0;
+    if (!route_trees_[method_index].Find(path, route_index, params)) {
+        return nullptr;
+    }
+    return &routes_[route_index];
+}
+
+void HttpServer::CompilePipeline(RouteEntry& route) const {
+    route.pipeline.Clear();
+    for (const auto& middleware : global_middlewares_) {
+        route.pipeline.Append(middleware);
+    }
     
-    middlewares[index](request, response, next);
+    // 路径中间件按路由模式在注册时筛选，仅无法静态确定的保留运行时前缀检查
+    for (const auto& path_middleware : path_middlewares_) {
+        switch (HttpMiddlewarePipeline::MatchPrefix(route.path_pattern, path_middleware.first)) {
+            case HttpMiddlewarePipeline::PrefixMatch::ALWAYS:
+                route.pipeline.Append(path_middleware.second);
+                break;
+            case HttpMiddlewarePipeline::PrefixMatch::RUNTIME:
+                route.pipeline.Append(path_middleware.second, path_middleware.first);
+                break;
+            case HttpMiddlewarePipeline::PrefixMatch::NEVER:
+                break;
+        }
+    }
+    
+    if (route.stream_handler || route.websocket_handler) {
+        route.pipeline.Append([](const HttpRequest&, HttpResponse& response, std::function<void()>) {
+            response.SetStreaming(true);
+        });
+    } else if (route.handler) {
+        route.pipeline.Append(route.handler);
+    }
+}
+
+void HttpServer::CompilePipelines() {
+    for (auto& route : routes_) {
+        CompilePipeline(route);
+    }
 }
 
-void HttpServer::DefaultErrorHandler(const HttpRequest& request, HttpResponse& response, std::function<void()> next) {
+template <typename Next>
+void HttpServer::ErrorHandlerStage::operator()(const HttpRequest& request, HttpResponse& response, Next&& next) const {
     try {
         next();
     } catch (const std::exception& e) {
@@ -745,7 +1741,17 @@ void HttpServer::DefaultErrorHandler(const HttpRequest& request, HttpResponse& r
     }
 }
 
-void HttpServer::LoggingMiddleware(const HttpRequest& request, HttpResponse& response, std::function<void()> next) {
+template <typename Next>
+void HttpServer::CompressionStage::operator()(const HttpRequest& request, HttpResponse& response, Next&& next) const {
+    if (server->compression_) {
+        server->compression_->Handle(request, response, [&next]() { next(); });
+    } else {
+        next();
+    }
+}
+
+template <typename Next>
+void HttpServer::LoggingStage::operator()(const HttpRequest& request, HttpResponse& response, Next&& next) const {
     auto start_time = std::chrono::steady_clock::now();
     
     next();
@@ -761,61 +1767,7 @@ void HttpServer::LoggingMiddleware(const HttpRequest& request, HttpResponse& res
 }
 
 bool HttpServer::HandleStaticFile(const HttpRequest& request, HttpResponse& response) {
-    std::string request_path = request.GetUrl().path;
-    
-    for (const auto& static_mapping : static_paths_) {
-        const std::string& url_prefix = static_mapping.first;
-        const std::string& file_root = static_mapping.second;
-        
-        if (request_path.find(url_prefix) == 0) {
-            std::string relative_path = request_path.substr(url_prefix.length());
-            std::string file_path = file_root + "/" + relative_path;
-            
-            std::ifstream file(file_path, std::ios::binary);
-            if (file) {
-                std::ostringstream buffer;
-                buffer << file.rdbuf();
-                
-                response.SetStatusCode(HttpStatusCode::OK);
-                response.SetBody(buffer.str());
-                response.SetHeader("Content-Type", GetMimeType(file_path));
-                return true;
-            }
-        }
-    }
-    
-    return false;
-}
-
-std::string HttpServer::GetMimeType(const std::string& file_path) {
-    auto pos = file_path.find_last_of('.');
-    if (pos == std::string::npos) {
-        return "application/octet-stream";
-    }
-    
-    std::string ext = file_path.substr(pos + 1);
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    
-    static std::unordered_map<std::string, std::string> mime_types = {
-        {"html", "text/html"},
-        {"htm", "text/html"},
-        {"css", "text/css"},
-        {"js", "application/javascript"},
-        {"json", "application/json"},
-        {"xml", "application/xml"},
-        {"png", "image/png"},
-        {"jpg", "image/jpeg"},
-        {"jpeg", "image/jpeg"},
-        {"gif", "image/gif"},
-        {"svg", "image/svg+xml"},
-        {"ico", "image/x-icon"},
-        {"txt", "text/plain"},
-        {"pdf", "application/pdf"},
-        {"zip", "application/zip"}
-    };
-    
-    auto it = mime_types.find(ext);
-    return (it != mime_types.end()) ? it->second : "application/octet-stream";
+    return static_files_.Handle(request, response);
 }
 
 std::string HttpServer::GenerateServerHeader() const {
@@ -823,8 +1775,34 @@ std::string HttpServer::GenerateServerHeader() const {
 }
 
 HttpServer::ServerStats HttpServer::GetStats() const {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    return stats_;
+    ServerStats stats;
+    stats.start_time = start_time_;
+    {
+        // 只被会话列表持有的会话已结束，尚未清理
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        stats.active_connections = static_cast<size_t>(std::count_if(active_sessions_.begin(), active_sessions_.end(),
+            [](const std::shared_ptr<HttpServerSession>& session) {
+                return session.use_count() > 1 || session->HasActiveUpgrade();
+            }));
+    }
+    
+    const HttpRouteMetrics total = metrics_.GetTotal();
+    const HttpHistogramSnapshot latency = total.GetLatency();
+    stats.in_flight_requests = static_cast<size_t>(std::max<int64_t>(total.in_flight, 0));
+    stats.total_requests = latency.count;
+    stats.failed_requests = total.latency_us[3].count + total.latency_us[4].count;
+    stats.successful_requests = stats.total_requests - stats.failed_requests;
+    stats.total_bytes_received = total.request_bytes.sum;
+    stats.total_bytes_sent = total.response_bytes.sum;
+    stats.average_response_time_ms = latency.GetMean() / 1000.0;
+    stats.p99_response_time_ms = latency.GetPercentile(99.0) / 1000.0;
+    return stats;
+}
+
+void HttpServer::ServeMetrics(const std::string& path, const std::string& prefix) {
+    Get(path, [this, prefix](const HttpRequest&, HttpResponse& response, std::function<void()>) {
+        response.SetBody(metrics_.RenderPrometheus(prefix), "text/plain; version=0.0.4");
+    });
 }
 
 std::string HttpServer::GetListeningEndpoint() const {
@@ -835,24 +1813,10 @@ std::string HttpServer::GetListeningEndpoint() const {
     return "not_listening";
 }
 
-void HttpServer::UpdateStats(bool success, std::chrono::milliseconds response_time, size_t bytes_received, size_t bytes_sent) {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    
-    stats_.total_requests++;
-    if (success) {
-        stats_.successful_requests++;
-    } else {
-        stats_.failed_requests++;
-    }
-    
-    stats_.total_bytes_received += bytes_received;
-    stats_.total_bytes_sent += bytes_sent;
-    
-    // 更新平均响应时间
-    if (stats_.total_requests > 0) {
-        stats_.average_response_time_ms = 
-            (stats_.average_response_time_ms * (stats_.total_requests - 1) + response_time.count()) / stats_.total_requests;
-    }
+void HttpServer::UpdateStats(size_t metrics_route, HttpStatusCode status, std::chrono::steady_clock::duration response_time,
+                             size_t bytes_received, size_t bytes_sent) {
+    metrics_.EndRequest(metrics_route, status, std::chrono::duration_cast<std::chrono::microseconds>(response_time),
+                        bytes_received, bytes_sent);
 }
 
 void HttpServer::SetConfig(const HttpServerConfig& config) {
@@ -861,6 +1825,12 @@ void HttpServer::SetConfig(const HttpServerConfig& config) {
         return;
     }
     config_ = config;
+    static_files_.Configure(config_.static_files);
+    if (config_.enable_compression) {
+        compression_ = std::make_unique<common::network::http::CompressionMiddleware>();
+    } else {
+        compression_.reset();
+    }
 }
 
 } // namespace http
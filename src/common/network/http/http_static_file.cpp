@@ -0,0 +1,379 @@
+#include "common/network/http/http_static_file.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace common {
+namespace network {
+namespace http {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::string Trim(const std::string& value) {
+    const auto begin = value.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    const auto end = value.find_last_not_of(" \t");
+    return value.substr(begin, end - begin + 1);
+}
+
+bool ParseUint(const std::string& text, uint64_t& value) {
+    if (text.empty()) {
+        return false;
+    }
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// 文件时钟与系统时钟的纪元偏移只计算一次，保证同一文件的Last-Modified稳定不变
+std::chrono::system_clock::time_point ToSystemTime(fs::file_time_type file_time) {
+    static const auto offset = std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::system_clock::now().time_since_epoch()) -
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            fs::file_time_type::clock::now().time_since_epoch());
+
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(file_time.time_since_epoch()) + offset);
+}
+
+} // namespace
+
+HttpStaticFileHandler::HttpStaticFileHandler(const HttpStaticFileConfig& config)
+    : config_(config) {
+}
+
+void HttpStaticFileHandler::Configure(const HttpStaticFileConfig& config) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    config_ = config;
+    EvictLocked(0);
+}
+
+void HttpStaticFileHandler::Mount(const std::string& url_prefix, const std::string& root) {
+    std::string prefix = url_prefix;
+    if (prefix.empty() || prefix.front() != '/') {
+        prefix.insert(prefix.begin(), '/');
+    }
+    while (prefix.size() > 1 && prefix.back() == '/') {
+        prefix.pop_back();
+    }
+
+    auto it = std::find_if(mounts_.begin(), mounts_.end(),
+        [&](const std::pair<std::string, std::string>& mount) { return mount.first == prefix; });
+    if (it != mounts_.end()) {
+        it->second = root;
+        return;
+    }
+
+    mounts_.emplace_back(prefix, root);
+    std::stable_sort(mounts_.begin(), mounts_.end(),
+        [](const auto& a, const auto& b) { return a.first.size() > b.first.size(); });
+}
+
+bool HttpStaticFileHandler::Handle(const HttpRequest& request, HttpResponse& response) {
+    const HttpMethod method = request.GetMethod();
+    if ((method != HttpMethod::GET && method != HttpMethod::HEAD) || mounts_.empty()) {
+        return false;
+    }
+
+    std::string file_path;
+    FileInfo info;
+    if (!ResolvePath(request.GetUrl().path, file_path) || !StatFile(file_path, info)) {
+        return false;
+    }
+
+    response.SetHeader("ETag", info.etag);
+    response.SetHeader("Last-Modified", info.last_modified);
+    if (config_.max_age.count() > 0) {
+        response.SetHeader("Cache-Control", "public, max-age=" + std::to_string(config_.max_age.count()));
+    }
+    if (config_.enable_ranges) {
+        response.SetHeader("Accept-Ranges", "bytes");
+    }
+
+    if (IsNotModified(request, info)) {
+        response.SetStatusCode(HttpStatusCode::NOT_MODIFIED);
+        return true;
+    }
+
+    uint64_t offset = 0;
+    uint64_t length = info.size;
+    if (config_.enable_ranges && RangeApplies(request, info)) {
+        const int range = ParseRange(request.GetHeader("Range"), info.size, offset, length);
+        if (range < 0) {
+            response.SetStatusCode(HttpStatusCode::RANGE_NOT_SATISFIABLE);
+            response.SetHeader("Content-Range", "bytes */" + std::to_string(info.size));
+            return true;
+        }
+        if (range > 0) {
+            response.SetStatusCode(HttpStatusCode::PARTIAL_CONTENT);
+            response.SetHeader("Content-Range", "bytes " + std::to_string(offset) + "-" +
+                               std::to_string(offset + length - 1) + "/" + std::to_string(info.size));
+        }
+    }
+
+    const auto dot = info.path.find_last_of('.');
+    const std::string content_type = HttpUtils::GetMimeType(
+        dot == std::string::npos ? std::string() : info.path.substr(dot));
+
+    // HEAD请求只需要长度，不读取文件内容
+    if (method == HttpMethod::GET && info.size <= config_.cache_max_file_size) {
+        auto data = GetCachedFile(info);
+        if (data) {
+            if (offset == 0 && length == data->size()) {
+                response.SetBody(*data, content_type);
+            } else {
+                response.SetBody(data->substr(static_cast<size_t>(offset), static_cast<size_t>(length)), content_type);
+            }
+            return true;
+        }
+    }
+
+    response.SetFileRange(info.path, offset, length);
+    response.SetContentType(content_type);
+    return true;
+}
+
+HttpStaticFileHandler::CacheStats HttpStaticFileHandler::GetCacheStats() const {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    CacheStats stats;
+    stats.entries = lru_.size();
+    stats.bytes = cache_bytes_;
+    stats.hits = cache_hits_;
+    stats.misses = cache_misses_;
+    return stats;
+}
+
+void HttpStaticFileHandler::ClearCache() {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    EvictLocked(0);
+}
+
+bool HttpStaticFileHandler::ResolvePath(const std::string& request_path, std::string& file_path) const {
+    for (const auto& mount : mounts_) {
+        const std::string& prefix = mount.first;
+        if (request_path.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        // 前缀必须在路径分隔处结束，/static 不匹配 /staticfoo
+        if (request_path.size() > prefix.size() && prefix.back() != '/' && request_path[prefix.size()] != '/') {
+            continue;
+        }
+
+        const std::string relative = HttpUtils::UrlDecode(request_path.substr(prefix.size()));
+        fs::path resolved(mount.second);
+
+        size_t pos = 0;
+        while (pos <= relative.size()) {
+            size_t end = relative.find('/', pos);
+            if (end == std::string::npos) {
+                end = relative.size();
+            }
+
+            const std::string segment = relative.substr(pos, end - pos);
+            pos = end + 1;
+
+            if (segment.empty() || segment == ".") {
+                continue;
+            }
+            // 拒绝越出挂载目录的路径
+            if (segment == ".." || segment.find_first_of(std::string("\\:\0", 3)) != std::string::npos) {
+                return false;
+            }
+            resolved /= segment;
+        }
+
+        std::error_code ec;
+        if (fs::is_directory(resolved, ec)) {
+            if (config_.index_file.empty()) {
+                return false;
+            }
+            resolved /= config_.index_file;
+        }
+
+        file_path = resolved.string();
+        return true;
+    }
+    return false;
+}
+
+bool HttpStaticFileHandler::StatFile(const std::string& file_path, FileInfo& info) const {
+    std::error_code ec;
+    if (!fs::is_regular_file(file_path, ec)) {
+        return false;
+    }
+
+    const auto size = fs::file_size(file_path, ec);
+    if (ec) {
+        return false;
+    }
+    const auto mtime = fs::last_write_time(file_path, ec);
+    if (ec) {
+        return false;
+    }
+
+    info.path = file_path;
+    info.size = static_cast<uint64_t>(size);
+    info.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    info.last_modified = HttpUtils::FormatHttpDate(ToSystemTime(mtime));
+
+    char etag[48];
+    std::snprintf(etag, sizeof(etag), "\"%llx-%llx\"",
+                  static_cast<unsigned long long>(info.size),
+                  static_cast<unsigned long long>(info.mtime));
+    info.etag = etag;
+    return true;
+}
+
+bool HttpStaticFileHandler::IsNotModified(const HttpRequest& request, const FileInfo& info) const {
+    // 存在If-None-Match时忽略If-Modified-Since
+    const std::string if_none_match = request.GetHeader("If-None-Match");
+    if (!if_none_match.empty()) {
+        return HttpUtils::EtagMatches(if_none_match, info.etag);
+    }
+
+    // 客户端回传的是我们下发的Last-Modified，精确比较即可，避免时区和秒级精度问题
+    const std::string if_modified_since = request.GetHeader("If-Modified-Since");
+    return !if_modified_since.empty() && Trim(if_modified_since) == info.last_modified;
+}
+
+bool HttpStaticFileHandler::RangeApplies(const HttpRequest& request, const FileInfo& info) const {
+    if (request.GetHeader("Range").empty()) {
+        return false;
+    }
+
+    // If-Range不匹配时返回完整文件；ETag需强比较
+    const std::string if_range = Trim(request.GetHeader("If-Range"));
+    if (if_range.empty()) {
+        return true;
+    }
+    return if_range == info.etag || if_range == info.last_modified;
+}
+
+int HttpStaticFileHandler::ParseRange(const std::string& header, uint64_t size, uint64_t& offset, uint64_t& length) {
+    const std::string value = Trim(header);
+    if (value.compare(0, 6, "bytes=") != 0) {
+        return 0;
+    }
+
+    // 多区间请求按完整文件响应
+    const std::string spec = Trim(value.substr(6));
+    const auto dash = spec.find('-');
+    if (dash == std::string::npos || spec.find(',') != std::string::npos) {
+        return 0;
+    }
+
+    const std::string first = Trim(spec.substr(0, dash));
+    const std::string last = Trim(spec.substr(dash + 1));
+
+    if (first.empty()) {
+        // 后缀区间：bytes=-N 表示最后N个字节
+        uint64_t suffix = 0;
+        if (!ParseUint(last, suffix)) {
+            return 0;
+        }
+        if (suffix == 0 || size == 0) {
+            return -1;
+        }
+        suffix = std::min(suffix, size);
+        offset = size - suffix;
+        length = suffix;
+        return 1;
+    }
+
+    uint64_t start = 0;
+    if (!ParseUint(first, start)) {
+        return 0;
+    }
+    if (start >= size) {
+        return -1;
+    }
+
+    uint64_t end = size - 1;
+    if (!last.empty()) {
+        if (!ParseUint(last, end) || end < start) {
+            return 0;
+        }
+        end = std::min(end, size - 1);
+    }
+
+    offset = start;
+    length = end - start + 1;
+    return 1;
+}
+
+std::shared_ptr<const std::string> HttpStaticFileHandler::GetCachedFile(const FileInfo& info) {
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto it = cache_index_.find(info.path);
+        if (it != cache_index_.end()) {
+            auto entry = it->second;
+            if (entry->size == info.size && entry->mtime == info.mtime) {
+                lru_.splice(lru_.begin(), lru_, entry);
+                ++cache_hits_;
+                return entry->data;
+            }
+
+            // 文件已变化，丢弃旧内容
+            cache_bytes_ -= static_cast<size_t>(entry->size);
+            lru_.erase(entry);
+            cache_index_.erase(it);
+        }
+        ++cache_misses_;
+    }
+
+    // 在锁外读取文件，读到的长度与stat结果不一致说明文件正在被修改，交由文件区间发送
+    std::ifstream file(info.path, std::ios::binary);
+    if (!file) {
+        return nullptr;
+    }
+
+    auto data = std::make_shared<std::string>();
+    data->resize(static_cast<size_t>(info.size));
+    file.read(&(*data)[0], static_cast<std::streamsize>(info.size));
+    if (static_cast<uint64_t>(file.gcount()) != info.size || file.peek() != std::ifstream::traits_type::eof()) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    InsertCacheLocked(info, data);
+    return data;
+}
+
+void HttpStaticFileHandler::InsertCacheLocked(const FileInfo& info, std::shared_ptr<const std::string> data) {
+    if (info.size > config_.cache_max_bytes) {
+        return;
+    }
+
+    auto it = cache_index_.find(info.path);
+    if (it != cache_index_.end()) {
+        cache_bytes_ -= static_cast<size_t>(it->second->size);
+        lru_.erase(it->second);
+        cache_index_.erase(it);
+    }
+
+    lru_.push_front(CacheEntry{info.path, info.size, info.mtime, std::move(data)});
+    cache_index_[info.path] = lru_.begin();
+    cache_bytes_ += static_cast<size_t>(info.size);
+
+    EvictLocked(config_.cache_max_bytes);
+}
+
+void HttpStaticFileHandler::EvictLocked(size_t max_bytes) {
+    // max_bytes为0时清空全部条目（包括空文件）
+    while (!lru_.empty() && (cache_bytes_ > max_bytes || max_bytes == 0)) {
+        const CacheEntry& victim = lru_.back();
+        cache_bytes_ -= static_cast<size_t>(victim.size);
+        cache_index_.erase(victim.path);
+        lru_.pop_back();
+    }
+}
+
+} // namespace http
+} // namespace network
+} // namespace common
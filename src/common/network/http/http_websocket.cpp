@@ -0,0 +1,361 @@
+#include "common/network/http/http_websocket.h"
+#include "common/network/network_logger.h"
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+
+namespace common {
+namespace network {
+namespace http {
+
+namespace websocket = boost::beast::websocket;
+
+namespace {
+std::string EndpointToString(const boost::asio::ip::tcp::socket& socket, bool remote) {
+    boost::system::error_code ec;
+    const auto endpoint = remote ? socket.remote_endpoint(ec) : socket.local_endpoint(ec);
+    if (ec) {
+        return "unknown";
+    }
+    return endpoint.address().to_string() + ":" + std::to_string(endpoint.port());
+}
+}
+
+// ===== WebSocketConnection Implementation =====
+
+template <typename Function>
+decltype(auto) WebSocketConnection::WithStream(Function&& function) {
+    return std::visit([&function](auto& stream) -> decltype(auto) { return function(*stream); }, stream_);
+}
+
+WebSocketConnection::WebSocketConnection(boost::asio::ip::tcp::socket socket, const std::string& connection_id,
+                                         const WebSocketOptions& options)
+    : Connection(boost::asio::make_strand(socket.get_executor()), connection_id),
+      options_(options) {
+    remote_endpoint_ = EndpointToString(socket, true);
+    local_endpoint_ = EndpointToString(socket, false);
+    stream_ = std::make_unique<PlainStream>(std::move(socket));
+    Configure();
+}
+
+WebSocketConnection::WebSocketConnection(boost::asio::ssl::stream<boost::asio::ip::tcp::socket> stream,
+                                         const std::string& connection_id, const WebSocketOptions& options)
+    : Connection(boost::asio::make_strand(stream.get_executor()), connection_id),
+      options_(options) {
+    remote_endpoint_ = EndpointToString(stream.next_layer(), true);
+    local_endpoint_ = EndpointToString(stream.next_layer(), false);
+    stream_ = std::make_unique<SslStream>(std::move(stream));
+    Configure();
+}
+
+WebSocketConnection::~WebSocketConnection() {
+    // No state change here: the handlers need shared_from_this()
+    WithStream([](auto& ws) {
+        boost::system::error_code ec;
+        boost::beast::get_lowest_layer(ws).close(ec);
+    });
+}
+
+void WebSocketConnection::Configure() {
+    WithStream([this](auto& ws) {
+        // Liveness is checked by the Connection heartbeat, Beast only guards the handshake and close
+        auto timeout = websocket::stream_base::timeout::suggested(boost::beast::role_type::server);
+        timeout.idle_timeout = websocket::stream_base::none();
+        ws.set_option(timeout);
+
+        websocket::permessage_deflate deflate;
+        deflate.server_enable = options_.permessage_deflate;
+        deflate.compLevel = options_.deflate_level;
+        deflate.server_no_context_takeover = options_.deflate_no_context_takeover;
+        ws.set_option(deflate);
+
+        ws.read_message_max(options_.max_message_size);
+        ws.binary(options_.binary);
+
+        if (!options_.server_name.empty()) {
+            ws.set_option(websocket::stream_base::decorator(
+                [server_name = options_.server_name](websocket::response_type& response) {
+                    response.set(boost::beast::http::field::server, server_name);
+                }));
+        }
+
+        // The callback is owned by the stream, which never outlives this connection
+        ws.control_callback([this](websocket::frame_type kind, boost::beast::string_view payload) {
+            OnControlFrame(kind, payload);
+        });
+    });
+}
+
+void WebSocketConnection::AsyncAccept(boost::beast::http::request<boost::beast::http::string_body> request,
+                                      AcceptHandler handler) {
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+    auto upgrade = std::make_shared<boost::beast::http::request<boost::beast::http::string_body>>(std::move(request));
+    boost::asio::dispatch(executor_, [self, upgrade, handler = std::move(handler)]() mutable {
+        self->WithStream([&](auto& ws) {
+            ws.async_accept(*upgrade, boost::asio::bind_executor(self->executor_,
+                [self, upgrade, handler = std::move(handler)](boost::system::error_code ec) mutable {
+                    self->OnAccept(ec, std::move(handler));
+                }));
+        });
+    });
+}
+
+void WebSocketConnection::OnAccept(boost::system::error_code ec, AcceptHandler handler) {
+    if (ec) {
+        NETWORK_LOG_WARN("WebSocket handshake failed on connection {}: {}", connection_id_, ec.message());
+        CloseSocket();
+        if (handler) {
+            handler(ec);
+        }
+        return;
+    }
+
+    last_receive_ = std::chrono::steady_clock::now();
+    UpdateState(ConnectionState::CONNECTED);
+
+    NETWORK_LOG_INFO("WebSocket connection {} accepted from {}", connection_id_, remote_endpoint_);
+
+    if (handler) {
+        try {
+            handler(ec);
+        } catch (const std::exception& e) {
+            NETWORK_LOG_ERROR("Exception in accept handler for WebSocket connection {}: {}", connection_id_, e.what());
+        }
+    }
+
+    StartReceive();
+}
+
+void WebSocketConnection::AsyncConnect(const std::string& endpoint,
+                                       std::function<void(boost::system::error_code)> callback) {
+    NETWORK_LOG_ERROR("WebSocket connection {} cannot connect to {}: server side only", connection_id_, endpoint);
+    if (callback) {
+        boost::asio::post(executor_, [callback = std::move(callback)]() {
+            callback(boost::asio::error::operation_not_supported);
+        });
+    }
+}
+
+void WebSocketConnection::AsyncSend(const std::vector<uint8_t>& data, SendCallback callback) {
+    QueueSend(SendOperation{data, std::move(callback), !options_.binary});
+}
+
+void WebSocketConnection::AsyncSendText(std::string text, SendCallback callback) {
+    QueueSend(SendOperation{std::vector<uint8_t>(text.begin(), text.end()), std::move(callback), true});
+}
+
+void WebSocketConnection::Close() {
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+    boost::asio::post(executor_, [self]() {
+        if (self->closing_ || !self->IsConnected()) {
+            return;
+        }
+
+        self->closing_ = true;
+        self->UpdateState(ConnectionState::DISCONNECTING);
+
+        NETWORK_LOG_INFO("Gracefully closing WebSocket connection: {}", self->connection_id_);
+
+        // The pending read completes once the peer answers the close frame and finishes the shutdown
+        self->WithStream([&self](auto& ws) {
+            ws.async_close(websocket::close_code::normal, boost::asio::bind_executor(self->executor_,
+                [self](boost::system::error_code ec) {
+                    if (ec) {
+                        NETWORK_LOG_DEBUG("WebSocket close error on connection {}: {}", self->connection_id_, ec.message());
+                        self->CloseSocket();
+                    }
+                }));
+        });
+    });
+}
+
+void WebSocketConnection::ForceClose() {
+    NETWORK_LOG_INFO("Force closing WebSocket connection: {}", connection_id_);
+
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+    boost::asio::post(executor_, [self]() {
+        self->CloseSocket();
+    });
+}
+
+void WebSocketConnection::SendHeartbeat() {
+    // Runs on the heartbeat timer, whose executor is this connection's strand
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_receive_ > std::chrono::milliseconds(2 * static_cast<uint64_t>(heartbeat_interval_ms_))) {
+        NETWORK_LOG_WARN("WebSocket connection {} silent for two heartbeat intervals, closing", connection_id_);
+        HandleError(boost::asio::error::timed_out);
+        CloseSocket();
+        return;
+    }
+
+    if (ping_writing_ || closing_) {
+        return;
+    }
+
+    // A pong that has not arrived by the next heartbeat is treated as lost; a late
+    // pong carries an old sequence number and is not taken as the new round trip
+    if (ping_pending_) {
+        NETWORK_LOG_DEBUG("Heartbeat pong {} not received on connection {}", ping_sequence_, connection_id_);
+    }
+
+    ping_pending_ = true;
+    ping_writing_ = true;
+    ping_sent_at_ = now;
+    websocket::ping_data payload(std::to_string(++ping_sequence_));
+
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+    WithStream([&self, &payload](auto& ws) {
+        ws.async_ping(payload, boost::asio::bind_executor(self->executor_, [self](boost::system::error_code ec) {
+            self->ping_writing_ = false;
+            if (ec) {
+                self->ping_pending_ = false;
+                NETWORK_LOG_WARN("Heartbeat ping failed on connection {}: {}", self->connection_id_, ec.message());
+            } else {
+                NETWORK_LOG_TRACE("Heartbeat ping sent on connection {}", self->connection_id_);
+            }
+        }));
+    });
+}
+
+void WebSocketConnection::OnControlFrame(websocket::frame_type kind, boost::beast::string_view payload) {
+    const auto now = std::chrono::steady_clock::now();
+    last_receive_ = now;
+
+    if (kind != websocket::frame_type::pong || !ping_pending_ || payload != std::to_string(ping_sequence_)) {
+        return;
+    }
+
+    ping_pending_ = false;
+    const auto rtt = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - ping_sent_at_).count());
+    const uint32_t average = stats_.avg_ping_ms.load();
+    stats_.last_ping_ms.store(rtt);
+    stats_.avg_ping_ms.store(average == 0 ? rtt : (average * 7 + rtt) / 8);
+}
+
+void WebSocketConnection::StartReceive() {
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+    WithStream([&self](auto& ws) {
+        ws.async_read(self->read_buffer_, boost::asio::bind_executor(self->executor_,
+            [self](boost::system::error_code ec, size_t bytes_transferred) {
+                self->HandleReceive(ec, bytes_transferred);
+            }));
+    });
+}
+
+void WebSocketConnection::HandleReceive(boost::system::error_code ec, size_t bytes_transferred) {
+    if (ec) {
+        HandleClosed(ec);
+        return;
+    }
+
+    last_receive_ = std::chrono::steady_clock::now();
+
+    // One message per callback, whether it arrived as a text or a binary frame
+    const auto buffer = read_buffer_.cdata();
+    const auto* begin = static_cast<const uint8_t*>(buffer.data());
+    std::vector<uint8_t> message(begin, begin + buffer.size());
+    read_buffer_.consume(read_buffer_.size());
+
+    HandleDataReceived(message);
+
+    NetworkLogger::Instance().LogDataTransfer(connection_id_, "receive", bytes_transferred, GetProtocol());
+
+    StartReceive();
+}
+
+void WebSocketConnection::QueueSend(SendOperation operation) {
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+    boost::asio::post(executor_, [self, operation = std::move(operation)]() mutable {
+        if (!self->IsConnected()) {
+            if (operation.callback) {
+                operation.callback(boost::asio::error::not_connected, 0);
+            }
+            return;
+        }
+        self->send_queue_.push_back(std::move(operation));
+        self->ProcessSendQueue();
+    });
+}
+
+void WebSocketConnection::ProcessSendQueue() {
+    if (sending_ || send_queue_.empty()) {
+        return;
+    }
+    sending_ = true;
+
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+    const SendOperation& operation = send_queue_.front();
+    WithStream([&self, &operation](auto& ws) {
+        ws.text(operation.text);
+        ws.async_write(boost::asio::buffer(operation.data), boost::asio::bind_executor(self->executor_,
+            [self](boost::system::error_code ec, size_t bytes_transferred) {
+                self->HandleSend(ec, bytes_transferred);
+            }));
+    });
+}
+
+void WebSocketConnection::HandleSend(boost::system::error_code ec, size_t bytes_transferred) {
+    SendOperation completed_operation = std::move(send_queue_.front());
+    send_queue_.pop_front();
+    sending_ = false;
+
+    if (ec) {
+        // The read side reports the failure and closes the connection
+        NETWORK_LOG_DEBUG("WebSocket send error on connection {}: {}", connection_id_, ec.message());
+        if (completed_operation.callback) {
+            completed_operation.callback(ec, 0);
+        }
+        while (!send_queue_.empty()) {
+            if (send_queue_.front().callback) {
+                send_queue_.front().callback(ec, 0);
+            }
+            send_queue_.pop_front();
+        }
+        return;
+    }
+
+    stats_.bytes_sent.fetch_add(completed_operation.data.size());
+    stats_.messages_sent.fetch_add(1);
+    stats_.last_activity = std::chrono::steady_clock::now();
+
+    NetworkLogger::Instance().LogDataTransfer(connection_id_, "send", bytes_transferred, GetProtocol());
+
+    if (completed_operation.callback) {
+        completed_operation.callback(ec, completed_operation.data.size());
+    }
+
+    ProcessSendQueue();
+}
+
+void WebSocketConnection::HandleClosed(boost::system::error_code ec) {
+    if (closing_ || ec == websocket::error::closed || ec == boost::asio::error::eof ||
+        ec == boost::asio::error::connection_reset || ec == boost::asio::error::operation_aborted) {
+        NETWORK_LOG_INFO("WebSocket connection {} closed", connection_id_);
+    } else {
+        NETWORK_LOG_ERROR("WebSocket receive error on connection {}: {}", connection_id_, ec.message());
+        HandleError(ec);
+    }
+    CloseSocket();
+}
+
+void WebSocketConnection::CloseSocket() {
+    WithStream([](auto& ws) {
+        auto& socket = boost::beast::get_lowest_layer(ws);
+        if (socket.is_open()) {
+            boost::system::error_code ec;
+            socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+            socket.close(ec);
+        }
+    });
+
+    const ConnectionState state = GetState();
+    if (state == ConnectionState::CONNECTED || state == ConnectionState::DISCONNECTING) {
+        UpdateState(ConnectionState::DISCONNECTED);
+        NETWORK_LOG_DEBUG("WebSocket socket closed for connection: {}", connection_id_);
+    }
+}
+
+} // namespace http
+} // namespace network
+} // namespace common
@@ -457,7 +457,7 @@ bool AppConfig::ValidateListenerConfig(const ListenerConfig& config) const {
     }
     
     // 验证支持的类型
-    std::vector<std::string> valid_types = {"tcp", "http", "https", "kcp"};
+    std::vector<std::string> valid_types = {"tcp", "http", "https", "kcp", "ws", "wss"};
     if (std::find(valid_types.begin(), valid_types.end(), config.type) == valid_types.end()) {
         std::cerr << "Invalid listener type: " << config.type << std::endl;
         return false;
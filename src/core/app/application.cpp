@@ -314,7 +314,7 @@ bool Application::CreateListenerServices() {
                 std::cerr << "Failed to create HTTP service: " << listener.name << std::endl;
                 success = false;
             }
-        } else if (listener.type == "tcp") {
+        } else if (listener.type == "tcp" || listener.type == "ws" || listener.type == "wss") {
             TcpServiceOptions options;
             options.on_connection = [listener](const std::string& conn_id, const std::string& endpoint) {
                 std::cout << "TCP connection established [" << listener.name << "]: " << conn_id << " from " << endpoint << std::endl;
@@ -616,7 +616,10 @@ void Application::ExecuteDefaultSignalHandler(int signal) {
 }
 
 bool Application::CreateTcpService(const ListenerConfig& config, const TcpServiceOptions& options) {
-    auto service = service_factory_->CreateTcpServer(config, options);
+    // WebSocket监听与TCP监听使用相同的服务选项
+    auto service = (config.type == "ws" || config.type == "wss")
+        ? service_factory_->CreateWebSocketServer(config, options)
+        : service_factory_->CreateTcpServer(config, options);
     if (service) {
         return service_registry_->RegisterService(std::move(service));
     }
@@ -183,6 +183,7 @@ void PrintServiceStatus(Application& app) {
                     case ServiceType::HTTP_SERVER: type_name = "HTTP Server"; break;
                     case ServiceType::HTTPS_SERVER: type_name = "HTTPS Server"; break;
                     case ServiceType::KCP_SERVER: type_name = "KCP Server"; break;
+                    case ServiceType::WEBSOCKET_SERVER: type_name = "WebSocket Server"; break;
                     case ServiceType::TCP_CLIENT: type_name = "TCP Client"; break;
                     case ServiceType::HTTP_CLIENT: type_name = "HTTP Client"; break;
                     case ServiceType::HTTPS_CLIENT: type_name = "HTTPS Client"; break;
@@ -53,7 +53,7 @@ std::unique_ptr<Service> ServiceFactory::CreateHttpServer(const ListenerConfig&
                 std::string response_body;
                 // 获取URL路径
                 std::string path = req.GetUrl().path;
-                options.request_handler(common::network::http::HttpUtils::MethodToString(req.GetMethod()), path, req.GetHeaders(), req.GetBody(), response_body);
+                options.request_handler(common::network::http::HttpUtils::MethodToString(req.GetMethod()), path, common::network::http::HttpUtils::ToHeaderMap(req.GetHeaders()), req.GetBody(), response_body);
                 resp.SetBody(response_body);
                 resp.SetStatusCode(common::network::http::HttpStatusCode::OK);
                 next();
@@ -89,7 +89,7 @@ std::unique_ptr<Service> ServiceFactory::CreateHttpsServer(const ListenerConfig&
                 std::string response_body;
                 // 获取URL路径
                 std::string path = req.GetUrl().path;
-                options.request_handler(common::network::http::HttpUtils::MethodToString(req.GetMethod()), path, req.GetHeaders(), req.GetBody(), response_body);
+                options.request_handler(common::network::http::HttpUtils::MethodToString(req.GetMethod()), path, common::network::http::HttpUtils::ToHeaderMap(req.GetHeaders()), req.GetBody(), response_body);
                 resp.SetBody(response_body);
                 resp.SetStatusCode(common::network::http::HttpStatusCode::OK);
                 next();
@@ -104,6 +104,72 @@ std::unique_ptr<Service> ServiceFactory::CreateHttpsServer(const ListenerConfig&
     }
 }
 
+std::unique_ptr<Service> ServiceFactory::CreateWebSocketServer(const ListenerConfig& config, const TcpServiceOptions& options) {
+    try {
+        auto http_config = CreateHttpServerConfig(config);
+        http_config.enable_compression = false;
+        if (config.type == "wss") {
+            if (!config.ssl.has_value()) {
+                std::cerr << "WSS server requires SSL configuration" << std::endl;
+                return nullptr;
+            }
+            http_config.enable_ssl = true;
+            http_config.ssl_certificate_file = config.ssl->cert_file;
+            http_config.ssl_private_key_file = config.ssl->key_file;
+            http_config.ssl_verify_client = config.ssl->verify_client;
+        }
+        
+        std::string path = "/ws";
+        if (!config.options.empty()) {
+            try {
+                path = config.options.value("path", path);
+                http_config.websocket_permessage_deflate = config.options.value("permessage_deflate", http_config.websocket_permessage_deflate);
+                http_config.websocket_max_message_size = config.options.value("max_message_size", http_config.websocket_max_message_size);
+                http_config.websocket_heartbeat_interval_ms = config.options.value("heartbeat_interval_ms", http_config.websocket_heartbeat_interval_ms);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Error parsing WebSocket server options: " << e.what() << std::endl;
+            }
+        }
+        
+        auto websocket_server = std::make_unique<common::network::http::HttpServer>(executor_, http_config);
+        
+        // 握手完成后按TCP连接的方式挂接回调，处理器返回后连接才开始读取
+        websocket_server->WebSocket(path, [options](std::shared_ptr<common::network::http::WebSocketConnection> conn,
+                                                    const common::network::http::HttpRequest&) {
+            if (options.on_connection) {
+                options.on_connection(conn->GetConnectionId(), conn->GetRemoteEndpoint());
+            }
+            
+            if (options.on_message) {
+                conn->SetDataHandler([options, conn_id = conn->GetConnectionId()](const std::vector<uint8_t>& data) {
+                    options.on_message(conn_id, data);
+                });
+            }
+            
+            if (options.on_error) {
+                conn->SetErrorHandler([options, conn_id = conn->GetConnectionId()](boost::system::error_code ec) {
+                    options.on_error(conn_id, ec);
+                });
+            }
+            
+            if (options.on_disconnect) {
+                conn->SetStateChangeHandler([options, conn_id = conn->GetConnectionId()](
+                        common::network::ConnectionState, common::network::ConnectionState new_state) {
+                    if (new_state == common::network::ConnectionState::DISCONNECTED) {
+                        options.on_disconnect(conn_id, boost::system::error_code());
+                    }
+                });
+            }
+        });
+        
+        return std::make_unique<WebSocketServerAdapter>(config.name, std::move(websocket_server));
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to create WebSocket server: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
 std::unique_ptr<Service> ServiceFactory::CreateKcpAcceptor(const ListenerConfig& config, const KcpServiceOptions& options) {
     try {
         auto kcp_server = std::make_shared<common::network::KcpAcceptor>(executor_, config.port, config.bind);
@@ -151,6 +217,8 @@ std::unique_ptr<Service> ServiceFactory::CreateListener(
         return CreateHttpsServer(config, *http_options);
     } else if (config.type == "kcp" && kcp_options) {
         return CreateKcpAcceptor(config, *kcp_options);
+    } else if ((config.type == "ws" || config.type == "wss") && tcp_options) {
+        return CreateWebSocketServer(config, *tcp_options);
     } else {
         std::cerr << "Unsupported listener type or missing options: " << config.type << std::endl;
         return nullptr;
@@ -272,6 +340,42 @@ ServiceType HttpServerAdapter::GetType() const {
     return is_https_ ? ServiceType::HTTPS_SERVER : ServiceType::HTTP_SERVER;
 }
 
+WebSocketServerAdapter::WebSocketServerAdapter(const std::string& name, std::unique_ptr<common::network::http::HttpServer> server)
+    : name_(name), server_(std::move(server)) {
+}
+
+bool WebSocketServerAdapter::Start() {
+    if (running_.load()) {
+        return true;
+    }
+    
+    bool success = server_->Start();
+    if (success) {
+        running_.store(true);
+    }
+    
+    return success;
+}
+
+void WebSocketServerAdapter::Stop() {
+    if (running_.load()) {
+        server_->Stop();
+        running_.store(false);
+    }
+}
+
+bool WebSocketServerAdapter::IsRunning() const {
+    return running_.load() && server_->IsRunning();
+}
+
+const std::string& WebSocketServerAdapter::GetName() const {
+    return name_;
+}
+
+ServiceType WebSocketServerAdapter::GetType() const {
+    return ServiceType::WEBSOCKET_SERVER;
+}
+
 KcpAcceptorAdapter::KcpAcceptorAdapter(const std::string& name, std::shared_ptr<common::network::KcpAcceptor> server)
     : name_(name), server_(server) {
 }
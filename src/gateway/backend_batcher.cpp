@@ -0,0 +1,222 @@
+#include "gateway/backend_batcher.h"
+#include "common/network/network_logger.h"
+#include <algorithm>
+
+namespace gateway {
+
+namespace {
+// 到达间隔EWMA的平滑系数
+constexpr double kArrivalGapAlpha = 0.2;
+// 预计截止期限内至少到达的帧数，低于该值时等待聚合没有收益
+constexpr double kMinExpectedFramesPerBatch = 2.0;
+// 字节直方图的单位
+constexpr uint64_t kBytesHistogramUnit = 64;
+}
+
+BackendBatcher::BatchStats& BackendBatcher::BatchStats::operator+=(const BatchStats& other) {
+    batches_flushed += other.batches_flushed;
+    frames_batched += other.frames_batched;
+    bytes_batched += other.bytes_batched;
+    flush_by_size += other.flush_by_size;
+    flush_by_deadline += other.flush_by_deadline;
+    flush_immediate += other.flush_immediate;
+    flush_on_close += other.flush_on_close;
+    send_errors += other.send_errors;
+    current_delay_us = std::max(current_delay_us, other.current_delay_us);
+    for (size_t i = 0; i < kHistogramBuckets; ++i) {
+        frames_per_batch[i] += other.frames_per_batch[i];
+        bytes_per_batch[i] += other.bytes_per_batch[i];
+    }
+    return *this;
+}
+
+BackendBatcher::BackendBatcher(std::shared_ptr<common::network::Connection> connection, const Config& config)
+    : connection_(std::move(connection))
+    , config_(config)
+    , timer_(connection_->GetExecutor()) {
+
+    buffer_.reserve(config_.max_batch_bytes);
+    current_delay_us_ = config_.adaptive ? 0 : config_.max_delay_us;
+}
+
+BackendBatcher::~BackendBatcher() {
+    boost::system::error_code ec;
+    timer_.cancel(ec);
+}
+
+void BackendBatcher::Enqueue(const std::vector<uint8_t>& frame) {
+    if (frame.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (closed_) {
+        return;
+    }
+
+    UpdateArrivalLocked(std::chrono::steady_clock::now());
+
+    buffer_.insert(buffer_.end(), frame.begin(), frame.end());
+    pending_frames_++;
+
+    if (buffer_.size() >= config_.max_batch_bytes || pending_frames_ >= config_.max_batch_frames) {
+        FlushLocked(FlushReason::SIZE);
+        return;
+    }
+
+    if (current_delay_us_ == 0) {
+        FlushLocked(FlushReason::IMMEDIATE);
+        return;
+    }
+
+    if (!timer_armed_) {
+        ArmTimerLocked();
+    }
+}
+
+void BackendBatcher::Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FlushLocked(FlushReason::DEADLINE);
+}
+
+void BackendBatcher::Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) {
+        return;
+    }
+
+    FlushLocked(FlushReason::CLOSE);
+    closed_ = true;
+
+    boost::system::error_code ec;
+    timer_.cancel(ec);
+}
+
+BackendBatcher::BatchStats BackendBatcher::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    BatchStats snapshot = stats_;
+    snapshot.current_delay_us = current_delay_us_;
+    return snapshot;
+}
+
+void BackendBatcher::FlushLocked(FlushReason reason) {
+    // 注意：此方法应在已持有锁的情况下调用，保证批次按入队顺序提交
+    if (timer_armed_) {
+        timer_armed_ = false;
+        timer_generation_++;
+        boost::system::error_code ec;
+        timer_.cancel(ec);
+    }
+
+    if (buffer_.empty()) {
+        return;
+    }
+
+    // AsyncSend会复制数据，缓冲区发送后清空即可复用，不必每批重新分配
+    const size_t frames = pending_frames_;
+    const size_t bytes = buffer_.size();
+    pending_frames_ = 0;
+
+    stats_.batches_flushed++;
+    stats_.frames_batched += frames;
+    stats_.bytes_batched += bytes;
+    stats_.frames_per_batch[BucketIndex(frames)]++;
+    stats_.bytes_per_batch[BucketIndex(bytes / kBytesHistogramUnit)]++;
+
+    switch (reason) {
+        case FlushReason::SIZE:
+            stats_.flush_by_size++;
+            break;
+        case FlushReason::DEADLINE:
+            stats_.flush_by_deadline++;
+            break;
+        case FlushReason::IMMEDIATE:
+            stats_.flush_immediate++;
+            break;
+        case FlushReason::CLOSE:
+            stats_.flush_on_close++;
+            break;
+    }
+
+    if (!connection_->IsConnected()) {
+        NETWORK_LOG_WARN("Dropping batch of {} frames ({} bytes) - backend link {} not connected",
+                         frames, bytes, connection_->GetConnectionId());
+        stats_.send_errors++;
+        buffer_.clear();
+        return;
+    }
+
+    auto self = shared_from_this();
+    connection_->AsyncSend(buffer_, [self, frames, bytes](boost::system::error_code ec, size_t) {
+        if (ec) {
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            self->stats_.send_errors++;
+        }
+        if (self->flush_callback_) {
+            self->flush_callback_(ec, frames, bytes);
+        }
+    });
+    buffer_.clear();
+
+    NETWORK_LOG_TRACE("Flushed batch of {} frames ({} bytes) to backend link {}",
+                      frames, bytes, connection_->GetConnectionId());
+}
+
+void BackendBatcher::ArmTimerLocked() {
+    timer_armed_ = true;
+    const uint64_t generation = ++timer_generation_;
+
+    auto self = shared_from_this();
+    timer_.expires_after(std::chrono::microseconds(current_delay_us_));
+    timer_.async_wait([self, generation](boost::system::error_code ec) {
+        self->HandleTimer(ec, generation);
+    });
+}
+
+void BackendBatcher::HandleTimer(boost::system::error_code ec, uint64_t generation) {
+    if (ec == boost::asio::error::operation_aborted) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // 定时器已被尺寸刷新取代
+    if (!timer_armed_ || generation != timer_generation_) {
+        return;
+    }
+
+    FlushLocked(FlushReason::DEADLINE);
+}
+
+void BackendBatcher::UpdateArrivalLocked(std::chrono::steady_clock::time_point now) {
+    if (!config_.adaptive) {
+        return;
+    }
+
+    if (last_arrival_ != std::chrono::steady_clock::time_point{}) {
+        const double gap_us = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - last_arrival_).count());
+        arrival_gap_ewma_us_ = arrival_gap_ewma_us_ == 0.0
+            ? gap_us
+            : kArrivalGapAlpha * gap_us + (1.0 - kArrivalGapAlpha) * arrival_gap_ewma_us_;
+
+        // 截止期限内预计能聚合到足够多的帧时才等待，否则直接发送以保证空闲延迟最小
+        const double expected_frames = arrival_gap_ewma_us_ > 0.0
+            ? config_.max_delay_us / arrival_gap_ewma_us_
+            : kMinExpectedFramesPerBatch;
+        current_delay_us_ = expected_frames >= kMinExpectedFramesPerBatch ? config_.max_delay_us : 0;
+    }
+    last_arrival_ = now;
+}
+
+size_t BackendBatcher::BucketIndex(uint64_t value) {
+    size_t index = 0;
+    while (value > 0 && index < kHistogramBuckets - 1) {
+        value >>= 1;
+        index++;
+    }
+    return index;
+}
+
+} // namespace gateway
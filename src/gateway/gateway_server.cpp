@@ -10,8 +10,11 @@ namespace gateway {
 GatewayServer::GatewayServer(boost::asio::any_io_executor executor, const GatewayConfig& config)
     : executor_(executor)
     , config_(config)
+    , start_time_(std::chrono::steady_clock::now())
     , cleanup_timer_(std::make_unique<boost::asio::steady_timer>(executor)) {
     
+    ConfigureProtocolRouter();
+    
 #ifdef ZEUS_USE_KCP
     NETWORK_LOG_INFO("Gateway server created - Protocol: KCP, Port: {}", config_.listen_port);
 #else
@@ -58,6 +61,11 @@ bool GatewayServer::Start() {
         }
 #endif
         
+        if (config_.websocket_enabled && !StartWebSocketListener()) {
+            NETWORK_LOG_ERROR("Failed to start WebSocket listener");
+            return false;
+        }
+        
         running_ = true;
         
         // 启动清理定时器
@@ -99,6 +107,11 @@ void GatewayServer::Stop() {
         kcp_acceptor_.reset();
     }
     
+    if (websocket_server_) {
+        websocket_server_->Stop();
+        websocket_server_.reset();
+    }
+    
     // 关闭所有会话
     CloseAllSessions();
     
@@ -110,6 +123,36 @@ void GatewayServer::Stop() {
     NETWORK_LOG_INFO("Gateway server stopped");
 }
 
+bool GatewayServer::StartWebSocketListener() {
+    common::network::http::HttpServerConfig http_config;
+    http_config.bind_address = config_.bind_address;
+    http_config.port = config_.websocket_port;
+    http_config.max_connections = config_.max_client_connections;
+    http_config.enable_compression = false;
+    http_config.websocket_permessage_deflate = config_.websocket_permessage_deflate;
+    http_config.websocket_max_message_size = config_.websocket_max_message_bytes;
+    // ping/pong使用与其他客户端连接相同的心跳间隔
+    http_config.websocket_heartbeat_interval_ms = config_.heartbeat_interval_ms;
+    
+    websocket_server_ = std::make_unique<common::network::http::HttpServer>(executor_, http_config);
+    
+    // 握手完成的连接与TCP/KCP连接走同一条会话创建流程
+    websocket_server_->WebSocket(config_.websocket_path,
+        [this](std::shared_ptr<common::network::http::WebSocketConnection> conn,
+               const common::network::http::HttpRequest&) {
+            OnClientConnection(std::static_pointer_cast<common::network::Connection>(conn));
+        });
+    
+    if (!websocket_server_->Start()) {
+        websocket_server_.reset();
+        return false;
+    }
+    
+    NETWORK_LOG_INFO("Gateway WebSocket listener started on {}:{}{}", 
+                    config_.bind_address, config_.websocket_port, config_.websocket_path);
+    return true;
+}
+
 void GatewayServer::OnClientConnection(std::shared_ptr<common::network::Connection> connection) {
     if (!running_) {
         NETWORK_LOG_WARN("Rejecting client connection - server is shutting down");
@@ -121,34 +164,157 @@ void GatewayServer::OnClientConnection(std::shared_ptr<common::network::Connecti
     std::string session_id = GenerateSessionId();
     
     // 创建会话
-    auto session = std::make_shared<GatewaySession>(session_id, connection);
+    GatewaySession::Options options;
+    options.rate_limit_config = config_.rate_limit_config;
+    options.violation_handler = [this](SessionRateLimiter::Action action) {
+        OnRateLimitViolation(action);
+    };
+    options.resume_config = config_.resume_config;
+    if (config_.resume_config.enabled) {
+        options.resume_handler = [this](GatewaySession& session, const std::string& token, uint64_t client_offset,
+                                        const std::vector<uint8_t>& early_data) {
+            return HandleResumeRequest(session, token, client_offset, early_data);
+        };
+    }
+    options.route_table = protocol_router_.GetRouteTable();
+    options.max_frame_bytes = config_.routing_config.max_frame_bytes;
     
-    // 选择后端服务器
-    std::string backend_endpoint = SelectBackendServer();
-    if (backend_endpoint.empty()) {
-        NETWORK_LOG_ERROR("No backend servers available for session {}", session_id);
+    // 恢复请求只能是第一条消息：先等待首条消息，避免恢复成功的临时会话白白建立后端连接
+    if (config_.resume_config.enabled) {
+        options.backend_connector = [this](GatewaySession& session) {
+            return ConnectSessionToBackend(session);
+        };
+    }
+    auto session = std::make_shared<GatewaySession>(session_id, connection, std::move(options));
+    
+    if (!config_.resume_config.enabled && !ConnectSessionToBackend(*session)) {
         connection->Close();
         return;
     }
     
-    // 连接到后端
-    session->ConnectToBackend(backend_endpoint, executor_, config_);
-    
     // 存储会话
     {
         std::lock_guard<std::mutex> lock(sessions_mutex_);
         sessions_[session_id] = session;
+        if (!session->GetResumeToken().empty()) {
+            resume_tokens_[std::string(ResumeFrame::GetTokenId(session->GetResumeToken()))] = session_id;
+        }
+        stats_.active_sessions.store(sessions_.size(), std::memory_order_relaxed);
     }
     
     // 更新统计
+    stats_.total_sessions_created.fetch_add(1, std::memory_order_relaxed);
+    
+    NETWORK_LOG_INFO("New client session created: {}", session_id);
+}
+
+bool GatewayServer::ConnectSessionToBackend(GatewaySession& session) {
+    // 选择后端服务器
+    std::string backend_endpoint = SelectBackendServer();
+    if (backend_endpoint.empty()) {
+        NETWORK_LOG_ERROR("No backend servers available for session {}", session.GetSessionId());
+        return false;
+    }
+    
+    // 为每个路由集群选择后端，空集群的消息回落到默认后端
+    std::unordered_map<std::string, std::string> cluster_endpoints;
+    if (protocol_router_.GetRouteTable()) {
+        for (const auto& cluster : protocol_router_.GetClusterNames()) {
+            std::string endpoint = protocol_router_.SelectClusterServer(cluster);
+            if (!endpoint.empty()) {
+                cluster_endpoints.emplace(cluster, std::move(endpoint));
+            }
+        }
+    }
+    
+    // 连接到后端
+    session.ConnectToBackend(backend_endpoint, executor_, config_, cluster_endpoints);
+    
+    NETWORK_LOG_INFO("Session {} -> Backend: {}", session.GetSessionId(), backend_endpoint);
+    return true;
+}
+
+void GatewayServer::OnRateLimitViolation(SessionRateLimiter::Action action) {
+    switch (action) {
+        case SessionRateLimiter::Action::DROP:
+            stats_.rate_limit_dropped.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case SessionRateLimiter::Action::DELAY:
+            stats_.rate_limit_delayed.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case SessionRateLimiter::Action::DISCONNECT:
+            stats_.rate_limit_disconnects.fetch_add(1, std::memory_order_relaxed);
+            break;
+    }
+}
+
+bool GatewayServer::HandleResumeRequest(GatewaySession& session, const std::string& token, uint64_t client_offset,
+                                        const std::vector<uint8_t>& early_data) {
+    std::shared_ptr<GatewaySession> parked_session;
     {
-        std::lock_guard<std::mutex> lock(stats_mutex_);
-        stats_.total_sessions_created++;
-        stats_.active_sessions = sessions_.size();
+        // 按令牌标识查找，令牌本身由会话做常量时间比较
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        auto token_it = resume_tokens_.find(std::string(ResumeFrame::GetTokenId(token)));
+        if (token_it != resume_tokens_.end()) {
+            auto session_it = sessions_.find(token_it->second);
+            if (session_it != sessions_.end()) {
+                parked_session = session_it->second;
+            }
+        }
+    }
+    
+    auto client_connection = session.GetClientConnection();
+    if (!parked_session || parked_session.get() == &session || !client_connection ||
+        !parked_session->MatchesResumeToken(token) ||
+        !parked_session->Resume(client_connection, client_offset, early_data)) {
+        stats_.session_resume_failures.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
     
-    NETWORK_LOG_INFO("New client session created: {} -> Backend: {}", 
-                     session_id, backend_endpoint);
+    // 客户端连接已由挂起的会话接管，新会话只需释放其后端连接，由清理定时器回收
+    session.DetachClientConnection();
+    session.Close();
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        EraseResumeTokenLocked(session);
+    }
+    
+    stats_.sessions_resumed.fetch_add(1, std::memory_order_relaxed);
+    
+    NETWORK_LOG_INFO("Client reattached to session {} (replacing {})",
+                     parked_session->GetSessionId(), session.GetSessionId());
+    return true;
+}
+
+void GatewayServer::RemoveSessionLocked(
+    std::unordered_map<std::string, std::shared_ptr<GatewaySession>>::iterator it) {
+    // 注意：此方法应在已持有sessions_mutex_的情况下调用
+    it->second->Close();
+    EraseResumeTokenLocked(*it->second);
+    
+    // 移除前将会话计数并入累计值，汇总统计时不丢失
+    const auto session_stats = it->second->GetStats();
+    stats_.retired_messages_processed.fetch_add(
+        session_stats.client_messages_received + session_stats.backend_messages_received,
+        std::memory_order_relaxed);
+    stats_.retired_bytes_processed.fetch_add(
+        session_stats.client_bytes_received + session_stats.backend_bytes_received,
+        std::memory_order_relaxed);
+    
+    sessions_.erase(it);
+    stats_.active_sessions.store(sessions_.size(), std::memory_order_relaxed);
+}
+
+void GatewayServer::EraseResumeTokenLocked(const GatewaySession& session) {
+    // 注意：此方法应在已持有sessions_mutex_的情况下调用
+    if (session.GetResumeToken().empty()) {
+        return;
+    }
+    // 标识理论上可能重复，只删除指向本会话的映射
+    auto it = resume_tokens_.find(std::string(ResumeFrame::GetTokenId(session.GetResumeToken())));
+    if (it != resume_tokens_.end() && it->second == session.GetSessionId()) {
+        resume_tokens_.erase(it);
+    }
 }
 
 std::string GatewayServer::GenerateSessionId() {
@@ -164,14 +330,36 @@ std::string GatewayServer::SelectBackendServer() {
 
 void GatewayServer::UpdateConfig(const GatewayConfig& config) {
     config_ = config;
+    ConfigureProtocolRouter();
     
+    NETWORK_LOG_INFO("Gateway configuration updated");
+}
+
+void GatewayServer::ConfigureProtocolRouter() {
     // 更新后端服务器列表到协议路由器
     protocol_router_.ClearBackendServers();
     for (const auto& server : config_.backend_servers) {
         protocol_router_.AddBackendServer(server);
     }
     
-    NETWORK_LOG_INFO("Gateway configuration updated");
+    // 已建立的会话继续使用创建时的路由表快照
+    protocol_router_.ClearClusters();
+    if (!config_.routing_config.enabled) {
+        return;
+    }
+    
+    for (const auto& cluster : config_.routing_config.clusters) {
+        protocol_router_.AddCluster(cluster.name, cluster.strategy);
+        for (const auto& server : cluster.servers) {
+            protocol_router_.AddClusterServer(cluster.name, server);
+        }
+        for (const auto& [first_opcode, last_opcode] : cluster.opcode_ranges) {
+            if (!protocol_router_.AddOpcodeRoute(first_opcode, last_opcode, cluster.name)) {
+                NETWORK_LOG_ERROR("Invalid or overlapping opcode route [{}, {}] for cluster {}",
+                                  first_opcode, last_opcode, cluster.name);
+            }
+        }
+    }
 }
 
 size_t GatewayServer::GetActiveSessionCount() const {
@@ -189,8 +377,7 @@ void GatewayServer::CloseSession(const std::string& session_id) {
     std::lock_guard<std::mutex> lock(sessions_mutex_);
     auto it = sessions_.find(session_id);
     if (it != sessions_.end()) {
-        it->second->Close();
-        sessions_.erase(it);
+        RemoveSessionLocked(it);
     }
 }
 
@@ -199,7 +386,46 @@ void GatewayServer::CloseAllSessions() {
     for (auto& [session_id, session] : sessions_) {
         session->Close();
     }
-    sessions_.clear();
+    while (!sessions_.empty()) {
+        RemoveSessionLocked(sessions_.begin());
+    }
+    resume_tokens_.clear();
+}
+
+GatewayServer::GatewayStats GatewayServer::GetStats() const {
+    GatewayStats snapshot;
+    snapshot.total_sessions_created = stats_.total_sessions_created.load(std::memory_order_relaxed);
+    snapshot.active_sessions = stats_.active_sessions.load(std::memory_order_relaxed);
+    snapshot.backend_connections_active = stats_.backend_connections_active.load(std::memory_order_relaxed);
+    snapshot.backend_connections_failed = stats_.backend_connections_failed.load(std::memory_order_relaxed);
+    snapshot.rate_limit_dropped = stats_.rate_limit_dropped.load(std::memory_order_relaxed);
+    snapshot.rate_limit_delayed = stats_.rate_limit_delayed.load(std::memory_order_relaxed);
+    snapshot.rate_limit_disconnects = stats_.rate_limit_disconnects.load(std::memory_order_relaxed);
+    snapshot.sessions_resumed = stats_.sessions_resumed.load(std::memory_order_relaxed);
+    snapshot.session_resume_failures = stats_.session_resume_failures.load(std::memory_order_relaxed);
+    snapshot.start_time = start_time_;
+    
+    // 消息与字节总数由各会话计数器汇总，转发路径不触碰全局计数
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    snapshot.total_messages_processed = stats_.retired_messages_processed.load(std::memory_order_relaxed);
+    snapshot.total_bytes_processed = stats_.retired_bytes_processed.load(std::memory_order_relaxed);
+    for (const auto& [session_id, session] : sessions_) {
+        const auto session_stats = session->GetStats();
+        snapshot.total_messages_processed +=
+            session_stats.client_messages_received + session_stats.backend_messages_received;
+        snapshot.total_bytes_processed +=
+            session_stats.client_bytes_received + session_stats.backend_bytes_received;
+    }
+    return snapshot;
+}
+
+BackendBatcher::BatchStats GatewayServer::GetBatchStats() const {
+    BackendBatcher::BatchStats total;
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    for (const auto& [session_id, session] : sessions_) {
+        total += session->GetBatchStats();
+    }
+    return total;
 }
 
 // 后端服务器管理方法已移至 ProtocolRouter
@@ -237,9 +463,17 @@ void GatewayServer::CleanupInactiveSessions() {
         auto now = std::chrono::steady_clock::now();
         
         for (const auto& [session_id, session] : sessions_) {
+            // 挂起的会话只受恢复宽限期约束
+            if (session->IsParked()) {
+                if (session->IsParkExpired(now)) {
+                    sessions_to_remove.push_back(session_id);
+                }
+                continue;
+            }
+            
             if (!session->IsActive() || 
                 std::chrono::duration_cast<std::chrono::milliseconds>(
-                    now - session->GetStats().last_activity).count() > config_.client_timeout_ms) {
+                    now - session->GetLastActivity()).count() > config_.client_timeout_ms) {
                 sessions_to_remove.push_back(session_id);
             }
         }
@@ -248,17 +482,13 @@ void GatewayServer::CleanupInactiveSessions() {
         for (const auto& session_id : sessions_to_remove) {
             auto it = sessions_.find(session_id);
             if (it != sessions_.end()) {
-                it->second->Close();
-                sessions_.erase(it);
+                RemoveSessionLocked(it);
                 NETWORK_LOG_DEBUG("Cleaned up inactive session: {}", session_id);
             }
         }
     }
     
-    // 更新统计
     if (!sessions_to_remove.empty()) {
-        std::lock_guard<std::mutex> lock(stats_mutex_);
-        stats_.active_sessions = sessions_.size();
         NETWORK_LOG_DEBUG("Cleaned up {} inactive sessions", sessions_to_remove.size());
     }
 }
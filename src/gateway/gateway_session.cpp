@@ -6,22 +6,65 @@
 
 namespace gateway {
 
+namespace {
+// 延迟连接后端期间最多暂存的客户端消息数
+constexpr size_t kMaxPendingBackendMessages = 256;
+}
+
 // GatewaySession 实现
 GatewaySession::GatewaySession(const std::string& session_id, 
                                std::shared_ptr<common::network::Connection> client_conn)
+    : GatewaySession(session_id, std::move(client_conn), Options{}) {
+}
+
+GatewaySession::GatewaySession(const std::string& session_id, 
+                               std::shared_ptr<common::network::Connection> client_conn,
+                               Options options)
     : session_id_(session_id)
-    , client_connection_(client_conn)
-    , active_(true) {
+    , active_(true)
+    , backend_connector_(std::move(options.backend_connector))
+    , created_time_(std::chrono::steady_clock::now())
+    , violation_handler_(std::move(options.violation_handler))
+    , resume_config_(options.resume_config)
+    , resume_handler_(std::move(options.resume_handler))
+    , route_table_(std::move(options.route_table))
+    , max_frame_bytes_(options.max_frame_bytes) {
+    
+    const auto& rate_limit_config = options.rate_limit_config;
+    
+    // 限流器需在注册数据处理器之前创建
+    if (rate_limit_config.enabled && client_conn) {
+        rate_limiter_ = std::make_unique<SessionRateLimiter>(rate_limit_config);
+        if (rate_limit_config.action == SessionRateLimiter::Action::DELAY) {
+            delay_timer_ = std::make_unique<boost::asio::steady_timer>(client_conn->GetExecutor());
+        }
+    }
+    
+    if (resume_config_.enabled) {
+        resume_token_ = ResumeFrame::GenerateToken();
+        if (resume_token_.empty()) {
+            NETWORK_LOG_ERROR("Failed to generate resume token for session {}, resume disabled", session_id_);
+        }
+    }
+    
+    // 按操作码路由需要先从客户端字节流中拆出完整帧
+    if (route_table_ && !route_table_->Empty()) {
+        client_decoder_ = std::make_unique<MessageFrameDecoder>(max_frame_bytes_);
+    } else {
+        route_table_.reset();
+    }
+    
+    UpdateLastActivity();
     
     // 设置客户端连接的事件处理器
-    if (client_connection_) {
-        client_connection_->SetDataHandler([this](const std::vector<uint8_t>& data) {
-            OnClientMessage(data);
-        });
+    if (client_conn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        AttachClientConnectionLocked(client_conn);
         
-        client_connection_->SetErrorHandler([this](boost::system::error_code ec) {
-            OnClientDisconnected(ec);
-        });
+        // 延迟连接时令牌在确认不是恢复请求后下发，恢复成功的临时会话不会用到
+        if (!backend_connector_) {
+            SendResumeTokenLocked();
+        }
     }
     
     NETWORK_LOG_INFO("Gateway session created: {}", session_id_);
@@ -34,47 +77,524 @@ GatewaySession::~GatewaySession() {
 
 bool GatewaySession::IsActive() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return active_ && client_connection_ && client_connection_->IsConnected();
+    return active_ && (parked_ || (client_connection_ && client_connection_->IsConnected()));
 }
 
 void GatewaySession::Close() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    active_ = false;
+    std::shared_ptr<common::network::Connection> client_connection;
+    std::vector<std::shared_ptr<common::network::Connection>> backend_connections;
+    std::vector<std::shared_ptr<BackendBatcher>> backend_batchers;
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!active_) {
+            return;
+        }
+        active_ = false;
+        parked_ = false;
+        
+        if (delay_timer_) {
+            delay_timer_->cancel();
+            delay_timer_armed_ = false;
+        }
+        delayed_messages_.clear();
+        pending_backend_messages_.clear();
+        resume_probe_buffer_.clear();
+        backend_connecting_.store(false, std::memory_order_relaxed);
+        backend_connector_ = nullptr;
+        replay_buffer_.clear();
+        replay_bytes_ = 0;
+        
+        client_connection = client_connection_;
+        if (backend_link_.connection) {
+            backend_connections.push_back(backend_link_.connection);
+            backend_batchers.push_back(backend_link_.batcher);
+        }
+        for (const auto& [cluster, link] : cluster_links_) {
+            backend_connections.push_back(link.connection);
+            backend_batchers.push_back(link.batcher);
+        }
+    }
     
-    if (client_connection_) {
-        client_connection_->Close();
+    // 关闭连接可能同步触发状态回调，必须在锁外进行
+    if (client_connection) {
+        client_connection->Close();
     }
     
-    if (backend_connection_) {
-        backend_connection_->Close();
+    // 先提交聚合中的数据再关闭后端连接
+    for (const auto& backend_batcher : backend_batchers) {
+        if (backend_batcher) {
+            backend_batcher->Close();
+        }
+    }
+    
+    for (const auto& backend_connection : backend_connections) {
+        backend_connection->Close();
     }
     
     NETWORK_LOG_INFO("Gateway session closed: {}", session_id_);
 }
 
+std::shared_ptr<common::network::Connection> GatewaySession::GetClientConnection() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return client_connection_;
+}
+
+void GatewaySession::AttachClientConnectionLocked(std::shared_ptr<common::network::Connection> client_conn) {
+    // 注意：此方法应在已持有锁的情况下调用
+    client_connection_ = std::move(client_conn);
+    
+    // 旧连接的回调可能在会话恢复后仍被触发，按连接身份过滤
+    const common::network::Connection* conn = client_connection_.get();
+    current_client_.store(conn, std::memory_order_release);
+    
+    client_connection_->SetDataHandler([this, conn](const std::vector<uint8_t>& data) {
+        if (current_client_.load(std::memory_order_acquire) == conn) {
+            OnClientMessage(data);
+        }
+    });
+    
+    client_connection_->SetErrorHandler([this, conn](boost::system::error_code ec) {
+        if (current_client_.load(std::memory_order_acquire) == conn) {
+            OnClientDisconnected(ec);
+        }
+    });
+    
+    // 对端正常关闭不会触发错误回调，可恢复会话需要监听状态变化以便及时挂起
+    if (resume_config_.enabled) {
+        client_connection_->SetStateChangeHandler(
+            [this, conn](common::network::ConnectionState, common::network::ConnectionState new_state) {
+                if (new_state == common::network::ConnectionState::DISCONNECTED &&
+                    current_client_.load(std::memory_order_acquire) == conn) {
+                    OnClientDisconnected(boost::asio::error::eof);
+                }
+            });
+    }
+}
+
+std::shared_ptr<common::network::Connection> GatewaySession::DetachClientConnection() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto client_connection = std::move(client_connection_);
+    client_connection_.reset();
+    current_client_.store(nullptr, std::memory_order_release);
+    return client_connection;
+}
+
+bool GatewaySession::IsParked() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return parked_;
+}
+
+bool GatewaySession::IsParkExpired(std::chrono::steady_clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return parked_ && std::chrono::duration_cast<std::chrono::milliseconds>(
+        now - parked_since_).count() > resume_config_.grace_period_ms;
+}
+
+bool GatewaySession::Park() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (!active_) {
+        return false;
+    }
+    if (parked_) {
+        return true;
+    }
+    if (!resume_config_.enabled || !backend_link_.connection || !backend_link_.connection->IsConnected()) {
+        return false;
+    }
+    
+    parked_ = true;
+    parked_since_ = std::chrono::steady_clock::now();
+    parked_offset_ = downstream_offset_;
+    client_connection_.reset();
+    current_client_.store(nullptr, std::memory_order_release);
+    
+    NETWORK_LOG_INFO("Gateway session parked: {} (downstream offset {}, grace {}ms)",
+                     session_id_, parked_offset_, resume_config_.grace_period_ms);
+    return true;
+}
+
+bool GatewaySession::Resume(std::shared_ptr<common::network::Connection> client_conn, uint64_t client_offset,
+                            const std::vector<uint8_t>& early_data) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    
+        if (!active_ || !parked_ || !client_conn) {
+            return false;
+        }
+    
+        // 客户端缺失的数据已被挤出重放缓冲区，无法无损恢复
+        if (client_offset < replay_start_offset_ || client_offset > downstream_offset_) {
+            NETWORK_LOG_WARN("Cannot resume session {}: client offset {} outside replay window [{}, {}]",
+                             session_id_, client_offset, replay_start_offset_, downstream_offset_);
+            return false;
+        }
+    
+        AttachClientConnectionLocked(std::move(client_conn));
+        parked_ = false;
+    
+        // 旧连接上未收完的半帧已无法补齐
+        if (client_decoder_) {
+            client_decoder_->Reset();
+        }
+        stats_.resumes.fetch_add(1, std::memory_order_relaxed);
+    
+        ResumeFrame frame;
+        frame.type = ResumeFrame::Type::RESUMED;
+        frame.offset = downstream_offset_ - client_offset;
+        client_connection_->AsyncSend(frame.Encode());
+    
+        // 按原帧边界重放客户端未收到的下行数据
+        uint64_t frame_start = replay_start_offset_;
+        for (const auto& data : replay_buffer_) {
+            const uint64_t frame_end = frame_start + data.size();
+            if (frame_end > client_offset) {
+                const size_t skip = client_offset > frame_start ? static_cast<size_t>(client_offset - frame_start) : 0;
+                client_connection_->AsyncSend(std::vector<uint8_t>(data.begin() + skip, data.end()));
+            }
+            frame_start = frame_end;
+        }
+    
+        NETWORK_LOG_INFO("Gateway session resumed: {} (replayed {} bytes)", session_id_, frame.offset);
+    }
+    
+    // 与恢复请求一起到达的数据排在重放之后，作为新连接上的第一条普通消息处理
+    if (!early_data.empty()) {
+        OnClientMessage(early_data);
+    }
+    return true;
+}
+
+void GatewaySession::ProbeResumeRequest(const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> regular;
+    std::optional<ResumeFrame> frame;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (resume_probe_done_.load(std::memory_order_relaxed)) {
+            regular = data;
+        } else {
+            resume_probe_buffer_.insert(resume_probe_buffer_.end(), data.begin(), data.end());
+            if (resume_deciding_) {
+                // 接管结果确定后与恢复请求之后的其余数据一起处理
+                return;
+            }
+            
+            const uint8_t* bytes = resume_probe_buffer_.data();
+            const size_t size = resume_probe_buffer_.size();
+            if (!ResumeFrame::MayBeResumeRequest(bytes, size)) {
+                regular = std::move(resume_probe_buffer_);
+                resume_probe_buffer_.clear();
+                resume_probe_done_.store(true, std::memory_order_release);
+            } else if (size < ResumeFrame::kResumeRequestSize) {
+                return;
+            } else {
+                // 只消费恢复请求这一帧，其后的字节留在缓冲区
+                frame = ResumeFrame::Decode(bytes, ResumeFrame::kResumeRequestSize);
+                resume_probe_buffer_.erase(resume_probe_buffer_.begin(),
+                                           resume_probe_buffer_.begin() + ResumeFrame::kResumeRequestSize);
+                resume_deciding_ = true;
+            }
+        }
+    }
+    
+    if (frame) {
+        auto client_connection = GetClientConnection();
+        if (!client_connection) {
+            return;
+        }
+        // 接管操作会替换连接的数据回调，不能在回调执行过程中进行
+        boost::asio::post(client_connection->GetExecutor(), [this, frame = std::move(*frame)]() {
+            DecideResume(frame);
+        });
+        return;
+    }
+    
+    // 不是恢复请求：作为新会话连接后端，暂存的字节按普通数据处理
+    StartDeferredBackend();
+    ProcessClientData(regular);
+}
+
+void GatewaySession::DecideResume(const ResumeFrame& frame) {
+    auto client_connection = GetClientConnection();
+    std::vector<uint8_t> early_data;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!active_ || !client_connection) {
+            return;
+        }
+        early_data = std::move(resume_probe_buffer_);
+        resume_probe_buffer_.clear();
+        resume_deciding_ = false;
+        resume_probe_done_.store(true, std::memory_order_release);
+    }
+    
+    if (resume_handler_(*this, frame.token, frame.offset, early_data)) {
+        return;
+    }
+    
+    NETWORK_LOG_INFO("Resume rejected for session {}, continuing as new session", session_id_);
+    ResumeFrame reply;
+    reply.type = ResumeFrame::Type::REJECTED;
+    client_connection->AsyncSend(reply.Encode());
+    StartDeferredBackend();
+    if (!early_data.empty()) {
+        ProcessClientData(early_data);
+    }
+}
+
+bool GatewaySession::MatchesResumeToken(const std::string& token) const {
+    return ResumeFrame::TokenEquals(resume_token_, token);
+}
+
+void GatewaySession::SendResumeTokenLocked() {
+    // 注意：此方法应在已持有锁的情况下调用
+    // 下发恢复令牌，客户端断线重连时凭此令牌恢复会话
+    if (!resume_config_.enabled || resume_token_.empty() || !client_connection_) {
+        return;
+    }
+    ResumeFrame frame;
+    frame.type = ResumeFrame::Type::TOKEN;
+    frame.token = resume_token_;
+    client_connection_->AsyncSend(frame.Encode());
+}
+
+void GatewaySession::StartDeferredBackend() {
+    BackendConnector connector;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!active_ || !backend_connector_) {
+            return;
+        }
+        connector = std::move(backend_connector_);
+        backend_connector_ = nullptr;
+        backend_connecting_.store(true, std::memory_order_release);
+        SendResumeTokenLocked();
+    }
+    
+    // 连接器会调用ConnectToBackend，必须在锁外执行
+    if (!connector(*this)) {
+        Close();
+    }
+}
+
+void GatewaySession::OnDefaultBackendConnected(boost::system::error_code ec) {
+    if (!backend_connecting_.load(std::memory_order_acquire)) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!backend_connecting_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    
+    // 在锁内按序转发暂存消息，新到的消息等待锁释放后排在其后
+    if (ec) {
+        if (!pending_backend_messages_.empty()) {
+            NETWORK_LOG_WARN("Dropping {} pending client messages in session {} - backend connect failed",
+                             pending_backend_messages_.size(), session_id_);
+        }
+    } else if (active_) {
+        for (const auto& data : pending_backend_messages_) {
+            DispatchToBackend(data);
+        }
+    }
+    pending_backend_messages_.clear();
+    backend_connecting_.store(false, std::memory_order_release);
+}
+
+bool GatewaySession::RecordDownstreamLocked(const std::vector<uint8_t>& data) {
+    // 注意：此方法应在已持有锁的情况下调用
+    replay_buffer_.push_back(data);
+    replay_bytes_ += data.size();
+    downstream_offset_ += data.size();
+    
+    while (replay_bytes_ > resume_config_.max_replay_bytes && !replay_buffer_.empty()) {
+        replay_start_offset_ += replay_buffer_.front().size();
+        replay_bytes_ -= replay_buffer_.front().size();
+        replay_buffer_.pop_front();
+    }
+    
+    // 挂起期间客户端最多收到parked_offset_之前的数据，超出重放窗口后已无法恢复
+    return !parked_ || replay_start_offset_ <= parked_offset_;
+}
+
 void GatewaySession::OnClientMessage(const std::vector<uint8_t>& data) {
     UpdateLastActivity();
+    stats_.client_messages_received.fetch_add(1, std::memory_order_relaxed);
+    stats_.client_bytes_received.fetch_add(data.size(), std::memory_order_relaxed);
     
+    NETWORK_LOG_TRACE("Client message received in session {}: {} bytes", session_id_, data.size());
+    
+    // 恢复请求只能出现在新连接的最前面
+    if (resume_handler_ && !resume_probe_done_.load(std::memory_order_acquire)) {
+        ProbeResumeRequest(data);
+        return;
+    }
+    
+    ProcessClientData(data);
+}
+
+void GatewaySession::ProcessClientData(const std::vector<uint8_t>& data) {
+    if (!client_decoder_) {
+        if (rate_limiter_ && !AdmitClientMessage(data)) {
+            return;
+        }
+        
+        // 转发到后端
+        ForwardToBackend(data);
+        return;
+    }
+    
+    // 路由模式下按完整帧限流和转发
+    std::vector<std::vector<uint8_t>> frames;
+    const bool valid = client_decoder_->Feed(data, frames);
+    for (const auto& frame : frames) {
+        if (rate_limiter_ && !AdmitClientMessage(frame)) {
+            continue;
+        }
+        ForwardToBackend(frame);
+    }
+    
+    if (!valid) {
+        NETWORK_LOG_WARN("Oversized frame from client in session {}, closing", session_id_);
+        Close();
+    }
+}
+
+bool GatewaySession::AdmitClientMessage(const std::vector<uint8_t>& data) {
+    const auto& config = rate_limiter_->GetConfig();
+    const bool delay_action = config.action == SessionRateLimiter::Action::DELAY;
+    
+    auto decision = rate_limiter_->Acquire(data.size(), delay_action
+        ? std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(config.max_delay_ms))
+        : std::chrono::nanoseconds{0});
+    
+    if (!decision.allowed) {
+        stats_.rate_limited_messages.fetch_add(1, std::memory_order_relaxed);
+        stats_.rate_limited_dropped.fetch_add(1, std::memory_order_relaxed);
+        
+        if (config.action == SessionRateLimiter::Action::DISCONNECT) {
+            NETWORK_LOG_WARN("Client in session {} exceeded rate limit, disconnecting", session_id_);
+            NotifyRateLimitViolation(SessionRateLimiter::Action::DISCONNECT);
+            Close();
+        } else {
+            NETWORK_LOG_DEBUG("Client message dropped by rate limit in session {}: {} bytes", session_id_, data.size());
+            NotifyRateLimitViolation(SessionRateLimiter::Action::DROP);
+        }
+        return false;
+    }
+    
+    if (!delay_action) {
+        return true;
+    }
+    
+    bool queued = false;
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        stats_.client_messages_received++;
-        stats_.client_bytes_received += data.size();
+        
+        // 已有排队消息或定时器正在转发时必须排在其后以保持顺序
+        if (decision.delay.count() == 0 && delayed_messages_.empty() && !delay_draining_) {
+            return true;
+        }
+        
+        stats_.rate_limited_messages.fetch_add(1, std::memory_order_relaxed);
+        if (active_ && delayed_messages_.size() < config.max_delayed_messages) {
+            delayed_messages_.push_back({std::chrono::steady_clock::now() + decision.delay, data});
+            if (!delay_timer_armed_ && !delay_draining_) {
+                ArmDelayTimerLocked();
+            }
+            queued = true;
+        }
     }
     
-    NETWORK_LOG_TRACE("Client message received in session {}: {} bytes", session_id_, data.size());
+    if (queued) {
+        stats_.rate_limited_delayed.fetch_add(1, std::memory_order_relaxed);
+        NotifyRateLimitViolation(SessionRateLimiter::Action::DELAY);
+    } else {
+        // 令牌已在Acquire中扣减，消息未转发需归还，否则会拉长之后消息的延迟
+        rate_limiter_->Refund(data.size());
+        stats_.rate_limited_dropped.fetch_add(1, std::memory_order_relaxed);
+        NETWORK_LOG_DEBUG("Delay queue full in session {}, dropping {} bytes", session_id_, data.size());
+        NotifyRateLimitViolation(SessionRateLimiter::Action::DROP);
+    }
+    return false;
+}
+
+void GatewaySession::ArmDelayTimerLocked() {
+    // 注意：此方法应在已持有锁的情况下调用
+    delay_timer_armed_ = true;
+    delay_timer_->expires_at(delayed_messages_.front().ready_time);
+    delay_timer_->async_wait([this](boost::system::error_code ec) {
+        HandleDelayTimer(ec);
+    });
+}
+
+void GatewaySession::HandleDelayTimer(boost::system::error_code ec) {
+    if (ec == boost::asio::error::operation_aborted) {
+        return;
+    }
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    delay_timer_armed_ = false;
+    if (!active_) {
+        return;
+    }
     
-    // 转发到后端
-    ForwardToBackend(data);
+    // 定时器不在连接的strand上，转发期间保持排空标记，
+    // 使并发到达的新消息继续排队，由本循环按顺序转发
+    delay_draining_ = true;
+    std::vector<std::vector<uint8_t>> ready;
+    for (;;) {
+        auto now = std::chrono::steady_clock::now();
+        while (!delayed_messages_.empty() && delayed_messages_.front().ready_time <= now) {
+            ready.push_back(std::move(delayed_messages_.front().data));
+            delayed_messages_.pop_front();
+        }
+        if (ready.empty()) {
+            break;
+        }
+        
+        lock.unlock();
+        for (const auto& data : ready) {
+            ForwardToBackend(data);
+        }
+        ready.clear();
+        lock.lock();
+        
+        if (!active_) {
+            delay_draining_ = false;
+            return;
+        }
+    }
+    delay_draining_ = false;
+    
+    if (!delayed_messages_.empty()) {
+        ArmDelayTimerLocked();
+    }
+}
+
+void GatewaySession::NotifyRateLimitViolation(SessionRateLimiter::Action action) {
+    // 注意：此方法不能在持有锁的情况下调用
+    if (violation_handler_) {
+        violation_handler_(action);
+    }
 }
 
 void GatewaySession::OnClientDisconnected(boost::system::error_code ec) {
     NETWORK_LOG_INFO("Client disconnected from session {}: {}", session_id_, ec.message());
+    
+    // 可恢复会话保留后端连接，等待客户端重连
+    if (Park()) {
+        return;
+    }
     Close();
 }
 
 void GatewaySession::ConnectToBackend(const std::string& backend_endpoint, 
                                      boost::asio::any_io_executor executor,
-                                     const GatewayConfig& config) {
+                                     const GatewayConfig& config,
+                                     const std::unordered_map<std::string, std::string>& cluster_endpoints) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     if (!active_) {
@@ -82,53 +602,114 @@ void GatewaySession::ConnectToBackend(const std::string& backend_endpoint,
         return;
     }
     
+    // 后端链路发布后转发路径无锁读取，不允许再替换
+    if (backend_link_.connection) {
+        NETWORK_LOG_WARN("Backend already connected for session {}", session_id_);
+        return;
+    }
+    
     try {
-        // 根据编译时宏选择协议
-#ifdef ZEUS_USE_KCP
-        auto kcp_conn = std::make_shared<common::network::KcpConnector>(
-            executor, session_id_ + "_backend", config.kcp_config);
-        backend_connection_ = kcp_conn;
-#else
-        auto tcp_conn = std::make_shared<common::network::TcpConnector>(
-            executor, session_id_ + "_backend");
-        backend_connection_ = tcp_conn;
-#endif
-        
-        // 设置后端连接的事件处理器
-        backend_connection_->SetDataHandler([this](const std::vector<uint8_t>& data) {
-            OnBackendMessage(data);
-        });
+        backend_link_ = CreateBackendLinkLocked(session_id_ + "_backend", backend_endpoint, executor, config, true);
         
-        backend_connection_->SetErrorHandler([this](boost::system::error_code ec) {
-            OnBackendDisconnected(ec);
-        });
+        // 每个路由集群使用独立链路，热点服务的流量不会阻塞其他服务
+        if (route_table_) {
+            for (const auto& [cluster, endpoint] : cluster_endpoints) {
+                cluster_links_.emplace(cluster, CreateBackendLinkLocked(
+                    session_id_ + "_" + cluster, endpoint, executor, config, false));
+            }
+        }
         
-        // 连接到后端
-        backend_connection_->AsyncConnect(backend_endpoint, 
-            [this, backend_endpoint](boost::system::error_code ec) {
-                if (ec) {
-                    NETWORK_LOG_ERROR("Failed to connect to backend {} for session {}: {}", 
-                                    backend_endpoint, session_id_, ec.message());
-                } else {
-                    NETWORK_LOG_INFO("Connected to backend {} for session {}", 
-                                    backend_endpoint, session_id_);
-                }
-            });
+        backend_ready_.store(true, std::memory_order_release);
             
     } catch (const std::exception& e) {
         NETWORK_LOG_ERROR("Exception connecting to backend for session {}: {}", session_id_, e.what());
     }
 }
 
-void GatewaySession::OnBackendMessage(const std::vector<uint8_t>& data) {
-    UpdateLastActivity();
+GatewaySession::BackendLink GatewaySession::CreateBackendLinkLocked(const std::string& name,
+                                                                    const std::string& endpoint,
+                                                                    boost::asio::any_io_executor executor,
+                                                                    const GatewayConfig& config,
+                                                                    bool is_default) {
+    // 注意：此方法应在已持有锁的情况下调用
+    BackendLink link;
     
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        stats_.backend_messages_received++;
-        stats_.backend_bytes_received += data.size();
+    // 根据编译时宏选择协议
+#ifdef ZEUS_USE_KCP
+    link.connection = std::make_shared<common::network::KcpConnector>(executor, name, config.kcp_config);
+#else
+    link.connection = std::make_shared<common::network::TcpConnector>(executor, name);
+#endif
+    
+    if (route_table_) {
+        link.decoder = std::make_unique<MessageFrameDecoder>(max_frame_bytes_);
     }
     
+    // 设置后端连接的事件处理器
+    MessageFrameDecoder* decoder = link.decoder.get();
+    link.connection->SetDataHandler([this, decoder](const std::vector<uint8_t>& data) {
+        OnBackendData(decoder, data);
+    });
+    
+    link.connection->SetErrorHandler([this](boost::system::error_code ec) {
+        OnBackendDisconnected(ec);
+    });
+    
+    // 启用后端链路消息聚合，链路归本会话所有，聚合不跨会话
+    if (config.batch_config.enabled) {
+        link.batcher = std::make_shared<BackendBatcher>(link.connection, config.batch_config);
+        link.batcher->SetFlushCallback([this](boost::system::error_code ec, size_t frames, size_t bytes) {
+            if (ec) {
+                NETWORK_LOG_ERROR("Failed to forward batch to backend in session {}: {}", session_id_, ec.message());
+                return;
+            }
+            stats_.backend_messages_sent.fetch_add(frames, std::memory_order_relaxed);
+            stats_.backend_bytes_sent.fetch_add(bytes, std::memory_order_relaxed);
+        });
+    }
+    
+    // 连接到后端
+    link.connection->AsyncConnect(endpoint, 
+        [this, endpoint, is_default](boost::system::error_code ec) {
+            if (ec) {
+                NETWORK_LOG_ERROR("Failed to connect to backend {} for session {}: {}", 
+                                endpoint, session_id_, ec.message());
+            } else {
+                NETWORK_LOG_INFO("Connected to backend {} for session {}", 
+                                endpoint, session_id_);
+            }
+            if (is_default) {
+                OnDefaultBackendConnected(ec);
+            }
+        });
+    
+    return link;
+}
+
+void GatewaySession::OnBackendData(MessageFrameDecoder* decoder, const std::vector<uint8_t>& data) {
+    if (!decoder) {
+        OnBackendMessage(data);
+        return;
+    }
+    
+    // 多个后端的下行数据汇入同一客户端连接，只能以完整帧为单位交错
+    std::vector<std::vector<uint8_t>> frames;
+    const bool valid = decoder->Feed(data, frames);
+    for (const auto& frame : frames) {
+        OnBackendMessage(frame);
+    }
+    
+    if (!valid) {
+        NETWORK_LOG_ERROR("Oversized frame from backend in session {}, closing", session_id_);
+        Close();
+    }
+}
+
+void GatewaySession::OnBackendMessage(const std::vector<uint8_t>& data) {
+    UpdateLastActivity();
+    stats_.backend_messages_received.fetch_add(1, std::memory_order_relaxed);
+    stats_.backend_bytes_received.fetch_add(data.size(), std::memory_order_relaxed);
+    
     NETWORK_LOG_TRACE("Backend message received in session {}: {} bytes", session_id_, data.size());
     
     // 转发到客户端
@@ -142,46 +723,163 @@ void GatewaySession::OnBackendDisconnected(boost::system::error_code ec) {
 }
 
 void GatewaySession::ForwardToBackend(const std::vector<uint8_t>& data) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    // 延迟连接的后端尚未就绪时暂存，连接成功后按序转发
+    if (backend_connecting_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (backend_connecting_.load(std::memory_order_relaxed)) {
+            if (pending_backend_messages_.size() < kMaxPendingBackendMessages) {
+                pending_backend_messages_.push_back(data);
+            } else {
+                NETWORK_LOG_WARN("Pending backend queue full in session {}, dropping {} bytes", session_id_, data.size());
+            }
+            return;
+        }
+    }
     
-    if (!backend_connection_ || !backend_connection_->IsConnected()) {
+    DispatchToBackend(data);
+}
+
+void GatewaySession::DispatchToBackend(const std::vector<uint8_t>& data) {
+    // 后端链路发布后不再改变，无需加锁
+    if (!backend_ready_.load(std::memory_order_acquire)) {
         NETWORK_LOG_WARN("Cannot forward to backend - no active backend connection in session {}", session_id_);
         return;
     }
     
-    backend_connection_->AsyncSend(data, [this](boost::system::error_code ec, size_t bytes_sent) {
+    const BackendLink& link = RouteMessage(data);
+    if (!link.connection->IsConnected()) {
+        NETWORK_LOG_WARN("Cannot forward to backend - no active backend connection in session {}", session_id_);
+        return;
+    }
+    
+    if (link.batcher) {
+        link.batcher->Enqueue(data);
+        return;
+    }
+    
+    link.connection->AsyncSend(data, [this](boost::system::error_code ec, size_t bytes_sent) {
         if (ec) {
             NETWORK_LOG_ERROR("Failed to forward message to backend in session {}: {}", session_id_, ec.message());
         } else {
-            stats_.backend_messages_sent++;
-            stats_.backend_bytes_sent += bytes_sent;
+            stats_.backend_messages_sent.fetch_add(1, std::memory_order_relaxed);
+            stats_.backend_bytes_sent.fetch_add(bytes_sent, std::memory_order_relaxed);
             NETWORK_LOG_TRACE("Forwarded {} bytes to backend in session {}", bytes_sent, session_id_);
         }
     });
 }
 
 void GatewaySession::ForwardToClient(const std::vector<uint8_t>& data) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    // 未启用会话恢复时客户端连接不会被替换，转发路径无需加锁
+    if (!resume_config_.enabled) {
+        SendToClient(client_connection_, data);
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        if (!active_ || RecordDownstreamLocked(data)) {
+            // 挂起期间只缓存，待客户端恢复后重放
+            if (parked_) {
+                return;
+            }
+            
+            // 在锁内投递以保证与恢复重放的下行顺序一致
+            SendToClient(client_connection_, data);
+            return;
+        }
+    }
     
-    if (!client_connection_ || !client_connection_->IsConnected()) {
+    NETWORK_LOG_WARN("Replay buffer overflowed while session {} was parked, closing", session_id_);
+    Close();
+}
+
+void GatewaySession::SendToClient(const std::shared_ptr<common::network::Connection>& client_connection,
+                                  const std::vector<uint8_t>& data) {
+    if (!client_connection || !client_connection->IsConnected()) {
         NETWORK_LOG_WARN("Cannot forward to client - no active client connection in session {}", session_id_);
         return;
     }
     
-    client_connection_->AsyncSend(data, [this](boost::system::error_code ec, size_t bytes_sent) {
+    client_connection->AsyncSend(data, [this](boost::system::error_code ec, size_t bytes_sent) {
         if (ec) {
             NETWORK_LOG_ERROR("Failed to forward message to client in session {}: {}", session_id_, ec.message());
         } else {
-            stats_.client_messages_sent++;
-            stats_.client_bytes_sent += bytes_sent;
+            stats_.client_messages_sent.fetch_add(1, std::memory_order_relaxed);
+            stats_.client_bytes_sent.fetch_add(bytes_sent, std::memory_order_relaxed);
             NETWORK_LOG_TRACE("Forwarded {} bytes to client in session {}", bytes_sent, session_id_);
         }
     });
 }
 
+const GatewaySession::BackendLink& GatewaySession::RouteMessage(const std::vector<uint8_t>& data) const {
+    if (!route_table_) {
+        return backend_link_;
+    }
+    
+    auto header = MessageHeader::Parse(data.data(), data.size());
+    if (!header) {
+        return backend_link_;
+    }
+    
+    // 未配置路由或该会话未连接对应集群的消息发往默认后端
+    const std::string* cluster = route_table_->Resolve(header->opcode);
+    if (!cluster) {
+        return backend_link_;
+    }
+    
+    auto it = cluster_links_.find(*cluster);
+    return it != cluster_links_.end() ? it->second : backend_link_;
+}
+
+BackendBatcher::BatchStats GatewaySession::GetBatchStats() const {
+    BackendBatcher::BatchStats total;
+    if (!backend_ready_.load(std::memory_order_acquire)) {
+        return total;
+    }
+    
+    if (backend_link_.batcher) {
+        total += backend_link_.batcher->GetStats();
+    }
+    for (const auto& [cluster, link] : cluster_links_) {
+        if (link.batcher) {
+            total += link.batcher->GetStats();
+        }
+    }
+    return total;
+}
+
+GatewaySession::SessionStats GatewaySession::GetStats() const {
+    SessionStats snapshot;
+    snapshot.client_messages_received = stats_.client_messages_received.load(std::memory_order_relaxed);
+    snapshot.client_bytes_received = stats_.client_bytes_received.load(std::memory_order_relaxed);
+    snapshot.backend_messages_sent = stats_.backend_messages_sent.load(std::memory_order_relaxed);
+    snapshot.backend_bytes_sent = stats_.backend_bytes_sent.load(std::memory_order_relaxed);
+    snapshot.backend_messages_received = stats_.backend_messages_received.load(std::memory_order_relaxed);
+    snapshot.backend_bytes_received = stats_.backend_bytes_received.load(std::memory_order_relaxed);
+    snapshot.client_messages_sent = stats_.client_messages_sent.load(std::memory_order_relaxed);
+    snapshot.client_bytes_sent = stats_.client_bytes_sent.load(std::memory_order_relaxed);
+    snapshot.rate_limited_messages = stats_.rate_limited_messages.load(std::memory_order_relaxed);
+    snapshot.rate_limited_delayed = stats_.rate_limited_delayed.load(std::memory_order_relaxed);
+    snapshot.rate_limited_dropped = stats_.rate_limited_dropped.load(std::memory_order_relaxed);
+    snapshot.resumes = stats_.resumes.load(std::memory_order_relaxed);
+    snapshot.created_time = created_time_;
+    snapshot.last_activity = GetLastActivity();
+    return snapshot;
+}
+
+std::chrono::steady_clock::time_point GatewaySession::GetLastActivity() const {
+    return std::chrono::steady_clock::time_point(
+        std::chrono::milliseconds(stats_.last_activity_ms.load(std::memory_order_relaxed)));
+}
+
 void GatewaySession::UpdateLastActivity() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    stats_.last_activity = std::chrono::steady_clock::now();
+    // 毫秒精度足以支撑超时判定，同一毫秒内的重复写入会在多核间来回争用缓存行
+    const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (stats_.last_activity_ms.load(std::memory_order_relaxed) != now_ms) {
+        stats_.last_activity_ms.store(now_ms, std::memory_order_relaxed);
+    }
 }
 
 } // namespace gateway
\ No newline at end of file
@@ -16,6 +16,7 @@
 #include <thread>
 #include <chrono>
 #include <filesystem>
+#include <limits>
 #include <nlohmann/json.hpp>
 
 using namespace core::app;
@@ -77,6 +78,67 @@ bool GatewayInitHook(Application& app) {
             gateway_config.backend_timeout_ms = gateway_json.value("timeouts", nlohmann::json{}).value("backend_timeout_ms", 30000);
             gateway_config.heartbeat_interval_ms = gateway_json.value("timeouts", nlohmann::json{}).value("heartbeat_interval_ms", 30000);
             
+            // 加载WebSocket接入配置
+            const auto websocket_json = gateway_json.value("websocket", nlohmann::json::object());
+            gateway_config.websocket_enabled = websocket_json.value("enabled", false);
+            gateway_config.websocket_port = websocket_json.value("port", 8090);
+            gateway_config.websocket_path = websocket_json.value("path", "/ws");
+            gateway_config.websocket_permessage_deflate = websocket_json.value("permessage_deflate", true);
+            gateway_config.websocket_max_message_bytes = websocket_json.value("max_message_bytes", 65536);
+            
+            // 加载后端链路消息聚合配置
+            const auto batching_json = gateway_json.value("batching", nlohmann::json::object());
+            gateway_config.batch_config.enabled = batching_json.value("enabled", false);
+            gateway_config.batch_config.max_batch_bytes = batching_json.value("max_batch_bytes", 16384);
+            gateway_config.batch_config.max_batch_frames = batching_json.value("max_batch_frames", 64);
+            gateway_config.batch_config.max_delay_us = batching_json.value("max_delay_us", 500);
+            gateway_config.batch_config.adaptive = batching_json.value("adaptive", true);
+            
+            // 加载客户端报文限流配置
+            const auto rate_limit_json = gateway_json.value("rate_limit", nlohmann::json::object());
+            gateway_config.rate_limit_config.enabled = rate_limit_json.value("enabled", false);
+            gateway_config.rate_limit_config.messages_per_second = rate_limit_json.value("messages_per_second", 200);
+            gateway_config.rate_limit_config.message_burst = rate_limit_json.value("message_burst", 400);
+            gateway_config.rate_limit_config.bytes_per_second = rate_limit_json.value("bytes_per_second", 262144);
+            gateway_config.rate_limit_config.byte_burst = rate_limit_json.value("byte_burst", 524288);
+            gateway_config.rate_limit_config.action = SessionRateLimiter::ParseAction(rate_limit_json.value("action", "drop"));
+            gateway_config.rate_limit_config.max_delay_ms = rate_limit_json.value("max_delay_ms", 200);
+            gateway_config.rate_limit_config.max_delayed_messages = rate_limit_json.value("max_delayed_messages", 256);
+            
+            // 加载断线会话恢复配置
+            const auto resume_json = gateway_json.value("session_resume", nlohmann::json::object());
+            gateway_config.resume_config.enabled = resume_json.value("enabled", false);
+            gateway_config.resume_config.grace_period_ms = resume_json.value("grace_period_ms", 30000);
+            gateway_config.resume_config.max_replay_bytes = resume_json.value("max_replay_bytes", 262144);
+            
+            // 加载操作码路由配置
+            const auto routing_json = gateway_json.value("routing", nlohmann::json::object());
+            gateway_config.routing_config.enabled = routing_json.value("enabled", false);
+            gateway_config.routing_config.max_frame_bytes = routing_json.value("max_frame_bytes", 65536);
+            for (const auto& cluster_json : routing_json.value("clusters", nlohmann::json::array())) {
+                BackendClusterConfig cluster;
+                cluster.name = cluster_json.value("name", "");
+                cluster.strategy = ProtocolRouter::ParseStrategy(cluster_json.value("load_balance_strategy", "round_robin"));
+                cluster.servers = cluster_json.value("servers", std::vector<std::string>{});
+                for (const auto& range : cluster_json.value("opcodes", nlohmann::json::array())) {
+                    // 区间为[lo, hi]整数对，按有符号读取后再检查，避免越界值被截断成其他操作码
+                    if (!range.is_array() || range.size() != 2 ||
+                        !range[0].is_number_integer() || !range[1].is_number_integer()) {
+                        std::cerr << "❌ 路由集群 " << cluster.name << " 的操作码区间格式错误: " << range.dump() << std::endl;
+                        return false;
+                    }
+                    const int64_t lo = range[0].get<int64_t>();
+                    const int64_t hi = range[1].get<int64_t>();
+                    if (lo < 0 || lo > hi || hi > std::numeric_limits<uint16_t>::max()) {
+                        std::cerr << "❌ 路由集群 " << cluster.name << " 的操作码区间无效: " << range.dump()
+                                  << "（要求 0 <= lo <= hi <= 65535）" << std::endl;
+                        return false;
+                    }
+                    cluster.opcode_ranges.emplace_back(static_cast<uint16_t>(lo), static_cast<uint16_t>(hi));
+                }
+                gateway_config.routing_config.clusters.push_back(std::move(cluster));
+            }
+            
             // 加载后端服务器列表
             if (gateway_json.contains("backend_servers") && gateway_json["backend_servers"].is_array()) {
                 for (const auto& server : gateway_json["backend_servers"]) {
@@ -0,0 +1,59 @@
+#include "gateway/message_frame.h"
+
+namespace gateway {
+
+std::optional<MessageHeader> MessageHeader::Parse(const uint8_t* data, size_t size) {
+    if (size < kSize) {
+        return std::nullopt;
+    }
+
+    MessageHeader header;
+    header.body_length = (static_cast<uint32_t>(data[0]) << 24) |
+                         (static_cast<uint32_t>(data[1]) << 16) |
+                         (static_cast<uint32_t>(data[2]) << 8) |
+                         static_cast<uint32_t>(data[3]);
+    header.opcode = static_cast<uint16_t>((data[4] << 8) | data[5]);
+    return header;
+}
+
+MessageFrameDecoder::MessageFrameDecoder(size_t max_frame_bytes)
+    : max_frame_bytes_(max_frame_bytes) {
+}
+
+bool MessageFrameDecoder::Feed(const std::vector<uint8_t>& data, std::vector<std::vector<uint8_t>>& frames) {
+    // 缓冲区为空时直接在输入上分帧，只有尾部半帧需要拷贝
+    const std::vector<uint8_t>* source = &data;
+    if (!buffer_.empty()) {
+        buffer_.insert(buffer_.end(), data.begin(), data.end());
+        source = &buffer_;
+    }
+
+    size_t pos = 0;
+    while (true) {
+        auto header = MessageHeader::Parse(source->data() + pos, source->size() - pos);
+        if (!header) {
+            break;
+        }
+
+        const size_t frame_size = MessageHeader::kSize + static_cast<size_t>(header->body_length);
+        if (frame_size > max_frame_bytes_) {
+            buffer_.clear();
+            return false;
+        }
+        if (source->size() - pos < frame_size) {
+            break;
+        }
+
+        frames.emplace_back(source->begin() + pos, source->begin() + pos + frame_size);
+        pos += frame_size;
+    }
+
+    if (source == &buffer_) {
+        buffer_.erase(buffer_.begin(), buffer_.begin() + pos);
+    } else {
+        buffer_.assign(data.begin() + pos, data.end());
+    }
+    return true;
+}
+
+} // namespace gateway
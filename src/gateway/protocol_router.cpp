@@ -1,9 +1,42 @@
 #include "gateway/protocol_router.h"
 #include <algorithm>
+#include <iterator>
 #include <random>
 
 namespace gateway {
 
+bool OpcodeRouteTable::AddRoute(uint16_t first_opcode, uint16_t last_opcode, const std::string& cluster) {
+    if (first_opcode > last_opcode || cluster.empty()) {
+        return false;
+    }
+
+    auto it = std::lower_bound(routes_.begin(), routes_.end(), first_opcode,
+        [](const Route& route, uint16_t opcode) { return route.first_opcode < opcode; });
+
+    // 与前后相邻区间均不重叠才能插入
+    if (it != routes_.end() && it->first_opcode <= last_opcode) {
+        return false;
+    }
+    if (it != routes_.begin() && std::prev(it)->last_opcode >= first_opcode) {
+        return false;
+    }
+
+    routes_.insert(it, Route{first_opcode, last_opcode, cluster});
+    return true;
+}
+
+const std::string* OpcodeRouteTable::Resolve(uint16_t opcode) const {
+    // 找到最后一个first_opcode <= opcode的区间
+    auto it = std::upper_bound(routes_.begin(), routes_.end(), opcode,
+        [](uint16_t value, const Route& route) { return value < route.first_opcode; });
+    if (it == routes_.begin()) {
+        return nullptr;
+    }
+
+    --it;
+    return opcode <= it->last_opcode ? &it->cluster : nullptr;
+}
+
 ProtocolRouter::ProtocolRouter(LoadBalanceStrategy strategy) 
     : strategy_(strategy) {
 }
@@ -43,24 +76,7 @@ void ProtocolRouter::ClearBackendServers() {
 
 std::string ProtocolRouter::SelectBackendServer() {
     std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (backend_servers_.empty()) {
-        return "";
-    }
-
-    switch (strategy_) {
-        case LoadBalanceStrategy::ROUND_ROBIN:
-            return SelectRoundRobin();
-        
-        case LoadBalanceStrategy::RANDOM:
-            return SelectRandom();
-        
-        case LoadBalanceStrategy::LEAST_CONNECTIONS:
-            return SelectLeastConnections();
-        
-        default:
-            return SelectRoundRobin();
-    }
+    return Select(strategy_, backend_servers_, round_robin_index_);
 }
 
 size_t ProtocolRouter::GetBackendServerCount() const {
@@ -83,33 +99,140 @@ ProtocolRouter::LoadBalanceStrategy ProtocolRouter::GetLoadBalanceStrategy() con
     return strategy_;
 }
 
-std::string ProtocolRouter::SelectRoundRobin() {
+void ProtocolRouter::AddCluster(const std::string& name, LoadBalanceStrategy strategy) {
+    if (name.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    clusters_[name].strategy = strategy;
+}
+
+void ProtocolRouter::AddClusterServer(const std::string& cluster, const std::string& endpoint) {
+    if (endpoint.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = clusters_.find(cluster);
+    if (it == clusters_.end()) {
+        return;
+    }
+
+    auto& servers = it->second.servers;
+    if (std::find(servers.begin(), servers.end(), endpoint) == servers.end()) {
+        servers.push_back(endpoint);
+    }
+}
+
+std::vector<std::string> ProtocolRouter::GetClusterNames() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<std::string> names;
+    names.reserve(clusters_.size());
+    for (const auto& [name, cluster] : clusters_) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+void ProtocolRouter::ClearClusters() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clusters_.clear();
+    route_table_.reset();
+}
+
+std::string ProtocolRouter::SelectClusterServer(const std::string& cluster) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = clusters_.find(cluster);
+    if (it == clusters_.end()) {
+        return "";
+    }
+    return Select(it->second.strategy, it->second.servers, it->second.round_robin_index);
+}
+
+bool ProtocolRouter::AddOpcodeRoute(uint16_t first_opcode, uint16_t last_opcode, const std::string& cluster) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (clusters_.find(cluster) == clusters_.end()) {
+        return false;
+    }
+
+    // 已发布的路由表可能正被会话使用，修改时复制一份新表
+    auto table = route_table_ ? std::make_shared<OpcodeRouteTable>(*route_table_)
+                              : std::make_shared<OpcodeRouteTable>();
+    if (!table->AddRoute(first_opcode, last_opcode, cluster)) {
+        return false;
+    }
+
+    route_table_ = std::move(table);
+    return true;
+}
+
+std::shared_ptr<const OpcodeRouteTable> ProtocolRouter::GetRouteTable() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return route_table_;
+}
+
+ProtocolRouter::LoadBalanceStrategy ProtocolRouter::ParseStrategy(const std::string& name) {
+    if (name == "random") {
+        return LoadBalanceStrategy::RANDOM;
+    }
+    if (name == "least_connections") {
+        return LoadBalanceStrategy::LEAST_CONNECTIONS;
+    }
+    return LoadBalanceStrategy::ROUND_ROBIN;
+}
+
+std::string ProtocolRouter::Select(LoadBalanceStrategy strategy, const std::vector<std::string>& servers, size_t& index) {
+    // 注意：此方法应在已持有锁的情况下调用
+    if (servers.empty()) {
+        return "";
+    }
+
+    switch (strategy) {
+        case LoadBalanceStrategy::ROUND_ROBIN:
+            return SelectRoundRobin(servers, index);
+        
+        case LoadBalanceStrategy::RANDOM:
+            return SelectRandom(servers);
+        
+        case LoadBalanceStrategy::LEAST_CONNECTIONS:
+            return SelectLeastConnections(servers, index);
+        
+        default:
+            return SelectRoundRobin(servers, index);
+    }
+}
+
+std::string ProtocolRouter::SelectRoundRobin(const std::vector<std::string>& servers, size_t& index) {
     // 注意：此方法应在已持有锁的情况下调用
-    if (backend_servers_.empty()) {
+    if (servers.empty()) {
         return "";
     }
     
-    size_t index = round_robin_index_.fetch_add(1) % backend_servers_.size();
-    return backend_servers_[index];
+    return servers[index++ % servers.size()];
 }
 
-std::string ProtocolRouter::SelectRandom() {
+std::string ProtocolRouter::SelectRandom(const std::vector<std::string>& servers) {
     // 注意：此方法应在已持有锁的情况下调用
-    if (backend_servers_.empty()) {
+    if (servers.empty()) {
         return "";
     }
     
     static thread_local std::random_device rd;
     static thread_local std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, backend_servers_.size() - 1);
+    std::uniform_int_distribution<size_t> dis(0, servers.size() - 1);
     
-    return backend_servers_[dis(gen)];
+    return servers[dis(gen)];
 }
 
-std::string ProtocolRouter::SelectLeastConnections() {
+std::string ProtocolRouter::SelectLeastConnections(const std::vector<std::string>& servers, size_t& index) {
     // 注意：此方法应在已持有锁的情况下调用
     // 简化实现 - 使用轮询算法
-    return SelectRoundRobin();
+    return SelectRoundRobin(servers, index);
 }
 
-} // namespace gateway
\ No newline at end of file
+} // namespace gateway
@@ -0,0 +1,116 @@
+#include "gateway/session_rate_limiter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace gateway {
+
+SessionRateLimiter::SessionRateLimiter(const Config& config)
+    : config_(config) {
+    message_bucket_.Configure(config_.messages_per_second, config_.message_burst);
+    byte_bucket_.Configure(static_cast<double>(config_.bytes_per_second),
+                           static_cast<double>(config_.byte_burst));
+}
+
+SessionRateLimiter::Decision SessionRateLimiter::Acquire(size_t bytes, std::chrono::nanoseconds max_delay) {
+    Decision decision;
+
+    if (!config_.enabled) {
+        decision.allowed = true;
+        return decision;
+    }
+
+    const int64_t now = NowNs();
+    const int64_t max_delay_ns = max_delay.count();
+
+    int64_t message_wait = 0;
+    if (message_bucket_.Enabled()) {
+        message_wait = message_bucket_.Acquire(now, 1.0, max_delay_ns);
+        if (message_wait < 0) {
+            return decision;
+        }
+    }
+
+    int64_t byte_wait = 0;
+    if (byte_bucket_.Enabled()) {
+        byte_wait = byte_bucket_.Acquire(now, ByteCost(bytes), max_delay_ns);
+        if (byte_wait < 0) {
+            if (message_bucket_.Enabled()) {
+                message_bucket_.Refund(1.0);
+            }
+            return decision;
+        }
+    }
+
+    decision.allowed = true;
+    decision.delay = std::chrono::nanoseconds(std::max(message_wait, byte_wait));
+    return decision;
+}
+
+void SessionRateLimiter::Refund(size_t bytes) {
+    if (!config_.enabled) {
+        return;
+    }
+    if (message_bucket_.Enabled()) {
+        message_bucket_.Refund(1.0);
+    }
+    if (byte_bucket_.Enabled()) {
+        byte_bucket_.Refund(ByteCost(bytes));
+    }
+}
+
+SessionRateLimiter::Action SessionRateLimiter::ParseAction(const std::string& name) {
+    if (name == "delay") {
+        return Action::DELAY;
+    }
+    if (name == "disconnect") {
+        return Action::DISCONNECT;
+    }
+    return Action::DROP;
+}
+
+double SessionRateLimiter::ByteCost(size_t bytes) const {
+    // 超过突发容量的大消息按清空整个桶计费，避免永远无法通过
+    return std::min(static_cast<double>(bytes), std::max(static_cast<double>(config_.byte_burst), 1.0));
+}
+
+int64_t SessionRateLimiter::NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SessionRateLimiter::Bucket::Configure(double rate_per_second, double burst) {
+    if (rate_per_second <= 0.0) {
+        emission_interval_ns_ = 0.0;
+        tolerance_ns_ = 0;
+        return;
+    }
+
+    emission_interval_ns_ = 1e9 / rate_per_second;
+    // 突发容量至少为1个令牌，否则任何消息都无法通过
+    tolerance_ns_ = static_cast<int64_t>(emission_interval_ns_ * std::max(burst, 1.0));
+}
+
+int64_t SessionRateLimiter::Bucket::Acquire(int64_t now_ns, double cost, int64_t max_delay_ns) {
+    const int64_t increment = static_cast<int64_t>(std::ceil(emission_interval_ns_ * cost));
+    int64_t tat = tat_ns_.load(std::memory_order_relaxed);
+
+    while (true) {
+        const int64_t new_tat = std::max(tat, now_ns) + increment;
+        const int64_t wait = new_tat - tolerance_ns_ - now_ns;
+
+        if (wait > max_delay_ns) {
+            return -1;
+        }
+
+        if (tat_ns_.compare_exchange_weak(tat, new_tat, std::memory_order_relaxed)) {
+            return std::max<int64_t>(wait, 0);
+        }
+    }
+}
+
+void SessionRateLimiter::Bucket::Refund(double cost) {
+    const int64_t increment = static_cast<int64_t>(std::ceil(emission_interval_ns_ * cost));
+    tat_ns_.fetch_sub(increment, std::memory_order_relaxed);
+}
+
+} // namespace gateway
@@ -0,0 +1,127 @@
+#include "gateway/session_resume.h"
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+#include <algorithm>
+
+namespace gateway {
+
+namespace {
+constexpr uint8_t kMagic[4] = {'Z', 'R', 'S', 'M'};
+constexpr size_t kHeaderSize = ResumeFrame::kHeaderSize;
+static_assert(kHeaderSize == sizeof(kMagic) + 1, "magic followed by the type byte");
+
+void AppendUint64(std::vector<uint8_t>& out, uint64_t value) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+uint64_t ReadUint64(const uint8_t* data, size_t pos) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        value = (value << 8) | data[pos + i];
+    }
+    return value;
+}
+}
+
+std::vector<uint8_t> ResumeFrame::Encode() const {
+    std::vector<uint8_t> out(kMagic, kMagic + sizeof(kMagic));
+    out.push_back(static_cast<uint8_t>(type));
+
+    switch (type) {
+        case Type::TOKEN:
+            out.insert(out.end(), token.begin(), token.end());
+            break;
+        case Type::RESUME_REQUEST:
+            out.insert(out.end(), token.begin(), token.end());
+            AppendUint64(out, offset);
+            break;
+        case Type::RESUMED:
+            AppendUint64(out, offset);
+            break;
+        case Type::REJECTED:
+            break;
+    }
+    return out;
+}
+
+std::optional<ResumeFrame> ResumeFrame::Decode(const std::vector<uint8_t>& data) {
+    return Decode(data.data(), data.size());
+}
+
+std::optional<ResumeFrame> ResumeFrame::Decode(const uint8_t* data, size_t size) {
+    if (size < kHeaderSize || !std::equal(kMagic, kMagic + sizeof(kMagic), data)) {
+        return std::nullopt;
+    }
+
+    ResumeFrame frame;
+    const size_t payload = size - kHeaderSize;
+    const char* body = reinterpret_cast<const char*>(data + kHeaderSize);
+
+    switch (static_cast<Type>(data[sizeof(kMagic)])) {
+        case Type::TOKEN:
+            if (payload != kTokenLength) {
+                return std::nullopt;
+            }
+            frame.type = Type::TOKEN;
+            frame.token.assign(body, kTokenLength);
+            return frame;
+        case Type::RESUME_REQUEST:
+            if (payload != kTokenLength + 8) {
+                return std::nullopt;
+            }
+            frame.type = Type::RESUME_REQUEST;
+            frame.token.assign(body, kTokenLength);
+            frame.offset = ReadUint64(data, kHeaderSize + kTokenLength);
+            return frame;
+        case Type::RESUMED:
+            if (payload != 8) {
+                return std::nullopt;
+            }
+            frame.type = Type::RESUMED;
+            frame.offset = ReadUint64(data, kHeaderSize);
+            return frame;
+        case Type::REJECTED:
+            if (payload != 0) {
+                return std::nullopt;
+            }
+            frame.type = Type::REJECTED;
+            return frame;
+    }
+    return std::nullopt;
+}
+
+bool ResumeFrame::MayBeResumeRequest(const uint8_t* data, size_t size) {
+    const uint8_t header[kHeaderSize] = {kMagic[0], kMagic[1], kMagic[2], kMagic[3],
+                                         static_cast<uint8_t>(Type::RESUME_REQUEST)};
+    return std::equal(data, data + std::min(size, kHeaderSize), header);
+}
+
+std::string ResumeFrame::GenerateToken() {
+    static const char kHex[] = "0123456789abcdef";
+
+    // 令牌即会话凭据，必须不可预测
+    uint8_t bytes[kTokenLength / 2];
+    if (RAND_bytes(bytes, sizeof(bytes)) != 1) {
+        return {};
+    }
+
+    std::string token;
+    token.reserve(kTokenLength);
+    for (uint8_t byte : bytes) {
+        token.push_back(kHex[byte >> 4]);
+        token.push_back(kHex[byte & 0xF]);
+    }
+    return token;
+}
+
+bool ResumeFrame::TokenEquals(std::string_view expected, std::string_view actual) {
+    // 令牌长度固定，长度不同可直接判定
+    if (expected.size() != actual.size() || expected.empty()) {
+        return false;
+    }
+    return CRYPTO_memcmp(expected.data(), actual.data(), expected.size()) == 0;
+}
+
+} // namespace gateway
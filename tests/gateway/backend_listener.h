@@ -0,0 +1,88 @@
+/**
+ * @file backend_listener.h
+ * @brief 网关测试用后端：在本地端口接受连接并累积收到的数据
+ */
+
+#pragma once
+
+#include <boost/asio.hpp>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gateway {
+namespace test {
+
+class BackendListener {
+public:
+    explicit BackendListener(boost::asio::io_context& io_context)
+        : acceptor_(io_context, {boost::asio::ip::make_address("127.0.0.1"), 0}) {
+        Accept();
+    }
+
+    std::string GetEndpoint() const {
+        return "127.0.0.1:" + std::to_string(acceptor_.local_endpoint().port());
+    }
+
+    size_t GetAcceptedCount() const { return accepted_; }
+    const std::string& GetReceived() const { return received_; }
+
+private:
+    void Accept() {
+        acceptor_.async_accept([this](boost::system::error_code ec, boost::asio::ip::tcp::socket socket) {
+            if (ec) {
+                return;
+            }
+            accepted_++;
+            sockets_.push_back(std::make_unique<boost::asio::ip::tcp::socket>(std::move(socket)));
+            Read(*sockets_.back());
+            Accept();
+        });
+    }
+
+    void Read(boost::asio::ip::tcp::socket& socket) {
+        socket.async_read_some(boost::asio::buffer(buffer_), [this, &socket](boost::system::error_code ec, size_t n) {
+            if (ec) {
+                // 网关关闭后端连接时只做半关闭，由对端关闭后连接才会释放
+                socket.close();
+                return;
+            }
+            received_.append(buffer_.data(), n);
+            Read(socket);
+        });
+    }
+
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::vector<std::unique_ptr<boost::asio::ip::tcp::socket>> sockets_;
+    std::array<char, 4096> buffer_{};
+    std::string received_;
+    size_t accepted_ = 0;
+};
+
+/**
+ * @brief 在当前线程驱动io_context直到条件满足或超时
+ */
+template <typename Predicate>
+bool RunUntil(boost::asio::io_context& io_context, Predicate predicate,
+              std::chrono::milliseconds timeout = std::chrono::milliseconds(2000)) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!predicate() && std::chrono::steady_clock::now() < deadline) {
+        io_context.run_for(std::chrono::milliseconds(1));
+    }
+    return predicate();
+}
+
+/**
+ * @brief 在当前线程驱动io_context一段时间
+ */
+inline void RunFor(boost::asio::io_context& io_context, std::chrono::milliseconds duration) {
+    const auto deadline = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < deadline) {
+        io_context.run_for(std::chrono::milliseconds(1));
+    }
+}
+
+} // namespace test
+} // namespace gateway
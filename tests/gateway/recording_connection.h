@@ -0,0 +1,61 @@
+/**
+ * @file recording_connection.h
+ * @brief 网关测试用连接：记录发送内容，不进行实际网络传输
+ */
+
+#pragma once
+
+#include "common/network/connection.h"
+#include <boost/asio.hpp>
+#include <mutex>
+#include <vector>
+
+namespace gateway {
+namespace test {
+
+class RecordingConnection : public common::network::Connection {
+public:
+    explicit RecordingConnection(boost::asio::any_io_executor executor, const std::string& id = "recording")
+        : Connection(executor, id) {}
+
+    std::string GetProtocol() const override { return "test"; }
+    std::string GetRemoteEndpoint() const override { return "remote"; }
+    std::string GetLocalEndpoint() const override { return "local"; }
+
+    void AsyncConnect(const std::string&, std::function<void(boost::system::error_code)> callback) override {
+        Connect();
+        boost::asio::post(executor_, [callback]() { callback({}); });
+    }
+
+    void AsyncSend(const std::vector<uint8_t>& data, SendCallback callback) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            sends.push_back(data);
+        }
+        if (callback) {
+            boost::asio::post(executor_, [callback, size = data.size()]() { callback({}, size); });
+        }
+    }
+
+    void Close() override { UpdateState(common::network::ConnectionState::DISCONNECTED); }
+    void ForceClose() override { Close(); }
+
+    // UpdateState依赖shared_from_this，不能在构造函数中调用
+    void Connect() { UpdateState(common::network::ConnectionState::CONNECTED); }
+
+    // 模拟从对端收到数据
+    void Deliver(const std::vector<uint8_t>& data) { HandleDataReceived(data); }
+
+    std::vector<std::vector<uint8_t>> GetSends() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return sends;
+    }
+
+    std::vector<std::vector<uint8_t>> sends;
+
+private:
+    mutable std::mutex mutex_;
+};
+
+} // namespace test
+} // namespace gateway
@@ -0,0 +1,167 @@
+/**
+ * @file test_backend_batcher.cpp
+ * @brief BackendBatcher聚合与刷新测试
+ */
+
+#include "gateway/backend_batcher.h"
+#include "recording_connection.h"
+#include <gtest/gtest.h>
+#include <boost/asio.hpp>
+
+using namespace gateway;
+using gateway::test::RecordingConnection;
+
+namespace {
+
+std::vector<uint8_t> Frame(uint8_t value, size_t size) {
+    return std::vector<uint8_t>(size, value);
+}
+
+class BackendBatcherTest : public ::testing::Test {
+protected:
+    std::shared_ptr<BackendBatcher> MakeBatcher(const BackendBatcher::Config& config) {
+        connection_ = std::make_shared<RecordingConnection>(io_context_.get_executor());
+        connection_->Connect();
+        return std::make_shared<BackendBatcher>(connection_, config);
+    }
+
+    BackendBatcher::Config FixedDelayConfig() const {
+        BackendBatcher::Config config;
+        config.enabled = true;
+        config.adaptive = false;
+        config.max_delay_us = 2000;
+        return config;
+    }
+
+    boost::asio::io_context io_context_;
+    std::shared_ptr<RecordingConnection> connection_;
+};
+
+} // anonymous namespace
+
+TEST_F(BackendBatcherTest, DeadlineFlushConcatenatesFramesInOrder) {
+    auto batcher = MakeBatcher(FixedDelayConfig());
+
+    batcher->Enqueue(Frame(1, 3));
+    batcher->Enqueue(Frame(2, 2));
+    EXPECT_TRUE(connection_->sends.empty());
+
+    io_context_.run_for(std::chrono::milliseconds(50));
+
+    ASSERT_EQ(connection_->sends.size(), 1u);
+    EXPECT_EQ(connection_->sends[0], (std::vector<uint8_t>{1, 1, 1, 2, 2}));
+
+    const auto stats = batcher->GetStats();
+    EXPECT_EQ(stats.batches_flushed, 1u);
+    EXPECT_EQ(stats.frames_batched, 2u);
+    EXPECT_EQ(stats.bytes_batched, 5u);
+    EXPECT_EQ(stats.flush_by_deadline, 1u);
+    EXPECT_EQ(stats.frames_per_batch[2], 1u);
+}
+
+TEST_F(BackendBatcherTest, FrameThresholdFlushesWithoutWaiting) {
+    auto config = FixedDelayConfig();
+    config.max_batch_frames = 3;
+    auto batcher = MakeBatcher(config);
+
+    for (uint8_t i = 0; i < 7; ++i) {
+        batcher->Enqueue(Frame(i, 1));
+    }
+
+    // 两批因帧数阈值立即发出，剩余一帧等待截止期限
+    ASSERT_EQ(connection_->sends.size(), 2u);
+    EXPECT_EQ(connection_->sends[0], (std::vector<uint8_t>{0, 1, 2}));
+    EXPECT_EQ(connection_->sends[1], (std::vector<uint8_t>{3, 4, 5}));
+
+    io_context_.run_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(connection_->sends.size(), 3u);
+    EXPECT_EQ(connection_->sends[2], (std::vector<uint8_t>{6}));
+
+    const auto stats = batcher->GetStats();
+    EXPECT_EQ(stats.flush_by_size, 2u);
+    EXPECT_EQ(stats.flush_by_deadline, 1u);
+}
+
+TEST_F(BackendBatcherTest, ByteThresholdFlushes) {
+    auto config = FixedDelayConfig();
+    config.max_batch_bytes = 8;
+    auto batcher = MakeBatcher(config);
+
+    batcher->Enqueue(Frame(1, 5));
+    EXPECT_TRUE(connection_->sends.empty());
+    batcher->Enqueue(Frame(2, 5));
+
+    ASSERT_EQ(connection_->sends.size(), 1u);
+    EXPECT_EQ(connection_->sends[0].size(), 10u);
+    EXPECT_EQ(batcher->GetStats().flush_by_size, 1u);
+}
+
+TEST_F(BackendBatcherTest, AdaptiveModeSendsImmediatelyWhenIdle) {
+    BackendBatcher::Config config;
+    config.enabled = true;
+    config.adaptive = true;
+    auto batcher = MakeBatcher(config);
+
+    batcher->Enqueue(Frame(7, 4));
+
+    ASSERT_EQ(connection_->sends.size(), 1u);
+    const auto stats = batcher->GetStats();
+    EXPECT_EQ(stats.flush_immediate, 1u);
+    EXPECT_EQ(stats.current_delay_us, 0u);
+}
+
+TEST_F(BackendBatcherTest, CloseFlushIsCountedSeparately) {
+    auto batcher = MakeBatcher(FixedDelayConfig());
+
+    batcher->Enqueue(Frame(1, 2));
+    batcher->Close();
+
+    ASSERT_EQ(connection_->sends.size(), 1u);
+    auto stats = batcher->GetStats();
+    EXPECT_EQ(stats.flush_on_close, 1u);
+    EXPECT_EQ(stats.flush_by_deadline, 0u);
+
+    // 关闭后不再接受新帧，定时器也已取消
+    batcher->Enqueue(Frame(2, 2));
+    io_context_.run_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(connection_->sends.size(), 1u);
+}
+
+TEST_F(BackendBatcherTest, DisconnectedLinkDropsBatchAndStartsClean) {
+    auto config = FixedDelayConfig();
+    config.max_batch_frames = 2;
+    auto batcher = MakeBatcher(config);
+
+    connection_->Close();
+    batcher->Enqueue(Frame(1, 1));
+    batcher->Enqueue(Frame(2, 1));
+    EXPECT_TRUE(connection_->sends.empty());
+    EXPECT_EQ(batcher->GetStats().send_errors, 1u);
+
+    // 丢弃的数据不能混入下一批
+    connection_->Connect();
+    batcher->Enqueue(Frame(3, 1));
+    batcher->Enqueue(Frame(4, 1));
+    ASSERT_EQ(connection_->sends.size(), 1u);
+    EXPECT_EQ(connection_->sends[0], (std::vector<uint8_t>{3, 4}));
+}
+
+TEST(BackendBatcherStatsTest, AccumulatesAcrossLinks) {
+    BackendBatcher::BatchStats a;
+    a.batches_flushed = 2;
+    a.flush_on_close = 1;
+    a.current_delay_us = 100;
+    a.frames_per_batch[1] = 2;
+
+    BackendBatcher::BatchStats b;
+    b.batches_flushed = 3;
+    b.flush_on_close = 2;
+    b.current_delay_us = 400;
+    b.frames_per_batch[1] = 1;
+
+    a += b;
+    EXPECT_EQ(a.batches_flushed, 5u);
+    EXPECT_EQ(a.flush_on_close, 3u);
+    EXPECT_EQ(a.current_delay_us, 400u);
+    EXPECT_EQ(a.frames_per_batch[1], 3u);
+}
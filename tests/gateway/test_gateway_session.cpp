@@ -0,0 +1,263 @@
+/**
+ * @file test_gateway_session.cpp
+ * @brief GatewaySession转发路径测试：延迟限流、定时器并发转发时的顺序和无锁计数
+ */
+
+#include "gateway/gateway_server.h"
+#include "gateway/gateway_session.h"
+#include "backend_listener.h"
+#include "recording_connection.h"
+#include <gtest/gtest.h>
+#include <boost/asio.hpp>
+#include <cstdio>
+#include <thread>
+
+using namespace gateway;
+using gateway::test::BackendListener;
+using gateway::test::RecordingConnection;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::vector<uint8_t> Bytes(const std::string& text) {
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+class GatewaySessionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+#ifdef ZEUS_USE_KCP
+        GTEST_SKIP() << "Backend listener in these tests speaks TCP";
+#endif
+        backend_ = std::make_unique<BackendListener>(io_context_);
+    }
+
+    void TearDown() override {
+        // 会话析构后等待后端连接完成关闭流程
+        RunFor(200ms);
+    }
+
+    std::shared_ptr<RecordingConnection> NewClient() {
+        auto client = std::make_shared<RecordingConnection>(io_context_.get_executor(), "client");
+        client->Connect();
+        return client;
+    }
+
+    std::shared_ptr<GatewaySession> ConnectedSession(GatewaySession::Options options) {
+        auto session = std::make_shared<GatewaySession>("session_test", NewClient(), std::move(options));
+        session->ConnectToBackend(backend_->GetEndpoint(), io_context_.get_executor(), config_);
+        RunUntil([this]() { return backend_->GetAcceptedCount() == 1; });
+        RunFor(20ms);
+        return session;
+    }
+
+    template <typename Predicate>
+    bool RunUntil(Predicate predicate) {
+        return test::RunUntil(io_context_, predicate);
+    }
+
+    void RunFor(std::chrono::milliseconds duration) {
+        test::RunFor(io_context_, duration);
+    }
+
+    boost::asio::io_context io_context_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_{io_context_.get_executor()};
+    std::unique_ptr<BackendListener> backend_;
+    GatewayConfig config_;
+};
+
+} // anonymous namespace
+
+TEST_F(GatewaySessionTest, DelayedMessagesKeepOrderAndOverflowIsRefunded) {
+    GatewaySession::Options options;
+    options.rate_limit_config.enabled = true;
+    options.rate_limit_config.messages_per_second = 20;     // 每50ms一条
+    options.rate_limit_config.message_burst = 1;
+    options.rate_limit_config.bytes_per_second = 0;
+    options.rate_limit_config.action = SessionRateLimiter::Action::DELAY;
+    options.rate_limit_config.max_delay_ms = 1000;
+    options.rate_limit_config.max_delayed_messages = 2;
+    auto session = ConnectedSession(std::move(options));
+
+    const auto start = std::chrono::steady_clock::now();
+    for (const char* message : {"a", "b", "c", "d", "e"}) {
+        session->OnClientMessage(Bytes(message));
+    }
+
+    // a立即转发，b、c排队，d、e因队列已满被丢弃
+    auto stats = session->GetStats();
+    EXPECT_EQ(stats.rate_limited_messages, 4u);
+    EXPECT_EQ(stats.rate_limited_delayed, 2u);
+    EXPECT_EQ(stats.rate_limited_dropped, 2u);
+
+    ASSERT_TRUE(RunUntil([this]() { return backend_->GetReceived() == "abc"; }));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 90ms);
+
+    // 丢弃的消息已归还令牌，c的发送时间之后新消息无需等待
+    RunFor(std::chrono::duration_cast<std::chrono::milliseconds>(start + 180ms - std::chrono::steady_clock::now()));
+    session->OnClientMessage(Bytes("f"));
+    EXPECT_EQ(session->GetStats().rate_limited_messages, 4u);
+    EXPECT_TRUE(RunUntil([this]() { return backend_->GetReceived() == "abcf"; }));
+}
+
+TEST(GatewaySessionOrderingTest, DelayedMessagesStayOrderedWhileTimerDrainsConcurrently) {
+#ifdef ZEUS_USE_KCP
+    GTEST_SKIP() << "Backend listener in these tests speaks TCP";
+#endif
+    // 后端监听器在主线程驱动，会话（延迟定时器和连接回调）在多线程io_context上运行
+    boost::asio::io_context backend_io;
+    auto backend_work = boost::asio::make_work_guard(backend_io);
+    BackendListener backend(backend_io);
+
+    boost::asio::io_context session_io;
+    auto session_work = boost::asio::make_work_guard(session_io);
+    std::vector<std::thread> io_threads;
+    for (int i = 0; i < 3; ++i) {
+        io_threads.emplace_back([&session_io]() { session_io.run(); });
+    }
+
+    GatewaySession::Options options;
+    options.rate_limit_config.enabled = true;
+    options.rate_limit_config.messages_per_second = 200000;
+    options.rate_limit_config.message_burst = 1;
+    options.rate_limit_config.bytes_per_second = 0;
+    options.rate_limit_config.action = SessionRateLimiter::Action::DELAY;
+    options.rate_limit_config.max_delay_ms = 10000;
+    options.rate_limit_config.max_delayed_messages = 100000;
+
+    constexpr int kMessages = 20000;
+    std::string expected;
+    {
+        auto client = std::make_shared<RecordingConnection>(session_io.get_executor(), "client");
+        client->Connect();
+        auto session = std::make_shared<GatewaySession>("ordering", client, std::move(options));
+        session->ConnectToBackend(backend.GetEndpoint(), session_io.get_executor(), GatewayConfig{});
+        ASSERT_TRUE(test::RunUntil(backend_io, [&]() { return backend.GetAcceptedCount() == 1; }));
+        test::RunFor(backend_io, 20ms);
+
+        // 高限速下定时器每次转发一批已到期消息，期间新消息可能拿到令牌并与之并发
+        std::vector<std::string> messages;
+        for (int i = 0; i < kMessages; ++i) {
+            char text[8];
+            std::snprintf(text, sizeof(text), "%05d|", i);
+            messages.emplace_back(text);
+            expected += text;
+        }
+        std::thread producer([&]() {
+            for (int i = 0; i < kMessages; ++i) {
+                session->OnClientMessage(Bytes(messages[i]));
+            }
+        });
+        producer.join();
+
+        EXPECT_TRUE(test::RunUntil(backend_io, [&]() { return backend.GetReceived().size() >= expected.size(); },
+                                   10000ms));
+        EXPECT_EQ(backend.GetReceived(), expected);
+        EXPECT_GT(session->GetStats().rate_limited_delayed, 0u);
+    }
+    test::RunFor(backend_io, 200ms);
+
+    session_work.reset();
+    session_io.stop();
+    for (auto& thread : io_threads) {
+        thread.join();
+    }
+}
+
+TEST_F(GatewaySessionTest, DropActionDiscardsWithoutQueueing) {
+    GatewaySession::Options options;
+    options.rate_limit_config.enabled = true;
+    options.rate_limit_config.messages_per_second = 1;
+    options.rate_limit_config.message_burst = 2;
+    options.rate_limit_config.bytes_per_second = 0;
+    options.rate_limit_config.action = SessionRateLimiter::Action::DROP;
+    std::vector<SessionRateLimiter::Action> violations;
+    options.violation_handler = [&](SessionRateLimiter::Action action) { violations.push_back(action); };
+    auto session = ConnectedSession(std::move(options));
+
+    for (const char* message : {"a", "b", "c", "d"}) {
+        session->OnClientMessage(Bytes(message));
+    }
+
+    ASSERT_TRUE(RunUntil([this]() { return backend_->GetReceived() == "ab"; }));
+    RunFor(50ms);
+    EXPECT_EQ(backend_->GetReceived(), "ab");
+
+    auto stats = session->GetStats();
+    EXPECT_EQ(stats.rate_limited_messages, 2u);
+    EXPECT_EQ(stats.rate_limited_delayed, 0u);
+    EXPECT_EQ(stats.rate_limited_dropped, 2u);
+    EXPECT_EQ(violations, std::vector<SessionRateLimiter::Action>(2, SessionRateLimiter::Action::DROP));
+}
+
+TEST_F(GatewaySessionTest, ConcurrentClientMessagesAreCountedExactly) {
+    auto client = NewClient();
+    auto session = std::make_shared<GatewaySession>("concurrent", client);
+    const auto created = session->GetLastActivity();
+
+    constexpr int kThreads = 4;
+    constexpr int kMessagesPerThread = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&session]() {
+            const auto message = Bytes("12345");
+            for (int i = 0; i < kMessagesPerThread; ++i) {
+                session->OnClientMessage(message);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto stats = session->GetStats();
+    EXPECT_EQ(stats.client_messages_received, static_cast<uint64_t>(kThreads * kMessagesPerThread));
+    EXPECT_EQ(stats.client_bytes_received, static_cast<uint64_t>(kThreads * kMessagesPerThread * 5));
+    EXPECT_EQ(stats.backend_messages_sent, 0u);
+    EXPECT_GE(session->GetLastActivity(), created);
+}
+
+TEST_F(GatewaySessionTest, ForwardedTrafficIsCountedOnCompletion) {
+    auto client = NewClient();
+    auto session = std::make_shared<GatewaySession>("forwarding", client);
+    session->ConnectToBackend(backend_->GetEndpoint(), io_context_.get_executor(), config_);
+    ASSERT_TRUE(RunUntil([this]() { return backend_->GetAcceptedCount() == 1; }));
+    RunFor(20ms);
+
+    client->Deliver(Bytes("hello"));
+    client->Deliver(Bytes("gateway"));
+    session->ForwardToClient(Bytes("reply"));
+
+    ASSERT_TRUE(RunUntil([&]() { return session->GetStats().backend_messages_sent == 2; }));
+    RunUntil([&]() { return session->GetStats().client_messages_sent == 1; });
+
+    auto stats = session->GetStats();
+    EXPECT_EQ(backend_->GetReceived(), "hellogateway");
+    EXPECT_EQ(stats.client_messages_received, 2u);
+    EXPECT_EQ(stats.client_bytes_received, 12u);
+    EXPECT_EQ(stats.backend_bytes_sent, 12u);
+    EXPECT_EQ(stats.client_messages_sent, 1u);
+    EXPECT_EQ(stats.client_bytes_sent, 5u);
+}
+
+TEST_F(GatewaySessionTest, ReplacedClientConnectionNoLongerFeedsSession) {
+    GatewaySession::Options options;
+    options.resume_config.enabled = true;
+    auto old_client = NewClient();
+    auto session = std::make_shared<GatewaySession>("replaced", old_client, std::move(options));
+    session->ConnectToBackend(backend_->GetEndpoint(), io_context_.get_executor(), config_);
+    ASSERT_TRUE(RunUntil([this]() { return backend_->GetAcceptedCount() == 1; }));
+    RunFor(20ms);
+
+    old_client->Close();
+    ASSERT_TRUE(session->IsParked());
+    auto new_client = NewClient();
+    ASSERT_TRUE(session->Resume(new_client, 0));
+
+    // 旧连接上迟到的回调按连接身份过滤，不计入也不转发
+    old_client->Deliver(Bytes("stale"));
+    new_client->Deliver(Bytes("fresh"));
+
+    ASSERT_TRUE(RunUntil([this]() { return backend_->GetReceived() == "fresh"; }));
+    EXPECT_EQ(session->GetStats().client_messages_received, 1u);
+}
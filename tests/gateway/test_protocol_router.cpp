@@ -0,0 +1,220 @@
+/**
+ * @file test_protocol_router.cpp
+ * @brief 操作码路由测试：路由表、分帧器、集群选择和会话按操作码转发
+ */
+
+#include "gateway/gateway_server.h"
+#include "gateway/gateway_session.h"
+#include "gateway/message_frame.h"
+#include "gateway/protocol_router.h"
+#include "backend_listener.h"
+#include "recording_connection.h"
+#include <gtest/gtest.h>
+#include <boost/asio.hpp>
+
+using namespace gateway;
+using gateway::test::BackendListener;
+using gateway::test::RecordingConnection;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::vector<uint8_t> Frame(uint16_t opcode, const std::string& body) {
+    std::vector<uint8_t> frame = {
+        static_cast<uint8_t>(body.size() >> 24), static_cast<uint8_t>(body.size() >> 16),
+        static_cast<uint8_t>(body.size() >> 8), static_cast<uint8_t>(body.size()),
+        static_cast<uint8_t>(opcode >> 8), static_cast<uint8_t>(opcode)};
+    frame.insert(frame.end(), body.begin(), body.end());
+    return frame;
+}
+
+std::string Text(const std::vector<uint8_t>& data) {
+    return std::string(data.begin(), data.end());
+}
+
+} // anonymous namespace
+
+TEST(OpcodeRouteTableTest, ResolvesInclusiveRanges) {
+    OpcodeRouteTable table;
+    ASSERT_TRUE(table.AddRoute(1000, 1999, "chat"));
+    ASSERT_TRUE(table.AddRoute(100, 199, "login"));
+    ASSERT_TRUE(table.AddRoute(2000, 2000, "match"));
+
+    EXPECT_EQ(table.Resolve(99), nullptr);
+    EXPECT_EQ(*table.Resolve(100), "login");
+    EXPECT_EQ(*table.Resolve(199), "login");
+    EXPECT_EQ(table.Resolve(200), nullptr);
+    EXPECT_EQ(*table.Resolve(1000), "chat");
+    EXPECT_EQ(*table.Resolve(1999), "chat");
+    EXPECT_EQ(*table.Resolve(2000), "match");
+    EXPECT_EQ(table.Resolve(2001), nullptr);
+
+    // 区间按起始操作码有序保存
+    ASSERT_EQ(table.GetRoutes().size(), 3u);
+    EXPECT_EQ(table.GetRoutes()[0].cluster, "login");
+    EXPECT_EQ(table.GetRoutes()[2].cluster, "match");
+}
+
+TEST(OpcodeRouteTableTest, RejectsOverlappingAndInvalidRanges) {
+    OpcodeRouteTable table;
+    ASSERT_TRUE(table.AddRoute(100, 199, "login"));
+
+    EXPECT_FALSE(table.AddRoute(150, 250, "chat"));    // 与右端重叠
+    EXPECT_FALSE(table.AddRoute(50, 100, "chat"));     // 与左端重叠
+    EXPECT_FALSE(table.AddRoute(120, 130, "chat"));    // 被包含
+    EXPECT_FALSE(table.AddRoute(0, 65535, "chat"));    // 包含已有区间
+    EXPECT_FALSE(table.AddRoute(300, 200, "chat"));
+    EXPECT_FALSE(table.AddRoute(300, 400, ""));
+
+    EXPECT_TRUE(table.AddRoute(200, 299, "chat"));
+    EXPECT_TRUE(table.AddRoute(0, 99, "chat"));
+    EXPECT_EQ(table.GetRoutes().size(), 3u);
+}
+
+TEST(MessageFrameDecoderTest, SplitsCoalescedAndPartialFrames) {
+    MessageFrameDecoder decoder;
+    auto stream = Frame(1, "alpha");
+    auto second = Frame(2, "");
+    auto third = Frame(3, "gamma");
+    stream.insert(stream.end(), second.begin(), second.end());
+    stream.insert(stream.end(), third.begin(), third.end());
+
+    // 每次只喂一个字节，帧边界落在任意位置
+    std::vector<std::vector<uint8_t>> frames;
+    for (uint8_t byte : stream) {
+        ASSERT_TRUE(decoder.Feed({byte}, frames));
+    }
+    ASSERT_EQ(frames.size(), 3u);
+    EXPECT_EQ(frames[0], Frame(1, "alpha"));
+    EXPECT_EQ(frames[1], Frame(2, ""));
+    EXPECT_EQ(frames[2], Frame(3, "gamma"));
+    EXPECT_EQ(decoder.GetBufferedBytes(), 0u);
+
+    // 一次喂入多帧加半帧，半帧留在缓冲区
+    frames.clear();
+    auto chunk = stream;
+    chunk.insert(chunk.end(), third.begin(), third.begin() + 4);
+    ASSERT_TRUE(decoder.Feed(chunk, frames));
+    EXPECT_EQ(frames.size(), 3u);
+    EXPECT_EQ(decoder.GetBufferedBytes(), 4u);
+
+    ASSERT_TRUE(decoder.Feed(std::vector<uint8_t>(third.begin() + 4, third.end()), frames));
+    ASSERT_EQ(frames.size(), 4u);
+    EXPECT_EQ(frames[3], third);
+
+    auto header = MessageHeader::Parse(frames[3].data(), frames[3].size());
+    ASSERT_TRUE(header);
+    EXPECT_EQ(header->opcode, 3);
+    EXPECT_EQ(header->body_length, 5u);
+}
+
+TEST(MessageFrameDecoderTest, RejectsOversizedFrame) {
+    MessageFrameDecoder decoder(16);
+    std::vector<std::vector<uint8_t>> frames;
+
+    EXPECT_TRUE(decoder.Feed(Frame(1, std::string(10, 'x')), frames));
+    EXPECT_EQ(frames.size(), 1u);
+
+    // 只收到固定头即可判定超限，不必等待负载
+    auto oversized = Frame(1, std::string(11, 'x'));
+    oversized.resize(MessageHeader::kSize);
+    EXPECT_FALSE(decoder.Feed(oversized, frames));
+    EXPECT_EQ(decoder.GetBufferedBytes(), 0u);
+}
+
+TEST(ProtocolRouterTest, ClusterSelectionAndCopyOnWriteRouteTable) {
+    ProtocolRouter router;
+    router.AddCluster("chat", ProtocolRouter::LoadBalanceStrategy::ROUND_ROBIN);
+    router.AddClusterServer("chat", "10.0.0.1:7000");
+    router.AddClusterServer("chat", "10.0.0.2:7000");
+    router.AddClusterServer("chat", "10.0.0.1:7000");   // 重复地址忽略
+    router.AddClusterServer("missing", "10.0.0.9:7000");
+
+    EXPECT_EQ(router.SelectClusterServer("chat"), "10.0.0.1:7000");
+    EXPECT_EQ(router.SelectClusterServer("chat"), "10.0.0.2:7000");
+    EXPECT_EQ(router.SelectClusterServer("chat"), "10.0.0.1:7000");
+    EXPECT_EQ(router.SelectClusterServer("missing"), "");
+    EXPECT_EQ(router.GetClusterNames(), std::vector<std::string>{"chat"});
+
+    // 路由只能指向已注册的集群
+    EXPECT_FALSE(router.AddOpcodeRoute(1, 10, "missing"));
+    EXPECT_EQ(router.GetRouteTable(), nullptr);
+
+    ASSERT_TRUE(router.AddOpcodeRoute(1000, 1999, "chat"));
+    auto published = router.GetRouteTable();
+    ASSERT_TRUE(published);
+
+    // 已发布的路由表不受之后修改的影响
+    router.AddCluster("match", ProtocolRouter::LoadBalanceStrategy::RANDOM);
+    ASSERT_TRUE(router.AddOpcodeRoute(2000, 2999, "match"));
+    EXPECT_EQ(published->Resolve(2500), nullptr);
+    EXPECT_EQ(*router.GetRouteTable()->Resolve(2500), "match");
+
+    EXPECT_FALSE(router.AddOpcodeRoute(1500, 2500, "chat"));
+
+    router.ClearClusters();
+    EXPECT_EQ(router.GetRouteTable(), nullptr);
+    EXPECT_EQ(*published->Resolve(1000), "chat");
+}
+
+TEST(ProtocolRouterTest, ParseStrategy) {
+    EXPECT_EQ(ProtocolRouter::ParseStrategy("random"), ProtocolRouter::LoadBalanceStrategy::RANDOM);
+    EXPECT_EQ(ProtocolRouter::ParseStrategy("least_connections"),
+              ProtocolRouter::LoadBalanceStrategy::LEAST_CONNECTIONS);
+    EXPECT_EQ(ProtocolRouter::ParseStrategy("round_robin"), ProtocolRouter::LoadBalanceStrategy::ROUND_ROBIN);
+    EXPECT_EQ(ProtocolRouter::ParseStrategy("unknown"), ProtocolRouter::LoadBalanceStrategy::ROUND_ROBIN);
+}
+
+TEST(SessionRoutingTest, FramesAreForwardedToTheirCluster) {
+#ifdef ZEUS_USE_KCP
+    GTEST_SKIP() << "Backend listener in these tests speaks TCP";
+#endif
+    boost::asio::io_context io_context;
+    auto work = boost::asio::make_work_guard(io_context);
+    BackendListener default_backend(io_context);
+    BackendListener chat_backend(io_context);
+
+    ProtocolRouter router;
+    router.AddCluster("chat", ProtocolRouter::LoadBalanceStrategy::ROUND_ROBIN);
+    router.AddCluster("idle", ProtocolRouter::LoadBalanceStrategy::ROUND_ROBIN);
+    ASSERT_TRUE(router.AddOpcodeRoute(1000, 1999, "chat"));
+    ASSERT_TRUE(router.AddOpcodeRoute(3000, 3999, "idle"));
+
+    auto client = std::make_shared<RecordingConnection>(io_context.get_executor(), "client");
+    client->Connect();
+    GatewaySession::Options options;
+    options.route_table = router.GetRouteTable();
+    options.max_frame_bytes = 64;
+    {
+        auto session = std::make_shared<GatewaySession>("routing", client, std::move(options));
+        session->ConnectToBackend(default_backend.GetEndpoint(), io_context.get_executor(), GatewayConfig{},
+                                  {{"chat", chat_backend.GetEndpoint()}});
+        ASSERT_TRUE(test::RunUntil(io_context, [&]() {
+            return default_backend.GetAcceptedCount() == 1 && chat_backend.GetAcceptedCount() == 1;
+        }));
+        test::RunFor(io_context, 20ms);
+
+        // 两帧合并在一次读取中，且第二帧跨越两次读取
+        auto login = Frame(100, "login");
+        auto chat = Frame(1500, "hi");
+        auto unconnected = Frame(3500, "idle");
+        std::vector<uint8_t> first = login;
+        first.insert(first.end(), chat.begin(), chat.begin() + 3);
+        client->Deliver(first);
+        std::vector<uint8_t> second(chat.begin() + 3, chat.end());
+        second.insert(second.end(), unconnected.begin(), unconnected.end());
+        client->Deliver(second);
+
+        // 未连接的集群回落到默认后端
+        const std::string expected_default = Text(login) + Text(unconnected);
+        ASSERT_TRUE(test::RunUntil(io_context, [&]() {
+            return default_backend.GetReceived() == expected_default && chat_backend.GetReceived() == Text(chat);
+        }));
+        EXPECT_EQ(session->GetStats().client_messages_received, 2u);
+
+        // 超限帧关闭会话
+        client->Deliver(Frame(100, std::string(64, 'x')));
+        EXPECT_FALSE(session->IsActive());
+    }
+    test::RunFor(io_context, 200ms);
+}
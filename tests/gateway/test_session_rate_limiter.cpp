@@ -0,0 +1,139 @@
+/**
+ * @file test_session_rate_limiter.cpp
+ * @brief SessionRateLimiter令牌桶测试
+ */
+
+#include "gateway/session_rate_limiter.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace gateway;
+using namespace std::chrono_literals;
+
+namespace {
+
+SessionRateLimiter::Config MessageOnlyConfig(uint32_t rate, uint32_t burst) {
+    SessionRateLimiter::Config config;
+    config.enabled = true;
+    config.messages_per_second = rate;
+    config.message_burst = burst;
+    config.bytes_per_second = 0;
+    return config;
+}
+
+} // anonymous namespace
+
+TEST(SessionRateLimiterTest, DisabledLimiterAllowsEverything) {
+    SessionRateLimiter::Config config = MessageOnlyConfig(1, 1);
+    config.enabled = false;
+    SessionRateLimiter limiter(config);
+
+    for (int i = 0; i < 100; ++i) {
+        auto decision = limiter.Acquire(1 << 20);
+        EXPECT_TRUE(decision.allowed);
+        EXPECT_EQ(decision.delay.count(), 0);
+    }
+}
+
+TEST(SessionRateLimiterTest, BurstThenReject) {
+    SessionRateLimiter limiter(MessageOnlyConfig(10, 5));
+
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(limiter.Acquire(1).allowed) << "message " << i;
+    }
+    EXPECT_FALSE(limiter.Acquire(1).allowed);
+}
+
+TEST(SessionRateLimiterTest, TokensRefillOverTime) {
+    // 100条/秒，每10ms补充一个令牌
+    SessionRateLimiter limiter(MessageOnlyConfig(100, 2));
+
+    EXPECT_TRUE(limiter.Acquire(1).allowed);
+    EXPECT_TRUE(limiter.Acquire(1).allowed);
+    EXPECT_FALSE(limiter.Acquire(1).allowed);
+
+    std::this_thread::sleep_for(25ms);
+    EXPECT_TRUE(limiter.Acquire(1).allowed);
+    EXPECT_TRUE(limiter.Acquire(1).allowed);
+    EXPECT_FALSE(limiter.Acquire(1).allowed);
+}
+
+TEST(SessionRateLimiterTest, DelaysAreOrderedAndSpacedByEmissionInterval) {
+    // 1000条/秒，突发1：之后的消息按1ms间隔排队
+    SessionRateLimiter limiter(MessageOnlyConfig(1000, 1));
+
+    auto first = limiter.Acquire(1, 100ms);
+    ASSERT_TRUE(first.allowed);
+    EXPECT_EQ(first.delay.count(), 0);
+
+    std::chrono::nanoseconds previous{0};
+    for (int i = 0; i < 10; ++i) {
+        auto decision = limiter.Acquire(1, 100ms);
+        ASSERT_TRUE(decision.allowed);
+        EXPECT_GT(decision.delay, previous) << "message " << i;
+        EXPECT_LE(decision.delay, std::chrono::nanoseconds(1ms) * (i + 1));
+        previous = decision.delay;
+    }
+
+    // 超过最大等待时间的消息被拒绝且不扣减令牌
+    EXPECT_FALSE(limiter.Acquire(1, 5ms).allowed);
+    auto next = limiter.Acquire(1, 100ms);
+    ASSERT_TRUE(next.allowed);
+    EXPECT_GT(next.delay, previous);
+    EXPECT_LT(next.delay, previous + std::chrono::nanoseconds(2ms));
+}
+
+TEST(SessionRateLimiterTest, RefundReturnsTokens) {
+    SessionRateLimiter limiter(MessageOnlyConfig(1, 3));
+
+    EXPECT_TRUE(limiter.Acquire(1).allowed);
+    EXPECT_TRUE(limiter.Acquire(1).allowed);
+    EXPECT_TRUE(limiter.Acquire(1).allowed);
+    EXPECT_FALSE(limiter.Acquire(1).allowed);
+
+    limiter.Refund(1);
+    EXPECT_TRUE(limiter.Acquire(1).allowed);
+    EXPECT_FALSE(limiter.Acquire(1).allowed);
+}
+
+TEST(SessionRateLimiterTest, ByteBucketLimitsLargeMessages) {
+    SessionRateLimiter::Config config;
+    config.enabled = true;
+    config.messages_per_second = 0;
+    config.bytes_per_second = 1000;
+    config.byte_burst = 1000;
+    SessionRateLimiter limiter(config);
+
+    EXPECT_TRUE(limiter.Acquire(600).allowed);
+    EXPECT_FALSE(limiter.Acquire(600).allowed);
+    EXPECT_TRUE(limiter.Acquire(300).allowed);
+
+    // 超过突发容量的消息按整桶计费，空桶时仍能通过
+    SessionRateLimiter fresh(config);
+    EXPECT_TRUE(fresh.Acquire(5000).allowed);
+    EXPECT_FALSE(fresh.Acquire(1).allowed);
+}
+
+TEST(SessionRateLimiterTest, ByteRejectionRollsBackMessageToken) {
+    SessionRateLimiter::Config config;
+    config.enabled = true;
+    config.messages_per_second = 1;
+    config.message_burst = 2;
+    config.bytes_per_second = 100;
+    config.byte_burst = 100;
+    SessionRateLimiter limiter(config);
+
+    EXPECT_TRUE(limiter.Acquire(100).allowed);
+    // 字节桶拒绝时消息令牌必须回滚，否则第二个消息令牌会被这些失败的申请耗尽
+    EXPECT_FALSE(limiter.Acquire(100).allowed);
+    EXPECT_FALSE(limiter.Acquire(100).allowed);
+    EXPECT_TRUE(limiter.Acquire(0).allowed);
+    EXPECT_FALSE(limiter.Acquire(0).allowed);
+}
+
+TEST(SessionRateLimiterTest, ParseAction) {
+    EXPECT_EQ(SessionRateLimiter::ParseAction("delay"), SessionRateLimiter::Action::DELAY);
+    EXPECT_EQ(SessionRateLimiter::ParseAction("disconnect"), SessionRateLimiter::Action::DISCONNECT);
+    EXPECT_EQ(SessionRateLimiter::ParseAction("drop"), SessionRateLimiter::Action::DROP);
+    EXPECT_EQ(SessionRateLimiter::ParseAction("unknown"), SessionRateLimiter::Action::DROP);
+}
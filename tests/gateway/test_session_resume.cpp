@@ -0,0 +1,459 @@
+/**
+ * @file test_session_resume.cpp
+ * @brief 会话恢复测试：控制帧、令牌、挂起过期、重放偏移、延迟连接后端和恢复请求分帧
+ */
+
+#include "gateway/gateway_server.h"
+#include "gateway/gateway_session.h"
+#include "gateway/session_resume.h"
+#include "backend_listener.h"
+#include "recording_connection.h"
+#include <gtest/gtest.h>
+#include <boost/asio.hpp>
+#include <atomic>
+#include <set>
+
+using namespace gateway;
+using gateway::test::BackendListener;
+using gateway::test::RecordingConnection;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::vector<uint8_t> Bytes(const std::string& text) {
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+std::string Text(const std::vector<uint8_t>& data) {
+    return std::string(data.begin(), data.end());
+}
+
+class SessionResumeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+#ifdef ZEUS_USE_KCP
+        GTEST_SKIP() << "Backend listener in these tests speaks TCP";
+#endif
+        backend_ = std::make_unique<BackendListener>(io_context_);
+    }
+
+    void TearDown() override {
+        // 会话析构后等待后端连接完成关闭流程
+        RunFor(200ms);
+    }
+
+    GatewaySession::Options ResumeOptions(uint32_t grace_period_ms = 30000, size_t max_replay_bytes = 1024) {
+        GatewaySession::Options options;
+        options.resume_config.enabled = true;
+        options.resume_config.grace_period_ms = grace_period_ms;
+        options.resume_config.max_replay_bytes = max_replay_bytes;
+        return options;
+    }
+
+    std::shared_ptr<RecordingConnection> NewClient() {
+        auto client = std::make_shared<RecordingConnection>(io_context_.get_executor(), "client");
+        client->Connect();
+        return client;
+    }
+
+    // 创建会话并连接到本地后端，等待后端连接建立
+    std::shared_ptr<GatewaySession> ConnectedSession(std::shared_ptr<RecordingConnection> client,
+                                                     GatewaySession::Options options) {
+        auto session = std::make_shared<GatewaySession>("resume_test", client, std::move(options));
+        session->ConnectToBackend(backend_->GetEndpoint(), io_context_.get_executor(), config_);
+        RunUntil([this]() { return backend_->GetAcceptedCount() == 1; });
+        RunFor(20ms);
+        return session;
+    }
+
+    template <typename Predicate>
+    bool RunUntil(Predicate predicate) {
+        return test::RunUntil(io_context_, predicate);
+    }
+
+    void RunFor(std::chrono::milliseconds duration) {
+        test::RunFor(io_context_, duration);
+    }
+
+    boost::asio::io_context io_context_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_{io_context_.get_executor()};
+    std::unique_ptr<BackendListener> backend_;
+    GatewayConfig config_;
+};
+
+} // anonymous namespace
+
+TEST(ResumeFrameTest, TokensAreRandomHexWithLookupId) {
+    std::set<std::string> tokens;
+    for (int i = 0; i < 100; ++i) {
+        const std::string token = ResumeFrame::GenerateToken();
+        ASSERT_EQ(token.size(), ResumeFrame::kTokenLength);
+        EXPECT_EQ(token.find_first_not_of("0123456789abcdef"), std::string::npos);
+        EXPECT_EQ(ResumeFrame::GetTokenId(token).size(), ResumeFrame::kTokenIdLength);
+        tokens.insert(token);
+    }
+    EXPECT_EQ(tokens.size(), 100u);
+}
+
+TEST(ResumeFrameTest, TokenEquals) {
+    const std::string token = ResumeFrame::GenerateToken();
+    std::string other = token;
+    other.back() = other.back() == 'a' ? 'b' : 'a';
+
+    EXPECT_TRUE(ResumeFrame::TokenEquals(token, token));
+    EXPECT_FALSE(ResumeFrame::TokenEquals(token, other));
+    EXPECT_FALSE(ResumeFrame::TokenEquals(token, token.substr(0, ResumeFrame::kTokenIdLength)));
+    EXPECT_FALSE(ResumeFrame::TokenEquals("", ""));
+}
+
+TEST(ResumeFrameTest, EncodeDecodeRoundTrip) {
+    ResumeFrame request;
+    request.type = ResumeFrame::Type::RESUME_REQUEST;
+    request.token = ResumeFrame::GenerateToken();
+    request.offset = 0x0102030405060708ULL;
+
+    auto decoded = ResumeFrame::Decode(request.Encode());
+    ASSERT_TRUE(decoded);
+    EXPECT_EQ(decoded->type, ResumeFrame::Type::RESUME_REQUEST);
+    EXPECT_EQ(decoded->token, request.token);
+    EXPECT_EQ(decoded->offset, request.offset);
+
+    ResumeFrame resumed;
+    resumed.type = ResumeFrame::Type::RESUMED;
+    resumed.offset = 42;
+    decoded = ResumeFrame::Decode(resumed.Encode());
+    ASSERT_TRUE(decoded);
+    EXPECT_EQ(decoded->type, ResumeFrame::Type::RESUMED);
+    EXPECT_EQ(decoded->offset, 42u);
+
+    ResumeFrame rejected;
+    rejected.type = ResumeFrame::Type::REJECTED;
+    decoded = ResumeFrame::Decode(rejected.Encode());
+    ASSERT_TRUE(decoded);
+    EXPECT_EQ(decoded->type, ResumeFrame::Type::REJECTED);
+}
+
+TEST(ResumeFrameTest, RejectsMalformedFrames) {
+    EXPECT_FALSE(ResumeFrame::Decode(Bytes("hello world")));
+    EXPECT_FALSE(ResumeFrame::Decode(Bytes("ZRSM")));
+
+    ResumeFrame token;
+    token.type = ResumeFrame::Type::TOKEN;
+    token.token = "short";
+    EXPECT_FALSE(ResumeFrame::Decode(token.Encode()));
+
+    auto request = Bytes("ZRSM");
+    request.push_back(static_cast<uint8_t>(ResumeFrame::Type::RESUME_REQUEST));
+    request.resize(request.size() + ResumeFrame::kTokenLength, 'a');
+    EXPECT_FALSE(ResumeFrame::Decode(request));   // 缺少偏移
+}
+
+TEST_F(SessionResumeTest, ParkedSessionExpiresAfterGracePeriod) {
+    auto client = NewClient();
+    auto session = ConnectedSession(client, ResumeOptions(100));
+
+    client->Close();
+    ASSERT_TRUE(session->IsParked());
+    EXPECT_TRUE(session->IsActive());
+
+    const auto now = std::chrono::steady_clock::now();
+    EXPECT_FALSE(session->IsParkExpired(now));
+    EXPECT_TRUE(session->IsParkExpired(now + 150ms));
+}
+
+TEST_F(SessionResumeTest, SessionWithoutBackendClosesInsteadOfParking) {
+    auto client = NewClient();
+    auto session = std::make_shared<GatewaySession>("no_backend", client, ResumeOptions());
+
+    client->Close();
+    EXPECT_FALSE(session->IsParked());
+    EXPECT_FALSE(session->IsActive());
+}
+
+TEST_F(SessionResumeTest, ResumeReplaysFromClientOffset) {
+    auto client = NewClient();
+    auto session = ConnectedSession(client, ResumeOptions());
+
+    auto sends = client->GetSends();
+    ASSERT_EQ(sends.size(), 1u);
+    auto token_frame = ResumeFrame::Decode(sends[0]);
+    ASSERT_TRUE(token_frame);
+    EXPECT_EQ(token_frame->type, ResumeFrame::Type::TOKEN);
+    EXPECT_TRUE(session->MatchesResumeToken(token_frame->token));
+
+    session->ForwardToClient(Bytes("aaaa"));
+    session->ForwardToClient(Bytes("bbbb"));
+    client->Close();
+    ASSERT_TRUE(session->IsParked());
+
+    // 挂起期间的下行数据只缓存
+    session->ForwardToClient(Bytes("cccc"));
+    EXPECT_EQ(client->GetSends().size(), 3u);
+
+    // 客户端收到了6个字节："aaaa" 和 "bb"
+    auto new_client = NewClient();
+    ASSERT_TRUE(session->Resume(new_client, 6));
+    EXPECT_FALSE(session->IsParked());
+
+    sends = new_client->GetSends();
+    ASSERT_EQ(sends.size(), 3u);
+    auto resumed = ResumeFrame::Decode(sends[0]);
+    ASSERT_TRUE(resumed);
+    EXPECT_EQ(resumed->type, ResumeFrame::Type::RESUMED);
+    EXPECT_EQ(resumed->offset, 6u);
+    EXPECT_EQ(Text(sends[1]), "bb");
+    EXPECT_EQ(Text(sends[2]), "cccc");
+
+    session->ForwardToClient(Bytes("dd"));
+    sends = new_client->GetSends();
+    ASSERT_EQ(sends.size(), 4u);
+    EXPECT_EQ(Text(sends[3]), "dd");
+    EXPECT_EQ(session->GetStats().resumes, 1u);
+}
+
+TEST_F(SessionResumeTest, ResumeRejectsOffsetOutsideReplayWindow) {
+    auto client = NewClient();
+    auto session = ConnectedSession(client, ResumeOptions(30000, 8));
+
+    // 重放缓冲区只保留最后8字节，窗口为[4, 12]
+    session->ForwardToClient(Bytes("1111"));
+    session->ForwardToClient(Bytes("2222"));
+    session->ForwardToClient(Bytes("3333"));
+    client->Close();
+    ASSERT_TRUE(session->IsParked());
+
+    auto new_client = NewClient();
+    EXPECT_FALSE(session->Resume(new_client, 2));
+    EXPECT_FALSE(session->Resume(new_client, 13));
+    EXPECT_TRUE(session->IsParked());
+
+    ASSERT_TRUE(session->Resume(new_client, 12));
+    auto sends = new_client->GetSends();
+    ASSERT_EQ(sends.size(), 1u);
+    EXPECT_EQ(ResumeFrame::Decode(sends[0])->offset, 0u);
+}
+
+TEST_F(SessionResumeTest, ResumeRequestDefersBackendConnect) {
+    auto client = NewClient();
+    std::atomic<int> connects{0};
+    std::string presented_token;
+    uint64_t presented_offset = 0;
+
+    auto options = ResumeOptions();
+    options.backend_connector = [&](GatewaySession& session) {
+        connects++;
+        session.ConnectToBackend(backend_->GetEndpoint(), io_context_.get_executor(), config_);
+        return true;
+    };
+    options.resume_handler = [&](GatewaySession&, const std::string& token, uint64_t offset,
+                                 const std::vector<uint8_t>&) {
+        presented_token = token;
+        presented_offset = offset;
+        return false;
+    };
+    auto session = std::make_shared<GatewaySession>("deferred", client, std::move(options));
+
+    // 首条消息之前既不连接后端也不下发令牌
+    EXPECT_TRUE(client->GetSends().empty());
+
+    ResumeFrame request;
+    request.type = ResumeFrame::Type::RESUME_REQUEST;
+    request.token = ResumeFrame::GenerateToken();
+    request.offset = 77;
+    session->OnClientMessage(request.Encode());
+    EXPECT_EQ(connects, 0);
+
+    // 恢复被拒绝后才作为新会话连接后端，令牌在REJECTED之后下发
+    ASSERT_TRUE(RunUntil([&]() { return backend_->GetAcceptedCount() == 1; }));
+    EXPECT_EQ(connects, 1);
+    EXPECT_EQ(presented_token, request.token);
+    EXPECT_EQ(presented_offset, 77u);
+
+    auto sends = client->GetSends();
+    ASSERT_EQ(sends.size(), 2u);
+    EXPECT_EQ(ResumeFrame::Decode(sends[0])->type, ResumeFrame::Type::REJECTED);
+    auto token_frame = ResumeFrame::Decode(sends[1]);
+    ASSERT_TRUE(token_frame);
+    EXPECT_EQ(token_frame->type, ResumeFrame::Type::TOKEN);
+    EXPECT_EQ(token_frame->token, session->GetResumeToken());
+}
+
+TEST_F(SessionResumeTest, SuccessfulResumeNeverConnectsBackend) {
+    auto client = NewClient();
+    std::atomic<int> connects{0};
+
+    auto options = ResumeOptions();
+    options.backend_connector = [&](GatewaySession&) {
+        connects++;
+        return true;
+    };
+    options.resume_handler = [](GatewaySession& session, const std::string&, uint64_t, const std::vector<uint8_t>&) {
+        session.DetachClientConnection();
+        session.Close();
+        return true;
+    };
+    auto session = std::make_shared<GatewaySession>("temporary", client, std::move(options));
+
+    ResumeFrame request;
+    request.type = ResumeFrame::Type::RESUME_REQUEST;
+    request.token = ResumeFrame::GenerateToken();
+    session->OnClientMessage(request.Encode());
+    RunFor(50ms);
+
+    EXPECT_EQ(connects, 0);
+    EXPECT_EQ(backend_->GetAcceptedCount(), 0u);
+    EXPECT_TRUE(client->GetSends().empty());
+}
+
+TEST_F(SessionResumeTest, FirstRegularMessageIsHeldUntilBackendConnects) {
+    auto client = NewClient();
+
+    auto options = ResumeOptions();
+    options.backend_connector = [&](GatewaySession& session) {
+        session.ConnectToBackend(backend_->GetEndpoint(), io_context_.get_executor(), config_);
+        return true;
+    };
+    options.resume_handler = [](GatewaySession&, const std::string&, uint64_t, const std::vector<uint8_t>&) { return false; };
+    auto session = std::make_shared<GatewaySession>("regular", client, std::move(options));
+
+    session->OnClientMessage(Bytes("hello "));
+    session->OnClientMessage(Bytes("world"));
+
+    ASSERT_TRUE(RunUntil([&]() { return backend_->GetReceived() == "hello world"; }));
+
+    auto sends = client->GetSends();
+    ASSERT_EQ(sends.size(), 1u);
+    EXPECT_EQ(ResumeFrame::Decode(sends[0])->type, ResumeFrame::Type::TOKEN);
+
+    session->OnClientMessage(Bytes("!"));
+    EXPECT_TRUE(RunUntil([&]() { return backend_->GetReceived() == "hello world!"; }));
+}
+
+TEST_F(SessionResumeTest, SplitResumeRequestIsReassembledAndTrailingDataForwarded) {
+    auto client = NewClient();
+    std::atomic<int> connects{0};
+    std::string presented_token;
+    std::string early_data;
+
+    auto options = ResumeOptions();
+    options.backend_connector = [&](GatewaySession& session) {
+        connects++;
+        session.ConnectToBackend(backend_->GetEndpoint(), io_context_.get_executor(), config_);
+        return true;
+    };
+    options.resume_handler = [&](GatewaySession&, const std::string& token, uint64_t,
+                                 const std::vector<uint8_t>& early) {
+        presented_token = token;
+        early_data = Text(early);
+        return false;
+    };
+    auto session = std::make_shared<GatewaySession>("split", client, std::move(options));
+
+    ResumeFrame request;
+    request.type = ResumeFrame::Type::RESUME_REQUEST;
+    request.token = ResumeFrame::GenerateToken();
+    const auto frame = request.Encode();
+    ASSERT_EQ(frame.size(), ResumeFrame::kResumeRequestSize);
+
+    // 恢复请求分三次到达，最后一段与之后的数据合并
+    client->Deliver(std::vector<uint8_t>(frame.begin(), frame.begin() + 3));
+    client->Deliver(std::vector<uint8_t>(frame.begin() + 3, frame.begin() + 30));
+    RunFor(20ms);
+    EXPECT_TRUE(presented_token.empty());
+    EXPECT_EQ(connects, 0);
+
+    auto last = std::vector<uint8_t>(frame.begin() + 30, frame.end());
+    last.insert(last.end(), {'h', 'e', 'l', 'l', 'o'});
+    client->Deliver(last);
+    client->Deliver(Bytes(" world"));
+
+    // 控制帧字节不会被当作普通数据转发给后端
+    ASSERT_TRUE(RunUntil([&]() { return backend_->GetReceived() == "hello world"; }));
+    EXPECT_EQ(presented_token, request.token);
+    EXPECT_EQ(early_data, "hello world");
+    EXPECT_EQ(connects, 1);
+    EXPECT_EQ(ResumeFrame::Decode(client->GetSends().at(0))->type, ResumeFrame::Type::REJECTED);
+}
+
+TEST_F(SessionResumeTest, DataCoalescedWithResumeRequestGoesToResumedSession) {
+    auto old_client = NewClient();
+    auto parked = ConnectedSession(old_client, ResumeOptions());
+    parked->ForwardToClient(Bytes("aaaa"));
+    old_client->Close();
+    ASSERT_TRUE(parked->IsParked());
+
+    std::atomic<int> connects{0};
+    auto options = ResumeOptions();
+    options.backend_connector = [&](GatewaySession&) {
+        connects++;
+        return true;
+    };
+    options.resume_handler = [&](GatewaySession& session, const std::string& token, uint64_t offset,
+                                 const std::vector<uint8_t>& early) {
+        if (!parked->MatchesResumeToken(token) || !parked->Resume(session.GetClientConnection(), offset, early)) {
+            return false;
+        }
+        session.DetachClientConnection();
+        session.Close();
+        return true;
+    };
+    auto new_client = NewClient();
+    auto temporary = std::make_shared<GatewaySession>("temporary", new_client, std::move(options));
+
+    ResumeFrame request;
+    request.type = ResumeFrame::Type::RESUME_REQUEST;
+    request.token = parked->GetResumeToken();
+    request.offset = 4;
+    auto data = request.Encode();
+    data.insert(data.end(), {'a', 'f', 't', 'e', 'r'});
+    new_client->Deliver(data);
+
+    ASSERT_TRUE(RunUntil([&]() { return backend_->GetReceived() == "after"; }));
+    EXPECT_FALSE(parked->IsParked());
+    EXPECT_EQ(connects, 0);
+
+    auto sends = new_client->GetSends();
+    ASSERT_EQ(sends.size(), 1u);
+    EXPECT_EQ(ResumeFrame::Decode(sends[0])->type, ResumeFrame::Type::RESUMED);
+
+    // 之后的数据直接进入接管连接的会话
+    new_client->Deliver(Bytes(" more"));
+    EXPECT_TRUE(RunUntil([&]() { return backend_->GetReceived() == "after more"; }));
+}
+
+TEST_F(SessionResumeTest, PrefixThatDivergesFromResumeRequestIsForwarded) {
+    auto client = NewClient();
+    int handled = 0;
+
+    auto options = ResumeOptions();
+    options.backend_connector = [&](GatewaySession& session) {
+        session.ConnectToBackend(backend_->GetEndpoint(), io_context_.get_executor(), config_);
+        return true;
+    };
+    options.resume_handler = [&](GatewaySession&, const std::string&, uint64_t, const std::vector<uint8_t>&) {
+        handled++;
+        return false;
+    };
+    auto session = std::make_shared<GatewaySession>("prefix", client, std::move(options));
+
+    // 与魔数前缀相同的字节先暂存，出现分歧后连同暂存部分一起转发
+    client->Deliver(Bytes("ZRS"));
+    RunFor(20ms);
+    EXPECT_EQ(backend_->GetAcceptedCount(), 0u);
+    client->Deliver(Bytes("Mx-data"));
+
+    ASSERT_TRUE(RunUntil([&]() { return backend_->GetReceived() == "ZRSMx-data"; }));
+    EXPECT_EQ(handled, 0);
+}
+
+TEST_F(SessionResumeTest, FailedBackendSelectionClosesSession) {
+    auto client = NewClient();
+
+    auto options = ResumeOptions();
+    options.backend_connector = [](GatewaySession&) { return false; };
+    options.resume_handler = [](GatewaySession&, const std::string&, uint64_t, const std::vector<uint8_t>&) { return false; };
+    auto session = std::make_shared<GatewaySession>("no_backend", client, std::move(options));
+
+    session->OnClientMessage(Bytes("hello"));
+    EXPECT_FALSE(session->IsActive());
+}
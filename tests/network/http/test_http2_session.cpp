@@ -0,0 +1,234 @@
+/**
+ * @file test_http2_session.cpp
+ * @brief HTTP/2端到端测试：明文h2c连接上的请求、慢处理器不阻塞同一连接的其他流
+ */
+
+#include "common/network/http/http_server.h"
+#include <gtest/gtest.h>
+
+#ifdef ZEUS_HTTP_HAS_NGHTTP2
+
+#include <nghttp2/nghttp2.h>
+#include <condition_variable>
+#include <map>
+#include <thread>
+
+using namespace common::network::http;
+using namespace std::chrono_literals;
+
+namespace {
+
+// 基于nghttp2客户端会话的同步h2c客户端，在测试线程中收发
+class H2Client {
+public:
+    struct Response {
+        int status = 0;
+        std::string body;
+        bool closed = false;
+        uint32_t error_code = 0;
+    };
+
+    explicit H2Client(uint16_t port) : socket_(io_context_) {
+        socket_.connect({boost::asio::ip::make_address("127.0.0.1"), port});
+        // 非阻塞读取，避免服务端无响应时测试挂起
+        socket_.non_blocking(true);
+
+        nghttp2_session_callbacks* callbacks = nullptr;
+        nghttp2_session_callbacks_new(&callbacks);
+        nghttp2_session_callbacks_set_on_header_callback(callbacks, &H2Client::OnHeader);
+        nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks, &H2Client::OnDataChunk);
+        nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, &H2Client::OnStreamClose);
+        nghttp2_session_client_new(&session_, callbacks, this);
+        nghttp2_session_callbacks_del(callbacks);
+        nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, nullptr, 0);
+    }
+
+    ~H2Client() { nghttp2_session_del(session_); }
+
+    int32_t Submit(const std::string& method, const std::string& path, const std::string& body = "") {
+        const std::string scheme = "http";
+        const std::string authority = "127.0.0.1";
+        const nghttp2_nv headers[] = {
+            Nv(":method", method), Nv(":scheme", scheme), Nv(":authority", authority), Nv(":path", path),
+        };
+        nghttp2_data_provider provider{};
+        if (!body.empty()) {
+            bodies_.push_back(std::make_unique<PendingBody>(PendingBody{body, 0}));
+            provider.source.ptr = bodies_.back().get();
+            provider.read_callback = &H2Client::ReadBody;
+        }
+        const int32_t id = nghttp2_submit_request(session_, nullptr, headers, std::size(headers),
+                                                  body.empty() ? nullptr : &provider, nullptr);
+        responses_[id];
+        Flush();
+        return id;
+    }
+
+    // 收发数据直到predicate成立或超时
+    template <typename Predicate>
+    bool PumpUntil(Predicate predicate, std::chrono::milliseconds timeout = 2000ms) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!predicate() && std::chrono::steady_clock::now() < deadline) {
+            std::array<uint8_t, 16 * 1024> buffer;
+            boost::system::error_code ec;
+            const size_t n = socket_.read_some(boost::asio::buffer(buffer), ec);
+            if (ec == boost::asio::error::would_block) {
+                std::this_thread::sleep_for(1ms);
+                continue;
+            }
+            if (ec || nghttp2_session_mem_recv(session_, buffer.data(), n) < 0) {
+                return false;
+            }
+            Flush();
+        }
+        return predicate();
+    }
+
+    const Response& Get(int32_t id) { return responses_[id]; }
+
+private:
+    struct PendingBody {
+        std::string data;
+        size_t offset;
+    };
+
+    static nghttp2_nv Nv(const char* name, const std::string& value) {
+        return nghttp2_nv{reinterpret_cast<uint8_t*>(const_cast<char*>(name)),
+                          reinterpret_cast<uint8_t*>(const_cast<char*>(value.data())),
+                          std::strlen(name), value.size(), NGHTTP2_NV_FLAG_NONE};
+    }
+
+    void Flush() {
+        const uint8_t* data = nullptr;
+        ssize_t length = 0;
+        while ((length = nghttp2_session_mem_send(session_, &data)) > 0) {
+            std::string_view pending(reinterpret_cast<const char*>(data), static_cast<size_t>(length));
+            while (!pending.empty()) {
+                boost::system::error_code ec;
+                const size_t n = socket_.write_some(boost::asio::buffer(pending.data(), pending.size()), ec);
+                if (ec && ec != boost::asio::error::would_block) {
+                    return;
+                }
+                pending.remove_prefix(n);
+            }
+        }
+    }
+
+    static int OnHeader(nghttp2_session*, const nghttp2_frame* frame, const uint8_t* name, size_t name_len,
+                        const uint8_t* value, size_t value_len, uint8_t, void* user_data) {
+        if (std::string_view(reinterpret_cast<const char*>(name), name_len) == ":status") {
+            auto& self = *static_cast<H2Client*>(user_data);
+            self.responses_[frame->hd.stream_id].status =
+                std::stoi(std::string(reinterpret_cast<const char*>(value), value_len));
+        }
+        return 0;
+    }
+
+    static int OnDataChunk(nghttp2_session*, uint8_t, int32_t stream_id, const uint8_t* data, size_t len,
+                           void* user_data) {
+        auto& self = *static_cast<H2Client*>(user_data);
+        self.responses_[stream_id].body.append(reinterpret_cast<const char*>(data), len);
+        return 0;
+    }
+
+    static int OnStreamClose(nghttp2_session*, int32_t stream_id, uint32_t error_code, void* user_data) {
+        auto& response = static_cast<H2Client*>(user_data)->responses_[stream_id];
+        response.closed = true;
+        response.error_code = error_code;
+        return 0;
+    }
+
+    static ssize_t ReadBody(nghttp2_session*, int32_t, uint8_t* buf, size_t length, uint32_t* data_flags,
+                            nghttp2_data_source* source, void*) {
+        auto& body = *static_cast<PendingBody*>(source->ptr);
+        const size_t count = std::min(length, body.data.size() - body.offset);
+        std::copy_n(body.data.data() + body.offset, count, buf);
+        body.offset += count;
+        if (body.offset == body.data.size()) {
+            *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+        }
+        return static_cast<ssize_t>(count);
+    }
+
+    boost::asio::io_context io_context_;
+    boost::asio::ip::tcp::socket socket_;
+    nghttp2_session* session_ = nullptr;
+    std::map<int32_t, Response> responses_;
+    std::vector<std::unique_ptr<PendingBody>> bodies_;
+};
+
+class Http2SessionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        HttpServerConfig config;
+        config.bind_address = "127.0.0.1";
+        config.port = 0;
+        config.enable_http2 = true;
+        config.enable_compression = false;
+        server_ = std::make_unique<HttpServer>(4, config);
+    }
+
+    void TearDown() override {
+        server_->Stop();
+        server_.reset();
+    }
+
+    uint16_t StartServer() {
+        EXPECT_TRUE(server_->Start());
+        const std::string endpoint = server_->GetListeningEndpoint();
+        return static_cast<uint16_t>(std::stoi(endpoint.substr(endpoint.rfind(':') + 1)));
+    }
+
+    std::unique_ptr<HttpServer> server_;
+};
+
+} // anonymous namespace
+
+TEST_F(Http2SessionTest, RequestsOverPriorKnowledgeH2c) {
+    server_->Post("/echo", [](const HttpRequest& request, HttpResponse& response, std::function<void()>) {
+        response.SetBody(request.GetBody(), "text/plain");
+    });
+    H2Client client(StartServer());
+
+    const int32_t echo = client.Submit("POST", "/echo", "hello h2");
+    const int32_t missing = client.Submit("GET", "/missing");
+    ASSERT_TRUE(client.PumpUntil([&]() { return client.Get(echo).closed && client.Get(missing).closed; }));
+
+    EXPECT_EQ(client.Get(echo).status, 200);
+    EXPECT_EQ(client.Get(echo).body, "hello h2");
+    EXPECT_EQ(client.Get(missing).status, 404);
+    EXPECT_EQ(client.Get(missing).error_code, static_cast<uint32_t>(NGHTTP2_NO_ERROR));
+}
+
+TEST_F(Http2SessionTest, SlowHandlerDoesNotBlockOtherStreams) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool released = false;
+    server_->Get("/slow", [&](const HttpRequest&, HttpResponse& response, std::function<void()>) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, 5s, [&]() { return released; });
+        response.SetBody("slow", "text/plain");
+    });
+    server_->Get("/fast", [](const HttpRequest&, HttpResponse& response, std::function<void()>) {
+        response.SetBody("fast", "text/plain");
+    });
+    H2Client client(StartServer());
+
+    // 同一连接上慢请求在前，快请求的响应不必等待它完成
+    const int32_t slow = client.Submit("GET", "/slow");
+    const int32_t fast = client.Submit("GET", "/fast");
+    ASSERT_TRUE(client.PumpUntil([&]() { return client.Get(fast).closed; }));
+    EXPECT_EQ(client.Get(fast).body, "fast");
+    EXPECT_FALSE(client.Get(slow).closed);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        released = true;
+    }
+    cv.notify_all();
+    ASSERT_TRUE(client.PumpUntil([&]() { return client.Get(slow).closed; }));
+    EXPECT_EQ(client.Get(slow).status, 200);
+    EXPECT_EQ(client.Get(slow).body, "slow");
+}
+
+#endif // ZEUS_HTTP_HAS_NGHTTP2
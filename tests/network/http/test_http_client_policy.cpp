@@ -0,0 +1,156 @@
+/**
+ * @file test_http_client_policy.cpp
+ * @brief HTTP客户端重试与对冲测试：重试预算的消耗与补充、对冲延迟跟随近期耗时的百分位
+ */
+
+#include "common/network/http/http_client.h"
+#include "common/network/http/http_server.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <future>
+#include <numeric>
+#include <random>
+
+using namespace common::network::http;
+using namespace std::chrono_literals;
+
+namespace {
+
+size_t WithdrawAll(HttpRetryBudget& budget, std::chrono::steady_clock::time_point now) {
+    size_t withdrawn = 0;
+    while (withdrawn < 1000 && budget.TryWithdraw(now)) {
+        ++withdrawn;
+    }
+    return withdrawn;
+}
+
+} // anonymous namespace
+
+TEST(HttpClientPolicyTest, RetryBudgetIsEarnedByRequestsAndCapped) {
+    // 无最低补充速率时只有请求存入的令牌可用
+    HttpRetryBudget budget(0.5, 0.0);
+    const auto now = std::chrono::steady_clock::now();
+    EXPECT_FALSE(budget.TryWithdraw(now));
+
+    budget.Deposit();
+    EXPECT_FALSE(budget.TryWithdraw(now));
+    budget.Deposit();
+    EXPECT_TRUE(budget.TryWithdraw(now));
+    EXPECT_FALSE(budget.TryWithdraw(now));
+
+    // 余额上限为10个令牌，之后的存入被丢弃
+    for (int i = 0; i < 100; ++i) {
+        budget.Deposit();
+    }
+    EXPECT_EQ(WithdrawAll(budget, now), 10u);
+}
+
+TEST(HttpClientPolicyTest, RetryBudgetRefillsAtMinimumRate) {
+    HttpRetryBudget budget(0.1, 2.0);
+    const auto start = std::chrono::steady_clock::now();
+
+    // 初始余额为每秒最低补充量，用完后立即受限
+    EXPECT_EQ(WithdrawAll(budget, start), 2u);
+
+    // 每秒补充2个令牌，0.4秒不足一个，0.5秒恰好一个
+    EXPECT_FALSE(budget.TryWithdraw(start + 400ms));
+    EXPECT_TRUE(budget.TryWithdraw(start + 500ms));
+    EXPECT_FALSE(budget.TryWithdraw(start + 500ms));
+
+    // 更早的时间戳不会重复补充
+    EXPECT_FALSE(budget.TryWithdraw(start + 300ms));
+    EXPECT_FALSE(budget.TryWithdraw(start + 500ms));
+
+    // 长时间空闲后余额以上限（最低速率的10倍）为准
+    EXPECT_EQ(WithdrawAll(budget, start + 1h), 20u);
+}
+
+TEST(HttpClientPolicyTest, HedgeDelayNeedsMinimumSamples) {
+    HttpLatencyTracker tracker;
+    for (size_t i = 1; i < HttpLatencyTracker::kMinSamples; ++i) {
+        tracker.Record(10ms);
+        EXPECT_FALSE(tracker.GetPercentile(0.95).has_value()) << i;
+    }
+    tracker.Record(10ms);
+    EXPECT_EQ(tracker.GetPercentile(0.95), 10ms);
+
+    // 不足1毫秒的耗时向上取整，至少等待1毫秒
+    HttpLatencyTracker fast;
+    for (size_t i = 0; i < HttpLatencyTracker::kMinSamples; ++i) {
+        fast.Record(200us);
+    }
+    EXPECT_EQ(fast.GetPercentile(0.5), 1ms);
+}
+
+TEST(HttpClientPolicyTest, HedgeDelayFollowsTrackedPercentile) {
+    // 1..100毫秒乱序记录
+    std::vector<int> latencies(100);
+    std::iota(latencies.begin(), latencies.end(), 1);
+    std::shuffle(latencies.begin(), latencies.end(), std::mt19937(42));
+    HttpLatencyTracker tracker;
+    for (int ms : latencies) {
+        tracker.Record(std::chrono::milliseconds(ms));
+    }
+
+    EXPECT_EQ(tracker.GetPercentile(0.0), 1ms);
+    EXPECT_EQ(tracker.GetPercentile(0.5), 51ms);
+    EXPECT_EQ(tracker.GetPercentile(0.95), 96ms);
+    EXPECT_EQ(tracker.GetPercentile(1.0), 100ms);
+    EXPECT_EQ(tracker.GetPercentile(2.0), 100ms);
+
+    // 只保留最近kCapacity个样本，源站变慢后延迟随之变长
+    for (size_t i = 0; i < HttpLatencyTracker::kCapacity - 8; ++i) {
+        tracker.Record(500ms);
+    }
+    EXPECT_EQ(tracker.GetPercentile(0.5), 500ms);
+    EXPECT_LT(tracker.GetPercentile(0.0), 500ms);
+    for (size_t i = 0; i < 8; ++i) {
+        tracker.Record(500ms);
+    }
+    EXPECT_EQ(tracker.GetPercentile(0.0), 500ms);
+}
+
+TEST(HttpClientPolicyTest, RetriesStopWhenBudgetIsUsedUp) {
+    HttpServerConfig server_config;
+    server_config.bind_address = "127.0.0.1";
+    server_config.port = 0;
+    HttpServer server(2, server_config);
+    std::atomic<int> attempts{0};
+    server.Get("/unavailable", [&attempts](const HttpRequest&, HttpResponse& response, std::function<void()>) {
+        ++attempts;
+        response.SetStatusCode(HttpStatusCode::SERVICE_UNAVAILABLE);
+    });
+    ASSERT_TRUE(server.Start());
+    const std::string endpoint = server.GetListeningEndpoint();
+    const std::string url = "http://127.0.0.1:" + endpoint.substr(endpoint.rfind(':') + 1) + "/unavailable";
+
+    // 请求不存入令牌，只有初始的2个令牌可供重试
+    HttpConfig config;
+    config.retry_budget_ratio = 0.0;
+    config.retry_budget_min_per_second = 2.0;
+    HttpClient client(2, config);
+    HttpRequestPolicy policy;
+    policy.max_retries = 2;
+    policy.retry_base_delay = 1ms;
+    policy.retry_max_delay = 1ms;
+
+    const auto send = [&]() {
+        std::promise<HttpStatusCode> done;
+        client.Request(HttpRequest(HttpMethod::GET, url), policy, [&done](boost::system::error_code, const HttpResponse& response) {
+            done.set_value(response.GetStatusCode());
+        });
+        auto result = done.get_future();
+        EXPECT_EQ(result.wait_for(5s), std::future_status::ready);
+        return result.get();
+    };
+
+    EXPECT_EQ(send(), HttpStatusCode::SERVICE_UNAVAILABLE);
+    EXPECT_EQ(attempts.load(), 3);
+    EXPECT_EQ(send(), HttpStatusCode::SERVICE_UNAVAILABLE);
+    EXPECT_EQ(attempts.load(), 4);
+
+    const auto stats = client.GetStats();
+    EXPECT_EQ(stats.retries, 2u);
+    EXPECT_GE(stats.retry_budget_exhausted, 1u);
+    server.Stop();
+}
@@ -0,0 +1,211 @@
+/**
+ * @file test_http_client_pool.cpp
+ * @brief HTTP客户端连接池测试：非幂等请求从不流水线发送、连接数上限按源站分别限制
+ */
+
+#include "common/network/http/http_client.h"
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <condition_variable>
+#include <thread>
+
+using namespace common::network::http;
+using namespace std::chrono_literals;
+namespace beast_http = boost::beast::http;
+
+namespace {
+
+// 每个连接一个线程同步收发的HTTP/1.1服务器，每个请求延迟后回复，记录连接数和流水线到达的请求
+class RecordingServer {
+public:
+    struct Record {
+        std::string method;
+        std::string target;
+        std::string pipelined_behind;      // 到达时仍未回复的前一个请求的方法，为空表示未流水线
+    };
+
+    explicit RecordingServer(std::chrono::milliseconds delay)
+        : delay_(delay), acceptor_(io_context_, {boost::asio::ip::make_address("127.0.0.1"), 0}) {
+        Accept();
+        io_thread_ = std::thread([this]() { io_context_.run(); });
+    }
+
+    ~RecordingServer() {
+        io_context_.stop();
+        io_thread_.join();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (int fd : open_sockets_) {
+                ::shutdown(fd, SHUT_RDWR);
+            }
+        }
+        for (auto& thread : connection_threads_) {
+            thread.join();
+        }
+    }
+
+    std::string Url(const std::string& path) const {
+        return "http://127.0.0.1:" + std::to_string(acceptor_.local_endpoint().port()) + path;
+    }
+
+    size_t GetAccepted() const { std::lock_guard<std::mutex> lock(mutex_); return accepted_; }
+    size_t GetMaxOpen() const { std::lock_guard<std::mutex> lock(mutex_); return max_open_; }
+    std::vector<Record> GetRecords() const { std::lock_guard<std::mutex> lock(mutex_); return records_; }
+
+private:
+    void Accept() {
+        acceptor_.async_accept([this](boost::system::error_code ec, boost::asio::ip::tcp::socket socket) {
+            if (ec) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ++accepted_;
+                open_sockets_.push_back(socket.native_handle());
+                max_open_ = std::max(max_open_, open_sockets_.size());
+            }
+            connection_threads_.emplace_back([this, socket = std::move(socket)]() mutable { Serve(socket); });
+            Accept();
+        });
+    }
+
+    void Serve(boost::asio::ip::tcp::socket& socket) {
+        boost::beast::flat_buffer buffer;
+        std::string pending_method;
+        for (;;) {
+            beast_http::request<beast_http::string_body> request;
+            boost::system::error_code ec;
+            beast_http::read(socket, buffer, request, ec);
+            if (ec) {
+                break;
+            }
+            const std::string method(request.method_string());
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                records_.push_back({method, std::string(request.target()), pending_method});
+            }
+
+            // 回复前下一个请求已经到达，说明它是流水线发送的
+            std::this_thread::sleep_for(delay_);
+            pending_method = buffer.size() > 0 || socket.available(ec) > 0 ? method : std::string();
+
+            beast_http::response<beast_http::string_body> response{beast_http::status::ok, 11};
+            response.body() = std::string(request.target());
+            response.keep_alive(true);
+            response.prepare_payload();
+            beast_http::write(socket, response, ec);
+            if (ec) {
+                break;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_sockets_.erase(std::remove(open_sockets_.begin(), open_sockets_.end(), socket.native_handle()),
+                            open_sockets_.end());
+    }
+
+    std::chrono::milliseconds delay_;
+    boost::asio::io_context io_context_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::thread io_thread_;
+    std::vector<std::thread> connection_threads_;
+
+    mutable std::mutex mutex_;
+    std::vector<int> open_sockets_;
+    size_t accepted_ = 0;
+    size_t max_open_ = 0;
+    std::vector<Record> records_;
+};
+
+// 等待一组异步请求全部完成
+class Completion {
+public:
+    HttpResponseCallback Callback() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++expected_;
+        return [this](boost::system::error_code ec, const HttpResponse& response) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!ec && response.GetStatusCode() == HttpStatusCode::OK) {
+                ++succeeded_;
+            }
+            ++completed_;
+            cv_.notify_all();
+        };
+    }
+
+    // 全部完成且成功时返回true
+    bool Wait(std::chrono::milliseconds timeout = 10s) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, timeout, [this]() { return completed_ == expected_; });
+        return completed_ == expected_ && succeeded_ == expected_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t expected_ = 0;
+    size_t completed_ = 0;
+    size_t succeeded_ = 0;
+};
+
+} // anonymous namespace
+
+TEST(HttpClientPoolTest, ConnectionLimitIsEnforcedPerOrigin) {
+    RecordingServer first(100ms);
+    RecordingServer second(100ms);
+    HttpConfig config;
+    config.max_connections_per_host = 2;
+    Completion completion;
+    {
+        HttpClient client(2, config);
+        for (int i = 0; i < 6; ++i) {
+            client.Get(first.Url("/first/" + std::to_string(i)), completion.Callback());
+            client.Get(second.Url("/second/" + std::to_string(i)), completion.Callback());
+        }
+        ASSERT_TRUE(completion.Wait());
+    }
+
+    // 每个源站各自用满两个连接，超出的请求排队复用这两个连接
+    for (const RecordingServer* server : {&first, &second}) {
+        EXPECT_EQ(server->GetMaxOpen(), 2u);
+        EXPECT_EQ(server->GetAccepted(), 2u);
+        EXPECT_EQ(server->GetRecords().size(), 6u);
+    }
+}
+
+TEST(HttpClientPoolTest, NonIdempotentRequestsAreNeverPipelined) {
+    RecordingServer server(150ms);
+    HttpConfig config;
+    config.max_connections_per_host = 1;
+    config.enable_pipelining = true;
+    config.max_pipeline_depth = 4;
+    Completion completion;
+    {
+        HttpClient client(2, config);
+        client.Get(server.Url("/a"), completion.Callback());
+        client.Get(server.Url("/b"), completion.Callback());
+        client.Post(server.Url("/c"), "payload", completion.Callback());
+        client.Get(server.Url("/d"), completion.Callback());
+        client.Patch(server.Url("/e"), "payload", completion.Callback());
+        client.Get(server.Url("/f"), completion.Callback());
+        ASSERT_TRUE(completion.Wait());
+    }
+
+    const auto records = server.GetRecords();
+    ASSERT_EQ(records.size(), 6u);
+    EXPECT_EQ(server.GetAccepted(), 1u);
+    size_t pipelined_gets = 0;
+    for (const auto& record : records) {
+        // POST/PATCH既不在未完成的请求之后发出，也不让后续请求排在它后面
+        if (record.method == "POST" || record.method == "PATCH") {
+            EXPECT_EQ(record.pipelined_behind, "") << record.target;
+        }
+        EXPECT_NE(record.pipelined_behind, "POST") << record.target;
+        EXPECT_NE(record.pipelined_behind, "PATCH") << record.target;
+        if (record.method == "GET" && !record.pipelined_behind.empty()) {
+            ++pipelined_gets;
+        }
+    }
+    // GET确实走了流水线，上面的检查才有意义
+    EXPECT_GT(pipelined_gets, 0u);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file test_http_compression.cpp
+ * @brief 压缩中间件测试：压缩结果缓存键
+ */
+
+#include "common/network/http/http_compression.h"
+#include "common/network/http/http_middleware.h"
+#include <gtest/gtest.h>
+
+using namespace common::network::http;
+
+namespace {
+
+std::string PageBody(const std::string& page) {
+    std::string body;
+    for (int i = 0; i < 64; ++i) {
+        body += "page " + page + " item " + std::to_string(i) + "\n";
+    }
+    return body;
+}
+
+HttpResponse Compress(CompressionMiddleware& middleware, const std::string& url, const std::string& etag,
+                      const std::string& body) {
+    HttpRequest request(HttpMethod::GET, url);
+    request.SetHeader("Accept-Encoding", "gzip");
+
+    HttpResponse response;
+    middleware.Handle(request, response, [&]() {
+        response.SetStatusCode(HttpStatusCode::OK);
+        response.SetBody(body, "text/plain");
+        response.SetHeader("ETag", etag);
+    });
+    return response;
+}
+
+std::string Gzip(const std::string& body) {
+    std::string output;
+    EXPECT_TRUE(HttpCompressor::Compress(body, "gzip", 6, output));
+    return output;
+}
+
+} // anonymous namespace
+
+TEST(HttpCompressionCacheTest, EtagKeyIncludesQuery) {
+    const auto page1 = HttpCompressionCache::MakeKey("gzip", "W/\"v1\"", "/list?page=1", "a");
+    const auto page2 = HttpCompressionCache::MakeKey("gzip", "W/\"v1\"", "/list?page=2", "b");
+    EXPECT_NE(page1, page2);
+    EXPECT_EQ(page1, HttpCompressionCache::MakeKey("gzip", "W/\"v1\"", "/list?page=1", "other body"));
+    EXPECT_NE(page1, HttpCompressionCache::MakeKey("br", "W/\"v1\"", "/list?page=1", "a"));
+
+    // 无ETag时按响应体哈希，与路径无关
+    EXPECT_EQ(HttpCompressionCache::MakeKey("gzip", "", "/a", "same"),
+              HttpCompressionCache::MakeKey("gzip", "", "/b", "same"));
+}
+
+TEST(CompressionMiddlewareTest, SameEtagOnDifferentQueriesIsNotShared) {
+    CompressionMiddleware::CompressionConfig config;
+    config.encodings = {"gzip"};
+    config.min_size = 16;
+    CompressionMiddleware middleware(config);
+
+    // 分页接口对每页返回相同的弱ETag（如按数据版本生成）
+    const std::string body1 = PageBody("1");
+    const std::string body2 = PageBody("2");
+    auto first = Compress(middleware, "http://localhost/list?page=1", "W/\"v1\"", body1);
+    auto second = Compress(middleware, "http://localhost/list?page=2", "W/\"v1\"", body2);
+
+    EXPECT_EQ(first.GetHeader("Content-Encoding"), "gzip");
+    EXPECT_EQ(second.GetHeader("Content-Encoding"), "gzip");
+    EXPECT_EQ(first.GetBody(), Gzip(body1));
+    EXPECT_EQ(second.GetBody(), Gzip(body2));
+
+    // 同一请求目标命中缓存
+    auto again = Compress(middleware, "http://localhost/list?page=1", "W/\"v1\"", body1);
+    EXPECT_EQ(again.GetBody(), first.GetBody());
+}
@@ -0,0 +1,165 @@
+/**
+ * @file test_http_etag.cpp
+ * @brief ETag测试：Hash64参考值、If-None-Match的强/弱比较、列表与*、304响应和版本提供者短路
+ */
+
+#include "common/network/http/http_middleware.h"
+#include <gtest/gtest.h>
+
+using namespace common::network::http;
+
+namespace {
+
+HttpResponse Send(EtagMiddleware& etag, const std::string& url, const std::string& if_none_match,
+                  const std::function<void(HttpResponse&)>& handler, HttpMethod method = HttpMethod::GET) {
+    HttpRequest request(method, url);
+    if (!if_none_match.empty()) {
+        request.SetHeader("If-None-Match", if_none_match);
+    }
+    HttpResponse response;
+    etag.Handle(request, response, [&]() { handler(response); });
+    return response;
+}
+
+void JsonBody(HttpResponse& response) {
+    response.SetStatusCode(HttpStatusCode::OK);
+    response.SetBody("{\"items\":[1,2,3]}", "application/json");
+}
+
+} // anonymous namespace
+
+TEST(HttpEtagTest, Hash64MatchesXxHash64ReferenceValues) {
+    EXPECT_EQ(HttpUtils::Hash64(""), 0xEF46DB3751D8E999ull);
+    EXPECT_EQ(HttpUtils::Hash64("abc"), 0x44BC2CF5AD770999ull);
+    // 32字节以上走四路并行分支
+    EXPECT_EQ(HttpUtils::Hash64("Nobody inspects the spammish repetition"), 0xFBCEA83C8A378BF1ull);
+    EXPECT_NE(HttpUtils::Hash64("abc", 1), HttpUtils::Hash64("abc"));
+}
+
+TEST(HttpEtagTest, StrongAndWeakTagsCompareWeakly) {
+    EXPECT_TRUE(HttpUtils::EtagMatches("\"v1\"", "\"v1\""));
+    EXPECT_TRUE(HttpUtils::EtagMatches("W/\"v1\"", "\"v1\""));
+    EXPECT_TRUE(HttpUtils::EtagMatches("\"v1\"", "W/\"v1\""));
+    EXPECT_TRUE(HttpUtils::EtagMatches("W/\"v1\"", "W/\"v1\""));
+    EXPECT_FALSE(HttpUtils::EtagMatches("\"v2\"", "\"v1\""));
+    // 引号是标签的一部分
+    EXPECT_FALSE(HttpUtils::EtagMatches("v1", "\"v1\""));
+}
+
+TEST(HttpEtagTest, ListsAndWildcardMatchAnyEntry) {
+    EXPECT_TRUE(HttpUtils::EtagMatches("\"a\", \"b\",\"v1\"", "\"v1\""));
+    EXPECT_TRUE(HttpUtils::EtagMatches("\"a\" ,  W/\"v1\" ", "\"v1\""));
+    EXPECT_FALSE(HttpUtils::EtagMatches("\"a\", \"b\"", "\"v1\""));
+    EXPECT_FALSE(HttpUtils::EtagMatches(" , ,", "\"v1\""));
+    EXPECT_TRUE(HttpUtils::EtagMatches("*", "\"v1\""));
+    EXPECT_TRUE(HttpUtils::EtagMatches("\"a\", *", "\"v1\""));
+}
+
+TEST(HttpEtagTest, MatchingBodyHashReturns304WithoutBody) {
+    EtagMiddleware etag;
+    const HttpResponse first = Send(etag, "http://localhost/items", "", JsonBody);
+    ASSERT_EQ(first.GetStatusCode(), HttpStatusCode::OK);
+    const std::string tag = first.GetHeader("ETag");
+    ASSERT_FALSE(tag.empty());
+    EXPECT_EQ(tag.front(), '"');
+
+    const HttpResponse cached = Send(etag, "http://localhost/items", "W/" + tag, JsonBody);
+    EXPECT_EQ(cached.GetStatusCode(), HttpStatusCode::NOT_MODIFIED);
+    EXPECT_TRUE(cached.GetBody().empty());
+    EXPECT_EQ(cached.GetHeader("ETag"), tag);
+    EXPECT_FALSE(cached.HasHeader("Content-Type"));
+    EXPECT_FALSE(cached.HasHeader("Content-Length"));
+
+    // 标签不匹配时返回完整响应
+    const HttpResponse changed = Send(etag, "http://localhost/items", "\"stale\"", JsonBody);
+    EXPECT_EQ(changed.GetStatusCode(), HttpStatusCode::OK);
+    EXPECT_EQ(changed.GetBody(), first.GetBody());
+
+    // 非GET/HEAD请求和非200响应不生成ETag
+    EXPECT_FALSE(Send(etag, "http://localhost/items", "*", JsonBody, HttpMethod::POST).HasHeader("ETag"));
+    const HttpResponse missing = Send(etag, "http://localhost/items", "*", [](HttpResponse& response) {
+        response.SetStatusCode(HttpStatusCode::NOT_FOUND);
+    });
+    EXPECT_EQ(missing.GetStatusCode(), HttpStatusCode::NOT_FOUND);
+
+    const auto stats = etag.GetStats();
+    EXPECT_EQ(stats.not_modified, 1u);
+    EXPECT_EQ(stats.handler_skipped, 0u);
+    EXPECT_EQ(stats.saved_bytes, first.GetBody().size());
+}
+
+TEST(HttpEtagTest, HandlerEtagIsUsedInsteadOfBodyHash) {
+    EtagMiddleware etag;
+    const auto handler = [](HttpResponse& response) {
+        JsonBody(response);
+        response.SetHeader("ETag", "W/\"rev-7\"");
+    };
+    EXPECT_EQ(Send(etag, "http://localhost/items", "", handler).GetHeader("ETag"), "W/\"rev-7\"");
+    EXPECT_EQ(Send(etag, "http://localhost/items", "\"rev-7\"", handler).GetStatusCode(), HttpStatusCode::NOT_MODIFIED);
+    EXPECT_EQ(etag.GetStats().hashed_bytes, 0u);
+}
+
+TEST(HttpEtagTest, VersionProviderSkipsHandlerWhenClientCopyIsCurrent) {
+    EtagMiddleware::EtagConfig config;
+    std::string version = "42";
+    config.version_providers["/config"] = [&](const HttpRequest&) { return version; };
+    EtagMiddleware etag(config);
+
+    int handler_calls = 0;
+    const auto handler = [&](HttpResponse& response) {
+        ++handler_calls;
+        JsonBody(response);
+    };
+
+    const HttpResponse first = Send(etag, "http://localhost/config/routes", "", handler);
+    EXPECT_EQ(first.GetHeader("ETag"), "\"42\"");
+    EXPECT_EQ(handler_calls, 1);
+
+    // 版本未变时不执行处理器
+    const HttpResponse cached = Send(etag, "http://localhost/config/routes", "\"42\"", handler);
+    EXPECT_EQ(cached.GetStatusCode(), HttpStatusCode::NOT_MODIFIED);
+    EXPECT_EQ(cached.GetHeader("ETag"), "\"42\"");
+    EXPECT_TRUE(cached.GetBody().empty());
+    EXPECT_EQ(handler_calls, 1);
+
+    // 版本变化后重新生成响应
+    version = "43";
+    const HttpResponse updated = Send(etag, "http://localhost/config/routes", "\"42\"", handler);
+    EXPECT_EQ(updated.GetStatusCode(), HttpStatusCode::OK);
+    EXPECT_EQ(updated.GetHeader("ETag"), "\"43\"");
+    EXPECT_EQ(handler_calls, 2);
+
+    // 版本未知时回退到响应体哈希
+    version.clear();
+    const HttpResponse hashed = Send(etag, "http://localhost/config/routes", "\"42\"", handler);
+    EXPECT_EQ(hashed.GetStatusCode(), HttpStatusCode::OK);
+    EXPECT_NE(hashed.GetHeader("ETag"), "\"42\"");
+    EXPECT_EQ(handler_calls, 3);
+
+    const auto stats = etag.GetStats();
+    EXPECT_EQ(stats.not_modified, 1u);
+    EXPECT_EQ(stats.handler_skipped, 1u);
+    EXPECT_EQ(stats.saved_bytes, 0u);
+}
+
+TEST(HttpEtagTest, MakeEtagHashesVersionsWithInvalidCharacters) {
+    EXPECT_EQ(EtagMiddleware::MakeEtag("snapshot-3"), "\"snapshot-3\"");
+    const std::string hashed = EtagMiddleware::MakeEtag("has \"quotes\" and spaces");
+    EXPECT_EQ(hashed.size(), 19u);
+    EXPECT_EQ(hashed.substr(0, 2), "\"v");
+    EXPECT_EQ(hashed, EtagMiddleware::MakeEtag("has \"quotes\" and spaces"));
+}
+
+TEST(HttpEtagTest, CheckVersionLetsHandlerReturnEarly) {
+    HttpRequest request(HttpMethod::GET, "http://localhost/items");
+    request.SetHeader("If-None-Match", "\"a\", \"7\"");
+    HttpResponse response;
+    EXPECT_TRUE(EtagMiddleware::CheckVersion(request, response, "7"));
+    EXPECT_EQ(response.GetStatusCode(), HttpStatusCode::NOT_MODIFIED);
+    EXPECT_EQ(response.GetHeader("ETag"), "\"7\"");
+
+    HttpResponse stale;
+    EXPECT_FALSE(EtagMiddleware::CheckVersion(request, stale, "8"));
+    EXPECT_EQ(stale.GetHeader("ETag"), "\"8\"");
+    EXPECT_NE(stale.GetStatusCode(), HttpStatusCode::NOT_MODIFIED);
+}
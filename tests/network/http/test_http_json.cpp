@@ -0,0 +1,134 @@
+/**
+ * @file test_http_json.cpp
+ * @brief JSON测试：流式写入器的字符串转义与数字格式、分隔符，以及消息体解析缓存的重置
+ */
+
+#include "common/network/http/http_json.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+
+using namespace common::network::http;
+
+namespace {
+
+std::string WriteString(std::string_view value) {
+    std::string out;
+    HttpJsonWriter(out).String(value);
+    return out;
+}
+
+std::string WriteDouble(double value) {
+    std::string out;
+    HttpJsonWriter(out).Double(value);
+    return out;
+}
+
+} // anonymous namespace
+
+TEST(HttpJsonWriterTest, EscapesQuotesBackslashesAndControlCharacters) {
+    EXPECT_EQ(WriteString(""), "\"\"");
+    EXPECT_EQ(WriteString("plain text"), "\"plain text\"");
+    EXPECT_EQ(WriteString("say \"hi\""), "\"say \\\"hi\\\"\"");
+    EXPECT_EQ(WriteString("C:\\dir\\"), "\"C:\\\\dir\\\\\"");
+    EXPECT_EQ(WriteString("a\nb\rc\td\be\ff"), "\"a\\nb\\rc\\td\\be\\ff\"");
+    EXPECT_EQ(WriteString(std::string_view("\0\x01\x1f", 3)), "\"\\u0000\\u0001\\u001f\"");
+    // '/'与DEL不需要转义
+    EXPECT_EQ(WriteString("a/b\x7f"), "\"a/b\x7f\"");
+
+    // 每个控制字符都能被解析器读回原值
+    std::string all;
+    for (int c = 0; c < 0x20; ++c) {
+        all.push_back(static_cast<char>(c));
+    }
+    all += "\"\\";
+    EXPECT_EQ(nlohmann::json::parse(WriteString(all)).get<std::string>(), all);
+}
+
+TEST(HttpJsonWriterTest, NonAsciiBytesAreCopiedVerbatim) {
+    const std::string text = "\xe4\xbd\xa0\xe5\xa5\xbd \xf0\x9f\x98\x80 caf\xc3\xa9";
+    EXPECT_EQ(WriteString(text), "\"" + text + "\"");
+    EXPECT_EQ(nlohmann::json::parse(WriteString(text)).get<std::string>(), text);
+
+    // 键与值使用同样的转义
+    const HttpJsonKey key("na\"me\xc3\xa9");
+    EXPECT_EQ(key.GetRendered(), "\"na\\\"me\xc3\xa9\":");
+}
+
+TEST(HttpJsonWriterTest, IntegersUseFullRange) {
+    std::string out;
+    HttpJsonWriter writer(out);
+    writer.BeginArray()
+          .Int(0)
+          .Int(-42)
+          .Int(std::numeric_limits<int64_t>::min())
+          .Int(std::numeric_limits<int64_t>::max())
+          .Uint(std::numeric_limits<uint64_t>::max())
+          .Value(static_cast<uint8_t>(200))
+          .Value(static_cast<int16_t>(-7))
+          .Value(true)
+          .Value(nullptr)
+          .EndArray();
+    EXPECT_EQ(out, "[0,-42,-9223372036854775808,9223372036854775807,18446744073709551615,200,-7,true,null]");
+    EXPECT_EQ(writer.GetDepth(), 0u);
+}
+
+TEST(HttpJsonWriterTest, DoublesRoundTripAndNonFiniteBecomesNull) {
+    EXPECT_EQ(WriteDouble(0.0), "0");
+    EXPECT_EQ(WriteDouble(1.5), "1.5");
+    EXPECT_EQ(WriteDouble(-2.0), "-2");
+    EXPECT_EQ(WriteDouble(0.1), "0.1");
+    EXPECT_EQ(WriteDouble(std::numeric_limits<double>::quiet_NaN()), "null");
+    EXPECT_EQ(WriteDouble(std::numeric_limits<double>::infinity()), "null");
+    EXPECT_EQ(WriteDouble(-std::numeric_limits<double>::infinity()), "null");
+
+    // 最短表示读回相同的值，指数形式也是合法JSON
+    for (double value : {1e300, 5e-324, 123456789.125, -1.0 / 3.0, 1e21}) {
+        const std::string text = WriteDouble(value);
+        EXPECT_EQ(nlohmann::json::parse(text).get<double>(), value) << text;
+    }
+    EXPECT_EQ(WriteDouble(1.0f / 3.0f), WriteDouble(static_cast<double>(1.0f / 3.0f)));
+}
+
+TEST(HttpJsonWriterTest, SeparatorsAndTakeProduceValidDocument) {
+    static const HttpJsonKey kId("id");
+    HttpJsonWriter writer;
+    writer.BeginObject().Member("count", 2).Key("items").BeginArray();
+    std::string streamed = writer.Take();
+    for (int i = 0; i < 2; ++i) {
+        writer.BeginObject().Member(kId, i).Member("tags", nlohmann::json::array({"a"})).EndObject();
+        streamed += writer.Take();
+    }
+    writer.EndArray().Member("empty", nlohmann::json::object()).EndObject();
+    EXPECT_EQ(writer.GetDepth(), 0u);
+    streamed += writer.Take();
+    EXPECT_EQ(writer.GetSize(), 0u);
+
+    EXPECT_EQ(streamed, "{\"count\":2,\"items\":[{\"id\":0,\"tags\":[\"a\"]},{\"id\":1,\"tags\":[\"a\"]}],\"empty\":{}}");
+}
+
+TEST(HttpJsonCacheTest, ResetDropsParsedBodyAndValidity) {
+    HttpJsonCache cache;
+    EXPECT_EQ(cache.Get("{\"a\":1}")["a"], 1);
+    // 未重置时沿用缓存，不重新解析
+    EXPECT_EQ(cache.Get("{\"a\":2}")["a"], 1);
+
+    cache.Reset();
+    EXPECT_TRUE(cache.Get("not json").is_null());
+    EXPECT_FALSE(cache.GetDocument("not json")->IsValid());
+
+    cache.Reset();
+    EXPECT_TRUE(cache.Get("[1,2]").is_array());
+    const auto document = cache.GetDocument("[1,2]");
+    ASSERT_TRUE(document->IsValid());
+    EXPECT_EQ(document->GetSize(), 2u);
+
+    // 重置后先取文档，再由文档生成树
+    cache.Reset();
+    const auto invalid = cache.GetDocument("{");
+    EXPECT_FALSE(invalid->IsValid());
+    EXPECT_TRUE(cache.Get("{").is_null());
+    cache.Reset();
+    EXPECT_EQ(cache.GetDocument("{\"b\":true}")->GetBool("/b"), true);
+    EXPECT_EQ(cache.Get("{\"b\":true}")["b"], true);
+}
@@ -0,0 +1,114 @@
+#include "common/network/http/http_message.h"
+#include "common/network/http/http_json.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <nlohmann/json.hpp>
+
+using namespace common::network::http;
+
+// Representative API payload: an object with a list of player records
+std::string MakePayload(size_t target_size) {
+    std::mt19937 rng(7);
+    nlohmann::json players = nlohmann::json::array();
+    nlohmann::json root = {{"request_id", "bench"}, {"version", 3}, {"players", nullptr}};
+
+    std::string body;
+    size_t index = 0;
+    do {
+        for (int i = 0; i < 8; ++i, ++index) {
+            players.push_back({
+                {"id", 100000 + index},
+                {"name", "player_" + std::to_string(index)},
+                {"level", static_cast<int>(rng() % 100)},
+                {"score", static_cast<double>(rng() % 1000000) / 7.0},
+                {"online", (rng() & 1) != 0},
+                {"guild", {{"id", static_cast<int>(rng() % 500)}, {"tag", "G" + std::to_string(rng() % 500)}}},
+                {"items", {rng() % 1000, rng() % 1000, rng() % 1000, rng() % 1000}}
+            });
+        }
+        root["players"] = players;
+        body = root.dump();
+    } while (body.size() < target_size);
+
+    return body;
+}
+
+template <typename Function>
+double MeasureMicros(int iterations, Function&& function) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        function();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+}
+
+void Report(const std::string& name, size_t bytes, double micros) {
+    const double mb_per_second = micros > 0 ? (bytes / micros) : 0;
+    std::cout << "  " << std::left << std::setw(44) << name
+              << std::right << std::setw(12) << std::fixed << std::setprecision(2) << micros << " us"
+              << std::setw(10) << std::setprecision(1) << mb_per_second << " MB/s" << std::endl;
+}
+
+void BenchmarkPayload(size_t target_size) {
+    const std::string body = MakePayload(target_size);
+    const int iterations = static_cast<int>(std::max<size_t>(5, (64u * 1024 * 1024) / body.size()));
+    const std::string last = "/players/" + std::to_string(
+        nlohmann::json::parse(body)["players"].size() - 1) + "/name";
+    size_t sink = 0;
+
+    std::cout << "\n=== Payload " << body.size() << " bytes, " << iterations << " iterations ===" << std::endl;
+
+    // Before: every GetJsonBody call parsed the body again (middleware + handler = 2 parses)
+    Report("nlohmann::json::parse x2", body.size(), MeasureMicros(iterations, [&]() {
+        for (int i = 0; i < 2; ++i) {
+            auto json = nlohmann::json::parse(body);
+            sink += json["players"].size();
+        }
+    }));
+
+    Report("HttpRequest::GetJsonBody x2 (cached)", body.size(), MeasureMicros(iterations, [&]() {
+        HttpRequest request;
+        request.SetJsonBody(body);
+        for (int i = 0; i < 2; ++i) {
+            sink += request.GetJsonBody()["players"].size();
+        }
+    }));
+
+    Report(std::string("HttpRequest::GetJsonDocument x2 (") + HttpJsonDocument::GetBackend() + ")",
+           body.size(), MeasureMicros(iterations, [&]() {
+        HttpRequest request;
+        request.SetJsonBody(body);
+        for (int i = 0; i < 2; ++i) {
+            auto document = request.GetJsonDocument();
+            sink += document->GetSize("/players") + document->GetString(last).value_or("").size();
+        }
+    }));
+
+    Report("GetJsonDocument, then GetJsonBody", body.size(), MeasureMicros(iterations, [&]() {
+        HttpRequest request;
+        request.SetJsonBody(body);
+        sink += request.GetJsonDocument()->GetSize("/players");
+        sink += request.GetJsonBody()["players"].size();
+    }));
+
+    if (sink == 0) {
+        std::cout << "unexpected empty result" << std::endl;
+    }
+}
+
+int main() {
+    std::cout << "Zeus HTTP JSON Body Performance Test" << std::endl;
+    std::cout << "====================================" << std::endl;
+    std::cout << "JSON document backend: " << HttpJsonDocument::GetBackend() << std::endl;
+
+    for (size_t size : {1024u, 16u * 1024, 256u * 1024, 1024u * 1024}) {
+        BenchmarkPayload(size);
+    }
+
+    std::cout << "\nHTTP JSON performance test completed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file test_http_message.cpp
+ * @brief 请求对象测试：查询参数和Cookie的延迟解析、请求级内存与复制/移动
+ */
+
+#include "common/network/http/http_message.h"
+#include <gtest/gtest.h>
+
+using namespace common::network::http;
+namespace beast_http = boost::beast::http;
+
+namespace {
+
+// 统计分配次数的内存资源，用于确认只解析一次
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t GetAllocations() const { return allocations_; }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations_;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    size_t allocations_ = 0;
+};
+
+HttpRequest ParsedRequest(const std::string& target, const std::string& cookie) {
+    beast_http::request<beast_http::string_body> request{beast_http::verb::get, target, 11};
+    request.set(beast_http::field::cookie, cookie);
+    return HttpRequest::FromBeastRequest(std::move(request));
+}
+
+} // anonymous namespace
+
+TEST(HttpRequestTest, PendingQueryAndCookiesAreParsedOnce) {
+    CountingResource arena;
+    auto request = ParsedRequest("/items?page=2&sort=name%20asc&page=3", "sid=abc; theme=dark");
+    request.SetArena(&arena);
+
+    EXPECT_EQ(request.GetParam("page"), "3");
+    const size_t after_query = arena.GetAllocations();
+    EXPECT_GT(after_query, 0u);
+    EXPECT_EQ(request.GetParam("sort"), "name asc");
+    EXPECT_TRUE(request.HasParam("page"));
+    EXPECT_FALSE(request.HasParam("missing"));
+    EXPECT_EQ(arena.GetAllocations(), after_query);
+
+    const auto sid = request.GetCookieView("sid");
+    EXPECT_EQ(sid, "abc");
+    const size_t after_cookies = arena.GetAllocations();
+    EXPECT_EQ(request.GetCookieView("theme"), "dark");
+    EXPECT_EQ(request.GetCookieView("sid").data(), sid.data());
+    EXPECT_EQ(arena.GetAllocations(), after_cookies);
+
+    // 物化为参数表时不再重复解析，重复的键以最后一个值为准
+    EXPECT_EQ(request.GetParams().at("page"), "3");
+    EXPECT_EQ(request.GetCookies().size(), 2u);
+    EXPECT_EQ(arena.GetAllocations(), after_cookies);
+}
+
+TEST(HttpRequestTest, CopyDoesNotReferenceRequestArena) {
+    auto arena = std::make_unique<HttpArena>();
+    auto request = ParsedRequest("/items?page=2", "sid=abc");
+    request.SetArena(arena->Resource());
+    ASSERT_EQ(request.GetParam("page"), "2");
+    ASSERT_EQ(request.GetCookieView("sid"), "abc");
+
+    HttpRequest copy = request;
+    HttpRequest assigned;
+    assigned = request;
+    EXPECT_EQ(copy.GetArena(), std::pmr::get_default_resource());
+    EXPECT_EQ(assigned.GetArena(), std::pmr::get_default_resource());
+
+    // 原请求结束、竞技场释放后副本仍可访问
+    request.SetArena(nullptr);
+    arena.reset();
+    for (const HttpRequest* r : {&copy, &assigned}) {
+        EXPECT_EQ(r->GetParam("page"), "2");
+        EXPECT_EQ(r->GetCookieView("sid"), "abc");
+        EXPECT_EQ(r->GetCookies().size(), 1u);
+    }
+}
+
+TEST(HttpRequestTest, MoveKeepsArenaAndReparsesViews) {
+    HttpArena arena;
+    // 短Cookie头保存在字符串内部，移动后原视图失效
+    auto request = ParsedRequest("/items?page=2", "a=1");
+    request.SetArena(arena.Resource());
+    ASSERT_EQ(request.GetCookieView("a"), "1");
+
+    HttpRequest moved = std::move(request);
+    EXPECT_EQ(moved.GetArena(), arena.Resource());
+    const auto value = moved.GetCookieView("a");
+    EXPECT_EQ(value, "1");
+    EXPECT_EQ(moved.GetParam("page"), "2");
+
+    moved.SetArena(nullptr);
+}
+
+TEST(HttpRequestTest, SetUrlDropsCachedQuery) {
+    auto request = ParsedRequest("/items?page=2", "");
+    ASSERT_EQ(request.GetParam("page"), "2");
+
+    HttpUrl url("http://localhost/items?page=5");
+    request.SetUrl(url);
+    EXPECT_EQ(request.GetParam("page"), "5");
+}
@@ -0,0 +1,190 @@
+/**
+ * @file test_http_metrics.cpp
+ * @brief 服务端指标测试：直方图桶边界与上界、溢出桶、分片合并和Prometheus累计le输出
+ */
+
+#include "common/network/http/http_metrics.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace common::network::http;
+using namespace std::chrono_literals;
+
+namespace {
+
+template <typename Layout>
+void ExpectContiguousBuckets() {
+    // 小值各占一个桶
+    for (uint64_t value = 0; value < (uint64_t(1) << Layout::kSubBucketBits); ++value) {
+        EXPECT_EQ(Layout::GetBucket(value), value);
+        EXPECT_EQ(Layout::GetUpperBound(value), value);
+    }
+
+    // 每个桶的上界属于该桶，上界加一属于下一个桶，桶宽不超过下界的1/2^SubBucketBits
+    uint64_t lower = 0;
+    for (size_t bucket = 0; bucket + 1 < Layout::kBucketCount; ++bucket) {
+        const uint64_t upper = Layout::GetUpperBound(bucket);
+        ASSERT_EQ(Layout::GetBucket(lower), bucket);
+        ASSERT_EQ(Layout::GetBucket(upper), bucket);
+        ASSERT_EQ(Layout::GetBucket(upper + 1), bucket + 1);
+        ASSERT_LE((upper - lower) << Layout::kSubBucketBits, std::max<uint64_t>(lower, 1));
+        lower = upper + 1;
+    }
+    EXPECT_EQ(Layout::GetBucket(lower), Layout::kBucketCount - 1);
+    EXPECT_EQ(Layout::GetUpperBound(Layout::kBucketCount - 1), (uint64_t(1) << Layout::kMaxBits) - 1);
+}
+
+// 取指标行的值，如 name{labels} 3
+std::string FindSample(const std::string& text, const std::string& series) {
+    const size_t pos = text.find(series + " ");
+    if (pos == std::string::npos || (pos > 0 && text[pos - 1] != '\n')) {
+        return "<missing>";
+    }
+    const size_t start = pos + series.size() + 1;
+    return text.substr(start, text.find('\n', start) - start);
+}
+
+} // anonymous namespace
+
+TEST(HttpMetricsTest, LayoutBucketsAreContiguousWithInclusiveUpperBounds) {
+    ExpectContiguousBuckets<HttpHistogramLayout>();
+    ExpectContiguousBuckets<HttpLogLinearLayout<7>>();
+
+    EXPECT_EQ(HttpHistogramLayout::GetBucket(1000), HttpHistogramLayout::GetBucket(960));
+    EXPECT_EQ(HttpHistogramLayout::GetUpperBound(HttpHistogramLayout::GetBucket(1000)), 1023u);
+}
+
+TEST(HttpMetricsTest, OverflowBucketCollectsLargeValuesAndReportsMax) {
+    constexpr size_t kLast = HttpHistogramLayout::kBucketCount - 1;
+    EXPECT_EQ(HttpHistogramLayout::GetBucket(uint64_t(1) << HttpHistogramLayout::kMaxBits), kLast);
+    EXPECT_EQ(HttpHistogramLayout::GetBucket(UINT64_MAX), kLast);
+    // 最后一个桶同时收容溢出值，其上界对溢出值没有意义
+    const uint64_t last_lower = HttpHistogramLayout::GetUpperBound(kLast - 1) + 1;
+    EXPECT_EQ(HttpHistogramLayout::GetBucket(last_lower), kLast);
+    EXPECT_EQ(HttpHistogramLayout::GetBucket(last_lower - 1), kLast - 1);
+
+    HttpHistogramSnapshot snapshot;
+    snapshot.buckets.assign(HttpHistogramLayout::kBucketCount, 0);
+    snapshot.buckets[HttpHistogramLayout::GetBucket(10)] = 1;
+    snapshot.buckets[kLast] = 1;
+    snapshot.count = 2;
+    snapshot.max = uint64_t(1) << 50;
+    snapshot.sum = snapshot.max + 10;
+    EXPECT_EQ(snapshot.GetPercentile(50), 10u);
+    EXPECT_EQ(snapshot.GetPercentile(100), snapshot.max);
+}
+
+TEST(HttpMetricsTest, PercentileReturnsBucketUpperBoundCappedAtMax) {
+    HttpHistogramSnapshot empty;
+    EXPECT_EQ(empty.GetPercentile(99), 0u);
+
+    HttpHistogramSnapshot snapshot;
+    snapshot.buckets.assign(HttpHistogramLayout::kBucketCount, 0);
+    for (uint64_t value : {100u, 200u, 300u, 1000u}) {
+        ++snapshot.buckets[HttpHistogramLayout::GetBucket(value)];
+        ++snapshot.count;
+        snapshot.sum += value;
+    }
+    snapshot.max = 1000;
+    EXPECT_EQ(snapshot.GetPercentile(25), 103u);
+    EXPECT_EQ(snapshot.GetPercentile(50), 207u);
+    EXPECT_EQ(snapshot.GetPercentile(100), 1000u);
+    EXPECT_DOUBLE_EQ(snapshot.GetMean(), 400.0);
+}
+
+TEST(HttpMetricsTest, SnapshotsMergeAcrossShardsAndStatusClasses) {
+    HttpServerMetrics metrics(16, 4);
+    const size_t route = metrics.RegisterRoute("GET", "/items/:id");
+
+    // 每个线程写自己的分片，请求在一个线程开始、另一个线程结束
+    metrics.BeginRequest(route);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&metrics, route, t]() {
+            for (int i = 0; i < 1000; ++i) {
+                metrics.BeginRequest(route);
+                metrics.EndRequest(route, i % 10 == 0 ? HttpStatusCode::INTERNAL_SERVER_ERROR : HttpStatusCode::OK,
+                                   std::chrono::microseconds(100 * (t + 1)), 10, 100);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto snapshot = metrics.GetSnapshot();
+    ASSERT_EQ(snapshot.size(), 1u);
+    const auto& items = snapshot.front();
+    EXPECT_EQ(items.pattern, "/items/:id");
+    EXPECT_EQ(items.in_flight, 1);
+    EXPECT_EQ(items.GetRequestCount(), 4000u);
+    EXPECT_EQ(items.latency_us[1].count, 3600u);
+    EXPECT_EQ(items.latency_us[4].count, 400u);
+    EXPECT_EQ(items.request_bytes.sum, 40000u);
+    EXPECT_EQ(items.response_bytes.max, 100u);
+
+    const auto latency = items.GetLatency();
+    EXPECT_EQ(latency.count, 4000u);
+    EXPECT_EQ(latency.sum, 1000u * (100 + 200 + 300 + 400));
+    EXPECT_EQ(latency.max, 400u);
+    EXPECT_EQ(latency.buckets[HttpHistogramLayout::GetBucket(300)], 1000u);
+
+    metrics.EndRequest(route, HttpStatusCode::OK, 1ms, 0, 0);
+    const auto total = metrics.GetTotal();
+    EXPECT_EQ(total.in_flight, 0);
+    EXPECT_EQ(total.GetRequestCount(), 4001u);
+}
+
+TEST(HttpMetricsTest, MergeIntoEmptySnapshotCopiesBuckets) {
+    HttpHistogramSnapshot source;
+    source.buckets.assign(HttpHistogramLayout::kBucketCount, 0);
+    source.buckets[HttpHistogramLayout::GetBucket(42)] = 3;
+    source.count = 3;
+    source.sum = 126;
+    source.max = 42;
+
+    HttpHistogramSnapshot merged;
+    merged.Merge(HttpHistogramSnapshot{});
+    EXPECT_TRUE(merged.buckets.empty());
+    merged.Merge(source);
+    merged.Merge(source);
+    EXPECT_EQ(merged.count, 6u);
+    EXPECT_EQ(merged.sum, 252u);
+    EXPECT_EQ(merged.max, 42u);
+    EXPECT_EQ(merged.buckets[HttpHistogramLayout::GetBucket(42)], 6u);
+}
+
+TEST(HttpMetricsTest, PrometheusBucketsAreCumulativeLowerBounds) {
+    HttpServerMetrics metrics(16, 2);
+    const size_t route = metrics.RegisterRoute("GET", "/items");
+    // 959落在上界为959的桶，1000所在的桶[960,1023]跨越0.001的边界，计入下一个边界
+    for (uint64_t latency : {100u, 959u, 1000u, 3000000u, 20000000u}) {
+        metrics.BeginRequest(route);
+        metrics.EndRequest(route, HttpStatusCode::OK, std::chrono::microseconds(latency), 63, 64);
+    }
+
+    const std::string text = metrics.RenderPrometheus();
+    const std::string duration = "zeus_http_request_duration_seconds";
+    const std::string labels = "method=\"GET\",route=\"/items\",status=\"2xx\"";
+    EXPECT_NE(text.find("# TYPE " + duration + " histogram\n"), std::string::npos);
+    EXPECT_EQ(FindSample(text, duration + "_bucket{" + labels + ",le=\"0.0005\"}"), "1");
+    EXPECT_EQ(FindSample(text, duration + "_bucket{" + labels + ",le=\"0.001\"}"), "2");
+    EXPECT_EQ(FindSample(text, duration + "_bucket{" + labels + ",le=\"0.0025\"}"), "3");
+    EXPECT_EQ(FindSample(text, duration + "_bucket{" + labels + ",le=\"2.5\"}"), "3");
+    EXPECT_EQ(FindSample(text, duration + "_bucket{" + labels + ",le=\"5\"}"), "4");
+    EXPECT_EQ(FindSample(text, duration + "_bucket{" + labels + ",le=\"10\"}"), "4");
+    EXPECT_EQ(FindSample(text, duration + "_bucket{" + labels + ",le=\"+Inf\"}"), "5");
+    EXPECT_EQ(FindSample(text, duration + "_sum{" + labels + "}"), "23.002059");
+    EXPECT_EQ(FindSample(text, duration + "_count{" + labels + "}"), "5");
+    EXPECT_EQ(FindSample(text, "zeus_http_requests_in_flight{method=\"GET\",route=\"/items\"}"), "0");
+
+    // 等于2的幂边界的值所在的桶从边界开始，计入下一个边界
+    const std::string route_labels = "method=\"GET\",route=\"/items\"";
+    EXPECT_EQ(FindSample(text, "zeus_http_request_size_bytes_bucket{" + route_labels + ",le=\"64\"}"), "5");
+    EXPECT_EQ(FindSample(text, "zeus_http_response_size_bytes_bucket{" + route_labels + ",le=\"64\"}"), "0");
+    EXPECT_EQ(FindSample(text, "zeus_http_response_size_bytes_bucket{" + route_labels + ",le=\"256\"}"), "5");
+    EXPECT_EQ(FindSample(text, "zeus_http_response_size_bytes_sum{" + route_labels + "}"), "320");
+
+    // 未使用的状态类不输出
+    EXPECT_EQ(text.find("status=\"5xx\""), std::string::npos);
+}
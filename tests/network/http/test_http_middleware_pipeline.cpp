@@ -0,0 +1,220 @@
+/**
+ * @file test_http_middleware_pipeline.cpp
+ * @brief 中间件链测试：全局→路径→路由的执行顺序、短路、路径前缀按段匹配及编译期组合链
+ */
+
+#include "common/network/http/http_server.h"
+#include <gtest/gtest.h>
+
+using namespace common::network::http;
+using PrefixMatch = HttpMiddlewarePipeline::PrefixMatch;
+
+namespace {
+
+// 记录经过的各级，next之后的部分记录返回顺序
+HttpRequestHandler Trace(std::vector<std::string>& trace, const std::string& name) {
+    return [&trace, name](const HttpRequest&, HttpResponse&, std::function<void()> next) {
+        trace.push_back(name);
+        next();
+        trace.push_back("~" + name);
+    };
+}
+
+void RunPath(const HttpMiddlewarePipeline& pipeline, const std::string& path) {
+    HttpRequest request(HttpMethod::GET, "http://localhost" + path);
+    HttpResponse response;
+    pipeline.Run(request, response);
+}
+
+// 通过真实连接发送请求，返回响应体
+std::string Fetch(uint16_t port, const std::string& target) {
+    namespace beast_http = boost::beast::http;
+    boost::asio::io_context io_context;
+    boost::asio::ip::tcp::socket socket(io_context);
+    socket.connect({boost::asio::ip::make_address("127.0.0.1"), port});
+    beast_http::request<beast_http::empty_body> request{beast_http::verb::get, target, 11};
+    request.set(beast_http::field::host, "127.0.0.1");
+    beast_http::write(socket, request);
+    boost::beast::flat_buffer buffer;
+    beast_http::response<beast_http::string_body> response;
+    beast_http::read(socket, buffer, response);
+    return std::to_string(response.result_int()) + " " + response.body();
+}
+
+} // anonymous namespace
+
+TEST(HttpMiddlewarePipelineTest, StagesRunInOrderAndUnwindInReverse) {
+    std::vector<std::string> trace;
+    HttpMiddlewarePipeline pipeline;
+    pipeline.Append(Trace(trace, "global"));
+    pipeline.Append(Trace(trace, "api"), "/api");
+    pipeline.Append([&trace](const HttpRequest&, HttpResponse& response, std::function<void()>) {
+        trace.push_back("route");
+        response.SetStatusCode(HttpStatusCode::OK);
+    });
+    EXPECT_EQ(pipeline.Size(), 3u);
+
+    RunPath(pipeline, "/api/items");
+    EXPECT_EQ(trace, (std::vector<std::string>{"global", "api", "route", "~api", "~global"}));
+
+    // 前缀不匹配的级被跳过
+    trace.clear();
+    RunPath(pipeline, "/health");
+    EXPECT_EQ(trace, (std::vector<std::string>{"global", "route", "~global"}));
+}
+
+TEST(HttpMiddlewarePipelineTest, StageThatSkipsNextShortCircuits) {
+    std::vector<std::string> trace;
+    HttpMiddlewarePipeline pipeline;
+    pipeline.Append(Trace(trace, "global"));
+    pipeline.Append([&trace](const HttpRequest& request, HttpResponse& response, std::function<void()> next) {
+        trace.push_back("auth");
+        if (request.GetHeader("Authorization").empty()) {
+            response.SetStatusCode(HttpStatusCode::UNAUTHORIZED);
+            return;
+        }
+        next();
+    });
+    pipeline.Append([&trace](const HttpRequest&, HttpResponse&, std::function<void()>) {
+        trace.push_back("route");
+    });
+
+    HttpRequest request(HttpMethod::GET, "http://localhost/api/items");
+    HttpResponse response;
+    pipeline.Run(request, response);
+    EXPECT_EQ(response.GetStatusCode(), HttpStatusCode::UNAUTHORIZED);
+    EXPECT_EQ(trace, (std::vector<std::string>{"global", "auth", "~global"}));
+
+    // 最后一级调用next不会越界
+    trace.clear();
+    HttpMiddlewarePipeline tail;
+    tail.Append(Trace(trace, "only"));
+    RunPath(tail, "/");
+    EXPECT_EQ(trace, (std::vector<std::string>{"only", "~only"}));
+}
+
+TEST(HttpMiddlewarePipelineTest, RuntimePrefixMatchesWholeSegments) {
+    std::vector<std::string> trace;
+    HttpMiddlewarePipeline pipeline;
+    pipeline.Append(Trace(trace, "api"), "/api");
+    pipeline.Append(Trace(trace, "files"), "/files/");
+
+    for (const char* path : {"/api", "/api/", "/api/items"}) {
+        trace.clear();
+        RunPath(pipeline, path);
+        EXPECT_EQ(trace, (std::vector<std::string>{"api", "~api"})) << path;
+    }
+    for (const char* path : {"/apix", "/ap", "/v1/api", "/files"}) {
+        trace.clear();
+        RunPath(pipeline, path);
+        EXPECT_TRUE(trace.empty()) << path;
+    }
+    trace.clear();
+    RunPath(pipeline, "/files/a.txt");
+    EXPECT_EQ(trace, (std::vector<std::string>{"files", "~files"}));
+}
+
+TEST(HttpMiddlewarePipelineTest, HasPathPrefixRequiresSegmentBoundary) {
+    EXPECT_TRUE(HttpMiddlewarePipeline::HasPathPrefix("/api", "/api"));
+    EXPECT_TRUE(HttpMiddlewarePipeline::HasPathPrefix("/api/v1", "/api"));
+    EXPECT_TRUE(HttpMiddlewarePipeline::HasPathPrefix("/api/v1", "/api/"));
+    EXPECT_TRUE(HttpMiddlewarePipeline::HasPathPrefix("/anything", "/"));
+    EXPECT_TRUE(HttpMiddlewarePipeline::HasPathPrefix("/anything", ""));
+    EXPECT_FALSE(HttpMiddlewarePipeline::HasPathPrefix("/apix", "/api"));
+    EXPECT_FALSE(HttpMiddlewarePipeline::HasPathPrefix("/api", "/api/"));
+    EXPECT_FALSE(HttpMiddlewarePipeline::HasPathPrefix("/ap", "/api"));
+}
+
+TEST(HttpMiddlewarePipelineTest, MatchPrefixResolvesLiteralPatternsAtRegistration) {
+    EXPECT_EQ(HttpMiddlewarePipeline::MatchPrefix("/api/items", "/api"), PrefixMatch::ALWAYS);
+    EXPECT_EQ(HttpMiddlewarePipeline::MatchPrefix("/api", "/api"), PrefixMatch::ALWAYS);
+    EXPECT_EQ(HttpMiddlewarePipeline::MatchPrefix("/api/users/{id}", "/api"), PrefixMatch::ALWAYS);
+    EXPECT_EQ(HttpMiddlewarePipeline::MatchPrefix("/api/{id}", "/api/"), PrefixMatch::ALWAYS);
+    EXPECT_EQ(HttpMiddlewarePipeline::MatchPrefix("/anything", "/"), PrefixMatch::ALWAYS);
+
+    // 前缀边界：/api不匹配/apix开头的路由
+    EXPECT_EQ(HttpMiddlewarePipeline::MatchPrefix("/apix", "/api"), PrefixMatch::NEVER);
+    EXPECT_EQ(HttpMiddlewarePipeline::MatchPrefix("/apix/{id}", "/api"), PrefixMatch::NEVER);
+    EXPECT_EQ(HttpMiddlewarePipeline::MatchPrefix("/api", "/api/"), PrefixMatch::NEVER);
+    EXPECT_EQ(HttpMiddlewarePipeline::MatchPrefix("/health", "/api"), PrefixMatch::NEVER);
+    EXPECT_EQ(HttpMiddlewarePipeline::MatchPrefix("/v1/{id}", "/v2/admin"), PrefixMatch::NEVER);
+
+    // 前缀落在参数或通配符部分，需按请求路径判断
+    EXPECT_EQ(HttpMiddlewarePipeline::MatchPrefix("/files/*", "/files/private"), PrefixMatch::RUNTIME);
+    EXPECT_EQ(HttpMiddlewarePipeline::MatchPrefix("/v1/{tenant}/items", "/v1/admin"), PrefixMatch::RUNTIME);
+    EXPECT_EQ(HttpMiddlewarePipeline::MatchPrefix("/api{suffix}", "/api"), PrefixMatch::RUNTIME);
+}
+
+TEST(HttpMiddlewarePipelineTest, StaticChainCallsStagesInOrderAndCanShortCircuit) {
+    std::vector<std::string> trace;
+    auto stage = [&trace](const char* name, bool pass) {
+        return [&trace, name, pass](const HttpRequest&, HttpResponse&, auto&& next) {
+            trace.push_back(name);
+            if (pass) {
+                next();
+            }
+        };
+    };
+
+    HttpRequest request(HttpMethod::GET, "http://localhost/");
+    HttpResponse response;
+    const auto chain = MakeStaticMiddlewareChain(stage("a", true), stage("b", true), stage("c", true));
+    chain(request, response, [&trace]() { trace.push_back("next"); });
+    EXPECT_EQ(trace, (std::vector<std::string>{"a", "b", "c", "next"}));
+
+    trace.clear();
+    const auto blocked = MakeStaticMiddlewareChain(stage("a", true), stage("b", false), stage("c", true));
+    blocked(request, response, [&trace]() { trace.push_back("next"); });
+    EXPECT_EQ(trace, (std::vector<std::string>{"a", "b"}));
+
+    // 整条链作为一级放入运行时链
+    trace.clear();
+    HttpMiddlewarePipeline pipeline;
+    pipeline.Append(MakeStaticMiddlewareChain(stage("a", true), stage("b", true)));
+    pipeline.Append([&trace](const HttpRequest&, HttpResponse&, std::function<void()>) { trace.push_back("route"); });
+    pipeline.Run(request, response);
+    EXPECT_EQ(trace, (std::vector<std::string>{"a", "b", "route"}));
+}
+
+TEST(HttpMiddlewarePipelineTest, ServerRunsGlobalThenPathThenRouteStages) {
+    HttpServerConfig config;
+    config.bind_address = "127.0.0.1";
+    config.port = 0;
+    HttpServer server(2, config);
+
+    const auto mark = [](const char* name) {
+        return [name](const HttpRequest&, HttpResponse& response, std::function<void()> next) {
+            response.SetHeader("X-Trace", response.GetHeader("X-Trace") + name + ">");
+            next();
+        };
+    };
+    const HttpRequestHandler route = [](const HttpRequest&, HttpResponse& response, std::function<void()>) {
+        response.SetBody(response.GetHeader("X-Trace") + "route", "text/plain");
+    };
+
+    // 注册顺序与执行顺序无关：路径中间件总在全局中间件之后
+    server.Use("/api", mark("api"));
+    server.Get("/api/items", route);
+    server.Get("/apix", route);
+    server.Get("/files/{name}", route);
+    server.Use(mark("global"));
+    server.Use("/files/private", mark("private"));
+    server.Use("/api", [](const HttpRequest& request, HttpResponse& response, std::function<void()> next) {
+        if (request.GetParam("deny") == "1") {
+            response.SetStatusCode(HttpStatusCode::FORBIDDEN);
+            response.SetBody("denied", "text/plain");
+            return;
+        }
+        next();
+    });
+    ASSERT_TRUE(server.Start());
+    const std::string endpoint = server.GetListeningEndpoint();
+    const auto port = static_cast<uint16_t>(std::stoi(endpoint.substr(endpoint.rfind(':') + 1)));
+
+    EXPECT_EQ(Fetch(port, "/api/items"), "200 global>api>route");
+    EXPECT_EQ(Fetch(port, "/api/items?deny=1"), "403 denied");
+    EXPECT_EQ(Fetch(port, "/apix"), "200 global>route");
+    EXPECT_EQ(Fetch(port, "/files/private"), "200 global>private>route");
+    EXPECT_EQ(Fetch(port, "/files/privateer"), "200 global>route");
+    server.Stop();
+}
@@ -0,0 +1,294 @@
+/**
+ * @file test_http_multipart.cpp
+ * @brief multipart/form-data测试：跨块分隔符、传输填充、各项限制、截断的请求体、请求表单的分隔符和文件缩短
+ */
+
+#include "common/network/http/http_multipart.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+using namespace common::network::http;
+
+namespace {
+
+const std::string kBoundary = "XyZ-boundary";
+
+struct ParsedPart {
+    std::string name;
+    std::string filename;
+    std::string content_type;
+    std::string data;
+    bool ended = false;
+};
+
+// 记录各回调收到的内容
+class Collector {
+public:
+    explicit Collector(HttpMultipartParser& parser) {
+        parser.OnPartBegin([this](HttpMultipartPart& part) {
+            parts.push_back({part.name, part.filename, part.content_type, "", false});
+            return true;
+        });
+        parser.OnPartData([this](const HttpMultipartPart&, std::string_view data) {
+            parts.back().data.append(data);
+            ++data_calls;
+            return true;
+        });
+        parser.OnPartEnd([this](const HttpMultipartPart&) {
+            parts.back().ended = true;
+            return true;
+        });
+    }
+
+    std::vector<ParsedPart> parts;
+    size_t data_calls = 0;
+};
+
+std::string Part(const std::string& headers, const std::string& content) {
+    return "--" + kBoundary + "\r\n" + headers + "\r\n\r\n" + content + "\r\n";
+}
+
+std::string Field(const std::string& name, const std::string& content) {
+    return Part("Content-Disposition: form-data; name=\"" + name + "\"", content);
+}
+
+std::string Closing() {
+    return "--" + kBoundary + "--\r\n";
+}
+
+} // anonymous namespace
+
+TEST(HttpMultipartParserTest, DelimiterSplitAtEveryPosition) {
+    // 内容中含有分隔符的前缀，不能被误判为分隔符
+    const std::string tricky = "line\r\n--XyZ-bound\r\r\n-\r\n--XyZ-boundarY";
+    HttpMultipartWriter writer(kBoundary);
+    writer.AddField("text", tricky);
+    writer.AddFile("upload", "a.bin", std::string("\0\r\n\r\n\xff", 6), "application/octet-stream");
+    writer.AddField("empty", "");
+    const std::string body = "preamble\r\n" + writer.ToString() + "epilogue";
+
+    for (size_t split = 0; split <= body.size(); ++split) {
+        HttpMultipartParser parser(kBoundary);
+        Collector collector(parser);
+        ASSERT_TRUE(parser.Feed(std::string_view(body).substr(0, split))) << split;
+        ASSERT_TRUE(parser.Feed(std::string_view(body).substr(split))) << split;
+        ASSERT_TRUE(parser.Finish()) << split;
+
+        ASSERT_EQ(collector.parts.size(), 3u) << split;
+        EXPECT_EQ(collector.parts[0].name, "text");
+        EXPECT_EQ(collector.parts[0].data, tricky) << split;
+        EXPECT_EQ(collector.parts[1].filename, "a.bin");
+        EXPECT_EQ(collector.parts[1].content_type, "application/octet-stream");
+        EXPECT_EQ(collector.parts[1].data, std::string("\0\r\n\r\n\xff", 6)) << split;
+        EXPECT_EQ(collector.parts[2].data, "");
+        for (const auto& part : collector.parts) {
+            EXPECT_TRUE(part.ended);
+        }
+    }
+}
+
+TEST(HttpMultipartParserTest, ByteAtATimeDeliversContentEarly) {
+    const std::string content(100, 'a');
+    const std::string body = Field("f", content) + Closing();
+
+    HttpMultipartParser parser(kBoundary);
+    Collector collector(parser);
+    for (char c : body) {
+        ASSERT_TRUE(parser.Feed(std::string_view(&c, 1)));
+    }
+    EXPECT_TRUE(parser.IsDone());
+    ASSERT_EQ(collector.parts.size(), 1u);
+    EXPECT_EQ(collector.parts[0].data, content);
+    // 不可能构成分隔符的字节立即交给处理器，不会积压到分隔符出现
+    EXPECT_GE(collector.data_calls, content.size());
+}
+
+TEST(HttpMultipartParserTest, TransportPaddingAfterDelimiter) {
+    const std::string padded = "--" + kBoundary + " \t \r\n"
+                               "Content-Disposition: form-data; name=\"a\"\r\n\r\n1\r\n"
+                               "--" + kBoundary + "\t--\r\n";
+    HttpMultipartParser parser(kBoundary);
+    Collector collector(parser);
+    ASSERT_TRUE(parser.Feed(padded));
+    ASSERT_TRUE(parser.Finish());
+    ASSERT_EQ(collector.parts.size(), 1u);
+    EXPECT_EQ(collector.parts[0].data, "1");
+
+    // 填充过长或填充后不是换行都视为格式错误
+    HttpMultipartParser too_long(kBoundary);
+    EXPECT_FALSE(too_long.Feed("--" + kBoundary + std::string(257, ' ') + "\r\n"));
+    EXPECT_EQ(too_long.GetError(), HttpMultipartError::MALFORMED);
+
+    HttpMultipartParser garbage(kBoundary);
+    EXPECT_FALSE(garbage.Feed("--" + kBoundary + "  x\r\n"));
+    EXPECT_EQ(garbage.GetError(), HttpMultipartError::MALFORMED);
+    EXPECT_FALSE(garbage.Feed(Closing()));
+}
+
+TEST(HttpMultipartParserTest, HeaderBlockLimit) {
+    HttpMultipartLimits limits;
+    limits.max_header_size = 64;
+    const std::string long_header = "Content-Disposition: form-data; name=\"" + std::string(64, 'n') + "\"";
+
+    // 头部一次到达
+    HttpMultipartParser complete(kBoundary, limits);
+    EXPECT_FALSE(complete.Feed(Part(long_header, "x") + Closing()));
+    EXPECT_EQ(complete.GetError(), HttpMultipartError::HEADER_TOO_LARGE);
+    EXPECT_EQ(complete.GetErrorCode(), boost::beast::http::error::header_limit);
+
+    // 头部没有结束且已超限时无需等待空行
+    HttpMultipartParser partial(kBoundary, limits);
+    EXPECT_TRUE(partial.Feed("--" + kBoundary + "\r\nX-Filler: "));
+    EXPECT_FALSE(partial.Feed(std::string(80, 'f')));
+    EXPECT_EQ(partial.GetError(), HttpMultipartError::HEADER_TOO_LARGE);
+
+    HttpMultipartParser within(kBoundary, limits);
+    EXPECT_TRUE(within.Feed(Field("short", "x") + Closing()));
+    EXPECT_TRUE(within.Finish());
+}
+
+TEST(HttpMultipartParserTest, PartCountLimit) {
+    HttpMultipartLimits limits;
+    limits.max_parts = 2;
+    HttpMultipartParser parser(kBoundary, limits);
+    Collector collector(parser);
+
+    EXPECT_FALSE(parser.Feed(Field("a", "1") + Field("b", "2") + Field("c", "3") + Closing()));
+    EXPECT_EQ(parser.GetError(), HttpMultipartError::TOO_MANY_PARTS);
+    EXPECT_EQ(parser.GetErrorCode(), boost::beast::http::error::body_limit);
+    EXPECT_EQ(collector.parts.size(), 2u);
+    EXPECT_FALSE(parser.Finish());
+}
+
+TEST(HttpMultipartParserTest, PartSizeLimits) {
+    HttpMultipartLimits limits;
+    limits.max_field_size = 4;
+    limits.max_file_size = 8;
+    const std::string file_headers = "Content-Disposition: form-data; name=\"f\"; filename=\"f.txt\"";
+
+    // 普通字段和文件分别使用各自的默认上限
+    HttpMultipartParser fits(kBoundary, limits);
+    EXPECT_TRUE(fits.Feed(Field("a", "1234") + Part(file_headers, "12345678") + Closing()));
+    EXPECT_TRUE(fits.Finish());
+
+    HttpMultipartParser field(kBoundary, limits);
+    EXPECT_FALSE(field.Feed(Field("a", "12345") + Closing()));
+    EXPECT_EQ(field.GetError(), HttpMultipartError::PART_TOO_LARGE);
+
+    HttpMultipartParser file(kBoundary, limits);
+    EXPECT_FALSE(file.Feed(Part(file_headers, "123456789") + Closing()));
+    EXPECT_EQ(file.GetError(), HttpMultipartError::PART_TOO_LARGE);
+
+    // 分块到达时累计计数
+    HttpMultipartParser chunked(kBoundary, limits);
+    const std::string body = Field("a", "12345") + Closing();
+    bool ok = true;
+    for (size_t i = 0; i < body.size() && ok; i += 3) {
+        ok = chunked.Feed(std::string_view(body).substr(i, 3));
+    }
+    EXPECT_FALSE(ok);
+    EXPECT_EQ(chunked.GetError(), HttpMultipartError::PART_TOO_LARGE);
+
+    // 开始回调可以按字段调整上限
+    HttpMultipartParser raised(kBoundary, limits);
+    raised.OnPartBegin([](HttpMultipartPart& part) {
+        if (part.name == "big") {
+            part.max_size = 16;
+        }
+        return true;
+    });
+    EXPECT_TRUE(raised.Feed(Field("big", std::string(16, 'b')) + Closing()));
+    EXPECT_TRUE(raised.Finish());
+}
+
+TEST(HttpMultipartParserTest, TruncatedBodyIsIncomplete) {
+    const std::string body = Field("a", "hello") + Closing();
+
+    // 截断在任意位置（包括结束分隔符中间）都不能被当作完整请求体
+    for (size_t length = 0; length < body.size() - 2; ++length) {
+        HttpMultipartParser parser(kBoundary);
+        ASSERT_TRUE(parser.Feed(std::string_view(body).substr(0, length))) << length;
+        EXPECT_FALSE(parser.Finish()) << length;
+        EXPECT_EQ(parser.GetError(), HttpMultipartError::INCOMPLETE) << length;
+        EXPECT_EQ(parser.GetErrorCode(), boost::beast::http::error::partial_message);
+    }
+
+    // 结束分隔符之后的尾随换行属于结语，可以缺失
+    HttpMultipartParser parser(kBoundary);
+    ASSERT_TRUE(parser.Feed(std::string_view(body).substr(0, body.size() - 2)));
+    EXPECT_TRUE(parser.Finish());
+}
+
+TEST(HttpMultipartParserTest, HandlerAbortAndBoundaryParsing) {
+    HttpMultipartParser parser(kBoundary);
+    parser.OnPartData([](const HttpMultipartPart&, std::string_view) { return false; });
+    EXPECT_FALSE(parser.Feed(Field("a", "1") + Closing()));
+    EXPECT_EQ(parser.GetError(), HttpMultipartError::ABORTED);
+
+    EXPECT_EQ(HttpMultipartParser::ParseBoundary("multipart/form-data; boundary=abc"), "abc");
+    EXPECT_EQ(HttpMultipartParser::ParseBoundary("multipart/form-data; charset=utf-8; BOUNDARY=\"a b;c\""), "a b;c");
+    EXPECT_EQ(HttpMultipartParser::ParseBoundary("multipart/form-data"), "");
+
+    HttpMultipartParser invalid("");
+    EXPECT_FALSE(invalid.Feed(Closing()));
+    EXPECT_EQ(invalid.GetError(), HttpMultipartError::MALFORMED);
+}
+
+TEST(HttpMultipartParserTest, RequestFormKeepsBoundaryInContentType) {
+    HttpRequest request(HttpMethod::POST, "http://localhost/upload");
+    request.AddFormField("early", "0");
+    request.SetMultipartForm({HttpFormField("a", "1")});
+    request.SetMultipartForm({HttpFormField("b", "2"), HttpFormField("c", "3")});
+    request.AddFormField("d", "4");
+
+    // 多次设置表单后请求体仍使用Content-Type中的分隔符
+    const std::string boundary = HttpMultipartParser::ParseBoundary(request.GetContentType());
+    ASSERT_FALSE(boundary.empty());
+    HttpMultipartParser parser(boundary);
+    Collector collector(parser);
+    ASSERT_TRUE(parser.Feed(request.GetBody()));
+    ASSERT_TRUE(parser.Finish());
+
+    ASSERT_EQ(collector.parts.size(), 3u);
+    EXPECT_EQ(collector.parts[0].name, "b");
+    EXPECT_EQ(collector.parts[0].data, "2");
+    EXPECT_EQ(collector.parts[2].name, "d");
+    EXPECT_EQ(collector.parts[2].data, "4");
+}
+
+TEST(HttpMultipartWriterTest, FileThatShrankAfterSizingIsAnError) {
+    const std::string path = (std::filesystem::temp_directory_path() / "zeus_multipart_shrink.bin").string();
+    std::ofstream(path, std::ios::binary) << std::string(100, 'x');
+
+    HttpMultipartWriter writer(kBoundary, 16);
+    ASSERT_TRUE(writer.AddFileFromDisk("upload", path));
+    auto stream = HttpFileBodyStream::Open(path, 10, std::nullopt, 16);
+    ASSERT_TRUE(stream);
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << std::string(40, 'y');
+
+    // 两种文件请求体都在读到缺失的部分时报告I/O错误，而不是发送短于Content-Length的内容
+    auto drain = [](HttpBodyStream& body) {
+        std::string chunk;
+        boost::system::error_code ec;
+        while (body.Read(chunk, ec)) {
+        }
+        return ec;
+    };
+    EXPECT_EQ(drain(writer), boost::system::errc::io_error);
+    EXPECT_EQ(drain(*stream), boost::system::errc::io_error);
+
+    // 文件恢复原大小后重新读取成功
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << std::string(100, 'z');
+    ASSERT_TRUE(stream->Rewind());
+    std::string body;
+    std::string chunk;
+    boost::system::error_code ec;
+    while (stream->Read(chunk, ec)) {
+        body += chunk;
+    }
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(body, std::string(90, 'z'));
+    std::remove(path.c_str());
+}
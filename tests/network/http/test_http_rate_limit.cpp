@@ -0,0 +1,155 @@
+/**
+ * @file test_http_rate_limit.cpp
+ * @brief 速率限制中间件测试：滑动窗口滚动、成功请求归还计数、路由限额和X-Forwarded-For取址
+ */
+
+#include "common/network/http/http_middleware.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace common::network::http;
+using namespace std::chrono_literals;
+
+namespace {
+
+// 窗口按steady_clock纪元对齐，睡眠到下一个窗口开始后offset处
+void SleepUntilNextWindow(std::chrono::milliseconds window, std::chrono::milliseconds offset = 20ms) {
+    const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch());
+    const auto next = (now / window + 1) * window + offset;
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(next));
+}
+
+RateLimitMiddleware::RateLimitConfig WindowConfig(size_t max_requests) {
+    RateLimitMiddleware::RateLimitConfig config;
+    config.max_requests = max_requests;
+    config.window = 1s;
+    config.shard_count = 2;
+    config.max_keys = 64;
+    return config;
+}
+
+HttpStatusCode Send(RateLimitMiddleware& limiter, const std::string& url = "http://localhost/api",
+                    HttpStatusCode status = HttpStatusCode::OK, const std::function<void()>& during = nullptr) {
+    HttpRequest request(HttpMethod::GET, url);
+    request.SetRemoteAddress("192.0.2.1");
+    HttpResponse response;
+    limiter.Handle(request, response, [&]() {
+        if (during) {
+            during();
+        }
+        response.SetStatusCode(status);
+    });
+    return response.GetStatusCode();
+}
+
+HttpStatusCode SendForwarded(RateLimitMiddleware& limiter, const std::string& forwarded_for) {
+    HttpRequest request(HttpMethod::GET, "http://localhost/api");
+    request.SetRemoteAddress("192.0.2.1");
+    request.SetHeader("X-Forwarded-For", forwarded_for);
+    HttpResponse response;
+    limiter.Handle(request, response, [&]() { response.SetStatusCode(HttpStatusCode::OK); });
+    return response.GetStatusCode();
+}
+
+} // anonymous namespace
+
+TEST(RateLimitTest, PreviousWindowDecaysAcrossRollover) {
+    RateLimitMiddleware limiter(WindowConfig(4));
+    SleepUntilNextWindow(1s);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(Send(limiter), HttpStatusCode::OK) << i;
+    }
+    HttpRequest request(HttpMethod::GET, "http://localhost/api");
+    request.SetRemoteAddress("192.0.2.1");
+    HttpResponse limited;
+    limiter.Handle(request, limited, []() {});
+    EXPECT_EQ(limited.GetStatusCode(), HttpStatusCode::TOO_MANY_REQUESTS);
+    EXPECT_EQ(limited.GetHeader("Retry-After"), "1");
+
+    // 新窗口开始时上一窗口的计数几乎完整计入，仍然受限
+    SleepUntilNextWindow(1s);
+    EXPECT_EQ(Send(limiter), HttpStatusCode::TOO_MANY_REQUESTS);
+
+    // 被拒绝的请求不计数，再滚动一个窗口后配额完全恢复
+    SleepUntilNextWindow(1s);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(Send(limiter), HttpStatusCode::OK) << i;
+    }
+    EXPECT_EQ(Send(limiter), HttpStatusCode::TOO_MANY_REQUESTS);
+
+    auto stats = limiter.GetStats();
+    EXPECT_EQ(stats.allowed, 8u);
+    EXPECT_EQ(stats.limited, 3u);
+    EXPECT_EQ(stats.tracked_keys, 1u);
+}
+
+TEST(RateLimitTest, SuccessfulRequestIsRefundedToItsOwnWindow) {
+    auto config = WindowConfig(2);
+    config.skip_successful_requests = true;
+    RateLimitMiddleware limiter(config);
+    SleepUntilNextWindow(1s);
+
+    // 成功请求不消耗配额
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(Send(limiter), HttpStatusCode::OK) << i;
+    }
+
+    // 成功请求A在窗口W计数，处理期间窗口滚动到W+1，另一个失败请求B计入W+1
+    EXPECT_EQ(Send(limiter, "http://localhost/api", HttpStatusCode::OK, [&]() {
+        SleepUntilNextWindow(1s);
+        EXPECT_EQ(Send(limiter, "http://localhost/api", HttpStatusCode::INTERNAL_SERVER_ERROR),
+                  HttpStatusCode::INTERNAL_SERVER_ERROR);
+    }), HttpStatusCode::OK);
+
+    // A归还的是W的计数，B在W+1的计数保留，在W+2中按比例计入
+    SleepUntilNextWindow(1s);
+    EXPECT_EQ(Send(limiter, "http://localhost/api", HttpStatusCode::INTERNAL_SERVER_ERROR),
+              HttpStatusCode::INTERNAL_SERVER_ERROR);
+    EXPECT_EQ(Send(limiter, "http://localhost/api", HttpStatusCode::INTERNAL_SERVER_ERROR),
+              HttpStatusCode::TOO_MANY_REQUESTS);
+}
+
+TEST(RateLimitTest, RouteLimitsAreCountedSeparatelyAndZeroMeansUnlimited) {
+    auto config = WindowConfig(1);
+    config.window = 60s;
+    config.route_limits["/api/search"] = 2;
+    config.route_limits["/health"] = 0;
+    RateLimitMiddleware limiter(config);
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(Send(limiter, "http://localhost/health/live"), HttpStatusCode::OK);
+    }
+
+    EXPECT_EQ(Send(limiter, "http://localhost/api/search?q=1"), HttpStatusCode::OK);
+    EXPECT_EQ(Send(limiter, "http://localhost/api/search?q=2"), HttpStatusCode::OK);
+    EXPECT_EQ(Send(limiter, "http://localhost/api/search?q=3"), HttpStatusCode::TOO_MANY_REQUESTS);
+
+    // 默认限额单独计数，不受搜索路由消耗影响
+    EXPECT_EQ(Send(limiter, "http://localhost/api/items"), HttpStatusCode::OK);
+    EXPECT_EQ(Send(limiter, "http://localhost/api/items"), HttpStatusCode::TOO_MANY_REQUESTS);
+    EXPECT_EQ(limiter.GetStats().tracked_keys, 2u);
+}
+
+TEST(RateLimitTest, ForwardedForUsesAddressAddedByTrustedProxy) {
+    auto config = WindowConfig(1);
+    config.window = 60s;
+    config.trust_forwarded_for = true;
+    RateLimitMiddleware limiter(config);
+
+    // 客户端伪造的左侧条目不影响计数键
+    EXPECT_EQ(SendForwarded(limiter, "198.51.100.1, 203.0.113.7"), HttpStatusCode::OK);
+    EXPECT_EQ(SendForwarded(limiter, "198.51.100.2, 203.0.113.7"), HttpStatusCode::TOO_MANY_REQUESTS);
+    EXPECT_EQ(SendForwarded(limiter, " 203.0.113.8 "), HttpStatusCode::OK);
+
+    // 两层代理时取右起第二个地址
+    config.trusted_proxy_hops = 2;
+    RateLimitMiddleware two_hops(config);
+    EXPECT_EQ(SendForwarded(two_hops, "198.51.100.1, 203.0.113.7, 10.0.0.1"), HttpStatusCode::OK);
+    EXPECT_EQ(SendForwarded(two_hops, "203.0.113.7,10.0.0.2"), HttpStatusCode::TOO_MANY_REQUESTS);
+
+    // 条目少于代理层数时回退到连接地址
+    EXPECT_EQ(SendForwarded(two_hops, "203.0.113.9"), HttpStatusCode::OK);
+    EXPECT_EQ(SendForwarded(two_hops, "203.0.113.10"), HttpStatusCode::TOO_MANY_REQUESTS);
+}
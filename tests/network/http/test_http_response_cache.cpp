@@ -0,0 +1,276 @@
+/**
+ * @file test_http_response_cache.cpp
+ * @brief 响应缓存中间件测试：命中、请求合并、等待上限和过期后返回旧响应
+ */
+
+#include "common/network/http/http_middleware.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+
+using namespace common::network::http;
+using namespace std::chrono_literals;
+
+namespace {
+
+// 可阻塞的处理器：block()之后的调用在release()前不返回
+class Backend {
+public:
+    void Block() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        blocked_ = true;
+    }
+
+    void Release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            blocked_ = false;
+        }
+        cv_.notify_all();
+    }
+
+    void SetBody(const std::string& body) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        body_ = body;
+    }
+
+    int GetCalls() const { return calls_; }
+
+    std::function<void()> Handler(HttpResponse& response) {
+        return [this, &response]() {
+            ++calls_;
+            std::string body;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return !blocked_; });
+                body = body_;
+            }
+            response.SetStatusCode(HttpStatusCode::OK);
+            response.SetBody(body, "text/plain");
+        };
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool blocked_ = false;
+    std::string body_ = "v1";
+    std::atomic<int> calls_{0};
+};
+
+HttpResponse Get(ResponseCacheMiddleware& cache, Backend& backend, const std::string& url = "http://localhost/data") {
+    HttpRequest request(HttpMethod::GET, url);
+    HttpResponse response;
+    cache.Handle(request, response, backend.Handler(response));
+    return response;
+}
+
+template <typename Predicate>
+bool WaitFor(Predicate predicate) {
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (!predicate() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    return predicate();
+}
+
+ResponseCacheMiddleware::ResponseCacheConfig CoalescingConfig() {
+    ResponseCacheMiddleware::ResponseCacheConfig config;
+    config.default_ttl = 60s;
+    config.coalesce_timeout = 2000ms;
+    config.max_coalesced_waiters = 8;
+    config.shard_count = 2;
+    return config;
+}
+
+} // anonymous namespace
+
+TEST(ResponseCacheTest, HitsShareEntryAcrossQueryOrder) {
+    ResponseCacheMiddleware cache(CoalescingConfig());
+    Backend backend;
+
+    auto first = Get(cache, backend, "http://localhost/data?b=2&a=1");
+    EXPECT_EQ(first.GetHeader("X-Cache"), "MISS");
+
+    auto second = Get(cache, backend, "http://localhost/data?a=1&b=2");
+    EXPECT_EQ(second.GetHeader("X-Cache"), "HIT");
+    EXPECT_EQ(second.GetBody(), "v1");
+    EXPECT_EQ(backend.GetCalls(), 1);
+
+    Get(cache, backend, "http://localhost/data?a=1&b=3");
+    EXPECT_EQ(backend.GetCalls(), 2);
+
+    auto stats = cache.GetStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.entries, 2u);
+}
+
+TEST(ResponseCacheTest, UncacheableRequestsAndResponsesBypass) {
+    auto config = CoalescingConfig();
+    config.route_ttls["/live"] = 0s;
+    ResponseCacheMiddleware cache(config);
+    Backend backend;
+
+    Get(cache, backend, "http://localhost/live/feed");
+    Get(cache, backend, "http://localhost/live/feed");
+    EXPECT_EQ(backend.GetCalls(), 2);
+
+    HttpRequest post(HttpMethod::POST, "http://localhost/data");
+    HttpResponse response;
+    cache.Handle(post, response, backend.Handler(response));
+    EXPECT_EQ(backend.GetCalls(), 3);
+
+    // 带Set-Cookie的响应不缓存
+    HttpRequest request(HttpMethod::GET, "http://localhost/session");
+    for (int i = 0; i < 2; ++i) {
+        HttpResponse with_cookie;
+        cache.Handle(request, with_cookie, [&]() {
+            backend.Handler(with_cookie)();
+            with_cookie.SetHeader("Set-Cookie", "sid=1");
+        });
+    }
+    EXPECT_EQ(backend.GetCalls(), 5);
+    EXPECT_EQ(cache.GetStats().entries, 0u);
+}
+
+TEST(ResponseCacheTest, ConcurrentMissesRunHandlerOnce) {
+    ResponseCacheMiddleware cache(CoalescingConfig());
+    Backend backend;
+    backend.Block();
+
+    std::vector<HttpResponse> responses(4);
+    std::vector<std::thread> threads;
+    threads.emplace_back([&]() { responses[0] = Get(cache, backend); });
+    ASSERT_TRUE(WaitFor([&]() { return backend.GetCalls() == 1; }));
+
+    for (size_t i = 1; i < responses.size(); ++i) {
+        threads.emplace_back([&, i]() { responses[i] = Get(cache, backend); });
+    }
+    ASSERT_TRUE(WaitFor([&]() { return cache.GetStats().coalesced == 3; }));
+
+    backend.Release();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(backend.GetCalls(), 1);
+    EXPECT_EQ(responses[0].GetHeader("X-Cache"), "MISS");
+    for (size_t i = 1; i < responses.size(); ++i) {
+        EXPECT_EQ(responses[i].GetHeader("X-Cache"), "HIT");
+        EXPECT_EQ(responses[i].GetBody(), "v1");
+    }
+    EXPECT_EQ(cache.GetStats().coalesce_timeouts, 0u);
+}
+
+TEST(ResponseCacheTest, WaitersBeyondLimitRunHandlerThemselves) {
+    auto config = CoalescingConfig();
+    config.max_coalesced_waiters = 1;
+    ResponseCacheMiddleware cache(config);
+    Backend backend;
+    backend.Block();
+
+    HttpResponse leader_response;
+    HttpResponse waiter_response;
+    std::thread leader([&]() { leader_response = Get(cache, backend); });
+    ASSERT_TRUE(WaitFor([&]() { return backend.GetCalls() == 1; }));
+    std::thread waiter([&]() { waiter_response = Get(cache, backend); });
+    ASSERT_TRUE(WaitFor([&]() { return cache.GetStats().coalesced == 1; }));
+
+    // 第三个请求不再阻塞等待，而是自行执行处理器
+    std::thread bypass([&]() { Get(cache, backend); });
+    ASSERT_TRUE(WaitFor([&]() { return backend.GetCalls() == 2; }));
+
+    backend.Release();
+    leader.join();
+    waiter.join();
+    bypass.join();
+
+    EXPECT_EQ(backend.GetCalls(), 2);
+    EXPECT_EQ(waiter_response.GetHeader("X-Cache"), "HIT");
+    EXPECT_EQ(cache.GetStats().coalesced, 1u);
+}
+
+TEST(ResponseCacheTest, WaiterStopsWaitingAfterTimeout) {
+    auto config = CoalescingConfig();
+    config.coalesce_timeout = 20ms;
+    ResponseCacheMiddleware cache(config);
+    Backend backend;
+    backend.Block();
+
+    std::thread leader([&]() { Get(cache, backend); });
+    ASSERT_TRUE(WaitFor([&]() { return backend.GetCalls() == 1; }));
+
+    HttpResponse waiter_response;
+    std::thread waiter([&]() { waiter_response = Get(cache, backend); });
+    ASSERT_TRUE(WaitFor([&]() { return backend.GetCalls() == 2; }));
+    EXPECT_EQ(cache.GetStats().coalesce_timeouts, 1u);
+
+    backend.Release();
+    leader.join();
+    waiter.join();
+    EXPECT_EQ(waiter_response.GetBody(), "v1");
+}
+
+TEST(ResponseCacheTest, ZeroTimeoutDisablesCoalescing) {
+    auto config = CoalescingConfig();
+    config.coalesce_timeout = 0ms;
+    ResponseCacheMiddleware cache(config);
+    Backend backend;
+    backend.Block();
+
+    std::thread first([&]() { Get(cache, backend); });
+    std::thread second([&]() { Get(cache, backend); });
+    ASSERT_TRUE(WaitFor([&]() { return backend.GetCalls() == 2; }));
+
+    backend.Release();
+    first.join();
+    second.join();
+    EXPECT_EQ(cache.GetStats().coalesced, 0u);
+}
+
+TEST(ResponseCacheTest, StaleResponseServedWhileOneRequestRefreshes) {
+    auto config = CoalescingConfig();
+    config.default_ttl = 1s;
+    config.stale_while_revalidate = 1s;
+    ResponseCacheMiddleware cache(config);
+    Backend backend;
+
+    EXPECT_EQ(Get(cache, backend).GetHeader("X-Cache"), "MISS");
+    std::this_thread::sleep_for(1100ms);
+
+    // 过期后第一个请求同步刷新，刷新期间其余请求直接返回旧响应
+    backend.SetBody("v2");
+    backend.Block();
+    HttpResponse refresh_response;
+    std::thread refresher([&]() { refresh_response = Get(cache, backend); });
+    ASSERT_TRUE(WaitFor([&]() { return backend.GetCalls() == 2; }));
+
+    auto stale = Get(cache, backend);
+    EXPECT_EQ(stale.GetHeader("X-Cache"), "STALE");
+    EXPECT_EQ(stale.GetBody(), "v1");
+    EXPECT_EQ(stale.GetHeader("Age"), "1");
+    EXPECT_EQ(backend.GetCalls(), 2);
+
+    backend.Release();
+    refresher.join();
+    EXPECT_EQ(refresh_response.GetHeader("X-Cache"), "MISS");
+    EXPECT_EQ(refresh_response.GetBody(), "v2");
+
+    auto fresh = Get(cache, backend);
+    EXPECT_EQ(fresh.GetHeader("X-Cache"), "HIT");
+    EXPECT_EQ(fresh.GetBody(), "v2");
+
+    // 超出stale_while_revalidate窗口后旧响应不再使用
+    std::this_thread::sleep_for(2100ms);
+    backend.SetBody("v3");
+    auto expired = Get(cache, backend);
+    EXPECT_EQ(expired.GetHeader("X-Cache"), "MISS");
+    EXPECT_EQ(expired.GetBody(), "v3");
+    EXPECT_EQ(backend.GetCalls(), 3);
+
+    auto stats = cache.GetStats();
+    EXPECT_EQ(stats.stale_hits, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+}
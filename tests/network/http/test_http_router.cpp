@@ -0,0 +1,235 @@
+/**
+ * @file test_http_router.cpp
+ * @brief 压缩前缀树路由测试：匹配优先级、参数约束、回溯和404/405
+ */
+
+#include "common/network/http/http_radix_tree.h"
+#include "common/network/http/http_router.h"
+#include <gtest/gtest.h>
+
+using namespace common::network::http;
+
+namespace {
+
+// 按插入顺序编号，匹配结果用编号断言
+class RadixTreeTest : public ::testing::Test {
+protected:
+    void Insert(const std::string& pattern) {
+        ASSERT_TRUE(tree_.Insert(pattern, tree_.Size())) << pattern;
+    }
+
+    // 返回匹配到的模式下标，未匹配返回-1
+    int Find(std::string_view path) {
+        size_t value = 0;
+        return tree_.Find(path, value, params_) ? static_cast<int>(value) : -1;
+    }
+
+    HttpRadixTree tree_;
+    PathParams params_;
+};
+
+} // anonymous namespace
+
+TEST_F(RadixTreeTest, StaticBeatsParamBeatsWildcard) {
+    Insert("/users/me");            // 0
+    Insert("/users/{id}");          // 1
+    Insert("/users/*rest");         // 2
+
+    EXPECT_EQ(Find("/users/me"), 0);
+    EXPECT_TRUE(params_.Empty());
+
+    EXPECT_EQ(Find("/users/42"), 1);
+    EXPECT_EQ(params_.Get("id"), "42");
+
+    // 参数只匹配一个片段，多片段落到通配符
+    EXPECT_EQ(Find("/users/42/posts"), 2);
+    EXPECT_EQ(params_.Get("rest"), "42/posts");
+    EXPECT_FALSE(params_.Has("id"));
+
+    // 静态前缀的延伸不影响参数匹配
+    EXPECT_EQ(Find("/users/mex"), 1);
+    EXPECT_EQ(params_.Get("id"), "mex");
+}
+
+TEST_F(RadixTreeTest, SharedPrefixesAreSplit) {
+    Insert("/search");              // 0
+    Insert("/support");             // 1
+    Insert("/s");                   // 2
+    Insert("/searching");           // 3
+
+    EXPECT_EQ(Find("/search"), 0);
+    EXPECT_EQ(Find("/support"), 1);
+    EXPECT_EQ(Find("/s"), 2);
+    EXPECT_EQ(Find("/searching"), 3);
+    EXPECT_EQ(Find("/sea"), -1);
+    EXPECT_EQ(Find("/searchin"), -1);
+    EXPECT_EQ(tree_.Size(), 4u);
+}
+
+TEST_F(RadixTreeTest, ConstrainedParamsAreTriedFirst) {
+    Insert("/items/{slug}");            // 0
+    Insert("/items/{id:[0-9]+}");       // 1
+    Insert("/v{major:\\d{1,2}}/ping");  // 2，约束中的花括号不结束参数
+
+    EXPECT_EQ(Find("/items/123"), 1);
+    EXPECT_EQ(params_.Get("id"), "123");
+
+    EXPECT_EQ(Find("/items/12a"), 0);
+    EXPECT_EQ(params_.Get("slug"), "12a");
+
+    // 约束必须匹配整个片段
+    EXPECT_EQ(Find("/v12/ping"), 2);
+    EXPECT_EQ(params_.Get("major"), "12");
+    EXPECT_EQ(Find("/v123/ping"), -1);
+}
+
+TEST_F(RadixTreeTest, BacktracksAcrossBranches) {
+    Insert("/a/{x}/c");             // 0
+    Insert("/a/b/d");               // 1
+    Insert("/a/{x}/{y}/e");         // 2
+    Insert("/a/{x:[0-9]+}/f");      // 3
+
+    // 静态分支/a/b/只能匹配d，失败后回溯到参数分支
+    EXPECT_EQ(Find("/a/b/d"), 1);
+    EXPECT_EQ(Find("/a/b/c"), 0);
+    EXPECT_EQ(params_.Get("x"), "b");
+
+    // 约束参数匹配成功但后续失败时回溯到无约束参数，已压入的参数被弹出
+    EXPECT_EQ(Find("/a/1/c"), 0);
+    ASSERT_EQ(params_.Size(), 1u);
+    EXPECT_EQ(params_.Get("x"), "1");
+
+    EXPECT_EQ(Find("/a/1/f"), 3);
+    EXPECT_EQ(Find("/a/b/q/e"), 2);
+    EXPECT_EQ(params_.Get("y"), "q");
+    EXPECT_EQ(Find("/a/b/q/z"), -1);
+    EXPECT_TRUE(params_.Empty());
+}
+
+TEST_F(RadixTreeTest, WildcardMatchesEmptyRemainder) {
+    Insert("/static/*path");        // 0
+    Insert("/files/*");             // 1
+
+    EXPECT_EQ(Find("/static/css/site.css"), 0);
+    EXPECT_EQ(params_.Get("path"), "css/site.css");
+    EXPECT_EQ(Find("/static/"), 0);
+    EXPECT_TRUE(params_.Has("path"));
+    EXPECT_EQ(params_.Get("path"), "");
+    EXPECT_EQ(Find("/files/a/b"), 1);
+    EXPECT_EQ(params_.Get("*"), "a/b");
+}
+
+TEST_F(RadixTreeTest, RejectsInvalidAndDuplicatePatterns) {
+    Insert("/users/{id}");
+    EXPECT_FALSE(tree_.Insert("/users/{id}", 9));
+    EXPECT_FALSE(tree_.Insert("/users/{}", 9));
+    EXPECT_FALSE(tree_.Insert("/users/{id", 9));
+    EXPECT_FALSE(tree_.Insert("/users/{id}x", 9));        // 参数之后只能是'/'
+    EXPECT_FALSE(tree_.Insert("/users/{id:[0-9}", 9));    // 非法正则
+    EXPECT_FALSE(tree_.Insert("/files/*a/b", 9));         // 通配符必须在末尾
+    Insert("/files/*a");
+    EXPECT_FALSE(tree_.Insert("/files/*b", 9));           // 同一位置的通配符名称冲突
+    EXPECT_EQ(tree_.Size(), 2u);
+}
+
+TEST_F(RadixTreeTest, ManyParamsSpillFromInlineStorage) {
+    std::string pattern;
+    std::string path;
+    for (size_t i = 0; i < PathParams::kInlineCapacity + 3; ++i) {
+        pattern += "/{p" + std::to_string(i) + "}";
+        path += "/v" + std::to_string(i);
+    }
+    Insert(pattern);
+
+    ASSERT_EQ(Find(path), 0);
+    ASSERT_EQ(params_.Size(), PathParams::kInlineCapacity + 3);
+    EXPECT_EQ(params_[PathParams::kInlineCapacity + 2].value, "v10");
+    EXPECT_EQ(params_.Get("p9"), "v9");
+}
+
+TEST(RadixTreeCaseTest, CaseInsensitiveTree) {
+    HttpRadixTree tree(false);
+    ASSERT_TRUE(tree.Insert("/API/Users/{Id:[a-f]+}", 0));
+
+    size_t value = 1;
+    PathParams params;
+    ASSERT_TRUE(tree.Find("/api/USERS/ABC", value, params));
+    EXPECT_EQ(value, 0u);
+    // 参数值保持请求中的原样
+    EXPECT_EQ(params.Get("Id"), "ABC");
+}
+
+TEST(HttpRouterTest, MatchExtractsParamsAndQuery) {
+    HttpRouter router;
+    router.Get("/users/{id:[0-9]+}/posts/{post}", [](const HttpRequest&, HttpResponse&, std::function<void()>) {});
+
+    auto match = router.Match(HttpMethod::GET, "/users/7/posts/hello/?page=2&sort");
+    ASSERT_TRUE(match.matched);
+    EXPECT_EQ(match.matched_pattern, "/users/{id:[0-9]+}/posts/{post}");
+    EXPECT_EQ(match.params["id"], "7");
+    EXPECT_EQ(match.params["post"], "hello");
+    EXPECT_EQ(match.queries["page"], "2");
+    EXPECT_EQ(match.queries.count("sort"), 1u);
+
+    EXPECT_FALSE(router.Match(HttpMethod::GET, "/users/x/posts/hello").matched);
+    EXPECT_FALSE(router.Match(HttpMethod::POST, "/users/7/posts/hello").matched);
+}
+
+TEST(HttpRouterTest, MethodNotAllowedVersusNotFound) {
+    HttpRouter router;
+    int handled = 0;
+    auto handler = [&handled](const HttpRequest&, HttpResponse& response, std::function<void()>) {
+        ++handled;
+        response.SetStatusCode(HttpStatusCode::OK);
+    };
+    router.Get("/items/{id}", handler);
+    router.Put("/items/{id}", handler);
+    router.Delete("/items/{id:[0-9]+}", handler);
+    router.Post("/items", handler);
+
+    HttpResponse response;
+    EXPECT_TRUE(router.HandleRequest(HttpRequest(HttpMethod::GET, "http://localhost/items/5"), response));
+    EXPECT_EQ(response.GetStatusCode(), HttpStatusCode::OK);
+    EXPECT_EQ(handled, 1);
+
+    // 路径存在但方法不匹配时返回405并列出可用方法
+    response = HttpResponse();
+    EXPECT_FALSE(router.HandleRequest(HttpRequest(HttpMethod::PATCH, "http://localhost/items/5"), response));
+    EXPECT_EQ(response.GetStatusCode(), HttpStatusCode::METHOD_NOT_ALLOWED);
+    EXPECT_EQ(response.GetHeader("Allow"), "GET, PUT, DELETE");
+
+    // 约束不满足的方法不出现在Allow中
+    response = HttpResponse();
+    EXPECT_FALSE(router.HandleRequest(HttpRequest(HttpMethod::PATCH, "http://localhost/items/abc"), response));
+    EXPECT_EQ(response.GetStatusCode(), HttpStatusCode::METHOD_NOT_ALLOWED);
+    EXPECT_EQ(response.GetHeader("Allow"), "GET, PUT");
+
+    // 任何方法都不匹配的路径返回404
+    response = HttpResponse();
+    EXPECT_FALSE(router.HandleRequest(HttpRequest(HttpMethod::GET, "http://localhost/items/5/extra"), response));
+    EXPECT_EQ(response.GetStatusCode(), HttpStatusCode::NOT_FOUND);
+    EXPECT_EQ(handled, 1);
+}
+
+TEST(HttpRouterTest, TrailingSlashAndCaseAreIgnoredByDefault) {
+    HttpRouter router;
+    router.Get("/Health/", [](const HttpRequest&, HttpResponse&, std::function<void()>) {});
+
+    EXPECT_TRUE(router.Match(HttpMethod::GET, "/health").matched);
+    EXPECT_TRUE(router.Match(HttpMethod::GET, "/HEALTH/").matched);
+    EXPECT_FALSE(router.Match(HttpMethod::GET, "/health/x").matched);
+}
+
+TEST(HttpRouterTest, DuplicateRouteIsIgnored) {
+    HttpRouter router;
+    int first = 0;
+    int second = 0;
+    router.Get("/dup", [&first](const HttpRequest&, HttpResponse&, std::function<void()>) { ++first; });
+    router.Get("/dup/", [&second](const HttpRequest&, HttpResponse&, std::function<void()>) { ++second; });
+
+    HttpResponse response;
+    router.HandleRequest(HttpRequest(HttpMethod::GET, "http://localhost/dup"), response);
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(second, 0);
+    EXPECT_EQ(router.GetRoutes().size(), 1u);
+}
@@ -0,0 +1,138 @@
+/**
+ * @file test_http_static_file.cpp
+ * @brief 静态文件测试：单区间、后缀区间、无法满足的区间(416)和If-Range不匹配时回退到200
+ */
+
+#include "common/network/http/http_static_file.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace common::network::http;
+
+namespace {
+
+class HttpStaticFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root_ = std::filesystem::temp_directory_path() /
+                ("zeus_static_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::create_directories(root_);
+        for (int i = 0; i < 100; ++i) {
+            content_.push_back(static_cast<char>('a' + i % 26));
+        }
+        std::ofstream(root_ / "data.txt", std::ios::binary) << content_;
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    // cache_max_file_size为0时走文件区间发送，否则从内存缓存切片
+    HttpResponse Get(const std::string& range, const std::string& if_range = "", size_t cache_max_file_size = 1024) {
+        HttpStaticFileConfig config;
+        config.cache_max_file_size = cache_max_file_size;
+        HttpStaticFileHandler handler(config);
+        handler.Mount("/static", root_.string());
+
+        HttpRequest request(HttpMethod::GET, "http://localhost/static/data.txt");
+        if (!range.empty()) {
+            request.SetHeader("Range", range);
+        }
+        if (!if_range.empty()) {
+            request.SetHeader("If-Range", if_range);
+        }
+        HttpResponse response;
+        EXPECT_TRUE(handler.Handle(request, response));
+        return response;
+    }
+
+    // 内存响应体或文件区间对应的内容
+    std::string Payload(const HttpResponse& response) const {
+        if (!response.HasFileRange()) {
+            return response.GetBody();
+        }
+        const auto& range = *response.GetFileRange();
+        return content_.substr(static_cast<size_t>(range.offset), static_cast<size_t>(range.length));
+    }
+
+    std::string Validator(const char* header) { return Get("").GetHeader(header); }
+
+    std::filesystem::path root_;
+    std::string content_;
+};
+
+} // anonymous namespace
+
+TEST_F(HttpStaticFileTest, SingleRangeReturnsPartialContent) {
+    for (size_t cache_limit : {size_t(1024), size_t(0)}) {
+        const HttpResponse response = Get("bytes=10-19", "", cache_limit);
+        EXPECT_EQ(response.GetStatusCode(), HttpStatusCode::PARTIAL_CONTENT);
+        EXPECT_EQ(response.GetHeader("Content-Range"), "bytes 10-19/100");
+        EXPECT_EQ(response.GetHeader("Accept-Ranges"), "bytes");
+        EXPECT_EQ(response.HasFileRange(), cache_limit == 0);
+        EXPECT_EQ(Payload(response), content_.substr(10, 10));
+    }
+
+    // 开放区间到文件末尾，超出的结束位置截断到文件末尾
+    const HttpResponse open = Get("bytes=95-");
+    EXPECT_EQ(open.GetHeader("Content-Range"), "bytes 95-99/100");
+    EXPECT_EQ(Payload(open), content_.substr(95));
+    EXPECT_EQ(Get("bytes=90-500").GetHeader("Content-Range"), "bytes 90-99/100");
+}
+
+TEST_F(HttpStaticFileTest, SuffixRangeReturnsLastBytes) {
+    const HttpResponse response = Get("bytes=-5");
+    EXPECT_EQ(response.GetStatusCode(), HttpStatusCode::PARTIAL_CONTENT);
+    EXPECT_EQ(response.GetHeader("Content-Range"), "bytes 95-99/100");
+    EXPECT_EQ(Payload(response), content_.substr(95));
+
+    // 后缀长于文件时返回整个文件
+    const HttpResponse whole = Get("bytes=-1000", "", 0);
+    EXPECT_EQ(whole.GetStatusCode(), HttpStatusCode::PARTIAL_CONTENT);
+    EXPECT_EQ(whole.GetHeader("Content-Range"), "bytes 0-99/100");
+    EXPECT_EQ(Payload(whole), content_);
+}
+
+TEST_F(HttpStaticFileTest, UnsatisfiableRangeReturns416) {
+    for (const char* range : {"bytes=100-", "bytes=200-300", "bytes=-0"}) {
+        const HttpResponse response = Get(range);
+        EXPECT_EQ(response.GetStatusCode(), HttpStatusCode::RANGE_NOT_SATISFIABLE) << range;
+        EXPECT_EQ(response.GetHeader("Content-Range"), "bytes */100") << range;
+        EXPECT_TRUE(response.GetBody().empty()) << range;
+        EXPECT_FALSE(response.HasFileRange()) << range;
+    }
+
+    // 语法无效或多区间的Range被忽略，返回完整文件
+    for (const char* range : {"bytes=20-10", "items=0-5", "bytes=0-1,5-6"}) {
+        const HttpResponse response = Get(range);
+        EXPECT_EQ(response.GetStatusCode(), HttpStatusCode::OK) << range;
+        EXPECT_EQ(Payload(response), content_) << range;
+    }
+}
+
+TEST_F(HttpStaticFileTest, IfRangeMismatchFallsBackToFullResponse) {
+    const std::string etag = Validator("ETag");
+    const std::string last_modified = Validator("Last-Modified");
+    ASSERT_FALSE(etag.empty());
+    ASSERT_FALSE(last_modified.empty());
+
+    // 校验值匹配时区间生效
+    EXPECT_EQ(Get("bytes=0-9", etag).GetStatusCode(), HttpStatusCode::PARTIAL_CONTENT);
+    EXPECT_EQ(Get("bytes=0-9", last_modified).GetStatusCode(), HttpStatusCode::PARTIAL_CONTENT);
+
+    // 不匹配（含弱ETag，If-Range要求强比较）时返回完整文件
+    for (const std::string& if_range : {std::string("\"stale\""), "W/" + etag,
+                                        std::string("Thu, 01 Jan 1970 00:00:00 GMT")}) {
+        for (size_t cache_limit : {size_t(1024), size_t(0)}) {
+            const HttpResponse response = Get("bytes=0-9", if_range, cache_limit);
+            EXPECT_EQ(response.GetStatusCode(), HttpStatusCode::OK) << if_range;
+            EXPECT_FALSE(response.HasHeader("Content-Range")) << if_range;
+            EXPECT_EQ(Payload(response), content_) << if_range;
+        }
+    }
+
+    // 不匹配时也不会因区间越界返回416
+    EXPECT_EQ(Get("bytes=500-", "\"stale\"").GetStatusCode(), HttpStatusCode::OK);
+}
@@ -0,0 +1,145 @@
+/**
+ * @file test_http_websocket.cpp
+ * @brief WebSocket端到端测试：握手与非升级请求的426、消息回显和permessage-deflate协商
+ */
+
+#include "common/network/http/http_server.h"
+#include <gtest/gtest.h>
+#include <mutex>
+
+using namespace common::network::http;
+namespace beast = boost::beast;
+namespace websocket = boost::beast::websocket;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+class WebSocketTest : public ::testing::Test {
+protected:
+    void SetUp() override { config_.bind_address = "127.0.0.1"; config_.port = 0; }
+
+    void TearDown() override {
+        if (server_) {
+            server_->Stop();
+            connections_.clear();
+            server_.reset();
+        }
+    }
+
+    // 注册回显路由并启动服务器，返回监听端口
+    uint16_t StartEchoServer() {
+        server_ = std::make_unique<HttpServer>(2, config_);
+        server_->WebSocket("/ws", [this](std::shared_ptr<WebSocketConnection> connection, const HttpRequest& request) {
+            std::weak_ptr<WebSocketConnection> weak = connection;
+            connection->SetDataHandler([weak](const std::vector<uint8_t>& data) {
+                if (auto self = weak.lock()) {
+                    self->AsyncSend(data);
+                }
+            });
+            std::lock_guard<std::mutex> lock(mutex_);
+            upgraded_path_ = request.GetUrl().path;
+            connections_.push_back(std::move(connection));
+        });
+        EXPECT_TRUE(server_->Start());
+        const std::string endpoint = server_->GetListeningEndpoint();
+        return static_cast<uint16_t>(std::stoi(endpoint.substr(endpoint.rfind(':') + 1)));
+    }
+
+    std::string GetUpgradedPath() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return upgraded_path_;
+    }
+
+    HttpServerConfig config_;
+    std::unique_ptr<HttpServer> server_;
+    std::mutex mutex_;
+    std::string upgraded_path_;
+    std::vector<std::shared_ptr<WebSocketConnection>> connections_;
+};
+
+// 同步WebSocket客户端，握手响应保留以检查协商的扩展
+struct Client {
+    explicit Client(uint16_t port, bool deflate) : ws(io_context) {
+        beast::get_lowest_layer(ws).connect({boost::asio::ip::make_address("127.0.0.1"), port});
+        websocket::permessage_deflate options;
+        options.client_enable = deflate;
+        ws.set_option(options);
+        ws.handshake(handshake_response, "127.0.0.1", "/ws");
+    }
+
+    std::string Echo(const std::string& message, bool text) {
+        ws.text(text);
+        ws.write(boost::asio::buffer(message));
+        beast::flat_buffer buffer;
+        ws.read(buffer);
+        return beast::buffers_to_string(buffer.data());
+    }
+
+    boost::asio::io_context io_context;
+    websocket::stream<tcp::socket> ws;
+    websocket::response_type handshake_response;
+};
+
+} // anonymous namespace
+
+TEST_F(WebSocketTest, PlainRequestGets426AndUpgradeIsAccepted) {
+    const uint16_t port = StartEchoServer();
+
+    // 普通GET请求不升级，返回426并提示升级方式
+    boost::asio::io_context io_context;
+    tcp::socket socket(io_context);
+    socket.connect({boost::asio::ip::make_address("127.0.0.1"), port});
+    beast::http::request<beast::http::empty_body> request{beast::http::verb::get, "/ws", 11};
+    request.set(beast::http::field::host, "127.0.0.1");
+    beast::http::write(socket, request);
+    beast::flat_buffer buffer;
+    beast::http::response<beast::http::string_body> response;
+    beast::http::read(socket, buffer, response);
+    EXPECT_EQ(response.result_int(), 426);
+    EXPECT_EQ(response[beast::http::field::upgrade], "websocket");
+
+    Client client(port, false);
+    EXPECT_EQ(client.handshake_response.result(), beast::http::status::switching_protocols);
+    EXPECT_EQ(GetUpgradedPath(), "/ws");
+    client.ws.close(websocket::close_code::normal);
+}
+
+TEST_F(WebSocketTest, MessagesAreEchoedAsSingleFrames) {
+    Client client(StartEchoServer(), false);
+
+    EXPECT_EQ(client.Echo("hello", false), "hello");
+    const std::string binary("\x00\x01\xff\xfe", 4);
+    EXPECT_EQ(client.Echo(binary, false), binary);
+    EXPECT_FALSE(client.ws.got_text());
+
+    // 分片发送的消息作为一条消息交给数据处理器
+    client.ws.auto_fragment(true);
+    client.ws.write_buffer_bytes(64);
+    const std::string large(4096, 'm');
+    EXPECT_EQ(client.Echo(large, false), large);
+    client.ws.close(websocket::close_code::normal);
+}
+
+TEST_F(WebSocketTest, PermessageDeflateIsNegotiatedWhenEnabled) {
+    {
+        Client client(StartEchoServer(), true);
+        const std::string extensions(client.handshake_response[beast::http::field::sec_websocket_extensions]);
+        EXPECT_NE(extensions.find("permessage-deflate"), std::string::npos);
+
+        // 压缩后的消息双向往返内容不变
+        std::string message;
+        for (int i = 0; i < 200; ++i) {
+            message += "compressible payload " + std::to_string(i % 10) + "\n";
+        }
+        EXPECT_EQ(client.Echo(message, true), message);
+        client.ws.close(websocket::close_code::normal);
+    }
+    TearDown();
+
+    // 服务端关闭压缩时不接受客户端的扩展请求
+    config_.websocket_permessage_deflate = false;
+    Client client(StartEchoServer(), true);
+    EXPECT_EQ(client.handshake_response[beast::http::field::sec_websocket_extensions], "");
+    EXPECT_EQ(client.Echo("plain", true), "plain");
+    client.ws.close(websocket::close_code::normal);
+}
@@ -34,8 +34,9 @@ void TestHttpsBasicConnection() {
         std::cout << "  Response size: " << response.GetBody().size() << " bytes" << std::endl;
         
         // Check if server indicates SSL was used
-        auto headers = response.GetHeaders();
-        for (const auto& [name, value] : headers) {
+        for (const auto& field : response.GetHeaders()) {
+            std::string name(field.name_string());
+            std::string value(field.value());
             if (name.find("ssl") != std::string::npos || 
                 name.find("tls") != std::string::npos ||
                 name.find("https") != std::string::npos) {
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "common/network/http/http_metrics.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace http_load_generator {
+
+/**
+ * @brief HDR风格的延迟直方图（微秒）
+ *
+ * 与服务端指标使用同一种对数线性桶布局。服务端的HttpHistogramLayout只保留1/8精度以控制每路由内存，
+ * 压测对比两次构建时需要更细的分辨率，这里每段划分为128个桶，相对误差不超过1/128。
+ * 非线程安全，由调用方加锁。
+ */
+class LatencyHistogram {
+public:
+    using Layout = common::network::http::HttpLogLinearLayout<7>;
+
+    LatencyHistogram();
+
+    void Record(uint64_t value);
+    void Merge(const LatencyHistogram& other);
+
+    uint64_t GetCount() const { return count_; }
+    uint64_t GetMin() const { return count_ > 0 ? min_ : 0; }
+    uint64_t GetMax() const { return max_; }
+    double GetMean() const { return count_ > 0 ? static_cast<double>(sum_) / count_ : 0.0; }
+
+    /**
+     * @brief 百分位数（0-100），返回所在桶的上界且不超过最大值
+     */
+    uint64_t GetPercentile(double percentile) const;
+
+private:
+    std::vector<uint64_t> buckets_;
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+};
+
+} // namespace http_load_generator
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "http_load_generator/latency_histogram.h"
+#include "http_load_generator/load_scenario.h"
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace http_load_generator {
+
+/**
+ * @brief 一类请求（或全部请求）的统计
+ */
+struct LoadStats {
+    LatencyHistogram latency;                   // 收到响应的请求的延迟（微秒），传输错误不计入
+    uint64_t requests = 0;                      // 发出的请求，含失败和结束时仍未完成的请求
+    uint64_t succeeded = 0;                     // 状态码小于400
+    uint64_t bytes_received = 0;                // 响应体字节数
+    std::map<std::string, uint64_t> errors;     // 如 "status 503"、"timeout"
+
+    void Merge(const LoadStats& other);
+};
+
+/**
+ * @brief 一次压测的结果
+ */
+struct LoadReport {
+    LoadScenario scenario;
+    std::string started_at;                     // UTC, ISO 8601
+    double elapsed_seconds = 0.0;               // 统计窗口的实际时长（不含预热）
+    uint64_t sent = 0;                          // 统计窗口内发出的请求
+    uint64_t skipped = 0;                       // 因未完成请求超过max_in_flight而未发出（RATE模式）
+    uint64_t late = 0;                          // 发送时已落后计划时间1ms以上（RATE模式），说明压测端饱和
+    size_t peak_in_flight = 0;
+    LoadStats total;
+    std::vector<std::pair<std::string, LoadStats>> per_request;    // 与场景中的请求顺序相同
+
+    double GetThroughput() const { return elapsed_seconds > 0 ? total.requests / elapsed_seconds : 0.0; }
+
+    /**
+     * @brief 输出文本报告
+     */
+    void Print(std::ostream& out) const;
+
+    /**
+     * @brief 用于保存和对比的JSON结果
+     */
+    nlohmann::json ToJson() const;
+
+    /**
+     * @brief 输出与基准结果（之前保存的ToJson）的对比
+     */
+    static void PrintComparison(std::ostream& out, const nlohmann::json& baseline, const nlohmann::json& current);
+};
+
+} // namespace http_load_generator
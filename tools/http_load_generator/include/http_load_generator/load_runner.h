@@ -0,0 +1,89 @@
+#pragma once
+
+#include "http_load_generator/load_report.h"
+#include "http_load_generator/load_scenario.h"
+#include "common/network/http/http_client.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace http_load_generator {
+
+/**
+ * @brief 按场景驱动HttpClient发送请求并统计结果
+ *
+ * RATE模式为开环：第i个请求的计划发送时间固定为 start + i/rate，与之前的请求是否完成无关，
+ * 延迟从计划发送时间算起。压测端或连接池排队造成的推迟因此计入延迟，避免协调遗漏
+ * （coordinated omission）把服务端的停顿隐藏掉。未完成请求超过max_in_flight时跳过发送并计数。
+ *
+ * CONCURRENCY模式为闭环：保持固定数量的未完成请求，延迟从实际发送时间算起。
+ *
+ * 计划发送时间落在预热期内的请求不计入统计。请求组合按权重展开为乱序表，按序号取用，
+ * 相同的种子得到相同的请求序列。
+ */
+class LoadRunner {
+public:
+    using ProgressCallback = std::function<void(uint64_t completed, double elapsed_seconds)>;
+
+    explicit LoadRunner(const LoadScenario& scenario);
+    ~LoadRunner();
+
+    LoadRunner(const LoadRunner&) = delete;
+    LoadRunner& operator=(const LoadRunner&) = delete;
+
+    /**
+     * @brief 运行预热和统计阶段，阻塞到所有请求完成（或超时）
+     * @param progress 约每秒调用一次，可为空
+     */
+    LoadReport Run(const ProgressCallback& progress = nullptr);
+
+    /**
+     * @brief 提前结束（可在信号处理函数中调用），已发出的请求仍会等待完成
+     */
+    void Stop() { stop_requested_ = true; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Slot {
+        std::mutex mutex;
+        LoadStats stats;
+        std::atomic<uint64_t> issued{0};        // 统计窗口内发出的请求，用于找出结束时仍未完成的请求
+    };
+
+    void RunOpenLoop(const ProgressCallback& progress);
+    void RunClosedLoop(const ProgressCallback& progress);
+    void Send(uint64_t sequence, Clock::time_point intended);
+    void OnResponse(size_t spec, Clock::time_point intended, boost::system::error_code ec,
+                    const common::network::http::HttpResponse& response);
+    bool IsMeasured(Clock::time_point intended) const { return intended >= measure_start_ && intended < end_; }
+    void WaitForInFlight();
+
+    LoadScenario scenario_;
+    std::vector<common::network::http::HttpRequest> prepared_;
+    std::vector<uint32_t> mix_;                 // 按权重展开并打乱的请求下标
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::unique_ptr<common::network::http::HttpClient> client_;
+
+    Clock::time_point start_;
+    Clock::time_point measure_start_;
+    Clock::time_point end_;
+
+    std::atomic<uint64_t> sequence_{0};
+    std::atomic<uint64_t> sent_{0};
+    std::atomic<uint64_t> skipped_{0};
+    std::atomic<uint64_t> late_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<size_t> in_flight_{0};
+    std::atomic<size_t> peak_in_flight_{0};
+    std::atomic<bool> stop_requested_{false};
+
+    std::mutex done_mutex_;
+    std::condition_variable done_cv_;
+};
+
+} // namespace http_load_generator
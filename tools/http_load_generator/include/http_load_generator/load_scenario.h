@@ -0,0 +1,70 @@
+#pragma once
+
+#include "common/network/http/http_common.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace http_load_generator {
+
+/**
+ * @brief 压测模式
+ */
+enum class LoadMode {
+    RATE,           // 开环：按固定速率发送，不等待响应
+    CONCURRENCY     // 闭环：固定数量的并发请求，每个完成后立即发送下一个
+};
+
+/**
+ * @brief 请求组合中的一种请求
+ */
+struct LoadRequestSpec {
+    std::string name;
+    common::network::http::HttpMethod method = common::network::http::HttpMethod::GET;
+    std::string path;                                   // 相对target的路径（含查询串）
+    common::network::http::HttpHeaders headers;
+    std::string body;
+    std::string content_type;
+    uint32_t weight = 1;                                // 在组合中的相对比例
+};
+
+/**
+ * @brief 压测场景
+ *
+ * 由JSON文件描述，命令行参数可覆盖其中的数值项，格式见README.md。
+ */
+struct LoadScenario {
+    std::string name = "default";
+    std::string target;                                 // 如 http://127.0.0.1:8080
+    LoadMode mode = LoadMode::RATE;
+    double rate = 1000.0;                               // 每秒请求数（RATE模式）
+    size_t concurrency = 64;                            // 并发请求数（CONCURRENCY模式）
+    std::chrono::milliseconds duration{30000};          // 统计时长（不含预热）
+    std::chrono::milliseconds warmup{5000};             // 预热时长，期间的结果不计入
+    std::chrono::milliseconds timeout{5000};            // 单个请求超时
+    size_t connections = 64;                            // 每个目标的最大连接数
+    size_t threads = 2;                                 // HttpClient的I/O线程数
+    size_t max_in_flight = 10000;                       // RATE模式下的未完成请求上限，超出的发送计为跳过
+    uint64_t seed = 1;                                  // 请求组合的随机种子
+    common::network::http::HttpHeaders headers;         // 所有请求共用的请求头
+    std::vector<LoadRequestSpec> requests;
+
+    /**
+     * @brief 从JSON文件加载
+     * @return 失败时返回false并设置error
+     */
+    bool LoadFromFile(const std::string& path, std::string& error);
+
+    /**
+     * @brief 从JSON文本加载
+     */
+    bool LoadFromString(const std::string& text, std::string& error);
+
+    /**
+     * @brief 检查配置是否可以运行
+     */
+    bool Validate(std::string& error) const;
+};
+
+} // namespace http_load_generator
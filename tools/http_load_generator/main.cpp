@@ -0,0 +1,249 @@
+/**
+ * @file main.cpp
+ * @brief HTTP压测工具主程序
+ *
+ * 按JSON场景文件（或--url指定的单个GET请求）对目标施加固定速率（开环）或固定并发（闭环）的负载，
+ * 输出延迟百分位、吞吐量和错误分类，并可保存JSON结果与之前的结果对比。
+ */
+
+#include "http_load_generator/load_runner.h"
+#include "common/network/http/http_common.h"
+
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace http_load_generator;
+
+namespace {
+
+LoadRunner* g_runner = nullptr;
+
+void OnSignal(int) {
+    if (g_runner) {
+        g_runner->Stop();
+    }
+}
+
+/**
+ * @brief 命令行参数结构
+ */
+struct CommandLineArgs {
+    std::string scenario_file;                  ///< 场景文件
+    std::string url;                            ///< 不使用场景文件时压测的URL
+    std::optional<std::string> target;
+    std::optional<double> rate;
+    std::optional<size_t> concurrency;
+    std::optional<double> duration_s;
+    std::optional<double> warmup_s;
+    std::optional<int64_t> timeout_ms;
+    std::optional<size_t> connections;
+    std::optional<size_t> threads;
+    std::optional<size_t> max_in_flight;
+    std::optional<uint64_t> seed;
+    std::string output_file;                    ///< JSON结果输出文件
+    std::string baseline_file;                  ///< 对比用的基准JSON结果
+    bool quiet = false;                         ///< 不输出进度
+    bool help = false;
+};
+
+void PrintUsage() {
+    std::cout <<
+        "Usage: http_load_generator [scenario.json] [options]\n"
+        "\n"
+        "Load:\n"
+        "  --url URL              GET URL without a scenario file\n"
+        "  --target URL           override the scenario target (scheme://host:port)\n"
+        "  --rate N               open loop at N requests/s (latency from the intended send time)\n"
+        "  --concurrency N        closed loop with N concurrent requests\n"
+        "  --duration S           measured seconds (default 30)\n"
+        "  --warmup S             warmup seconds, not measured (default 5)\n"
+        "  --timeout MS           per request timeout (default 5000)\n"
+        "  --connections N        connections to the target (default 64)\n"
+        "  --threads N            client I/O threads (default 2)\n"
+        "  --max-in-flight N      open loop: skip sends beyond N outstanding requests (default 10000)\n"
+        "  --seed N               request mix seed (default 1)\n"
+        "\n"
+        "Output:\n"
+        "  --output FILE          write the result as JSON\n"
+        "  --baseline FILE        compare with an earlier JSON result\n"
+        "  --quiet                no progress lines\n"
+        "  --help\n";
+}
+
+bool ParseCommandLine(int argc, char* argv[], CommandLineArgs& args) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return nullptr;
+            }
+            return argv[++i];
+        };
+
+        try {
+            if (arg == "--help" || arg == "-h") {
+                args.help = true;
+            } else if (arg == "--quiet" || arg == "-q") {
+                args.quiet = true;
+            } else if (arg.rfind("--", 0) != 0) {
+                args.scenario_file = arg;
+            } else {
+                const char* text = value();
+                if (!text) {
+                    return false;
+                }
+                if (arg == "--url") args.url = text;
+                else if (arg == "--target") args.target = text;
+                else if (arg == "--rate") args.rate = std::stod(text);
+                else if (arg == "--concurrency") args.concurrency = std::stoull(text);
+                else if (arg == "--duration") args.duration_s = std::stod(text);
+                else if (arg == "--warmup") args.warmup_s = std::stod(text);
+                else if (arg == "--timeout") args.timeout_ms = std::stoll(text);
+                else if (arg == "--connections") args.connections = std::stoull(text);
+                else if (arg == "--threads") args.threads = std::stoull(text);
+                else if (arg == "--max-in-flight") args.max_in_flight = std::stoull(text);
+                else if (arg == "--seed") args.seed = std::stoull(text);
+                else if (arg == "--output") args.output_file = text;
+                else if (arg == "--baseline") args.baseline_file = text;
+                else {
+                    std::cerr << "Unknown option " << arg << std::endl;
+                    return false;
+                }
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value for " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (args.rate && args.concurrency) {
+        std::cerr << "--rate and --concurrency are mutually exclusive" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool BuildScenario(const CommandLineArgs& args, LoadScenario& scenario) {
+    std::string error;
+    if (!args.scenario_file.empty()) {
+        if (!scenario.LoadFromFile(args.scenario_file, error)) {
+            std::cerr << "Scenario " << args.scenario_file << ": " << error << std::endl;
+            return false;
+        }
+    } else if (!args.url.empty()) {
+        common::network::http::HttpUrl url(args.url);
+        if (!url.IsValid()) {
+            std::cerr << "Invalid URL " << args.url << std::endl;
+            return false;
+        }
+        scenario.name = args.url;
+        scenario.target = url.scheme + "://" + url.host + (url.port ? ":" + std::to_string(url.port) : "");
+        LoadRequestSpec spec;
+        spec.path = (url.path.empty() ? "/" : url.path) + (url.query.empty() ? "" : "?" + url.query);
+        spec.name = "GET " + spec.path;
+        scenario.requests.push_back(spec);
+    } else {
+        std::cerr << "A scenario file or --url is required (see --help)" << std::endl;
+        return false;
+    }
+
+    // 命令行参数覆盖场景文件
+    if (args.target) scenario.target = *args.target;
+    if (args.rate) {
+        scenario.mode = LoadMode::RATE;
+        scenario.rate = *args.rate;
+    }
+    if (args.concurrency) {
+        scenario.mode = LoadMode::CONCURRENCY;
+        scenario.concurrency = *args.concurrency;
+    }
+    if (args.duration_s) scenario.duration = std::chrono::milliseconds(static_cast<int64_t>(*args.duration_s * 1000));
+    if (args.warmup_s) scenario.warmup = std::chrono::milliseconds(static_cast<int64_t>(*args.warmup_s * 1000));
+    if (args.timeout_ms) scenario.timeout = std::chrono::milliseconds(*args.timeout_ms);
+    if (args.connections) scenario.connections = *args.connections;
+    if (args.threads) scenario.threads = *args.threads;
+    if (args.max_in_flight) scenario.max_in_flight = *args.max_in_flight;
+    if (args.seed) scenario.seed = *args.seed;
+
+    if (!scenario.Validate(error)) {
+        std::cerr << "Scenario: " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    CommandLineArgs args;
+    if (!ParseCommandLine(argc, argv, args)) {
+        return 2;
+    }
+    if (args.help) {
+        PrintUsage();
+        return 0;
+    }
+
+    LoadScenario scenario;
+    if (!BuildScenario(args, scenario)) {
+        return 2;
+    }
+
+    // 先读取基准文件，避免压测结束后才发现文件有误
+    nlohmann::json baseline;
+    if (!args.baseline_file.empty()) {
+        std::ifstream file(args.baseline_file);
+        try {
+            baseline = nlohmann::json::parse(file);
+        } catch (const nlohmann::json::exception& e) {
+            std::cerr << "Baseline " << args.baseline_file << ": " << e.what() << std::endl;
+            return 2;
+        }
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+
+    LoadRunner runner(scenario);
+    g_runner = &runner;
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+
+    const double total_seconds = (scenario.warmup + scenario.duration).count() / 1000.0;
+    LoadRunner::ProgressCallback progress;
+    if (!args.quiet) {
+        progress = [total_seconds](uint64_t completed, double elapsed) {
+            std::cerr << "  " << static_cast<int>(elapsed) << "/" << static_cast<int>(total_seconds)
+                      << " s, " << completed << " completed" << std::endl;
+        };
+    }
+
+    const LoadReport report = runner.Run(progress);
+    g_runner = nullptr;
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+
+    std::cout << std::endl;
+    report.Print(std::cout);
+
+    const nlohmann::json result = report.ToJson();
+    if (!args.output_file.empty()) {
+        std::ofstream file(args.output_file);
+        file << result.dump(2) << std::endl;
+        if (!file) {
+            std::cerr << "Cannot write " << args.output_file << std::endl;
+            return 1;
+        }
+        std::cout << "\nResult written to " << args.output_file << std::endl;
+    }
+
+    if (!baseline.is_null()) {
+        std::cout << std::endl;
+        LoadReport::PrintComparison(std::cout, baseline, result);
+    }
+
+    return report.total.requests > 0 ? 0 : 1;
+}
@@ -0,0 +1,31 @@
+#include "http_load_generator/latency_histogram.h"
+#include <algorithm>
+
+namespace http_load_generator {
+
+LatencyHistogram::LatencyHistogram() : buckets_(Layout::kBucketCount, 0) {
+}
+
+void LatencyHistogram::Record(uint64_t value) {
+    buckets_[Layout::GetBucket(value)]++;
+    count_++;
+    sum_ += value;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < Layout::kBucketCount; ++i) {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+uint64_t LatencyHistogram::GetPercentile(double percentile) const {
+    return Layout::GetPercentile(buckets_, count_, max_, percentile);
+}
+
+} // namespace http_load_generator
@@ -0,0 +1,191 @@
+#include "http_load_generator/load_report.h"
+#include <iomanip>
+
+namespace http_load_generator {
+
+namespace {
+
+struct Percentile {
+    const char* key;            // JSON键
+    const char* label;          // 文本报告列名
+    double value;
+};
+
+const Percentile kPercentiles[] = {
+    {"p50", "p50", 50.0}, {"p75", "p75", 75.0}, {"p90", "p90", 90.0}, {"p99", "p99", 99.0},
+    {"p99_9", "p99.9", 99.9}, {"p99_99", "p99.99", 99.99}
+};
+
+nlohmann::json StatsToJson(const LoadStats& stats) {
+    nlohmann::json latency = {
+        {"min", stats.latency.GetMin()},
+        {"mean", stats.latency.GetMean()},
+        {"max", stats.latency.GetMax()}
+    };
+    for (const auto& percentile : kPercentiles) {
+        latency[percentile.key] = stats.latency.GetPercentile(percentile.value);
+    }
+
+    return {
+        {"requests", stats.requests},
+        {"succeeded", stats.succeeded},
+        {"failed", stats.requests - stats.succeeded},
+        {"bytes_received", stats.bytes_received},
+        {"latency_us", latency},
+        {"errors", stats.errors}
+    };
+}
+
+void PrintLatencyRow(std::ostream& out, const std::string& name, const LoadStats& stats) {
+    out << "  " << std::left << std::setw(24) << name.substr(0, 23) << std::right
+        << std::setw(10) << stats.latency.GetCount()
+        << std::setw(10) << stats.latency.GetMin()
+        << std::setw(10) << static_cast<uint64_t>(stats.latency.GetMean());
+    for (const auto& percentile : kPercentiles) {
+        if (percentile.value == 75.0) {
+            continue;
+        }
+        out << std::setw(10) << stats.latency.GetPercentile(percentile.value);
+    }
+    out << std::setw(10) << stats.latency.GetMax() << "\n";
+}
+
+// 基准值 -> 当前值（变化百分比）
+void PrintChange(std::ostream& out, const std::string& label, double baseline, double current) {
+    out << "  " << std::left << std::setw(22) << label << std::right << std::fixed << std::setprecision(1)
+        << std::setw(14) << baseline << " -> " << std::setw(14) << current;
+    if (baseline != 0.0) {
+        out << "  (" << std::showpos << (current - baseline) / baseline * 100.0 << std::noshowpos << "%)";
+    }
+    out << "\n";
+}
+
+void PrintStatsComparison(std::ostream& out, const nlohmann::json& baseline, const nlohmann::json& current) {
+    for (const char* key : {"p50", "p90", "p99", "p99_9", "max"}) {
+        PrintChange(out, std::string("latency ") + key + " (us)",
+                    baseline["latency_us"].value(key, 0.0), current["latency_us"].value(key, 0.0));
+    }
+    PrintChange(out, "failed", baseline.value("failed", 0.0), current.value("failed", 0.0));
+}
+
+} // namespace
+
+void LoadStats::Merge(const LoadStats& other) {
+    latency.Merge(other.latency);
+    requests += other.requests;
+    succeeded += other.succeeded;
+    bytes_received += other.bytes_received;
+    for (const auto& [error, count] : other.errors) {
+        errors[error] += count;
+    }
+}
+
+void LoadReport::Print(std::ostream& out) const {
+    const auto flags = out.flags();
+    out << std::fixed << std::setprecision(1);
+
+    out << "Scenario: " << scenario.name << "  target " << scenario.target << "\n";
+    if (scenario.mode == LoadMode::RATE) {
+        out << "Mode: open loop at " << scenario.rate << " req/s (latency measured from the intended send time)\n";
+    } else {
+        out << "Mode: closed loop with " << scenario.concurrency << " concurrent requests\n";
+    }
+    out << "Duration: " << elapsed_seconds << " s (+" << scenario.warmup.count() / 1000.0 << " s warmup), "
+        << scenario.connections << " connections, " << scenario.threads << " threads\n\n";
+
+    out << "Requests: " << sent << " sent, " << total.succeeded
+        << " succeeded, " << (total.requests - total.succeeded) << " failed";
+    if (scenario.mode == LoadMode::RATE) {
+        out << ", " << skipped << " skipped, " << late << " sent late";
+    }
+    out << "\n";
+    out << "Throughput: " << GetThroughput() << " req/s, "
+        << (elapsed_seconds > 0 ? total.bytes_received / elapsed_seconds / (1024.0 * 1024.0) : 0.0)
+        << " MB/s received\n";
+    out << "Peak in flight: " << peak_in_flight << "\n\n";
+
+    out << "Latency (us)\n  " << std::left << std::setw(24) << "request" << std::right << std::setw(10) << "count"
+        << std::setw(10) << "min" << std::setw(10) << "mean";
+    for (const auto& percentile : kPercentiles) {
+        if (percentile.value != 75.0) {
+            out << std::setw(10) << percentile.label;
+        }
+    }
+    out << std::setw(10) << "max" << "\n";
+    PrintLatencyRow(out, "total", total);
+    if (per_request.size() > 1) {
+        for (const auto& [name, stats] : per_request) {
+            PrintLatencyRow(out, name, stats);
+        }
+    }
+
+    if (!total.errors.empty()) {
+        out << "\nErrors:\n";
+        for (const auto& [error, count] : total.errors) {
+            out << "  " << error << ": " << count << "\n";
+        }
+    }
+
+    if (scenario.mode == LoadMode::RATE && sent > 0 && late * 100 > sent) {
+        out << "\nWarning: " << late << " requests were sent late; the load generator could not keep up "
+            << "with the target rate (add threads or connections)\n";
+    }
+
+    out.flags(flags);
+}
+
+nlohmann::json LoadReport::ToJson() const {
+    nlohmann::json json;
+    json["scenario"] = {
+        {"name", scenario.name},
+        {"target", scenario.target},
+        {"mode", scenario.mode == LoadMode::RATE ? "rate" : "concurrency"},
+        {"rate", scenario.rate},
+        {"concurrency", scenario.concurrency},
+        {"duration_s", scenario.duration.count() / 1000.0},
+        {"warmup_s", scenario.warmup.count() / 1000.0},
+        {"timeout_ms", scenario.timeout.count()},
+        {"connections", scenario.connections},
+        {"threads", scenario.threads},
+        {"max_in_flight", scenario.max_in_flight},
+        {"seed", scenario.seed}
+    };
+    json["started_at"] = started_at;
+    json["elapsed_s"] = elapsed_seconds;
+    json["sent"] = sent;
+    json["skipped"] = skipped;
+    json["late"] = late;
+    json["peak_in_flight"] = peak_in_flight;
+    json["throughput_rps"] = GetThroughput();
+    json["total"] = StatsToJson(total);
+
+    json["requests"] = nlohmann::json::object();
+    for (const auto& [name, stats] : per_request) {
+        json["requests"][name] = StatsToJson(stats);
+    }
+    return json;
+}
+
+void LoadReport::PrintComparison(std::ostream& out, const nlohmann::json& baseline, const nlohmann::json& current) {
+    const auto flags = out.flags();
+
+    out << "Comparison with baseline (" << baseline.value("started_at", std::string("unknown")) << ")\n";
+    out << "total\n";
+    PrintChange(out, "throughput (req/s)", baseline.value("throughput_rps", 0.0), current.value("throughput_rps", 0.0));
+    if (baseline.contains("total") && current.contains("total")) {
+        PrintStatsComparison(out, baseline["total"], current["total"]);
+    }
+
+    if (baseline.contains("requests") && current.contains("requests") && current["requests"].size() > 1) {
+        for (const auto& [name, stats] : current["requests"].items()) {
+            if (baseline["requests"].contains(name)) {
+                out << name << "\n";
+                PrintStatsComparison(out, baseline["requests"][name], stats);
+            }
+        }
+    }
+
+    out.flags(flags);
+}
+
+} // namespace http_load_generator
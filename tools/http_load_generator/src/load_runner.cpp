@@ -0,0 +1,249 @@
+#include "http_load_generator/load_runner.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace http_load_generator {
+
+using common::network::http::HttpClient;
+using common::network::http::HttpConfig;
+using common::network::http::HttpRequest;
+using common::network::http::HttpResponse;
+
+namespace {
+
+// 发送时落后计划时间超过该值计为迟发
+constexpr std::chrono::milliseconds kLateThreshold{1};
+
+// 权重之和超过该值时按比例缩小乱序表
+constexpr uint64_t kMaxMixSize = 65536;
+
+std::string ErrorName(boost::system::error_code ec) {
+    if (ec == boost::asio::error::operation_aborted) {
+        return "unfinished";
+    }
+    if (ec == boost::asio::error::timed_out) {
+        return "timeout";
+    }
+    if (ec == boost::asio::error::connection_refused) {
+        return "connection refused";
+    }
+    if (ec == boost::asio::error::connection_reset) {
+        return "connection reset";
+    }
+    return ec.message();
+}
+
+std::string CurrentUtcTime() {
+    const std::time_t now = std::time(nullptr);
+    std::tm utc{};
+    gmtime_r(&now, &utc);
+    std::ostringstream out;
+    out << std::put_time(&utc, "%Y-%m-%dT%H:%M:%SZ");
+    return out.str();
+}
+
+} // namespace
+
+LoadRunner::LoadRunner(const LoadScenario& scenario) : scenario_(scenario) {
+    // 每种请求只构造一次，发送时复制
+    std::string target = scenario_.target;
+    while (!target.empty() && target.back() == '/') {
+        target.pop_back();
+    }
+    for (const auto& spec : scenario_.requests) {
+        const std::string path = spec.path.empty() || spec.path[0] != '/' ? "/" + spec.path : spec.path;
+        HttpRequest request(spec.method, target + path);
+        for (const auto& [name, value] : scenario_.headers) {
+            request.SetHeader(name, value);
+        }
+        for (const auto& [name, value] : spec.headers) {
+            request.SetHeader(name, value);
+        }
+        if (!spec.body.empty()) {
+            request.SetBody(spec.body, spec.content_type);
+        }
+        prepared_.push_back(std::move(request));
+        slots_.push_back(std::make_unique<Slot>());
+    }
+
+    uint64_t total_weight = 0;
+    for (const auto& spec : scenario_.requests) {
+        total_weight += spec.weight;
+    }
+    const double scale = total_weight > kMaxMixSize ? static_cast<double>(kMaxMixSize) / total_weight : 1.0;
+    for (size_t i = 0; i < scenario_.requests.size(); ++i) {
+        const auto weight = scenario_.requests[i].weight;
+        const uint64_t copies = weight == 0 ? 0 : std::max<uint64_t>(1, std::llround(weight * scale));
+        mix_.insert(mix_.end(), copies, static_cast<uint32_t>(i));
+    }
+    std::mt19937_64 rng(scenario_.seed);
+    std::shuffle(mix_.begin(), mix_.end(), rng);
+
+    HttpConfig config;
+    config.connect_timeout = scenario_.timeout;
+    config.request_timeout = scenario_.timeout;
+    config.max_connections_per_host = scenario_.connections;
+    config.max_idle_connections_per_host = scenario_.connections;
+    config.user_agent = "Zeus-HTTP-Load/1.0";
+    client_ = std::make_unique<HttpClient>(scenario_.threads, config);
+}
+
+LoadRunner::~LoadRunner() {
+    client_.reset();
+}
+
+LoadReport LoadRunner::Run(const ProgressCallback& progress) {
+    LoadReport report;
+    report.scenario = scenario_;
+    report.started_at = CurrentUtcTime();
+
+    start_ = Clock::now();
+    measure_start_ = start_ + scenario_.warmup;
+    end_ = measure_start_ + scenario_.duration;
+
+    if (scenario_.mode == LoadMode::RATE) {
+        RunOpenLoop(progress);
+    } else {
+        RunClosedLoop(progress);
+    }
+    const auto stopped_at = std::min(Clock::now(), end_);
+    WaitForInFlight();
+
+    // 析构客户端后不会再有回调，之后读取统计无需担心并发
+    client_.reset();
+
+    report.elapsed_seconds = std::max(0.0, std::chrono::duration<double>(stopped_at - measure_start_).count());
+    report.sent = sent_;
+    report.skipped = skipped_;
+    report.late = late_;
+    report.peak_in_flight = peak_in_flight_;
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        // 等待超时后被丢弃的请求计为失败，否则最慢的请求会从统计中消失
+        LoadStats& stats = slots_[i]->stats;
+        if (slots_[i]->issued > stats.requests) {
+            const uint64_t unfinished = slots_[i]->issued - stats.requests;
+            stats.requests += unfinished;
+            stats.errors["unfinished"] += unfinished;
+        }
+        report.total.Merge(slots_[i]->stats);
+        report.per_request.emplace_back(scenario_.requests[i].name, slots_[i]->stats);
+    }
+    return report;
+}
+
+void LoadRunner::RunOpenLoop(const ProgressCallback& progress) {
+    const double interval_ns = 1e9 / scenario_.rate;
+    auto next_progress = start_ + std::chrono::seconds(1);
+
+    for (uint64_t i = 0; !stop_requested_; ++i) {
+        const auto intended = start_ + std::chrono::nanoseconds(static_cast<int64_t>(i * interval_ns));
+        if (intended >= end_) {
+            break;
+        }
+
+        auto now = Clock::now();
+        if (intended > now) {
+            std::this_thread::sleep_until(intended);
+            now = Clock::now();
+        }
+        if (progress && now >= next_progress) {
+            progress(completed_, std::chrono::duration<double>(now - start_).count());
+            next_progress += std::chrono::seconds(1);
+        }
+
+        const bool measured = IsMeasured(intended);
+        if (in_flight_ >= scenario_.max_in_flight) {
+            if (measured) {
+                skipped_++;
+            }
+            continue;
+        }
+        if (measured && now - intended > kLateThreshold) {
+            late_++;
+        }
+        Send(i, intended);
+    }
+}
+
+void LoadRunner::RunClosedLoop(const ProgressCallback& progress) {
+    // 每个请求完成后由回调发出下一个，这里只负责启动和等待结束
+    const auto now = Clock::now();
+    for (size_t i = 0; i < scenario_.concurrency; ++i) {
+        Send(sequence_++, now);
+    }
+
+    auto next_progress = start_ + std::chrono::seconds(1);
+    while (!stop_requested_ && Clock::now() < end_) {
+        std::this_thread::sleep_until(std::min(next_progress, end_));
+        if (progress && Clock::now() >= next_progress) {
+            progress(completed_, std::chrono::duration<double>(Clock::now() - start_).count());
+            next_progress += std::chrono::seconds(1);
+        }
+    }
+}
+
+void LoadRunner::Send(uint64_t sequence, Clock::time_point intended) {
+    const size_t spec = mix_[sequence % mix_.size()];
+    if (IsMeasured(intended)) {
+        sent_++;
+        slots_[spec]->issued++;
+    }
+
+    const size_t in_flight = ++in_flight_;
+    size_t peak = peak_in_flight_;
+    while (in_flight > peak && !peak_in_flight_.compare_exchange_weak(peak, in_flight)) {
+    }
+
+    client_->Request(prepared_[spec], [this, spec, intended](boost::system::error_code ec, const HttpResponse& response) {
+        OnResponse(spec, intended, ec, response);
+    });
+}
+
+void LoadRunner::OnResponse(size_t spec, Clock::time_point intended, boost::system::error_code ec,
+                            const HttpResponse& response) {
+    const auto now = Clock::now();
+
+    if (IsMeasured(intended)) {
+        Slot& slot = *slots_[spec];
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        slot.stats.requests++;
+        if (ec) {
+            slot.stats.errors[ErrorName(ec)]++;
+        } else {
+            slot.stats.latency.Record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(now - intended).count()));
+            slot.stats.bytes_received += response.GetBody().size();
+            const int status = static_cast<int>(response.GetStatusCode());
+            if (status < 400) {
+                slot.stats.succeeded++;
+            } else {
+                slot.stats.errors["status " + std::to_string(status)]++;
+            }
+        }
+    }
+    completed_++;
+
+    // 闭环模式：完成一个立即补发一个
+    if (scenario_.mode == LoadMode::CONCURRENCY && !stop_requested_ && now < end_ &&
+        ec != boost::asio::error::operation_aborted) {
+        Send(sequence_++, now);
+    }
+
+    if (--in_flight_ == 0) {
+        std::lock_guard<std::mutex> lock(done_mutex_);
+        done_cv_.notify_all();
+    }
+}
+
+void LoadRunner::WaitForInFlight() {
+    // 超时的请求由客户端结束，多等一秒作为余量
+    std::unique_lock<std::mutex> lock(done_mutex_);
+    done_cv_.wait_for(lock, scenario_.timeout + std::chrono::seconds(1), [this]() { return in_flight_ == 0; });
+}
+
+} // namespace http_load_generator
@@ -0,0 +1,191 @@
+#include "http_load_generator/load_scenario.h"
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <sstream>
+
+namespace http_load_generator {
+
+using common::network::http::HttpHeaders;
+using common::network::http::HttpMethod;
+
+namespace {
+
+std::chrono::milliseconds Seconds(const nlohmann::json& value) {
+    return std::chrono::milliseconds(static_cast<int64_t>(value.get<double>() * 1000.0));
+}
+
+bool ParseHeaders(const nlohmann::json& json, HttpHeaders& headers, std::string& error) {
+    if (!json.is_object()) {
+        error = "headers must be an object";
+        return false;
+    }
+    for (const auto& [name, value] : json.items()) {
+        if (!value.is_string()) {
+            error = "header '" + name + "' must be a string";
+            return false;
+        }
+        headers[name] = value.get<std::string>();
+    }
+    return true;
+}
+
+bool ParseMethod(const std::string& text, HttpMethod& method) {
+    static const std::pair<const char*, HttpMethod> kMethods[] = {
+        {"GET", HttpMethod::GET}, {"POST", HttpMethod::POST}, {"PUT", HttpMethod::PUT},
+        {"DELETE", HttpMethod::DELETE}, {"PATCH", HttpMethod::PATCH}, {"HEAD", HttpMethod::HEAD},
+        {"OPTIONS", HttpMethod::OPTIONS}
+    };
+    for (const auto& [name, value] : kMethods) {
+        if (text == name) {
+            method = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParseRequest(const nlohmann::json& json, size_t index, LoadRequestSpec& spec, std::string& error) {
+    if (!json.is_object()) {
+        error = "requests[" + std::to_string(index) + "] must be an object";
+        return false;
+    }
+
+    spec.path = json.value("path", "/");
+    spec.name = json.value("name", json.value("method", "GET") + " " + spec.path);
+    if (!ParseMethod(json.value("method", "GET"), spec.method)) {
+        error = "request '" + spec.name + "': unsupported method";
+        return false;
+    }
+    if (json.contains("headers") && !ParseHeaders(json["headers"], spec.headers, error)) {
+        error = "request '" + spec.name + "': " + error;
+        return false;
+    }
+
+    // "json"为任意JSON值，发送前序列化一次；"body"为原样发送的文本
+    if (json.contains("json")) {
+        spec.body = json["json"].dump();
+        spec.content_type = "application/json";
+    } else if (json.contains("body")) {
+        spec.body = json["body"].get<std::string>();
+        spec.content_type = "text/plain";
+    }
+    spec.content_type = json.value("content_type", spec.content_type);
+
+    const int64_t weight = json.value("weight", int64_t(1));
+    if (weight < 0) {
+        error = "request '" + spec.name + "': weight must not be negative";
+        return false;
+    }
+    spec.weight = static_cast<uint32_t>(weight);
+    return true;
+}
+
+} // namespace
+
+bool LoadScenario::LoadFromFile(const std::string& path, std::string& error) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return LoadFromString(buffer.str(), error);
+}
+
+bool LoadScenario::LoadFromString(const std::string& text, std::string& error) {
+    try {
+        const nlohmann::json json = nlohmann::json::parse(text);
+        if (!json.is_object()) {
+            error = "scenario must be a JSON object";
+            return false;
+        }
+
+        name = json.value("name", name);
+        target = json.value("target", target);
+
+        const std::string mode_name = json.value("mode", mode == LoadMode::RATE ? "rate" : "concurrency");
+        if (mode_name == "rate") {
+            mode = LoadMode::RATE;
+        } else if (mode_name == "concurrency") {
+            mode = LoadMode::CONCURRENCY;
+        } else {
+            error = "mode must be \"rate\" or \"concurrency\"";
+            return false;
+        }
+
+        rate = json.value("rate", rate);
+        concurrency = json.value("concurrency", concurrency);
+        if (json.contains("duration_s")) duration = Seconds(json["duration_s"]);
+        if (json.contains("warmup_s")) warmup = Seconds(json["warmup_s"]);
+        if (json.contains("timeout_ms")) timeout = std::chrono::milliseconds(json["timeout_ms"].get<int64_t>());
+        connections = json.value("connections", connections);
+        threads = json.value("threads", threads);
+        max_in_flight = json.value("max_in_flight", max_in_flight);
+        seed = json.value("seed", seed);
+
+        if (json.contains("headers") && !ParseHeaders(json["headers"], headers, error)) {
+            return false;
+        }
+
+        if (json.contains("requests")) {
+            if (!json["requests"].is_array()) {
+                error = "requests must be an array";
+                return false;
+            }
+            requests.clear();
+            for (size_t i = 0; i < json["requests"].size(); ++i) {
+                LoadRequestSpec spec;
+                if (!ParseRequest(json["requests"][i], i, spec, error)) {
+                    return false;
+                }
+                requests.push_back(std::move(spec));
+            }
+        }
+    } catch (const nlohmann::json::exception& e) {
+        error = e.what();
+        return false;
+    }
+
+    return true;
+}
+
+bool LoadScenario::Validate(std::string& error) const {
+    if (target.empty()) {
+        error = "target is not set";
+        return false;
+    }
+    if (requests.empty()) {
+        error = "no requests in the scenario";
+        return false;
+    }
+
+    uint64_t total_weight = 0;
+    for (const auto& spec : requests) {
+        total_weight += spec.weight;
+    }
+    if (total_weight == 0) {
+        error = "all request weights are zero";
+        return false;
+    }
+
+    if (mode == LoadMode::RATE && !(rate > 0.0)) {
+        error = "rate must be positive";
+        return false;
+    }
+    if (mode == LoadMode::CONCURRENCY && concurrency == 0) {
+        error = "concurrency must be positive";
+        return false;
+    }
+    if (duration.count() <= 0) {
+        error = "duration must be positive";
+        return false;
+    }
+    if (threads == 0 || connections == 0) {
+        error = "threads and connections must be positive";
+        return false;
+    }
+    return true;
+}
+
+} // namespace http_load_generator